@@ -30,6 +30,142 @@
 /* OUTPUT_SCALE is used to accomodate data size limit of 16 bits */
 #define OUTPUT_SCALE 16
 
+/*
+ * AUTOCORR_SNR_MARGIN: With VERIFY_FLOAT, a run passes down to this many dB
+ * below the S/N of the reference fxpAutoCorrelation output against the
+ * golden result, 3 dB for twice its error power. AUTOCORR_EXACT_SNR stands
+ * for that S/N where the reference output is exact: one LSB of error in a
+ * full scale 16 bit lag is 90 dB down.
+ */
+#if !defined(AUTOCORR_SNR_MARGIN)
+#define AUTOCORR_SNR_MARGIN 3.0
+#endif
+#define AUTOCORR_EXACT_SNR 90.0
+
+/*
+ * AUTOCORR_FFT_MAX_EXPONENT: the largest FFT the FFT path of AutoCorrCompute
+ * uses, 2**13 points, the largest FFTPlan of fft00. Longer inputs always
+ * take the direct path.
+ */
+#define AUTOCORR_FFT_MIN_EXPONENT 4
+#define AUTOCORR_FFT_MAX_EXPONENT 13
+
+/*
+ * AUTOCORR_FFT_CROSSOVER: AutoCorrCompute takes the FFT path when the
+ * DataSize * NumberOfLags products of the direct path outnumber
+ * AUTOCORR_FFT_CROSSOVER * M * log2(M), for the M point FFT it would use.
+ * AUTOCORR_FFT_CROSSOVER_VEC replaces it when the direct path runs the
+ * SSE2 or NEON kernel of AUTOCORR_SIMD, which does about 3.5 times the
+ * products per second. Measured with AUTOCORR_FFT_BENCH (gcc -O2, x86-64):
+ * the paths break even at 12 for the scalar and 42 for the SSE2 kernel.
+ */
+#if !defined(AUTOCORR_FFT_CROSSOVER)
+#define AUTOCORR_FFT_CROSSOVER 12
+#endif
+#if !defined(AUTOCORR_FFT_CROSSOVER_VEC)
+#define AUTOCORR_FFT_CROSSOVER_VEC 40
+#endif
+
+/*
+ * AUTOCORR_FFT_BENCH: When TRUE, the benchmark computes the autocorrelation
+ * with AutoCorrCompute instead of fxpAutoCorrelation (the data sets take
+ * the direct path, so the CRCs are unchanged). After the timed loop it
+ * times the direct and FFT paths on pseudo random data for a range of
+ * sizes and lags, and reports both rates, the path AutoCorrCompute picks
+ * and the largest difference between the paths.
+ */
+#if !defined(AUTOCORR_FFT_BENCH)
+#define AUTOCORR_FFT_BENCH (FALSE)
+#endif
+
+/*
+ * AUTOCORR_SIMD: Selects the register-blocked kernel of fxpAutoCorrelation,
+ * which computes four lags in one pass over the input, with SSE2 or NEON
+ * multiply-accumulates when the compiler targets them. Scale 0 takes
+ * pmaddwd / vmlal_s16 without the product shifts. The output is identical
+ * to the direct sum-of-products.
+ */
+#if !defined(AUTOCORR_SIMD)
+#define AUTOCORR_SIMD (FALSE)
+#endif
+
+/*
+ * LPC_MAX_ORDER: the largest order of fxpLevinsonDurbin and fxpAutoCorrLpc.
+ * LPC_SHIFT: the fraction bits of their LPC coefficients, Q12.
+ */
+#define LPC_MAX_ORDER 32
+#define LPC_SHIFT 12
+
+/*
+ * AUTOCORR_LPC_BENCH: When TRUE, the benchmark times the LPC front end of
+ * the data set after the timed loop: fxpAutoCorrelation then
+ * fxpLevinsonDurbin, the fused fxpAutoCorrLpc, and fxpAutoCorrLpcBatch
+ * over AUTOCORR_LPC_CHANNELS frames, of order NUMBER_OF_LAGS-1. It
+ * reports frames per second and, with FLOAT_SUPPORT, the largest
+ * difference from a double precision Levinson-Durbin of the same lags.
+ */
+#if !defined(AUTOCORR_LPC_BENCH)
+#define AUTOCORR_LPC_BENCH (FALSE)
+#endif
+#if !defined(AUTOCORR_LPC_CHANNELS)
+#define AUTOCORR_LPC_CHANNELS 16
+#endif
+
+/*
+ * AUTOCORR_CHANNEL_BLOCK: channels fxpAutoCorrInterleaved accumulates at
+ * once, for AUTOCORR_LAG_BLOCK (4) lags.
+ */
+#if !defined(AUTOCORR_CHANNEL_BLOCK)
+#define AUTOCORR_CHANNEL_BLOCK 64
+#endif
+
+/*
+ * AUTOCORR_CHANNEL_BENCH: When TRUE, after the timed loop the benchmark
+ * times fxpAutoCorrChannels and fxpAutoCorrInterleaved on 1 to
+ * AUTOCORR_MAX_CHANNELS channels, rotations of the data set, with the
+ * channels split across a th_pool_open() pool of 1 to AUTOCORR_MAX_THREADS
+ * threads. It checks every channel against fxpAutoCorrelation and reports
+ * the wall-clock channels per second. Needs TH_THREADS.
+ */
+#if !defined(AUTOCORR_CHANNEL_BENCH)
+#define AUTOCORR_CHANNEL_BENCH (FALSE)
+#endif
+#if AUTOCORR_CHANNEL_BENCH && !TH_THREADS
+#error "AUTOCORR_CHANNEL_BENCH needs the worker threads of TH_THREADS"
+#endif
+#if !defined(AUTOCORR_MAX_CHANNELS)
+#define AUTOCORR_MAX_CHANNELS 1024
+#endif
+#if !defined(AUTOCORR_MAX_THREADS)
+#define AUTOCORR_MAX_THREADS 4
+#endif
+
+/*
+ * AUTOCORR_TILE_SAMPLES, AUTOCORR_TILE_LAGS: fxpAutoCorrTiled takes the
+ * input in tiles of AUTOCORR_TILE_SAMPLES samples, 8K bytes, and uses each
+ * tile for up to AUTOCORR_TILE_LAGS lags while it is in the L1 cache.
+ */
+#if !defined(AUTOCORR_TILE_SAMPLES)
+#define AUTOCORR_TILE_SAMPLES 4096
+#endif
+#if !defined(AUTOCORR_TILE_LAGS)
+#define AUTOCORR_TILE_LAGS 64
+#endif
+
+/*
+ * AUTOCORR_TILE_BENCH: When TRUE, after the timed loop the benchmark times
+ * fxpAutoCorrTiled and the lag at a time loop of fxpAutoCorrelation on
+ * pseudo random data of 1K to 2**AUTOCORR_TILE_MAX_EXPONENT samples (16M),
+ * NUMBER_OF_LAGS lags, checks that they agree and reports samples per
+ * second for both.
+ */
+#if !defined(AUTOCORR_TILE_BENCH)
+#define AUTOCORR_TILE_BENCH (FALSE)
+#endif
+#if !defined(AUTOCORR_TILE_MAX_EXPONENT)
+#define AUTOCORR_TILE_MAX_EXPONENT 24
+#endif
+
 /*******************************************************************************
     Global Variables                                                            
 *******************************************************************************/
@@ -49,4 +185,59 @@ void fxpAutoCorrelation (
     e_s16   Scale           /* partial product scale (bits) */
     );
 
+/*
+ * AutoCorrContext: Opaque state of AutoCorrCompute, which computes the same
+ * output as fxpAutoCorrelation, either directly or through an FFT of the
+ * zero padded input, whichever is faster. The context owns the fft00 plans
+ * and work buffers for inputs of up to MaxDataSize samples and lags, so
+ * separate contexts can be used from separate threads.
+ *
+ * The FFT path computes the sums with 16-bit FFTs scaled to the input.
+ * For broadband input it is within a few LSBs of the direct path; input
+ * whose power is in a few lines, a constant or a tone, is the worst case,
+ * within about AutoCorrData[0] / 2**7.
+ */
+typedef struct AutoCorrContext AutoCorrContext;
+
+AutoCorrContext *AutoCorrContextInit(n_int MaxDataSize, n_int MaxLags);
+void AutoCorrContextFree(AutoCorrContext *ctx);
+void AutoCorrCompute(AutoCorrContext *ctx, e_s16 *InputData, e_s16 *AutoCorrData,
+                     e_s16 DataSize, e_s16 NumberOfLags, e_s16 Scale);
+n_int AutoCorrUsesFFT(const AutoCorrContext *ctx, e_s16 DataSize, e_s16 NumberOfLags);
+void AutoCorrFFT(AutoCorrContext *ctx, e_s16 *InputData, e_s16 *AutoCorrData,
+                 e_s16 DataSize, e_s16 NumberOfLags, e_s16 Scale);
+
+/*
+ * AutoCorrStream: Opaque state of the autocorrelation of a sliding window
+ * over a stream of samples. AutoCorrStreamPush updates the sum of each lag
+ * as samples enter and leave the window, NumberOfLags products per
+ * sample, and AutoCorrStreamGet returns the fxpAutoCorrelation output of
+ * the window at any point. Overlapping frames then cost their hop rather
+ * than their length.
+ */
+typedef struct AutoCorrStream AutoCorrStream;
+
+AutoCorrStream *AutoCorrStreamInit(n_int WindowSize, n_int NumberOfLags, n_int Scale);
+void AutoCorrStreamFree(AutoCorrStream *s);
+void AutoCorrStreamReset(AutoCorrStream *s);
+void AutoCorrStreamPush(AutoCorrStream *s, const e_s16 *Samples, n_int Count);
+void AutoCorrStreamGet(const AutoCorrStream *s, e_s16 *AutoCorrData);
+
+n_int fxpLevinsonDurbin(const e_s16 *AutoCorrData, e_s16 *LpcCoeffs, e_s16 *ReflCoeffs,
+                        n_int Order);
+n_int fxpAutoCorrLpc(e_s16 *InputData, e_s16 DataSize, e_s16 Scale, e_s16 *LpcCoeffs,
+                     e_s16 *ReflCoeffs, n_int Order);
+n_int fxpAutoCorrLpcBatch(e_s16 *InputData, n_int Channels, e_s16 DataSize, e_s16 Scale,
+                          e_s16 *LpcCoeffs, e_s16 *ReflCoeffs, n_int Order);
+
+void fxpAutoCorrChannels(e_s16 **Channels, e_s16 **AutoCorrData, n_int NumChannels,
+                         e_s16 DataSize, e_s16 NumberOfLags, e_s16 Scale,
+                         n_int Part, n_int NumParts);
+void fxpAutoCorrInterleaved(const e_s16 *InputData, e_s16 *AutoCorrData, n_int NumChannels,
+                            e_s16 DataSize, e_s16 NumberOfLags, e_s16 Scale,
+                            n_int Part, n_int NumParts);
+void fxpAutoCorrTiled(const e_s16 *InputData, e_s16 *AutoCorrData, e_s32 DataSize,
+                      n_int NumberOfLags, e_s16 Scale);
+void fxpAutoCorrSelectKernel(void);
+
 #endif /* __ALGO_H */
@@ -12,9 +12,256 @@
 *******************************************************************************/
 #include "algo.h"
 
+#if FLOAT_SUPPORT
+#include <math.h>
+#endif
+
+#if AUTOCORR_SIMD
+#include "eembc_fxp.h"
+#endif
+
+/* From fft00/fft00.c, which is linked into the autcor00 targets */
+typedef struct FFTPlan FFTPlan;
+
+FFTPlan *FFTPlanInit(n_int DataSizeExponent);
+void FFTPlanFree(FFTPlan *plan);
+void FFTPlanForwardScaled(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData,
+                          n_int Halved);
+void FFTPlanInverseScaled(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData,
+                          n_int Halved);
+
+#define AUTOCORR_PI 3.14159265358979323846
+
+/* Largest magnitude fed to the scaled FFTs, with some margin */
+#define AUTOCORR_FFT_LIMIT 32000
+
+/* Lags computed together by the AUTOCORR_SIMD kernel */
+#define AUTOCORR_LAG_BLOCK 4
+
+/*
+ * AUTOCORR_VEC_SAMPLES: samples per vector of the AUTOCORR_SIMD kernel, 0
+ * when the compiler targets neither SSE2 nor NEON.
+ */
+#if AUTOCORR_SIMD && (defined(__SSE2__) || defined(__ARM_NEON))
+#define AUTOCORR_VEC_SAMPLES 8
+#else
+#define AUTOCORR_VEC_SAMPLES 0
+#endif
+
 /*******************************************************************************
     Functions                                                                   
 *******************************************************************************/
+#if AUTOCORR_VEC_SAMPLES
+/*
+ * The vector lanes accumulate in 32 bits and wrap. The output is bits 16
+ * to 31 of the accumulator, which wrapping does not change, so the lanes
+ * give the same output as the e_s32 accumulator of the scalar loop.
+ */
+#if defined(__SSE2__)
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrVec
+ *
+ * DESC    : 
+ * The vector part of fxpAutoCorrBlock: adds the products of x[i] and
+ * x[i+k] for lags k = 0 .. AUTOCORR_LAG_BLOCK-1 of x = InputData + Lag,
+ * for i below Count rounded down to whole vectors. pmaddwd forms and adds
+ * pairs of products, ee_q15x8_mac, when Scale is 0; otherwise each product is formed in
+ * 32 bits from its low and high halves and shifted on its own.
+ *
+ * RETURNS : The number of samples done
+ * ---------------------------------------------------------------------------*/
+static n_int
+fxpAutoCorrVec (
+    const e_s16 *InputData,     /* first sample of each product */
+    const e_s16 *LagData,       /* InputData + Lag */
+    n_int       Count,          /* products of each lag */
+    n_int       Scale,          /* partial product scale (bits) */
+    e_s32       *Acc            /* accumulator of each lag */
+)
+{
+    __m128i Sum[AUTOCORR_LAG_BLOCK];
+    __m128i x, y, lo, hi;
+    __m128i s = _mm_cvtsi32_si128(Scale);
+    n_int   i, k;
+
+    for (k = 0; k < AUTOCORR_LAG_BLOCK; k++)
+        Sum[k] = ee_q31x4_zero();
+
+    for (i = 0; i + AUTOCORR_VEC_SAMPLES <= Count; i += AUTOCORR_VEC_SAMPLES) {
+        x = _mm_loadu_si128((const __m128i *)(InputData + i));
+        for (k = 0; k < AUTOCORR_LAG_BLOCK; k++) {
+            y = _mm_loadu_si128((const __m128i *)(LagData + i + k));
+            if (Scale == 0) {
+                Sum[k] = ee_q15x8_mac(Sum[k], x, y);
+            } else {
+                lo = _mm_mullo_epi16(x, y);
+                hi = _mm_mulhi_epi16(x, y);
+                Sum[k] = _mm_add_epi32(Sum[k], _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), s));
+                Sum[k] = _mm_add_epi32(Sum[k], _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), s));
+            }
+        }
+    }
+
+    for (k = 0; k < AUTOCORR_LAG_BLOCK; k++)
+        Acc[k] += ee_q31x4_sum(Sum[k]);
+    return i;
+}
+#else /* __ARM_NEON */
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrVec
+ *
+ * DESC    : 
+ * As the SSE2 version, ee_q15x8_mac being vmlal_s16 multiply-accumulates,
+ * and otherwise vmull_s16 products shifted on their own.
+ *
+ * RETURNS : The number of samples done
+ * ---------------------------------------------------------------------------*/
+static n_int
+fxpAutoCorrVec (
+    const e_s16 *InputData,     /* first sample of each product */
+    const e_s16 *LagData,       /* InputData + Lag */
+    n_int       Count,          /* products of each lag */
+    n_int       Scale,          /* partial product scale (bits) */
+    e_s32       *Acc            /* accumulator of each lag */
+)
+{
+    int32x4_t   Sum[AUTOCORR_LAG_BLOCK];
+    int32x4_t   s = vdupq_n_s32(-Scale);
+    int16x8_t   x, y;
+    n_int       i, k;
+
+    for (k = 0; k < AUTOCORR_LAG_BLOCK; k++)
+        Sum[k] = ee_q31x4_zero();
+
+    for (i = 0; i + AUTOCORR_VEC_SAMPLES <= Count; i += AUTOCORR_VEC_SAMPLES) {
+        x = vld1q_s16(InputData + i);
+        for (k = 0; k < AUTOCORR_LAG_BLOCK; k++) {
+            y = vld1q_s16(LagData + i + k);
+            if (Scale == 0) {
+                Sum[k] = ee_q15x8_mac(Sum[k], x, y);
+            } else {
+                Sum[k] = vaddq_s32(Sum[k], vshlq_s32(vmull_s16(vget_low_s16(x), vget_low_s16(y)), s));
+                Sum[k] = vaddq_s32(Sum[k], vshlq_s32(vmull_s16(vget_high_s16(x), vget_high_s16(y)), s));
+            }
+        }
+    }
+
+    for (k = 0; k < AUTOCORR_LAG_BLOCK; k++)
+        Acc[k] += ee_q31x4_sum(Sum[k]);
+    return i;
+}
+#endif
+
+/* The vector kernel fxpAutoCorrSelectKernel picked, NULL for scalar */
+static n_int (*AutoCorrVec)(const e_s16 *, const e_s16 *, n_int, n_int, e_s32 *) =
+    fxpAutoCorrVec;
+#endif /* AUTOCORR_VEC_SAMPLES */
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrSums
+ *
+ * DESC    : 
+ * Adds the products of x[i] and y[i+k] for i below Count and lags k = 0 ..
+ * AUTOCORR_LAG_BLOCK-1, x = InputData and y = LagData, to Acc[k]: each
+ * sample is loaded once for all the lags, with one accumulator per lag,
+ * and the lagged samples rotate through registers. Whole vectors go to
+ * fxpAutoCorrVec with AUTOCORR_SIMD. Scale 0 leaves out the product
+ * shifts.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpAutoCorrSums (
+    const e_s16 *InputData,     /* first sample of each product */
+    const e_s16 *y,             /* InputData + Lag */
+    n_int       Count,          /* products of each lag */
+    n_int       Scale,          /* partial product scale (bits) */
+    e_s32       *Acc            /* accumulator of each lag */
+)
+{
+    e_s32       x, y0, y1, y2, y3;
+    n_int       i = 0;
+
+#if AUTOCORR_VEC_SAMPLES
+    if (AutoCorrVec != NULL)
+        i = (*AutoCorrVec)(InputData, y, Count, Scale, Acc);
+#endif
+    if (i < Count) {
+        y0 = y[i];
+        y1 = y[i+1];
+        y2 = y[i+2];
+        if (Scale == 0) {
+            for (; i < Count; i++) {
+                x  = InputData[i];
+                y3 = y[i+3];
+                Acc[0] += x * y0;
+                Acc[1] += x * y1;
+                Acc[2] += x * y2;
+                Acc[3] += x * y3;
+                y0 = y1;
+                y1 = y2;
+                y2 = y3;
+            }
+        } else {
+            for (; i < Count; i++) {
+                x  = InputData[i];
+                y3 = y[i+3];
+                Acc[0] += (x * y0) >> Scale;
+                Acc[1] += (x * y1) >> Scale;
+                Acc[2] += (x * y2) >> Scale;
+                Acc[3] += (x * y3) >> Scale;
+                y0 = y1;
+                y1 = y2;
+                y2 = y3;
+            }
+        }
+    }
+}
+
+#if AUTOCORR_SIMD
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrBlock
+ *
+ * DESC    : 
+ * Lags Lag .. Lag+AUTOCORR_LAG_BLOCK-1 of fxpAutoCorrelation in one pass
+ * over the input with fxpAutoCorrSums. The samples that only the lower
+ * lags of the block reach are added at the end.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpAutoCorrBlock (
+    const e_s16 *InputData,     /* input data */
+    e_s16       *AutoCorrData,  /* output of lag Lag on */
+    n_int       DataSize,       /* size of input data */
+    n_int       Lag,            /* first lag of the block */
+    n_int       Scale           /* partial product scale (bits) */
+)
+{
+    const e_s16 *y = InputData + Lag;
+    e_s32       Acc[AUTOCORR_LAG_BLOCK];
+    n_int       Count, i, k;
+
+    for (k = 0; k < AUTOCORR_LAG_BLOCK; k++)
+        Acc[k] = 0;
+
+    /* Samples that all lags of the block reach */
+    Count = DataSize - Lag - (AUTOCORR_LAG_BLOCK - 1);
+    if (Count < 0)
+        Count = 0;
+    fxpAutoCorrSums(InputData, y, Count, Scale, Acc);
+
+    /* The last samples of the lower lags */
+    for (k = 0; k < AUTOCORR_LAG_BLOCK; k++) {
+        for (i = Count; i < DataSize - Lag - k; i++)
+            Acc[k] += ((e_s32) InputData[i] * (e_s32) y[i+k]) >> Scale;
+
+        /* Extract MSW of 1.31 fixed point accumulator */
+        AutoCorrData[k] = (e_s16) (Acc[k] >> 16);
+    }
+}
+#endif /* AUTOCORR_SIMD */
+
 /*------------------------------------------------------------------------------
  * FUNC    : fxpAutoCorrelation
  *
@@ -26,6 +273,8 @@
  * sum-of-products implementation is used to compute the output.
  * Partial products are scaled by Scale bits.
  *
+ * With AUTOCORR_SIMD whole blocks of AUTOCORR_LAG_BLOCK lags are
+ * computed by fxpAutoCorrBlock, with the same output.
  *         
  * RETURNS : 
  *      true/false
@@ -45,8 +294,14 @@ fxpAutoCorrelation (
     n_int   LastIndex;
     e_s32    Accumulator;
 
+    lag = 0;
+#if AUTOCORR_SIMD
+    for (; lag + AUTOCORR_LAG_BLOCK <= NumberOfLags; lag += AUTOCORR_LAG_BLOCK)
+        fxpAutoCorrBlock(InputData, AutoCorrData + lag, DataSize, lag, Scale);
+#endif
+
     /* Compute AutoCorrelation */
-    for (lag = 0; lag < NumberOfLags; lag++) {
+    for (; lag < NumberOfLags; lag++) {
         Accumulator = 0;
         LastIndex = DataSize - lag;
         for (i = 0; i < LastIndex; i++) {
@@ -58,3 +313,977 @@ fxpAutoCorrelation (
     }
 }
 
+
+/*******************************************************************************
+    FFT path
+*******************************************************************************/
+
+/*
+ * The fft00 plans keep the half-step twiddles of the original fft00 tables:
+ * every twiddle multiply adds a phase of -pi/M, so the M point FFT of x[n]
+ * is the DFT of x[n] * exp(-i*pi*popcount(n)/M), and the IFFT of X[k] the
+ * inverse DFT of X[k] * exp(i*pi*popcount(k)/M). Phase[e][p] holds
+ * (cos, sin) of p*pi/2**e to undo this on each side.
+ */
+struct AutoCorrContext {
+    n_int   MaxExponent;    /* largest FFT built, 0 for none */
+    FFTPlan *Plan[AUTOCORR_FFT_MAX_EXPONENT+1];
+    e_s16   Phase[AUTOCORR_FFT_MAX_EXPONENT+1][AUTOCORR_FFT_MAX_EXPONENT+1][2];
+    e_s16   *Time;          /* 2**MaxExponent interleaved points */
+    e_s16   *Freq;          /* 2**MaxExponent interleaved points */
+};
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrExponent
+ *
+ * DESC    : The FFT size for lags 0 .. NumberOfLags-1 of DataSize samples,
+ *           large enough that the circular correlation does not wrap
+ *
+ * RETURNS : log2 of the size, at least AUTOCORR_FFT_MIN_EXPONENT
+ * ---------------------------------------------------------------------------*/
+static n_int AutoCorrExponent(n_int DataSize, n_int NumberOfLags)
+{
+    n_int   e = AUTOCORR_FFT_MIN_EXPONENT;
+
+    if (NumberOfLags > DataSize)
+        NumberOfLags = DataSize;
+    while ((1L << e) < (long)DataSize + NumberOfLags - 1)
+        e++;
+    return e;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrContextInit
+ *
+ * DESC    : 
+ * Create a context for inputs of up to MaxDataSize samples and up to
+ * MaxLags lags. The FFT path is left out when the FFT would be larger than
+ * 2**AUTOCORR_FFT_MAX_EXPONENT points, or without FLOAT_SUPPORT for the
+ * plan tables.
+ *
+ * RETURNS : The context, or NULL on out of memory
+ * ---------------------------------------------------------------------------*/
+AutoCorrContext *AutoCorrContextInit(n_int MaxDataSize, n_int MaxLags)
+{
+    AutoCorrContext *ctx;
+    n_int           e, p;
+#if FLOAT_SUPPORT
+    e_f64           c;
+#endif
+
+    ctx = (AutoCorrContext *)th_malloc(sizeof(AutoCorrContext));
+    if (ctx == NULL)
+        return NULL;
+
+    for (e = 0; e <= AUTOCORR_FFT_MAX_EXPONENT; e++)
+        ctx->Plan[e] = NULL;
+    ctx->Time = NULL;
+    ctx->Freq = NULL;
+    ctx->MaxExponent = 0;
+
+#if FLOAT_SUPPORT
+    ctx->MaxExponent = AutoCorrExponent(MaxDataSize, MaxLags);
+    if (ctx->MaxExponent > AUTOCORR_FFT_MAX_EXPONENT)
+        ctx->MaxExponent = AUTOCORR_FFT_MAX_EXPONENT;
+
+    for (e = AUTOCORR_FFT_MIN_EXPONENT; e <= ctx->MaxExponent; e++) {
+        ctx->Plan[e] = FFTPlanInit(e);
+        if (ctx->Plan[e] == NULL) {
+            AutoCorrContextFree(ctx);
+            return NULL;
+        }
+        for (p = 0; p <= e; p++) {
+            c = floor(32768.0 * cos(p * AUTOCORR_PI / (1L << e)) + 0.5);
+            ctx->Phase[e][p][0] = (e_s16)(c < 32767 ? c : 32767);
+            ctx->Phase[e][p][1] = (e_s16)floor(32768.0 * sin(p * AUTOCORR_PI / (1L << e)) + 0.5);
+        }
+    }
+
+    ctx->Time = (e_s16 *)th_malloc(2 * sizeof(e_s16) << ctx->MaxExponent);
+    ctx->Freq = (e_s16 *)th_malloc(2 * sizeof(e_s16) << ctx->MaxExponent);
+    if (ctx->Time == NULL || ctx->Freq == NULL) {
+        AutoCorrContextFree(ctx);
+        return NULL;
+    }
+#else
+    MaxDataSize = MaxDataSize;
+    MaxLags = MaxLags;
+    p = 0;
+#endif
+
+    return ctx;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrContextFree
+ *
+ * DESC    : Release a context from AutoCorrContextInit. NULL is ignored.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void AutoCorrContextFree(AutoCorrContext *ctx)
+{
+    n_int   e;
+
+    if (ctx == NULL)
+        return;
+    for (e = 0; e <= AUTOCORR_FFT_MAX_EXPONENT; e++)
+        FFTPlanFree(ctx->Plan[e]);
+    if (ctx->Time != NULL)
+        th_free(ctx->Time);
+    if (ctx->Freq != NULL)
+        th_free(ctx->Freq);
+    th_free(ctx);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrPopCount
+ *
+ * DESC    : 
+ *
+ * RETURNS : The number of bits set in n
+ * ---------------------------------------------------------------------------*/
+static n_int AutoCorrPopCount(n_int n)
+{
+    n_int   Count = 0;
+
+    for (; n != 0; n &= n - 1)
+        Count++;
+    return Count;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrShift
+ *
+ * DESC    : x * 2**-Shift, rounded, for Shift of either sign
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static e_s32 AutoCorrShift(e_s32 x, n_int Shift)
+{
+    if (Shift > 0)
+        return ((x >> (Shift - 1)) + 1) >> 1;
+    return x * (1L << -Shift);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrHalved
+ *
+ * DESC    : 
+ * The fewest halved stages for an M = 2**e point scaled FFT of data whose
+ * peak magnitude is Peak, within the limit, and whose magnitudes sum to
+ * Sum: the output stays within Peak * 2**(e - Halved) and Sum * 2**-Halved.
+ *
+ * RETURNS : Halved
+ * ---------------------------------------------------------------------------*/
+static n_int AutoCorrHalved(e_s32 Peak, e_s32 Sum, n_int e)
+{
+    n_int   Halved = 0;
+
+    while (Halved < e && (Peak << (e - Halved)) > AUTOCORR_FFT_LIMIT &&
+           Sum > ((e_s32)AUTOCORR_FFT_LIMIT << Halved))
+        Halved++;
+    return Halved;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrFFT
+ *
+ * DESC    : 
+ * The FFT path of AutoCorrCompute. The input is scaled so that its peak
+ * is within AUTOCORR_FFT_LIMIT, phase corrected and transformed with as
+ * few stages halved as keep the spectrum within the same limit; the power
+ * spectrum is scaled to its peak likewise and transformed back, and the
+ * lags are scaled to the MSW of the 1.31 accumulator, with the partial
+ * product Scale.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void AutoCorrFFT(AutoCorrContext *ctx, e_s16 *InputData, e_s16 *AutoCorrData,
+                 e_s16 DataSize, e_s16 NumberOfLags, e_s16 Scale)
+{
+    e_s16       (*Phase)[2];
+    e_s16       *Time = ctx->Time;
+    e_s16       *Freq = ctx->Freq;
+    e_s32       Peak, Sum, x, y, Power;
+    n_int       e, M, InShift, PowerShift, OutShift, Halved, Lags, i, p;
+
+    Lags = NumberOfLags < DataSize ? NumberOfLags : DataSize;
+    e = AutoCorrExponent(DataSize, Lags);
+    M = 1 << e;
+    Phase = ctx->Phase[e];
+
+    /* Smallest input shift keeping the peak within the limit */
+    Peak = 0;
+    for (i = 0; i < DataSize; i++) {
+        x = InputData[i] < 0 ? -(e_s32)InputData[i] : InputData[i];
+        if (x > Peak)
+            Peak = x;
+    }
+    InShift = -15;
+    while (AutoCorrShift(Peak, InShift) > AUTOCORR_FFT_LIMIT)
+        InShift++;
+
+    Peak = AutoCorrShift(Peak, InShift);
+    Sum = 0;
+    for (i = 0; i < DataSize; i++) {
+        x = AutoCorrShift(InputData[i], InShift);
+        Sum += x < 0 ? -x : x;
+        p = AutoCorrPopCount(i);
+        Time[2*i]   = (e_s16)((x * Phase[p][0] + 16384) >> 15);
+        Time[2*i+1] = (e_s16)((x * Phase[p][1] + 16384) >> 15);
+    }
+    for (; i < M; i++) {
+        Time[2*i]   = 0;
+        Time[2*i+1] = 0;
+    }
+
+    Halved = AutoCorrHalved(Peak, Sum, e);
+    FFTPlanForwardScaled(ctx->Plan[e], Time, Freq, Halved);
+    OutShift = Scale + 16 + e - 2 * (Halved + InShift);
+
+    /* Smallest power shift keeping the peak power within the limit */
+    Peak = 0;
+    for (i = 0; i < M; i++) {
+        x = Freq[2*i];
+        y = Freq[2*i+1];
+        if (x * x + y * y > Peak)
+            Peak = x * x + y * y;
+    }
+    PowerShift = 0;
+    while (AutoCorrShift(Peak, PowerShift) > AUTOCORR_FFT_LIMIT)
+        PowerShift++;
+    while (PowerShift > -15 && AutoCorrShift(Peak, PowerShift - 1) <= AUTOCORR_FFT_LIMIT)
+        PowerShift--;
+
+    Sum = 0;
+    for (i = 0; i < M; i++) {
+        x = Freq[2*i];
+        y = Freq[2*i+1];
+        Power = AutoCorrShift(x * x + y * y, PowerShift);
+        Sum += Power;
+        p = AutoCorrPopCount(i);
+        Freq[2*i]   = (e_s16)((Power * Phase[p][0] + 16384) >> 15);
+        Freq[2*i+1] = (e_s16)(-((Power * Phase[p][1] + 16384) >> 15));
+    }
+
+    Halved = AutoCorrHalved(AutoCorrShift(Peak, PowerShift), Sum, e);
+    FFTPlanInverseScaled(ctx->Plan[e], Freq, Time, Halved);
+
+    /* Time[2*lag] is M * 2**-(all the shifts and halvings) times the sum */
+    OutShift -= PowerShift + Halved;
+    for (i = 0; i < Lags; i++) {
+        x = Time[2*i];
+        AutoCorrData[i] = (e_s16)(OutShift >= 0 ? x >> OutShift : x << -OutShift);
+    }
+    for (; i < NumberOfLags; i++)
+        AutoCorrData[i] = 0;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrUsesFFT
+ *
+ * DESC    : 
+ * Whether AutoCorrCompute takes the FFT path for this size, against the
+ * crossover of the direct kernel fxpAutoCorrSelectKernel picked.
+ *
+ * RETURNS : TRUE or FALSE
+ * ---------------------------------------------------------------------------*/
+n_int AutoCorrUsesFFT(const AutoCorrContext *ctx, e_s16 DataSize, e_s16 NumberOfLags)
+{
+    n_int   Lags = NumberOfLags < DataSize ? NumberOfLags : DataSize;
+    n_int   e = AutoCorrExponent(DataSize, Lags);
+    e_s32   Crossover = AUTOCORR_FFT_CROSSOVER;
+
+    if (e > ctx->MaxExponent || ctx->Plan[e] == NULL)
+        return FALSE;
+#if AUTOCORR_VEC_SAMPLES
+    if (AutoCorrVec != NULL)
+        Crossover = AUTOCORR_FFT_CROSSOVER_VEC;
+#endif
+    return (e_s32)DataSize * Lags > Crossover * e << e;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrCompute
+ *
+ * DESC    : 
+ * fxpAutoCorrelation, through an FFT when that is faster. DataSize and
+ * NumberOfLags must not exceed those given to AutoCorrContextInit for
+ * the FFT path to be available.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void AutoCorrCompute(AutoCorrContext *ctx, e_s16 *InputData, e_s16 *AutoCorrData,
+                     e_s16 DataSize, e_s16 NumberOfLags, e_s16 Scale)
+{
+    if (AutoCorrUsesFFT(ctx, DataSize, NumberOfLags))
+        AutoCorrFFT(ctx, InputData, AutoCorrData, DataSize, NumberOfLags, Scale);
+    else
+        fxpAutoCorrelation(InputData, AutoCorrData, DataSize, NumberOfLags, Scale);
+}
+
+/*
+ * AutoCorrStream: the last WindowSize samples, written twice so that the
+ * window is contiguous at Window + Head, and the sum of products of each
+ * lag. The sums are unsigned so that adding and removing products wraps;
+ * like the lanes of the AUTOCORR_SIMD kernel, bits 16 to 31 are exact.
+ */
+struct AutoCorrStream {
+    n_int   WindowSize;     /* samples in a full window */
+    n_int   NumberOfLags;   /* lags kept */
+    n_int   Scale;          /* partial product scale (bits) */
+    n_int   Head;           /* oldest sample, 0 .. WindowSize-1 */
+    n_int   Count;          /* samples in the window */
+    e_s16   *Window;        /* 2 * WindowSize samples */
+    e_u32   *Acc;           /* NumberOfLags sums */
+};
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrStreamInit
+ *
+ * DESC    : 
+ * Create a stream over a sliding window of WindowSize samples, for lags
+ * 0 .. NumberOfLags-1 with partial products scaled by Scale bits. The
+ * window starts empty.
+ *
+ * RETURNS : The stream, or NULL on out of memory
+ * ---------------------------------------------------------------------------*/
+AutoCorrStream *AutoCorrStreamInit(n_int WindowSize, n_int NumberOfLags, n_int Scale)
+{
+    AutoCorrStream *s = (AutoCorrStream *)th_malloc(sizeof(AutoCorrStream));
+
+    if (s == NULL)
+        return NULL;
+    s->WindowSize = WindowSize;
+    s->NumberOfLags = NumberOfLags;
+    s->Scale = Scale;
+    s->Window = (e_s16 *)th_malloc(2 * WindowSize * sizeof(e_s16));
+    s->Acc = (e_u32 *)th_malloc(NumberOfLags * sizeof(e_u32));
+    if (s->Window == NULL || s->Acc == NULL) {
+        AutoCorrStreamFree(s);
+        return NULL;
+    }
+    AutoCorrStreamReset(s);
+    return s;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrStreamFree
+ *
+ * DESC    : Release a stream from AutoCorrStreamInit. NULL is ignored.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void AutoCorrStreamFree(AutoCorrStream *s)
+{
+    if (s == NULL)
+        return;
+    if (s->Window != NULL)
+        th_free(s->Window);
+    if (s->Acc != NULL)
+        th_free(s->Acc);
+    th_free(s);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrStreamReset
+ *
+ * DESC    : Empty the window
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void AutoCorrStreamReset(AutoCorrStream *s)
+{
+    n_int   lag;
+
+    s->Head = 0;
+    s->Count = 0;
+    for (lag = 0; lag < s->NumberOfLags; lag++)
+        s->Acc[lag] = 0;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrStreamPush
+ *
+ * DESC    : 
+ * Add Count samples to the end of the window. Once the window is full,
+ * the oldest sample leaves it for each one that enters. Each sample that
+ * enters or leaves adds or removes its products with the other samples
+ * of the window, one per lag.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void AutoCorrStreamPush(AutoCorrStream *s, const e_s16 *Samples, n_int Count)
+{
+    e_s16   *w;
+    e_s32   x;
+    n_int   i, lag, Lags, p;
+
+    for (i = 0; i < Count; i++) {
+        if (s->Count == s->WindowSize) {
+            /* The oldest sample leaves */
+            w = s->Window + s->Head;
+            x = w[0];
+            Lags = s->NumberOfLags < s->Count ? s->NumberOfLags : s->Count;
+            for (lag = 0; lag < Lags; lag++)
+                s->Acc[lag] -= (e_u32)((x * (e_s32)w[lag]) >> s->Scale);
+            if (++s->Head == s->WindowSize)
+                s->Head = 0;
+            s->Count--;
+        }
+
+        /* The new sample enters */
+        p = s->Head + s->Count;
+        if (p >= s->WindowSize)
+            p -= s->WindowSize;
+        s->Window[p] = s->Window[p + s->WindowSize] = Samples[i];
+        s->Count++;
+
+        w = s->Window + s->Head + s->Count - 1;
+        x = w[0];
+        Lags = s->NumberOfLags < s->Count ? s->NumberOfLags : s->Count;
+        for (lag = 0; lag < Lags; lag++)
+            s->Acc[lag] += (e_u32)((x * (e_s32)w[-lag]) >> s->Scale);
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrStreamGet
+ *
+ * DESC    : 
+ * The autocorrelation of the samples in the window, the same as
+ * fxpAutoCorrelation of them with the Scale of the stream. Lags that
+ * reach past the samples so far are 0.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void AutoCorrStreamGet(const AutoCorrStream *s, e_s16 *AutoCorrData)
+{
+    n_int   lag;
+
+    for (lag = 0; lag < s->NumberOfLags; lag++) {
+        /* Extract MSW of 1.31 fixed point accumulator */
+        AutoCorrData[lag] = (e_s16) (s->Acc[lag] >> 16);
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : LevinsonMpy
+ *
+ * DESC    : (x * y) >> 15 of a 32-bit x and a 16-bit y, from the two halves
+ *           of x so that no product needs more than 32 bits
+ *
+ * RETURNS : The product
+ * ---------------------------------------------------------------------------*/
+static e_s32 LevinsonMpy(e_s32 x, e_s32 y)
+{
+    return (x >> 15) * y + (((x & 0x7fff) * y) >> 15);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : LevinsonMpyQ30
+ *
+ * DESC    : (x * k) >> 30 of a 32-bit x and a Q30 k, |k| < 1.0, from the
+ *           upper and lower 15 bits of k
+ *
+ * RETURNS : The product
+ * ---------------------------------------------------------------------------*/
+static e_s32 LevinsonMpyQ30(e_s32 x, e_s32 k)
+{
+    return LevinsonMpy(x, k >> 15) + (LevinsonMpy(x, k & 0x7fff) >> 15);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : LevinsonDiv
+ *
+ * DESC    : Num / Den in Q30, for 0 <= Num < Den < 2**30
+ *
+ * RETURNS : The quotient
+ * ---------------------------------------------------------------------------*/
+static e_s32 LevinsonDiv(e_s32 Num, e_s32 Den)
+{
+    e_s32   q = 0;
+    n_int   b;
+
+    for (b = 0; b < 30; b++) {
+        Num <<= 1;
+        q <<= 1;
+        if (Num >= Den) {
+            Num -= Den;
+            q++;
+        }
+    }
+    return q;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpLevinsonDurbin
+ *
+ * DESC    : 
+ * Solve for the LPC coefficients of A(z) = 1 + a1 z**-1 + ... + ap z**-p,
+ * p = Order, from lags 0 .. Order of an autocorrelation. LpcCoeffs[0..Order]
+ * are in Q(LPC_SHIFT), LpcCoeffs[0] being 1.0, and ReflCoeffs[0..Order-1],
+ * unless NULL, the reflection coefficients in Q15.
+ *
+ * The lags are normalized to 15 bits first. The coefficients are kept in
+ * Q24, the reflection coefficients in Q30 and the prediction error in Q9
+ * of the normalized lags, with products of at most 32x16 bits. The recursion stops at the first order whose reflection
+ * coefficient would reach 1.0, as the filter would not be stable; the
+ * coefficients of higher orders are then 0.
+ *
+ * RETURNS : The order reached, Order unless the recursion stopped
+ * ---------------------------------------------------------------------------*/
+n_int
+fxpLevinsonDurbin (
+    const e_s16 *AutoCorrData,  /* lags 0 .. Order */
+    e_s16       *LpcCoeffs,     /* Order+1 coefficients, Q(LPC_SHIFT) */
+    e_s16       *ReflCoeffs,    /* Order coefficients, Q15, or NULL */
+    n_int       Order           /* at most LPC_MAX_ORDER */
+)
+{
+    e_s32   r[LPC_MAX_ORDER+1];
+    e_s32   a[LPC_MAX_ORDER+1];
+    e_s32   Acc, Err, k, t;
+    n_int   i, j, Norm, Reached;
+
+    for (i = 0; i <= Order; i++)
+        a[i] = 0;
+    a[0] = 1L << 24;
+    if (ReflCoeffs != NULL)
+        for (i = 0; i < Order; i++)
+            ReflCoeffs[i] = 0;
+
+    /* Normalize lag 0 to 15 bits, saturating the others */
+    Reached = 0;
+    if (AutoCorrData[0] > 0) {
+        for (Norm = 0; ((e_s32)AutoCorrData[0] << Norm) < 16384; Norm++)
+            ;
+        for (i = 0; i <= Order; i++) {
+            t = (e_s32)AutoCorrData[i] << Norm;
+            r[i] = t > 32767 ? 32767 : t < -32768 ? -32768 : t;
+        }
+
+        Err = r[0] << 9;
+        for (i = 1; i <= Order; i++) {
+            /* Acc = r[i] + sum a[j] r[i-j], in Q9 */
+            Acc = r[i] << 9;
+            for (j = 1; j < i; j++)
+                Acc += LevinsonMpy(a[j], r[i-j]);
+
+            if ((Acc < 0 ? -Acc : Acc) >= Err)
+                break;
+            k = LevinsonDiv(Acc < 0 ? -Acc : Acc, Err);
+            if (Acc > 0)
+                k = -k;
+
+            for (j = 1; j < i - j; j++) {
+                t = a[j] + LevinsonMpyQ30(a[i-j], k);
+                a[i-j] += LevinsonMpyQ30(a[j], k);
+                a[j] = t;
+            }
+            if (j == i - j)
+                a[j] += LevinsonMpyQ30(a[j], k);
+            a[i] = (k + (1L << 5)) >> 6;
+
+            Err -= LevinsonMpyQ30(LevinsonMpyQ30(Err, k), k);
+            if (ReflCoeffs != NULL) {
+                t = (k + (1L << 14)) >> 15;
+                ReflCoeffs[i-1] = (e_s16)(t > 32767 ? 32767 : t);
+            }
+            Reached = i;
+        }
+    }
+
+    for (i = 0; i <= Order; i++) {
+        t = (a[i] + (1L << (23 - LPC_SHIFT))) >> (24 - LPC_SHIFT);
+        LpcCoeffs[i] = (e_s16)(t > 32767 ? 32767 : t < -32768 ? -32768 : t);
+    }
+    return Reached;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrLpc
+ *
+ * DESC    : 
+ * fxpAutoCorrelation of lags 0 .. Order followed by fxpLevinsonDurbin,
+ * with the lags in a local array rather than an output buffer.
+ *
+ * RETURNS : The order reached, as fxpLevinsonDurbin
+ * ---------------------------------------------------------------------------*/
+n_int
+fxpAutoCorrLpc (
+    e_s16   *InputData,     /* input data */
+    e_s16   DataSize,       /* size of input data */
+    e_s16   Scale,          /* partial product scale (bits) */
+    e_s16   *LpcCoeffs,     /* Order+1 coefficients, Q(LPC_SHIFT) */
+    e_s16   *ReflCoeffs,    /* Order coefficients, Q15, or NULL */
+    n_int   Order           /* at most LPC_MAX_ORDER */
+)
+{
+    e_s16   Lags[LPC_MAX_ORDER+1];
+
+    fxpAutoCorrelation(InputData, Lags, DataSize, (e_s16)(Order + 1), Scale);
+    return fxpLevinsonDurbin(Lags, LpcCoeffs, ReflCoeffs, Order);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrLpcBatch
+ *
+ * DESC    : 
+ * fxpAutoCorrLpc of Channels frames of DataSize samples, frame c at
+ * InputData + c * DataSize. Its coefficients go to LpcCoeffs +
+ * c * (Order + 1) and, unless NULL, ReflCoeffs + c * Order.
+ *
+ * RETURNS : The number of frames that reached Order
+ * ---------------------------------------------------------------------------*/
+n_int
+fxpAutoCorrLpcBatch (
+    e_s16   *InputData,     /* Channels frames */
+    n_int   Channels,       /* number of frames */
+    e_s16   DataSize,       /* size of each frame */
+    e_s16   Scale,          /* partial product scale (bits) */
+    e_s16   *LpcCoeffs,     /* Channels * (Order+1) coefficients */
+    e_s16   *ReflCoeffs,    /* Channels * Order coefficients, or NULL */
+    n_int   Order           /* at most LPC_MAX_ORDER */
+)
+{
+    n_int   c, Full = 0;
+
+    for (c = 0; c < Channels; c++) {
+        if (fxpAutoCorrLpc(InputData + (long)c * DataSize, DataSize, Scale,
+                           LpcCoeffs + (long)c * (Order + 1),
+                           ReflCoeffs != NULL ? ReflCoeffs + (long)c * Order : NULL,
+                           Order) == Order)
+            Full++;
+    }
+    return Full;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AutoCorrPart
+ *
+ * DESC    : The first of the NumChannels channels in part Part of NumParts
+ *
+ * RETURNS : The channel index; part NumParts gives NumChannels
+ * ---------------------------------------------------------------------------*/
+static n_int AutoCorrPart(n_int NumChannels, n_int Part, n_int NumParts)
+{
+    return (n_int)((long)NumChannels * Part / NumParts);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrChannels
+ *
+ * DESC    : 
+ * fxpAutoCorrelation of each of NumChannels separate buffers, Channels[c]
+ * into AutoCorrData[c]. The channels are split into NumParts parts of
+ * consecutive channels and only part Part is computed, so that separate
+ * threads can run the parts; NumParts 1 computes them all.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void
+fxpAutoCorrChannels (
+    e_s16   **Channels,         /* NumChannels input buffers */
+    e_s16   **AutoCorrData,     /* NumChannels output buffers */
+    n_int   NumChannels,        /* number of channels */
+    e_s16   DataSize,           /* size of each input */
+    e_s16   NumberOfLags,       /* size of each output */
+    e_s16   Scale,              /* partial product scale (bits) */
+    n_int   Part,               /* part to compute */
+    n_int   NumParts            /* number of parts */
+)
+{
+    n_int   c, Last = AutoCorrPart(NumChannels, Part + 1, NumParts);
+
+    for (c = AutoCorrPart(NumChannels, Part, NumParts); c < Last; c++)
+        fxpAutoCorrelation(Channels[c], AutoCorrData[c], DataSize, NumberOfLags, Scale);
+}
+
+#if AUTOCORR_VEC_SAMPLES
+#if defined(__SSE2__)
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrRowsVec
+ *
+ * DESC    : 
+ * The vector part of fxpAutoCorrInterleaved: lags Lag .. Lag+Lags-1 of
+ * the first Count channels of the rows at InputData, rounded down to
+ * whole vectors, one channel per 32-bit lane. As in fxpAutoCorrVec, the
+ * lanes wrap without changing the output.
+ *
+ * RETURNS : The number of channels done
+ * ---------------------------------------------------------------------------*/
+static n_int
+fxpAutoCorrRowsVec (
+    const e_s16 *InputData,     /* first channel of the block, row 0 */
+    e_s16       *AutoCorrData,  /* first channel of the block, lag 0 */
+    n_int       NumChannels,    /* row length */
+    n_int       Count,          /* channels in the block */
+    n_int       DataSize,       /* rows */
+    n_int       Lag,            /* first lag */
+    n_int       Lags,           /* lags, at most AUTOCORR_LAG_BLOCK */
+    n_int       Scale           /* partial product scale (bits) */
+)
+{
+    __m128i     Acc[AUTOCORR_LAG_BLOCK][2 * AUTOCORR_CHANNEL_BLOCK / AUTOCORR_VEC_SAMPLES];
+    __m128i     x, y, lo, hi;
+    __m128i     s = _mm_cvtsi32_si128(Scale);
+    const e_s16 *r;
+    n_int       Vecs = Count / AUTOCORR_VEC_SAMPLES;
+    n_int       i, k, v;
+
+    for (k = 0; k < Lags; k++)
+        for (v = 0; v < 2 * Vecs; v++)
+            Acc[k][v] = _mm_setzero_si128();
+
+    for (i = 0; i + Lag < DataSize; i++) {
+        r = InputData + (long)i * NumChannels;
+        for (v = 0; v < Vecs; v++) {
+            x = _mm_loadu_si128((const __m128i *)(r + v * AUTOCORR_VEC_SAMPLES));
+            for (k = 0; k < Lags && i + Lag + k < DataSize; k++) {
+                y = _mm_loadu_si128((const __m128i *)(r + (long)(Lag + k) * NumChannels +
+                                                      v * AUTOCORR_VEC_SAMPLES));
+                lo = _mm_mullo_epi16(x, y);
+                hi = _mm_mulhi_epi16(x, y);
+                Acc[k][2*v]   = _mm_add_epi32(Acc[k][2*v],   _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), s));
+                Acc[k][2*v+1] = _mm_add_epi32(Acc[k][2*v+1], _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), s));
+            }
+        }
+    }
+
+    /* Bits 16 to 31 of each lane; the pack cannot saturate */
+    for (k = 0; k < Lags; k++)
+        for (v = 0; v < Vecs; v++)
+            _mm_storeu_si128((__m128i *)(AutoCorrData + (long)(Lag + k) * NumChannels +
+                                         v * AUTOCORR_VEC_SAMPLES),
+                             _mm_packs_epi32(_mm_srai_epi32(Acc[k][2*v], 16),
+                                             _mm_srai_epi32(Acc[k][2*v+1], 16)));
+    return Vecs * AUTOCORR_VEC_SAMPLES;
+}
+#else /* __ARM_NEON */
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrRowsVec
+ *
+ * DESC    : 
+ * As the SSE2 version, with vmull_s16 products and vshrn_n_s32 for the
+ * output.
+ *
+ * RETURNS : The number of channels done
+ * ---------------------------------------------------------------------------*/
+static n_int
+fxpAutoCorrRowsVec (
+    const e_s16 *InputData,     /* first channel of the block, row 0 */
+    e_s16       *AutoCorrData,  /* first channel of the block, lag 0 */
+    n_int       NumChannels,    /* row length */
+    n_int       Count,          /* channels in the block */
+    n_int       DataSize,       /* rows */
+    n_int       Lag,            /* first lag */
+    n_int       Lags,           /* lags, at most AUTOCORR_LAG_BLOCK */
+    n_int       Scale           /* partial product scale (bits) */
+)
+{
+    int32x4_t   Acc[AUTOCORR_LAG_BLOCK][2 * AUTOCORR_CHANNEL_BLOCK / AUTOCORR_VEC_SAMPLES];
+    int32x4_t   s = vdupq_n_s32(-Scale);
+    int16x8_t   x, y;
+    const e_s16 *r;
+    n_int       Vecs = Count / AUTOCORR_VEC_SAMPLES;
+    n_int       i, k, v;
+
+    for (k = 0; k < Lags; k++)
+        for (v = 0; v < 2 * Vecs; v++)
+            Acc[k][v] = vdupq_n_s32(0);
+
+    for (i = 0; i + Lag < DataSize; i++) {
+        r = InputData + (long)i * NumChannels;
+        for (v = 0; v < Vecs; v++) {
+            x = vld1q_s16(r + v * AUTOCORR_VEC_SAMPLES);
+            for (k = 0; k < Lags && i + Lag + k < DataSize; k++) {
+                y = vld1q_s16(r + (long)(Lag + k) * NumChannels + v * AUTOCORR_VEC_SAMPLES);
+                Acc[k][2*v]   = vaddq_s32(Acc[k][2*v],   vshlq_s32(vmull_s16(vget_low_s16(x), vget_low_s16(y)), s));
+                Acc[k][2*v+1] = vaddq_s32(Acc[k][2*v+1], vshlq_s32(vmull_s16(vget_high_s16(x), vget_high_s16(y)), s));
+            }
+        }
+    }
+
+    for (k = 0; k < Lags; k++)
+        for (v = 0; v < Vecs; v++)
+            vst1q_s16(AutoCorrData + (long)(Lag + k) * NumChannels + v * AUTOCORR_VEC_SAMPLES,
+                      vcombine_s16(vshrn_n_s32(Acc[k][2*v], 16), vshrn_n_s32(Acc[k][2*v+1], 16)));
+    return Vecs * AUTOCORR_VEC_SAMPLES;
+}
+#endif
+
+/* The vector kernel fxpAutoCorrSelectKernel picked, NULL for scalar */
+static n_int (*AutoCorrRowsVec)(const e_s16 *, e_s16 *, n_int, n_int, n_int, n_int, n_int,
+                                n_int) = fxpAutoCorrRowsVec;
+#endif /* AUTOCORR_VEC_SAMPLES */
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrSelectKernel
+ *
+ * DESC    : 
+ * Picks the vector kernels of AUTOCORR_SIMD, or the scalar loops, with
+ * th_kernel_select: the best the CPU runs unless -kernel= forces one.
+ * Without vector kernels there is nothing to pick.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void
+fxpAutoCorrSelectKernel (void)
+{
+#if AUTOCORR_VEC_SAMPLES
+    static const THKernelVariant Variants[] = {
+#if defined(__SSE2__)
+        { "sse2",   TH_CPU_SSE2 },
+#else
+        { "neon",   TH_CPU_NEON },
+#endif
+        { "scalar", 0 }
+    };
+
+    if (th_kernel_select("autocorr", Variants, 2) == 0) {
+        AutoCorrVec     = fxpAutoCorrVec;
+        AutoCorrRowsVec = fxpAutoCorrRowsVec;
+    } else {
+        AutoCorrVec     = NULL;
+        AutoCorrRowsVec = NULL;
+    }
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrInterleaved
+ *
+ * DESC    : 
+ * fxpAutoCorrelation of NumChannels channels interleaved sample by sample,
+ * sample i of channel c at InputData[i * NumChannels + c], into lag
+ * AutoCorrData[lag * NumChannels + c]. Blocks of AUTOCORR_CHANNEL_BLOCK
+ * channels and AUTOCORR_LAG_BLOCK lags are accumulated in a local array
+ * in one pass over the rows, the inner loop running along a row. With
+ * AUTOCORR_SIMD, fxpAutoCorrRowsVec takes each whole vector of channels.
+ * Parts are as fxpAutoCorrChannels.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void
+fxpAutoCorrInterleaved (
+    const e_s16 *InputData,     /* DataSize rows of NumChannels samples */
+    e_s16       *AutoCorrData,  /* NumberOfLags rows of NumChannels lags */
+    n_int       NumChannels,    /* number of channels */
+    e_s16       DataSize,       /* samples of each channel */
+    e_s16       NumberOfLags,   /* lags of each channel */
+    e_s16       Scale,          /* partial product scale (bits) */
+    n_int       Part,           /* part to compute */
+    n_int       NumParts        /* number of parts */
+)
+{
+    e_s32       Acc[AUTOCORR_LAG_BLOCK][AUTOCORR_CHANNEL_BLOCK];
+    const e_s16 *x, *y;
+    n_int       First, Last, c0, Count, Done, Lag, Lags, i, k, c;
+
+    First = AutoCorrPart(NumChannels, Part, NumParts);
+    Last = AutoCorrPart(NumChannels, Part + 1, NumParts);
+
+    for (c0 = First; c0 < Last; c0 += AUTOCORR_CHANNEL_BLOCK) {
+        Count = Last - c0 < AUTOCORR_CHANNEL_BLOCK ? Last - c0 : AUTOCORR_CHANNEL_BLOCK;
+
+        for (Lag = 0; Lag < NumberOfLags; Lag += AUTOCORR_LAG_BLOCK) {
+            Lags = NumberOfLags - Lag < AUTOCORR_LAG_BLOCK ? NumberOfLags - Lag : AUTOCORR_LAG_BLOCK;
+            Done = 0;
+#if AUTOCORR_VEC_SAMPLES
+            if (AutoCorrRowsVec != NULL)
+                Done = (*AutoCorrRowsVec)(InputData + c0, AutoCorrData + c0, NumChannels,
+                                          Count, DataSize, Lag, Lags, Scale);
+            if (Done == Count)
+                continue;
+#endif
+            for (k = 0; k < Lags; k++)
+                for (c = Done; c < Count; c++)
+                    Acc[k][c] = 0;
+
+            for (i = 0; i + Lag < DataSize; i++) {
+                x = InputData + (long)i * NumChannels + c0;
+                for (k = 0; k < Lags && i + Lag + k < DataSize; k++) {
+                    y = x + (long)(Lag + k) * NumChannels;
+                    for (c = Done; c < Count; c++)
+                        Acc[k][c] += ((e_s32) x[c] * (e_s32) y[c]) >> Scale;
+                }
+            }
+
+            /* Extract MSW of 1.31 fixed point accumulator */
+            for (k = 0; k < Lags; k++)
+                for (c = Done; c < Count; c++)
+                    AutoCorrData[(long)(Lag + k) * NumChannels + c0 + c] = (e_s16) (Acc[k][c] >> 16);
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpAutoCorrTiled
+ *
+ * DESC    : 
+ * fxpAutoCorrelation of inputs of any length, for which a lag at a time
+ * would read the whole input from memory once per lag. The input is taken
+ * in tiles of AUTOCORR_TILE_SAMPLES, each used for up to AUTOCORR_TILE_LAGS
+ * lags while it is in the cache, by fxpAutoCorrSums for blocks of four
+ * lags. More lags read the input once per AUTOCORR_TILE_LAGS lags.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void
+fxpAutoCorrTiled (
+    const e_s16 *InputData,     /* input data */
+    e_s16       *AutoCorrData,  /* output data */
+    e_s32       DataSize,       /* size of input data */
+    n_int       NumberOfLags,   /* size of output data */
+    e_s16       Scale           /* partial product scale (bits) */
+)
+{
+    e_s32       Acc[AUTOCORR_TILE_LAGS];
+    e_s32       b, i, n;
+    n_int       Lag0, Lags, Lag, k;
+
+    for (Lag0 = 0; Lag0 < NumberOfLags; Lag0 += AUTOCORR_TILE_LAGS) {
+        Lags = NumberOfLags - Lag0 < AUTOCORR_TILE_LAGS ? NumberOfLags - Lag0 : AUTOCORR_TILE_LAGS;
+        for (k = 0; k < Lags; k++)
+            Acc[k] = 0;
+
+        for (b = 0; b < DataSize - Lag0; b += AUTOCORR_TILE_SAMPLES) {
+            for (k = 0; k < Lags; k++) {
+                Lag = Lag0 + k;
+                if (k + AUTOCORR_LAG_BLOCK <= Lags) {
+                    /* Samples of the tile that all four lags reach */
+                    n = DataSize - Lag - (AUTOCORR_LAG_BLOCK - 1) - b;
+                    if (n > AUTOCORR_TILE_SAMPLES)
+                        n = AUTOCORR_TILE_SAMPLES;
+                    if (n > 0)
+                        fxpAutoCorrSums(InputData + b, InputData + b + Lag, (n_int)n,
+                                        Scale, Acc + k);
+                    k += AUTOCORR_LAG_BLOCK - 1;
+                } else {
+                    n = DataSize - Lag - b;
+                    if (n > AUTOCORR_TILE_SAMPLES)
+                        n = AUTOCORR_TILE_SAMPLES;
+                    for (i = b; i < b + n; i++)
+                        Acc[k] += ((e_s32) InputData[i] * (e_s32) InputData[i+Lag]) >> Scale;
+                }
+            }
+        }
+
+        for (k = 0; k < Lags; k++) {
+            Lag = Lag0 + k;
+            /* The last samples of the lower lags of each block of four */
+            if ((k | (AUTOCORR_LAG_BLOCK - 1)) < Lags) {
+                i = DataSize - Lag - (AUTOCORR_LAG_BLOCK - 1 - (k & (AUTOCORR_LAG_BLOCK - 1)));
+                if (i < 0)
+                    i = 0;
+                for (; i < DataSize - Lag; i++)
+                    Acc[k] += ((e_s32) InputData[i] * (e_s32) InputData[i+Lag]) >> Scale;
+            }
+
+            /* Extract MSW of 1.31 fixed point accumulator */
+            AutoCorrData[Lag] = (e_s16) (Acc[k] >> 16);
+        }
+    }
+}
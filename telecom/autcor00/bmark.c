@@ -16,6 +16,10 @@
 
 #include <stdlib.h> /* atoi */
 
+#if AUTOCORR_LPC_BENCH && FLOAT_SUPPORT
+#include <math.h> /* fabs */
+#endif
+
 /*------------------------------------------------------------------------------
  * Test Component Definition Structure
  */
@@ -49,6 +53,27 @@ int    test_main( struct TCDef** tcdef, int argc, const char* argv[] );
 #define EXPECTED_CRC	0x0000
 #endif
 
+/* The S/N in dB of the reference output against the golden result, and
+ * the least that passes, 0 for no check (see AUTOCORR_SNR_MARGIN).  The
+ * data files of TH_DATA_FILES have no golden result. */
+#if defined(DATA_1)
+#define REFERENCE_SNR	AUTOCORR_EXACT_SNR
+#elif defined(DATA_2)
+#define REFERENCE_SNR	47.750426
+#else
+#define REFERENCE_SNR	70.401789
+#endif
+
+#if TH_DATA_FILES
+#define EXPECTED_SNR	0.0
+#else
+#define EXPECTED_SNR	( REFERENCE_SNR - AUTOCORR_SNR_MARGIN )
+#endif
+
+/* Write the output for the host's diffmeasure if nothing checks it here */
+#define OUTPUT_FILE	( !CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK && \
+	( TH_VERIFY_FILES || !( VERIFY_FLOAT && FLOAT_SUPPORT ) ) )
+
 static TCDef the_tcdef = 
    {
     "TEL autcor00   ",
@@ -97,43 +122,474 @@ static TCDef the_tcdef =
 #if	defined(DATA_1)
 #define MAX_DATA_SIZE 16  /* this is the actual file size */ 
 #define OUTFILENAME "xpulseiOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "xpulsei.bin"
+#define REFFILENAME "vpulseai.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xpulsei.dat"
 };
 static e_f64 test_buf[] = { 
 #include "vpulseai.dat"
-}; 
+};
+#endif
 #define NUMBER_OF_LAGS	8
 
 #elif defined(DATA_2)
 
 #define MAX_DATA_SIZE 1024  /* this is the actual file size */ 
 #define OUTFILENAME "xsineiOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "xsinei.bin"
+#define REFFILENAME "vsineai.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xsinei.dat"
 };
 static e_f64 test_buf[] = { 
 #include "vsineai.dat"
 };
+#endif
 #define NUMBER_OF_LAGS	16
 
 #else /* default DATA_3 */  
 
 #define MAX_DATA_SIZE 500  /* this is the actual file size */ 
 #define OUTFILENAME "xspeechiOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "xspeechi.bin"
+#define REFFILENAME "vspeechai.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xspeechi.dat"
 };
 static e_f64 test_buf[] = { 
 #include "vspeechai.dat"
 };
+#endif
 #define NUMBER_OF_LAGS	32
 #endif /* included data */ 
 
-#define T_BSIZE   (MAX_DATA_SIZE*sizeof(e_s16)) /* for results only */ 
+#define T_BSIZE   (DataSize*sizeof(e_s16)) /* for results only */ 
 
 static n_char* t_buf = NULL ;
 
+#if AUTOCORR_FFT_BENCH
+/*
+* FUNC   : fft_bench
+*
+* DESC   : Times the direct and FFT paths of AutoCorrCompute on pseudo random
+*          data of 64 to 4096 samples, with 8 lags up to the size, each for
+*          about the work of the timed loop, and prints autocorrelations per
+*          second for both, the path AutoCorrCompute takes and the largest
+*          difference between the paths.
+*/
+static void fft_bench( size_t iterations )
+{
+    AutoCorrContext *ctx;
+    e_s16       *in, *direct, *fft;
+    e_s16       DataSize, NumberOfLags, Scale;
+    n_int       i, e, diff, max_diff;
+    size_t      loop_cnt, passes, duration;
+    double      work, direct_rate, fft_rate;
+    e_u32       seed = 1;
+
+    ctx    = AutoCorrContextInit( 4096, 4096 );
+    in     = (e_s16 *)th_malloc( 4096 * sizeof(e_s16) );
+    direct = (e_s16 *)th_malloc( 4096 * sizeof(e_s16) );
+    fft    = (e_s16 *)th_malloc( 4096 * sizeof(e_s16) );
+    if( ctx == NULL || in == NULL || direct == NULL || fft == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    work = (double)iterations * MAX_DATA_SIZE * NUMBER_OF_LAGS;
+
+    for ( DataSize = 64; DataSize <= 4096; DataSize *= 4 )
+    {
+        for ( i = 0; i < DataSize; i++ )
+        {
+            seed = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+            in[i] = (e_s16)( seed >> 16 );
+        }
+        for ( Scale = 0; ( 1 << Scale ) < DataSize; Scale++ )
+            ;
+
+        for ( NumberOfLags = 8; NumberOfLags <= DataSize; NumberOfLags *= 4 )
+        {
+            passes = (size_t)( work / ( (double)DataSize * NumberOfLags ) ) + 1;
+            th_signal_start();
+            for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+                fxpAutoCorrelation( in, direct, DataSize, NumberOfLags, Scale );
+            duration = th_signal_finished();
+            direct_rate = duration ? (double)passes * th_ticks_per_sec() / duration : 0.0;
+
+            /* The M point FFT path costs about CROSSOVER * M * log2(M) */
+            for ( e = 4; ( 1L << e ) < (long)DataSize + NumberOfLags - 1; e++ )
+                ;
+            passes = (size_t)( work / ( (double)AUTOCORR_FFT_CROSSOVER * e * ( 1L << e ) ) ) + 1;
+            th_signal_start();
+            for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+                AutoCorrFFT( ctx, in, fft, DataSize, NumberOfLags, Scale );
+            duration = th_signal_finished();
+            fft_rate = duration ? (double)passes * th_ticks_per_sec() / duration : 0.0;
+
+            max_diff = 0;
+            for ( i = 0; i < NumberOfLags; i++ )
+            {
+                diff = direct[i] - fft[i];
+                if ( diff < 0 )
+                    diff = -diff;
+                if ( diff > max_diff )
+                    max_diff = diff;
+            }
+
+            th_printf( "--  Autocorrelation %4d samples %4d lags: %10.1f/s direct %10.1f/s FFT, uses %s, max difference %d\n",
+                       DataSize, NumberOfLags, direct_rate, fft_rate,
+                       AutoCorrUsesFFT( ctx, DataSize, NumberOfLags ) ? "FFT" : "direct", max_diff );
+        }
+    }
+
+    th_free( fft );
+    th_free( direct );
+    th_free( in );
+    AutoCorrContextFree( ctx );
+}
+#endif
+
+#if AUTOCORR_LPC_BENCH
+#if FLOAT_SUPPORT
+/*
+* FUNC   : lpc_reference
+*
+* DESC   : Double precision Levinson-Durbin of lags 0 .. Order, stopping
+*          where fxpLevinsonDurbin would.
+*/
+static void lpc_reference( const e_s16 *AutoCorrData, double *a, n_int Order )
+{
+    double      t[LPC_MAX_ORDER+1];
+    double      Err, Acc, k;
+    n_int       i, j;
+
+    for ( i = 0; i <= Order; i++ )
+        a[i] = 0.0;
+    a[0] = 1.0;
+    Err = AutoCorrData[0];
+    if ( Err <= 0.0 )
+        return;
+    for ( i = 1; i <= Order; i++ )
+    {
+        Acc = AutoCorrData[i];
+        for ( j = 1; j < i; j++ )
+            Acc += a[j] * AutoCorrData[i-j];
+        k = -Acc / Err;
+        if ( fabs( k ) >= 1.0 )
+            return;
+        for ( j = 1; j < i; j++ )
+            t[j] = a[j] + k * a[i-j];
+        for ( j = 1; j < i; j++ )
+            a[j] = t[j];
+        a[i] = k;
+        Err *= 1.0 - k * k;
+    }
+}
+#endif
+
+/*
+* FUNC   : lpc_bench
+*
+* DESC   : Times the LPC front end of the data set, of order NUMBER_OF_LAGS-1:
+*          fxpAutoCorrelation then fxpLevinsonDurbin, fxpAutoCorrLpc, and
+*          fxpAutoCorrLpcBatch over AUTOCORR_LPC_CHANNELS frames, rotations
+*          of the data set. Prints frames per second for each, the order
+*          reached and, with FLOAT_SUPPORT, the largest difference from
+*          lpc_reference in LSBs of the coefficients.
+*/
+static void lpc_bench( size_t iterations, e_s16 *InputData, e_s16 DataSize, e_s16 Scale )
+{
+    e_s16       Lags[LPC_MAX_ORDER+1];
+    e_s16       *frames, *lpc, *refl;
+    n_int       Order = NUMBER_OF_LAGS - 1;
+    n_int       Reached, Full, c, i;
+    size_t      loop_cnt, passes, duration;
+    double      rate;
+#if FLOAT_SUPPORT
+    double      a[LPC_MAX_ORDER+1], diff, max_diff;
+#endif
+
+    frames = (e_s16 *)th_malloc( AUTOCORR_LPC_CHANNELS * DataSize * sizeof(e_s16) );
+    lpc    = (e_s16 *)th_malloc( AUTOCORR_LPC_CHANNELS * ( Order + 1 ) * sizeof(e_s16) );
+    refl   = (e_s16 *)th_malloc( AUTOCORR_LPC_CHANNELS * Order * sizeof(e_s16) );
+    if( frames == NULL || lpc == NULL || refl == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    for ( c = 0; c < AUTOCORR_LPC_CHANNELS; c++ )
+        for ( i = 0; i < DataSize; i++ )
+            frames[c * DataSize + i] = InputData[( i + c * DataSize / AUTOCORR_LPC_CHANNELS ) % DataSize];
+
+    Reached = 0;
+    th_signal_start();
+    for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )
+    {
+        fxpAutoCorrelation( InputData, Lags, DataSize, (e_s16)( Order + 1 ), Scale );
+        Reached = fxpLevinsonDurbin( Lags, lpc, refl, Order );
+    }
+    duration = th_signal_finished();
+    rate = duration ? (double)iterations * th_ticks_per_sec() / duration : 0.0;
+    th_printf( "--  LPC order %d, %-40s %10.1f frames/s\n", Order, "autocorrelation then Levinson-Durbin:", rate );
+
+    th_signal_start();
+    for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )
+        Reached = fxpAutoCorrLpc( InputData, DataSize, Scale, lpc, refl, Order );
+    duration = th_signal_finished();
+    rate = duration ? (double)iterations * th_ticks_per_sec() / duration : 0.0;
+    th_printf( "--  LPC order %d, %-40s %10.1f frames/s\n", Order, "fused:", rate );
+
+    passes = iterations / AUTOCORR_LPC_CHANNELS + 1;
+    Full = 0;
+    th_signal_start();
+    for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+        Full = fxpAutoCorrLpcBatch( frames, AUTOCORR_LPC_CHANNELS, DataSize, Scale, lpc, refl, Order );
+    duration = th_signal_finished();
+    rate = duration ? (double)passes * AUTOCORR_LPC_CHANNELS * th_ticks_per_sec() / duration : 0.0;
+    th_printf( "--  LPC order %d, %-40s %10.1f frames/s, %d of %d of full order\n",
+               Order, "batch:", rate, Full, AUTOCORR_LPC_CHANNELS );
+
+    Reached = fxpAutoCorrLpc( InputData, DataSize, Scale, lpc, refl, Order );
+#if FLOAT_SUPPORT
+    fxpAutoCorrelation( InputData, Lags, DataSize, (e_s16)( Order + 1 ), Scale );
+    lpc_reference( Lags, a, Order );
+    max_diff = 0.0;
+    for ( i = 0; i <= Order; i++ )
+    {
+        diff = fabs( lpc[i] - a[i] * ( 1L << LPC_SHIFT ) );
+        if ( diff > max_diff )
+            max_diff = diff;
+    }
+    th_printf( "--  LPC order reached %d, max difference from double precision %.1f LSB\n",
+               Reached, max_diff );
+#else
+    th_printf( "--  LPC order reached %d\n", Reached );
+#endif
+
+    th_free( refl );
+    th_free( lpc );
+    th_free( frames );
+}
+#endif
+
+#if AUTOCORR_CHANNEL_BENCH
+/*
+ * A pass of channel_bench over the channels, the channel buffers or the
+ * interleaved ones, that th_pool_run() splits across the threads.
+ */
+typedef struct {
+    n_int               nthreads;
+    n_int               interleaved;    /* FALSE for the channel buffers */
+    n_int               channels;
+    e_s16               DataSize;
+    e_s16               NumberOfLags;
+    e_s16               Scale;
+    e_s16               **in;           /* channel buffers */
+    e_s16               **out;
+    e_s16               *matrix;        /* interleaved channels */
+    e_s16               *lags;
+} channel_job;
+
+static void channel_part( void *arg, int part )
+{
+    channel_job     *job = (channel_job *)arg;
+
+    if ( job->interleaved )
+        fxpAutoCorrInterleaved( job->matrix, job->lags, job->channels, job->DataSize,
+                                job->NumberOfLags, job->Scale, part, job->nthreads );
+    else
+        fxpAutoCorrChannels( job->in, job->out, job->channels, job->DataSize,
+                             job->NumberOfLags, job->Scale, part, job->nthreads );
+}
+
+/*
+* FUNC   : channel_bench
+*
+* DESC   : Times fxpAutoCorrChannels and fxpAutoCorrInterleaved on 1 to
+*          AUTOCORR_MAX_CHANNELS channels, channel c being the data set
+*          rotated by c samples, with 1 to AUTOCORR_MAX_THREADS threads, for
+*          about the work of the timed loop each. Checks every channel of
+*          both forms against fxpAutoCorrelation and prints the wall-clock
+*          channels per second.
+*/
+static void channel_bench( size_t iterations, e_s16 *InputData, e_s16 DataSize,
+                           e_s16 NumberOfLags, e_s16 Scale )
+{
+    THPool          *pool;
+    channel_job     job;
+    e_s16           *data, *ref, *out;
+    n_int           channels, form, nthreads, c, i, bad;
+    size_t          loop_cnt, passes;
+    double          t0, t1;
+
+    data = (e_s16 *)th_malloc( (size_t)AUTOCORR_MAX_CHANNELS * DataSize * sizeof(e_s16) );
+    job.matrix = (e_s16 *)th_malloc( (size_t)AUTOCORR_MAX_CHANNELS * DataSize * sizeof(e_s16) );
+    ref  = (e_s16 *)th_malloc( (size_t)AUTOCORR_MAX_CHANNELS * NumberOfLags * sizeof(e_s16) );
+    out  = (e_s16 *)th_malloc( (size_t)AUTOCORR_MAX_CHANNELS * NumberOfLags * sizeof(e_s16) );
+    job.lags = (e_s16 *)th_malloc( (size_t)AUTOCORR_MAX_CHANNELS * NumberOfLags * sizeof(e_s16) );
+    job.in  = (e_s16 **)th_malloc( AUTOCORR_MAX_CHANNELS * sizeof(e_s16 *) );
+    job.out = (e_s16 **)th_malloc( AUTOCORR_MAX_CHANNELS * sizeof(e_s16 *) );
+    if( data == NULL || job.matrix == NULL || ref == NULL || out == NULL ||
+        job.lags == NULL || job.in == NULL || job.out == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    for ( c = 0; c < AUTOCORR_MAX_CHANNELS; c++ )
+    {
+        job.in[c]  = data + (long)c * DataSize;
+        job.out[c] = out + (long)c * NumberOfLags;
+        for ( i = 0; i < DataSize; i++ )
+            job.in[c][i] = InputData[( i + c ) % DataSize];
+        fxpAutoCorrelation( job.in[c], ref + (long)c * NumberOfLags, DataSize, NumberOfLags, Scale );
+    }
+
+    job.DataSize = DataSize;
+    job.NumberOfLags = NumberOfLags;
+    job.Scale = Scale;
+
+    for ( channels = 1; channels <= AUTOCORR_MAX_CHANNELS; channels *= 4 )
+    {
+        job.channels = channels;
+        for ( i = 0; i < DataSize; i++ )
+            for ( c = 0; c < channels; c++ )
+                job.matrix[(long)i * channels + c] = job.in[c][i];
+
+        passes = iterations / channels + 1;
+
+        for ( form = 0; form < 2; form++ )
+        {
+            job.interleaved = form;
+            for ( nthreads = 1; nthreads <= AUTOCORR_MAX_THREADS; nthreads++ )
+            {
+                job.nthreads = nthreads;
+                pool = th_pool_open( nthreads );
+                if ( pool == NULL )
+                   th_exit( THE_FAILURE, "Cannot create thread %s:%d", __FILE__, __LINE__ );
+
+                t0 = th_wall_seconds();
+                for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+                    th_pool_run( pool, channel_part, &job );
+                t1 = th_wall_seconds();
+
+                th_pool_close( pool );
+
+                bad = 0;
+                for ( c = 0; c < channels; c++ )
+                    for ( i = 0; i < NumberOfLags; i++ )
+                        if ( ( form ? job.lags[(long)i * channels + c] : job.out[c][i] ) !=
+                             ref[(long)c * NumberOfLags + i] )
+                            bad++;
+                if ( bad )
+                    th_printf( "--  Channels Failure: %d channels, %d threads, %d lags differ\n",
+                               channels, nthreads, bad );
+
+                th_printf( "--  %-11s %4d channels, %d threads: %12.1f channels/s\n",
+                           form ? "Interleaved" : "Buffers", channels, nthreads,
+                           t1 > t0 ? (double)passes * channels / ( t1 - t0 ) : 0.0 );
+            }
+        }
+    }
+
+    th_free( job.out );
+    th_free( job.in );
+    th_free( job.lags );
+    th_free( out );
+    th_free( ref );
+    th_free( job.matrix );
+    th_free( data );
+}
+#endif
+
+#if AUTOCORR_TILE_BENCH
+/*
+* FUNC   : autocorr_by_lag
+*
+* DESC   : The loop of fxpAutoCorrelation, a lag at a time over the whole
+*          input, for inputs longer than its e_s16 DataSize.
+*/
+static void autocorr_by_lag( const e_s16 *InputData, e_s16 *AutoCorrData, e_s32 DataSize,
+                             n_int NumberOfLags, e_s16 Scale )
+{
+    e_s32       Accumulator, i;
+    n_int       lag;
+
+    for ( lag = 0; lag < NumberOfLags; lag++ )
+    {
+        Accumulator = 0;
+        for ( i = 0; i < DataSize - lag; i++ )
+            Accumulator += ( (e_s32)InputData[i] * (e_s32)InputData[i+lag] ) >> Scale;
+        AutoCorrData[lag] = (e_s16)( Accumulator >> 16 );
+    }
+}
+
+/*
+* FUNC   : tile_bench
+*
+* DESC   : Times autocorr_by_lag and fxpAutoCorrTiled on pseudo random data
+*          of 1K to 2**AUTOCORR_TILE_MAX_EXPONENT samples, by fours, with
+*          Scale log2 of the size, each for about the work of the timed
+*          loop, and prints samples per second for both. The two must
+*          agree.
+*/
+static void tile_bench( size_t iterations, n_int NumberOfLags )
+{
+    e_s16       *in, *by_lag, *tiled;
+    e_s32       DataSize, i;
+    n_int       e;
+    size_t      loop_cnt, passes, duration;
+    double      work, by_lag_rate, tiled_rate;
+    e_u32       seed = 1;
+
+    in     = (e_s16 *)th_malloc( sizeof(e_s16) << AUTOCORR_TILE_MAX_EXPONENT );
+    by_lag = (e_s16 *)th_malloc( NumberOfLags * sizeof(e_s16) );
+    tiled  = (e_s16 *)th_malloc( NumberOfLags * sizeof(e_s16) );
+    if( in == NULL || by_lag == NULL || tiled == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    for ( i = 0; i < ( 1L << AUTOCORR_TILE_MAX_EXPONENT ); i++ )
+    {
+        seed = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+        in[i] = (e_s16)( seed >> 16 );
+    }
+
+    work = (double)iterations * MAX_DATA_SIZE * NUMBER_OF_LAGS;
+
+    for ( e = 10; e <= AUTOCORR_TILE_MAX_EXPONENT; e += 2 )
+    {
+        DataSize = 1L << e;
+        passes = (size_t)( work / ( (double)DataSize * NumberOfLags ) ) + 1;
+
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+            autocorr_by_lag( in, by_lag, DataSize, NumberOfLags, (e_s16)e );
+        duration = th_signal_finished();
+        by_lag_rate = duration ? (double)passes * DataSize * th_ticks_per_sec() / duration : 0.0;
+
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+            fxpAutoCorrTiled( in, tiled, DataSize, NumberOfLags, (e_s16)e );
+        duration = th_signal_finished();
+        tiled_rate = duration ? (double)passes * DataSize * th_ticks_per_sec() / duration : 0.0;
+
+        for ( i = 0; i < NumberOfLags; i++ )
+        {
+            if ( by_lag[i] != tiled[i] )
+            {
+                th_printf( "--  Tiled Failure: %ld samples, lag %ld\n", (long)DataSize, (long)i );
+                break;
+            }
+        }
+
+        th_printf( "--  Autocorrelation %8ld samples %2d lags: %12.1f samples/s by lag %12.1f samples/s tiled\n",
+                   (long)DataSize, NumberOfLags, by_lag_rate, tiled_rate );
+    }
+
+    th_free( tiled );
+    th_free( by_lag );
+    th_free( in );
+}
+#endif
+
 /*------------------------------------------------------------------------------
  * FUNC   : t_run_test
  *
@@ -170,13 +626,17 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
    /* this should accomodate a short + 2 symbols (\n) */ 
 	const char		*outFilename;
 	e_s16			*InputData,*AutoCorrData;
-	e_s16			DataSize,NumberOfLags,Scale,TempVal;
+	e_s16			DataSize,NumberOfLags,DefaultLags,Scale,TempVal;
+#if	TH_DATA_FILES
+	const e_f64		*golden_data;
+	size_t			n;
+#endif
+#if AUTOCORR_FFT_BENCH
+	AutoCorrContext	*ctx;
+#endif
 
-#if	!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
+#if	OUTPUT_FILE
 	e_s16			i;   
-	e_u8			*out_symbol_buffer;
-	e_u8			*stringHeadPtr;
-	n_char			*tmp_buf;
 #endif
 
 	/*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
@@ -184,10 +644,21 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
    */
 	outFilename = OUTFILENAME;
 
-   t_buf     = (n_char *) th_malloc( T_BSIZE );
-   if( t_buf == NULL )
-       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
-
+#if	TH_DATA_FILES
+   /* The data set comes from files, and the lags default to the number of
+    * golden results. The partial product scale is found in an e_s16, so
+    * takes at most 16384 samples.
+    */
+    InputData	 = (e_s16 *)th_get_data_file( TH_DATA_INPUT, INFILENAME, sizeof(e_s16), &n );
+	if ( n > 16384 )
+		th_exit( THE_BAD_SIZE, "Data set of %ld samples is over 16384", (long)n );
+	DataSize     = (e_s16)n;
+	golden_data  = (const e_f64 *)th_get_data_file( TH_DATA_GOLDEN, REFFILENAME, sizeof(e_f64), &n );
+	DefaultLags  = (e_s16)n;
+#if	VERIFY_FLOAT && FLOAT_SUPPORT
+   	golden_result= (e_f64 *)golden_data; 
+#endif
+#else
 #if	VERIFY_FLOAT && FLOAT_SUPPORT
    	golden_result= (e_f64 *)&test_buf; 
 #endif
@@ -196,19 +667,26 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 	* so initializing is simplier
 	*/ 
     InputData	 = (e_s16 *)&input_buf; 
-    AutoCorrData = (e_s16 *)t_buf;
 	DataSize     = MAX_DATA_SIZE;  
+	DefaultLags  = NUMBER_OF_LAGS;
+#endif
+
+   t_buf     = (n_char *) th_malloc( T_BSIZE );
+   if( t_buf == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    AutoCorrData = (e_s16 *)t_buf;
 
 	if (argc < 2)  
 	{
 		th_printf( "WARNING: Missing output filename  Using: %s\n",outFilename);
-		NumberOfLags = NUMBER_OF_LAGS;
+		NumberOfLags = DefaultLags;
         th_printf( "WARNING: Cannot determine lags  Using: %d\n",NumberOfLags);
 	} else {
     if ((argc <3) || ((NumberOfLags = atoi(argv[2])) == 0))
 	{
 	    outFilename = argv[1];
-		NumberOfLags = NUMBER_OF_LAGS;
+		NumberOfLags = DefaultLags;
         th_printf( "WARNING: Cannot determine lags  Using: %d\n",NumberOfLags);
 	}}
      
@@ -224,16 +702,30 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 	 TempVal = TempVal << 1;
        }
 
+#if AUTOCORR_FFT_BENCH
+   ctx = AutoCorrContextInit( DataSize, NumberOfLags );
+   if( ctx == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+#endif
+
+   fxpAutoCorrSelectKernel();  /* pick the kernel variants, see th_kernel_select() */
+
    /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
     * This is the actual benchmark
    */
+   th_latency_begin( iterations );
    th_signal_start();  /* Tell the host that the test has begun */
 
    for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
       {
+#if AUTOCORR_FFT_BENCH
+   	AutoCorrCompute(ctx,InputData,AutoCorrData,DataSize,NumberOfLags,Scale);
+#else
    	fxpAutoCorrelation(InputData,AutoCorrData,DataSize,NumberOfLags,
 	                   Scale
 			   );
+#endif
+   	th_latency_mark();
 /* Bug 51 always true */
 #if BMDEBUG
 		if ( !th_harness_poll() )	break;
@@ -243,53 +735,54 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
    results.duration   = th_signal_finished();  /* signal that we are finished */
    
    results.iterations = iterations;
+
+#if AUTOCORR_FFT_BENCH
+   AutoCorrContextFree( ctx );
+   fft_bench( iterations );
+#endif
+#if AUTOCORR_LPC_BENCH
+   lpc_bench( iterations, InputData, DataSize, Scale );
+#endif
+#if AUTOCORR_CHANNEL_BENCH
+   channel_bench( iterations, InputData, DataSize, NumberOfLags, Scale );
+#endif
+#if AUTOCORR_TILE_BENCH
+   tile_bench( iterations, NumberOfLags );
+#endif
 #if		VERIFY_FLOAT && FLOAT_SUPPORT
    dunion.d          = diffmeasure (golden_result, NumberOfLags, COMPLEX, AutoCorrData, NumberOfLags, COMPLEX);
    results.v1         = dunion.v[0];
    results.v2         = dunion.v[1];
+   dunion.d          = EXPECTED_SNR;
+   results.v3         = dunion.v[0];
+   results.v4         = dunion.v[1];
+   results.verify_snr = TRUE;
 #else
    results.v1         = 0;
    results.v2         = 0;
-#endif
    results.v3         = 0;
    results.v4         = 0;
+   results.verify_snr = FALSE;
+#endif
    results.info       = info;
    
    th_sprintf( info, "A note of basic info" );
 
 #if		NON_INTRUSIVE_CRC_CHECK
-	results.CRC = 0;
-	for ( loop_cnt = 0; loop_cnt < (size_t) NumberOfLags;loop_cnt++)
-		results.CRC = Calc_crc16((e_u16) AutoCorrData[loop_cnt],results.CRC);
+	results.CRC = Calc_crc_buf16( (const e_u16 *)AutoCorrData, (size_t)NumberOfLags, 0 );
 #elif	CRC_CHECK
 	results.CRC=0;
 #else
 	results.CRC=0;
-   
-   /* Calculate the size of the output buffer */ 
-   TempVal   = 0;             /* reuse this variable as a counter */ 
-   tmp_buf   = (n_char *)th_malloc(16); /* should acommodate largest single token */
-   if( tmp_buf == NULL )
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+#endif
 
+#if	OUTPUT_FILE
+   /* Stream the output to the host as it is formatted */
+   th_file_begin( outFilename );
    for( i=0; i<NumberOfLags; i++ ){
-       TempVal += th_sprintf( tmp_buf, " %d\n", AutoCorrData[i]);
+       th_file_printf( " %d\n", AutoCorrData[i]);
    }
-   th_free(tmp_buf); 
-
-   /* Uploading is different as well,
-    * Since we do not have input buffer, we need to 
-	* use one of our own 
-    */ 
-    out_symbol_buffer  = (e_u8 *)th_malloc(TempVal+1);
-	if( out_symbol_buffer == NULL )
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
-
-    stringHeadPtr = out_symbol_buffer; 
-    for( i=0; i<NumberOfLags; i++ ){
-       stringHeadPtr += th_sprintf((char *) stringHeadPtr, " %d\n", AutoCorrData[i]);
-    }
-    th_send_buf_as_file((char *)out_symbol_buffer,TempVal,outFilename);
+   th_file_end();
 #endif
 
    return th_report_results( &results, EXPECTED_CRC );
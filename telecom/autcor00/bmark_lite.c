@@ -46,6 +46,18 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] );
 #define EXPECTED_CRC	0x0000
 #endif
 
+/* The S/N in dB of the reference output against the golden result, and
+ * the least that passes (see AUTOCORR_SNR_MARGIN) */
+#if defined(DATA_1)
+#define REFERENCE_SNR	AUTOCORR_EXACT_SNR
+#elif defined(DATA_2)
+#define REFERENCE_SNR	47.750426
+#else
+#define REFERENCE_SNR	70.401789
+#endif
+
+#define EXPECTED_SNR	( REFERENCE_SNR - AUTOCORR_SNR_MARGIN )
+
 TCDef the_tcdef = 
 {
     "TEL autcor00   ",
@@ -64,14 +76,15 @@ TCDef the_tcdef =
 	0,
 	0,
 	0,
-	0
+	0,
+	FALSE
 }; 
 
 /* encapsulated data */ 
 #if	defined(DATA_1)
 #define MAX_DATA_SIZE 16  /* this is the actual file size */ 
 #define OUTFILENAME "xpulseiOutput.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xpulsei.dat"
 };
 static e_f64 test_buf[] = { 
@@ -83,7 +96,7 @@ static e_f64 test_buf[] = {
 
 #define MAX_DATA_SIZE 1024  /* this is the actual file size */ 
 #define OUTFILENAME "xsineiOutput.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xsinei.dat"
 };
 static e_f64 test_buf[] = { 
@@ -95,7 +108,7 @@ static e_f64 test_buf[] = {
 
 #define MAX_DATA_SIZE 500  /* this is the actual file size */ 
 #define OUTFILENAME "xspeechiOutput.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xspeechi.dat"
 };
 static e_f64 test_buf[] = { 
@@ -186,10 +199,13 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 	 TempVal = TempVal << 1;
        }
 
+   fxpAutoCorrSelectKernel();  /* pick the kernel variants, see th_kernel_select() */
+
    /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
     * This is the actual benchmark
    */
       tcdef->CRC = 0;
+   th_latency_begin( tcdef->rec_iterations );
    th_signal_start();  /* Tell the host that the test has begun */
 
    for ( loop_cnt = 0; loop_cnt < tcdef->rec_iterations ; loop_cnt++ )  /* no stopping! */
@@ -197,6 +213,7 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
    	fxpAutoCorrelation(InputData,AutoCorrData,DataSize,NumberOfLags,
 	                   Scale
 			   );
+   	th_latency_mark();
 /* Bug 51 always true */
 #if BMDEBUG
 		if ( !th_harness_poll() )	break;
@@ -209,17 +226,19 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 	dunion.d			= diffmeasure (golden_result, NumberOfLags, COMPLEX, AutoCorrData, NumberOfLags, COMPLEX);
 	tcdef->v1			= dunion.v[0];
 	tcdef->v2			= dunion.v[1];
+	dunion.d			= EXPECTED_SNR;
+	tcdef->v3			= dunion.v[0];
+	tcdef->v4			= dunion.v[1];
+	tcdef->verify_snr	= TRUE;
 #else
 	tcdef->v1			= 0;
 	tcdef->v2			= 0;
-#endif
 	tcdef->v3			= 0;
 	tcdef->v4			= 0;
+#endif
 
 #if		NON_INTRUSIVE_CRC_CHECK
-	tcdef->CRC = 0;
-	for ( loop_cnt = 0; loop_cnt < (size_t) NumberOfLags;loop_cnt++)
-		tcdef->CRC = Calc_crc16((e_u16) AutoCorrData[loop_cnt],tcdef->CRC);
+	tcdef->CRC = Calc_crc_buf16( (const e_u16 *)AutoCorrData, (size_t)NumberOfLags, 0 );
 #elif	CRC_CHECK
 	tcdef->CRC=0;
 #else
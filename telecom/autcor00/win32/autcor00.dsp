@@ -95,6 +95,10 @@ SOURCE=..\bmark.c
 
 SOURCE=..\..\diffmeasure\verify.c
 # End Source File
+# Begin Source File
+
+SOURCE=..\..\fft00\fft00.c
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
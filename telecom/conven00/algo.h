@@ -29,6 +29,48 @@
 #define DATA_3
 #endif
 
+/*
+ * CONV_PARITY: When TRUE, convolutionalEncode compiles the CodeMatrix into
+ * generator masks and runs convolutionalEncodeParity, with the same output.
+ */
+#if !defined(CONV_PARITY)
+#define CONV_PARITY (FALSE)
+#endif
+
+/*
+ * CONV_PACKED_BENCH: When TRUE, after the timed loop the benchmark packs
+ * the data set, checks convolutionalEncodeParity, convolutionalEncodePacked
+ * and convolutionalEncodeWords against convolutionalEncode and reports the
+ * input Mbit/s of all four.
+ */
+#if !defined(CONV_PACKED_BENCH)
+#define CONV_PACKED_BENCH (FALSE)
+#endif
+
+/*
+ * CONV_STREAM_BENCH: When TRUE, after the timed loop the benchmark encodes
+ * the data set with ConvEncoderPush at rates 1/2, 2/3 and 3/4, in pieces
+ * of 1 to 64 bits, checks the branch words against convolutionalEncode
+ * with the punctured ones left out, and reports the input Mbit/s of each
+ * rate.
+ */
+#if !defined(CONV_STREAM_BENCH)
+#define CONV_STREAM_BENCH (FALSE)
+#endif
+
+/*
+ * CONV_SLICED_BENCH: When TRUE, after the timed loop the benchmark runs
+ * convolutionalEncodeSliced on 1 to CONV_MAX_STREAMS streams, stream s
+ * being the data set rotated by s bits, checks every stream against
+ * convolutionalEncode and reports the total input Mbit/s encoded.
+ */
+#if !defined(CONV_SLICED_BENCH)
+#define CONV_SLICED_BENCH (FALSE)
+#endif
+#if !defined(CONV_MAX_STREAMS)
+#define CONV_MAX_STREAMS 256
+#endif
+
 
 /*******************************************************************************
     Global Variables                                                            
@@ -47,5 +89,60 @@ convolutionalEncode (
     e_u8    *BranchWords                        /* Output data 1 bit per byte */
 );
 
+/*
+ * Generator masks: bit j of the mask of a code vector is row j of its
+ * CodeMatrix column, and each branch word the parity of the shift
+ * register, bit j holding the bit entered j steps before, under the mask.
+ */
+void ConvGeneratorMasks(e_s16 NumberCodeVectors, e_s16 ConstraintLength,
+                        e_u8 (*CodeMatrix)[MAX_CODE_VECTORS], e_u32 *Masks);
+void convolutionalEncodeParity(const e_u8 *DataBits, e_s16 DataByteSize,
+                               e_s16 NumberCodeVectors, const e_u32 *Masks,
+                               e_u8 *BranchWords);
+
+/*
+ * ConvEncodeTable: Opaque table of the branch words of each input byte from
+ * each state of a code, for the packed encoders. convolutionalEncodePacked
+ * takes 8 input bits per byte and convolutionalEncodeWords 32 per e_u32,
+ * first bit highest, and pack the branch words of convolutionalEncode the
+ * same way, NumberCodeVectors output bytes or words per input one. The
+ * table takes 2**(ConstraintLength-1) * 512 bytes.
+ */
+typedef struct ConvEncodeTable ConvEncodeTable;
+
+ConvEncodeTable *ConvEncodeTableInit(e_s16 NumberCodeVectors, e_s16 ConstraintLength,
+                                     e_u8 (*CodeMatrix)[MAX_CODE_VECTORS]);
+void ConvEncodeTableFree(ConvEncodeTable *t);
+void convolutionalEncodePacked(const ConvEncodeTable *t, const e_u8 *DataBytes,
+                               e_s32 DataByteCount, e_u8 *BranchBytes);
+void convolutionalEncodeWords(const ConvEncodeTable *t, const e_u32 *DataWords,
+                              e_s32 DataWordCount, e_u32 *BranchWords);
+
+/*
+ * ConvEncoder: Opaque streaming encoder. It keeps the shift register
+ * between calls of ConvEncoderPush, so a frame can be encoded in pieces
+ * as it arrives, and optionally punctures the branch words on the way out
+ * with a pattern of keep flags, NumberCodeVectors per input bit; rate 2/3
+ * from rate 1/2 is {1,1, 1,0} and rate 3/4 {1,1, 1,0, 0,1}.
+ */
+typedef struct ConvEncoder ConvEncoder;
+
+ConvEncoder *ConvEncoderInit(e_s16 NumberCodeVectors, e_s16 ConstraintLength,
+                             e_u8 (*CodeMatrix)[MAX_CODE_VECTORS],
+                             const e_u8 *Puncture, n_int PuncturePeriod);
+void ConvEncoderFree(ConvEncoder *enc);
+void ConvEncoderReset(ConvEncoder *enc);
+n_int ConvEncoderPush(ConvEncoder *enc, const e_u8 *DataBits, n_int DataByteSize,
+                      e_u8 *BranchWords);
+
+/*
+ * convolutionalEncodeSliced: convolutionalEncode of many streams bit
+ * sliced, bit i of each word a separate stream, 32 streams per e_u32 and
+ * SliceWords words per step for 64, 128, 256 ... streams.
+ */
+void convolutionalEncodeSliced(const e_u32 *DataSlices, n_int SliceWords, e_s16 DataByteSize,
+                               e_s16 NumberCodeVectors, e_s16 ConstraintLength,
+                               e_u8 (*CodeMatrix)[MAX_CODE_VECTORS], e_u32 *BranchSlices);
+
 #endif
 
@@ -85,39 +85,320 @@ static n_char* t_buf = NULL;
 #if defined(DATA_1)
 #define MAX_DATA_SIZE_BYTES 512  /* this is the actual file size */ 
 #define OUTFILENAME "xk5r2diOutput.dat"
-static  e_u8 input_buf[] = {
+#define INFILENAME  "xk5r2di.bin"
+#define REFFILENAME "vk5r2bwi.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_u8 input_buf[] = {
 #include "xk5r2di.dat"
 };
 static e_u8 test_buf[] = { 
 #include "vk5r2bwi.dat"
-}; 
+};
+#endif
 #define		CODE_INDEX	3
 #elif defined(DATA_2)
 
 #define MAX_DATA_SIZE_BYTES 512  /* this is the actual file size */ 
 #define OUTFILENAME "xk4r2diOutput.dat"
-static  e_u8 input_buf[] = {
+#define INFILENAME  "xk4r2di.bin"
+#define REFFILENAME "vk4r2bwi.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_u8 input_buf[] = {
 #include "xk4r2di.dat"
 };
 static e_u8 test_buf[] = { 
 #include "vk4r2bwi.dat"
-}; 
+};
+#endif
 #define		CODE_INDEX	2
 #else /* default DATA_3 */  
 
 #define MAX_DATA_SIZE_BYTES 512  /* this is the actual file size */ 
 #define OUTFILENAME "xk3r2diOutput.dat"
-static  e_u8 input_buf[] = {
+#define INFILENAME  "xk3r2di.bin"
+#define REFFILENAME "vk3r2bwi.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_u8 input_buf[] = {
 #include "xk3r2di.dat"
 };
 static e_u8 test_buf[] = { 
 #include "vk3r2bwi.dat"
-}; 
+};
+#endif
 #define		CODE_INDEX	1
 #endif /* included data */
 
 #define T_BSIZE ((MAX_DATA_SIZE_BYTES*2)+(2*(MAX_CODE_VECTORS*MAX_CONSTRAINT_LENGTH)))
 
+#if CONV_PACKED_BENCH
+/*
+* FUNC   : packed_bench
+*
+* DESC   : Packs the DataByteSize input bits of the data set into bytes and
+*          words, encodes them with convolutionalEncodePacked and
+*          convolutionalEncodeWords, the unpacked bits with
+*          convolutionalEncodeParity, and checks every branch word bit
+*          against BranchWords from convolutionalEncode. Then times the
+*          four encoders, the packed ones for PACKED_PASSES times the
+*          work of the timed loop, and prints input Mbit/s for each.
+*/
+#define PACKED_PASSES 16
+
+static void packed_bench( size_t iterations, e_u8 *DataBits, e_s16 DataByteSize,
+                          e_s16 NumberCodeVectors, e_s16 ConstraintLength,
+                          e_u8 (*CodeMatrix)[MAX_CODE_VECTORS], const e_u8 *BranchWords )
+{
+    ConvEncodeTable *t;
+    e_u8            *bytes, *bytes_out, *unpacked;
+    e_u32           *words, *words_out;
+    e_u32           Masks[MAX_CODE_VECTORS];
+    n_int           byte_count, word_count, i, bit;
+    size_t          loop_cnt, passes, duration;
+    double          rate;
+
+    byte_count = ( DataByteSize + 7 ) / 8;
+    word_count = ( DataByteSize + 31 ) / 32;
+    t         = ConvEncodeTableInit( NumberCodeVectors, ConstraintLength, CodeMatrix );
+    bytes     = (e_u8 *)th_malloc( 4 * word_count );
+    bytes_out = (e_u8 *)th_malloc( 4 * word_count * NumberCodeVectors );
+    words     = (e_u32 *)th_malloc( word_count * sizeof(e_u32) );
+    words_out = (e_u32 *)th_malloc( word_count * NumberCodeVectors * sizeof(e_u32) );
+    unpacked  = (e_u8 *)th_malloc( DataByteSize * MAX_CODE_VECTORS );
+    if( t == NULL || bytes == NULL || bytes_out == NULL || words == NULL ||
+        words_out == NULL || unpacked == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    for ( i = 0; i < 4 * word_count; i++ )
+        bytes[i] = 0;
+    for ( i = 0; i < word_count; i++ )
+        words[i] = 0;
+    for ( i = 0; i < DataByteSize; i++ )
+    {
+        bytes[i / 8] |= (e_u8)( ( DataBits[i] & 1 ) << ( 7 - i % 8 ) );
+        words[i / 32] |= (e_u32)( DataBits[i] & 1 ) << ( 31 - i % 32 );
+    }
+
+    ConvGeneratorMasks( NumberCodeVectors, ConstraintLength, CodeMatrix, Masks );
+    convolutionalEncodeParity( DataBits, DataByteSize, NumberCodeVectors, Masks, unpacked );
+    convolutionalEncodePacked( t, bytes, byte_count, bytes_out );
+    convolutionalEncodeWords( t, words, word_count, words_out );
+    for ( i = 0; i < NumberCodeVectors * DataByteSize; i++ )
+    {
+        bit = ( bytes_out[i / 8] >> ( 7 - i % 8 ) ) & 1;
+        if ( bit != BranchWords[i] || unpacked[i] != BranchWords[i] ||
+             (n_int)( ( words_out[i / 32] >> ( 31 - i % 32 ) ) & 1 ) != bit )
+        {
+            th_printf( "--  Packed Failure: branch word bit %d\n", i );
+            break;
+        }
+    }
+
+    th_signal_start();
+    for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )
+        convolutionalEncode( DataBits, DataByteSize, NumberCodeVectors, ConstraintLength,
+                             CodeMatrix, unpacked );
+    duration = th_signal_finished();
+    rate = duration ? (double)iterations * DataByteSize * th_ticks_per_sec() / duration / 1e6 : 0.0;
+    th_printf( "--  convolutionalEncode       %10.2f Mbit/s\n", rate );
+
+    th_signal_start();
+    for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )
+        convolutionalEncodeParity( DataBits, DataByteSize, NumberCodeVectors, Masks, unpacked );
+    duration = th_signal_finished();
+    rate = duration ? (double)iterations * DataByteSize * th_ticks_per_sec() / duration / 1e6 : 0.0;
+    th_printf( "--  convolutionalEncodeParity %10.2f Mbit/s\n", rate );
+
+    passes = iterations * PACKED_PASSES;
+    th_signal_start();
+    for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+        convolutionalEncodePacked( t, bytes, byte_count, bytes_out );
+    duration = th_signal_finished();
+    rate = duration ? (double)passes * 8 * byte_count * th_ticks_per_sec() / duration / 1e6 : 0.0;
+    th_printf( "--  convolutionalEncodePacked %10.2f Mbit/s\n", rate );
+
+    th_signal_start();
+    for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+        convolutionalEncodeWords( t, words, word_count, words_out );
+    duration = th_signal_finished();
+    rate = duration ? (double)passes * 32 * word_count * th_ticks_per_sec() / duration / 1e6 : 0.0;
+    th_printf( "--  convolutionalEncodeWords  %10.2f Mbit/s\n", rate );
+
+    th_free( unpacked );
+    th_free( words_out );
+    th_free( words );
+    th_free( bytes_out );
+    th_free( bytes );
+    ConvEncodeTableFree( t );
+}
+#endif
+
+#if CONV_STREAM_BENCH
+/*
+* FUNC   : stream_bench
+*
+* DESC   : For rates 1/2, 2/3 and 3/4, punctured from the data set code,
+*          encodes the data set with ConvEncoderPush in pieces of 1, 2, ...
+*          64 bits in turn and checks the branch words against BranchWords
+*          from convolutionalEncode, less the punctured ones. Then times
+*          the frame pushed in pieces of STREAM_PIECE bits and prints the
+*          input Mbit/s of each rate.
+*/
+#define STREAM_PIECE 64
+
+static void stream_bench( size_t iterations, e_u8 *DataBits, e_s16 DataByteSize,
+                          e_s16 NumberCodeVectors, e_s16 ConstraintLength,
+                          e_u8 (*CodeMatrix)[MAX_CODE_VECTORS], const e_u8 *BranchWords )
+{
+    static const e_u8 RATE_2_3[] = { 1,1, 1,0 };
+    static const e_u8 RATE_3_4[] = { 1,1, 1,0, 0,1 };
+    static const char *names[] = { "1/2", "2/3", "3/4" };
+    const e_u8      *patterns[3];
+    n_int           periods[3];
+    ConvEncoder     *enc;
+    e_u8            *out;
+    n_int           r, i, k, piece, count, expected;
+    size_t          loop_cnt, duration;
+    double          rate;
+
+    patterns[0] = NULL;
+    periods[0]  = 1;
+    patterns[1] = RATE_2_3;
+    periods[1]  = 2;
+    patterns[2] = RATE_3_4;
+    periods[2]  = 3;
+
+    out = (e_u8 *)th_malloc( DataByteSize * MAX_CODE_VECTORS );
+    if( out == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    /* The patterns are for rate 1/2 codes */
+    for ( r = 0; r < ( NumberCodeVectors == 2 ? 3 : 1 ); r++ )
+    {
+        enc = ConvEncoderInit( NumberCodeVectors, ConstraintLength, CodeMatrix,
+                               patterns[r], periods[r] );
+        if( enc == NULL )
+           th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+        count = 0;
+        for ( i = 0, piece = 1; i < DataByteSize; i += piece, piece = piece % 64 + 1 )
+            count += ConvEncoderPush( enc, DataBits + i,
+                                      piece < DataByteSize - i ? piece : DataByteSize - i,
+                                      out + count );
+
+        expected = 0;
+        for ( i = 0; i < NumberCodeVectors * DataByteSize; i++ )
+        {
+            k = i % ( NumberCodeVectors * periods[r] );
+            if ( patterns[r] != NULL && !patterns[r][k] )
+                continue;
+            if ( expected >= count || out[expected] != BranchWords[i] )
+            {
+                th_printf( "--  Stream Failure: rate %s, branch word %d\n", names[r], i );
+                break;
+            }
+            expected++;
+        }
+        if ( expected != count )
+            th_printf( "--  Stream Failure: rate %s, %d branch words for %d\n",
+                       names[r], count, expected );
+
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )
+        {
+            ConvEncoderReset( enc );
+            count = 0;
+            for ( i = 0; i < DataByteSize; i += STREAM_PIECE )
+                count += ConvEncoderPush( enc, DataBits + i,
+                                          STREAM_PIECE < DataByteSize - i ? STREAM_PIECE : DataByteSize - i,
+                                          out + count );
+        }
+        duration = th_signal_finished();
+        rate = duration ? (double)iterations * DataByteSize * th_ticks_per_sec() / duration / 1e6 : 0.0;
+        th_printf( "--  ConvEncoderPush rate %s %10.2f Mbit/s, %d branch words per frame\n",
+                   names[r], rate, count );
+
+        ConvEncoderFree( enc );
+    }
+
+    th_free( out );
+}
+#endif
+
+#if CONV_SLICED_BENCH
+/*
+* FUNC   : sliced_bench
+*
+* DESC   : Bit slices 1, 2, 4, ... CONV_MAX_STREAMS streams, stream s being
+*          the data set rotated by s bits, encodes them with
+*          convolutionalEncodeSliced and checks every stream against
+*          convolutionalEncode of its own bits. Then times each stream
+*          count and prints the total input Mbit/s over all streams.
+*/
+static void sliced_bench( size_t iterations, e_u8 *DataBits, e_s16 DataByteSize,
+                          e_s16 NumberCodeVectors, e_s16 ConstraintLength,
+                          e_u8 (*CodeMatrix)[MAX_CODE_VECTORS] )
+{
+    e_u32           *slices, *slices_out;
+    e_u8            *bits, *ref;
+    n_int           streams, words, stream, i, failed;
+    size_t          loop_cnt, duration;
+    double          rate;
+
+    words      = ( CONV_MAX_STREAMS + 31 ) / 32;
+    slices     = (e_u32 *)th_malloc( (size_t)DataByteSize * words * sizeof(e_u32) );
+    slices_out = (e_u32 *)th_malloc( (size_t)DataByteSize * words * MAX_CODE_VECTORS * sizeof(e_u32) );
+    bits       = (e_u8 *)th_malloc( DataByteSize );
+    ref        = (e_u8 *)th_malloc( DataByteSize * MAX_CODE_VECTORS );
+    if( slices == NULL || slices_out == NULL || bits == NULL || ref == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    for ( streams = 1; streams <= CONV_MAX_STREAMS; streams *= 2 )
+    {
+        words = ( streams + 31 ) / 32;
+        for ( i = 0; i < DataByteSize * words; i++ )
+            slices[i] = 0;
+        for ( stream = 0; stream < streams; stream++ )
+            for ( i = 0; i < DataByteSize; i++ )
+                slices[i * words + stream / 32] |=
+                    (e_u32)( DataBits[( i + stream ) % DataByteSize] & 1 ) << ( stream % 32 );
+
+        convolutionalEncodeSliced( slices, words, DataByteSize, NumberCodeVectors,
+                                   ConstraintLength, CodeMatrix, slices_out );
+        failed = FALSE;
+        for ( stream = 0; stream < streams && !failed; stream++ )
+        {
+            for ( i = 0; i < DataByteSize; i++ )
+                bits[i] = DataBits[( i + stream ) % DataByteSize];
+            convolutionalEncode( bits, DataByteSize, NumberCodeVectors, ConstraintLength,
+                                 CodeMatrix, ref );
+            for ( i = 0; i < NumberCodeVectors * DataByteSize; i++ )
+            {
+                if ( (e_u8)( ( slices_out[i * words + stream / 32] >> ( stream % 32 ) ) & 1 ) != ref[i] )
+                {
+                    th_printf( "--  Sliced Failure: %d streams, stream %d, branch word %d\n",
+                               streams, stream, i );
+                    failed = TRUE;
+                    break;
+                }
+            }
+        }
+
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )
+            convolutionalEncodeSliced( slices, words, DataByteSize, NumberCodeVectors,
+                                       ConstraintLength, CodeMatrix, slices_out );
+        duration = th_signal_finished();
+        rate = duration ? (double)iterations * streams * DataByteSize * th_ticks_per_sec() / duration / 1e6 : 0.0;
+        th_printf( "--  convolutionalEncodeSliced %3d streams %10.2f Mbit/s\n", streams, rate );
+    }
+
+    th_free( ref );
+    th_free( bits );
+    th_free( slices_out );
+    th_free( slices );
+}
+#endif
+
 /*------------------------------------------------------------------------------
  * FUNC   : t_run_test
  *
@@ -151,14 +432,11 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 	e_u8          *DataBits,*BranchWords;
 	e_u8         (*CodeMatrix)[MAX_CODE_VECTORS];
 	e_s16        i,DataByteSize,CodeIndex,NumberCodeVectors,ConstraintLength;
+#if	TH_DATA_FILES
+	size_t       n, golden_size, Blocks, Block;
+#endif
 
 	const char		*outFilename;
-#if		!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
-	e_s8		*out_symbol_buffer; 
-	e_s8        *stringHeadPtr;  /* changed for compatibility arw 2-14-00 */
-	n_char		*tmp_buf;
-	e_s16		TempVal;
-#endif
 
    /* Rate 1/2, Constraint Length 3, Free Distance 5  Convolutional Code */
    e_u8 CM_ONE[3][2] = {{1,1},
@@ -186,7 +464,21 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 	NumberCodeVectors = 0;
 	ConstraintLength = 0;
 
+#if	TH_DATA_FILES
+   /* The data set comes from files, up to MAX_DATA_SIZE_BYTES input bits and
+    * the golden rate 1/2 code words for them, or a stream of blocks of
+    * MAX_DATA_SIZE_BYTES bits, one encoded per iteration
+    */
+   	DataBits      = (e_u8 *)th_get_data_file( TH_DATA_INPUT, INFILENAME, sizeof(e_u8), &n );
+   	golden_result = (e_u8 *)th_get_data_file( TH_DATA_GOLDEN, REFFILENAME, sizeof(e_u8), &golden_size );
+	if ( ( n > MAX_DATA_SIZE_BYTES && n % MAX_DATA_SIZE_BYTES != 0 ) || golden_size < 2 * n )
+		th_exit( THE_BAD_SIZE, "Data set of %ld bits with %ld golden bits does not fit",
+			(long)n, (long)golden_size );
+	Blocks        = n > MAX_DATA_SIZE_BYTES ? n / MAX_DATA_SIZE_BYTES : 1;
+	DataByteSize  = (e_s16)( n / Blocks );
+#else
    	golden_result = (e_u8 *)&test_buf;
+#endif
 
    t_buf = th_malloc( T_BSIZE );
    if ( t_buf == NULL )
@@ -194,14 +486,16 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
       }
 
+#if	!TH_DATA_FILES
 	/* When this is defined no file uploading necesary
 	 * we have all the data in the executable
 	 * so initialising is simplier
 	 */ 
     DataBits     = (e_u8 *)&input_buf; 
+    DataByteSize =  MAX_DATA_SIZE_BYTES;
+#endif
     BranchWords  = (e_u8 *)t_buf;
     CodeMatrix   = (e_u8 (*)[2])(BranchWords+(MAX_DATA_SIZE_BYTES));
-    DataByteSize =  MAX_DATA_SIZE_BYTES;
 
     if (argc < 2)
 	{
@@ -237,28 +531,46 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
     * This is the actual benchmark
     *---------------------------------------------------------------------------*/
 
+   th_latency_begin( iterations );
    th_signal_start();  /* Tell the host that the test has begun */
 
    for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
      {
+#if	TH_DATA_FILES
+       convolutionalEncode(DataBits + ( loop_cnt % Blocks ) * DataByteSize,
+			   DataByteSize, NumberCodeVectors,
+			   ConstraintLength, CodeMatrix,
+			   BranchWords
+			   );
+#else
        convolutionalEncode(DataBits, DataByteSize, NumberCodeVectors,
 			   ConstraintLength, CodeMatrix,
 			   BranchWords
 			   );
+#endif
+       th_latency_mark();
      } /* end for */
 
    results.duration   = th_signal_finished();  /* signal that we are finished */
+
+#if	TH_DATA_FILES
+   /* Check, and bench further, the block of the last iteration */
+   Block          = iterations > 0 ? ( iterations - 1 ) % Blocks : 0;
+   DataBits      += Block * DataByteSize;
+   golden_result += Block * NumberCodeVectors * DataByteSize;
+#endif
    results.iterations = iterations;
    results.v1         = 0;
    results.v2         = 0;
    results.v3         = 0;
    results.v4         = 0;
    results.info       = info;
+   results.verify_snr = FALSE;
 
    th_sprintf( info, "A note of basic info" );
 
 #if	NON_INTRUSIVE_CRC_CHECK
-	results.CRC = 0;
+	results.CRC = Calc_crc_buf( BranchWords, (size_t)(NumberCodeVectors*DataByteSize), 0 );
 #elif	CRC_CHECK
 	results.CRC=0;
 #else
@@ -266,9 +578,6 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 #endif
 		/* Verification */ 
     for( i=0; i<NumberCodeVectors*DataByteSize; i++ ){
-#if	NON_INTRUSIVE_CRC_CHECK
-	  results.CRC = Calc_crc8(BranchWords[i],results.CRC);
-#endif
       if(BranchWords[i] != golden_result[i])
 	  {
         th_printf("%x: Failed at[%d] calculated(%d) != golden(%d)\n",results.CRC,i,BranchWords[i],golden_result[i]);
@@ -283,34 +592,26 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 #endif
 	}
 
-#if		!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
-   /* Calculate the size of the output buffer */ 
-   TempVal   = 0;             /* reuse this variable as a counter */ 
-   tmp_buf   = (n_char *)th_malloc(16); /* should acommodate largest single token */
-   if( tmp_buf == NULL )
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+#if		CONV_PACKED_BENCH
+	packed_bench( iterations, DataBits, DataByteSize, NumberCodeVectors,
+	              ConstraintLength, CodeMatrix, BranchWords );
+#endif
+#if		CONV_STREAM_BENCH
+	stream_bench( iterations, DataBits, DataByteSize, NumberCodeVectors,
+	              ConstraintLength, CodeMatrix, BranchWords );
+#endif
+#if		CONV_SLICED_BENCH
+	sliced_bench( iterations, DataBits, DataByteSize, NumberCodeVectors,
+	              ConstraintLength, CodeMatrix );
+#endif
 
+#if		!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
+   /* Stream the output to the host as it is formatted */
+   th_file_begin( outFilename );
    for( i=0; i<NumberCodeVectors*DataByteSize; i++ ){
-       TempVal += th_sprintf( tmp_buf, " %d\n", BranchWords[i]);
+       th_file_printf( " %d\n", BranchWords[i]);
    }
-
-   th_free(tmp_buf); 
-
-   /* Uploading is different as well,
-    * Since we do not have input buffer, we need to 
-	* use one of our own 
-    */ 
-
-    out_symbol_buffer  = (e_s8 *)th_malloc(TempVal+1);
-	if( out_symbol_buffer == NULL )
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
-
-    stringHeadPtr = out_symbol_buffer; 
-    for( i=0; i<NumberCodeVectors*DataByteSize; i++ ){
-       stringHeadPtr += th_sprintf((char *) stringHeadPtr, " %d\n", BranchWords[i]);
-    }
-    th_send_buf_as_file((char *)out_symbol_buffer,TempVal,outFilename);
-
+   th_file_end();
 #endif
 
 		return th_report_results( &results, EXPECTED_CRC );
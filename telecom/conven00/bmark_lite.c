@@ -64,7 +64,8 @@ TCDef the_tcdef =
 	0,
 	0,
 	0,
-	0
+	0,
+	FALSE
 }; 
 
 static n_char* t_buf = NULL;
@@ -73,7 +74,7 @@ static n_char* t_buf = NULL;
 #if defined( DATA_1 )
 #define MAX_DATA_SIZE_BYTES 512  /* this is the actual file size */ 
 #define OUTFILENAME "xk5r2diOutput.dat"
-static  e_u8 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_u8 input_buf[] = {
 #include "xk5r2di.dat"
 };
 static e_u8 test_buf[] = { 
@@ -84,7 +85,7 @@ static e_u8 test_buf[] = {
 
 #define MAX_DATA_SIZE_BYTES 512  /* this is the actual file size */ 
 #define OUTFILENAME "xk4r2diOutput.dat"
-static  e_u8 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_u8 input_buf[] = {
 #include "xk4r2di.dat"
 };
 static e_u8 test_buf[] = { 
@@ -95,7 +96,7 @@ static e_u8 test_buf[] = {
 
 #define MAX_DATA_SIZE_BYTES 512  /* this is the actual file size */ 
 #define OUTFILENAME "xk3r2diOutput.dat"
-static  e_u8 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_u8 input_buf[] = {
 #include "xk3r2di.dat"
 };
 static e_u8 test_buf[] = { 
@@ -205,6 +206,7 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
     * This is the actual benchmark
     *---------------------------------------------------------------------------*/
 
+   th_latency_begin( tcdef->rec_iterations );
    th_signal_start();  /* Tell the host that the test has begun */
 
    for ( loop_cnt = 0; loop_cnt < tcdef->rec_iterations; loop_cnt++ )  /* no stopping! */
@@ -213,6 +215,7 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 			   ConstraintLength, CodeMatrix,
 			   BranchWords
 			   );
+       th_latency_mark();
      } /* end for */
 
     tcdef->duration		= th_signal_finished() ;
@@ -220,7 +223,7 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 
 
 #if	NON_INTRUSIVE_CRC_CHECK
-	tcdef->CRC = 0;
+	tcdef->CRC = Calc_crc_buf( BranchWords, (size_t)(NumberCodeVectors*DataByteSize), 0 );
 #elif	CRC_CHECK
 	tcdef->CRC=0;
 #else
@@ -228,9 +231,6 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 #endif
 		/* Verification */ 
     for( i=0; i<NumberCodeVectors*DataByteSize; i++ ){
-#if	NON_INTRUSIVE_CRC_CHECK
-	  tcdef->CRC = Calc_crc8(BranchWords[i],tcdef->CRC);
-#endif
       if(BranchWords[i] != golden_result[i])
 	  {
         th_printf("%x: Failed at[%d] calculated(%d) != golden(%d)\n",tcdef->CRC,i,BranchWords[i],golden_result[i]);
@@ -15,6 +15,100 @@
 /*******************************************************************************
     Functions                                                                   
 *******************************************************************************/
+/*------------------------------------------------------------------------------
+ * FUNC    : ConvParity
+ *
+ * DESC    : The parity of the low 32 bits of x, from the compiler builtin
+ *           under GCC, which uses the parity flag or popcount instruction of
+ *           the target, else by folding into a 16 entry table held in a
+ *           constant
+ *
+ * RETURNS : 0 or 1
+ * ---------------------------------------------------------------------------*/
+static e_u8 ConvParity(e_u32 x)
+{
+#if defined(__GNUC__)
+    return (e_u8)__builtin_parity((unsigned int)(x & 0xffffffffUL));
+#else
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    return (e_u8)((0x6996 >> (x & 0xf)) & 1);
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : ConvGeneratorMasks
+ *
+ * DESC    : 
+ * Compile the CodeMatrix of convolutionalEncode into one generator mask per
+ * code vector, bit SRIndex of Masks[CVIndex] set for
+ * CodeMatrix[SRIndex][CVIndex], to match the integer shift register of
+ * convolutionalEncodeParity.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+void
+ConvGeneratorMasks (
+    e_s16   NumberCodeVectors,                  /* Number of code vectors (n) */
+    e_s16   ConstraintLength,                   /* Constraint Length (K) */
+    e_u8    (*CodeMatrix)[MAX_CODE_VECTORS],    /* Matrix of code vectors (column-wise) */
+    e_u32   *Masks                              /* NumberCodeVectors generator masks */
+)
+{
+    e_s16   SRIndex;
+    e_s16   CVIndex;
+
+    for (CVIndex = 0; CVIndex < NumberCodeVectors; CVIndex++) {
+        Masks[CVIndex] = 0;
+        for (SRIndex = 0; SRIndex < ConstraintLength; SRIndex++) {
+            if ( CodeMatrix[SRIndex][CVIndex] ) {
+                Masks[CVIndex] |= 1UL << SRIndex;
+            }
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : convolutionalEncodeParity
+ *
+ * DESC    : 
+ * convolutionalEncode with the shift register held as an integer, bit j
+ * being ShiftRegister[j], and each branch word the parity of the register
+ * masked by the generator mask of its code vector, from ConvGeneratorMasks.
+ * The cost per bit does not depend on ConstraintLength.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+void
+convolutionalEncodeParity (
+    const e_u8  *DataBits,                      /* Input data 1 bit per byte */
+    e_s16       DataByteSize,                   /* Data size in bytes */
+    e_s16       NumberCodeVectors,              /* Number of code vectors (n) */
+    const e_u32 *Masks,                         /* Generator masks */
+    e_u8        *BranchWords                    /* Output data 1 bit per byte */
+)
+{
+    e_u32   SR = 0;
+    e_u32   Mask0 = Masks[0];
+    e_u32   Mask1 = NumberCodeVectors > 1 ? Masks[1] : 0;
+    e_s16   DIndex;
+
+    /* The masks stop at ConstraintLength, so older bits of SR do not matter */
+    if (NumberCodeVectors == 2) {
+        for (DIndex = 0; DIndex < DataByteSize; DIndex++) {
+            SR = (SR << 1) | DataBits[DIndex];
+            *BranchWords++ = ConvParity(SR & Mask0);
+            *BranchWords++ = ConvParity(SR & Mask1);
+        }
+    } else {
+        for (DIndex = 0; DIndex < DataByteSize; DIndex++) {
+            SR = (SR << 1) | DataBits[DIndex];
+            *BranchWords++ = ConvParity(SR & Mask0);
+        }
+    }
+}
+
 /*------------------------------------------------------------------------------
  * FUNC    : convolutionalEncode
  *
@@ -45,6 +139,13 @@ convolutionalEncode (
     e_s16   DIndex;
     e_s16   CVIndex;
     e_u8    ShiftRegister[MAX_CONSTRAINT_LENGTH];
+#if CONV_PARITY
+    e_u32   Masks[MAX_CODE_VECTORS];
+
+    ConvGeneratorMasks(NumberCodeVectors, ConstraintLength, CodeMatrix, Masks);
+    convolutionalEncodeParity(DataBits, DataByteSize, NumberCodeVectors, Masks, BranchWords);
+    return;
+#endif
 
     /* Initializations */
     for (SRIndex = 0; SRIndex < ConstraintLength; SRIndex++) {
@@ -78,3 +179,379 @@ convolutionalEncode (
         } /* end CVIndex for */
     } /* end DIndex for */
 }
+
+/*
+ * ConvEncodeTable: the branch words of every input byte from every state,
+ * for the packed encoders. The shift register is an integer, bit j being
+ * ShiftRegister[j] of convolutionalEncode, so the state before an input
+ * byte is its last ConstraintLength-1 bits and the state after it the low
+ * bits of (State << 8) | Byte. Output[State][Byte] holds the
+ * 8 * NumberCodeVectors branch word bits of the byte, first bit highest.
+ */
+struct ConvEncodeTable {
+    n_int   NumberCodeVectors;  /* n */
+    n_int   ConstraintLength;   /* K */
+    e_u16   *Output;            /* 2**(K-1) states by 256 bytes */
+};
+
+/*------------------------------------------------------------------------------
+ * FUNC    : ConvEncodeTableInit
+ *
+ * DESC    : 
+ * Build the table of the convolutional code of convolutionalEncode given
+ * by NumberCodeVectors, ConstraintLength and CodeMatrix, running each byte
+ * through the shift register bit by bit with the generator masks.
+ *
+ * RETURNS : The table, or NULL on out of memory
+ * ---------------------------------------------------------------------------*/
+ConvEncodeTable *
+ConvEncodeTableInit (
+    e_s16   NumberCodeVectors,                  /* Number of code vectors (n) */
+    e_s16   ConstraintLength,                   /* Constraint Length (K) */
+    e_u8    (*CodeMatrix)[MAX_CODE_VECTORS]     /* Matrix of code vectors (column-wise) */
+)
+{
+    ConvEncodeTable *t;
+    n_int           States = 1 << (ConstraintLength - 1);
+    n_int           State, DataByte, Bit, CVIndex;
+    e_u32           Masks[MAX_CODE_VECTORS];
+    e_u32           SR;
+    e_u16           Branches;
+
+    t = (ConvEncodeTable *)th_malloc(sizeof(ConvEncodeTable));
+    if (t == NULL)
+        return NULL;
+    t->NumberCodeVectors = NumberCodeVectors;
+    t->ConstraintLength = ConstraintLength;
+    t->Output = (e_u16 *)th_malloc((size_t)States * 256 * sizeof(e_u16));
+    if (t->Output == NULL) {
+        th_free(t);
+        return NULL;
+    }
+
+    ConvGeneratorMasks(NumberCodeVectors, ConstraintLength, CodeMatrix, Masks);
+    for (State = 0; State < States; State++) {
+        for (DataByte = 0; DataByte < 256; DataByte++) {
+            SR = (e_u32)State;
+            Branches = 0;
+            for (Bit = 7; Bit >= 0; Bit--) {
+                SR = (SR << 1) | ((DataByte >> Bit) & 1);
+                for (CVIndex = 0; CVIndex < NumberCodeVectors; CVIndex++)
+                    Branches = (e_u16)((Branches << 1) | ConvParity(SR & Masks[CVIndex]));
+            }
+            t->Output[State * 256 + DataByte] = Branches;
+        }
+    }
+    return t;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : ConvEncodeTableFree
+ *
+ * DESC    : Release a table from ConvEncodeTableInit. NULL is ignored.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void ConvEncodeTableFree(ConvEncodeTable *t)
+{
+    if (t == NULL)
+        return;
+    th_free(t->Output);
+    th_free(t);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : convolutionalEncodePacked
+ *
+ * DESC    : 
+ * convolutionalEncode of DataByteCount bytes of 8 input bits each, first
+ * bit highest, into NumberCodeVectors bytes of branch word bits per input
+ * byte, in the order of convolutionalEncode and packed the same way. The
+ * shift register starts at zero, as in convolutionalEncode.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+void
+convolutionalEncodePacked (
+    const ConvEncodeTable   *t,                 /* code table */
+    const e_u8              *DataBytes,         /* Input data 8 bits per byte */
+    e_s32                   DataByteCount,      /* Data size in bytes */
+    e_u8                    *BranchBytes        /* Output data 8 bits per byte */
+)
+{
+    const e_u16 *Output = t->Output;
+    e_u32       StateMask = (1UL << (t->ConstraintLength - 1)) - 1;
+    e_u32       SR = 0;
+    e_u16       Branches;
+    e_s32       DIndex;
+
+    if (t->NumberCodeVectors == 2) {
+        for (DIndex = 0; DIndex < DataByteCount; DIndex++) {
+            Branches = Output[(SR << 8) | DataBytes[DIndex]];
+            SR = ((SR << 8) | DataBytes[DIndex]) & StateMask;
+            *BranchBytes++ = (e_u8)(Branches >> 8);
+            *BranchBytes++ = (e_u8)Branches;
+        }
+    } else {
+        for (DIndex = 0; DIndex < DataByteCount; DIndex++) {
+            *BranchBytes++ = (e_u8)Output[(SR << 8) | DataBytes[DIndex]];
+            SR = ((SR << 8) | DataBytes[DIndex]) & StateMask;
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : convolutionalEncodeWords
+ *
+ * DESC    : 
+ * convolutionalEncodePacked of 32 input bits per word, first bit highest,
+ * into NumberCodeVectors words of branch word bits per input word. Only
+ * the low 32 bits of each e_u32 are used.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+void
+convolutionalEncodeWords (
+    const ConvEncodeTable   *t,                 /* code table */
+    const e_u32             *DataWords,         /* Input data 32 bits per word */
+    e_s32                   DataWordCount,      /* Data size in words */
+    e_u32                   *BranchWords        /* Output data 32 bits per word */
+)
+{
+    const e_u16 *Output = t->Output;
+    e_u32       StateMask = (1UL << (t->ConstraintLength - 1)) - 1;
+    n_int       Width = 8 * t->NumberCodeVectors;
+    e_u32       SR = 0;
+    e_u32       In, DataByte, Acc;
+    e_s32       DIndex;
+    n_int       Shift, Bits;
+
+    for (DIndex = 0; DIndex < DataWordCount; DIndex++) {
+        In = DataWords[DIndex];
+        Acc = 0;
+        Bits = 0;
+        for (Shift = 24; Shift >= 0; Shift -= 8) {
+            DataByte = (In >> Shift) & 0xff;
+            Acc = (Acc << Width) | Output[(SR << 8) | DataByte];
+            SR = ((SR << 8) | DataByte) & StateMask;
+            if ((Bits += Width) == 32) {
+                *BranchWords++ = Acc & 0xffffffffUL;
+                Acc = 0;
+                Bits = 0;
+            }
+        }
+    }
+}
+
+/*
+ * ConvEncoder: the state convolutionalEncode keeps for one call, kept from
+ * one ConvEncoderPush to the next: the shift register, as in
+ * convolutionalEncodeParity, and the position in the puncturing pattern.
+ */
+struct ConvEncoder {
+    n_int   NumberCodeVectors;          /* n */
+    e_u32   Masks[MAX_CODE_VECTORS];    /* generator masks */
+    e_u32   SR;                         /* shift register */
+    e_u8    *Puncture;                  /* n * PuncturePeriod keep flags, or NULL */
+    n_int   PuncturePeriod;             /* input bits per pattern */
+    n_int   Phase;                      /* input bit of the pattern next */
+};
+
+/*------------------------------------------------------------------------------
+ * FUNC    : ConvEncoderInit
+ *
+ * DESC    : 
+ * Create an encoder for the code of convolutionalEncode given by
+ * NumberCodeVectors, ConstraintLength and CodeMatrix. Puncture, unless
+ * NULL, holds NumberCodeVectors keep flags for each of PuncturePeriod
+ * input bits, in branch word order: branch word CVIndex of input bit p of
+ * each period is sent when Puncture[p * NumberCodeVectors + CVIndex] is
+ * not 0. The encoder starts reset.
+ *
+ * RETURNS : The encoder, or NULL on out of memory
+ * ---------------------------------------------------------------------------*/
+ConvEncoder *
+ConvEncoderInit (
+    e_s16       NumberCodeVectors,              /* Number of code vectors (n) */
+    e_s16       ConstraintLength,               /* Constraint Length (K) */
+    e_u8        (*CodeMatrix)[MAX_CODE_VECTORS],/* Matrix of code vectors (column-wise) */
+    const e_u8  *Puncture,                      /* keep flags, or NULL */
+    n_int       PuncturePeriod                  /* input bits per pattern */
+)
+{
+    ConvEncoder *enc;
+    n_int       i;
+
+    enc = (ConvEncoder *)th_malloc(sizeof(ConvEncoder));
+    if (enc == NULL)
+        return NULL;
+    enc->NumberCodeVectors = NumberCodeVectors;
+    ConvGeneratorMasks(NumberCodeVectors, ConstraintLength, CodeMatrix, enc->Masks);
+    enc->Puncture = NULL;
+    enc->PuncturePeriod = 1;
+    if (Puncture != NULL) {
+        enc->Puncture = (e_u8 *)th_malloc(NumberCodeVectors * PuncturePeriod);
+        if (enc->Puncture == NULL) {
+            th_free(enc);
+            return NULL;
+        }
+        for (i = 0; i < NumberCodeVectors * PuncturePeriod; i++)
+            enc->Puncture[i] = Puncture[i];
+        enc->PuncturePeriod = PuncturePeriod;
+    }
+    ConvEncoderReset(enc);
+    return enc;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : ConvEncoderFree
+ *
+ * DESC    : Release an encoder from ConvEncoderInit. NULL is ignored.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void ConvEncoderFree(ConvEncoder *enc)
+{
+    if (enc == NULL)
+        return;
+    if (enc->Puncture != NULL)
+        th_free(enc->Puncture);
+    th_free(enc);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : ConvEncoderReset
+ *
+ * DESC    : Clear the shift register, as at the start of convolutionalEncode,
+ *           and start the puncturing pattern again
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void ConvEncoderReset(ConvEncoder *enc)
+{
+    enc->SR = 0;
+    enc->Phase = 0;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : ConvEncoderPush
+ *
+ * DESC    : 
+ * Encode DataByteSize more input bits, 1 bit per byte, continuing from the
+ * state the last call left, into the branch words the puncturing pattern
+ * keeps, 1 bit per byte. Without puncturing, the branch words of a frame
+ * pushed in any number of pieces are those of convolutionalEncode of the
+ * whole frame. BranchWords needs room for NumberCodeVectors words per
+ * input bit even when punctured. To flush the register at the end of a frame, push
+ * ConstraintLength-1 zero bits.
+ *
+ * RETURNS : The number of branch words written
+ * ---------------------------------------------------------------------------*/
+n_int
+ConvEncoderPush (
+    ConvEncoder *enc,                           /* encoder */
+    const e_u8  *DataBits,                      /* Input data 1 bit per byte */
+    n_int       DataByteSize,                   /* Data size in bytes */
+    e_u8        *BranchWords                    /* Output data 1 bit per byte */
+)
+{
+    const e_u8  *Keep;
+    e_u8        *Out = BranchWords;
+    e_u32       SR = enc->SR;
+    n_int       n = enc->NumberCodeVectors;
+    n_int       Phase = enc->Phase;
+    n_int       DIndex, CVIndex;
+
+    if (enc->Puncture == NULL) {
+        for (DIndex = 0; DIndex < DataByteSize; DIndex++) {
+            SR = (SR << 1) | DataBits[DIndex];
+            for (CVIndex = 0; CVIndex < n; CVIndex++)
+                *Out++ = ConvParity(SR & enc->Masks[CVIndex]);
+        }
+    } else {
+        for (DIndex = 0; DIndex < DataByteSize; DIndex++) {
+            SR = (SR << 1) | DataBits[DIndex];
+            Keep = enc->Puncture + Phase * n;
+            for (CVIndex = 0; CVIndex < n; CVIndex++) {
+                /* Always store, keep by moving on */
+                *Out = ConvParity(SR & enc->Masks[CVIndex]);
+                Out += Keep[CVIndex] != 0;
+            }
+            if (++Phase == enc->PuncturePeriod)
+                Phase = 0;
+        }
+    }
+
+    enc->SR = SR;
+    enc->Phase = Phase;
+    return (n_int)(Out - BranchWords);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : convolutionalEncodeSliced
+ *
+ * DESC    : 
+ * convolutionalEncode of up to 32 * SliceWords independent streams at once,
+ * bit sliced: bit i of DataSlices[t * SliceWords + w] is input bit t of
+ * stream 32 * w + i, and bit i of BranchSlices[(t * NumberCodeVectors +
+ * CVIndex) * SliceWords + w] the branch word CVIndex of that bit. A branch
+ * word is the XOR of the input bits the code vector taps, so each slice of
+ * branch words is the XOR of the tapped slices of the last
+ * ConstraintLength steps, for all the streams of a word in one operation.
+ * As in convolutionalEncode, every stream starts from a cleared register.
+ * Only the low 32 bits of each e_u32 carry streams.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+void
+convolutionalEncodeSliced (
+    const e_u32 *DataSlices,                    /* Input data 1 bit per stream */
+    n_int       SliceWords,                     /* words per step */
+    e_s16       DataByteSize,                   /* Data size in steps */
+    e_s16       NumberCodeVectors,              /* Number of code vectors (n) */
+    e_s16       ConstraintLength,               /* Constraint Length (K) */
+    e_u8        (*CodeMatrix)[MAX_CODE_VECTORS],/* Matrix of code vectors (column-wise) */
+    e_u32       *BranchSlices                   /* Output data 1 bit per stream */
+)
+{
+    n_int       Taps[MAX_CODE_VECTORS][MAX_CONSTRAINT_LENGTH];
+    n_int       NumTaps[MAX_CODE_VECTORS];
+    const e_u32 *In;
+    e_u32       Acc;
+    e_s16       DIndex, SRIndex, CVIndex;
+    n_int       w, k;
+
+    /* Slice offset of each tap, from the newest bit back */
+    for (CVIndex = 0; CVIndex < NumberCodeVectors; CVIndex++) {
+        NumTaps[CVIndex] = 0;
+        for (SRIndex = 0; SRIndex < ConstraintLength; SRIndex++) {
+            if ( CodeMatrix[SRIndex][CVIndex] ) {
+                Taps[CVIndex][NumTaps[CVIndex]++] = SRIndex * SliceWords;
+            }
+        }
+    }
+
+    for (DIndex = 0; DIndex < DataByteSize; DIndex++) {
+        In = DataSlices + (long)DIndex * SliceWords;
+        for (CVIndex = 0; CVIndex < NumberCodeVectors; CVIndex++) {
+            if (DIndex >= ConstraintLength - 1) {
+                for (w = 0; w < SliceWords; w++) {
+                    Acc = 0;
+                    for (k = 0; k < NumTaps[CVIndex]; k++)
+                        Acc ^= In[w - Taps[CVIndex][k]];
+                    BranchSlices[w] = Acc;
+                }
+            } else {
+                /* Taps before the first step read the cleared register */
+                for (w = 0; w < SliceWords; w++) {
+                    Acc = 0;
+                    for (k = 0; k < NumTaps[CVIndex]; k++)
+                        if (Taps[CVIndex][k] <= DIndex * SliceWords)
+                            Acc ^= In[w - Taps[CVIndex][k]];
+                    BranchSlices[w] = Acc;
+                }
+            }
+            BranchSlices += SliceWords;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/**
+ *
+ * Copyright (C) EEMBC(R) All Rights Reserved
+ *
+ * This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+ * Please refer to the license file (LICENSE.md) included with this code.
+ *
+ */
+
+/*******************************************************************
+*
+
+This program converts a .dat data set file, the comma separated C
+initializer the benchmarks #include, to the binary file a benchmark built
+with TH_DATA_FILES reads.  The binary file holds the values in the layout
+of the host it runs on, so build and run it for the target's byte order
+and floating point format.
+
+Execution:  dat2bin [s16|u8|f64] [.dat file] [binary file]
+
+The type is that of the benchmark's array:
+
+autcor00  input s16  golden f64
+conven00  input u8   golden u8
+fbital00  input s16  golden s16
+fft00     input s16  golden f64
+viterb00  input s16  golden s16
+
+Integer values may be decimal or 0x hex.  Hex values of 16 bits are
+stored as they are, the way the compiler stores them in an e_s16 array.
+
+E.g. to run an autcor00 image built with TH_DATA_FILES on the pulse data
+set:
+
+   dat2bin s16 autcor00/datasets/xpulsei.dat xpulsei.bin
+   dat2bin f64 autcor00/datasets/vpulseai.dat vpulseai.bin
+   autcor00data_1.exe -data=. -autogo
+
+
+***************************************************************************************/
+
+#include <stdio.h>  /* FILE definition */
+#include <stdlib.h> /* strtol, strtod, exit definitions */
+#include <string.h> /* strcmp */
+#include <ctype.h>  /* isspace */
+
+int main (int argc, char *argv[])
+{
+	FILE		*InFile, *OutFile;
+	char		InString[256];
+	char		*s, *end;
+	long		IntVal;
+	double		RealVal;
+	short		S16Val;
+	unsigned char	U8Val;
+	int			Type, Count = 0;
+
+	/* Check arguments */
+
+	if (argc != 4 ||
+		((Type = strcmp(argv[1],"s16") == 0 ? 1 : strcmp(argv[1],"u8") == 0 ? 2 :
+		          strcmp(argv[1],"f64") == 0 ? 3 : 0) == 0)){
+		printf("ERROR: Incorrect arguments\n");
+		printf("  Usage: dat2bin s16|u8|f64 datfile binfile\n");
+		printf("     Exiting...");
+		return 1;
+	}
+	if ((InFile = fopen(argv[2],"r")) == NULL){
+		printf("ERROR: Cannot open %s\n  Exiting...\n",argv[2]);
+		return 1;
+	}
+	if ((OutFile = fopen(argv[3],"wb")) == NULL){
+		printf("ERROR: Cannot open %s\n  Exiting...\n",argv[3]);
+		return 1;
+	}
+
+	/* Every value is followed by a comma, a space or the end of a line */
+
+	while (fgets(InString,sizeof(InString),InFile) != NULL){
+		for (s = InString; *s != '\0'; s = end){
+			while (isspace((unsigned char)*s) || *s == ',')	s++;
+			if (*s == '\0')		break;
+
+			if (Type == 3){
+				RealVal = strtod(s, &end);
+				if (end != s)
+					fwrite(&RealVal, sizeof(RealVal), 1, OutFile);
+			} else {
+				IntVal = strtol(s, &end, 0);
+				if (Type == 1){
+					S16Val = (short)(IntVal > 0x7FFF ? IntVal - 0x10000L : IntVal);
+					if (end != s)
+						fwrite(&S16Val, sizeof(S16Val), 1, OutFile);
+				} else {
+					U8Val = (unsigned char)IntVal;
+					if (end != s)
+						fwrite(&U8Val, sizeof(U8Val), 1, OutFile);
+				}
+			}
+			if (end == s){
+				printf("ERROR: Bad value '%.16s' in %s\n  Exiting...\n",s,argv[2]);
+				return 1;
+			}
+			Count++;
+		}
+	}
+
+	fclose(InFile);
+	if (fclose(OutFile) != 0){
+		printf("ERROR: Cannot write %s\n  Exiting...\n",argv[3]);
+		return 1;
+	}
+	printf("%d values\n",Count);
+	return 0;
+}
@@ -0,0 +1,406 @@
+/**
+ *
+ * Copyright (C) EEMBC(R) All Rights Reserved
+ *
+ * This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+ * Please refer to the license file (LICENSE.md) included with this code.
+ *
+ */
+
+/*******************************************************************
+*
+
+This program generates a synthetic data set of any size for one of the
+telecom kernels, the input and the reference output a benchmark built
+with TH_DATA_FILES reads (see dat2bin for the binary layout).  The input
+is random for a given seed, so the same arguments give the same files on
+every host.  The reference output comes from a plain, slow implementation
+of what the kernel computes, not from the kernel itself.
+
+Execution:
+
+   datagen autcor [samples] [lags] [seed] [input] [reference]
+   datagen conven [bits] [code 1-3] [seed] [input] [reference]
+   datagen fbital [carriers] [bits per symbol] [seed] [allocmapi.dat] [input] [reference]
+   datagen fft    [blocks] [f|r] [seed] [input] [reference]
+   datagen viterb [packets] [seed] [input] [reference]
+
+autcor00  Low pass noise of up to 16384 samples, and its autocorrelation
+          for lags 0 .. lags-1 in double precision.
+conven00  Random bits, and their rate 1/2 code words for the code index
+          the benchmark is run with, from a shift register.  More than 512
+          bits must be a multiple of 512, each 512 encoded on their own.
+fbital00  A random SNR profile of up to 32767 carriers, and the
+          allocation of the benchmark's stepped water level search.  The
+          search stalls when a step rounds to zero, so a budget it cannot
+          reach is moved to the nearest one it does, printed to pass the
+          benchmark as its bits per DMT symbol.
+fft00     Blocks of 256 points of random tones in noise, and the transform
+          of each: the DFT of the fft00 half-step twiddles (see
+          autcor00.c), forward or reverse.
+viterb00  Packets of 339 random bits, flushed with 5 zeros, as the hard
+          decision IS-136 branch words, and the payloads they decode to.
+
+The floating point references hold the shape only, which is all
+diffmeasure compares.  The benchmarks stream through a data set of more
+than one block, conven00, fft00 and viterb00 a block per iteration, so
+large data sets give cache scaling curves.
+
+E.g. to run viterb00 over 2048 packets, 1.4 MB of branch words:
+
+   datagen viterb 2048 1 pkts.bin pkts_golden.bin
+   viterb00data_1.exe -data=. -in=pkts.bin -ref=pkts_golden.bin -autogo
+
+
+***************************************************************************************/
+
+#include <stdio.h>  /* FILE definition */
+#include <stdlib.h> /* strtol, malloc, exit definitions */
+#include <string.h> /* strcmp */
+#include <ctype.h>  /* isspace */
+#include <math.h>   /* sin, cos, sqrt, log */
+
+#define PI					3.14159265358979323846
+
+#define CONV_BLOCK_BITS		512		/* conven00 MAX_DATA_SIZE_BYTES */
+#define FFT_POINTS			256		/* fft00 MAX_FFT_SIZE */
+#define VITERBI_BITS		344		/* viterb00 MAX_DATA_SIZE */
+#define VITERBI_WORDS		(VITERBI_BITS/16+1)
+#define VITERBI_FLUSH		5
+#define ALLOCATION_MAP_SIZE	512
+#define MAX_BITS_PER_CARRIER	12
+#define STEP_SIZE			51
+#define MAX_PASSES			1000	/* passes before a search counts as stalled */
+#define MAX_BUDGETS			1000	/* budgets tried each side of the one asked for */
+
+static unsigned long Seed;
+
+/* Linear congruential generator, 15 random bits per call */
+static int Random(void)
+{
+	Seed = (Seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+	return (int)((Seed >> 16) & 0x7fff);
+}
+
+/* Unit normal, Box-Muller */
+static double Gauss(void)
+{
+	double	u1, u2;
+
+	u1 = (Random() + 1.0) / 32768.0;
+	u2 = Random() / 32768.0;
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * PI * u2);
+}
+
+static short Clip(double x)
+{
+	return (short)(x > 32767.0 ? 32767 : x < -32768.0 ? -32768 : (long)floor(x + 0.5));
+}
+
+static void *Alloc(long n, size_t size)
+{
+	void	*p = malloc((size_t)n * size);
+
+	if (p == NULL){
+		printf("ERROR: Cannot allocate %ld values\n  Exiting...\n", n);
+		exit(1);
+	}
+	return p;
+}
+
+static void WriteFile(const char *fn, const void *buf, size_t size, long n)
+{
+	FILE	*OutFile;
+
+	if ((OutFile = fopen(fn,"wb")) == NULL){
+		printf("ERROR: Cannot open %s\n  Exiting...\n",fn);
+		exit(1);
+	}
+	if (fwrite(buf, size, (size_t)n, OutFile) != (size_t)n || fclose(OutFile) != 0){
+		printf("ERROR: Cannot write %s\n  Exiting...\n",fn);
+		exit(1);
+	}
+	printf("%s: %ld values\n",fn,n);
+}
+
+/* autcor00: first order low pass noise and its autocorrelation */
+static void GenAutcor(long Samples, long Lags, const char *InFn, const char *RefFn)
+{
+	short	*x = (short *)Alloc(Samples, sizeof(short));
+	double	*r = (double *)Alloc(Lags, sizeof(double));
+	double	y = 0.0;
+	long	i, lag;
+
+	for (i = 0; i < Samples; i++){
+		y = 0.9 * y + 0.436 * Gauss();	/* unit variance */
+		x[i] = Clip(4096.0 * y);
+	}
+	for (lag = 0; lag < Lags; lag++){
+		r[lag] = 0.0;
+		for (i = 0; i + lag < Samples; i++)
+			r[lag] += (double)x[i] * x[i+lag];
+	}
+	WriteFile(InFn, x, sizeof(short), Samples);
+	WriteFile(RefFn, r, sizeof(double), Lags);
+}
+
+/* conven00: the codes of CM_ONE, CM_TWO and CM_THREE in bmark.c,
+ * CodeMatrix[SRIndex][CVIndex], ShiftRegister[0] the newest bit */
+static const unsigned char CodeMatrices[3][5][2] = {
+	{{1,1},{1,0},{1,1}},
+	{{1,1},{1,0},{1,1},{1,1}},
+	{{1,1},{0,1},{1,0},{1,0},{1,1}}
+};
+
+static void GenConven(long Bits, int Code, const char *InFn, const char *RefFn)
+{
+	unsigned char	*x = (unsigned char *)Alloc(Bits, 1);
+	unsigned char	*y = (unsigned char *)Alloc(2 * Bits, 1);
+	unsigned char	sr[5];
+	int				K = Code + 2, j, cv;
+	long			i;
+
+	for (i = 0; i < Bits; i++)
+		x[i] = (unsigned char)(Random() & 1);
+	for (i = 0; i < Bits; i++){
+		/* Each block starts from a clear shift register */
+		if (i % CONV_BLOCK_BITS == 0)
+			for (j = 0; j < K; j++)	sr[j] = 0;
+		for (j = K-1; j > 0; j--)	sr[j] = sr[j-1];
+		sr[0] = x[i];
+		for (cv = 0; cv < 2; cv++){
+			y[2*i+cv] = 0;
+			for (j = 0; j < K; j++)
+				if (CodeMatrices[Code-1][j][cv])	y[2*i+cv] ^= sr[j];
+		}
+	}
+	WriteFile(InFn, x, 1, Bits);
+	WriteFile(RefFn, y, 1, 2 * Bits);
+}
+
+/* fbital00: AllocateCarriers and the stepped search of fxpBitAllocationStats,
+ * with the benchmark's integer types */
+static long Allocate(const short *snr, short *bits, long n, short level,
+                     const short *map, long budget)
+{
+	long	total = 0, b, delta, i;
+
+	for (i = 0; i < n; i++){
+		delta = snr[i] - level;
+		if (delta < 0)
+			b = 0;
+		else {
+			b = delta > 32767 ? MAX_BITS_PER_CARRIER : map[delta >> 6];
+			if (b + total > budget)	b = budget - total;
+		}
+		bits[i] = (short)b;
+		total += b;
+	}
+	return total;
+}
+
+/* The passes the search takes, 0 if it stalls, a step of zero short of the
+ * budget repeating forever */
+static long SteppedSearch(const short *snr, short *bits, long n, short start,
+                          const short *map, long budget)
+{
+	unsigned short	total;
+	short			level = start, last;
+	long			passes = 0;
+
+	do {
+		total = (unsigned short)Allocate(snr, bits, n, level, map, budget);
+		passes++;
+		last = level;
+		level = (short)(level + (long)STEP_SIZE * 3 *
+		                ((short)total - (short)budget) / (short)n);
+	} while (total != budget && level != last && passes < MAX_PASSES);
+	return total == budget ? passes : 0;
+}
+
+static void GenFbital(long Carriers, long Budget, const char *MapFn,
+                      const char *InFn, const char *RefFn)
+{
+	short	*snr = (short *)Alloc(Carriers, sizeof(short));
+	short	*bits = (short *)Alloc(Carriers, sizeof(short));
+	short	map[ALLOCATION_MAP_SIZE], start = -32768;
+	FILE	*InFile;
+	char	InString[256], *s, *end;
+	double	level;
+	long	i, n = 0, passes = 0, b, tries, limit;
+
+	/* The allocation map, limited as the benchmark does */
+	if ((InFile = fopen(MapFn,"r")) == NULL){
+		printf("ERROR: Cannot open %s\n  Exiting...\n",MapFn);
+		exit(1);
+	}
+	while (n < ALLOCATION_MAP_SIZE && fgets(InString,sizeof(InString),InFile) != NULL){
+		for (s = InString; n < ALLOCATION_MAP_SIZE; s = end){
+			while (isspace((unsigned char)*s) || *s == ',')	s++;
+			if (*s == '\0')		break;
+			i = strtol(s, &end, 0);
+			if (end == s){
+				printf("ERROR: Bad value '%.16s' in %s\n  Exiting...\n",s,MapFn);
+				exit(1);
+			}
+			map[n++] = (short)(i > MAX_BITS_PER_CARRIER ? MAX_BITS_PER_CARRIER : i);
+		}
+	}
+	fclose(InFile);
+	if (n != ALLOCATION_MAP_SIZE){
+		printf("ERROR: %s has %ld of %d values\n  Exiting...\n",MapFn,n,ALLOCATION_MAP_SIZE);
+		exit(1);
+	}
+
+	/* A slowly wandering SNR with a few dead carriers at the band edge, in
+	 * steps of 512 like the staircases of the fbital00 data sets: the search
+	 * only reaches the budget exactly when carriers cross a threshold together */
+	level = 8000.0 + Random() % 12000;
+	for (i = 0; i < Carriers; i++){
+		level += 150.0 * Gauss();
+		level = level < 2000.0 ? 2000.0 : level > 30000.0 ? 30000.0 : level;
+		snr[i] = (short)(i < Carriers / 64 ? 0 : 512 * (long)floor(level / 512.0 + 0.5));
+		if (snr[i] > start)		start = snr[i];
+	}
+
+	/* The nearest budget the search reaches, below first */
+	limit = Carriers * MAX_BITS_PER_CARRIER < 32767 ? Carriers * MAX_BITS_PER_CARRIER : 32767;
+	if (Budget <= 0)		Budget = 6 * Carriers;
+	if (Budget > limit)		Budget = limit;
+	for (tries = 0; tries <= 2 * MAX_BUDGETS && passes == 0; tries++){
+		b = tries % 2 == 0 ? Budget - tries / 2 : Budget + tries / 2 + 1;
+		if (b >= 1 && b <= limit)
+			passes = SteppedSearch(snr, bits, Carriers, start, map, b);
+	}
+	Budget = b;
+	if (passes == 0){
+		printf("ERROR: No budget the search reaches, try another seed\n  Exiting...\n");
+		exit(1);
+	}
+	printf("bits per DMT symbol %ld, %ld passes\n", Budget, passes);
+	WriteFile(InFn, snr, sizeof(short), Carriers);
+	WriteFile(RefFn, bits, sizeof(short), Carriers);
+}
+
+/* fft00: random tones, and M point transforms of the half-step twiddles,
+ * forward the DFT of x[n] * exp(-i*pi*popcount(n)/M) */
+static int PopCount(long n)
+{
+	int		c = 0;
+
+	for (; n != 0; n >>= 1)	c += (int)(n & 1);
+	return c;
+}
+
+static void GenFft(long Blocks, int Reverse, const char *InFn, const char *RefFn)
+{
+	long	n = Blocks * FFT_POINTS, b, i, k;
+	short	*x = (short *)Alloc(2 * n, sizeof(short));
+	double	*y = (double *)Alloc(2 * n, sizeof(double));
+	double	f[4], a[4], re, im, p, sign = Reverse ? 1.0 : -1.0;
+	int		t;
+
+	for (b = 0; b < Blocks; b++){
+		for (t = 0; t < 4; t++){
+			f[t] = 2.0 * PI * (Random() % FFT_POINTS) / FFT_POINTS;
+			a[t] = 4000.0 + Random() % 3500;	/* near full scale after the prescale */
+		}
+		for (i = 0; i < FFT_POINTS; i++){
+			re = 300.0 * Gauss();
+			im = 300.0 * Gauss();
+			for (t = 0; t < 4; t++){
+				re += a[t] * cos(f[t] * i);
+				im += a[t] * sin(f[t] * i);
+			}
+			x[2*(b*FFT_POINTS+i)]   = Clip(re);
+			x[2*(b*FFT_POINTS+i)+1] = Clip(im);
+		}
+	}
+	for (b = 0; b < Blocks; b++){
+		for (k = 0; k < FFT_POINTS; k++){
+			re = im = 0.0;
+			for (i = 0; i < FFT_POINTS; i++){
+				p = sign * PI * (PopCount(i) + 2.0 * ((i * k) % FFT_POINTS)) / FFT_POINTS;
+				re += x[2*(b*FFT_POINTS+i)] * cos(p) - x[2*(b*FFT_POINTS+i)+1] * sin(p);
+				im += x[2*(b*FFT_POINTS+i)] * sin(p) + x[2*(b*FFT_POINTS+i)+1] * cos(p);
+			}
+			y[2*(b*FFT_POINTS+k)]   = re;
+			y[2*(b*FFT_POINTS+k)+1] = im;
+		}
+	}
+	WriteFile(InFn, x, sizeof(short), 2 * n);
+	WriteFile(RefFn, y, sizeof(double), 2 * n);
+}
+
+/* viterb00: is136_code_matrix in bmark.c, y0 in bits 5..3 and y1 in
+ * bits 2..0 of a branch word, 4 a hard 0 and 0 a hard 1 */
+static const unsigned char IS136Matrix[6][2] = {
+	{1,1},{1,0},{0,1},{1,1},{0,1},{1,1}
+};
+
+static void GenViterb(long Packets, const char *InFn, const char *RefFn)
+{
+	short			*x = (short *)Alloc(Packets * VITERBI_BITS, sizeof(short));
+	short			*y = (short *)Alloc(Packets * VITERBI_WORDS, sizeof(short));
+	unsigned char	sr[6], c;
+	long			p, i;
+	int				j, cv;
+
+	for (p = 0; p < Packets; p++){
+		for (j = 0; j < 6; j++)		sr[j] = 0;
+		for (i = 0; i < VITERBI_WORDS; i++)	y[p*VITERBI_WORDS+i] = 0;
+		for (i = 0; i < VITERBI_BITS; i++){
+			for (j = 5; j > 0; j--)		sr[j] = sr[j-1];
+			sr[0] = (unsigned char)(i < VITERBI_BITS - VITERBI_FLUSH ? Random() & 1 : 0);
+			if (sr[0])
+				y[p*VITERBI_WORDS+(i>>4)] |= (short)(0x8000 >> (i & 15));
+			x[p*VITERBI_BITS+i] = 0;
+			for (cv = 0; cv < 2; cv++){
+				c = 0;
+				for (j = 0; j < 6; j++)
+					if (IS136Matrix[j][cv])	c ^= sr[j];
+				x[p*VITERBI_BITS+i] |= (short)((c ? 0 : 4) << (3 - 3 * cv));
+			}
+		}
+	}
+	WriteFile(InFn, x, sizeof(short), Packets * VITERBI_BITS);
+	WriteFile(RefFn, y, sizeof(short), Packets * VITERBI_WORDS);
+}
+
+int main (int argc, char *argv[])
+{
+	long	n = argc > 2 ? strtol(argv[2], NULL, 0) : 0;
+	long	m = argc > 3 ? strtol(argv[3], NULL, 0) : 0;
+
+	/* Check arguments */
+
+	if (argc == 7 && strcmp(argv[1],"autcor") == 0 && n > 0 && n <= 16384 && m > 0 && m <= n){
+		Seed = (unsigned long)strtol(argv[4], NULL, 0);
+		GenAutcor(n, m, argv[5], argv[6]);
+	} else if (argc == 7 && strcmp(argv[1],"conven") == 0 && n > 0 && m >= 1 && m <= 3 &&
+	           (n <= CONV_BLOCK_BITS || n % CONV_BLOCK_BITS == 0)){
+		Seed = (unsigned long)strtol(argv[4], NULL, 0);
+		GenConven(n, (int)m, argv[5], argv[6]);
+	} else if (argc == 8 && strcmp(argv[1],"fbital") == 0 && n > 0 && n <= 32767 && m >= 0 &&
+	           m <= n * MAX_BITS_PER_CARRIER){
+		Seed = (unsigned long)strtol(argv[4], NULL, 0);
+		GenFbital(n, m, argv[5], argv[6], argv[7]);
+	} else if (argc == 7 && strcmp(argv[1],"fft") == 0 && n > 0 &&
+	           (argv[3][0] == 'f' || argv[3][0] == 'F' || argv[3][0] == 'r' || argv[3][0] == 'R')){
+		Seed = (unsigned long)strtol(argv[4], NULL, 0);
+		GenFft(n, argv[3][0] == 'r' || argv[3][0] == 'R', argv[5], argv[6]);
+	} else if (argc == 6 && strcmp(argv[1],"viterb") == 0 && n > 0){
+		Seed = (unsigned long)m;
+		GenViterb(n, argv[4], argv[5]);
+	} else {
+		printf("ERROR: Incorrect arguments\n");
+		printf("  Usage: datagen autcor samples lags seed input reference\n");
+		printf("         datagen conven bits code seed input reference\n");
+		printf("         datagen fbital carriers bits seed allocmapi.dat input reference\n");
+		printf("         datagen fft blocks f|r seed input reference\n");
+		printf("         datagen viterb packets seed input reference\n");
+		printf("     Exiting...");
+		return 1;
+	}
+	return 0;
+}
@@ -15,6 +15,13 @@ This program computes the signal to noise ratio. According to:
 SNR = 10 log10 (ErrorPower / SignalPower).
 
 Execution:  diffmeasure [reference file] [outputted data file from benchmark] ([prompt])
+            diffmeasure -batch [list file]
+
+Each file is read into memory once and parsed in one pass.  With -batch
+the list file names a reference file and a data file on each line, e.g.
+every output of a results directory, and each pair is compared in turn
+with one summary line.  The exit status is 1 if any pair cannot be
+compared.
 
 Naming convention:
 
@@ -27,182 +34,285 @@ vdata = golden files (not used as input or output)
 #include "verify.h"
 #include <stdio.h>  /* FILE definition */
 #include <stdlib.h> /* calloc, exit definitions */
+#include <string.h> /* memchr */
+#include <stdarg.h> /* va_list */
 
 double diffmeasure (e_f64 *golden, int golden_size, DATA_TYPE RefType, e_s16 *calculated, int calculated_size, DATA_TYPE DataType); 
 
-int main (int argc, char *argv[])
+/*
+ * DataSet: A reference or data file, its Values one or two (real,
+ * imaginary) per line for Points lines of Type, and the Power of the sum of
+ * their squares.
+ */
+typedef struct {
+	double		*Values;
+	int			Points;
+	DATA_TYPE	Type;
+	double		Power;
+} DataSet;
+
+/*
+ * FUNC: ParseLine
+ *
+ * DESC: Parses up to two values, the " %lf %lf" of the line from s to end
+ * into v, without going past the end of the line.
+ *
+ * RETURNS: The number of values, BAD_F for a blank line
+ */
+static int ParseLine(const char *s, const char *end, double *v)
 {
-    double    RefReal,RefImag,DataReal,DataImag,RefPower,DataPower;
-    double    RefScaleFactor,ErrorSum;
-    int       RefNumPoints,DataNumPoints,i,j;
-    char      InString[256];
-    FILE     *RefFile, *DataFile;
-    DATA_TYPE Type,RefType,DataType;
-	double		*golden_file; 
-	short		*data_file; 
+	char	*next;
+	int		n = 0;
+
+	while (n < 2){
+		while (s < end && (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\f' || *s == '\v'))
+			s++;
+		if (s == end)
+			break;
+		v[n] = strtod(s, &next);
+		if (next == s)
+			break;
+		s = next;
+		n++;
+	}
+	while (s < end && (*s == ' ' || *s == '\t' || *s == '\r'))
+		s++;
+	return (n == 0 && s == end) ? BAD_F : n;
+}
 
-   /* Check arguments */
-   
-	if (!((argc == 3) || (argc == 4))){
-   		printf("ERROR: Incorrect arguments\n");
-		printf("  Usage: diffmeasure reffile datafile [prompt]\n");
-		printf("     Exiting...");
+/*
+ * FUNC: ReadDataSet
+ *
+ * DESC: Reads the file fn into memory with one fread and parses it into ds
+ * in one pass, up to the first blank line. The file's first line sets its
+ * type; lines of the other type are reported and skipped.
+ *
+ * RETURNS: 0, or 1 with a message if the file cannot be read or is empty
+ */
+static int ReadDataSet(const char *fn, const char *What, DataSet *ds)
+{
+	FILE	*File;
+	char	*Text, *s, *end, *TextEnd;
+	long	Length;
+	double	v[2];
+	int		Type, Step;
+
+	ds->Values = NULL;
+	if ((File = fopen(fn,"rb")) == NULL){
+		printf("ERROR: Cannot open %s\n  Exiting...\n",fn);
 		return 1;
 	}
-	if ((RefFile = fopen(argv[1],"r")) == NULL){
-   		printf("ERROR: Cannot open %s\n  Exiting...\n",argv[1]);
+	fseek(File, 0L, SEEK_END);
+	Length = ftell(File);
+	rewind(File);
+	if (Length < 0 || (Text = (char *)malloc((size_t)Length + 1)) == NULL){
+		fclose(File);
+		printf("ERROR: Cannot read %s\n  Exiting...\n",fn);
 		return 1;
 	}
-	if ((DataFile = fopen(argv[2],"r")) == NULL){
-   		printf("ERROR: Cannot open %s\n  Exiting...\n",argv[2]);
+	if (fread(Text, 1, (size_t)Length, File) != (size_t)Length){
+		fclose(File);
+		free(Text);
+		printf("ERROR: Cannot read %s\n  Exiting...\n",fn);
 		return 1;
 	}
-
-	/* Determine Reference File Data Type (Real or Complex) */
-   
-	RefPower = 0.0;
-	RefImag  = 0.0;
-   
-	fgets(InString,sizeof(InString) - 1,RefFile);
-	RefType = (DATA_TYPE) sscanf(InString, " %lf %lf", &RefReal, &RefImag);
-	if (RefType == BAD_F){
-      printf("ERROR: No reference data.\n");
-      return 1;
+	fclose(File);
+	TextEnd = Text + Length;
+	*TextEnd = '\0';
+
+	/* A value takes at least two characters, a digit and a separator */
+	ds->Values = (double *)malloc(((size_t)Length / 2 + 2) * sizeof(double));
+	if (ds->Values == NULL){
+		free(Text);
+		exit(1);
 	}
+	ds->Points	= 0;
+	ds->Power	= 0.0;
+	ds->Type	= BAD_F;
+	Step		= 0;
+
+	for (s = Text; s < TextEnd; s = end + 1){
+		end = (char *)memchr(s, '\n', (size_t)(TextEnd - s));
+		if (end == NULL)
+			end = TextEnd;
+		Type = ParseLine(s, end, v);
+		if (Type == BAD_F)	break;
+		if (Type == 0 || (ds->Type != BAD_F && Type != (int)ds->Type)){
+			printf("ERROR: Mixed real and complex in the %s file.\n",What);
+			continue;
+		}
+		if (ds->Type == BAD_F){
+			ds->Type	= (DATA_TYPE)Type;
+			Step		= Type;
+		}
 
-	RefPower += (RefReal * RefReal) + (RefImag * RefImag);
-
-	/* Count Number of Points in the Reference File and keep track of the
-   	Maximum Amplitude */
-	RefNumPoints = 1;
-	while (fgets(InString,255,RefFile) != NULL){
-		Type = (DATA_TYPE) sscanf(InString, " %lf %lf", &RefReal, &RefImag);
-		if (Type == BAD_F)		break;
-		if (Type != RefType)	printf("ERROR: Mixed real and complex in the reference file.\n");
-
-		RefPower += (RefReal * RefReal) + (RefImag * RefImag);
-   		RefNumPoints++;
+		ds->Values[ds->Points*Step] = v[0];
+		if (Step == 2)
+			ds->Values[ds->Points*2+1] = v[1];
+		else
+			v[1] = 0.0;
+		ds->Power += (v[0] * v[0]) + (v[1] * v[1]);
+		ds->Points++;
 	}
+	free(Text);
 
-	/* Display Reference File Summary */
-	printf("Reference File: %s\n",argv[1]);
-	if (RefType == REAL)	printf("   Contains %d  REAL elements\n",RefNumPoints);
-	else			   		printf("   Contains %d  COMPLEX elements\n",RefNumPoints);
-	printf("   Average reference power = %lf\n\n", RefPower / RefNumPoints);
-
-	if (RefType == COMPLEX)	golden_file = (double *)calloc(RefNumPoints*2,sizeof(double)); 
-	else					golden_file = (double *)calloc(RefNumPoints,sizeof(double)); 
-	fclose(RefFile);
-
-	if(!golden_file)	exit(1); 
-
-	/* Determine Data File Data Type (Real or Complex) */
-	DataPower = 0.0;
-	DataImag  = 0.0;
+	if (ds->Type == BAD_F){
+		printf("ERROR: No %s data.\n",What);
+		return 1;
+	}
+	return 0;
+}
 
-	fgets(InString,255,DataFile);
+/*
+ * FUNC: Compare
+ *
+ * DESC: Compares the data file DataFn with the reference file RefFn. Unless
+ * Brief, prints the summary of each file and the maximum amplitude ratio,
+ * and prompts for the reference scale factor if Prompt.
+ *
+ * RETURNS: 0, or 1 if the files cannot be compared
+ */
+static int Compare(const char *RefFn, const char *DataFn, int Prompt, int Brief)
+{
+	DataSet		Ref, Data;
+	double		RefScaleFactor, DiffM;
+	short		*data_file;
+	int			i, n, rv = 1;
 
-	DataType = (DATA_TYPE) sscanf(InString, " %lf %lf", &DataReal, &DataImag);
-	if (DataType == BAD_F){
-		printf("ERROR: No data.\n");
+	if (ReadDataSet(RefFn, "reference", &Ref) != 0){
+		free(Ref.Values);
 		return 1;
 	}
 
-	DataPower += (DataReal * DataReal) + (DataImag * DataImag);
-
-	/* Count Number of Points in the Data File and keep track of the
-   	Maximum Amplitude */
-	DataNumPoints = 1;
-	while (fgets(InString,255,DataFile) != NULL){
-		Type = (DATA_TYPE) sscanf(InString, " %lf %lf", &DataReal, &DataImag);
-		if (Type == BAD_F)		break;
-		if (Type != DataType)	printf("ERROR: Mixed real and complex in the data file.\n");
+	/* Display Reference File Summary */
+	if (!Brief){
+		printf("Reference File: %s\n",RefFn);
+		if (Ref.Type == REAL)	printf("   Contains %d  REAL elements\n",Ref.Points);
+		else			   		printf("   Contains %d  COMPLEX elements\n",Ref.Points);
+		printf("   Average reference power = %lf\n\n", Ref.Power / Ref.Points);
+	}
 
-		DataPower += (DataReal * DataReal) + (DataImag * DataImag);
-   		DataNumPoints++;
+	if (ReadDataSet(DataFn, "data", &Data) != 0){
+		free(Ref.Values);
+		free(Data.Values);
+		return 1;
 	}
 
 	/* Display Data File Summary */
-	printf("Data File: %s\n",argv[2]);
-	if (DataType == REAL)	printf("   Contains %d  REAL elements\n",DataNumPoints);
-	else		   			printf("   Contains %d  COMPLEX elements\n",DataNumPoints);
-   
-	printf("   Average data power = %lf\n\n", DataPower / DataNumPoints);
-
-	if (DataType != RefType){
-		printf("ERROR: Unable to compare real with complex.\n");
-		return 1;
+	if (!Brief){
+		printf("Data File: %s\n",DataFn);
+		if (Data.Type == REAL)	printf("   Contains %d  REAL elements\n",Data.Points);
+		else		   			printf("   Contains %d  COMPLEX elements\n",Data.Points);
+		printf("   Average data power = %lf\n\n", Data.Power / Data.Points);
 	}
 
-	if (DataNumPoints != RefNumPoints){
+	data_file = NULL;
+	if (Data.Type != Ref.Type){
+		printf("ERROR: Unable to compare real with complex.\n");
+	} else if (Data.Points != Ref.Points){
 		printf("ERROR: Unable to compare sequences of different lengths.\n");
-		return 1;
+	} else if (Data.Power == 0){
+		printf("ERROR: No data power.\n");
+	} else {
+		/* The benchmarks' output is 16 bit integers */
+		n = Data.Points * (int)Data.Type;
+		data_file = (short *)calloc((size_t)n, sizeof(short));
+		if(!data_file)	exit(2); 
+		for (i = 0; i < n; i++)
+			data_file[i] = (short)(long)Data.Values[i];
+
+		/* Set up RefScaleFactor */
+		if (!Brief)
+			printf("Maximum Amplitude Ratio %g\n",Ref.Power / Data.Power);
+		if (Prompt) {
+			/* Prompt for Reference Scale Factor */
+			printf("Enter Reference Scale Factor (RefPower /  DataPower): ");
+			scanf("%lf",&RefScaleFactor);
+			printf("\n\n");
+		}
+
+		DiffM = diffmeasure(Ref.Values,n,Data.Type,data_file,n,Data.Type);
+		if (DiffM == DIFFM_ERROR)
+			printf("ERROR: The data adds up to 0, no reference scale factor.\n");
+		else if (Brief)
+			printf("%s %s: Difference Measure (S/N) = %g (dB)\n",RefFn,DataFn,DiffM);
+		else
+			printf("\nDifference Measure (S/N) = %g (dB)\n",DiffM);
+		rv = DiffM == DIFFM_ERROR;
 	}
 
-	if (DataType == COMPLEX)	data_file = (short *)calloc(RefNumPoints*2,sizeof(short)); 
-	else						data_file = (short *)calloc(RefNumPoints,sizeof(short)); 
-	fclose(DataFile);
+	free(data_file);
+	free(Ref.Values);
+	free(Data.Values);
+	return rv;
+}
 
-	if(!data_file)	exit(2); 
+/*
+ * FUNC: CompareBatch
+ *
+ * DESC: Compares each reference file and data file pair the lines of the
+ * file ListFn name, or standard input for "-".
+ *
+ * RETURNS: 0, or 1 if any pair cannot be compared
+ */
+static int CompareBatch(const char *ListFn)
+{
+	FILE	*List;
+	char	InString[1024], RefFn[512], DataFn[512];
+	int		Pairs = 0, Failed = 0;
 
-	if (DataPower == 0){
-		printf("ERROR: No data power.\n");
+	List = strcmp(ListFn, "-") == 0 ? stdin : fopen(ListFn, "r");
+	if (List == NULL){
+		printf("ERROR: Cannot open %s\n  Exiting...\n",ListFn);
 		return 1;
 	}
-
-	/* Set up RefScaleFactor */
-	printf("Maximum Amplitude Ratio %g\n",RefPower / DataPower);
-	if (argc == 4) {
-   		/* Prompt for Reference Scale Factor */
-   		printf("Enter Reference Scale Factor (RefPower /  DataPower): ");
-   		scanf("%lf",&RefScaleFactor);
-   		printf("\n\n");
-	}
-	else {
-      if (DataPower == 0){
-         printf("ERROR: No data power.\n");
-         return 1;
-      }
-   		RefScaleFactor = (RefPower / DataPower);
+	while (fgets(InString,sizeof(InString),List) != NULL){
+		if (sscanf(InString, " %511s %511s", RefFn, DataFn) != 2)
+			continue;
+		Pairs++;
+		if (Compare(RefFn, DataFn, 0, 1) != 0){
+			printf("%s %s: FAILED\n",RefFn,DataFn);
+			Failed++;
+		}
 	}
+	if (List != stdin)
+		fclose(List);
+
+	printf("%d pairs compared, %d failed\n",Pairs,Failed);
+	return Failed != 0 || Pairs == 0;
+}
 
-	/* Open files and initialize variables */
-	RefFile		= fopen(argv[1],"r");
-	DataFile	= fopen(argv[2],"r");
+int main (int argc, char *argv[])
+{
+   /* Check arguments */
    
-	ErrorSum = 0.0;
-
-	/* Compute the error power and the signal power */
-	/* Process for the Number of Data Points */
-	j	= 0; 
-	for (i = 0; i < DataNumPoints; i++) {
-		if (DataType == COMPLEX){
-			fgets(InString,255,RefFile);
-			sscanf(InString, " %lf %lf", &golden_file[j], &golden_file[j+1]);
-
-			fgets(InString,255,DataFile);
-			sscanf(InString, " %d %d", &data_file[j], &data_file[j+1]);
-			j+=2; 
-		}
-		else{
-			fgets(InString,255,RefFile);
-			sscanf(InString, " %lf", &golden_file[i]);
+	if (argc == 3 && strcmp(argv[1], "-batch") == 0)
+		return CompareBatch(argv[2]);
 
-			fgets(InString,255,DataFile);
-			sscanf(InString, " %d", &data_file[i]);
-		} 
+	if (!((argc == 3) || (argc == 4))){
+   		printf("ERROR: Incorrect arguments\n");
+		printf("  Usage: diffmeasure reffile datafile [prompt]\n");
+		printf("         diffmeasure -batch listfile\n");
+		printf("     Exiting...");
+		return 1;
 	}
 
-	if (DataType == COMPLEX){
-		printf("\nDifference Measure (S/N) = %g (dB)\n",
-			diffmeasure(golden_file,DataNumPoints,COMPLEX,data_file,DataNumPoints,COMPLEX)); 
-	} 
-	else{
-		printf("\nDifference Measure (S/N) = %g (dB)\n",
-			diffmeasure(golden_file,DataNumPoints,REAL,data_file,DataNumPoints,REAL)); 
-	} 
+	return Compare(argv[1], argv[2], argc == 4, 0);
+}
+
+/*
+ * th_printf for diffmeasure(), which prints its sums with it. This program
+ * does not start the test harness, so there is no harness console.
+ */
+int th_printf( const char *fmt, ... )
+{
+	va_list	args;
+	int		rv;
 
-   return 0;
+	va_start( args, fmt );
+	rv = vprintf( fmt, args );
+	va_end( args );
+	return rv;
 }
 
 /* 
@@ -90,75 +90,54 @@ double log_10 (double num)
    return(my_log(num)/LN_10);
 }
 
-double diffmeasure (e_f64 *golden, int golden_size, DATA_TYPE RefType, e_s16 *calculated, int calculated_size, DATA_TYPE DataType)
-{
-	e_f64	RefReal,DataReal,RefImag,DataImag,RefPower,DataPower;
-	e_f64	RefScaleFactor,SignalSum,ErrorSum,SignalValue,ErrorValue,DiffM;
-    e_f64   RealDiff, ImagDiff;
-	int		i;
+/*
+ * DIFF_LANES: The sums of diffmeasure are split into DIFF_LANES partial sums
+ * of every DIFF_LANES-th value, so that the compiler can keep them in SIMD
+ * registers, and added at the end. The sums may differ from one running sum
+ * in the last bits.
+ */
+#define DIFF_LANES 4
 
-	/* Clear two warnings */
-	if(RefType != DataType)				return  -999.999; 
-	if(golden_size != calculated_size ||
-	   golden == NULL ||
-	   calculated == NULL)				return  -999.999; 
-
-	/* determine maximum Power in golden array */
-	RefPower = 0.0;
-	RefImag  = 0.0;
-	for(i=0;i<golden_size;i++)
-	{ 
-		RefReal		= golden[i]; 
-		if(RefType == COMPLEX)	RefImag	= golden[++i];
-		else					RefImag	= 0.0; 
-		/*RefPower	+= (RefReal * RefReal) + (RefImag * RefImag);*/
-		RefPower	+= (RefReal + RefImag); 
-	}
-	/*RefPower	= RefPower / golden_size; */
-
-	/* determine maximum Power in calculated array */
-	DataPower		= 0.0;
-	DataImag		= 0.0;
-	for(i=0;i<golden_size;i++)
-	{ 
-		DataReal		= (e_f64)calculated[i]; 
-		if(DataType == COMPLEX)	DataImag	= (e_f64)calculated[++i];
-		else					DataImag	= 0.0; 
-		/*DataPower += (DataReal * DataReal) + (DataImag * DataImag);*/
-		DataPower	+= (DataReal + DataImag); 
-	} 
-	/*DataPower	= DataPower / golden_size; */
+static e_f64 SumLanes(const e_f64 *Lane)
+{
+	return (Lane[0] + Lane[1]) + (Lane[2] + Lane[3]);
+}
 
-	if(!DataPower){
-		th_exit(1,"Error. DataPower == 0\n");
-	} 
-	/* Set up RefScaleFactor */
-	RefScaleFactor	= (RefPower / DataPower);
-	SignalSum		= 0.0;
-	ErrorSum		= 0.0;
+/*
+ * The S/N in dB of the n values of calculated, times RefScaleFactor,
+ * against those of golden.
+ */
+static double DiffSums (const e_f64 *golden, const e_s16 *calculated, int n, e_f64 RefScaleFactor)
+{
+	e_f64	SignalSum,ErrorSum,DiffM;
+	e_f64	DataValue,Diff;
+	e_f64	SignalLane[DIFF_LANES],ErrorLane[DIFF_LANES];
+	int		i,k;
 
 	/* Compute the Sum of |Signal| and the Sum of |Error| */
-	/* Process for the Number of Data Points */
-	for (i = 0; i < golden_size; i++)
+	for(k=0;k<DIFF_LANES;k++)
+	{
+		SignalLane[k]	= 0.0;
+		ErrorLane[k]	= 0.0;
+	}
+	for(i=0;i+DIFF_LANES<=n;i+=DIFF_LANES)
+	{
+		for(k=0;k<DIFF_LANES;k++)
+		{
+			DataValue		= (e_f64)calculated[i+k] * RefScaleFactor;
+			Diff			= golden[i+k] - DataValue;
+			SignalLane[k]  += DataValue * DataValue;
+			ErrorLane[k]   += Diff * Diff;
+		}
+	}
+	SignalSum	= SumLanes(SignalLane);
+	ErrorSum	= SumLanes(ErrorLane);
+	for(;i<n;i++)
 	{
-		RefReal	 = golden[i];
-		if(RefType == COMPLEX)	RefImag	= golden[i+1];
-		else					RefImag	= 0.0; 
-		DataReal = (e_f64)calculated[i];
-		if(DataType == COMPLEX)	DataImag	= (e_f64)calculated[++i];
-		else					DataImag	= 0.0; 
-
-		/* Scale */ 
-		DataReal	= DataReal * RefScaleFactor;
-		DataImag	= DataImag * RefScaleFactor;
-
-		RealDiff	= RefReal - DataReal;
-		ImagDiff	= RefImag - DataImag;
-	
-		SignalValue = (DataReal * DataReal) + (DataImag * DataImag);
-		SignalSum  += SignalValue;
-		ErrorValue  = (RealDiff * RealDiff) + (ImagDiff * ImagDiff);
-		ErrorSum   += ErrorValue;
+		DataValue	= (e_f64)calculated[i] * RefScaleFactor;
+		Diff		= golden[i] - DataValue;
+		SignalSum  += DataValue * DataValue;
+		ErrorSum   += Diff * Diff;
 	}
 
 	th_printf("SignalSum %g, ErrorSum is %g\n",SignalSum,ErrorSum); 
@@ -172,3 +151,72 @@ double diffmeasure (e_f64 *golden, int golden_size, DATA_TYPE RefType, e_s16 *ca
 		return	DiffM; 
 	}
 }
+
+/*
+ * A COMPLEX array holds (real, imaginary) pairs, and golden_size counts its
+ * values from the first pair on, rounded up to a whole pair; a REAL array
+ * has an imaginary part of 0. Both add up the same, value by value, so the
+ * sums run over the values in one loop for either type.
+ */
+double diffmeasure (e_f64 *golden, int golden_size, DATA_TYPE RefType, e_s16 *calculated, int calculated_size, DATA_TYPE DataType)
+{
+	e_f64	RefPower,DataPower,RefScaleFactor;
+	e_f64	RefLane[DIFF_LANES],DataLane[DIFF_LANES];
+	int		i,k,n;
+
+	/* Clear two warnings */
+	if(RefType != DataType)				return  DIFFM_ERROR; 
+	if(golden_size != calculated_size ||
+	   golden == NULL ||
+	   calculated == NULL)				return  DIFFM_ERROR; 
+
+	n = (RefType == COMPLEX) ? golden_size + (golden_size & 1) : golden_size;
+
+	/* determine the sum of the golden and the calculated arrays */
+	for(k=0;k<DIFF_LANES;k++)
+	{
+		RefLane[k]	= 0.0;
+		DataLane[k]	= 0.0;
+	}
+	for(i=0;i+DIFF_LANES<=n;i+=DIFF_LANES)
+	{
+		for(k=0;k<DIFF_LANES;k++)
+		{
+			RefLane[k]	+= golden[i+k];
+			DataLane[k]	+= (e_f64)calculated[i+k];
+		}
+	}
+	RefPower	= SumLanes(RefLane);
+	DataPower	= SumLanes(DataLane);
+	for(;i<n;i++)
+	{
+		RefPower	+= golden[i];
+		DataPower	+= (e_f64)calculated[i];
+	}
+
+	/* No scale factor, the caller decides whether that ends the run */
+	if(!DataPower){
+		th_printf("Error. DataPower == 0\n");
+		return	DIFFM_ERROR;
+	} 
+	/* Set up RefScaleFactor */
+	RefScaleFactor	= (RefPower / DataPower);
+
+	return DiffSums(golden, calculated, n, RefScaleFactor);
+}
+
+/*
+ * diffmeasure without the scale factor, for a golden array computed at the
+ * scale of the calculated one, whose sums may well add up to about 0, as
+ * those of a transform do when the first input is 0.
+ */
+double diffmeasure_unscaled (e_f64 *golden, int golden_size, DATA_TYPE RefType, e_s16 *calculated, int calculated_size, DATA_TYPE DataType)
+{
+	if(RefType != DataType)				return  DIFFM_ERROR; 
+	if(golden_size != calculated_size ||
+	   golden == NULL ||
+	   calculated == NULL)				return  DIFFM_ERROR; 
+
+	return DiffSums(golden, calculated,
+		(RefType == COMPLEX) ? golden_size + (golden_size & 1) : golden_size, 1.0);
+}
@@ -23,7 +23,12 @@ DATA_TYPE;
 
 
 
+/* diffmeasure result for arrays that cannot be compared, or whose data
+ * adds up to 0 so that there is no scale factor */
+#define	DIFFM_ERROR	(-999.999)
+
 double	diffmeasure (e_f64 *, int , DATA_TYPE , e_s16 *, int , DATA_TYPE );
+double	diffmeasure_unscaled (e_f64 *, int , DATA_TYPE , e_s16 *, int , DATA_TYPE );
 
 /* Used to convert diffmeasure output into THResults */
 
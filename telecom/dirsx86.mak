@@ -34,6 +34,8 @@ clean:: cleanlogs
 	@rm -f $(OBJBUILD)/viterb00data_2/*$(OBJ)
 	@rm -f $(OBJBUILD)/viterb00data_3/*$(OBJ)
 	@rm -f $(OBJBUILD)/viterb00data_4/*$(OBJ)
+	@rm -f $(OBJBUILD)/telemark/*$(OBJ)
+	@rm -f $(OBJBUILD)/modem00/*$(OBJ)
 	@rm -f $(BINBUILD)/empty$(LITE)$(EXE)
 	@rm -f $(BINBUILD)/autcor00data_1$(LITE)$(EXE)
 	@rm -f $(BINBUILD)/autcor00data_2$(LITE)$(EXE)
@@ -51,6 +53,8 @@ clean:: cleanlogs
 	@rm -f $(BINBUILD)/viterb00data_2$(LITE)$(EXE)
 	@rm -f $(BINBUILD)/viterb00data_3$(LITE)$(EXE)
 	@rm -f $(BINBUILD)/viterb00data_4$(LITE)$(EXE)
+	@rm -f $(BINBUILD)/telemark$(LITE)$(EXE)
+	@rm -f $(BINBUILD)/modem00$(LITE)$(EXE)
 	@rm -f $(BINBUILD)/diffmeasure$(LITE)$(EXE)
 
 mkdir:
@@ -75,6 +79,8 @@ mkdir:
 	@mkdir -p $(OBJBUILD)/viterb00data_2
 	@mkdir -p $(OBJBUILD)/viterb00data_3
 	@mkdir -p $(OBJBUILD)/viterb00data_4
+	@mkdir -p $(OBJBUILD)/telemark
+	@mkdir -p $(OBJBUILD)/modem00
 
 rmdir:
 	@rm -rf $(BINBUILD)
@@ -171,6 +171,7 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 	results.v3         = 0;
 	results.v4         = 0;
 	results.info       = info;
+	results.verify_snr = FALSE;
 
 	th_sprintf( info, "Just at test to see how big the TH is." );
 
@@ -60,7 +60,8 @@ TCDef the_tcdef =
 	0,
 	0,
 	0,
-	0
+	0,
+	FALSE
 } ; 
 
 /*
@@ -23,6 +23,73 @@
 #define MAX_BITS_PER_CARRIER    12
 #define ALLOCATION_MAP_SIZE     512
 
+/*
+ * FBITAL_BISECTION: When TRUE, fxpBitAllocation bisects for the highest
+ * water level at which the carriers take at least BitsPerDMTSymbol bits,
+ * in at most 17 counting passes that stop as soon as the budget is met,
+ * then allocates once at that level. Otherwise the water level is stepped
+ * in proportion to the bit shortfall until the allocation is exact.
+ */
+#if !defined(FBITAL_BISECTION)
+#define FBITAL_BISECTION (FALSE)
+#endif
+
+/*
+ * FBITAL_HISTOGRAM: When TRUE, fxpBitAllocation finds the same water level
+ * as FBITAL_BISECTION from histograms instead of passes over the carriers.
+ * The SNRs are counted once into bins of 64, one per step of the
+ * AllocationMap index, and each candidate level on that grid is evaluated
+ * over the bins. One more pass over the carriers bins the bits lost per
+ * unit of level within the chosen step, and the carriers are allocated
+ * once at the final level. The cost is three carrier passes plus
+ * O(FBITAL_SNR_BINS) per candidate, whatever the number of carriers.
+ */
+#if !defined(FBITAL_HISTOGRAM)
+#define FBITAL_HISTOGRAM (FALSE)
+#endif
+
+/*
+ * FBITAL_SIMD: When TRUE, the allocation and counting passes of
+ * fxpBitAllocation run 8 carriers per SSE2 or NEON vector, from 64
+ * carriers up. The AllocationMap lookup is gather free: a non-decreasing
+ * map of at most MAX_BITS_PER_CARRIER bits is the count of its step
+ * indices at or below the index, found with one compare per step. Other
+ * maps, and other compilers, use the scalar passes. The result is
+ * unchanged.
+ */
+#if !defined(FBITAL_SIMD)
+#define FBITAL_SIMD (FALSE)
+#endif
+
+/*
+ * FBITAL_WIDE_BENCH: When TRUE, after the timed loop the benchmark times
+ * fxpBitAllocationWide on 256 to FBITAL_WIDE_MAX_CARRIERS carriers of two
+ * generated profiles: the data set stretched over the carriers with its
+ * bits per carrier, and a VDSL2 like slope from 56 to 20 dB that takes 9
+ * bits per carrier, beyond e_u16 from 8192 carriers. The passes are split
+ * across a th_pool_open() pool of 1 to FBITAL_WIDE_MAX_THREADS threads.
+ * Every allocation is checked and the wall-clock time per allocation and
+ * speedup over 1 thread are reported, with the fewest carriers at which
+ * more threads are at least 5% faster than 1: each pass of the search is only a few microseconds
+ * of work, so a threaded allocation pays off on wide lines only, and
+ * never on one CPU. Needs TH_THREADS.
+ */
+#if !defined(FBITAL_WIDE_BENCH)
+#define FBITAL_WIDE_BENCH (FALSE)
+#endif
+#if FBITAL_WIDE_BENCH && !TH_THREADS
+#error "FBITAL_WIDE_BENCH needs the worker threads of TH_THREADS"
+#endif
+#if !defined(FBITAL_WIDE_MAX_CARRIERS)
+#define FBITAL_WIDE_MAX_CARRIERS    32768
+#endif
+#if !defined(FBITAL_WIDE_MAX_THREADS)
+#define FBITAL_WIDE_MAX_THREADS     4
+#endif
+
+/* FBITAL_SNR_BINS: The number of bins of 64 in the e_s16 SNR range */
+#define FBITAL_SNR_BINS         (65536 >> 6)
+
 /* Compile time Data set select for uuencode: 
  * DATA_1 through DATA_6
  * DATA_6 is default
@@ -31,6 +98,23 @@
 #define DATA_6
 #endif
 
+/*
+ * FBITAL_SWAP_BENCH: When TRUE, after the timed loop the benchmark tracks
+ * the allocation with BitAllocTrackerUpdate while FBITAL_SWAP_CHANGES
+ * random carriers per update drift by up to FBITAL_SWAP_DRIFT, checks it
+ * against a full allocation at the tracked level and reports the time
+ * and deltas per update against one full allocation pass.
+ */
+#if !defined(FBITAL_SWAP_BENCH)
+#define FBITAL_SWAP_BENCH (FALSE)
+#endif
+#if !defined(FBITAL_SWAP_CHANGES)
+#define FBITAL_SWAP_CHANGES     8
+#endif
+#if !defined(FBITAL_SWAP_DRIFT)
+#define FBITAL_SWAP_DRIFT       64
+#endif
+
 /*******************************************************************************
     Global Variables                                                            
 *******************************************************************************/
@@ -53,4 +137,68 @@ fxpBitAllocation (
 	size_t	loop_cnt
 );
 
+/*
+ * BitAllocStats: The convergence of one fxpBitAllocationStats call: its
+ * passes over the carriers, counting passes included, and the bits short
+ * of BitsPerDMTSymbol at the end.
+ */
+typedef struct {
+    n_int   Passes;
+    e_s32   FinalDelta;
+} BitAllocStats;
+
+void
+fxpBitAllocationStats (
+    e_s16   *CarrierSNRdB,          /* input data */
+    e_s16   *CarrierBitAllocation,  /* output data */
+    e_u16   NumberOfCarriers,       /* size of input data */
+    e_s16   WaterLeveldB_in,        /* Starting water level in dB */
+    e_s16   *WaterLeveldB_out,      /* Final water level in dB */
+    e_s16   *AllocationMap,         /* Lookup Table */
+    e_u16    BitsPerDMTSymbol,        /* total bits for allocation */
+    BitAllocStats *Stats            /* convergence, NULL to ignore */
+);
+
+/*
+ * BitAllocTracker: Opaque state of incremental (bit swap) re-allocation.
+ * BitAllocDelta: One changed carrier and its new number of bits.
+ */
+typedef struct BitAllocTracker BitAllocTracker;
+
+typedef struct {
+    e_u16   Carrier;
+    e_s16   Bits;
+} BitAllocDelta;
+
+BitAllocTracker *BitAllocTrackerInit(const e_s16 *CarrierSNRdB, e_u16 NumberOfCarriers,
+                                     e_s16 WaterLeveldB, const e_s16 *AllocationMap,
+                                     e_u16 BitsPerDMTSymbol);
+void BitAllocTrackerFree(BitAllocTracker *t);
+n_int BitAllocTrackerUpdate(BitAllocTracker *t, const e_u16 *Carriers,
+                            const e_s16 *CarrierSNRdB, n_int NumberOfChanges,
+                            BitAllocDelta *Deltas);
+e_s16 BitAllocTrackerWaterLevel(const BitAllocTracker *t);
+const e_s16 *BitAllocTrackerAllocation(const BitAllocTracker *t);
+
+/*
+ * BitAllocWide: Opaque state of fxpBitAllocationWide, with e_s32 carrier
+ * and bit counts and passes split into parts for threads.
+ */
+typedef struct BitAllocWide BitAllocWide;
+
+BitAllocWide *BitAllocWideInit(n_int NumParts);
+void BitAllocWideFree(BitAllocWide *w);
+void BitAllocWideStart(BitAllocWide *w, const e_s16 *CarrierSNRdB, e_s16 *CarrierBitAllocation,
+                       e_s32 NumberOfCarriers, e_s16 WaterLeveldB_in,
+                       const e_s16 *AllocationMap, e_s32 BitsPerDMTSymbol);
+void BitAllocWidePass(BitAllocWide *w, n_int Part);
+n_int BitAllocWideMerge(BitAllocWide *w);
+e_s16 BitAllocWideWaterLevel(const BitAllocWide *w);
+e_s32 BitAllocWideTotalBits(const BitAllocWide *w);
+e_s32 fxpBitAllocationWide(BitAllocWide *w, const e_s16 *CarrierSNRdB,
+                           e_s16 *CarrierBitAllocation, e_s32 NumberOfCarriers,
+                           e_s16 WaterLeveldB_in, e_s16 *WaterLeveldB_out,
+                           const e_s16 *AllocationMap, e_s32 BitsPerDMTSymbol);
+void fxpBitAllocSelectKernel(void);
+
 #endif /* __fBitAl00_H */
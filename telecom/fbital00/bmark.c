@@ -93,72 +93,418 @@ static TCDef the_tcdef =
 #define MAX_CARRIERS		256  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	1920
 #define OUTFILENAME "vtypbaiOut.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "vtypbai.bin"
+#define REFFILENAME "vtypbai.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "vtypbai.dat"
 };
 static e_s16 test_buf[] = { 
 #include "vtypbai.dat"
-}; 
+};
+#endif
 #elif defined(DATA_2)
 #define MAX_CARRIERS		256  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	1920
 #define OUTFILENAME "xtypsnriOut.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "xtypsnri.bin"
+#define REFFILENAME "vtypbai.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xtypsnri.dat"
 };
 static e_s16 test_buf[] = { 
 #include "vtypbai.dat"
-}; 
+};
+#endif
 #elif defined(DATA_3)
 #define MAX_CARRIERS		20  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	120
 #define OUTFILENAME "xstepsnriOut.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "xstepsnri.bin"
+#define REFFILENAME "vstepbai.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xstepsnri.dat"
 };
 static e_s16 test_buf[] = { 
 #include "vstepbai.dat"
-}; 
+};
+#endif
 #elif defined(DATA_4)
 #define MAX_CARRIERS		20  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	120
 #define OUTFILENAME "vstepbaiOut.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "vstepbai.bin"
+#define REFFILENAME "vstepbai.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "vstepbai.dat"
 };
 static e_s16 test_buf[] = { 
 #include "vstepbai.dat"
-}; 
+};
+#endif
 #elif defined(DATA_5)
 #define MAX_CARRIERS		20  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	120
 #define OUTFILENAME "vpentbaiOut.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "vpentbai.bin"
+#define REFFILENAME "vpentbai.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "vpentbai.dat"
 };
 static e_s16 test_buf[] = { 
 #include "vpentbai.dat"
-}; 
+};
+#endif
 #elif defined(DATA_6)
 
 #define MAX_CARRIERS		100  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	500
 #define OUTFILENAME "xpentsnriOut.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "xpentsnri.bin"
+#define REFFILENAME "vpentbai.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xpentsnri.dat"
 };
 static e_s16 test_buf[] = { 
 #include "vpentbai.dat"
-}; 
+};
+#endif
 #endif /* included data */
 
-static e_s16 alloc_map_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 alloc_map_buf[] = {
 #include "allocmapi.dat"
 };
-#define T_BSIZE (sizeof(e_s16)*(MAX_CARRIERS*2))
+#define T_BSIZE (sizeof(e_s16)*(NumberOfCarriers*2))
 
 static n_char* t_buf = NULL;
 
+#if FBITAL_SWAP_BENCH || FBITAL_WIDE_BENCH
+/*
+* FUNC   : swap_reference
+*
+* DESC   : Full allocation pass at WaterLeveldB, limited to BitsPerDMTSymbol
+*          in carrier order as fxpBitAllocation does. Returns the unlimited
+*          total.
+*/
+static e_s32 swap_reference( const e_s16 *CarrierSNRdB, n_int NumberOfCarriers, e_s32 WaterLeveldB,
+                             const e_s16 *AllocationMap, e_s32 BitsPerDMTSymbol, e_s16 *Allocation )
+{
+    e_s32   TotalBits = 0, Allocated = 0, DeltadB, CarrierBits;
+    n_int   i;
+
+    for ( i = 0; i < NumberOfCarriers; i++ )
+    {
+        DeltadB = CarrierSNRdB[i] - WaterLeveldB;
+        CarrierBits = DeltadB < 0 ? 0 : DeltadB > 32767 ? MAX_BITS_PER_CARRIER
+                                                        : AllocationMap[DeltadB >> 6];
+        TotalBits += CarrierBits;
+        if ( CarrierBits > BitsPerDMTSymbol - Allocated )
+            CarrierBits = BitsPerDMTSymbol - Allocated;
+        Allocation[i] = (e_s16)CarrierBits;
+        Allocated += CarrierBits;
+    }
+    return TotalBits;
+}
+#endif
+
+#if FBITAL_SWAP_BENCH
+/*
+* FUNC   : swap_bench
+*
+* DESC   : Starts a BitAllocTracker from the benchmark result and applies
+*          iterations updates of FBITAL_SWAP_CHANGES random carriers, each
+*          drifting by up to FBITAL_SWAP_DRIFT, to a copy of the SNRs and the
+*          allocation. The first updates are checked against swap_reference
+*          at the tracked level, which must be the highest that meets the
+*          budget. Then times the updates against the reference pass and
+*          prints the time per update and the deltas per update.
+*/
+#define SWAP_CHECKED_UPDATES 500
+
+static void swap_bench( size_t iterations, const e_s16 *CarrierSNRdB, e_u16 NumberOfCarriers,
+                        e_s16 WaterLeveldB, const e_s16 *AllocationMap, e_u16 BitsPerDMTSymbol,
+                        const e_s16 *CarrierBitAllocation )
+{
+    BitAllocTracker *t;
+    BitAllocDelta   *deltas;
+    e_s16           *snr, *alloc, *ref, *values;
+    e_u16           *carriers;
+    e_s32           value;
+    n_int           i, j, n, k, failed;
+    size_t          loop_cnt, duration, ref_duration, total_deltas;
+    e_u32           seed = 1;
+
+    snr      = (e_s16 *)th_malloc( NumberOfCarriers * sizeof(e_s16) );
+    alloc    = (e_s16 *)th_malloc( NumberOfCarriers * sizeof(e_s16) );
+    ref      = (e_s16 *)th_malloc( NumberOfCarriers * sizeof(e_s16) );
+    deltas   = (BitAllocDelta *)th_malloc( NumberOfCarriers * sizeof(BitAllocDelta) );
+    carriers = (e_u16 *)th_malloc( iterations * FBITAL_SWAP_CHANGES * sizeof(e_u16) );
+    values   = (e_s16 *)th_malloc( iterations * FBITAL_SWAP_CHANGES * sizeof(e_s16) );
+    if( snr == NULL || alloc == NULL || ref == NULL || deltas == NULL ||
+        carriers == NULL || values == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    /* The drift, as a random walk of the SNRs */
+    for ( i = 0; i < NumberOfCarriers; i++ )
+        snr[i] = CarrierSNRdB[i];
+    for ( k = 0; k < (n_int)iterations * FBITAL_SWAP_CHANGES; k++ )
+    {
+        seed  = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+        j     = (n_int)( ( seed >> 8 ) % NumberOfCarriers );
+        seed  = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+        value = snr[j] + (e_s32)( ( seed >> 8 ) % ( 2 * FBITAL_SWAP_DRIFT + 1 ) ) - FBITAL_SWAP_DRIFT;
+        value = value < -32768L ? -32768L : value > 32767L ? 32767L : value;
+        snr[j]      = (e_s16)value;
+        carriers[k] = (e_u16)j;
+        values[k]   = (e_s16)value;
+    }
+
+    failed = FALSE;
+    for ( n = 0; n < 2; n++ )
+    {
+        t = BitAllocTrackerInit( CarrierSNRdB, NumberOfCarriers, WaterLeveldB,
+                                 AllocationMap, BitsPerDMTSymbol );
+        if( t == NULL )
+           th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+        for ( i = 0; i < NumberOfCarriers; i++ )
+        {
+            snr[i]   = CarrierSNRdB[i];
+            alloc[i] = BitAllocTrackerAllocation( t )[i];
+            if ( n == 0 && alloc[i] != CarrierBitAllocation[i] && !failed )
+            {
+                th_printf( "--  Bit swap Failure: start carrier %d\n", i );
+                failed = TRUE;
+            }
+        }
+
+        total_deltas = 0;
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )
+        {
+            k = (n_int)loop_cnt * FBITAL_SWAP_CHANGES;
+            j = BitAllocTrackerUpdate( t, carriers + k, values + k, FBITAL_SWAP_CHANGES, deltas );
+            total_deltas += j;
+            for ( i = 0; i < j; i++ )
+                alloc[deltas[i].Carrier] = deltas[i].Bits;
+
+            /* Untimed pass: check each update */
+            if ( n == 0 && loop_cnt < SWAP_CHECKED_UPDATES && !failed )
+            {
+                for ( i = 0; i < FBITAL_SWAP_CHANGES; i++ )
+                    snr[carriers[k + i]] = values[k + i];
+                value = BitAllocTrackerWaterLevel( t );
+                swap_reference( snr, NumberOfCarriers, value, AllocationMap, BitsPerDMTSymbol, ref );
+                for ( i = 0; i < NumberOfCarriers; i++ )
+                {
+                    if ( alloc[i] != ref[i] || BitAllocTrackerAllocation( t )[i] != ref[i] )
+                    {
+                        th_printf( "--  Bit swap Failure: update %d carrier %d\n", (n_int)loop_cnt, i );
+                        failed = TRUE;
+                        break;
+                    }
+                }
+                if ( !failed && value < 32767 &&
+                     swap_reference( snr, NumberOfCarriers, value + 1, AllocationMap,
+                                     BitsPerDMTSymbol, ref ) >= BitsPerDMTSymbol )
+                {
+                    th_printf( "--  Bit swap Failure: update %d level %d is not the highest\n",
+                               (n_int)loop_cnt, (n_int)value );
+                    failed = TRUE;
+                }
+            }
+        }
+        duration = th_signal_finished();
+        value = BitAllocTrackerWaterLevel( t );
+        BitAllocTrackerFree( t );
+    }
+
+    /* One full pass per update, the least a search from scratch costs */
+    th_signal_start();
+    for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )
+        swap_reference( snr, NumberOfCarriers, value, AllocationMap, BitsPerDMTSymbol, ref );
+    ref_duration = th_signal_finished();
+
+    th_printf( "--  Bit swap: %d carriers, %d changes: %.3f us per update, %.2f deltas, full pass %.3f us\n",
+               NumberOfCarriers, FBITAL_SWAP_CHANGES,
+               (double)duration * 1e6 / th_ticks_per_sec() / iterations,
+               (double)total_deltas / iterations,
+               (double)ref_duration * 1e6 / th_ticks_per_sec() / iterations );
+
+    th_free( values );
+    th_free( carriers );
+    th_free( deltas );
+    th_free( ref );
+    th_free( alloc );
+    th_free( snr );
+}
+#endif
+
+#if FBITAL_WIDE_BENCH
+/* Runs one part of a pass of fxpBitAllocationWide on a th_pool_run() thread */
+static void wide_part( void *arg, int part )
+{
+    BitAllocWidePass( (BitAllocWide *)arg, part );
+}
+
+/*
+* FUNC   : wide_profile
+
+*
+* DESC   : Generates profile 0 or 1 of wide_bench over NumberOfCarriers
+*          carriers and returns its bits per symbol: the data set SNRs held
+*          over NumberOfCarriers / DataCarriers carriers each with the same
+*          bits per carrier, or a slope from 56 to 20 dB with 1 dB of
+*          ripple and 9 bits per carrier.
+*/
+static e_s32 wide_profile( n_int profile, e_s16 *CarrierSNRdB, e_s32 NumberOfCarriers,
+                           const e_s16 *DataSNRdB, n_int DataCarriers, e_s32 DataBits )
+{
+    e_s32   i;
+    e_u32   seed = 1;
+
+    for ( i = 0; i < NumberOfCarriers; i++ )
+    {
+        if ( profile == 0 )
+            CarrierSNRdB[i] = DataSNRdB[(long)i * DataCarriers / NumberOfCarriers];
+        else
+        {
+            seed = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+            CarrierSNRdB[i] = (e_s16)( 56L * 512 - 36L * 512 * i / ( NumberOfCarriers - 1 ) +
+                                       (e_s32)( ( seed >> 8 ) % 1025 ) - 512 );
+        }
+    }
+    return profile == 0 ? (e_s32)( (long)DataBits * NumberOfCarriers / DataCarriers )
+                        : 9 * NumberOfCarriers;
+}
+
+/*
+* FUNC   : wide_bench
+*
+* DESC   : Times fxpBitAllocationWide on the two wide_profile profiles of
+*          256 to FBITAL_WIDE_MAX_CARRIERS carriers, with its passes split
+*          across 1 to FBITAL_WIDE_MAX_THREADS threads, about the carriers
+*          of the timed loop each. Checks every allocation against
+*          swap_reference at its water level, which must be the highest
+*          that meets the budget, and prints the wall-clock time per
+*          allocation and the speedup over 1 thread. Every pass of the
+*          search hands the threads a few microseconds of work, so for
+*          each profile it also prints the crossover, the fewest carriers
+*          at which more threads are at least 5% faster than 1.
+*/
+static void wide_bench( size_t iterations, const e_s16 *DataSNRdB, n_int DataCarriers,
+                        const e_s16 *AllocationMap, e_s32 DataBits )
+{
+    THPool          *pool;
+    BitAllocWide    *w;
+    e_s16           *snr, *alloc, *ref;
+    e_s16           WaterLeveldB, WaterLeveldB_out;
+    e_s32           carriers, bits, total, unlimited, crossover;
+    n_int           profile, nthreads, i, failed, best;
+    size_t          loop_cnt, passes;
+    double          t0, t1, us, us1, best_us;
+
+    snr   = (e_s16 *)th_malloc( FBITAL_WIDE_MAX_CARRIERS * sizeof(e_s16) );
+    alloc = (e_s16 *)th_malloc( FBITAL_WIDE_MAX_CARRIERS * sizeof(e_s16) );
+    ref   = (e_s16 *)th_malloc( FBITAL_WIDE_MAX_CARRIERS * sizeof(e_s16) );
+    if( snr == NULL || alloc == NULL || ref == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    for ( profile = 0; profile < 2; profile++ )
+    {
+        crossover = 0;
+        best      = 1;
+        us1       = 0.0;
+        best_us   = 0.0;
+        for ( carriers = 256; carriers <= FBITAL_WIDE_MAX_CARRIERS; carriers *= 2 )
+        {
+            bits = wide_profile( profile, snr, carriers, DataSNRdB, DataCarriers, DataBits );
+            WaterLeveldB = -32768;
+            for ( i = 0; i < carriers; i++ )
+                if ( snr[i] > WaterLeveldB )
+                    WaterLeveldB = snr[i];
+
+            passes = iterations * DataCarriers / carriers + 1;
+
+            for ( nthreads = 1; nthreads <= FBITAL_WIDE_MAX_THREADS; nthreads++ )
+            {
+                w = BitAllocWideInit( nthreads );
+                if( w == NULL )
+                   th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+                pool = th_pool_open( nthreads );
+                if( pool == NULL )
+                   th_exit( THE_FAILURE, "Cannot create thread %s:%d", __FILE__, __LINE__ );
+
+                total = 0;
+                WaterLeveldB_out = WaterLeveldB;
+                t0 = th_wall_seconds();
+                for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+                {
+                    if ( nthreads == 1 )
+                        total = fxpBitAllocationWide( w, snr, alloc, carriers, WaterLeveldB,
+                                                      &WaterLeveldB_out, AllocationMap, bits );
+                    else
+                    {
+                        BitAllocWideStart( w, snr, alloc, carriers, WaterLeveldB,
+                                           AllocationMap, bits );
+                        do
+                            th_pool_run( pool, wide_part, w );
+                        while ( BitAllocWideMerge( w ) );
+                        total = BitAllocWideTotalBits( w );
+                        WaterLeveldB_out = BitAllocWideWaterLevel( w );
+                    }
+                }
+                t1 = th_wall_seconds();
+
+                th_pool_close( pool );
+                BitAllocWideFree( w );
+
+                /* Untimed check of the last allocation */
+                unlimited = swap_reference( snr, carriers, WaterLeveldB_out, AllocationMap, bits, ref );
+                failed = total != ( unlimited < bits ? unlimited : bits );
+                for ( i = 0; i < carriers && !failed; i++ )
+                    failed = alloc[i] != ref[i];
+                if ( !failed && WaterLeveldB_out < WaterLeveldB )
+                    failed = swap_reference( snr, carriers, WaterLeveldB_out + 1, AllocationMap,
+                                             bits, ref ) >= bits;
+                if ( failed )
+                    th_printf( "--  Wide Failure: profile %d, %d carriers, %d threads\n",
+                               profile, (n_int)carriers, nthreads );
+
+                us = t1 > t0 ? ( t1 - t0 ) * 1e6 / passes : 0.0;
+                if ( nthreads == 1 )
+                    best_us = us1 = us;
+                else if ( crossover == 0 && us < best_us && us < 0.95 * us1 )
+                {
+                    best_us = us;
+                    best    = nthreads;
+                }
+                th_printf( "--  Wide %-8s %4d carriers %6ld bits, %d threads: %9.3f us per allocation, %5.2fx\n",
+                           profile == 0 ? "data set" : "slope", (n_int)carriers, (long)total, nthreads,
+                           us, us > 0.0 ? us1 / us : 0.0 );
+            }
+            if ( crossover == 0 && best > 1 )
+                crossover = carriers;
+        }
+
+        if ( crossover != 0 )
+            th_printf( "--  Wide %-8s crossover: %d threads beat 1 from %d carriers\n",
+                       profile == 0 ? "data set" : "slope", best, (n_int)crossover );
+        else
+            th_printf( "--  Wide %-8s crossover: 1 thread is fastest up to %d carriers\n",
+                       profile == 0 ? "data set" : "slope", FBITAL_WIDE_MAX_CARRIERS );
+    }
+
+    th_free( ref );
+    th_free( alloc );
+    th_free( snr );
+}
+#endif
+
 /*------------------------------------------------------------------------------
  * FUNC   : t_run_test
  *
@@ -199,29 +545,41 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 	n_int            i; 
 	e_u16            NumberOfCarriers;
 	e_s16			*golden_result; 
-#if		!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
-	e_u8			    *out_symbol_buffer; 
-	n_char			*stringHeadPtr,*tmp_buf;
-	n_int            TempVal; 
+	BitAllocStats    stats;
+#if	TH_DATA_FILES
+	size_t           n, golden_size;
 #endif
    
     /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
      * First, initialize the data structures we need for the test
      */
-    t_buf     = (n_char *) th_malloc( T_BSIZE );
-    if( t_buf == NULL )
-       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+#if	TH_DATA_FILES
+   /* The data set comes from files, the SNR of each carrier and at least as
+    * many golden bit allocations
+    */
+    CarrierSNRdB	     = (e_s16 *)th_get_data_file( TH_DATA_INPUT, INFILENAME, sizeof(e_s16), &n );
+	golden_result		 = (e_s16 *)th_get_data_file( TH_DATA_GOLDEN, REFFILENAME, sizeof(e_s16), &golden_size );
+	if ( n > 0xFFFF || golden_size < n )
+		th_exit( THE_BAD_SIZE, "Data set of %ld carriers with %ld golden carriers does not fit",
+			(long)n, (long)golden_size );
+	NumberOfCarriers     = (e_u16)n;
+#else
 	golden_result		 = (e_s16 *)&test_buf; 
 
-
    /* When this is defined no file uploading necesary
     * we have all the data in the executable
 	* so initialising is simplier
 	*/ 
     CarrierSNRdB	     = (e_s16 *)&input_buf; 
+	NumberOfCarriers     = MAX_CARRIERS;  
+#endif
+
+    t_buf     = (n_char *) th_malloc( T_BSIZE );
+    if( t_buf == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
 	AllocationMap		 = (e_s16 *)&alloc_map_buf; 
     CarrierBitAllocation = (e_s16 *)t_buf; 
-	NumberOfCarriers     = MAX_CARRIERS;  
 
 	outFilename = OUTFILENAME;
 	BitsPerDMTSymbol = BITSPERDMTSYMBOL;
@@ -239,7 +597,7 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 	}}
      
     WaterLeveldB     = -32768;
-	for( i=0; i< MAX_CARRIERS; i++){ 
+	for( i=0; i< NumberOfCarriers; i++){ 
 	    /* Save the maximum CarrierSNR as the inital WaterLevel */
     	if (CarrierSNRdB[i] > WaterLeveldB) {
 	        WaterLeveldB = CarrierSNRdB[i];
@@ -266,10 +624,13 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 		        BitsPerDMTSymbol,NumberOfCarriers,MAX_BITS_PER_CARRIER);
     }
 
+    fxpBitAllocSelectKernel();  /* pick the kernel variants, see th_kernel_select() */
+
     /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
      * This is the actual benchmark
      */
 
+    th_latency_begin( iterations );
     th_signal_start();  /* Tell the host that the test has begun */
 
      /* no stopping!  Do ALL the iterations */
@@ -278,22 +639,45 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
         fxpBitAllocation(CarrierSNRdB,CarrierBitAllocation,NumberOfCarriers,
                          WaterLeveldB, &WaterLeveldB_out, AllocationMap, 
                          BitsPerDMTSymbol, loop_cnt );
+        th_latency_mark();
     } /* end for */
 
 
     results.duration   = th_signal_finished();  /* signal that we are finished */
 
+#if FBITAL_SWAP_BENCH
+    swap_bench( iterations, CarrierSNRdB, NumberOfCarriers, WaterLeveldB_out,
+                AllocationMap, BitsPerDMTSymbol, CarrierBitAllocation );
+#endif
+#if FBITAL_WIDE_BENCH
+    wide_bench( iterations, CarrierSNRdB, NumberOfCarriers, AllocationMap, BitsPerDMTSymbol );
+#endif
+
+    /* Untimed: the convergence of each call, the same in every iteration */
+    fxpBitAllocationStats(CarrierSNRdB,CarrierBitAllocation,NumberOfCarriers,
+                          WaterLeveldB, &WaterLeveldB_out, AllocationMap,
+                          BitsPerDMTSymbol, &stats );
+
+    /* v1: passes per call, v2: final delta, v3: all passes, v4: ns per pass */
     results.iterations = iterations;
-    results.v1         = 0;
-    results.v2         = 0;
-    results.v3         = 0;
+    results.v1         = stats.Passes;
+    results.v2         = stats.FinalDelta;
+    results.v3         = iterations * stats.Passes;
+#if FLOAT_SUPPORT
+    results.v4         = results.v3 > 0 ? (size_t)( (double)results.duration * 1e9 /
+                                         th_ticks_per_sec() / results.v3 ) : 0;
+#else
     results.v4         = 0;
+#endif
     results.info       = info;
+    results.verify_snr = FALSE;
 
-    th_sprintf( info, "A note of basic info" );
+    /* The telecom harness shows v1..v4 as doubles, so repeat them here */
+    th_sprintf( info, "%d passes per call, final delta %ld, %lu ns per pass",
+                stats.Passes, (long)stats.FinalDelta, (unsigned long)results.v4 );
 
 #if	NON_INTRUSIVE_CRC_CHECK
-	results.CRC = 0;
+	results.CRC = Calc_crc_buf16( (const e_u16 *)CarrierBitAllocation, (size_t)NumberOfCarriers, 0 );
 #elif	CRC_CHECK
 	results.CRC=0;
 #else
@@ -302,9 +686,6 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 
 	/* Verification */ 
   for( loop_cnt=0; loop_cnt<NumberOfCarriers; loop_cnt++ ){
-#if	NON_INTRUSIVE_CRC_CHECK
-	results.CRC = Calc_crc16(CarrierBitAllocation[loop_cnt],results.CRC);
-#endif
     if(CarrierBitAllocation[loop_cnt] != golden_result[loop_cnt]){
       th_printf("Failure: Expected [%d] Actual(%d) != golden(%d)\n",loop_cnt,CarrierBitAllocation[loop_cnt],golden_result[loop_cnt]);
 	  results.v1         = loop_cnt;
@@ -316,30 +697,12 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 
 
 #if	!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
-	/* Calculate the size of the output buffer */ 
-   TempVal   = 0;            
-   tmp_buf   = (n_char *)th_malloc(16); /* should acommodate largest single token */
-   if( tmp_buf == NULL )
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
-
+	/* Stream the output to the host as it is formatted */
+   th_file_begin( outFilename );
    for( i=0; i<NumberOfCarriers; i++ ){
-       TempVal += th_sprintf( tmp_buf, " %d\n", CarrierBitAllocation[i]);
+       th_file_printf( " %d\n", CarrierBitAllocation[i]);
    }
-   th_free(tmp_buf); 
-
-   /* Uploading is different as well,
-    * Since we do not have input buffer, we need to 
-	* use one of our own 
-    */ 
-    out_symbol_buffer  = (e_u8 *)th_malloc(TempVal+1);
-	if( out_symbol_buffer == NULL )
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
-
-    stringHeadPtr = (n_char *)out_symbol_buffer; 
-    for( i=0; i<NumberOfCarriers; i++ ){
-       stringHeadPtr += th_sprintf( (char *)stringHeadPtr, " %d\n", CarrierBitAllocation[i]);
-    }
-    th_send_buf_as_file((const char *)out_symbol_buffer,TempVal,outFilename);
+   th_file_end();
 #endif
 
 		return th_report_results( &results, EXPECTED_CRC );
@@ -59,7 +59,8 @@ TCDef the_tcdef =
 	0,
 	0,
 	0,
-	0
+	0,
+	FALSE
 }; 
 
 /* encapsulated data */ 
@@ -67,7 +68,7 @@ TCDef the_tcdef =
 #define MAX_CARRIERS		256  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	1920
 #define OUTFILENAME "vtypbaiOut.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "vtypbai.dat"
 };
 static e_s16 test_buf[] = { 
@@ -77,7 +78,7 @@ static e_s16 test_buf[] = {
 #define MAX_CARRIERS		256  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	1920
 #define OUTFILENAME "xtypsnriOut.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xtypsnri.dat"
 };
 static e_s16 test_buf[] = { 
@@ -87,7 +88,7 @@ static e_s16 test_buf[] = {
 #define MAX_CARRIERS		20  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	120
 #define OUTFILENAME "xstepsnriOut.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xstepsnri.dat"
 };
 static e_s16 test_buf[] = { 
@@ -97,7 +98,7 @@ static e_s16 test_buf[] = {
 #define MAX_CARRIERS		20  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	120
 #define OUTFILENAME "vstepbaiOut.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "vstepbai.dat"
 };
 static e_s16 test_buf[] = { 
@@ -107,7 +108,7 @@ static e_s16 test_buf[] = {
 #define MAX_CARRIERS		20  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	120
 #define OUTFILENAME "vpentbaiOut.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "vpentbai.dat"
 };
 static e_s16 test_buf[] = { 
@@ -118,7 +119,7 @@ static e_s16 test_buf[] = {
 #define MAX_CARRIERS		100  /* this is the actual file size */ 
 #define	BITSPERDMTSYMBOL	500
 #define OUTFILENAME "xpentsnriOut.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xpentsnri.dat"
 };
 static e_s16 test_buf[] = { 
@@ -126,7 +127,7 @@ static e_s16 test_buf[] = {
 }; 
 #endif /* included data */
 
-static e_s16 alloc_map_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 alloc_map_buf[] = {
 #include "allocmapi.dat"
 };
 #define T_BSIZE (sizeof(e_s16)*(MAX_CARRIERS*2))
@@ -231,10 +232,13 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 		        BitsPerDMTSymbol,NumberOfCarriers,MAX_BITS_PER_CARRIER);
     }
 
+    fxpBitAllocSelectKernel();  /* pick the kernel variants, see th_kernel_select() */
+
     /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
      * This is the actual benchmark
      */
 
+    th_latency_begin( tcdef->rec_iterations );
     th_signal_start();  /* Tell the host that the test has begun */
 
      /* no stopping!  Do ALL the iterations */
@@ -243,6 +247,7 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
         fxpBitAllocation(CarrierSNRdB,CarrierBitAllocation,NumberOfCarriers,
                          WaterLeveldB, &WaterLeveldB_out, AllocationMap, 
                          BitsPerDMTSymbol, loop_cnt );
+        th_latency_mark();
     } /* end for */
 
 
@@ -250,7 +255,7 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 	tcdef->iterations	= loop_cnt;
 
 #if	NON_INTRUSIVE_CRC_CHECK
-	tcdef->CRC = 0;
+	tcdef->CRC = Calc_crc_buf16( (const e_u16 *)CarrierBitAllocation, (size_t)NumberOfCarriers, 0 );
 #elif	CRC_CHECK
 	tcdef->CRC=0;
 #else
@@ -259,9 +264,6 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 
 	/* Verification */ 
   for( loop_cnt=0; loop_cnt<NumberOfCarriers; loop_cnt++ ){
-#if	NON_INTRUSIVE_CRC_CHECK
-	tcdef->CRC = Calc_crc16(CarrierBitAllocation[loop_cnt],tcdef->CRC);
-#endif
     if(CarrierBitAllocation[loop_cnt] != golden_result[loop_cnt]){
       th_printf("Failure: Expected [%d] Actual(%d) != golden(%d)\n",loop_cnt,CarrierBitAllocation[loop_cnt],golden_result[loop_cnt]);
 	  tcdef->v1         = loop_cnt;
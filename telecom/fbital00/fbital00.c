@@ -12,11 +12,611 @@
 *******************************************************************************/
 #include "algo.h"
 
+#if FBITAL_SIMD
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#endif
+
+/*******************************************************************************
+    Defines                                                                     
+*******************************************************************************/
+/*
+ * FBITAL_VEC_CARRIERS: carriers per vector of the FBITAL_SIMD allocation
+ * pass, 0 when the compiler targets neither SSE2 nor NEON.
+ * FBITAL_VEC_MIN_CARRIERS: the fewest carriers the vector pass is used for.
+ */
+#if FBITAL_SIMD && (defined(__SSE2__) || defined(__ARM_NEON))
+#define FBITAL_VEC_CARRIERS 8
+#define FBITAL_VEC_MIN_CARRIERS 64
+#else
+#define FBITAL_VEC_CARRIERS 0
+#endif
+
 /*******************************************************************************
     Functions                                                                   
 *******************************************************************************/
+#if FBITAL_VEC_CARRIERS
 /*------------------------------------------------------------------------------
- * FUNC    : FxpBitAllocation
+ * FUNC    : MapThresholds
+ *
+ * DESC    : 
+ * For a non-decreasing AllocationMap of at most MAX_BITS_PER_CARRIER bits,
+ * Thresholds[b] is the first index with more than b bits, or
+ * ALLOCATION_MAP_SIZE. AllocationMap[i] is then the number of thresholds
+ * not above i, which vectors count with compares instead of a gather.
+ *
+ * RETURNS : TRUE if AllocationMap has that form
+ * ---------------------------------------------------------------------------*/
+static n_int
+MapThresholds (
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    e_s16       *Thresholds             /* MAX_BITS_PER_CARRIER indices */
+)
+{
+    n_int   i, b;
+
+    b = 0;
+    for (i = 0; i < ALLOCATION_MAP_SIZE; i++) {
+        if (AllocationMap[i] < b || AllocationMap[i] > MAX_BITS_PER_CARRIER)
+            return FALSE;
+        while (b < AllocationMap[i])
+            Thresholds[b++] = (e_s16)i;
+    }
+    while (b < MAX_BITS_PER_CARRIER)
+        Thresholds[b++] = ALLOCATION_MAP_SIZE;
+    return TRUE;
+}
+
+/*
+ * FbitalVec, VecLevel: A vector of FBITAL_VEC_CARRIERS 16-bit lanes, and the
+ * constants of one water level broadcast for VecBits.
+ */
+#if defined(__SSE2__)
+typedef __m128i FbitalVec;
+#else
+typedef int16x8_t FbitalVec;
+#endif
+
+typedef struct {
+    FbitalVec   Level;
+    FbitalVec   Big;
+    FbitalVec   Max;
+    FbitalVec   Thresholds[MAX_BITS_PER_CARRIER];
+} VecLevel;
+
+/*------------------------------------------------------------------------------
+ * FUNC    : VecLevelInit
+ *
+ * DESC    : 
+ * Broadcasts the water level, the highest SNR not more than 32767 above
+ * it and the thresholds.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+static void
+VecLevelInit (VecLevel *v, e_s16 WaterLeveldB, const e_s16 *Thresholds)
+{
+    e_s16   Big;
+    n_int   b;
+
+    Big = (e_s16)(WaterLeveldB < 0 ? WaterLeveldB + 32767 : 32767);
+#if defined(__SSE2__)
+    v->Level = _mm_set1_epi16(WaterLeveldB);
+    v->Big   = _mm_set1_epi16(Big);
+    v->Max   = _mm_set1_epi16(MAX_BITS_PER_CARRIER);
+    for (b = 0; b < MAX_BITS_PER_CARRIER; b++)
+        v->Thresholds[b] = _mm_set1_epi16((e_s16)(Thresholds[b] - 1));
+#else
+    v->Level = vdupq_n_s16(WaterLeveldB);
+    v->Big   = vdupq_n_s16(Big);
+    v->Max   = vdupq_n_s16(MAX_BITS_PER_CARRIER);
+    for (b = 0; b < MAX_BITS_PER_CARRIER; b++)
+        v->Thresholds[b] = vdupq_n_s16(Thresholds[b]);
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : VecBits
+ *
+ * DESC    : 
+ * The unlimited bits of FBITAL_VEC_CARRIERS carriers. The map index of
+ * each lane is the wrapped 16-bit difference shifted down by 6, compares
+ * against the thresholds count its bits, and lanes below the water level
+ * or more than 32767 above it are masked to 0 or MAX_BITS_PER_CARRIER.
+ *
+ * RETURNS : The bits of each lane
+ * ---------------------------------------------------------------------------*/
+static FbitalVec
+VecBits (const VecLevel *v, const e_s16 *CarrierSNRdB)
+{
+#if defined(__SSE2__)
+    __m128i s, Below, Above, Index, Bits, Odd;
+    n_int   b;
+
+    s     = _mm_loadu_si128((const __m128i *)CarrierSNRdB);
+    Below = _mm_cmpgt_epi16(v->Level, s);
+    Above = _mm_cmpgt_epi16(s, v->Big);
+    Index = _mm_srli_epi16(_mm_sub_epi16(s, v->Level), 6);
+    Bits  = _mm_setzero_si128();
+    Odd   = _mm_setzero_si128();
+
+    /* Unrolled into two sums, to keep the compares independent */
+    for (b = 0; b + 4 <= MAX_BITS_PER_CARRIER; b += 4) {
+        Bits = _mm_sub_epi16(Bits, _mm_cmpgt_epi16(Index, v->Thresholds[b]));
+        Odd  = _mm_sub_epi16(Odd, _mm_cmpgt_epi16(Index, v->Thresholds[b + 1]));
+        Bits = _mm_sub_epi16(Bits, _mm_cmpgt_epi16(Index, v->Thresholds[b + 2]));
+        Odd  = _mm_sub_epi16(Odd, _mm_cmpgt_epi16(Index, v->Thresholds[b + 3]));
+    }
+    for (; b < MAX_BITS_PER_CARRIER; b++)
+        Bits = _mm_sub_epi16(Bits, _mm_cmpgt_epi16(Index, v->Thresholds[b]));
+    Bits  = _mm_add_epi16(Bits, Odd);
+    Bits  = _mm_andnot_si128(Below, Bits);
+    return _mm_or_si128(_mm_andnot_si128(Above, Bits), _mm_and_si128(Above, v->Max));
+#else
+    int16x8_t   s, Index, Bits, Odd;
+    uint16x8_t  Below, Above;
+    n_int       b;
+
+    s     = vld1q_s16(CarrierSNRdB);
+    Below = vcgtq_s16(v->Level, s);
+    Above = vcgtq_s16(s, v->Big);
+    Index = vreinterpretq_s16_u16(vshrq_n_u16(vreinterpretq_u16_s16(vsubq_s16(s, v->Level)), 6));
+    Bits  = vdupq_n_s16(0);
+    Odd   = vdupq_n_s16(0);
+    for (b = 0; b + 2 <= MAX_BITS_PER_CARRIER; b += 2) {
+        Bits = vsubq_s16(Bits, vreinterpretq_s16_u16(vcgeq_s16(Index, v->Thresholds[b])));
+        Odd  = vsubq_s16(Odd, vreinterpretq_s16_u16(vcgeq_s16(Index, v->Thresholds[b + 1])));
+    }
+    for (; b < MAX_BITS_PER_CARRIER; b++)
+        Bits = vsubq_s16(Bits, vreinterpretq_s16_u16(vcgeq_s16(Index, v->Thresholds[b])));
+    Bits  = vaddq_s16(Bits, Odd);
+    Bits  = vbicq_s16(Bits, vreinterpretq_s16_u16(Below));
+    return vbslq_s16(Above, v->Max, Bits);
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : VecSum
+ *
+ * DESC    : 
+ * Adds the lanes of a VecBits result.
+ *
+ * RETURNS : The sum
+ * ---------------------------------------------------------------------------*/
+static e_s32
+VecSum (FbitalVec Bits)
+{
+#if defined(__SSE2__)
+    __m128i Pairs;
+
+    Pairs = _mm_madd_epi16(Bits, _mm_set1_epi16(1));
+    Pairs = _mm_add_epi32(Pairs, _mm_shuffle_epi32(Pairs, 0x4e));
+    Pairs = _mm_add_epi32(Pairs, _mm_shuffle_epi32(Pairs, 0xb1));
+    return _mm_cvtsi128_si32(Pairs);
+#else
+    int64x2_t   Pairs = vpaddlq_s32(vpaddlq_s16(Bits));
+
+    return (e_s32)(vgetq_lane_s64(Pairs, 0) + vgetq_lane_s64(Pairs, 1));
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AllocateCarriersVec
+ *
+ * DESC    : 
+ * Allocates or only counts the carriers FBITAL_VEC_CARRIERS at a time,
+ * while the running total stays within Limit. The vector that would
+ * exceed it is left to the caller: for AllocateCarriers the scalar loop
+ * limits its carriers in order, for LevelMeetsBudget it meets the budget.
+ *
+ * RETURNS : The number of carriers done, their bits added to *TotalBits
+ * ---------------------------------------------------------------------------*/
+static n_int
+AllocateCarriersVec (
+    const e_s16 *CarrierSNRdB,          /* input data */
+    e_s16       *CarrierBitAllocation,  /* output data, NULL to count */
+    e_s32       NumberOfCarriers,       /* size of input data */
+    e_s16       WaterLeveldB,           /* water level in dB */
+    const e_s16 *Thresholds,            /* from MapThresholds */
+    e_s32       Limit,                  /* largest total */
+    e_s32       *TotalBits              /* bits allocated */
+)
+{
+    VecLevel    v;
+    FbitalVec   Bits;
+    e_s32       Sum, Total;
+    n_int       ccb;
+
+    VecLevelInit(&v, WaterLeveldB, Thresholds);
+    Total = *TotalBits;
+    for (ccb = 0; ccb + FBITAL_VEC_CARRIERS <= NumberOfCarriers; ccb += FBITAL_VEC_CARRIERS) {
+        Bits = VecBits(&v, CarrierSNRdB + ccb);
+        Sum  = VecSum(Bits);
+        if (Total + Sum > Limit)
+            break;
+        if (CarrierBitAllocation != NULL) {
+#if defined(__SSE2__)
+            _mm_storeu_si128((__m128i *)(CarrierBitAllocation + ccb), Bits);
+#else
+            vst1q_s16(CarrierBitAllocation + ccb, Bits);
+#endif
+        }
+        Total += Sum;
+    }
+    *TotalBits = Total;
+    return ccb;
+}
+
+/* The vector pass fxpBitAllocSelectKernel picked, NULL for scalar */
+static n_int (*AllocVec)(const e_s16 *, e_s16 *, e_s32, e_s16, const e_s16 *, e_s32,
+                         e_s32 *) = AllocateCarriersVec;
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpBitAllocSelectKernel
+ *
+ * DESC    : 
+ * Picks the vector passes of FBITAL_SIMD, or the scalar passes, with
+ * th_kernel_select: the best the CPU runs unless -kernel= forces one.
+ * Without vector passes there is nothing to pick.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void
+fxpBitAllocSelectKernel (void)
+{
+#if FBITAL_VEC_CARRIERS
+    static const THKernelVariant Variants[] = {
+#if defined(__SSE2__)
+        { "sse2",   TH_CPU_SSE2 },
+#else
+        { "neon",   TH_CPU_NEON },
+#endif
+        { "scalar", 0 }
+    };
+
+    AllocVec = th_kernel_select("bitalloc", Variants, 2) == 0 ? AllocateCarriersVec : NULL;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : AllocateCarriers
+ *
+ * DESC    : 
+ * One allocation pass at WaterLeveldB: each carrier gets the AllocationMap
+ * bits of its SNR above the water level, limited so that the total does
+ * not exceed BitsPerDMTSymbol. Given Thresholds, the FBITAL_SIMD vector
+ * pass allocates the carriers up to the one that reaches the budget.
+ *
+ * RETURNS : The total number of bits allocated
+ * ---------------------------------------------------------------------------*/
+static e_s32
+AllocateCarriers (
+    const e_s16 *CarrierSNRdB,          /* input data */
+    e_s16       *CarrierBitAllocation,  /* output data */
+    e_s32       NumberOfCarriers,       /* size of input data */
+    e_s16       WaterLeveldB,           /* water level in dB */
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    const e_s16 *Thresholds,            /* MapThresholds, NULL for scalar */
+    e_s32       BitsPerDMTSymbol        /* total bits for allocation */
+)
+{
+    e_s32    TotalBits;
+    e_s32    CarrierBits;
+    e_s32    ccb;
+    e_s32    DeltadB;
+
+    TotalBits = 0;
+    ccb = 0;
+#if FBITAL_VEC_CARRIERS
+    if (Thresholds != NULL)
+        ccb = (*AllocVec)(CarrierSNRdB, CarrierBitAllocation, NumberOfCarriers,
+                          WaterLeveldB, Thresholds, BitsPerDMTSymbol, &TotalBits);
+#else
+    Thresholds = Thresholds;
+#endif
+    for (; ccb < NumberOfCarriers; ccb++) {
+        DeltadB = CarrierSNRdB[ccb] - WaterLeveldB;
+
+        /* Check if any bits can be allocated to this carrier */
+        if (DeltadB < 0) {
+            CarrierBits = 0;
+        } 
+        else {
+            if (DeltadB > 32767) {
+                CarrierBits = MAX_BITS_PER_CARRIER;
+            } 
+            else {
+                CarrierBits = AllocationMap[(DeltadB >> 6)];
+            }
+
+            /* Limit per BitsPerDMTSymbol */
+            /* Needed to insure convergence */
+            if ((CarrierBits + TotalBits) > BitsPerDMTSymbol) {
+                CarrierBits = BitsPerDMTSymbol - TotalBits;
+            }
+        }
+
+        /* Assign bits to carrier */
+        CarrierBitAllocation[ccb] = (e_s16)CarrierBits;
+        TotalBits += CarrierBits;
+    }
+    return TotalBits;
+}
+
+#if FBITAL_BISECTION && !FBITAL_HISTOGRAM
+/*------------------------------------------------------------------------------
+ * FUNC    : LevelMeetsBudget
+ *
+ * DESC    : 
+ * Counts the unlimited AllocationMap bits of the carriers at WaterLeveldB,
+ * stopping as soon as BitsPerDMTSymbol is reached. The count can only fall
+ * as the water level rises. Given Thresholds, whole vectors are counted
+ * first.
+ *
+ * RETURNS : TRUE if the carriers take at least BitsPerDMTSymbol bits
+ * ---------------------------------------------------------------------------*/
+static n_int
+LevelMeetsBudget (
+    const e_s16 *CarrierSNRdB,          /* input data */
+    e_u16       NumberOfCarriers,       /* size of input data */
+    e_s32       WaterLeveldB,           /* water level in dB */
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    const e_s16 *Thresholds,            /* MapThresholds, NULL for scalar */
+    e_u16       BitsPerDMTSymbol        /* total bits for allocation */
+)
+{
+    e_s32    TotalBits;
+    e_s32    DeltadB;
+    e_s16   ccb;
+
+    TotalBits = 0;
+    ccb = 0;
+#if FBITAL_VEC_CARRIERS
+    if (Thresholds != NULL && BitsPerDMTSymbol > 0) {
+        ccb = (e_s16)(*AllocVec)(CarrierSNRdB, NULL, NumberOfCarriers, (e_s16)WaterLeveldB,
+                                 Thresholds, BitsPerDMTSymbol - 1, &TotalBits);
+        if (ccb + FBITAL_VEC_CARRIERS <= NumberOfCarriers)
+            return TRUE;
+    }
+#else
+    Thresholds = Thresholds;
+#endif
+    for (; ccb < NumberOfCarriers; ccb++) {
+        DeltadB = CarrierSNRdB[ccb] - WaterLeveldB;
+        if (DeltadB >= 0) {
+            TotalBits += DeltadB > 32767 ? MAX_BITS_PER_CARRIER
+                                         : AllocationMap[(DeltadB >> 6)];
+            if (TotalBits >= BitsPerDMTSymbol)
+                return TRUE;
+        }
+    }
+    return BitsPerDMTSymbol == 0;
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BucketBits
+ *
+ * DESC    : 
+ * The bits of a carrier whose SNR above the water level has AllocationMap
+ * index Bucket: none below the map and MAX_BITS_PER_CARRIER above it.
+ *
+ * RETURNS : The number of bits
+ * ---------------------------------------------------------------------------*/
+static e_s32
+BucketBits (
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    e_s32       Bucket                  /* (SNR - water level) >> 6 */
+)
+{
+    if (Bucket < 0)
+        return 0;
+    if (Bucket >= ALLOCATION_MAP_SIZE)
+        return MAX_BITS_PER_CARRIER;
+    return AllocationMap[Bucket];
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : HistogramBits
+ *
+ * DESC    : 
+ * The unlimited total bits of the carriers counted in Histogram, at the
+ * water level of bin LevelBin (level LevelBin * 64 - 32768). Stops once
+ * Limit is reached.
+ *
+ * RETURNS : The total, or a value >= Limit
+ * ---------------------------------------------------------------------------*/
+static e_s32
+HistogramBits (
+    const e_s32 *Histogram,             /* carriers per SNR bin */
+    e_s32       LevelBin,               /* water level bin */
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    e_s32       Limit                   /* early exit total */
+)
+{
+    e_s32    TotalBits;
+    e_s32    Bin;
+
+    TotalBits = 0;
+    for (Bin = LevelBin; Bin < FBITAL_SNR_BINS; Bin++) {
+        TotalBits += Histogram[Bin] * BucketBits(AllocationMap, Bin - LevelBin);
+        if (TotalBits >= Limit)
+            break;
+    }
+    return TotalBits;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : HistogramCount
+ *
+ * DESC    : 
+ * Counts the SNRs of carriers First to Last-1 into the FBITAL_SNR_BINS
+ * bins of Histogram.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+static void
+HistogramCount (
+    const e_s16 *CarrierSNRdB,          /* input data */
+    e_s32       First,                  /* first carrier */
+    e_s32       Last,                   /* end of the carriers */
+    e_s32       *Histogram              /* carriers per SNR bin */
+)
+{
+    e_s32    ccb, Bin;
+
+    for (Bin = 0; Bin < FBITAL_SNR_BINS; Bin++)
+        Histogram[Bin] = 0;
+    for (ccb = First; ccb < Last; ccb++)
+        Histogram[(CarrierSNRdB[ccb] + 32768L) >> 6]++;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : HistogramLevelBin
+ *
+ * DESC    : 
+ * Bisects Histogram for the highest water level bin, no higher than the
+ * bin of WaterLeveldB_in, at which the carriers take at least
+ * BitsPerDMTSymbol unlimited bits, and stores their bits there.
+ *
+ * RETURNS : The bin, -1 if even bin 0 falls short
+ * ---------------------------------------------------------------------------*/
+static e_s32
+HistogramLevelBin (
+    const e_s32 *Histogram,             /* carriers per SNR bin */
+    e_s16       WaterLeveldB_in,        /* Starting water level in dB */
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    e_s32       BitsPerDMTSymbol,       /* total bits for allocation */
+    e_s32       *TotalBits              /* bits at the bin */
+)
+{
+    e_s32    Low, High, Mid;
+
+    /* The budget is met at bin Low and not at bin High */
+    if (HistogramBits(Histogram, 0, AllocationMap, BitsPerDMTSymbol) < BitsPerDMTSymbol)
+        return -1;
+    Low = 0;
+    High = ((WaterLeveldB_in + 32768L) >> 6) + 1;
+    while (High - Low > 1) {
+        Mid = Low + (High - Low) / 2;
+        if (HistogramBits(Histogram, Mid, AllocationMap, BitsPerDMTSymbol) >= BitsPerDMTSymbol)
+            Low = Mid;
+        else
+            High = Mid;
+    }
+    *TotalBits = HistogramBits(Histogram, Low, AllocationMap, 0x7fffffffL);
+    return Low;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : HistogramLosses
+ *
+ * DESC    : 
+ * Bins the bits each of carriers First to Last-1 loses once the water
+ * level rises past its SNR residual within bin LevelBin.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+static void
+HistogramLosses (
+    const e_s16 *CarrierSNRdB,          /* input data */
+    e_s32       First,                  /* first carrier */
+    e_s32       Last,                   /* end of the carriers */
+    e_s32       LevelBin,               /* water level bin */
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    e_s32       *Losses                 /* 64 bits lost per residual */
+)
+{
+    e_s32    ccb, Index, Bucket, Offset;
+
+    for (Offset = 0; Offset < 64; Offset++)
+        Losses[Offset] = 0;
+    for (ccb = First; ccb < Last; ccb++) {
+        Index  = CarrierSNRdB[ccb] + 32768L;
+        Bucket = (Index >> 6) - LevelBin;
+        Losses[Index & 63] += BucketBits(AllocationMap, Bucket) -
+                              BucketBits(AllocationMap, Bucket - 1);
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : LossesWaterLevel
+ *
+ * DESC    : 
+ * Raises the water level from bin LevelBin, where the carriers take
+ * TotalBits, one unit at a time for as long as they still take
+ * BitsPerDMTSymbol bits, up to WaterLeveldB_in.
+ *
+ * RETURNS : The water level
+ * ---------------------------------------------------------------------------*/
+static e_s16
+LossesWaterLevel (
+    const e_s32 *Losses,                /* 64 bits lost per residual */
+    e_s32       LevelBin,               /* water level bin */
+    e_s32       TotalBits,              /* bits at the bin */
+    e_s16       WaterLeveldB_in,        /* Starting water level in dB */
+    e_s32       BitsPerDMTSymbol        /* total bits for allocation */
+)
+{
+    e_s32    Top, Offset;
+
+    Top = WaterLeveldB_in + 32768L - LevelBin * 64;
+    if (Top > 63)
+        Top = 63;
+    for (Offset = 0; Offset < Top; Offset++) {
+        TotalBits -= Losses[Offset];
+        if (TotalBits < BitsPerDMTSymbol)
+            break;
+    }
+    return (e_s16)(LevelBin * 64 + Offset - 32768L);
+}
+
+#if FBITAL_HISTOGRAM
+/*------------------------------------------------------------------------------
+ * FUNC    : HistogramWaterLevel
+ *
+ * DESC    : 
+ * The highest water level, no higher than WaterLeveldB_in, at which the
+ * carriers take at least BitsPerDMTSymbol unlimited bits. The level's bin
+ * is bisected over the SNR histogram. Within the bin, raising the level
+ * by one unit moves the carriers with that SNR residual down one map
+ * index, so a histogram of their bit losses by residual gives the total
+ * at each of the 64 levels.
+ *
+ * RETURNS : The water level, -32768 if even that level falls short
+ * ---------------------------------------------------------------------------*/
+static e_s16
+HistogramWaterLevel (
+    const e_s16 *CarrierSNRdB,          /* input data */
+    e_u16       NumberOfCarriers,       /* size of input data */
+    e_s16       WaterLeveldB_in,        /* Starting water level in dB */
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    e_u16       BitsPerDMTSymbol,       /* total bits for allocation */
+    n_int       *Passes                 /* incremented per carrier pass */
+)
+{
+    e_s32    Histogram[FBITAL_SNR_BINS];
+    e_s32    Losses[64];
+    e_s32    Low, TotalBits;
+
+    HistogramCount(CarrierSNRdB, 0, NumberOfCarriers, Histogram);
+    ++*Passes;
+    Low = HistogramLevelBin(Histogram, WaterLeveldB_in, AllocationMap, BitsPerDMTSymbol,
+                            &TotalBits);
+    if (Low < 0)
+        return -32768;
+    HistogramLosses(CarrierSNRdB, 0, NumberOfCarriers, Low, AllocationMap, Losses);
+    ++*Passes;
+    return LossesWaterLevel(Losses, Low, TotalBits, WaterLeveldB_in, BitsPerDMTSymbol);
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FxpBitAllocationStats
  *
  * DESC    : 
  * Allocate BitsPerDMTSymbol over a set (size = NumberOfCarriers) of carriers
@@ -31,11 +631,20 @@
  * The range of CarrierSNR (dB) [-64.0, 63.998] (float)
  * is represented by the range [-32768, 32767] (fixed)
  *
+ * With FBITAL_BISECTION or FBITAL_HISTOGRAM the final water level is the
+ * highest one at which the allocation is exact. Any level down to the next
+ * step of the AllocationMap gives the same allocation, so the stepped
+ * search can end a little lower with the same result.
+ *
+ * Given Stats, the number of passes over the carriers and the bits short
+ * of BitsPerDMTSymbol at the end, 0 once the allocation is exact, are
+ * stored there.
+ *
  * RETURNS : 
  * ---------------------------------------------------------------------------*/
 
 void
-fxpBitAllocation (
+fxpBitAllocationStats (
     e_s16   *CarrierSNRdB,           /* input data */
     e_s16   *CarrierBitAllocation,   /* output data */
     e_u16    NumberOfCarriers,       /* size of input data */
@@ -43,49 +652,64 @@ fxpBitAllocation (
     e_s16   *WaterLeveldB_out,       /* Final water level in dB */
     e_s16   *AllocationMap,          /* Lookup Table */
     e_u16    BitsPerDMTSymbol,        /* total bits for allocation */
-	size_t	loop_cnt
-
+    BitAllocStats *Stats             /* convergence, NULL to ignore */
 )
 
 {
-    e_u16    TotalBits;
-    e_u16    CarrierBits;
-    e_s16   ccb;
-    e_s32    DeltadB;
     e_s16   l_WaterLeveldB;
+    e_s32   Allocated;
+    n_int   Passes = 0;
+#if FBITAL_VEC_CARRIERS
+    /* Below FBITAL_VEC_MIN_CARRIERS the setup costs more than the vectors save */
+    e_s16   ThresholdBuf[MAX_BITS_PER_CARRIER];
+    const e_s16 *Thresholds = AllocVec != NULL && NumberOfCarriers >= FBITAL_VEC_MIN_CARRIERS &&
+                              MapThresholds(AllocationMap, ThresholdBuf) ? ThresholdBuf : NULL;
+#else
+    const e_s16 *Thresholds = NULL;
+#endif
+#if FBITAL_HISTOGRAM
+    l_WaterLeveldB = HistogramWaterLevel(CarrierSNRdB, NumberOfCarriers, WaterLeveldB_in,
+                                         AllocationMap, BitsPerDMTSymbol, &Passes);
+
+    Allocated = AllocateCarriers(CarrierSNRdB, CarrierBitAllocation, NumberOfCarriers,
+                                 l_WaterLeveldB, AllocationMap, Thresholds, BitsPerDMTSymbol);
+    Passes++;
+#elif FBITAL_BISECTION
+    e_s32    Low, High, Mid;
+
+    /* The budget is met at Low and not at High */
+    High = WaterLeveldB_in;
+    Passes++;
+    if (!LevelMeetsBudget(CarrierSNRdB, NumberOfCarriers, High,
+                          AllocationMap, Thresholds, BitsPerDMTSymbol)) {
+        Low = -32768;
+        while (High - Low > 1) {
+            Mid = Low + (High - Low) / 2;
+            Passes++;
+            if (LevelMeetsBudget(CarrierSNRdB, NumberOfCarriers, Mid,
+                                 AllocationMap, Thresholds, BitsPerDMTSymbol))
+                Low = Mid;
+            else
+                High = Mid;
+        }
+        High = Low;
+    }
+    l_WaterLeveldB = (e_s16)High;
+
+    Allocated = AllocateCarriers(CarrierSNRdB, CarrierBitAllocation, NumberOfCarriers,
+                                 l_WaterLeveldB, AllocationMap, Thresholds, BitsPerDMTSymbol);
+    Passes++;
+#else
+    e_u16    TotalBits;
 
     /* Make a working copy */
     l_WaterLeveldB = WaterLeveldB_in;
 
     do {
         /* Allocate bits based on current water level */
-        TotalBits = 0;
-        for (ccb = 0; ccb < NumberOfCarriers; ccb++) {
-            DeltadB = CarrierSNRdB[ccb] - l_WaterLeveldB;
-
-            /* Check if any bits can be allocated to this carrier */
-            if (DeltadB < 0) {
-                CarrierBits = 0;
-            } 
-            else {
-                if (DeltadB > 32767) {
-                    CarrierBits = MAX_BITS_PER_CARRIER;
-			    } 
-                else {
-                    CarrierBits = AllocationMap[(DeltadB >> 6)];
-                }
-
-                /* Limit per BitsPerDMTSymbol */
-                /* Needed to insure convergence */
-                if ((CarrierBits + TotalBits) > BitsPerDMTSymbol) {
-                    CarrierBits = BitsPerDMTSymbol - TotalBits;
-                }
-            }
-
-            /* Assign bits to carrier */
-            CarrierBitAllocation[ccb] = CarrierBits;
-            TotalBits += CarrierBits;
-        }
+        TotalBits = (e_u16)AllocateCarriers(CarrierSNRdB, CarrierBitAllocation, NumberOfCarriers,
+                                            l_WaterLeveldB, AllocationMap, Thresholds, BitsPerDMTSymbol);
+        Passes++;
 
         /* Update water level */
 /* bug 90, 121
@@ -97,10 +721,737 @@ fxpBitAllocation (
 
     
     } while (TotalBits != BitsPerDMTSymbol);
+    Allocated = TotalBits;
+#endif
 
     /* Store the result back to the caller */
     *WaterLeveldB_out = l_WaterLeveldB;
-    
+    if (Stats != NULL) {
+        Stats->Passes     = Passes;
+        Stats->FinalDelta = BitsPerDMTSymbol - Allocated;
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FxpBitAllocation
+ *
+ * DESC    : 
+ * fxpBitAllocationStats without the convergence statistics.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+
+void
+fxpBitAllocation (
+    e_s16   *CarrierSNRdB,           /* input data */
+    e_s16   *CarrierBitAllocation,   /* output data */
+    e_u16    NumberOfCarriers,       /* size of input data */
+    e_s16   WaterLeveldB_in,         /* Starting water level in dB */
+    e_s16   *WaterLeveldB_out,       /* Final water level in dB */
+    e_s16   *AllocationMap,          /* Lookup Table */
+    e_u16    BitsPerDMTSymbol,        /* total bits for allocation */
+	size_t	loop_cnt
+
+)
+
+{
+    fxpBitAllocationStats(CarrierSNRdB, CarrierBitAllocation, NumberOfCarriers,
+                          WaterLeveldB_in, WaterLeveldB_out, AllocationMap,
+                          BitsPerDMTSymbol, NULL);
+}
+
+/*------------------------------------------------------------------------------
+ * BitAllocWide: The state of fxpBitAllocationWide, the histogram search
+ * of FBITAL_HISTOGRAM in e_s32 counts. Each pass over the carriers is
+ * split into NumParts parts of consecutive carriers, with their own
+ * histograms, losses and bits, that BitAllocWideMerge combines.
+ * ---------------------------------------------------------------------------*/
+struct BitAllocWide {
+    n_int       NumParts;
+    n_int       Phase;
+    const e_s16 *CarrierSNRdB;
+    e_s16       *CarrierBitAllocation;
+    e_s32       NumberOfCarriers;
+    e_s16       WaterLeveldB_in;
+    e_s16       WaterLeveldB;
+    const e_s16 *AllocationMap;
+    const e_s16 *Thresholds;
+    e_s16       ThresholdBuf[MAX_BITS_PER_CARRIER];
+    e_s32       BitsPerDMTSymbol;
+    e_s32       LevelBin;
+    e_s32       TotalBits;
+    e_s32       *Histograms;
+    e_s32       *Losses;
+    e_s32       *PartBits;
+};
+
+/* The passes of fxpBitAllocationWide, in order */
+#define WIDE_HISTOGRAM  0
+#define WIDE_LOSSES     1
+#define WIDE_ALLOCATE   2
+#define WIDE_DONE       3
+
+/*------------------------------------------------------------------------------
+ * FUNC    : WidePart
+ *
+ * DESC    : The first of the NumberOfCarriers carriers in part Part of NumParts
+ *
+ * RETURNS : The carrier index; part NumParts gives NumberOfCarriers
+ * ---------------------------------------------------------------------------*/
+static e_s32
+WidePart (e_s32 NumberOfCarriers, n_int Part, n_int NumParts)
+{
+    return (e_s32)((long)NumberOfCarriers * Part / NumParts);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocWideInit
+ *
+ * DESC    : 
+ * The state of fxpBitAllocationWide for passes split into NumParts parts.
+ *
+ * RETURNS : The state, NULL if out of memory
+ * ---------------------------------------------------------------------------*/
+BitAllocWide *
+BitAllocWideInit (n_int NumParts)
+{
+    BitAllocWide *w;
+
+    w = (BitAllocWide *)th_malloc(sizeof(BitAllocWide));
+    if (w == NULL)
+        return NULL;
+    w->NumParts   = NumParts < 1 ? 1 : NumParts;
+    w->Phase      = WIDE_DONE;
+    w->Histograms = (e_s32 *)th_malloc((size_t)w->NumParts * FBITAL_SNR_BINS * sizeof(e_s32));
+    w->Losses     = (e_s32 *)th_malloc((size_t)w->NumParts * 64 * sizeof(e_s32));
+    w->PartBits   = (e_s32 *)th_malloc((size_t)w->NumParts * sizeof(e_s32));
+    if (w->Histograms == NULL || w->Losses == NULL || w->PartBits == NULL) {
+        BitAllocWideFree(w);
+        return NULL;
+    }
+    return w;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocWideFree
+ *
+ * DESC    : 
+ * Frees the state of fxpBitAllocationWide; NULL is ignored.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+void
+BitAllocWideFree (BitAllocWide *w)
+{
+    if (w == NULL)
+        return;
+    if (w->PartBits != NULL)
+        th_free(w->PartBits);
+    if (w->Losses != NULL)
+        th_free(w->Losses);
+    if (w->Histograms != NULL)
+        th_free(w->Histograms);
+    th_free(w);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocWideStart
+ *
+ * DESC    : 
+ * Starts an allocation of BitsPerDMTSymbol over NumberOfCarriers carriers,
+ * then run by BitAllocWidePass on every part and BitAllocWideMerge until
+ * it returns FALSE. The arguments are those of fxpBitAllocation.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+void
+BitAllocWideStart (
+    BitAllocWide *w,                    /* state */
+    const e_s16 *CarrierSNRdB,          /* input data */
+    e_s16       *CarrierBitAllocation,  /* output data */
+    e_s32       NumberOfCarriers,       /* size of input data */
+    e_s16       WaterLeveldB_in,        /* Starting water level in dB */
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    e_s32       BitsPerDMTSymbol        /* total bits for allocation */
+)
+{
+    w->Phase                = WIDE_HISTOGRAM;
+    w->CarrierSNRdB         = CarrierSNRdB;
+    w->CarrierBitAllocation = CarrierBitAllocation;
+    w->NumberOfCarriers     = NumberOfCarriers;
+    w->WaterLeveldB_in      = WaterLeveldB_in;
+    w->WaterLeveldB         = WaterLeveldB_in;
+    w->AllocationMap        = AllocationMap;
+    w->BitsPerDMTSymbol     = BitsPerDMTSymbol;
+    w->LevelBin             = 0;
+    w->TotalBits            = 0;
+#if FBITAL_VEC_CARRIERS
+    w->Thresholds = AllocVec != NULL &&
+                    NumberOfCarriers >= (long)FBITAL_VEC_MIN_CARRIERS * w->NumParts &&
+                    MapThresholds(AllocationMap, w->ThresholdBuf) ? w->ThresholdBuf : NULL;
+#else
+    w->Thresholds = NULL;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocWidePass
+ *
+ * DESC    : 
+ * Runs part Part of the current pass. The parts of a pass touch separate
+ * carriers and state, so separate threads can run them.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+void
+BitAllocWidePass (BitAllocWide *w, n_int Part)
+{
+    e_s32   First, Last;
+
+    First = WidePart(w->NumberOfCarriers, Part, w->NumParts);
+    Last  = WidePart(w->NumberOfCarriers, Part + 1, w->NumParts);
+    switch (w->Phase) {
+    case WIDE_HISTOGRAM:
+        HistogramCount(w->CarrierSNRdB, First, Last, w->Histograms + (long)Part * FBITAL_SNR_BINS);
+        break;
+    case WIDE_LOSSES:
+        HistogramLosses(w->CarrierSNRdB, First, Last, w->LevelBin, w->AllocationMap,
+                        w->Losses + (long)Part * 64);
+        break;
+    case WIDE_ALLOCATE:
+        /* Part 0 is limited to the budget as it goes, later parts by the merge */
+        w->PartBits[Part] = AllocateCarriers(w->CarrierSNRdB + First,
+                                             w->CarrierBitAllocation + First, Last - First,
+                                             w->WaterLeveldB, w->AllocationMap, w->Thresholds,
+                                             Part == 0 ? w->BitsPerDMTSymbol : 0x7fffffffL);
+        break;
+    default:
+        break;
+    }
 }
 
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocWideMerge
+ *
+ * DESC    : 
+ * Combines the parts of the pass just run and moves to the next. After
+ * the allocation pass the carriers from the part that exceeds
+ * BitsPerDMTSymbol on are limited in order, as in fxpBitAllocation.
+ *
+ * RETURNS : TRUE if another pass is to be run
+ * ---------------------------------------------------------------------------*/
+n_int
+BitAllocWideMerge (BitAllocWide *w)
+{
+    e_s32   Bin, Bits, ccb;
+    n_int   Part;
+
+    switch (w->Phase) {
+    case WIDE_HISTOGRAM:
+        for (Part = 1; Part < w->NumParts; Part++)
+            for (Bin = 0; Bin < FBITAL_SNR_BINS; Bin++)
+                w->Histograms[Bin] += w->Histograms[(long)Part * FBITAL_SNR_BINS + Bin];
+        w->LevelBin = HistogramLevelBin(w->Histograms, w->WaterLeveldB_in, w->AllocationMap,
+                                        w->BitsPerDMTSymbol, &w->TotalBits);
+        if (w->LevelBin < 0) {
+            w->WaterLeveldB = -32768;
+            w->Phase = WIDE_ALLOCATE;
+        }
+        else {
+            w->Phase = WIDE_LOSSES;
+        }
+        return TRUE;
+    case WIDE_LOSSES:
+        for (Part = 1; Part < w->NumParts; Part++)
+            for (Bin = 0; Bin < 64; Bin++)
+                w->Losses[Bin] += w->Losses[(long)Part * 64 + Bin];
+        w->WaterLeveldB = LossesWaterLevel(w->Losses, w->LevelBin, w->TotalBits,
+                                           w->WaterLeveldB_in, w->BitsPerDMTSymbol);
+        w->Phase = WIDE_ALLOCATE;
+        return TRUE;
+    case WIDE_ALLOCATE:
+        w->TotalBits = w->PartBits[0];
+        for (Part = 1; Part < w->NumParts; Part++) {
+            if (w->TotalBits + w->PartBits[Part] > w->BitsPerDMTSymbol)
+                break;
+            w->TotalBits += w->PartBits[Part];
+        }
+        if (Part < w->NumParts) {
+            for (ccb = WidePart(w->NumberOfCarriers, Part, w->NumParts);
+                 ccb < w->NumberOfCarriers; ccb++) {
+                Bits = w->CarrierBitAllocation[ccb];
+                if (Bits > w->BitsPerDMTSymbol - w->TotalBits)
+                    Bits = w->BitsPerDMTSymbol - w->TotalBits;
+                w->CarrierBitAllocation[ccb] = (e_s16)Bits;
+                w->TotalBits += Bits;
+            }
+        }
+        w->Phase = WIDE_DONE;
+        return FALSE;
+    default:
+        return FALSE;
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocWideWaterLevel
+ *
+ * DESC    : The water level of the last merged pass
+ *
+ * RETURNS : The water level in dB
+ * ---------------------------------------------------------------------------*/
+e_s16
+BitAllocWideWaterLevel (const BitAllocWide *w)
+{
+    return w->WaterLeveldB;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocWideTotalBits
+ *
+ * DESC    : The total bits once the allocation is done
+ *
+ * RETURNS : The number of bits
+ * ---------------------------------------------------------------------------*/
+e_s32
+BitAllocWideTotalBits (const BitAllocWide *w)
+{
+    return w->TotalBits;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpBitAllocationWide
+ *
+ * DESC    : 
+ * fxpBitAllocation for any number of carriers and bits, with the water
+ * level of FBITAL_HISTOGRAM: the highest, no higher than WaterLeveldB_in,
+ * at which the allocation is exact. The parts of each pass of w are run
+ * in turn; threads can instead run them with BitAllocWideStart,
+ * BitAllocWidePass and BitAllocWideMerge.
+ *
+ * RETURNS : The total number of bits allocated
+ * ---------------------------------------------------------------------------*/
+e_s32
+fxpBitAllocationWide (
+    BitAllocWide *w,                    /* state */
+    const e_s16 *CarrierSNRdB,          /* input data */
+    e_s16       *CarrierBitAllocation,  /* output data */
+    e_s32       NumberOfCarriers,       /* size of input data */
+    e_s16       WaterLeveldB_in,        /* Starting water level in dB */
+    e_s16       *WaterLeveldB_out,      /* Final water level in dB */
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    e_s32       BitsPerDMTSymbol        /* total bits for allocation */
+)
+{
+    n_int   Part;
+
+    BitAllocWideStart(w, CarrierSNRdB, CarrierBitAllocation, NumberOfCarriers,
+                      WaterLeveldB_in, AllocationMap, BitsPerDMTSymbol);
+    do {
+        for (Part = 0; Part < w->NumParts; Part++)
+            BitAllocWidePass(w, Part);
+    } while (BitAllocWideMerge(w));
+
+    *WaterLeveldB_out = w->WaterLeveldB;
+    return w->TotalBits;
+}
+
+/*------------------------------------------------------------------------------
+ * BitAllocTracker: Incremental re-allocation state. Bits holds the
+ * unlimited AllocationMap bits of each carrier at WaterLeveldB, Prefix a
+ * Fenwick tree of their running sums, and the carriers are linked into
+ * one list per SNR residual modulo 64, the carriers whose map index
+ * changes when the level moves by one unit. Cut is the carrier at which
+ * the running sum reaches BitsPerDMTSymbol, NumberOfCarriers if it never
+ * does; later carriers are allocated no bits.
+ * ---------------------------------------------------------------------------*/
+struct BitAllocTracker {
+    e_u16       NumberOfCarriers;
+    e_u16       BitsPerDMTSymbol;
+    const e_s16 *AllocationMap;
+    e_s32       WaterLeveldB;
+    e_s32       TotalBits;
+    n_int       Cut;
+    e_s16       *SNRdB;
+    e_s16       *Bits;
+    e_s16       *Allocation;
+    e_s32       *Prefix;
+    n_int       Head[64];
+    n_int       *Next;
+    n_int       *Prev;
+    n_int       *Touched;
+    n_int       NumTouched;
+    e_u8        *Marked;
+};
+
+/* TRACKER_BUCKET: floor((SNR - level) / 64) for any e_s16 SNR and level */
+#define TRACKER_BUCKET(snr, level)  ((((e_s32)(snr) - (level) + 65536L) >> 6) - 1024)
+
+/* TRACKER_RESIDUAL: The residual list of an SNR or level */
+#define TRACKER_RESIDUAL(value)     ((n_int)(((e_s32)(value) + 32768L) & 63))
+
+/*------------------------------------------------------------------------------
+ * FUNC    : TrackerPrefix
+ *
+ * DESC    : 
+ * The sum of Bits over carriers 0 to Carrier.
+ *
+ * RETURNS : The running sum
+ * ---------------------------------------------------------------------------*/
+static e_s32
+TrackerPrefix (const BitAllocTracker *t, n_int Carrier)
+{
+    e_s32    Sum = 0;
+    n_int   i;
 
+    for (i = Carrier + 1; i > 0; i -= i & -i)
+        Sum += t->Prefix[i];
+    return Sum;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : TrackerFindCut
+ *
+ * DESC    : 
+ * The first carrier at which the running sum of Bits reaches
+ * BitsPerDMTSymbol, found by descending the Fenwick tree.
+ *
+ * RETURNS : The carrier, NumberOfCarriers if the total falls short
+ * ---------------------------------------------------------------------------*/
+static n_int
+TrackerFindCut (const BitAllocTracker *t)
+{
+    e_s32    Remaining = t->BitsPerDMTSymbol;
+    n_int   Pos = 0, Step;
+
+    if (t->TotalBits < t->BitsPerDMTSymbol)
+        return t->NumberOfCarriers;
+    if (Remaining == 0)
+        return 0;
+    for (Step = 1; Step * 2 <= t->NumberOfCarriers; Step *= 2)
+        ;
+    for (; Step > 0; Step /= 2) {
+        if (Pos + Step <= t->NumberOfCarriers && t->Prefix[Pos + Step] < Remaining) {
+            Pos += Step;
+            Remaining -= t->Prefix[Pos];
+        }
+    }
+    return Pos;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : TrackerTouch
+ *
+ * DESC    : 
+ * Queues Carrier for the allocation check at the end of an update.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+static void
+TrackerTouch (BitAllocTracker *t, n_int Carrier)
+{
+    if (!t->Marked[Carrier]) {
+        t->Marked[Carrier] = TRUE;
+        t->Touched[t->NumTouched++] = Carrier;
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : TrackerSetBits
+ *
+ * DESC    : 
+ * Sets the unlimited bits of Carrier, keeping TotalBits and the Fenwick
+ * tree up to date.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+static void
+TrackerSetBits (BitAllocTracker *t, n_int Carrier, e_s32 CarrierBits)
+{
+    e_s32    Delta = CarrierBits - t->Bits[Carrier];
+    n_int   i;
+
+    if (Delta == 0)
+        return;
+    t->Bits[Carrier] = (e_s16)CarrierBits;
+    t->TotalBits += Delta;
+    for (i = Carrier + 1; i <= t->NumberOfCarriers; i += i & -i)
+        t->Prefix[i] += Delta;
+    TrackerTouch(t, Carrier);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : TrackerLink, TrackerUnlink
+ *
+ * DESC    : 
+ * Adds Carrier to, or removes it from, the list of its SNR residual.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+static void
+TrackerLink (BitAllocTracker *t, n_int Carrier)
+{
+    n_int   r = TRACKER_RESIDUAL(t->SNRdB[Carrier]);
+
+    t->Prev[Carrier] = -1;
+    t->Next[Carrier] = t->Head[r];
+    if (t->Head[r] >= 0)
+        t->Prev[t->Head[r]] = Carrier;
+    t->Head[r] = Carrier;
+}
+
+static void
+TrackerUnlink (BitAllocTracker *t, n_int Carrier)
+{
+    if (t->Prev[Carrier] >= 0)
+        t->Next[t->Prev[Carrier]] = t->Next[Carrier];
+    else
+        t->Head[TRACKER_RESIDUAL(t->SNRdB[Carrier])] = t->Next[Carrier];
+    if (t->Next[Carrier] >= 0)
+        t->Prev[t->Next[Carrier]] = t->Prev[Carrier];
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : TrackerSettle
+ *
+ * DESC    : 
+ * Lowers the water level one unit at a time while the carriers take fewer
+ * than BitsPerDMTSymbol bits, then raises it while the level above still
+ * meets the budget. Each unit only visits the carriers of one residual.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+static void
+TrackerSettle (BitAllocTracker *t)
+{
+    e_s32    Loss;
+    n_int   c;
+
+    while (t->TotalBits < t->BitsPerDMTSymbol && t->WaterLeveldB > -32768L) {
+        t->WaterLeveldB--;
+        for (c = t->Head[TRACKER_RESIDUAL(t->WaterLeveldB)]; c >= 0; c = t->Next[c])
+            TrackerSetBits(t, c, BucketBits(t->AllocationMap,
+                                            TRACKER_BUCKET(t->SNRdB[c], t->WaterLeveldB)));
+    }
+
+    while (t->WaterLeveldB < 32767L) {
+        Loss = 0;
+        for (c = t->Head[TRACKER_RESIDUAL(t->WaterLeveldB)]; c >= 0; c = t->Next[c])
+            Loss += t->Bits[c] - BucketBits(t->AllocationMap,
+                                            TRACKER_BUCKET(t->SNRdB[c], t->WaterLeveldB + 1));
+        if (t->TotalBits - Loss < t->BitsPerDMTSymbol)
+            break;
+        for (c = t->Head[TRACKER_RESIDUAL(t->WaterLeveldB)]; c >= 0; c = t->Next[c])
+            TrackerSetBits(t, c, BucketBits(t->AllocationMap,
+                                            TRACKER_BUCKET(t->SNRdB[c], t->WaterLeveldB + 1)));
+        t->WaterLeveldB++;
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : TrackerAllocation
+ *
+ * DESC    : 
+ * The bits allocated to Carrier: its unlimited bits before the cut, the
+ * rest of the budget at the cut and none after it, as AllocateCarriers
+ * limits them.
+ *
+ * RETURNS : The allocation of Carrier
+ * ---------------------------------------------------------------------------*/
+static e_s16
+TrackerAllocation (const BitAllocTracker *t, n_int Carrier)
+{
+    if (Carrier < t->Cut)
+        return t->Bits[Carrier];
+    if (Carrier > t->Cut)
+        return 0;
+    return (e_s16)(t->BitsPerDMTSymbol - (TrackerPrefix(t, Carrier) - t->Bits[Carrier]));
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocTrackerInit
+ *
+ * DESC    : 
+ * Starts tracking the allocation of BitsPerDMTSymbol over the carriers from
+ * a previous water level, normally the WaterLeveldB_out of
+ * fxpBitAllocation. The level is settled to the highest one that meets
+ * the budget, which gives the same allocation as the fxpBitAllocation
+ * searches when they end in its AllocationMap step. AllocationMap must
+ * stay valid until BitAllocTrackerFree.
+ *
+ * RETURNS : The tracker, NULL if out of memory
+ * ---------------------------------------------------------------------------*/
+BitAllocTracker *
+BitAllocTrackerInit (
+    const e_s16 *CarrierSNRdB,          /* input data */
+    e_u16       NumberOfCarriers,       /* size of input data */
+    e_s16       WaterLeveldB,           /* Starting water level in dB */
+    const e_s16 *AllocationMap,         /* Lookup Table */
+    e_u16       BitsPerDMTSymbol        /* total bits for allocation */
+)
+{
+    BitAllocTracker *t;
+    n_int           c, i, r;
+
+    t = (BitAllocTracker *)th_malloc(sizeof(BitAllocTracker));
+    if (t == NULL)
+        return NULL;
+    t->SNRdB      = (e_s16 *)th_malloc((NumberOfCarriers + 1) * sizeof(e_s16));
+    t->Bits       = (e_s16 *)th_malloc((NumberOfCarriers + 1) * sizeof(e_s16));
+    t->Allocation = (e_s16 *)th_malloc((NumberOfCarriers + 1) * sizeof(e_s16));
+    t->Prefix     = (e_s32 *)th_malloc((NumberOfCarriers + 1) * sizeof(e_s32));
+    t->Next       = (n_int *)th_malloc((NumberOfCarriers + 1) * sizeof(n_int));
+    t->Prev       = (n_int *)th_malloc((NumberOfCarriers + 1) * sizeof(n_int));
+    t->Touched    = (n_int *)th_malloc((NumberOfCarriers + 1) * sizeof(n_int));
+    t->Marked     = (e_u8 *)th_malloc(NumberOfCarriers + 1);
+    if (t->SNRdB == NULL || t->Bits == NULL || t->Allocation == NULL || t->Prefix == NULL ||
+        t->Next == NULL || t->Prev == NULL || t->Touched == NULL || t->Marked == NULL) {
+        BitAllocTrackerFree(t);
+        return NULL;
+    }
+
+    t->NumberOfCarriers = NumberOfCarriers;
+    t->BitsPerDMTSymbol = BitsPerDMTSymbol;
+    t->AllocationMap    = AllocationMap;
+    t->WaterLeveldB     = WaterLeveldB;
+    t->TotalBits        = 0;
+    t->NumTouched       = 0;
+    for (r = 0; r < 64; r++)
+        t->Head[r] = -1;
+    for (i = 0; i <= NumberOfCarriers; i++)
+        t->Prefix[i] = 0;
+    for (c = 0; c < NumberOfCarriers; c++) {
+        t->SNRdB[c]  = CarrierSNRdB[c];
+        t->Bits[c]   = (e_s16)BucketBits(AllocationMap, TRACKER_BUCKET(CarrierSNRdB[c], WaterLeveldB));
+        t->Marked[c] = FALSE;
+        t->TotalBits += t->Bits[c];
+        TrackerLink(t, c);
+
+        /* Linear time Fenwick tree build */
+        i = c + 1;
+        t->Prefix[i] += t->Bits[c];
+        if (i + (i & -i) <= NumberOfCarriers)
+            t->Prefix[i + (i & -i)] += t->Prefix[i];
+    }
+
+    TrackerSettle(t);
+    for (i = 0; i < t->NumTouched; i++)
+        t->Marked[t->Touched[i]] = FALSE;
+    t->NumTouched = 0;
+
+    t->Cut = TrackerFindCut(t);
+    for (c = 0; c < NumberOfCarriers; c++)
+        t->Allocation[c] = TrackerAllocation(t, c);
+    return t;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocTrackerFree
+ *
+ * DESC    : 
+ * Frees a tracker from BitAllocTrackerInit. NULL is ignored.
+ *
+ * RETURNS : Void
+ * ---------------------------------------------------------------------------*/
+void
+BitAllocTrackerFree (BitAllocTracker *t)
+{
+    if (t == NULL)
+        return;
+    if (t->Marked != NULL)     th_free(t->Marked);
+    if (t->Touched != NULL)    th_free(t->Touched);
+    if (t->Prev != NULL)       th_free(t->Prev);
+    if (t->Next != NULL)       th_free(t->Next);
+    if (t->Prefix != NULL)     th_free(t->Prefix);
+    if (t->Allocation != NULL) th_free(t->Allocation);
+    if (t->Bits != NULL)       th_free(t->Bits);
+    if (t->SNRdB != NULL)      th_free(t->SNRdB);
+    th_free(t);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocTrackerUpdate
+ *
+ * DESC    : 
+ * Bit swap: applies new SNRs to NumberOfChanges carriers, Carriers[i]
+ * taking CarrierSNRdB[i], moves the water level only as far as needed to
+ * meet the budget again and writes each carrier whose allocation changed
+ * to Deltas, which must have room for NumberOfCarriers entries. The work
+ * is in proportion to the changes, the carriers crossing an AllocationMap
+ * step as the level moves and the carriers the cut moves over, plus a
+ * logarithmic factor for the running sums.
+ *
+ * RETURNS : The number of entries written to Deltas
+ * ---------------------------------------------------------------------------*/
+n_int
+BitAllocTrackerUpdate (
+    BitAllocTracker *t,
+    const e_u16     *Carriers,          /* changed carriers */
+    const e_s16     *CarrierSNRdB,      /* their new SNRs */
+    n_int           NumberOfChanges,    /* size of Carriers and CarrierSNRdB */
+    BitAllocDelta   *Deltas             /* changed allocations */
+)
+{
+    n_int   i, c, First, Last, NumDeltas;
+    e_s16   Bits;
+
+    for (i = 0; i < NumberOfChanges; i++) {
+        c = Carriers[i];
+        if (t->SNRdB[c] == CarrierSNRdB[i])
+            continue;
+        TrackerUnlink(t, c);
+        t->SNRdB[c] = CarrierSNRdB[i];
+        TrackerLink(t, c);
+        TrackerSetBits(t, c, BucketBits(t->AllocationMap,
+                                        TRACKER_BUCKET(t->SNRdB[c], t->WaterLeveldB)));
+    }
+    TrackerSettle(t);
+
+    /* The carriers between the old and the new cut change too */
+    First = t->Cut;
+    t->Cut = TrackerFindCut(t);
+    Last = t->Cut;
+    if (First > Last) {
+        Last = First;
+        First = t->Cut;
+    }
+    if (Last >= t->NumberOfCarriers)
+        Last = t->NumberOfCarriers - 1;
+    for (c = First; c <= Last; c++)
+        TrackerTouch(t, c);
+
+    NumDeltas = 0;
+    for (i = 0; i < t->NumTouched; i++) {
+        c = t->Touched[i];
+        t->Marked[c] = FALSE;
+        Bits = TrackerAllocation(t, c);
+        if (Bits != t->Allocation[c]) {
+            t->Allocation[c] = Bits;
+            Deltas[NumDeltas].Carrier = (e_u16)c;
+            Deltas[NumDeltas].Bits    = Bits;
+            NumDeltas++;
+        }
+    }
+    t->NumTouched = 0;
+    return NumDeltas;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : BitAllocTrackerWaterLevel, BitAllocTrackerAllocation
+ *
+ * DESC    : 
+ * The current water level and allocation of a tracker.
+ *
+ * RETURNS : The level in dB, the allocation of each carrier
+ * ---------------------------------------------------------------------------*/
+e_s16
+BitAllocTrackerWaterLevel (const BitAllocTracker *t)
+{
+    return (e_s16)t->WaterLeveldB;
+}
+
+const e_s16 *
+BitAllocTrackerAllocation (const BitAllocTracker *t)
+{
+    return t->Allocation;
+}
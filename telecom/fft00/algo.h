@@ -68,6 +68,174 @@
  */
 #define IFFT_SCALE_FACTOR 0
 
+/*
+ * FFT_RADIX4: Selects the radix-4 stages in fxpfft and fxpifft, with a single
+ * radix-2 stage first when the size is not a power of 4. Same tables, data
+ * layouts and scale factors as the radix-2 stages, with 3 twiddle multiplies
+ * per 4 points instead of 4. Rounding differs, so the output CRCs do too.
+ */
+#if !defined(FFT_RADIX4)
+#define FFT_RADIX4 (FALSE)
+#endif
+
+/*
+ * FFT_STOCKHAM: Selects Stockham (self-sorting) radix-2 stages in fxpfft
+ * and fxpifft. They ping-pong between the output and a work array with
+ * consecutive reads and writes, need no bit reversal pass and do not use
+ * BitRevInd. The output is identical to the radix-2 stages.
+ */
+#if !defined(FFT_STOCKHAM)
+#define FFT_STOCKHAM (FALSE)
+#endif
+
+#if FFT_STOCKHAM && FFT_RADIX4
+#error "FFT_STOCKHAM has radix-2 stages only, do not combine it with FFT_RADIX4"
+#endif
+
+/*
+ * FFT_PLAN_MIN_EXPONENT, FFT_PLAN_MAX_EXPONENT: the range of DataSizeExponent
+ * FFTPlanInit accepts, 16 to 8192 points.
+ */
+#define FFT_PLAN_MIN_EXPONENT 4
+#define FFT_PLAN_MAX_EXPONENT 13
+
+/*
+ * FFT_PLAN_BENCH: When TRUE, the benchmark transforms the data set with a
+ * 256 point FFTPlan instead of fxpfft/fxpifft and the included tables.
+ * After the timed loop it times a plan of each size from 16 to 8192 points
+ * on pseudo random data and reports transforms per second and the time per
+ * point. Needs the interleaved data layout.
+ */
+#if !defined(FFT_PLAN_BENCH)
+#define FFT_PLAN_BENCH (FALSE)
+#endif
+
+/*
+ * FFT_INPLACE_BENCH: When TRUE, each benchmark iteration copies the input
+ * to the output buffer and transforms it in place there, with fxpfft/
+ * fxpifft or the FFT_PLAN_BENCH plan. The output is unchanged.
+ */
+#if !defined(FFT_INPLACE_BENCH)
+#define FFT_INPLACE_BENCH (FALSE)
+#endif
+
+/*
+ * FFT_SIMD: Selects SSE2, AVX2 or NEON butterflies, when the compiler
+ * targets them, for the stages of fxpfft, fxpifft and the FFT plans on
+ * interleaved data (D_INTERLEAVED). Stages whose butterfly groups are
+ * narrower than a vector run the scalar butterflies. The output is
+ * identical to the scalar stages, radix-2 or FFT_RADIX4.
+ */
+#if !defined(FFT_SIMD)
+#define FFT_SIMD (FALSE)
+#endif
+
+/*
+ * FFT_BATCH_BLOCK_BYTES: the working set of a block of vectors in an
+ * FFTBatch, about the size of the L1 data cache.
+ */
+#if !defined(FFT_BATCH_BLOCK_BYTES)
+#define FFT_BATCH_BLOCK_BYTES 32768
+#endif
+
+/*
+ * FFT_BATCH_BENCH: When TRUE, after the timed loop the benchmark transforms
+ * batches of 1 to 64 pseudo random 256 point symbols with an FFTBatch, and
+ * one at a time with FFTPlanForward/Inverse, checks that they agree, and
+ * reports symbols per second for both. Needs the interleaved data layout.
+ */
+#if !defined(FFT_BATCH_BENCH)
+#define FFT_BATCH_BENCH (FALSE)
+#endif
+
+/*
+ * FFT_REAL_BENCH: When TRUE, after the timed loop the benchmark times the
+ * real FFT (forward) or Hermitian IFFT (reverse) of each size from 32 to
+ * 8192 points against the complex FFTPlan of the same size, and reports
+ * transforms per second for both.
+ */
+#if !defined(FFT_REAL_BENCH)
+#define FFT_REAL_BENCH (FALSE)
+#endif
+
+/*
+ * FFT_LARGE_MIN_EXPONENT, FFT_LARGE_MAX_EXPONENT: the range of
+ * DataSizeExponent FFTLargePlanInit accepts, 256 points to 1M points.
+ */
+#define FFT_LARGE_MIN_EXPONENT 8
+#if !defined(FFT_LARGE_MAX_EXPONENT)
+#define FFT_LARGE_MAX_EXPONENT 20
+#endif
+
+#if FFT_LARGE_MAX_EXPONENT > 2 * FFT_PLAN_MAX_EXPONENT
+#error "FFT_LARGE_MAX_EXPONENT is limited to twice FFT_PLAN_MAX_EXPONENT"
+#endif
+
+/*
+ * FFT_LARGE_BENCH: When TRUE, after the timed loop the benchmark times the
+ * four-step FFT of pseudo random data from 8192 points to
+ * 2**FFT_LARGE_MAX_EXPONENT points, with the columns and rows split
+ * across a th_pool_open() pool of 1 to FFT_MAX_THREADS threads, checks
+ * that every thread count gives the single thread output, and reports the
+ * wall-clock transforms per second for each. With VERIFY_FLOAT it checks
+ * each size against FFT_LARGE_MIN_SNR. Needs TH_THREADS.
+ */
+#if !defined(FFT_LARGE_BENCH)
+#define FFT_LARGE_BENCH (FALSE)
+#endif
+#if FFT_LARGE_BENCH && !TH_THREADS
+#error "FFT_LARGE_BENCH needs the worker threads of TH_THREADS"
+#endif
+
+/*
+ * FFT_LARGE_MIN_SNR: With VERIFY_FLOAT, the least S/N in dB of an
+ * FFT_LARGE_BENCH size of 2**e points against FFTReference that passes
+ * the run. The four-step transform halves every stage and rounds every
+ * product, so its error stays near one LSB while full scale random data
+ * comes out at 2**(15 - e/2) LSB; the budget is 6.02 dB for each of those
+ * bits, and the run fails FFT_LARGE_SNR_MARGIN below it. The sizes from
+ * 8192 points to 1M points measure 0.6 dB above the budget.
+ */
+#if !defined(FFT_LARGE_SNR_MARGIN)
+#define FFT_LARGE_SNR_MARGIN 3.0
+#endif
+#define FFT_LARGE_MIN_SNR(e) ( 6.02 * ( 15 - (e) / 2.0 ) - FFT_LARGE_SNR_MARGIN )
+
+#if !defined(FFT_MAX_THREADS)
+#define FFT_MAX_THREADS 4
+#endif
+
+/*
+ * FFT_LOOPBACK_BENCH: When TRUE, after the timed loop the benchmark runs
+ * FFT_LOOPBACK_SYMBOLS 4-QAM DMT symbols through fxpifft, a channel adding
+ * uniform noise of +/- FFT_LOOPBACK_NOISE to the scaled down samples, and
+ * fxpfft, whatever the direction, and reports symbols per second, symbol
+ * errors and the wall-clock latency percentiles of one symbol. Not with
+ * FFT_PLAN_BENCH.
+ */
+#if !defined(FFT_LOOPBACK_BENCH)
+#define FFT_LOOPBACK_BENCH (FALSE)
+#endif
+
+#if !defined(FFT_LOOPBACK_SYMBOLS)
+#define FFT_LOOPBACK_SYMBOLS 10000
+#endif
+
+#if !defined(FFT_LOOPBACK_NOISE)
+#define FFT_LOOPBACK_NOISE 16
+#endif
+
+/*
+ * FFT_MIN_SNR: With VERIFY_FLOAT, the least S/N in dB of the output
+ * against FFTReference of the same prescaled input that passes the run,
+ * for every data set, kernel and direction. The twiddle tables are at odd
+ * multiples of pi/DataSize, half a step off the exact angles, which holds
+ * every kernel to about 26 dB; the data sets measure 24.5 to 26 dB.
+ */
+#if !defined(FFT_MIN_SNR)
+#define FFT_MIN_SNR 20.0
+#endif
+
 
 /*******************************************************************************
     TypeDefs                                                            
@@ -111,5 +279,78 @@ fxpifft (
     e_s16   *BitRevInd          /* bit reversal indicies */
 );
 
+/*
+ * FFTPlan: Opaque transform plan for one size, with its own twiddle and bit
+ * reversal tables. FFTPlanForward and FFTPlanInverse take interleaved
+ * (real, imaginary) data, prescaled like the fxpfft input. The Scaled
+ * forms take data that is not, and halve the first Halved stages instead.
+ */
+typedef struct FFTPlan FFTPlan;
+
+FFTPlan *FFTPlanInit(n_int DataSizeExponent);
+void FFTPlanFree(FFTPlan *plan);
+void FFTPlanForward(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData);
+void FFTPlanInverse(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData);
+void FFTPlanForwardScaled(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData,
+                          n_int Halved);
+void FFTPlanInverseScaled(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData,
+                          n_int Halved);
+
+/*
+ * FFTBatch: Opaque work space for transforming many vectors of one plan's
+ * size together, as the DMT receiver does with the symbols of a frame.
+ */
+typedef struct FFTBatch FFTBatch;
+
+FFTBatch *FFTBatchInit(const FFTPlan *plan);
+void FFTBatchFree(FFTBatch *batch);
+void FFTBatchForward(FFTBatch *batch, e_s16 **InData, e_s16 **OutData, n_int NumVectors);
+void FFTBatchInverse(FFTBatch *batch, e_s16 **InData, e_s16 **OutData, n_int NumVectors);
+
+/*
+ * FFTRealPlan: Opaque plan for real transforms of one size, computed with
+ * a complex plan of half the size. FFTRealForward takes DataSize real
+ * samples and gives the packed spectrum: the real DC and Nyquist bins,
+ * then bins 1 .. DataSize/2-1 as (real, imaginary) pairs. FFTRealInverse
+ * takes a packed Hermitian spectrum and gives the real samples.
+ */
+typedef struct FFTRealPlan FFTRealPlan;
+
+FFTRealPlan *FFTRealPlanInit(n_int DataSizeExponent);
+void FFTRealPlanFree(FFTRealPlan *plan);
+void FFTRealForward(const FFTRealPlan *plan, const e_s16 *InData, e_s16 *OutData);
+void FFTRealInverse(const FFTRealPlan *plan, const e_s16 *InData, e_s16 *OutData);
+
+/*
+ * FFTLargePlan: Opaque four-step plan for transforms too large for one
+ * FFTPlan, as column FFTs, a twiddle multiply and row FFTs. The column and
+ * row steps split into parts for separate threads, each with its own
+ * scratch array; FFTLargeRows must wait for every part of FFTLargeColumns.
+ * Same data layout as FFTPlanForward, but the data is not prescaled:
+ * every stage halves and rounds, as FFTPlanForwardScaled with all stages
+ * Halved, so the output is the transform times 2**-DataSizeExponent. The
+ * sub-transforms use twiddles at the exact angles (see FFT_LARGE_MIN_SNR).
+ */
+typedef struct FFTLargePlan FFTLargePlan;
+
+FFTLargePlan *FFTLargePlanInit(n_int DataSizeExponent);
+void FFTLargePlanFree(FFTLargePlan *plan);
+n_int FFTLargeScratchSize(const FFTLargePlan *plan);
+void FFTLargeColumns(const FFTLargePlan *plan, const e_s16 *InData, e_s16 *WorkData,
+                     n_int Part, n_int NumParts, e_s16 *Scratch, n_int Inverse);
+void FFTLargeRows(const FFTLargePlan *plan, const e_s16 *WorkData, e_s16 *OutData,
+                  n_int Part, n_int NumParts, e_s16 *Scratch, n_int Inverse);
+void FFTLargeForward(const FFTLargePlan *plan, const e_s16 *InData, e_s16 *OutData,
+                     e_s16 *WorkData, e_s16 *Scratch);
+void FFTLargeInverse(const FFTLargePlan *plan, const e_s16 *InData, e_s16 *OutData,
+                     e_s16 *WorkData, e_s16 *Scratch);
+void fxpFFTSelectKernel(void);
+
+/*
+ * FFTReference: The exact transform of 2**DataSizeExponent interleaved
+ * points in double, for checking the fixed point ones (see FFT_MIN_SNR).
+ */
+void FFTReference(const e_s16 *InData, e_f64 *RefData, n_int DataSizeExponent, n_int Inverse);
+
 
 #endif /* ALGO_H */
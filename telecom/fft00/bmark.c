@@ -9,6 +9,10 @@
 
 #include "algo.h"
 
+#if FFT_LOOPBACK_BENCH
+#include <stdlib.h> /* qsort */
+#endif
+
 #if		VERIFY_FLOAT && FLOAT_SUPPORT
 #include "verify.h"
 #endif
@@ -37,7 +41,17 @@ int    test_main( struct TCDef** tcdef, int argc, const char* argv[] );
 #if NON_INTRUSIVE_CRC_CHECK
 #if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
 
+#if FFT_RADIX4
+
 #if defined(DATA_1)
+#define EXPECTED_CRC			0x78c6
+#elif defined(DATA_2)
+#define EXPECTED_CRC			0x1124
+#else
+#define EXPECTED_CRC			0xaf60
+#endif
+
+#elif defined(DATA_1)
 #define EXPECTED_CRC			0x21a5
 #elif defined(DATA_2)
 #define EXPECTED_CRC			0x0527
@@ -81,6 +95,10 @@ int    test_main( struct TCDef** tcdef, int argc, const char* argv[] );
 #define EXPECTED_CRC			0x0000
 #endif
 
+/* Write the output for the host's diffmeasure if nothing checks it here */
+#define OUTPUT_FILE	( !CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK && \
+	( TH_VERIFY_FILES || !( VERIFY_FLOAT && FLOAT_SUPPORT ) ) )
+
 static TCDef the_tcdef = 
    {
     "TEL fft00      ",
@@ -128,54 +146,604 @@ static TCDef the_tcdef =
 #if defined(DATA_1)
 
 #define OUTFILENAME "xtpulse256iOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "xtpulse256i.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xtpulse256i.dat"
 };
-static e_f64 test_buf[] = { 
-#include "vtpulse256i.dat"
-}; 
+#endif
 #elif defined(DATA_2)
 
 #define OUTFILENAME "xspn256iOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "xspn256i.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xspn256i.dat"
 };
-static e_f64 test_buf[] = { 
-#include "vspn256i.dat"
-}; 
+#endif
 #else /* default DATA_3 */  
 
 #define OUTFILENAME "xsine256iOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "xsine256i.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xsine256i.dat"
 };
-static e_f64 test_buf[] = { 
-#include "golden_sine.dat"
-}; 
+#endif
 #endif /* included data */ 
 
-#if defined(C_INTERLEAVED)
-static  e_s16 sin_buf[] = {0};
-static  e_s16 cosin_buf[] = {
+/* Twiddle and bit reversal tables, which an FFTPlan builds itself */
+#if FFT_PLAN_BENCH
+#elif defined(C_INTERLEAVED)
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 sin_buf[] = {0};
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 cosin_buf[] = {
 #include "cstable256i.dat"
 };
 #else
-static  e_s16 sin_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 sin_buf[] = {
 #include "stable256i.dat"
 }; 
-static  e_s16 cosin_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 cosin_buf[] = {
 #include "ctable256i.dat"
 };
 #endif
 
-static  e_s16 index_buf[] = {
+#if !FFT_PLAN_BENCH
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 index_buf[] = {
 #include "brind256i.dat"
 }; 
+#endif
 
 #define T_BSIZE (sizeof(e_s16)*(MAX_FFT_SIZE*2))
 
 static n_char* t_buf = NULL;
 
+#if FFT_PLAN_BENCH
+#if !(defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
+#error "FFT_PLAN_BENCH needs C_INTERLEAVED and D_INTERLEAVED"
+#endif
+
+/*
+* FUNC   : plan_bench
+*
+* DESC   : Times an FFTPlan of each size from 2**FFT_PLAN_MIN_EXPONENT to
+*          2**FFT_PLAN_MAX_EXPONENT points in the given direction, on
+*          pseudo random data prescaled like the data set. Each size runs
+*          about the butterflies of iterations 256 point transforms and
+*          prints transforms per second and the time per point.
+*/
+static void plan_bench( size_t iterations, FFT_DIRECTION Direction )
+{
+    FFTPlan     *plan;
+    e_s16       *in, *out;
+    n_int       e, i, size;
+    size_t      loop_cnt, passes, duration;
+    double      rate;
+    e_u32       seed = 1;
+
+    in  = (e_s16 *)th_malloc( 2 * sizeof(e_s16) << FFT_PLAN_MAX_EXPONENT );
+    out = (e_s16 *)th_malloc( 2 * sizeof(e_s16) << FFT_PLAN_MAX_EXPONENT );
+    if( in == NULL || out == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    for ( e = FFT_PLAN_MIN_EXPONENT; e <= FFT_PLAN_MAX_EXPONENT; e++ )
+    {
+        size = 1 << e;
+        plan = FFTPlanInit( e );
+        if( plan == NULL )
+           th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+        for ( i = 0; i < 2 * size; i++ )
+        {
+            seed = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+            in[i] = (e_s16)( seed >> 16 );
+        }
+
+        passes = iterations * MAX_FFT_SIZE * 8 / ( (size_t)size * e );
+        if ( passes == 0 )
+            passes = 1;
+
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+        {
+            if ( Direction == FORWARD )
+                FFTPlanForward( plan, in, out );
+            else
+                FFTPlanInverse( plan, in, out );
+        }
+        duration = th_signal_finished();
+
+        rate = duration ? (double)passes * th_ticks_per_sec() / duration : 0.0;
+        th_printf( "--  Plan %4d points: %11.1f transforms/s %8.2f ns/point\n",
+                   size, rate, rate ? 1e9 / ( rate * size ) : 0.0 );
+
+        FFTPlanFree( plan );
+    }
+
+    th_free( in );
+    th_free( out );
+}
+#endif
+
+#if FFT_BATCH_BENCH || FFT_REAL_BENCH || FFT_LARGE_BENCH
+#if !(defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
+#error "FFT_BATCH_BENCH, FFT_REAL_BENCH and FFT_LARGE_BENCH need C_INTERLEAVED and D_INTERLEAVED"
+#endif
+#endif
+
+#if FFT_BATCH_BENCH
+
+#define BATCH_MAX_SYMBOLS 64
+
+/*
+* FUNC   : batch_bench
+*
+* DESC   : Times batches of 1 to BATCH_MAX_SYMBOLS pseudo random 256 point
+*          symbols, prescaled like the data set, through an FFTBatch and
+*          one at a time through FFTPlanForward/Inverse, about iterations
+*          symbols each, and prints symbols per second for both. The two
+*          outputs must agree.
+*/
+static void batch_bench( size_t iterations, FFT_DIRECTION Direction )
+{
+    FFTPlan     *plan;
+    FFTBatch    *batch;
+    e_s16       *in[BATCH_MAX_SYMBOLS], *out[BATCH_MAX_SYMBOLS];
+    e_s16       *buf, *ref;
+    n_int       i, m, v;
+    size_t      loop_cnt, passes, duration;
+    double      rate, single_rate;
+    e_u32       seed = 1;
+
+    plan  = FFTPlanInit( DATA_SIZE_EXPONENT );
+    batch = FFTBatchInit( plan );
+    buf = (e_s16 *)th_malloc( 2 * 2 * MAX_FFT_SIZE * sizeof(e_s16) * BATCH_MAX_SYMBOLS );
+    ref = (e_s16 *)th_malloc( 2 * MAX_FFT_SIZE * sizeof(e_s16) );
+    if( batch == NULL || buf == NULL || ref == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    for ( v = 0; v < BATCH_MAX_SYMBOLS; v++ )
+    {
+        in[v]  = buf + 2 * MAX_FFT_SIZE * 2 * v;
+        out[v] = in[v] + 2 * MAX_FFT_SIZE;
+        for ( i = 0; i < 2 * MAX_FFT_SIZE; i++ )
+        {
+            seed = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+            in[v][i] = (e_s16)( (e_s16)( seed >> 16 ) >> DATA_SIZE_EXPONENT );
+        }
+    }
+
+    for ( m = 1; m <= BATCH_MAX_SYMBOLS; m *= 2 )
+    {
+        passes = iterations / m;
+        if ( passes == 0 )
+            passes = 1;
+
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+        {
+            if ( Direction == FORWARD )
+                FFTBatchForward( batch, in, out, m );
+            else
+                FFTBatchInverse( batch, in, out, m );
+        }
+        duration = th_signal_finished();
+        rate = duration ? (double)passes * m * th_ticks_per_sec() / duration : 0.0;
+
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+        {
+            for ( v = 0; v < m; v++ )
+            {
+                if ( Direction == FORWARD )
+                    FFTPlanForward( plan, in[v], ref );
+                else
+                    FFTPlanInverse( plan, in[v], ref );
+            }
+        }
+        duration = th_signal_finished();
+        single_rate = duration ? (double)passes * m * th_ticks_per_sec() / duration : 0.0;
+
+        for ( v = 0; v < m; v++ )
+        {
+            if ( Direction == FORWARD )
+                FFTPlanForward( plan, in[v], ref );
+            else
+                FFTPlanInverse( plan, in[v], ref );
+            for ( i = 0; i < 2 * MAX_FFT_SIZE; i++ )
+                if ( out[v][i] != ref[i] )
+                    break;
+            if ( i < 2 * MAX_FFT_SIZE )
+                th_printf( "--  Batch Failure: symbol %d of %d differs from FFTPlan\n", v, m );
+        }
+
+        th_printf( "--  Batch %2d symbols: %11.1f symbols/s %11.1f one at a time\n",
+                   m, rate, single_rate );
+    }
+
+    th_free( ref );
+    th_free( buf );
+    FFTBatchFree( batch );
+    FFTPlanFree( plan );
+}
+#endif
+
+#if FFT_REAL_BENCH
+/*
+* FUNC   : real_bench
+*
+* DESC   : Times FFTRealForward/Inverse against the complex FFTPlan of each
+*          size from 2**(FFT_PLAN_MIN_EXPONENT+1) to 2**FFT_PLAN_MAX_EXPONENT
+*          points in the given direction, on pseudo random real samples or
+*          Hermitian spectra prescaled like the data set, as plan_bench
+*          does, and prints transforms per second for both.
+*/
+static void real_bench( size_t iterations, FFT_DIRECTION Direction )
+{
+    FFTRealPlan *real;
+    FFTPlan     *plan;
+    e_s16       *in, *out, *cin;
+    n_int       e, i, size;
+    size_t      loop_cnt, passes, duration;
+    double      rate, complex_rate;
+    e_u32       seed = 1;
+
+    in  = (e_s16 *)th_malloc( sizeof(e_s16) << FFT_PLAN_MAX_EXPONENT );
+    out = (e_s16 *)th_malloc( 2 * sizeof(e_s16) << FFT_PLAN_MAX_EXPONENT );
+    cin = (e_s16 *)th_malloc( 2 * sizeof(e_s16) << FFT_PLAN_MAX_EXPONENT );
+    if( in == NULL || out == NULL || cin == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    for ( e = FFT_PLAN_MIN_EXPONENT + 1; e <= FFT_PLAN_MAX_EXPONENT; e++ )
+    {
+        size = 1 << e;
+        real = FFTRealPlanInit( e );
+        plan = FFTPlanInit( e );
+        if( real == NULL || plan == NULL )
+           th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+        /* Real samples, or the packed half of a Hermitian spectrum */
+        for ( i = 0; i < size; i++ )
+        {
+            seed = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+            in[i] = (e_s16)( seed >> 16 );
+        }
+
+        /* The same data as a full complex vector */
+        for ( i = 0; i < 2 * size; i++ )
+            cin[i] = 0;
+        if ( Direction == FORWARD )
+        {
+            for ( i = 0; i < size; i++ )
+                cin[2*i] = in[i];
+        }
+        else
+        {
+            cin[0]    = in[0];
+            cin[size] = in[1];
+            for ( i = 1; i < size / 2; i++ )
+            {
+                cin[2*i]            = in[2*i];
+                cin[2*i+1]          = in[2*i+1];
+                cin[2*(size-i)]     = in[2*i];
+                cin[2*(size-i)+1]   = (e_s16)-in[2*i+1];
+            }
+        }
+
+        passes = iterations * MAX_FFT_SIZE * 8 / ( (size_t)size * e );
+        if ( passes == 0 )
+            passes = 1;
+
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+        {
+            if ( Direction == FORWARD )
+                FFTRealForward( real, in, out );
+            else
+                FFTRealInverse( real, in, out );
+        }
+        duration = th_signal_finished();
+        rate = duration ? (double)passes * th_ticks_per_sec() / duration : 0.0;
+
+        th_signal_start();
+        for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+        {
+            if ( Direction == FORWARD )
+                FFTPlanForward( plan, cin, out );
+            else
+                FFTPlanInverse( plan, cin, out );
+        }
+        duration = th_signal_finished();
+        complex_rate = duration ? (double)passes * th_ticks_per_sec() / duration : 0.0;
+
+        th_printf( "--  Real %4d points: %11.1f transforms/s %11.1f complex\n",
+                   size, rate, complex_rate );
+
+        FFTRealPlanFree( real );
+        FFTPlanFree( plan );
+    }
+
+    th_free( cin );
+    th_free( in );
+    th_free( out );
+}
+#endif
+
+#if FFT_LARGE_BENCH
+/*
+ * A step of a large_bench transform, the column or the row FFTs, that
+ * th_pool_run() splits across the threads.
+ */
+typedef struct {
+    n_int               nthreads;
+    n_int               rows;           /* FALSE for the column step */
+    n_int               inverse;
+    const FFTLargePlan  *plan;
+    const e_s16         *in;
+    e_s16               *work;
+    e_s16               *out;
+    e_s16               *scratch[FFT_MAX_THREADS];
+} large_job;
+
+static void large_part( void *arg, int part )
+{
+    large_job   *job = (large_job *)arg;
+
+    if ( job->rows )
+        FFTLargeRows( job->plan, job->work, job->out, part, job->nthreads,
+                      job->scratch[part], job->inverse );
+    else
+        FFTLargeColumns( job->plan, job->in, job->work, part, job->nthreads,
+                         job->scratch[part], job->inverse );
+}
+
+/*
+* FUNC   : large_bench
+*
+* DESC   : Times the four-step FFT or IFFT of each size from
+*          2**FFT_PLAN_MAX_EXPONENT to 2**FFT_LARGE_MAX_EXPONENT points,
+*          on full scale pseudo random data, with 1 to
+*          FFT_MAX_THREADS threads, and prints the wall-clock transforms
+*          per second for each. Every thread count must give the single
+*          thread output. With VERIFY_FLOAT it also prints the S/N of each
+*          size against FFTReference, and fails the run below
+*          FFT_LARGE_MIN_SNR.
+*/
+static void large_bench( size_t iterations, FFT_DIRECTION Direction )
+{
+    FFTLargePlan    *plan;
+    THPool          *pool;
+    large_job       job;
+    e_s16           *in, *out, *ref;
+    n_int           e, i, t, size, nthreads;
+    size_t          loop_cnt, passes;
+    double          t0, t1;
+    e_u32           seed = 1;
+#if VERIFY_FLOAT && FLOAT_SUPPORT
+    e_f64           *exact;
+    double          snr;
+#endif
+
+    in   = (e_s16 *)th_malloc( 2 * sizeof(e_s16) << FFT_LARGE_MAX_EXPONENT );
+    out  = (e_s16 *)th_malloc( 2 * sizeof(e_s16) << FFT_LARGE_MAX_EXPONENT );
+    ref  = (e_s16 *)th_malloc( 2 * sizeof(e_s16) << FFT_LARGE_MAX_EXPONENT );
+    job.work = (e_s16 *)th_malloc( 2 * sizeof(e_s16) << FFT_LARGE_MAX_EXPONENT );
+    if( in == NULL || out == NULL || ref == NULL || job.work == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+#if VERIFY_FLOAT && FLOAT_SUPPORT
+    exact = (e_f64 *)th_malloc( 2 * sizeof(e_f64) << FFT_LARGE_MAX_EXPONENT );
+    if( exact == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+#endif
+
+    job.inverse = ( Direction == REVERSE );
+    job.in  = in;
+    job.out = out;
+
+    for ( e = FFT_PLAN_MAX_EXPONENT; e <= FFT_LARGE_MAX_EXPONENT; e++ )
+    {
+        size = 1 << e;
+        plan = FFTLargePlanInit( e );
+        if( plan == NULL )
+           th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+        job.plan = plan;
+
+        /* The heap is not thread-safe, so every scratch array comes first */
+        for ( t = 0; t < FFT_MAX_THREADS; t++ )
+        {
+            job.scratch[t] = (e_s16 *)th_malloc( FFTLargeScratchSize( plan ) * sizeof(e_s16) );
+            if( job.scratch[t] == NULL )
+               th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+        }
+
+        for ( i = 0; i < 2 * size; i++ )
+        {
+            seed = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+            in[i] = (e_s16)( seed >> 16 );
+        }
+
+        if ( Direction == FORWARD )
+            FFTLargeForward( plan, in, ref, job.work, job.scratch[0] );
+        else
+            FFTLargeInverse( plan, in, ref, job.work, job.scratch[0] );
+
+#if VERIFY_FLOAT && FLOAT_SUPPORT
+        FFTReference( in, exact, e, Direction == REVERSE );
+        for ( i = 0; i < 2 * size; i++ )
+            exact[i] = ldexp( exact[i], -e );
+        snr = diffmeasure_unscaled( exact, 2 * size, COMPLEX, ref, 2 * size, COMPLEX );
+        th_printf( "--  Large %7d points: %.1f dB against FFTReference\n", size, snr );
+        if ( !( snr >= FFT_LARGE_MIN_SNR( e ) ) )
+           th_exit( THE_FAILURE, "Four-step FFT of %d points at %.1f dB, below %.1f dB",
+                    size, snr, FFT_LARGE_MIN_SNR( e ) );
+#endif
+
+        passes = iterations * MAX_FFT_SIZE * 8 / ( (size_t)size * e );
+        if ( passes == 0 )
+            passes = 1;
+
+        for ( nthreads = 1; nthreads <= FFT_MAX_THREADS; nthreads++ )
+        {
+            job.nthreads = nthreads;
+            pool = th_pool_open( nthreads );
+            if ( pool == NULL )
+               th_exit( THE_FAILURE, "Cannot create thread %s:%d", __FILE__, __LINE__ );
+
+            t0 = th_wall_seconds();
+            for ( loop_cnt = 0; loop_cnt < passes; loop_cnt++ )
+            {
+                job.rows = FALSE;
+                th_pool_run( pool, large_part, &job );
+                job.rows = TRUE;
+                th_pool_run( pool, large_part, &job );
+            }
+            t1 = th_wall_seconds();
+
+            th_pool_close( pool );
+
+            for ( i = 0; i < 2 * size; i++ )
+            {
+                if ( out[i] != ref[i] )
+                {
+                    th_printf( "--  Large Failure: %d points, %d threads, value %d\n",
+                               size, nthreads, i );
+                    break;
+                }
+            }
+
+            th_printf( "--  Large %7d points, %d threads: %10.1f transforms/s\n",
+                       size, nthreads, t1 > t0 ? (double)passes / ( t1 - t0 ) : 0.0 );
+        }
+
+        for ( t = 0; t < FFT_MAX_THREADS; t++ )
+            th_free( job.scratch[t] );
+        FFTLargePlanFree( plan );
+    }
+
+#if VERIFY_FLOAT && FLOAT_SUPPORT
+    th_free( exact );
+#endif
+    th_free( job.work );
+    th_free( ref );
+    th_free( out );
+    th_free( in );
+}
+#endif
+
+
+#if FFT_LOOPBACK_BENCH
+#if FFT_PLAN_BENCH
+#error "FFT_LOOPBACK_BENCH uses the included tables, do not combine it with FFT_PLAN_BENCH"
+#endif
+
+static int compare_seconds( const void *a, const void *b )
+{
+    double  x = *(const double *)a;
+    double  y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*
+* FUNC   : loopback_bench
+*
+* DESC   : Runs FFT_LOOPBACK_SYMBOLS DMT symbols through the modem loop:
+*          4-QAM on every bin, fxpifft, a channel that scales the samples
+*          down by 2**(FFTSize/2) with rounding and adds uniform noise of
+*          +/- FFT_LOOPBACK_NOISE, fxpfft and a sign slicer. The bins come
+*          back about 2**(FFTSize/2) times the transmitted amplitude, with
+*          no overflow for random data. Each symbol is timed from the IFFT
+*          to the sliced bits, and the throughput, symbol errors and
+*          latency percentiles are printed.
+*/
+static void loopback_bench( e_s16 FFTSize, e_s16 *SineV, e_s16 *CosineV, e_s16 *BitRevInd )
+{
+    static const double percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+    e_s16   *tx, *line, *rx;
+    double  *latency;
+    double  start, t0, total;
+    n_int   size, amplitude, shift, sym, i, p, errors;
+    e_u32   data_seed = 1, noise_seed = 2;
+    e_u32   bits[MAX_FFT_SIZE];
+
+    size = 1 << FFTSize;
+    amplitude = TRIG_SCALE_FACTOR >> FFTSize;
+    shift = FFTSize / 2;
+
+    tx      = (e_s16 *)th_malloc( 2 * sizeof(e_s16) * size );
+    line    = (e_s16 *)th_malloc( 2 * sizeof(e_s16) * size );
+    rx      = (e_s16 *)th_malloc( 2 * sizeof(e_s16) * size );
+    latency = (double *)th_malloc( sizeof(double) * FFT_LOOPBACK_SYMBOLS );
+    if( tx == NULL || line == NULL || rx == NULL || latency == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    errors = 0;
+    start = th_wall_seconds();
+    for ( sym = 0; sym < FFT_LOOPBACK_SYMBOLS; sym++ )
+    {
+        /* Two bits on each bin, real and imaginary sign */
+        for ( i = 0; i < size; i++ )
+        {
+            data_seed = ( data_seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+            bits[i] = ( data_seed >> 16 ) & 3;
+#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
+            tx[2*i]   = (e_s16)( bits[i] & 1 ? -amplitude : amplitude );
+            tx[2*i+1] = (e_s16)( bits[i] & 2 ? -amplitude : amplitude );
+#else
+            tx[i]        = (e_s16)( bits[i] & 1 ? -amplitude : amplitude );
+            tx[size + i] = (e_s16)( bits[i] & 2 ? -amplitude : amplitude );
+#endif
+        }
+
+        t0 = th_wall_seconds();
+
+#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
+        fxpifft( tx, NULL, line, NULL, FFTSize, SineV, CosineV, BitRevInd );
+#else
+        fxpifft( tx, tx + size, line, line + size, FFTSize, SineV, CosineV, BitRevInd );
+#endif
+
+        /* Channel: scale down for the FFT and add noise */
+        for ( i = 0; i < 2 * size; i++ )
+        {
+            noise_seed = ( noise_seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+            line[i] = (e_s16)( ( ( line[i] + ( 1 << ( shift - 1 ) ) ) >> shift ) +
+                      (n_int)( ( noise_seed >> 16 ) % ( 2 * FFT_LOOPBACK_NOISE + 1 ) ) - FFT_LOOPBACK_NOISE );
+        }
+
+#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
+        fxpfft( line, NULL, rx, NULL, FFTSize, SineV, CosineV, BitRevInd );
+        for ( i = 0; i < size; i++ )
+            errors += ( ( rx[2*i] < 0 ) | ( ( rx[2*i+1] < 0 ) << 1 ) ) != (n_int)bits[i];
+#else
+        fxpfft( line, line + size, rx, rx + size, FFTSize, SineV, CosineV, BitRevInd );
+        for ( i = 0; i < size; i++ )
+            errors += ( ( rx[i] < 0 ) | ( ( rx[size + i] < 0 ) << 1 ) ) != (n_int)bits[i];
+#endif
+
+        latency[sym] = th_wall_seconds() - t0;
+    }
+    total = th_wall_seconds() - start;
+
+    qsort( latency, FFT_LOOPBACK_SYMBOLS, sizeof(double), compare_seconds );
+
+    th_printf( "--  Loopback %d symbols of %d points: %10.1f symbols/s, %d symbol errors\n",
+               FFT_LOOPBACK_SYMBOLS, size,
+               total > 0.0 ? FFT_LOOPBACK_SYMBOLS / total : 0.0, errors );
+    for ( p = 0; p < (n_int)( sizeof(percentiles) / sizeof(percentiles[0]) ); p++ )
+    {
+        i = (n_int)( percentiles[p] / 100.0 * ( FFT_LOOPBACK_SYMBOLS - 1 ) + 0.5 );
+        th_printf( "--  Loopback latency p%-4g: %9.2f us\n", percentiles[p], latency[i] * 1e6 );
+    }
+    th_printf( "--  Loopback latency max  : %9.2f us\n", latency[FFT_LOOPBACK_SYMBOLS - 1] * 1e6 );
+
+    th_free( latency );
+    th_free( rx );
+    th_free( line );
+    th_free( tx );
+}
+#endif
+
 
 /*------------------------------------------------------------------------------
  * FUNC   : t_run_test
@@ -207,48 +775,75 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 
 
 #if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))  
-	e_s16		*InData,*OutData; 
+	e_s16		*InData,*OutData,*in_buffer; 
+#if FFT_INPLACE_BENCH
+	e_s16		*SrcData;
+#endif
 #else 
 	e_s16		*InRealData,*InImagData,*OutRealData,*OutImagData;
 	e_s16		*out_buffer;
+#if FFT_INPLACE_BENCH
+	e_s16		*SrcRealData,*SrcImagData;
+#endif
 #endif   
+#if FFT_PLAN_BENCH
+	FFTPlan		*plan;
+#else
 	e_s16          *SineV,*CosineV;
 	e_s16          *BitRevInd;
+#endif
 	e_s16          i,FFTSize,NumPoints,TempVal;
 	const char		*outFilename;
-
-#if	!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
-	e_u8			*out_symbol_buffer; 
-	e_s8         *stringHeadPtr,*tmp_buf;
+	const e_s16		*InputData;
+#if	TH_DATA_FILES
+	size_t			n, Blocks, j;
+	e_s16			*StreamData, *BlockData;
 #endif
 
 #if		VERIFY_FLOAT && FLOAT_SUPPORT
-	e_f64			*golden_result; 
+	e_s16			*ref_input;
+	e_f64			*ref_result; 
 	d_union			dunion;
+	size_t			Block;
 #endif
 	FFT_DIRECTION  Direction;
 
    /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     * First, initialize the data structures we need for the test
    */
-   t_buf     = (n_char *) th_malloc( T_BSIZE );
+   t_buf     = (n_char *) th_malloc_aligned( T_BSIZE, EE_SIMD_ALIGN );
    if( t_buf == NULL )
        th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
 
-#if		VERIFY_FLOAT && FLOAT_SUPPORT
-   	golden_result	= (e_f64 *)&test_buf; 
+#if	TH_DATA_FILES
+   /* The data set comes from files, blocks of MAX_FFT_SIZE complex points,
+    * one block transformed per iteration
+    */
+   InputData = (const e_s16 *)th_get_data_file( TH_DATA_INPUT, INFILENAME, sizeof(e_s16), &n );
+   if ( n % (MAX_FFT_SIZE*2) != 0 )
+       th_exit( THE_BAD_SIZE, "Data set of %ld values is not of %d points", (long)n, MAX_FFT_SIZE );
+   Blocks = n / (MAX_FFT_SIZE*2);
+#else
+   InputData = input_buf;
 #endif
 
 
 #if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
-   InData      = (e_s16 *)input_buf; 
+   /* The inputs are prescaled in place, so work on a copy or a second run
+    * would shift them again */
+   in_buffer   = (e_s16 *)th_malloc_aligned( T_BSIZE, EE_SIMD_ALIGN );
+   if( in_buffer == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+   for (i = 0; i < MAX_FFT_SIZE*2; i++)
+       in_buffer[i] = InputData[i];
+   InData      = in_buffer; 
    OutData     = (e_s16 *)t_buf;  
 #else
    InRealData  = (e_s16 *)t_buf;
    InImagData  = InRealData + (MAX_FFT_SIZE);
    OutRealData = InImagData + (MAX_FFT_SIZE);
    OutImagData = OutRealData + (MAX_FFT_SIZE);
-   out_buffer	= (e_s16 *)th_malloc( T_BSIZE );
+   out_buffer	= (e_s16 *)th_malloc_aligned( T_BSIZE, EE_SIMD_ALIGN );
    if( out_buffer == NULL )
        th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
 #endif /* INTERLEAVED */ 
@@ -257,9 +852,11 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
     * we have all the data in the executable
 	* so initialising is simplier
 	*/ 
+#if !FFT_PLAN_BENCH
     SineV       = (e_s16 *)&sin_buf; 
     CosineV     = (e_s16 *)&cosin_buf; 
     BitRevInd   = (e_s16 *)&index_buf;
+#endif
 
 	if (argc < 2)
 	{
@@ -282,8 +879,8 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 #if !(defined(C_INTERLEAVED) && defined(D_INTERLEAVED))  
 	NumPoints     = 0;
     for(i=0; i < MAX_FFT_SIZE*2 ; i+=2){
-      InRealData[NumPoints] = input_buf[i]; 
-	  InImagData[NumPoints] = input_buf[i+1];
+      InRealData[NumPoints] = InputData[i]; 
+	  InImagData[NumPoints] = InputData[i+1];
       NumPoints++;
     }
 #else
@@ -311,18 +908,93 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
         InImagData[i] >>= FFTSize;
     } 
 #endif 
+
+#if	TH_DATA_FILES
+    /* The other blocks, laid out and prescaled as the first */
+    StreamData = NULL;
+    if ( Blocks > 1 )
+    {
+        StreamData = (e_s16 *)th_malloc_aligned( Blocks * T_BSIZE, EE_SIMD_ALIGN );
+        if( StreamData == NULL )
+            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+        for (j = 0; j < Blocks * MAX_FFT_SIZE; j++) {
+            BlockData = StreamData + (j / MAX_FFT_SIZE) * (MAX_FFT_SIZE*2);
+#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))  
+            BlockData[2*(j % MAX_FFT_SIZE)]   = InputData[2*j] >> FFTSize;
+            BlockData[2*(j % MAX_FFT_SIZE)+1] = InputData[2*j+1] >> FFTSize;
+#else
+            BlockData[j % MAX_FFT_SIZE]                = InputData[2*j] >> FFTSize;
+            BlockData[j % MAX_FFT_SIZE + MAX_FFT_SIZE] = InputData[2*j+1] >> FFTSize;
+#endif
+        }
+    }
+#endif
+
+#if FFT_INPLACE_BENCH
+/* Each iteration copies the input to the output and transforms it there */
+#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))  
+    SrcData = InData;
+    InData  = OutData;
+#else
+    SrcRealData = InRealData;
+    SrcImagData = InImagData;
+    InRealData  = OutRealData;
+    InImagData  = OutImagData;
+#endif
+#endif
+#if FFT_PLAN_BENCH
+   plan = FFTPlanInit(FFTSize);
+   if( plan == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+#endif
+
+   fxpFFTSelectKernel();  /* pick the kernel variants, see th_kernel_select() */
+
    /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
     * This is the actual benchmark
     *---------------------------------------------------------------------------*/
 
+   th_latency_begin( iterations );
    th_signal_start();  /* Tell the host that the test has begun */
 
    for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
      {
+#if	TH_DATA_FILES
+       if ( Blocks > 1 )
+       {
+           BlockData = StreamData + ( loop_cnt % Blocks ) * (MAX_FFT_SIZE*2);
+#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED)) && FFT_INPLACE_BENCH
+           SrcData     = BlockData;
+#elif (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
+           InData      = BlockData;
+#elif FFT_INPLACE_BENCH
+           SrcRealData = BlockData;
+           SrcImagData = BlockData + MAX_FFT_SIZE;
+#else
+           InRealData  = BlockData;
+           InImagData  = BlockData + MAX_FFT_SIZE;
+#endif
+       }
+#endif
+#if FFT_INPLACE_BENCH
+#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))  
+       for (i = 0; i < 2*NumPoints; i++)
+           InData[i] = SrcData[i];
+#else
+       for (i = 0; i < NumPoints; i++) {
+           InRealData[i] = SrcRealData[i];
+           InImagData[i] = SrcImagData[i];
+       }
+#endif
+#endif
        if (Direction == FORWARD)
 	 {
+#if FFT_PLAN_BENCH
+
+    FFTPlanForward(plan, InData, OutData);
+
 /* Define C_INTERLEAVED & D_INTERLEAVED at compile time for this */
-#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))  
+#elif (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))  
 
     fxpfft (
         InData,                     /* real part of input data */
@@ -351,8 +1023,12 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 	 }
        else /* Reverse */ 
 	 {
+#if FFT_PLAN_BENCH
+
+    FFTPlanInverse(plan, InData, OutData);
+
 /* Define C_INTERLEAVED & D_INTERLEAVED at compile time for this */
-#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))  
+#elif (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))  
 
     fxpifft (
         InData,                     /* real part of input data */
@@ -379,16 +1055,53 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
     ) ;
 #endif
 	 }
+       th_latency_mark();
      } /* end for */
 
    results.duration   = th_signal_finished();  /* signal that we are finished */
 
    results.iterations = iterations;
+
+#if	VERIFY_FLOAT && FLOAT_SUPPORT
+   /* Check the block of the last iteration against the exact transform of
+    * its prescaled input
+    */
+#if	TH_DATA_FILES
+   Block = Blocks > 1 && iterations > 0 ? ( iterations - 1 ) % Blocks : 0;
+#else
+   Block = 0;
+#endif
+   ref_input  = (e_s16 *)th_malloc( T_BSIZE );
+   ref_result = (e_f64 *)th_malloc( MAX_FFT_SIZE*2 * sizeof(e_f64) );
+   if( ref_input == NULL || ref_result == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+   for (i = 0; i < MAX_FFT_SIZE*2; i++)
+       ref_input[i] = InputData[Block * (MAX_FFT_SIZE*2) + i] >> FFTSize;
+   FFTReference(ref_input, ref_result, FFTSize, Direction == REVERSE);
+#endif
+
+#if FFT_PLAN_BENCH
+   FFTPlanFree(plan);
+   plan_bench(iterations, Direction);
+#endif
+#if FFT_BATCH_BENCH
+   batch_bench(iterations, Direction);
+#endif
+#if FFT_REAL_BENCH
+   real_bench(iterations, Direction);
+#endif
+#if FFT_LARGE_BENCH
+   large_bench(iterations, Direction);
+#endif
+#if FFT_LOOPBACK_BENCH
+   loopback_bench(FFTSize, SineV, CosineV, BitRevInd);
+#endif
    results.v1         = 0;
    results.v2         = 0;
    results.v3         = 0;
    results.v4         = 0;
    results.info       = info;
+   results.verify_snr = FALSE;
 
    th_sprintf( info, "A note of basic info" );
 
@@ -404,62 +1117,48 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 #if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
 
 #if	 VERIFY_FLOAT && FLOAT_SUPPORT
-	dunion.d = diffmeasure (golden_result, NumPoints, COMPLEX, OutData, NumPoints, COMPLEX);
+	dunion.d = diffmeasure_unscaled (ref_result, 2*NumPoints, COMPLEX, OutData, 2*NumPoints, COMPLEX);
 #endif
 #if	NON_INTRUSIVE_CRC_CHECK
-  for( i=0; i<NumPoints; i++ )
-	results.CRC = Calc_crc16(OutData[i],results.CRC);
+	results.CRC = Calc_crc_buf16( (const e_u16 *)OutData, (size_t)NumPoints, results.CRC );
 #endif
 
 #else
 	for( i=0; i<NumPoints; i++ ){	/* Convert into interleaved form  */ 
 		out_buffer[i*2]		= OutRealData[i];
 		out_buffer[(i*2)+1]	= OutImagData[i]; 
+	} 
 #if	NON_INTRUSIVE_CRC_CHECK
-		results.CRC = Calc_crc16(OutRealData[i],results.CRC);
-		results.CRC = Calc_crc16(OutImagData[i],results.CRC);
+	results.CRC = Calc_crc_buf16( (const e_u16 *)out_buffer, (size_t)(2*NumPoints), results.CRC );
 #endif
-	} 
 #if	 VERIFY_FLOAT && FLOAT_SUPPORT
-	dunion.d	= diffmeasure (golden_result, NumPoints, COMPLEX, out_buffer, NumPoints, COMPLEX);
+	dunion.d	= diffmeasure_unscaled (ref_result, 2*NumPoints, COMPLEX, out_buffer, 2*NumPoints, COMPLEX);
 #endif
 #endif 
 
 #if	 VERIFY_FLOAT && FLOAT_SUPPORT
 	results.v1			= dunion.v[0];
 	results.v2			= dunion.v[1];
+	dunion.d			= FFT_MIN_SNR;
+	results.v3			= dunion.v[0];
+	results.v4			= dunion.v[1];
+	results.verify_snr	= TRUE;
+	th_free( ref_input );
+	th_free( ref_result );
 #endif
 
 
-#if	!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
-   /* Calculate the size of the output buffer */ 
-   TempVal   = 0;             /* reuse this variable as a counter */ 
-   tmp_buf   = (e_s8 *)th_malloc(16); /* should acommodate largest single token */
-   if( tmp_buf == NULL )
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
-
+#if	OUTPUT_FILE
+   /* Stream the output to the host as it is formatted */
+   th_file_begin( outFilename );
    for( i=0; i<NumPoints; i++ ){
 #if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))	
-        TempVal += th_sprintf( (char *)tmp_buf," %d %d\n", OutData[2*i], OutData[2*i+1]);
+        th_file_printf( " %d %d\n", OutData[2*i], OutData[2*i+1]);
 #else
-        TempVal += th_sprintf( (char *)tmp_buf," %d %d\n", OutRealData[i], OutImagData[i]);
+        th_file_printf( " %d %d\n", OutRealData[i], OutImagData[i]);
 #endif
    } 
-   th_free(tmp_buf); 
-
-    out_symbol_buffer  = (e_u8 *)th_malloc(TempVal+1);
-	if( out_symbol_buffer == NULL )
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
-
-    stringHeadPtr = (e_s8 *)out_symbol_buffer; 
-    for( i=0; i<NumPoints; i++ ){
-#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))	
-        stringHeadPtr += th_sprintf((char *) stringHeadPtr," %d %d\n", OutData[2*i], OutData[2*i+1]);
-#else
-        stringHeadPtr += th_sprintf( (char *)stringHeadPtr," %d %d\n", OutRealData[i], OutImagData[i]);
-#endif
-    } 
-    th_send_buf_as_file((char *)out_symbol_buffer,TempVal,outFilename);
+   th_file_end();
 #endif
 
    return th_report_results( &results, EXPECTED_CRC );
@@ -36,7 +36,17 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] );
 #if NON_INTRUSIVE_CRC_CHECK
 #if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
 
+#if FFT_RADIX4
+
 #if defined(DATA_1)
+#define EXPECTED_CRC			0x78c6
+#elif defined(DATA_2)
+#define EXPECTED_CRC			0x1124
+#else
+#define EXPECTED_CRC			0xaf60
+#endif
+
+#elif defined(DATA_1)
 #define EXPECTED_CRC			0x21a5
 #elif defined(DATA_2)
 #define EXPECTED_CRC			0x0527
@@ -98,7 +108,8 @@ TCDef the_tcdef =
 	0,
 	0,
 	0,
-	0
+	0,
+	FALSE
 }; 
 
 	/* Default for all runs */
@@ -108,47 +119,38 @@ TCDef the_tcdef =
 #if defined(DATA_1)
 
 #define OUTFILENAME "xtpulse256iOutput.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xtpulse256i.dat"
 };
-static e_f64 test_buf[] = { 
-#include "vtpulse256i.dat"
-}; 
 #elif defined(DATA_2)
 
 #define OUTFILENAME "xspn256iOutput.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xspn256i.dat"
 };
-static e_f64 test_buf[] = { 
-#include "vspn256i.dat"
-}; 
 #else /* default DATA_3 */  
 
 #define OUTFILENAME "xsine256iOutput.dat"
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "xsine256i.dat"
 };
-static e_f64 test_buf[] = { 
-#include "golden_sine.dat"
-}; 
 #endif /* included data */ 
 
 #if defined(C_INTERLEAVED)
-static  e_s16 sin_buf[] = {0};
-static  e_s16 cosin_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 sin_buf[] = {0};
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 cosin_buf[] = {
 #include "cstable256i.dat"
 };
 #else
-static  e_s16 sin_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 sin_buf[] = {
 #include "stable256i.dat"
 }; 
-static  e_s16 cosin_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 cosin_buf[] = {
 #include "ctable256i.dat"
 };
 #endif
 
-static  e_s16 index_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 index_buf[] = {
 #include "brind256i.dat"
 }; 
 
@@ -193,7 +195,8 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 	const char	*outFilename;
 
 #if		VERIFY_FLOAT && FLOAT_SUPPORT
-	e_f64		*golden_result; 
+	e_s16		*ref_input;
+	e_f64		*ref_result; 
 	d_union		dunion;
 #endif
 	FFT_DIRECTION  Direction;
@@ -201,14 +204,10 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
    /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     * First, initialize the data structures we need for the test
    */
-   t_buf     = (n_char *) th_malloc( T_BSIZE );
+   t_buf     = (n_char *) th_malloc_aligned( T_BSIZE, EE_SIMD_ALIGN );
    if( t_buf == NULL )
        th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
 
-#if		VERIFY_FLOAT && FLOAT_SUPPORT
-   	golden_result	= (e_f64 *)&test_buf; 
-#endif
-
 #if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
    InData		= (e_s16 *)input_buf; 
    OutData		= (e_s16 *)t_buf;  
@@ -217,7 +216,7 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
    InImagData	= InRealData + (MAX_FFT_SIZE);
    OutRealData	= InImagData + (MAX_FFT_SIZE);
    OutImagData	= OutRealData + (MAX_FFT_SIZE);
-   out_buffer	= (e_s16 *)th_malloc( T_BSIZE );
+   out_buffer	= (e_s16 *)th_malloc_aligned( T_BSIZE, EE_SIMD_ALIGN );
    if( out_buffer == NULL )
        th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
 #endif /* INTERLEAVED */ 
@@ -278,11 +277,15 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
         InImagData[i] >>= FFTSize;
     } 
 #endif 
+
+   fxpFFTSelectKernel();  /* pick the kernel variants, see th_kernel_select() */
+
    /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
     * This is the actual benchmark
     *---------------------------------------------------------------------------*/
 
       tcdef->CRC = 0;
+   th_latency_begin( tcdef->rec_iterations );
    th_signal_start();  /* Tell the host that the test has begun */
 
    for ( loop_cnt = 0; loop_cnt < tcdef->rec_iterations; loop_cnt++ )  /* no stopping! */
@@ -347,12 +350,31 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
     ) ;
 #endif
 	 }
+       th_latency_mark();
      } /* end for */
 
 
     tcdef->duration		= th_signal_finished() ;
 	tcdef->iterations	= tcdef->rec_iterations;
 
+#if	VERIFY_FLOAT && FLOAT_SUPPORT
+	/* The exact transform of the prescaled input */
+	ref_input	= (e_s16 *)th_malloc( T_BSIZE );
+	ref_result	= (e_f64 *)th_malloc( MAX_FFT_SIZE*2 * sizeof(e_f64) );
+	if( ref_input == NULL || ref_result == NULL )
+		th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+	for( i=0; i<NumPoints; i++ ){
+#if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
+		ref_input[i*2]		= InData[i*2];
+		ref_input[(i*2)+1]	= InData[(i*2)+1];
+#else
+		ref_input[i*2]		= InRealData[i];
+		ref_input[(i*2)+1]	= InImagData[i];
+#endif
+	}
+	FFTReference(ref_input, ref_result, FFTSize, Direction == REVERSE);
+#endif
+
 #if	NON_INTRUSIVE_CRC_CHECK
 	tcdef->CRC = 0;
 #elif	CRC_CHECK
@@ -365,30 +387,34 @@ int t_run_test( struct TCDef *tcdef,int argc, const char *argv[] )
 #if (defined(C_INTERLEAVED) && defined(D_INTERLEAVED))
 
 #if	 VERIFY_FLOAT && FLOAT_SUPPORT
-	dunion.d = diffmeasure (golden_result, NumPoints, COMPLEX, OutData, NumPoints, COMPLEX);
+	dunion.d = diffmeasure_unscaled (ref_result, 2*NumPoints, COMPLEX, OutData, 2*NumPoints, COMPLEX);
 #endif
 #if	NON_INTRUSIVE_CRC_CHECK
-  for( i=0; i<NumPoints; i++ )
-	tcdef->CRC = Calc_crc16(OutData[i],tcdef->CRC);
+	tcdef->CRC = Calc_crc_buf16( (const e_u16 *)OutData, (size_t)NumPoints, tcdef->CRC );
 #endif
 
 #else
 	for( i=0; i<NumPoints; i++ ){	/* Convert into interleaved form  */ 
 		out_buffer[i*2]		= OutRealData[i];
 		out_buffer[(i*2)+1]	= OutImagData[i]; 
+	} 
 #if	NON_INTRUSIVE_CRC_CHECK
-		tcdef->CRC = Calc_crc16(OutRealData[i],tcdef->CRC);
-		tcdef->CRC = Calc_crc16(OutImagData[i],tcdef->CRC);
+	tcdef->CRC = Calc_crc_buf16( (const e_u16 *)out_buffer, (size_t)(2*NumPoints), tcdef->CRC );
 #endif
-	} 
 #if	 VERIFY_FLOAT && FLOAT_SUPPORT
-	dunion.d	= diffmeasure (golden_result, NumPoints, COMPLEX, out_buffer, NumPoints, COMPLEX);
+	dunion.d	= diffmeasure_unscaled (ref_result, 2*NumPoints, COMPLEX, out_buffer, 2*NumPoints, COMPLEX);
 #endif
 #endif 
 
 #if	 VERIFY_FLOAT && FLOAT_SUPPORT
 	tcdef->v1			= dunion.v[0];
 	tcdef->v2			= dunion.v[1];
+	dunion.d			= FFT_MIN_SNR;
+	tcdef->v3			= dunion.v[0];
+	tcdef->v4			= dunion.v[1];
+	tcdef->verify_snr	= TRUE;
+	th_free( ref_input );
+	th_free( ref_result );
 #endif
 	return	th_report_results(tcdef,EXPECTED_CRC);
 
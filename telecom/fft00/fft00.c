@@ -17,270 +17,2213 @@
 #include <math.h>
 #endif
 
+#if FFT_SIMD
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#endif
+
+#define FFT_PI 3.14159265358979323846
+
+/*
+ * FFT_VEC_POINTS: complex points per vector of the SIMD butterflies, 0 when
+ * the compiler targets none of SSE2, AVX2 or NEON. Stages whose groups are
+ * narrower than a vector run the scalar butterflies.
+ */
+#if FFT_SIMD && defined(__AVX2__)
+#define FFT_VEC_POINTS 8
+#elif FFT_SIMD && defined(__SSE2__)
+#define FFT_VEC_POINTS 4
+#elif FFT_SIMD && defined(__ARM_NEON)
+#define FFT_VEC_POINTS 8
+#else
+#define FFT_VEC_POINTS 0
+#endif
+
 
 /*******************************************************************************
     Functions                                                                   
 *******************************************************************************/
 
+/*
+ * FFTStageTwiddles: the twiddles of one radix-2 stage, twiddle j at
+ * Cos[Step*j], Sin[Step*j]. Stage k of a DataSize point transform uses
+ * twiddle table entries 0, DataSize >> k, 2*(DataSize >> k) ..., so it
+ * reads a strided subset of a full size table, or its own contiguous
+ * table, from fxpStageTwiddles.
+ */
+typedef struct {
+    const e_s16 *Cos;
+    const e_s16 *Sin;
+    n_int       Step;
+} FFTStageTwiddles;
+
 /*------------------------------------------------------------------------------
- * FUNC    : fxpfft
+ * FUNC    : fxpStageTwiddles
  *
  * DESC    : 
- * Compute the Fixed Point FFT on the 2**DataSizeExponent
- * complex input values stored in arrays InRealData and InImagData.
- * Return results in OutRealData and OutImagData
- * Requires precomputation of the sine & cosine twiddle factors.
- * Requires precomputation of the bit reversal indicies.
- *         
+ * The twiddles of stage k, from the full size table at CosV, SinV, entry m
+ * at CosV[TwStride*m], or with PerStage from per-stage tables there: the
+ * 2**(k-1) twiddles of each stage in order, stage 1 first, so that stage k
+ * starts at entry 2**(k-1) - 1.
+ *
+ * RETURNS : The twiddles in Tw
+ * ---------------------------------------------------------------------------*/
+static void
+fxpStageTwiddles (
+    FFTStageTwiddles    *Tw,
+    n_int               DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    n_int               k,                  /* stage, 1 .. DataSizeExponent */
+    const e_s16         *CosV,              /* cosine of each twiddle */
+    const e_s16         *SinV,              /* sine of each twiddle */
+    n_int               TwStride,           /* distance between twiddles */
+    n_int               PerStage            /* TRUE for per-stage tables */
+)
+{
+    n_int   First = 0;
+
+    if (PerStage) {
+        First = TwStride * ((1 << (k - 1)) - 1);
+        Tw->Step = TwStride;
+    } else {
+        Tw->Step = TwStride * ((1 << DataSizeExponent) >> k);
+    }
+    Tw->Cos = CosV + First;
+    Tw->Sin = SinV + First;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpRound
+ *
+ * DESC    : x * 2**-Shift rounded to nearest, ties to even, so that the
+ * rounding of the scaled stages has no bias to build up over the stages.
+ *
  * RETURNS : 
  * ---------------------------------------------------------------------------*/
+static e_s32
+fxpRound (
+    e_s32   x,
+    n_int   Shift
+)
+{
+    if (Shift == 0)
+        return x;
+    return ( x + ( 1L << ( Shift - 1 ) ) - 1 + ( ( x >> Shift ) & 1 ) ) >> Shift;
+}
 
-void
-fxpfft (
-    e_s16   *InRealData,        /* real part of input data */
-    e_s16   *InImagData,        /* imaginary part of input data */
-    e_s16   *OutRealData,       /* real part of output data */
-    e_s16   *OutImagData,       /* imaginary part of output data */
-    e_s16   DataSizeExponent,   /* size of data = 2**DataSizeExponent */
-    e_s16   *SineV,             /* Sine table */
-    e_s16   *CosineV,           /* Cosine table */
-    e_s16   *BitRevInd          /* bit reversal indicies */
+#if FFT_RADIX4
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpScale
+ *
+ * DESC    : x * 2**-Shift, rounded with Round, else truncated
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static e_s32
+fxpScale (
+    e_s32   x,
+    n_int   Shift,
+    n_int   Round
+)
+{
+    return Round ? fxpRound(x, Shift) : x >> Shift;
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpRadix2Stage
+ *
+ * DESC    : 
+ * Radix-2 decimation-in-time stage k of a 2**DataSizeExponent point
+ * transform on bit reversed data, in place. Point i is RealData[Stride*i],
+ * ImagData[Stride*i], so the same stage runs on split (Stride 1) and
+ * interleaved (Stride 2) data. NumVectors transforms can be interleaved
+ * point by point, point i of vector v at Stride*(NumVectors*i + v), so
+ * that each twiddle lookup serves all of them. Twiddles are looked up in
+ * order, once for all the butterflies that use them, which reads a
+ * per-stage table in sequence. Inverse conjugates the twiddles for the
+ * IFFT. If IFFT_SCALE_FACTOR = 1 the IFFT output of the stage is
+ * scaled by 1/2. With Round, for the scaled transforms, the twiddle
+ * products are rounded instead and the output is shifted right by Shift
+ * in 32 bits, rounded, without IFFT_SCALE_FACTOR.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpRadix2Stage (
+    e_s16       *RealData,          /* real part, bit reversed, in place */
+    e_s16       *ImagData,          /* imaginary part, bit reversed, in place */
+    n_int       Stride,             /* distance between points */
+    n_int       NumVectors,         /* vectors interleaved point by point */
+    n_int       DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    n_int       k,                  /* stage, 1 .. DataSizeExponent */
+    const FFTStageTwiddles *Tw,     /* twiddles of the stage */
+    n_int       Inverse,            /* TRUE for the IFFT */
+    n_int       Round,              /* TRUE for the scaled transforms */
+    n_int       Shift               /* right shift of the output, with Round */
 )
 {
     e_s32   WReal;
     e_s32   WImag;
     e_s32   tRealData;
     e_s32   tImagData;
-    e_s16   DataSize;
-    e_s16   ArgIndex;
-    e_s16   DeltaIndex;
-    e_s16   n1;
-    e_s16   n2;
-    e_s16   l;
-    e_s16   i;
-    e_s16   j;
-    e_s16   k;
-    e_s16   RealBitRevData[MAX_FFT_SIZE];
-    e_s16   ImagBitRevData[MAX_FFT_SIZE];
-
-
-/*( Make this a macro  -- Dave levine to supply code ) 8*/
+    n_int   DataSize;
+    n_int   Span;
+    n_int   n1;
+    n_int   n2;
+    n_int   l;
+    n_int   i;
+    n_int   j;
+    n_int   v;
 
-    /* Bit Reversal */
     DataSize = 1 << DataSizeExponent;
-    assert( (DataSize >= 4) && ((DataSize % 2) == 0) );
-#ifdef D_INTERLEAVED
-    for (i = 0; i < DataSize; i++) {
-        RealBitRevData[i] = InRealData[2*BitRevInd[i]];
-        ImagBitRevData[i] = InRealData[(2*BitRevInd[i])+1];
-    }
-#else
-    for (i = 0; i < DataSize; i++) {
-        RealBitRevData[i] = InRealData[BitRevInd[i]];
-        ImagBitRevData[i] = InImagData[BitRevInd[i]];
-    }
-#endif
-
-    /* FFT Computation */
-
-    /* Step through the stages */
-    for (k = 1; k <= DataSizeExponent; k++) {
-        n1 = 1<<k;
-        n2 = n1>>1;
+    Span = Stride * NumVectors;     /* distance between points of a vector */
+    n1 = 1<<k;
+    n2 = n1>>1;
 
-        /* Initialize twiddle factor lookup indicies */
-        ArgIndex = 0;
-        DeltaIndex = (DataSize >> 1) / n2;
+    /* Step through the butterflies */
+    for(j = 0; j < n2; j++) {
 
-        /* Step through the butterflies */
-        for(j = 0; j < n2; j++) {
+        /* Lookup twiddle factors */
+        WReal = Tw->Cos[Tw->Step*j];
+        WImag = Tw->Sin[Tw->Step*j];
+        if (Inverse)
+            WImag = -WImag;
 
-            /* Lookup twiddle factors */
-#ifdef C_INTERLEAVED
-            WReal = CosineV[2*ArgIndex];
-            WImag = CosineV[2*ArgIndex+1];
-#else
-            WReal = CosineV[ArgIndex];
-            WImag = SineV[ArgIndex];
-#endif
-            ArgIndex += DeltaIndex;
+        /* Process butterflies with the same twiddle factors */
+        for (v = 0; v < NumVectors; v++) {
+            for(i = Span*j + Stride*v; i < Span*DataSize; i += Span*n1) {
+                l = i + Span*n2;
 
-            /* Process butterflies with the same twiddle factors */
-            for(i = j; i < DataSize; i += n1) {
-                l = i + n2;
+                tRealData = ( WReal * RealData[l] ) + ( WImag * ImagData[l] );
+                tImagData = ( WReal * ImagData[l] ) - ( WImag * RealData[l] );
 
-                tRealData = ( WReal * RealBitRevData[l] ) + ( WImag * ImagBitRevData[l] );
-                tImagData = ( WReal * ImagBitRevData[l] ) - ( WImag * RealBitRevData[l] );
+                if (Round) {
+                    tRealData = fxpRound(tRealData, BUTTERFLY_SCALE_FACTOR);
+                    tImagData = fxpRound(tImagData, BUTTERFLY_SCALE_FACTOR);
+                    RealData[l] = (e_s16)fxpRound(RealData[i] - tRealData, Shift);
+                    ImagData[l] = (e_s16)fxpRound(ImagData[i] - tImagData, Shift);
+                    RealData[i] = (e_s16)fxpRound(RealData[i] + tRealData, Shift);
+                    ImagData[i] = (e_s16)fxpRound(ImagData[i] + tImagData, Shift);
+                    continue;
+                }
 
                 /* Scale twiddle products to accomodate 16 bit storage */
                 tRealData = tRealData >> BUTTERFLY_SCALE_FACTOR;
                 tImagData = tImagData >> BUTTERFLY_SCALE_FACTOR;
-                RealBitRevData[l] = RealBitRevData[i] - tRealData;
-                ImagBitRevData[l] = ImagBitRevData[i] - tImagData;
-                RealBitRevData[i] += tRealData;
-                ImagBitRevData[i] += tImagData;
+                RealData[l] = RealData[i] - tRealData;
+                ImagData[l] = ImagData[i] - tImagData;
+                RealData[i] += tRealData;
+                ImagData[i] += tImagData;
+
+#if IFFT_SCALE_FACTOR
+                if (Inverse) {
+                    /* 1/N IFFT scaling implemented each stage */
+                    RealData[l] >>= IFFT_SCALE_FACTOR;
+                    ImagData[l] >>= IFFT_SCALE_FACTOR;
+                    RealData[i] >>= IFFT_SCALE_FACTOR;
+                    ImagData[i] >>= IFFT_SCALE_FACTOR;
+                }
+#endif
             }
         }
     }
-
-    /* Return bit reversed data to output arrays */
-#ifdef D_INTERLEAVED
-    for(i = 0; i < DataSize; i++) {
-        OutRealData[2*i] = RealBitRevData[i];
-        OutRealData[2*i+1] = ImagBitRevData[i];
-    }
-#else
-    for(i = 0; i < DataSize; i++) {
-        OutRealData[i] = RealBitRevData[i];
-        OutImagData[i] = ImagBitRevData[i];
-    }
-#endif
 }
 
+#if FFT_RADIX4
 /*------------------------------------------------------------------------------
- * FUNC    : ipow
+ * FUNC    : fxpRadix4Twiddles
  *
- * DESC    : Integer version of pow
- * RETURNS : y to the x power
+ * DESC    : 
+ * The three twiddles of butterfly j of the radix-4 stage made of radix-2
+ * stages k and k+1, whose twiddles are Tw[0] and Tw[1]: twiddle j of the
+ * second stage (c) and of the first stage (b), and their product (d),
+ * rounded and kept within 16 bits.
+ *
+ * RETURNS : The twiddles in W[0..5], real and imaginary for c, b, d
  * ---------------------------------------------------------------------------*/
-n_int	ipow(n_int x, n_int y)
+static void
+fxpRadix4Twiddles (
+    n_int       j,                  /* butterfly */
+    const FFTStageTwiddles *Tw,     /* twiddles of the two radix-2 stages */
+    n_int       Inverse,            /* TRUE for the IFFT */
+    e_s32       *W
+)
 {
-	n_int	i,tmp=1;
+    W[0] = Tw[1].Cos[Tw[1].Step*j];
+    W[1] = Tw[1].Sin[Tw[1].Step*j];
+    W[2] = Tw[0].Cos[Tw[0].Step*j];
+    W[3] = Tw[0].Sin[Tw[0].Step*j];
+    if (Inverse) {
+        W[1] = -W[1];
+        W[3] = -W[3];
+    }
+    W[4] = ( ( W[0] * W[2] ) - ( W[1] * W[3] ) + ( 1L << ( BUTTERFLY_SCALE_FACTOR - 1 ) ) ) >> BUTTERFLY_SCALE_FACTOR;
+    W[5] = ( ( W[0] * W[3] ) + ( W[1] * W[2] ) + ( 1L << ( BUTTERFLY_SCALE_FACTOR - 1 ) ) ) >> BUTTERFLY_SCALE_FACTOR;
 
-	for (i=0;i<y;i++) tmp*=x;
-	return tmp;
+    /*
+     * Rounding can reach +-TRIG_SCALE_FACTOR; keep the product within 16
+     * bits, and symmetric so that the IFFT twiddle is the FFT's conjugate.
+     */
+    if (W[4] >= TRIG_SCALE_FACTOR)
+        W[4] = TRIG_SCALE_FACTOR - 1;
+    if (W[4] <= -TRIG_SCALE_FACTOR)
+        W[4] = 1 - TRIG_SCALE_FACTOR;
+    if (W[5] >= TRIG_SCALE_FACTOR)
+        W[5] = TRIG_SCALE_FACTOR - 1;
+    if (W[5] <= -TRIG_SCALE_FACTOR)
+        W[5] = 1 - TRIG_SCALE_FACTOR;
 }
 
 /*------------------------------------------------------------------------------
- * FUNC    : fxpifft
+ * FUNC    : fxpRadix4Stage
  *
  * DESC    : 
- * Compute the Radix 2  Decimation-in-Time IFFT on the 2**DataSizeExponent
- * complex input values stored in arrays RealData and ImagData.
- * Return results in OutRealData and OutImagData
- * Requires precomputation of the sine & cosine twiddle factors.
- * Requires precomputation of the bit reversal indicies.
+ * Radix-4 stage made of radix-2 stages k and k+1, with the arguments of
+ * fxpRadix2Stage and the twiddles of both stages. It does their work with 3 twiddle multiplies per 4
+ * points instead of 4: the second radix-2 stage's twiddle for the upper
+ * half of a group is the lower half's rotated by a quarter turn, which is
+ * free, and the two multiplies on the last input fold into one by the
+ * product of the two twiddles, formed once per twiddle group.
  *
- * If IFFT_SCALE_FACTOR = 1 then generate code for 1/N ifft scaling.
+ * Twiddle products are scaled by BUTTERFLY_SCALE_FACTOR as in the radix-2
+ * stages. With IFFT_SCALE_FACTOR the IFFT output of each radix-4 stage is
+ * scaled by its two radix-2 stages' worth. Rounding differs from the
+ * radix-2 stages, so the output is close to, not identical with, theirs.
+ * Round and Shift are as in fxpRadix2Stage, Shift covering both stages.
  *
  * RETURNS : 
  * ---------------------------------------------------------------------------*/
-void
-fxpifft (
-    e_s16   *InRealData,        /* real part of input data */
-    e_s16   *InImagData,        /* imaginary part of input data */
-    e_s16   *OutRealData,       /* real part of output data */
-    e_s16   *OutImagData,       /* imaginary part of output data */
-    e_s16   DataSizeExponent,   /* size of data = 2**DataSizeExponent */
-    e_s16   *SineV,             /* Sine table */
-    e_s16   *CosineV,           /* Cosine table */
-    e_s16   *BitRevInd          /* bit reversal indicies */
+static void
+fxpRadix4Stage (
+    e_s16       *RealData,          /* real part, bit reversed, in place */
+    e_s16       *ImagData,          /* imaginary part, bit reversed, in place */
+    n_int       Stride,             /* distance between points */
+    n_int       NumVectors,         /* vectors interleaved point by point */
+    n_int       DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    n_int       k,                  /* first radix-2 stage */
+    const FFTStageTwiddles *Tw,     /* twiddles of stages k and k+1 */
+    n_int       Inverse,            /* TRUE for the IFFT */
+    n_int       Round,              /* TRUE for the scaled transforms */
+    n_int       Shift               /* right shift of the output, with Round */
 )
 {
-    e_s32   WReal;
-    e_s32   WImag;
-    e_s32   tRealData;
-    e_s32   tImagData;
-    e_s16   DataSize;
-    e_s16   ArgIndex;
-    e_s16   DeltaIndex;
-    e_s16   n1;
-    e_s16   n2;
-    e_s16   l;
-    e_s16   i;
-    e_s16   j;
-    e_s16   k;
-    e_s16   RealBitRevData[MAX_FFT_SIZE];
-    e_s16   ImagBitRevData[MAX_FFT_SIZE];
+    e_s32   W[6];
+    e_s32   ARe, AIm, BRe, BIm, X1Re, X1Im, X2Re, X2Im, X3Re, X3Im;
+    e_s32   SRe, SIm, DRe, DIm;
+    n_int   DataSize, Span, OutShift;
+    n_int   h, i, j, v, p1, p2, p3;
 
-    /* Bit Reversal */
-    DataSize = 1<<DataSizeExponent;
+    DataSize = 1 << DataSizeExponent;
+    OutShift = Round ? Shift : ( Inverse ? 2*IFFT_SCALE_FACTOR : 0 );
+    Span = Stride * NumVectors;     /* distance between points of a vector */
+    h = 1 << (k - 1);               /* n2 of the first radix-2 stage */
 
+    for (j = 0; j < h; j++) {
+        fxpRadix4Twiddles(j, Tw, Inverse, W);
 
-#ifdef D_INTERLEAVED
-    for (i = 0; i < DataSize; i++) {
-        RealBitRevData[i] = InRealData[2*BitRevInd[i]];
-        ImagBitRevData[i] = InRealData[(2*BitRevInd[i])+1];
+        for (v = 0; v < NumVectors; v++) {
+            for (i = Span*j + Stride*v; i < Span*DataSize; i += Span*4*h) {
+                p1 = i + Span*h;
+                p2 = p1 + Span*h;
+                p3 = p2 + Span*h;
+
+                X2Re = fxpScale( ( W[2] * RealData[p1] ) + ( W[3] * ImagData[p1] ), BUTTERFLY_SCALE_FACTOR, Round );
+                X2Im = fxpScale( ( W[2] * ImagData[p1] ) - ( W[3] * RealData[p1] ), BUTTERFLY_SCALE_FACTOR, Round );
+                X1Re = fxpScale( ( W[0] * RealData[p2] ) + ( W[1] * ImagData[p2] ), BUTTERFLY_SCALE_FACTOR, Round );
+                X1Im = fxpScale( ( W[0] * ImagData[p2] ) - ( W[1] * RealData[p2] ), BUTTERFLY_SCALE_FACTOR, Round );
+                X3Re = fxpScale( ( W[4] * RealData[p3] ) + ( W[5] * ImagData[p3] ), BUTTERFLY_SCALE_FACTOR, Round );
+                X3Im = fxpScale( ( W[4] * ImagData[p3] ) - ( W[5] * RealData[p3] ), BUTTERFLY_SCALE_FACTOR, Round );
+
+                ARe = RealData[i] + X2Re;
+                AIm = ImagData[i] + X2Im;
+                BRe = RealData[i] - X2Re;
+                BIm = ImagData[i] - X2Im;
+                SRe = X1Re + X3Re;
+                SIm = X1Im + X3Im;
+
+                /* Quarter turn: -j for the FFT, +j for the IFFT */
+                if (Inverse) {
+                    DRe = X3Im - X1Im;
+                    DIm = X1Re - X3Re;
+                } else {
+                    DRe = X1Im - X3Im;
+                    DIm = X3Re - X1Re;
+                }
+
+                RealData[i]  = (e_s16)fxpScale( ARe + SRe, OutShift, Round );
+                ImagData[i]  = (e_s16)fxpScale( AIm + SIm, OutShift, Round );
+                RealData[p2] = (e_s16)fxpScale( ARe - SRe, OutShift, Round );
+                ImagData[p2] = (e_s16)fxpScale( AIm - SIm, OutShift, Round );
+                RealData[p1] = (e_s16)fxpScale( BRe + DRe, OutShift, Round );
+                ImagData[p1] = (e_s16)fxpScale( BIm + DIm, OutShift, Round );
+                RealData[p3] = (e_s16)fxpScale( BRe - DRe, OutShift, Round );
+                ImagData[p3] = (e_s16)fxpScale( BIm - DIm, OutShift, Round );
+            }
+        }
     }
+}
+#endif /* FFT_RADIX4 */
+
+#if FFT_VEC_POINTS
+/*
+ * SIMD butterflies on interleaved (real, imaginary) data, FFT_VEC_POINTS
+ * consecutive butterflies of a group per vector, each with its own
+ * twiddle. They are bit-exact with the scalar stages: the twiddle
+ * products are formed in 32 bits and shifted right by
+ * BUTTERFLY_SCALE_FACTOR, and the sums wrap in 16 bits as the e_s16 stores
+ * of the scalar code do.
+ */
+#if defined(__AVX2__) || defined(__SSE2__)
+/*
+ * x86: a vector holds FFT_VEC_POINTS interleaved points. pmaddwd of the
+ * points with (WReal, WImag) pairs gives the real parts of the twiddle
+ * products; of the points with re/im swapped and (WReal, -WImag) pairs,
+ * the imaginary parts.
+ */
+#if defined(__AVX2__)
+typedef __m256i FFTVec;
+#define FV_LOAD(p)      _mm256_loadu_si256((const __m256i *)(p))
+#define FV_STORE(p, v)  _mm256_storeu_si256((__m256i *)(p), v)
+#define FV_ADD          _mm256_add_epi16
+#define FV_SUB          _mm256_sub_epi16
+#define FV_MUL          _mm256_mullo_epi16
+#define FV_MADD         _mm256_madd_epi16
+#define FV_AND          _mm256_and_si256
+#define FV_OR           _mm256_or_si256
+#define FV_SRA32        _mm256_srai_epi32
+#define FV_SLL32        _mm256_slli_epi32
+#define FV_SRA16        _mm256_srai_epi16
+#define FV_SET32        _mm256_set1_epi32
+#define FV_SWAP(v)      _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, 0xB1), 0xB1)
 #else
-    for(i = 0; i < DataSize; i++) {
-        RealBitRevData[i] = InRealData[BitRevInd[i]];
-        ImagBitRevData[i] = InImagData[BitRevInd[i]];
-    }
+typedef __m128i FFTVec;
+#define FV_LOAD(p)      _mm_loadu_si128((const __m128i *)(p))
+#define FV_STORE(p, v)  _mm_storeu_si128((__m128i *)(p), v)
+#define FV_ADD          _mm_add_epi16
+#define FV_SUB          _mm_sub_epi16
+#define FV_MUL          _mm_mullo_epi16
+#define FV_MADD         _mm_madd_epi16
+#define FV_AND          _mm_and_si128
+#define FV_OR           _mm_or_si128
+#define FV_SRA32        _mm_srai_epi32
+#define FV_SLL32        _mm_slli_epi32
+#define FV_SRA16        _mm_srai_epi16
+#define FV_SET32        _mm_set1_epi32
+#define FV_SWAP(v)      _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1)
 #endif
 
-    /* IFFT Computation */
+/* Twiddles of a vector: (WReal, WImag) and (WReal, -WImag) pairs */
+typedef struct {
+    FFTVec  W;
+    FFTVec  WConj;
+} FFTVecTwiddle;
 
-    /* Step through the stages */
-    for(k = 1; k <= DataSizeExponent; k++) {
-        n1 = 1<<k;
-        n2 = n1>>1;
+static void fxpVecTwiddle(FFTVecTwiddle *t, const e_s32 *WReal, const e_s32 *WImag)
+{
+    e_s16   w[2*FFT_VEC_POINTS], wc[2*FFT_VEC_POINTS];
+    n_int   p;
 
-        /* Initialize twiddle factor lookup indicies */
-        ArgIndex = 0;
-        DeltaIndex = (DataSize >> 1)/n2;
+    for (p = 0; p < FFT_VEC_POINTS; p++) {
+        w[2*p]    = (e_s16)WReal[p];
+        w[2*p+1]  = (e_s16)WImag[p];
+        wc[2*p]   = (e_s16)WReal[p];
+        wc[2*p+1] = (e_s16)-WImag[p];
+    }
+    t->W     = FV_LOAD(w);
+    t->WConj = FV_LOAD(wc);
+}
 
-        /* Step through the butterflies */
-        for(j = 0; j < n2; j++) {
+#if !FFT_RADIX4
+/* Twiddles of a vector from FFT_VEC_POINTS contiguous (cos, sin) pairs */
+static void fxpVecTwiddleLoad(FFTVecTwiddle *t, const e_s16 *Pairs, n_int Inverse)
+{
+    FFTVec  w, wc;
 
-            /* Lookup twiddle factors */
+    w  = FV_LOAD(Pairs);
+    wc = FV_MUL(w, FV_SET32(-65535));   /* (1, -1) in each pair */
+    t->W     = Inverse ? wc : w;
+    t->WConj = Inverse ? w : wc;
+}
+#endif
 
+/* Twiddle products of the points at pData, truncated to 16 bits */
+static FFTVec fxpVecMul(const e_s16 *pData, const FFTVecTwiddle *t)
+{
+    FFTVec  x, tRe, tIm;
 
-#ifdef C_INTERLEAVED
+    x   = FV_LOAD(pData);
+    tRe = FV_SRA32(FV_MADD(x, t->W), BUTTERFLY_SCALE_FACTOR);
+    tIm = FV_SRA32(FV_MADD(FV_SWAP(x), t->WConj), BUTTERFLY_SCALE_FACTOR);
+    return FV_OR(FV_AND(tRe, FV_SET32(0xffff)), FV_SLL32(tIm, 16));
+}
 
-            WReal = CosineV[2*ArgIndex];
-            WImag = -CosineV[2*ArgIndex+1];
-#else
+#if !FFT_RADIX4
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpRadix2StageVec
+ *
+ * DESC    : 
+ * fxpRadix2Stage on interleaved data, for NumVectors*2**(k-1) a multiple
+ * of FFT_VEC_POINTS.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpRadix2StageVec (
+    e_s16       *Data,              /* interleaved data, bit reversed, in place */
+    n_int       NumVectors,         /* vectors interleaved point by point */
+    n_int       DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    n_int       k,                  /* stage */
+    const FFTStageTwiddles *Tw,     /* twiddles of the stage */
+    n_int       Inverse             /* TRUE for the IFFT */
+)
+{
+    FFTVecTwiddle   VTw;
+    FFTVec          x, t;
+    e_s32           WReal[FFT_VEC_POINTS], WImag[FFT_VEC_POINTS];
+    n_int           DataSize, n1, n2, i, j, p;
 
-            WReal = CosineV[ArgIndex];
+    /* Across the interleaved vectors, column j has twiddle j/NumVectors */
+    DataSize = NumVectors << DataSizeExponent;
+    n1 = NumVectors << k;
+    n2 = n1>>1;
 
-            /* Compute  proper sign of the sine term for IFFT */
-            WImag = -SineV[ArgIndex];
+    for (j = 0; j < n2; j += FFT_VEC_POINTS) {
+        if (NumVectors == 1 && Tw->Step == 2 && Tw->Sin == Tw->Cos + 1) {
+            /* Contiguous (cos, sin) pairs */
+            fxpVecTwiddleLoad(&VTw, Tw->Cos + 2*j, Inverse);
+        } else {
+            for (p = 0; p < FFT_VEC_POINTS; p++) {
+                WReal[p] = Tw->Cos[Tw->Step*((j+p)/NumVectors)];
+                WImag[p] = Tw->Sin[Tw->Step*((j+p)/NumVectors)];
+                if (Inverse)
+                    WImag[p] = -WImag[p];
+            }
+            fxpVecTwiddle(&VTw, WReal, WImag);
+        }
 
+        for (i = j; i < DataSize; i += n1) {
+            t = fxpVecMul(Data + 2*(i + n2), &VTw);
+            x = FV_LOAD(Data + 2*i);
+#if IFFT_SCALE_FACTOR
+            if (Inverse) {
+                FV_STORE(Data + 2*(i + n2), FV_SRA16(FV_SUB(x, t), IFFT_SCALE_FACTOR));
+                FV_STORE(Data + 2*i, FV_SRA16(FV_ADD(x, t), IFFT_SCALE_FACTOR));
+                continue;
+            }
 #endif
+            FV_STORE(Data + 2*(i + n2), FV_SUB(x, t));
+            FV_STORE(Data + 2*i, FV_ADD(x, t));
+        }
+    }
+}
+
+#else
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpRadix4StageVec
+ *
+ * DESC    : 
+ * fxpRadix4Stage on interleaved data, for NumVectors*2**(k-1) a multiple
+ * of FFT_VEC_POINTS and not for the IFFT with IFFT_SCALE_FACTOR, whose shift the scalar stage
+ * applies before the 16 bit wrap.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpRadix4StageVec (
+    e_s16       *Data,              /* interleaved data, bit reversed, in place */
+    n_int       NumVectors,         /* vectors interleaved point by point */
+    n_int       DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    n_int       k,                  /* first radix-2 stage */
+    const FFTStageTwiddles *Tw,     /* twiddles of stages k and k+1 */
+    n_int       Inverse             /* TRUE for the IFFT */
+)
+{
+    FFTVecTwiddle   VTw1, VTw2, VTw3;
+    FFTVec          a, A, B, S, D, X1, X2, X3, Rot;
+    e_s32           W[6];
+    e_s32           WReal[3][FFT_VEC_POINTS], WImag[3][FFT_VEC_POINTS];
+    e_s16           r[2*FFT_VEC_POINTS];
+    n_int           DataSize, h, i, j, p;
 
-            ArgIndex += DeltaIndex;
+    /* Across the interleaved vectors, column j has twiddle j/NumVectors */
+    DataSize = NumVectors << DataSizeExponent;
+    h = NumVectors << (k - 1);
 
-            /* Process butterflies with the same twiddle factors */
-            for(i = j; i < DataSize; i += n1) {
-                l = i + n2;
+    /* Quarter turn after the re/im swap: -j for the FFT, +j for the IFFT */
+    for (p = 0; p < FFT_VEC_POINTS; p++) {
+        r[2*p]   = (e_s16)(Inverse ? -1 : 1);
+        r[2*p+1] = (e_s16)(Inverse ? 1 : -1);
+    }
+    Rot = FV_LOAD(r);
 
-                tRealData = ( WReal * RealBitRevData[l] ) + ( WImag * ImagBitRevData[l] );
-                tImagData = ( WReal * ImagBitRevData[l] ) - ( WImag * RealBitRevData[l] );
+    for (j = 0; j < h; j += FFT_VEC_POINTS) {
+        for (p = 0; p < FFT_VEC_POINTS; p++) {
+            if (p == 0 || (j + p) % NumVectors == 0)
+                fxpRadix4Twiddles((j + p) / NumVectors, Tw, Inverse, W);
+            WReal[0][p] = W[0];
+            WImag[0][p] = W[1];
+            WReal[1][p] = W[2];
+            WImag[1][p] = W[3];
+            WReal[2][p] = W[4];
+            WImag[2][p] = W[5];
+        }
+        fxpVecTwiddle(&VTw1, WReal[0], WImag[0]);
+        fxpVecTwiddle(&VTw2, WReal[1], WImag[1]);
+        fxpVecTwiddle(&VTw3, WReal[2], WImag[2]);
 
-                /* Scale twiddle products to accomodate 16 bit storage */
-                tRealData = tRealData >> BUTTERFLY_SCALE_FACTOR;
-                tImagData = tImagData >> BUTTERFLY_SCALE_FACTOR;
+        for (i = j; i < DataSize; i += 4*h) {
+            X2 = fxpVecMul(Data + 2*(i + h), &VTw2);
+            X1 = fxpVecMul(Data + 2*(i + 2*h), &VTw1);
+            X3 = fxpVecMul(Data + 2*(i + 3*h), &VTw3);
+            a  = FV_LOAD(Data + 2*i);
 
-                RealBitRevData[l] = RealBitRevData[i] - tRealData;
-                ImagBitRevData[l] = ImagBitRevData[i] - tImagData;
-                RealBitRevData[i] += tRealData;
-                ImagBitRevData[i] += tImagData;
+            A = FV_ADD(a, X2);
+            B = FV_SUB(a, X2);
+            S = FV_ADD(X1, X3);
+            D = FV_MUL(FV_SWAP(FV_SUB(X1, X3)), Rot);
 
-#if IFFT_SCALE_FACTOR
-                /* 1/N IFFT scaling implemented each stage */
-                RealBitRevData[l] >>= IFFT_SCALE_FACTOR;
-                ImagBitRevData[l] >>= IFFT_SCALE_FACTOR;
-                RealBitRevData[i] >>= IFFT_SCALE_FACTOR;
-                ImagBitRevData[i] >>= IFFT_SCALE_FACTOR;
+            FV_STORE(Data + 2*i,         FV_ADD(A, S));
+            FV_STORE(Data + 2*(i + 2*h), FV_SUB(A, S));
+            FV_STORE(Data + 2*(i + h),   FV_ADD(B, D));
+            FV_STORE(Data + 2*(i + 3*h), FV_SUB(B, D));
+        }
+    }
+}
+#endif /* !FFT_RADIX4 */
+
+#elif defined(__ARM_NEON)
+/*
+ * NEON: vld2q splits 8 interleaved points into real and imaginary vectors,
+ * the twiddle products are formed with widening multiplies, and vshrn
+ * shifts and truncates them to 16 bits.
+ */
+typedef struct {
+    int16x8_t   WReal;
+    int16x8_t   WImag;
+} FFTVecTwiddle;
+
+static void fxpVecTwiddle(FFTVecTwiddle *t, const e_s32 *WReal, const e_s32 *WImag)
+{
+    e_s16   wr[FFT_VEC_POINTS], wi[FFT_VEC_POINTS];
+    n_int   p;
+
+    for (p = 0; p < FFT_VEC_POINTS; p++) {
+        wr[p] = (e_s16)WReal[p];
+        wi[p] = (e_s16)WImag[p];
+    }
+    t->WReal = vld1q_s16(wr);
+    t->WImag = vld1q_s16(wi);
+}
+
+#if !FFT_RADIX4
+/* Twiddles of a vector from FFT_VEC_POINTS contiguous (cos, sin) pairs */
+static void fxpVecTwiddleLoad(FFTVecTwiddle *t, const e_s16 *Pairs, n_int Inverse)
+{
+    int16x8x2_t w;
+
+    w = vld2q_s16(Pairs);
+    t->WReal = w.val[0];
+    t->WImag = Inverse ? vnegq_s16(w.val[1]) : w.val[1];
+}
 #endif
 
+/* Twiddle products of the points at pData, truncated to 16 bits */
+static int16x8x2_t fxpVecMul(const e_s16 *pData, const FFTVecTwiddle *t)
+{
+    int16x8x2_t x, r;
+    int32x4_t   lo, hi;
+
+    x  = vld2q_s16(pData);
+    lo = vmlal_s16(vmull_s16(vget_low_s16(t->WReal), vget_low_s16(x.val[0])),
+                   vget_low_s16(t->WImag), vget_low_s16(x.val[1]));
+    hi = vmlal_s16(vmull_s16(vget_high_s16(t->WReal), vget_high_s16(x.val[0])),
+                   vget_high_s16(t->WImag), vget_high_s16(x.val[1]));
+    r.val[0] = vcombine_s16(vshrn_n_s32(lo, BUTTERFLY_SCALE_FACTOR),
+                            vshrn_n_s32(hi, BUTTERFLY_SCALE_FACTOR));
+    lo = vmlsl_s16(vmull_s16(vget_low_s16(t->WReal), vget_low_s16(x.val[1])),
+                   vget_low_s16(t->WImag), vget_low_s16(x.val[0]));
+    hi = vmlsl_s16(vmull_s16(vget_high_s16(t->WReal), vget_high_s16(x.val[1])),
+                   vget_high_s16(t->WImag), vget_high_s16(x.val[0]));
+    r.val[1] = vcombine_s16(vshrn_n_s32(lo, BUTTERFLY_SCALE_FACTOR),
+                            vshrn_n_s32(hi, BUTTERFLY_SCALE_FACTOR));
+    return r;
+}
+
+#if !FFT_RADIX4
+static void
+fxpRadix2StageVec (
+    e_s16       *Data,              /* interleaved data, bit reversed, in place */
+    n_int       NumVectors,         /* vectors interleaved point by point */
+    n_int       DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    n_int       k,                  /* stage */
+    const FFTStageTwiddles *Tw,     /* twiddles of the stage */
+    n_int       Inverse             /* TRUE for the IFFT */
+)
+{
+    FFTVecTwiddle   VTw;
+    int16x8x2_t     x, t, y;
+    e_s32           WReal[FFT_VEC_POINTS], WImag[FFT_VEC_POINTS];
+    n_int           DataSize, n1, n2, i, j, p;
+
+    /* Across the interleaved vectors, column j has twiddle j/NumVectors */
+    DataSize = NumVectors << DataSizeExponent;
+    n1 = NumVectors << k;
+    n2 = n1>>1;
+
+    for (j = 0; j < n2; j += FFT_VEC_POINTS) {
+        if (NumVectors == 1 && Tw->Step == 2 && Tw->Sin == Tw->Cos + 1) {
+            /* Contiguous (cos, sin) pairs */
+            fxpVecTwiddleLoad(&VTw, Tw->Cos + 2*j, Inverse);
+        } else {
+            for (p = 0; p < FFT_VEC_POINTS; p++) {
+                WReal[p] = Tw->Cos[Tw->Step*((j+p)/NumVectors)];
+                WImag[p] = Tw->Sin[Tw->Step*((j+p)/NumVectors)];
+                if (Inverse)
+                    WImag[p] = -WImag[p];
+            }
+            fxpVecTwiddle(&VTw, WReal, WImag);
+        }
+
+        for (i = j; i < DataSize; i += n1) {
+            t = fxpVecMul(Data + 2*(i + n2), &VTw);
+            x = vld2q_s16(Data + 2*i);
+            y.val[0] = vsubq_s16(x.val[0], t.val[0]);
+            y.val[1] = vsubq_s16(x.val[1], t.val[1]);
+            x.val[0] = vaddq_s16(x.val[0], t.val[0]);
+            x.val[1] = vaddq_s16(x.val[1], t.val[1]);
+#if IFFT_SCALE_FACTOR
+            if (Inverse) {
+                y.val[0] = vshrq_n_s16(y.val[0], IFFT_SCALE_FACTOR);
+                y.val[1] = vshrq_n_s16(y.val[1], IFFT_SCALE_FACTOR);
+                x.val[0] = vshrq_n_s16(x.val[0], IFFT_SCALE_FACTOR);
+                x.val[1] = vshrq_n_s16(x.val[1], IFFT_SCALE_FACTOR);
             }
+#endif
+            vst2q_s16(Data + 2*(i + n2), y);
+            vst2q_s16(Data + 2*i, x);
         }
     }
+}
 
-    /* Return bit reversed data to output arrays */
+#else
+static void
+fxpRadix4StageVec (
+    e_s16       *Data,              /* interleaved data, bit reversed, in place */
+    n_int       NumVectors,         /* vectors interleaved point by point */
+    n_int       DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    n_int       k,                  /* first radix-2 stage */
+    const FFTStageTwiddles *Tw,     /* twiddles of stages k and k+1 */
+    n_int       Inverse             /* TRUE for the IFFT */
+)
+{
+    FFTVecTwiddle   VTw1, VTw2, VTw3;
+    int16x8x2_t     a, X1, X2, X3, y;
+    int16x8_t       ARe, AIm, BRe, BIm, SRe, SIm, DRe, DIm;
+    e_s32           W[6];
+    e_s32           WReal[3][FFT_VEC_POINTS], WImag[3][FFT_VEC_POINTS];
+    n_int           DataSize, h, i, j, p;
 
-#ifdef D_INTERLEAVED
-    for(i = 0; i < DataSize; i++) {
-        OutRealData[2*i] = RealBitRevData[i];
-        OutRealData[2*i+1] = ImagBitRevData[i];
+    /* Across the interleaved vectors, column j has twiddle j/NumVectors */
+    DataSize = NumVectors << DataSizeExponent;
+    h = NumVectors << (k - 1);
+
+    for (j = 0; j < h; j += FFT_VEC_POINTS) {
+        for (p = 0; p < FFT_VEC_POINTS; p++) {
+            if (p == 0 || (j + p) % NumVectors == 0)
+                fxpRadix4Twiddles((j + p) / NumVectors, Tw, Inverse, W);
+            WReal[0][p] = W[0];
+            WImag[0][p] = W[1];
+            WReal[1][p] = W[2];
+            WImag[1][p] = W[3];
+            WReal[2][p] = W[4];
+            WImag[2][p] = W[5];
+        }
+        fxpVecTwiddle(&VTw1, WReal[0], WImag[0]);
+        fxpVecTwiddle(&VTw2, WReal[1], WImag[1]);
+        fxpVecTwiddle(&VTw3, WReal[2], WImag[2]);
+
+        for (i = j; i < DataSize; i += 4*h) {
+            X2 = fxpVecMul(Data + 2*(i + h), &VTw2);
+            X1 = fxpVecMul(Data + 2*(i + 2*h), &VTw1);
+            X3 = fxpVecMul(Data + 2*(i + 3*h), &VTw3);
+            a  = vld2q_s16(Data + 2*i);
+
+            ARe = vaddq_s16(a.val[0], X2.val[0]);
+            AIm = vaddq_s16(a.val[1], X2.val[1]);
+            BRe = vsubq_s16(a.val[0], X2.val[0]);
+            BIm = vsubq_s16(a.val[1], X2.val[1]);
+            SRe = vaddq_s16(X1.val[0], X3.val[0]);
+            SIm = vaddq_s16(X1.val[1], X3.val[1]);
+
+            /* Quarter turn: -j for the FFT, +j for the IFFT */
+            if (Inverse) {
+                DRe = vsubq_s16(X3.val[1], X1.val[1]);
+                DIm = vsubq_s16(X1.val[0], X3.val[0]);
+            } else {
+                DRe = vsubq_s16(X1.val[1], X3.val[1]);
+                DIm = vsubq_s16(X3.val[0], X1.val[0]);
+            }
+
+            y.val[0] = vaddq_s16(ARe, SRe);
+            y.val[1] = vaddq_s16(AIm, SIm);
+            vst2q_s16(Data + 2*i, y);
+            y.val[0] = vsubq_s16(ARe, SRe);
+            y.val[1] = vsubq_s16(AIm, SIm);
+            vst2q_s16(Data + 2*(i + 2*h), y);
+            y.val[0] = vaddq_s16(BRe, DRe);
+            y.val[1] = vaddq_s16(BIm, DIm);
+            vst2q_s16(Data + 2*(i + h), y);
+            y.val[0] = vsubq_s16(BRe, DRe);
+            y.val[1] = vsubq_s16(BIm, DIm);
+            vst2q_s16(Data + 2*(i + 3*h), y);
+        }
     }
+}
+#endif /* !FFT_RADIX4 */
+#endif /* __ARM_NEON */
+
+/* The vector stage fxpFFTSelectKernel picked, NULL for scalar */
+static void (*StageVec)(e_s16 *, n_int, n_int, n_int, const FFTStageTwiddles *, n_int) =
+#if FFT_RADIX4
+    fxpRadix4StageVec;
 #else
-    for(i = 0; i < DataSize; i++) {
-        OutRealData[i] = RealBitRevData[i];
-        OutImagData[i] = ImagBitRevData[i];
-    }
+    fxpRadix2StageVec;
 #endif
-}
+#endif /* FFT_VEC_POINTS */
 
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpFFTSelectKernel
+ *
+ * DESC    : 
+ * Picks the SIMD butterflies of FFT_SIMD, or the scalar ones, with
+ * th_kernel_select: the best the CPU runs unless -kernel= forces one.
+ * Without SIMD butterflies there is nothing to pick.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void
+fxpFFTSelectKernel (void)
+{
+#if FFT_VEC_POINTS
+    static const THKernelVariant Variants[] = {
+#if defined(__AVX2__)
+        { "avx2",   TH_CPU_AVX2 },
+#elif defined(__SSE2__)
+        { "sse2",   TH_CPU_SSE2 },
+#else
+        { "neon",   TH_CPU_NEON },
+#endif
+        { "scalar", 0 }
+    };
+
+    if (th_kernel_select("fft", Variants, 2) == 0)
+#if FFT_RADIX4
+        StageVec = fxpRadix4StageVec;
+#else
+        StageVec = fxpRadix2StageVec;
+#endif
+    else
+        StageVec = NULL;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpStages
+ *
+ * DESC    : 
+ * All stages of a 2**DataSizeExponent point transform on bit reversed
+ * data, with the arguments of fxpRadix2Stage and the twiddle tables of
+ * fxpStageTwiddles: radix-2 stages, or with FFT_RADIX4 a radix-2 stage
+ * when DataSizeExponent is odd (mixed radix) followed by radix-4 stages.
+ * With FFT_SIMD, stages on interleaved data whose groups, across the
+ * NumVectors vectors, fill whole vectors use the SIMD butterflies. With
+ * Round all stages round as in fxpRadix2Stage, the first Halved of them
+ * halving their output, and the SIMD butterflies are not used.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpStages (
+    e_s16       *RealData,          /* real part, bit reversed, in place */
+    e_s16       *ImagData,          /* imaginary part, bit reversed, in place */
+    n_int       Stride,             /* distance between points */
+    n_int       NumVectors,         /* vectors interleaved point by point */
+    n_int       DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    const e_s16 *CosV,              /* cosine of each twiddle */
+    const e_s16 *SinV,              /* sine of each twiddle */
+    n_int       TwStride,           /* distance between twiddles */
+    n_int       PerStage,           /* TRUE for per-stage twiddle tables */
+    n_int       Inverse,            /* TRUE for the IFFT */
+    n_int       Round,              /* TRUE for the scaled transforms */
+    n_int       Halved              /* with Round, leading stages halved */
+)
+{
+    FFTStageTwiddles    Tw[2];
+    n_int               k = 1;
+#if FFT_VEC_POINTS
+    n_int               Vec = ( StageVec != NULL && Stride == 2 && ImagData == RealData + 1 );
+#endif
+
+#if FFT_RADIX4
+    if (DataSizeExponent & 1) {
+        fxpStageTwiddles(&Tw[0], DataSizeExponent, 1, CosV, SinV, TwStride, PerStage);
+        fxpRadix2Stage(RealData, ImagData, Stride, NumVectors, DataSizeExponent, 1,
+                       &Tw[0], Inverse, Round, Halved >= 1);
+        k = 2;
+    }
+    for (; k < DataSizeExponent; k += 2) {
+        fxpStageTwiddles(&Tw[0], DataSizeExponent, k, CosV, SinV, TwStride, PerStage);
+        fxpStageTwiddles(&Tw[1], DataSizeExponent, k + 1, CosV, SinV, TwStride, PerStage);
+#if FFT_VEC_POINTS
+        if (Vec && (NumVectors << (k - 1)) % FFT_VEC_POINTS == 0 &&
+            !(Inverse && IFFT_SCALE_FACTOR) && !Round) {
+            (*StageVec)(RealData, NumVectors, DataSizeExponent, k, Tw, Inverse);
+            continue;
+        }
+#endif
+        fxpRadix4Stage(RealData, ImagData, Stride, NumVectors, DataSizeExponent, k,
+                       Tw, Inverse, Round, (Halved >= k) + (Halved >= k + 1));
+    }
+#else
+    for (; k <= DataSizeExponent; k++) {
+        fxpStageTwiddles(&Tw[0], DataSizeExponent, k, CosV, SinV, TwStride, PerStage);
+#if FFT_VEC_POINTS
+        if (Vec && (NumVectors << (k - 1)) % FFT_VEC_POINTS == 0 && !Round) {
+            (*StageVec)(RealData, NumVectors, DataSizeExponent, k, &Tw[0], Inverse);
+            continue;
+        }
+#endif
+        fxpRadix2Stage(RealData, ImagData, Stride, NumVectors, DataSizeExponent, k,
+                       &Tw[0], Inverse, Round, Halved >= k);
+    }
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpBitReverseSwap
+ *
+ * DESC    : 
+ * Bit reversal of 2**DataSizeExponent points in place, by swapping each
+ * pair once. Points are strided as in fxpRadix2Stage.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpBitReverseSwap (
+    e_s16       *RealData,          /* real part, in place */
+    e_s16       *ImagData,          /* imaginary part, in place */
+    n_int       Stride,             /* distance between points */
+    n_int       DataSize,           /* number of points */
+    const e_s16 *BitRevInd          /* bit reversal indicies */
+)
+{
+    e_s16   t;
+    n_int   i, r;
+
+    for (i = 0; i < DataSize; i++) {
+        r = BitRevInd[i];
+        if (i < r) {
+            t = RealData[Stride*i];
+            RealData[Stride*i] = RealData[Stride*r];
+            RealData[Stride*r] = t;
+            t = ImagData[Stride*i];
+            ImagData[Stride*i] = ImagData[Stride*r];
+            ImagData[Stride*r] = t;
+        }
+    }
+}
+
+/* The TH_PROF_BEGIN/TH_PROF_END stages of the transforms, see TH_PROFILE */
+enum { PROF_BitReverse, PROF_Stages, PROF_CopyOut };
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpRunStages
+ *
+ * DESC    : fxpStages with the twiddles of the SineV and CosineV tables
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpRunStages (
+    e_s16   *RealData,          /* real part, bit reversed, in place */
+    e_s16   *ImagData,          /* imaginary part, bit reversed, in place */
+    n_int   Stride,             /* distance between points */
+    n_int   DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    e_s16   *SineV,             /* Sine table */
+    e_s16   *CosineV,           /* Cosine table */
+    n_int   Inverse             /* TRUE for the IFFT */
+)
+{
+#ifdef C_INTERLEAVED
+    fxpStages(RealData, ImagData, Stride, 1, DataSizeExponent,
+              CosineV, CosineV + 1, 2, FALSE, Inverse, FALSE, 0);
+    SineV = SineV;
+#else
+    fxpStages(RealData, ImagData, Stride, 1, DataSizeExponent,
+              CosineV, SineV, 1, FALSE, Inverse, FALSE, 0);
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpInPlace
+ *
+ * DESC    : 
+ * The in place path of fxpfft and fxpifft: the bit reversal swaps points
+ * within the caller's buffer and the stages run on it, so the data is not
+ * copied to the stack arrays and back.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpInPlace (
+    e_s16   *RealData,          /* real part, in place */
+    e_s16   *ImagData,          /* imaginary part, in place */
+    n_int   Stride,             /* distance between points */
+    n_int   DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    e_s16   *SineV,             /* Sine table */
+    e_s16   *CosineV,           /* Cosine table */
+    e_s16   *BitRevInd,         /* bit reversal indicies */
+    n_int   Inverse             /* TRUE for the IFFT */
+)
+{
+    TH_PROF_BEGIN(PROF_BitReverse);
+    fxpBitReverseSwap(RealData, ImagData, Stride, 1 << DataSizeExponent, BitRevInd);
+    TH_PROF_END(PROF_BitReverse);
+    TH_PROF_BEGIN(PROF_Stages);
+    fxpRunStages(RealData, ImagData, Stride, DataSizeExponent, SineV, CosineV, Inverse);
+    TH_PROF_END(PROF_Stages);
+}
+
+#if FFT_STOCKHAM
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpStockhamStage
+ *
+ * DESC    : 
+ * Radix-2 stage k of a Stockham (self-sorting) 2**DataSizeExponent point
+ * transform, from Src to Dst. Before the stage, with L = 2**(k-1) and
+ * r = DataSize/2L, point j*2r + m holds bin j of the L point transform of
+ * the samples m, m+2r, m+4r ..., and after it point j*r + m holds bin j of
+ * the 2L point transform of the samples m, m+r, m+2r .... That combines
+ * the same even and odd halves with the same twiddles and butterflies as
+ * fxpRadix2Stage on bit reversed data, so the output is identical. Both
+ * loops step through consecutive points.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpStockhamStage (
+    const e_s16 *SrcReal,           /* real part of the stage input */
+    const e_s16 *SrcImag,           /* imaginary part of the stage input */
+    n_int       SrcStride,          /* distance between input points */
+    e_s16       *DstReal,           /* real part of the stage output */
+    e_s16       *DstImag,           /* imaginary part of the stage output */
+    n_int       DstStride,          /* distance between output points */
+    n_int       DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    n_int       k,                  /* stage, 1 .. DataSizeExponent */
+    const e_s16 *CosV,              /* cosine of each twiddle */
+    const e_s16 *SinV,              /* sine of each twiddle */
+    n_int       TwStride,           /* distance between twiddles */
+    n_int       Inverse             /* TRUE for the IFFT */
+)
+{
+    e_s32   WReal, WImag, tRealData, tImagData;
+    e_s16   aReal, aImag;
+    n_int   L, r, j, m, a, b, x, y;
+
+    L = 1 << (k - 1);
+    r = (1 << DataSizeExponent) >> k;   /* also the twiddle index step */
+
+    for (j = 0; j < L; j++) {
+
+        /* Lookup twiddle factors */
+        WReal = CosV[TwStride*j*r];
+        WImag = SinV[TwStride*j*r];
+        if (Inverse)
+            WImag = -WImag;
+
+        a = SrcStride*(2*j*r);
+        b = a + SrcStride*r;
+        x = DstStride*(j*r);
+        y = DstStride*((j + L)*r);
+        for (m = 0; m < r; m++) {
+            tRealData = ( WReal * SrcReal[b] ) + ( WImag * SrcImag[b] );
+            tImagData = ( WReal * SrcImag[b] ) - ( WImag * SrcReal[b] );
+
+            /* Scale twiddle products to accomodate 16 bit storage */
+            tRealData = tRealData >> BUTTERFLY_SCALE_FACTOR;
+            tImagData = tImagData >> BUTTERFLY_SCALE_FACTOR;
+            aReal = SrcReal[a];
+            aImag = SrcImag[a];
+            DstReal[y] = aReal - tRealData;
+            DstImag[y] = aImag - tImagData;
+            DstReal[x] = aReal + tRealData;
+            DstImag[x] = aImag + tImagData;
+
+#if IFFT_SCALE_FACTOR
+            if (Inverse) {
+                /* 1/N IFFT scaling implemented each stage */
+                DstReal[y] >>= IFFT_SCALE_FACTOR;
+                DstImag[y] >>= IFFT_SCALE_FACTOR;
+                DstReal[x] >>= IFFT_SCALE_FACTOR;
+                DstImag[x] >>= IFFT_SCALE_FACTOR;
+            }
+#endif
+            a += SrcStride;
+            b += SrcStride;
+            x += DstStride;
+            y += DstStride;
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpStockham
+ *
+ * DESC    : 
+ * The transform of fxpfft and fxpifft without a bit reversal pass: the
+ * Stockham stages ping-pong between the output and the work arrays,
+ * arranged so that the last one writes the output. When the transform is
+ * in place and the number of stages is odd, the first stage cannot write
+ * the output it reads, so the stages end in the work arrays and are
+ * copied out.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+fxpStockham (
+    e_s16   *InReal,            /* real part of input data */
+    e_s16   *InImag,            /* imaginary part of input data */
+    e_s16   *OutReal,           /* real part of output data */
+    e_s16   *OutImag,           /* imaginary part of output data */
+    n_int   Stride,             /* distance between input and output points */
+    n_int   DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    e_s16   *SineV,             /* Sine table */
+    e_s16   *CosineV,           /* Cosine table */
+    e_s16   *WorkReal,          /* work arrays of 2**DataSizeExponent */
+    e_s16   *WorkImag,
+    n_int   Inverse             /* TRUE for the IFFT */
+)
+{
+    const e_s16 *SrcReal = InReal, *SrcImag = InImag;
+    e_s16       *DstReal, *DstImag;
+    n_int       SrcStride = Stride, DstStride;
+    n_int       k, ToOut, Copy;
+
+    /* Stage k writes the output when ToOut is set, otherwise the work arrays */
+    Copy = ( InReal == OutReal && (DataSizeExponent & 1) );
+    ToOut = ( (DataSizeExponent & 1) != 0 ) != Copy;
+
+    for (k = 1; k <= DataSizeExponent; k++) {
+        if (ToOut) {
+            DstReal = OutReal;
+            DstImag = OutImag;
+            DstStride = Stride;
+        } else {
+            DstReal = WorkReal;
+            DstImag = WorkImag;
+            DstStride = 1;
+        }
+#ifdef C_INTERLEAVED
+        fxpStockhamStage(SrcReal, SrcImag, SrcStride, DstReal, DstImag, DstStride,
+                         DataSizeExponent, k, CosineV, CosineV + 1, 2, Inverse);
+#else
+        fxpStockhamStage(SrcReal, SrcImag, SrcStride, DstReal, DstImag, DstStride,
+                         DataSizeExponent, k, CosineV, SineV, 1, Inverse);
+#endif
+        SrcReal = DstReal;
+        SrcImag = DstImag;
+        SrcStride = DstStride;
+        ToOut = !ToOut;
+    }
+
+    if (Copy) {
+        for (k = 0; k < (1 << DataSizeExponent); k++) {
+            OutReal[Stride*k] = WorkReal[k];
+            OutImag[Stride*k] = WorkImag[k];
+        }
+    }
+#ifdef C_INTERLEAVED
+    SineV = SineV;
+#endif
+}
+#endif /* FFT_STOCKHAM */
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpfft
+ *
+ * DESC    : 
+ * Compute the Fixed Point FFT on the 2**DataSizeExponent
+ * complex input values stored in arrays InRealData and InImagData.
+ * Return results in OutRealData and OutImagData
+ * Requires precomputation of the sine & cosine twiddle factors.
+ * Requires precomputation of the bit reversal indicies.
+ * Runs in place, without the stack arrays, when the output arrays are
+ * the input arrays.
+ *         
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+
+void
+fxpfft (
+    e_s16   *InRealData,        /* real part of input data */
+    e_s16   *InImagData,        /* imaginary part of input data */
+    e_s16   *OutRealData,       /* real part of output data */
+    e_s16   *OutImagData,       /* imaginary part of output data */
+    e_s16   DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    e_s16   *SineV,             /* Sine table */
+    e_s16   *CosineV,           /* Cosine table */
+    e_s16   *BitRevInd          /* bit reversal indicies */
+)
+{
+    e_s16   DataSize;
+    e_s16   i;
+    e_s16   RealBitRevData[MAX_FFT_SIZE];
+    e_s16   ImagBitRevData[MAX_FFT_SIZE];
+
+
+/*( Make this a macro  -- Dave levine to supply code ) 8*/
+
+    /* Bit Reversal */
+    DataSize = 1 << DataSizeExponent;
+    assert( (DataSize >= 4) && ((DataSize % 2) == 0) );
+
+#if FFT_STOCKHAM
+    /* Self-sorting stages, no bit reversal */
+    TH_PROF_BEGIN(PROF_Stages);
+#ifdef D_INTERLEAVED
+    fxpStockham(InRealData, InRealData + 1, OutRealData, OutRealData + 1, 2,
+                DataSizeExponent, SineV, CosineV, RealBitRevData, ImagBitRevData, FALSE);
+#else
+    fxpStockham(InRealData, InImagData, OutRealData, OutImagData, 1,
+                DataSizeExponent, SineV, CosineV, RealBitRevData, ImagBitRevData, FALSE);
+#endif
+    TH_PROF_END(PROF_Stages);
+    return;
+#endif
+
+    /* In place */
+#ifdef D_INTERLEAVED
+    if (InRealData == OutRealData) {
+        fxpInPlace(OutRealData, OutRealData + 1, 2, DataSizeExponent, SineV, CosineV, BitRevInd, FALSE);
+        return;
+    }
+#else
+    if (InRealData == OutRealData && InImagData == OutImagData) {
+        fxpInPlace(OutRealData, OutImagData, 1, DataSizeExponent, SineV, CosineV, BitRevInd, FALSE);
+        return;
+    }
+#endif
+
+#if FFT_VEC_POINTS && defined(D_INTERLEAVED)
+    /* Gather straight into the output, where the SIMD stages can run */
+    TH_PROF_BEGIN(PROF_BitReverse);
+    for (i = 0; i < DataSize; i++) {
+        OutRealData[2*i] = InRealData[2*BitRevInd[i]];
+        OutRealData[2*i+1] = InRealData[(2*BitRevInd[i])+1];
+    }
+    TH_PROF_END(PROF_BitReverse);
+    TH_PROF_BEGIN(PROF_Stages);
+    fxpRunStages(OutRealData, OutRealData + 1, 2, DataSizeExponent, SineV, CosineV, FALSE);
+    TH_PROF_END(PROF_Stages);
+    return;
+#endif
+
+    TH_PROF_BEGIN(PROF_BitReverse);
+#ifdef D_INTERLEAVED
+    for (i = 0; i < DataSize; i++) {
+        RealBitRevData[i] = InRealData[2*BitRevInd[i]];
+        ImagBitRevData[i] = InRealData[(2*BitRevInd[i])+1];
+    }
+#else
+    for (i = 0; i < DataSize; i++) {
+        RealBitRevData[i] = InRealData[BitRevInd[i]];
+        ImagBitRevData[i] = InImagData[BitRevInd[i]];
+    }
+#endif
+    TH_PROF_END(PROF_BitReverse);
+
+    /* FFT Computation */
+    TH_PROF_BEGIN(PROF_Stages);
+#ifdef C_INTERLEAVED
+    fxpStages(RealBitRevData, ImagBitRevData, 1, 1, DataSizeExponent,
+              CosineV, CosineV + 1, 2, FALSE, FALSE, FALSE, 0);
+#else
+    fxpStages(RealBitRevData, ImagBitRevData, 1, 1, DataSizeExponent,
+              CosineV, SineV, 1, FALSE, FALSE, FALSE, 0);
+#endif
+    TH_PROF_END(PROF_Stages);
+
+    /* Return bit reversed data to output arrays */
+    TH_PROF_BEGIN(PROF_CopyOut);
+#ifdef D_INTERLEAVED
+    for(i = 0; i < DataSize; i++) {
+        OutRealData[2*i] = RealBitRevData[i];
+        OutRealData[2*i+1] = ImagBitRevData[i];
+    }
+#else
+    for(i = 0; i < DataSize; i++) {
+        OutRealData[i] = RealBitRevData[i];
+        OutImagData[i] = ImagBitRevData[i];
+    }
+#endif
+    TH_PROF_END(PROF_CopyOut);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : ipow
+ *
+ * DESC    : Integer version of pow
+ * RETURNS : y to the x power
+ * ---------------------------------------------------------------------------*/
+n_int	ipow(n_int x, n_int y)
+{
+	n_int	i,tmp=1;
+
+	for (i=0;i<y;i++) tmp*=x;
+	return tmp;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : fxpifft
+ *
+ * DESC    : 
+ * Compute the Radix 2  Decimation-in-Time IFFT on the 2**DataSizeExponent
+ * complex input values stored in arrays RealData and ImagData.
+ * Return results in OutRealData and OutImagData
+ * Requires precomputation of the sine & cosine twiddle factors.
+ * Requires precomputation of the bit reversal indicies.
+ *
+ * If IFFT_SCALE_FACTOR = 1 then generate code for 1/N ifft scaling.
+ * Runs in place, like fxpfft, when the output arrays are the input arrays.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void
+fxpifft (
+    e_s16   *InRealData,        /* real part of input data */
+    e_s16   *InImagData,        /* imaginary part of input data */
+    e_s16   *OutRealData,       /* real part of output data */
+    e_s16   *OutImagData,       /* imaginary part of output data */
+    e_s16   DataSizeExponent,   /* size of data = 2**DataSizeExponent */
+    e_s16   *SineV,             /* Sine table */
+    e_s16   *CosineV,           /* Cosine table */
+    e_s16   *BitRevInd          /* bit reversal indicies */
+)
+{
+    e_s16   DataSize;
+    e_s16   i;
+    e_s16   RealBitRevData[MAX_FFT_SIZE];
+    e_s16   ImagBitRevData[MAX_FFT_SIZE];
+
+    /* Bit Reversal */
+    DataSize = 1<<DataSizeExponent;
+
+#if FFT_STOCKHAM
+    /* Self-sorting stages, no bit reversal */
+    TH_PROF_BEGIN(PROF_Stages);
+#ifdef D_INTERLEAVED
+    fxpStockham(InRealData, InRealData + 1, OutRealData, OutRealData + 1, 2,
+                DataSizeExponent, SineV, CosineV, RealBitRevData, ImagBitRevData, TRUE);
+#else
+    fxpStockham(InRealData, InImagData, OutRealData, OutImagData, 1,
+                DataSizeExponent, SineV, CosineV, RealBitRevData, ImagBitRevData, TRUE);
+#endif
+    TH_PROF_END(PROF_Stages);
+    return;
+#endif
+
+    /* In place */
+#ifdef D_INTERLEAVED
+    if (InRealData == OutRealData) {
+        fxpInPlace(OutRealData, OutRealData + 1, 2, DataSizeExponent, SineV, CosineV, BitRevInd, TRUE);
+        return;
+    }
+#else
+    if (InRealData == OutRealData && InImagData == OutImagData) {
+        fxpInPlace(OutRealData, OutImagData, 1, DataSizeExponent, SineV, CosineV, BitRevInd, TRUE);
+        return;
+    }
+#endif
+
+#if FFT_VEC_POINTS && defined(D_INTERLEAVED)
+    /* Gather straight into the output, where the SIMD stages can run */
+    TH_PROF_BEGIN(PROF_BitReverse);
+    for (i = 0; i < DataSize; i++) {
+        OutRealData[2*i] = InRealData[2*BitRevInd[i]];
+        OutRealData[2*i+1] = InRealData[(2*BitRevInd[i])+1];
+    }
+    TH_PROF_END(PROF_BitReverse);
+    TH_PROF_BEGIN(PROF_Stages);
+    fxpRunStages(OutRealData, OutRealData + 1, 2, DataSizeExponent, SineV, CosineV, TRUE);
+    TH_PROF_END(PROF_Stages);
+    return;
+#endif
+
+
+    TH_PROF_BEGIN(PROF_BitReverse);
+#ifdef D_INTERLEAVED
+    for (i = 0; i < DataSize; i++) {
+        RealBitRevData[i] = InRealData[2*BitRevInd[i]];
+        ImagBitRevData[i] = InRealData[(2*BitRevInd[i])+1];
+    }
+#else
+    for(i = 0; i < DataSize; i++) {
+        RealBitRevData[i] = InRealData[BitRevInd[i]];
+        ImagBitRevData[i] = InImagData[BitRevInd[i]];
+    }
+#endif
+    TH_PROF_END(PROF_BitReverse);
+
+    /* IFFT Computation */
+    TH_PROF_BEGIN(PROF_Stages);
+#ifdef C_INTERLEAVED
+    fxpStages(RealBitRevData, ImagBitRevData, 1, 1, DataSizeExponent,
+              CosineV, CosineV + 1, 2, FALSE, TRUE, FALSE, 0);
+#else
+    fxpStages(RealBitRevData, ImagBitRevData, 1, 1, DataSizeExponent,
+              CosineV, SineV, 1, FALSE, TRUE, FALSE, 0);
+#endif
+    TH_PROF_END(PROF_Stages);
+
+    /* Return bit reversed data to output arrays */
+    TH_PROF_BEGIN(PROF_CopyOut);
+#ifdef D_INTERLEAVED
+    for(i = 0; i < DataSize; i++) {
+        OutRealData[2*i] = RealBitRevData[i];
+        OutRealData[2*i+1] = ImagBitRevData[i];
+    }
+#else
+    for(i = 0; i < DataSize; i++) {
+        OutRealData[i] = RealBitRevData[i];
+        OutImagData[i] = ImagBitRevData[i];
+    }
+#endif
+    TH_PROF_END(PROF_CopyOut);
+}
+/*******************************************************************************
+    FFT plans
+*******************************************************************************/
+
+struct FFTPlan {
+    n_int   DataSizeExponent;
+    n_int   DataSize;
+    e_s16   *Twiddle;       /* DataSize-1 (cos, sin) pairs, stage by stage */
+    e_s16   *BitRevInd;     /* bit reversal indicies */
+};
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTPlanBuild
+ *
+ * DESC    : 
+ * FFTPlanInit, or with Exact a plan whose twiddle table entry m is the
+ * cosine and sine of 2m*pi/DataSize, rounded and kept within 16 bits, for
+ * the sub-transforms of the four-step plans. The half step of the fxpfft
+ * table is a rotation of every butterfly that the four-step inter-step
+ * twiddles do not undo, so the sub-transforms need the exact angles.
+ *
+ * RETURNS : The plan, or NULL on bad size or out of memory
+ * ---------------------------------------------------------------------------*/
+static FFTPlan *FFTPlanBuild(n_int DataSizeExponent, n_int Exact)
+{
+#if FLOAT_SUPPORT
+    FFTPlan *plan;
+    e_f64   Angle, c, s;
+    n_int   i, j, k, b, r;
+
+    if (DataSizeExponent < FFT_PLAN_MIN_EXPONENT || DataSizeExponent > FFT_PLAN_MAX_EXPONENT)
+        return NULL;
+
+    plan = (FFTPlan *)th_malloc(sizeof(FFTPlan));
+    if (plan == NULL)
+        return NULL;
+
+    plan->DataSizeExponent = DataSizeExponent;
+    plan->DataSize         = 1 << DataSizeExponent;
+    plan->Twiddle   = (e_s16 *)th_malloc(2 * (plan->DataSize - 1) * sizeof(e_s16));
+    plan->BitRevInd = (e_s16 *)th_malloc(plan->DataSize * sizeof(e_s16));
+    if (plan->Twiddle == NULL || plan->BitRevInd == NULL) {
+        FFTPlanFree(plan);
+        return NULL;
+    }
+
+    i = 0;
+    for (k = 1; k <= DataSizeExponent; k++) {
+        for (j = 0; j < (1 << (k - 1)); j++, i++) {
+            if (Exact) {
+                Angle = 2 * j * (plan->DataSize >> k) * FFT_PI / plan->DataSize;
+                c = floor(TRIG_SCALE_FACTOR * cos(Angle) + 0.5);
+                s = floor(TRIG_SCALE_FACTOR * sin(Angle) + 0.5);
+                plan->Twiddle[2*i]   = (e_s16)(c < TRIG_SCALE_FACTOR ? c : TRIG_SCALE_FACTOR - 1);
+                plan->Twiddle[2*i+1] = (e_s16)(s < TRIG_SCALE_FACTOR ? s : TRIG_SCALE_FACTOR - 1);
+            } else {
+                Angle = (2 * j * (plan->DataSize >> k) + 1) * FFT_PI / plan->DataSize;
+                plan->Twiddle[2*i]   = (e_s16)(TRIG_SCALE_FACTOR * cos(Angle));
+                plan->Twiddle[2*i+1] = (e_s16)(TRIG_SCALE_FACTOR * sin(Angle));
+            }
+        }
+    }
+
+    for (i = 0; i < plan->DataSize; i++) {
+        r = 0;
+        for (b = 0; b < DataSizeExponent; b++)
+            r = (r << 1) | ((i >> b) & 1);
+        plan->BitRevInd[i] = (e_s16)r;
+    }
+
+    return plan;
+#else
+    DataSizeExponent = DataSizeExponent;
+    Exact = Exact;
+    return NULL;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTPlanInit
+ *
+ * DESC    : 
+ * Create a plan for 2**DataSizeExponent point transforms, for
+ * DataSizeExponent in FFT_PLAN_MIN_EXPONENT .. FFT_PLAN_MAX_EXPONENT.
+ * Builds the twiddle tables and the bit reversal indicies once. Twiddle
+ * table entry m is TRIG_SCALE_FACTOR times the cosine and sine of
+ * (2m+1)*pi/DataSize, truncated, which makes the 256 point table the same
+ * as cstable256i.dat. The plan keeps, for each stage k, the 2**(k-1)
+ * entries it uses, 0, DataSize >> k, 2*(DataSize >> k) ..., in the order
+ * the butterflies use them, so that each stage reads its twiddles in
+ * sequence (see fxpStageTwiddles). Needs FLOAT_SUPPORT for the tables.
+ *
+ * RETURNS : The plan, or NULL on bad size or out of memory
+ * ---------------------------------------------------------------------------*/
+FFTPlan *FFTPlanInit(n_int DataSizeExponent)
+{
+    return FFTPlanBuild(DataSizeExponent, FALSE);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTPlanFree
+ *
+ * DESC    : Release a plan from FFTPlanInit. NULL is ignored.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTPlanFree(FFTPlan *plan)
+{
+    if (plan == NULL)
+        return;
+    if (plan->Twiddle != NULL)
+        th_free(plan->Twiddle);
+    if (plan->BitRevInd != NULL)
+        th_free(plan->BitRevInd);
+    th_free(plan);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTPlanGather
+ *
+ * DESC    : 
+ * Bit reversal of the interleaved input into the output, or within the
+ * buffer when they are the same.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void FFTPlanGather(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData)
+{
+    n_int   i;
+
+    if (InData == OutData) {
+        fxpBitReverseSwap(OutData, OutData + 1, 2, plan->DataSize, plan->BitRevInd);
+        return;
+    }
+
+    for (i = 0; i < plan->DataSize; i++) {
+        OutData[2*i]   = InData[2*plan->BitRevInd[i]];
+        OutData[2*i+1] = InData[2*plan->BitRevInd[i]+1];
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTPlanForward, FFTPlanInverse
+ *
+ * DESC    : 
+ * The FFT and IFFT of the plan's size on interleaved (real, imaginary)
+ * data, computed as fxpfft and fxpifft do with the fft00 tables. InData
+ * and OutData are either the same buffer, for a transform in place, or do
+ * not overlap. The plan is not modified, so one plan can be used from
+ * several threads.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTPlanForward(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData)
+{
+    FFTPlanGather(plan, InData, OutData);
+    fxpStages(OutData, OutData + 1, 2, 1, plan->DataSizeExponent,
+              plan->Twiddle, plan->Twiddle + 1, 2, TRUE, FALSE, FALSE, 0);
+}
+
+void FFTPlanInverse(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData)
+{
+    FFTPlanGather(plan, InData, OutData);
+    fxpStages(OutData, OutData + 1, 2, 1, plan->DataSizeExponent,
+              plan->Twiddle, plan->Twiddle + 1, 2, TRUE, TRUE, FALSE, 0);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTPlanForwardScaled, FFTPlanInverseScaled
+ *
+ * DESC    : 
+ * FFTPlanForward and FFTPlanInverse for data that is not prescaled: the
+ * first Halved radix-2 stages halve their output, so the output is the
+ * transform times 2**-Halved, and every twiddle product and halving is
+ * rounded to nearest, so that the error has no bias. The output stays
+ * within both the largest input magnitude times 2**(DataSizeExponent -
+ * Halved) and the sum of the input magnitudes times 2**-Halved. These
+ * run the scalar stages only.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTPlanForwardScaled(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData,
+                          n_int Halved)
+{
+    FFTPlanGather(plan, InData, OutData);
+    fxpStages(OutData, OutData + 1, 2, 1, plan->DataSizeExponent,
+              plan->Twiddle, plan->Twiddle + 1, 2, TRUE, FALSE, TRUE, Halved);
+}
+
+void FFTPlanInverseScaled(const FFTPlan *plan, const e_s16 *InData, e_s16 *OutData,
+                          n_int Halved)
+{
+    FFTPlanGather(plan, InData, OutData);
+    fxpStages(OutData, OutData + 1, 2, 1, plan->DataSizeExponent,
+              plan->Twiddle, plan->Twiddle + 1, 2, TRUE, TRUE, TRUE, Halved);
+}
+
+/*******************************************************************************
+    Batched transforms
+*******************************************************************************/
+
+struct FFTBatch {
+    const FFTPlan   *Plan;
+    n_int           BlockVectors;   /* vectors transformed together */
+    e_s16           *Work;          /* BlockVectors interleaved point by point */
+};
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTBatchInit
+ *
+ * DESC    : 
+ * Create the work space for batched transforms of the plan's size. A batch
+ * is transformed in blocks of as many vectors as fit FFT_BATCH_BLOCK_BYTES,
+ * at least one, and a whole number of SIMD vectors wide when that many
+ * fit. The plan must outlive the batch.
+ *
+ * RETURNS : The batch, or NULL on out of memory
+ * ---------------------------------------------------------------------------*/
+FFTBatch *FFTBatchInit(const FFTPlan *plan)
+{
+    FFTBatch    *batch;
+    n_int       VectorBytes;
+
+    if (plan == NULL)
+        return NULL;
+
+    batch = (FFTBatch *)th_malloc(sizeof(FFTBatch));
+    if (batch == NULL)
+        return NULL;
+
+    VectorBytes = 2 * sizeof(e_s16) * plan->DataSize;
+    batch->Plan = plan;
+    batch->BlockVectors = FFT_BATCH_BLOCK_BYTES / VectorBytes;
+    if (batch->BlockVectors < 1)
+        batch->BlockVectors = 1;
+#if FFT_VEC_POINTS
+    if (batch->BlockVectors >= FFT_VEC_POINTS)
+        batch->BlockVectors -= batch->BlockVectors % FFT_VEC_POINTS;
+#endif
+
+    batch->Work = (e_s16 *)th_malloc(batch->BlockVectors * VectorBytes);
+    if (batch->Work == NULL) {
+        FFTBatchFree(batch);
+        return NULL;
+    }
+
+    return batch;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTBatchFree
+ *
+ * DESC    : Release a batch from FFTBatchInit. NULL is ignored.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTBatchFree(FFTBatch *batch)
+{
+    if (batch == NULL)
+        return;
+    if (batch->Work != NULL)
+        th_free(batch->Work);
+    th_free(batch);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTBatchTransform
+ *
+ * DESC    : 
+ * Transform the vectors block by block: bit reverse each vector of the
+ * block into the work space, interleaved point by point with the others,
+ * run the stages on the whole block, so that each twiddle is looked up
+ * once per block and stage, and copy the vectors back out.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+static void
+FFTBatchTransform(FFTBatch *batch, e_s16 **InData, e_s16 **OutData,
+                  n_int NumVectors, n_int Inverse)
+{
+    const FFTPlan   *plan = batch->Plan;
+    e_s16           *Work = batch->Work;
+    const e_s16     *In;
+    e_s16           *Out;
+    n_int           First, Block, i, v;
+
+    for (First = 0; First < NumVectors; First += Block) {
+        Block = NumVectors - First;
+        if (Block > batch->BlockVectors)
+            Block = batch->BlockVectors;
+
+        for (v = 0; v < Block; v++) {
+            In = InData[First + v];
+            for (i = 0; i < plan->DataSize; i++) {
+                Work[2*(Block*i + v)]   = In[2*plan->BitRevInd[i]];
+                Work[2*(Block*i + v)+1] = In[2*plan->BitRevInd[i]+1];
+            }
+        }
+
+        fxpStages(Work, Work + 1, 2, Block, plan->DataSizeExponent,
+                  plan->Twiddle, plan->Twiddle + 1, 2, TRUE, Inverse, FALSE, 0);
+
+        for (v = 0; v < Block; v++) {
+            Out = OutData[First + v];
+            for (i = 0; i < plan->DataSize; i++) {
+                Out[2*i]   = Work[2*(Block*i + v)];
+                Out[2*i+1] = Work[2*(Block*i + v)+1];
+            }
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTBatchForward, FFTBatchInverse
+ *
+ * DESC    : 
+ * FFTPlanForward and FFTPlanInverse of NumVectors interleaved vectors,
+ * InData[v] to OutData[v], with the same output. Each OutData[v] is the
+ * same buffer as InData[v] or overlaps no input.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTBatchForward(FFTBatch *batch, e_s16 **InData, e_s16 **OutData, n_int NumVectors)
+{
+    FFTBatchTransform(batch, InData, OutData, NumVectors, FALSE);
+}
+
+void FFTBatchInverse(FFTBatch *batch, e_s16 **InData, e_s16 **OutData, n_int NumVectors)
+{
+    FFTBatchTransform(batch, InData, OutData, NumVectors, TRUE);
+}
+
+/*******************************************************************************
+    Real transforms
+*******************************************************************************/
+
+struct FFTRealPlan {
+    FFTPlan *Half;          /* DataSize/2 point complex plan */
+    n_int   DataSize;
+    e_s16   *Split;         /* DataSize/4+1 (cos, sin) pairs */
+};
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTRealPlanInit
+ *
+ * DESC    : 
+ * Create a plan for 2**DataSizeExponent point real transforms, for
+ * DataSizeExponent in FFT_PLAN_MIN_EXPONENT+1 .. FFT_PLAN_MAX_EXPONENT+1:
+ * a complex plan of half the size, and the split twiddles, TRIG_SCALE_FACTOR
+ * times the cosine and sine of 2*pi*k/DataSize for k = 0 .. DataSize/4,
+ * rounded and kept within 16 bits.
+ *
+ * RETURNS : The plan, or NULL on bad size, out of memory or no FLOAT_SUPPORT
+ * ---------------------------------------------------------------------------*/
+FFTRealPlan *FFTRealPlanInit(n_int DataSizeExponent)
+{
+#if FLOAT_SUPPORT
+    FFTRealPlan *plan;
+    e_f64       Angle, c, s;
+    n_int       k;
+
+    if (DataSizeExponent <= FFT_PLAN_MIN_EXPONENT || DataSizeExponent > FFT_PLAN_MAX_EXPONENT + 1)
+        return NULL;
+
+    plan = (FFTRealPlan *)th_malloc(sizeof(FFTRealPlan));
+    if (plan == NULL)
+        return NULL;
+
+    plan->DataSize = 1 << DataSizeExponent;
+    plan->Half  = FFTPlanInit(DataSizeExponent - 1);
+    plan->Split = (e_s16 *)th_malloc((plan->DataSize / 2 + 2) * sizeof(e_s16));
+    if (plan->Half == NULL || plan->Split == NULL) {
+        FFTRealPlanFree(plan);
+        return NULL;
+    }
+
+    for (k = 0; k <= plan->DataSize / 4; k++) {
+        Angle = 2 * FFT_PI * k / plan->DataSize;
+        c = floor(TRIG_SCALE_FACTOR * cos(Angle) + 0.5);
+        s = floor(TRIG_SCALE_FACTOR * sin(Angle) + 0.5);
+        plan->Split[2*k]   = (e_s16)(c < TRIG_SCALE_FACTOR ? c : TRIG_SCALE_FACTOR - 1);
+        plan->Split[2*k+1] = (e_s16)(s < TRIG_SCALE_FACTOR ? s : TRIG_SCALE_FACTOR - 1);
+    }
+
+    return plan;
+#else
+    DataSizeExponent = DataSizeExponent;
+    return NULL;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTRealPlanFree
+ *
+ * DESC    : Release a plan from FFTRealPlanInit. NULL is ignored.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTRealPlanFree(FFTRealPlan *plan)
+{
+    if (plan == NULL)
+        return;
+    FFTPlanFree(plan->Half);
+    if (plan->Split != NULL)
+        th_free(plan->Split);
+    th_free(plan);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTRealForward
+ *
+ * DESC    : 
+ * The FFT of DataSize real samples, prescaled like the fxpfft input. The
+ * samples, taken as DataSize/2 complex points z[m] = x[2m] + j x[2m+1],
+ * go through the half size complex FFT, and the split pass separates
+ * the transforms E of the even and O of the odd samples,
+ *     E[k] = (Z[k] + conj Z[N/2-k]) / 2
+ *     O[k] = (Z[k] - conj Z[N/2-k]) / 2j
+ * and forms X[k] = E[k] + W**k O[k] and X[N/2-k] = conj(E[k] - W**k O[k])
+ * for each pair of bins. The output is the packed spectrum: the real DC
+ * and Nyquist bins in OutData[0] and OutData[1], then bins 1 .. N/2-1
+ * interleaved. The other bins are the conjugates of these. InData and
+ * OutData are the same buffer or do not overlap.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTRealForward(const FFTRealPlan *plan, const e_s16 *InData, e_s16 *OutData)
+{
+    const e_s16 *W = plan->Split;
+    e_s32       Er, Ei, Or, Oi, tr, ti, z0r, z0i;
+    n_int       k, m;
+
+    FFTPlanForward(plan->Half, InData, OutData);
+
+    z0r = OutData[0];
+    z0i = OutData[1];
+    OutData[0] = (e_s16)(z0r + z0i);
+    OutData[1] = (e_s16)(z0r - z0i);
+
+    for (k = 1; k <= plan->DataSize / 4; k++) {
+        m = plan->DataSize / 2 - k;
+
+        Er = ( (e_s32)OutData[2*k]   + OutData[2*m]   ) >> 1;
+        Ei = ( (e_s32)OutData[2*k+1] - OutData[2*m+1] ) >> 1;
+        Or = ( (e_s32)OutData[2*k+1] + OutData[2*m+1] ) >> 1;
+        Oi = ( (e_s32)OutData[2*m]   - OutData[2*k]   ) >> 1;
+
+        tr = ( ( W[2*k] * Or ) + ( W[2*k+1] * Oi ) ) >> BUTTERFLY_SCALE_FACTOR;
+        ti = ( ( W[2*k] * Oi ) - ( W[2*k+1] * Or ) ) >> BUTTERFLY_SCALE_FACTOR;
+
+        OutData[2*k]   = (e_s16)(Er + tr);
+        OutData[2*k+1] = (e_s16)(Ei + ti);
+        OutData[2*m]   = (e_s16)(Er - tr);
+        OutData[2*m+1] = (e_s16)(ti - Ei);
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTRealInverse
+ *
+ * DESC    : 
+ * The IFFT of a Hermitian symmetric spectrum, in the packed layout of
+ * FFTRealForward, to DataSize real samples, as fxpifft computes it. The
+ * split pass forms, for each pair of bins,
+ *     Z[k] = (X[k] + conj X[N/2-k]) + j W**-k (X[k] - conj X[N/2-k])
+ * and the half size complex IFFT of Z gives z[m] = x[2m] + j x[2m+1]. With
+ * IFFT_SCALE_FACTOR the split pass also scales by 1/2, for the stage the
+ * half size IFFT does not have. InData and OutData are the same buffer or
+ * do not overlap.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTRealInverse(const FFTRealPlan *plan, const e_s16 *InData, e_s16 *OutData)
+{
+    const e_s16 *W = plan->Split;
+    e_s32       Ar, Ai, Dr, Di, Br, Bi, x0, xn;
+    n_int       k, m;
+
+    x0 = InData[0];
+    xn = InData[1];
+    OutData[0] = (e_s16)( ( x0 + xn ) >> IFFT_SCALE_FACTOR );
+    OutData[1] = (e_s16)( ( x0 - xn ) >> IFFT_SCALE_FACTOR );
+
+    for (k = 1; k <= plan->DataSize / 4; k++) {
+        m = plan->DataSize / 2 - k;
+
+        Ar = (e_s32)InData[2*k]   + InData[2*m];
+        Ai = (e_s32)InData[2*k+1] - InData[2*m+1];
+        Dr = (e_s32)InData[2*k]   - InData[2*m];
+        Di = (e_s32)InData[2*k+1] + InData[2*m+1];
+
+        /* Each product fits 32 bits, though their sum might not */
+        Br = ( ( W[2*k] * Dr ) >> BUTTERFLY_SCALE_FACTOR ) - ( ( W[2*k+1] * Di ) >> BUTTERFLY_SCALE_FACTOR );
+        Bi = ( ( W[2*k] * Di ) >> BUTTERFLY_SCALE_FACTOR ) + ( ( W[2*k+1] * Dr ) >> BUTTERFLY_SCALE_FACTOR );
+
+        OutData[2*k]   = (e_s16)( ( Ar - Bi ) >> IFFT_SCALE_FACTOR );
+        OutData[2*k+1] = (e_s16)( ( Ai + Br ) >> IFFT_SCALE_FACTOR );
+        OutData[2*m]   = (e_s16)( ( Ar + Bi ) >> IFFT_SCALE_FACTOR );
+        OutData[2*m+1] = (e_s16)( ( Br - Ai ) >> IFFT_SCALE_FACTOR );
+    }
+
+    FFTPlanInverse(plan->Half, OutData, OutData);
+}
+
+/*******************************************************************************
+    Four-step transforms
+*******************************************************************************/
+
+/*
+ * A DataSize = N1*N2 point transform, input point N2*n1 + n2 and output
+ * bin k1 + N1*k2, is done in four steps: the N2 column FFTs of N1 points
+ * (over n1), a multiply of column n2 bin k1 by W**(n2*k1), and the N1 row
+ * FFTs of N2 points (over n2). The work array holds the twiddled column
+ * results row by row, N1 rows of N2 points. Each step transforms a block
+ * of columns or rows at a time, interleaved point by point in a scratch
+ * array small enough for the cache, so that every load and store of the
+ * input, work and output arrays moves runs of BlockVectors points.
+ */
+struct FFTLargePlan {
+    n_int   DataSizeExponent;
+    n_int   N1;             /* column FFT size */
+    n_int   N2;             /* row FFT size */
+    n_int   BlockVectors;   /* columns or rows transformed together */
+    FFTPlan *Col;
+    FFTPlan *Row;
+    e_s16   *Twiddle;       /* (cos, sin) of 2*pi*n2*k1/DataSize at k1*N2 + n2 */
+};
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTLargePlanInit
+ *
+ * DESC    : 
+ * Create a four-step plan for 2**DataSizeExponent point transforms, for
+ * DataSizeExponent in FFT_LARGE_MIN_EXPONENT .. FFT_LARGE_MAX_EXPONENT,
+ * with column and row plans of 2**(DataSizeExponent/2) and the remaining
+ * points, built by FFTPlanBuild with the exact angles. The twiddles are
+ * rounded and kept within 16 bits. Needs FLOAT_SUPPORT for the tables.
+ *
+ * RETURNS : The plan, or NULL on bad size or out of memory
+ * ---------------------------------------------------------------------------*/
+FFTLargePlan *FFTLargePlanInit(n_int DataSizeExponent)
+{
+#if FLOAT_SUPPORT
+    FFTLargePlan    *plan;
+    e_f64           Angle, c, s;
+    n_int           k1, n2, Largest;
+
+    if (DataSizeExponent < FFT_LARGE_MIN_EXPONENT || DataSizeExponent > FFT_LARGE_MAX_EXPONENT)
+        return NULL;
+
+    plan = (FFTLargePlan *)th_malloc(sizeof(FFTLargePlan));
+    if (plan == NULL)
+        return NULL;
+
+    plan->DataSizeExponent = DataSizeExponent;
+    plan->N1 = 1 << (DataSizeExponent / 2);
+    plan->N2 = 1 << (DataSizeExponent - DataSizeExponent / 2);
+    plan->Col = FFTPlanBuild(DataSizeExponent / 2, TRUE);
+    plan->Row = FFTPlanBuild(DataSizeExponent - DataSizeExponent / 2, TRUE);
+    plan->Twiddle = (e_s16 *)th_malloc(2 * sizeof(e_s16) << DataSizeExponent);
+    if (plan->Col == NULL || plan->Row == NULL || plan->Twiddle == NULL) {
+        FFTLargePlanFree(plan);
+        return NULL;
+    }
+
+    Largest = plan->N1 > plan->N2 ? plan->N1 : plan->N2;
+    plan->BlockVectors = FFT_BATCH_BLOCK_BYTES / (2 * sizeof(e_s16) * Largest);
+    if (plan->BlockVectors < 1)
+        plan->BlockVectors = 1;
+    if (plan->BlockVectors > plan->N1)
+        plan->BlockVectors = plan->N1;
+#if FFT_VEC_POINTS
+    if (plan->BlockVectors >= FFT_VEC_POINTS)
+        plan->BlockVectors -= plan->BlockVectors % FFT_VEC_POINTS;
+#endif
+
+    for (k1 = 0; k1 < plan->N1; k1++) {
+        for (n2 = 0; n2 < plan->N2; n2++) {
+            Angle = 2 * FFT_PI * ((k1 * n2) & ((1L << DataSizeExponent) - 1)) / (1L << DataSizeExponent);
+            c = floor(TRIG_SCALE_FACTOR * cos(Angle) + 0.5);
+            s = floor(TRIG_SCALE_FACTOR * sin(Angle) + 0.5);
+            plan->Twiddle[2*(k1*plan->N2 + n2)]   = (e_s16)(c < TRIG_SCALE_FACTOR ? c : TRIG_SCALE_FACTOR - 1);
+            plan->Twiddle[2*(k1*plan->N2 + n2)+1] = (e_s16)(s < TRIG_SCALE_FACTOR ? s : TRIG_SCALE_FACTOR - 1);
+        }
+    }
+
+    return plan;
+#else
+    DataSizeExponent = DataSizeExponent;
+    return NULL;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTLargePlanFree
+ *
+ * DESC    : Release a plan from FFTLargePlanInit. NULL is ignored.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTLargePlanFree(FFTLargePlan *plan)
+{
+    if (plan == NULL)
+        return;
+    FFTPlanFree(plan->Col);
+    FFTPlanFree(plan->Row);
+    if (plan->Twiddle != NULL)
+        th_free(plan->Twiddle);
+    th_free(plan);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTLargeScratchSize
+ *
+ * DESC    : The scratch array each caller of FFTLargeColumns/Rows needs
+ *
+ * RETURNS : Its size in e_s16
+ * ---------------------------------------------------------------------------*/
+n_int FFTLargeScratchSize(const FFTLargePlan *plan)
+{
+    n_int   Largest = plan->N1 > plan->N2 ? plan->N1 : plan->N2;
+
+    return 2 * plan->BlockVectors * Largest;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTLargePart
+ *
+ * DESC    : 
+ * Part Part of NumParts of Count columns or rows, in whole blocks of
+ * BlockVectors but the last.
+ *
+ * RETURNS : The first of the part in First, and the end of it
+ * ---------------------------------------------------------------------------*/
+static n_int FFTLargePart(const FFTLargePlan *plan, n_int Count, n_int Part,
+                          n_int NumParts, n_int *First)
+{
+    n_int   Blocks = (Count + plan->BlockVectors - 1) / plan->BlockVectors;
+    n_int   End;
+
+    *First = (Blocks * Part / NumParts) * plan->BlockVectors;
+    End    = (Blocks * (Part + 1) / NumParts) * plan->BlockVectors;
+    return End < Count ? End : Count;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTLargeColumns
+ *
+ * DESC    : 
+ * Steps 1 and 2, for part Part of NumParts of the columns: the column FFTs
+ * (IFFTs if Inverse) of InData, each stage halved and rounded, twiddled
+ * (conjugate twiddles if Inverse) and rounded into WorkData, DataSize
+ * interleaved points. The parts write disjoint
+ * parts of WorkData and only read the plan and InData, so they can run
+ * on separate threads, each with its own Scratch of FFTLargeScratchSize.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTLargeColumns(const FFTLargePlan *plan, const e_s16 *InData, e_s16 *WorkData,
+                     n_int Part, n_int NumParts, e_s16 *Scratch, n_int Inverse)
+{
+    const FFTPlan   *Col = plan->Col;
+    const e_s16     *W;
+    e_s32           WReal, WImag, xr, xi;
+    n_int           N1 = plan->N1, N2 = plan->N2;
+    n_int           n2, End, B, i, r, v;
+
+    End = FFTLargePart(plan, N2, Part, NumParts, &n2);
+    for (; n2 < End; n2 += B) {
+        B = End - n2 < plan->BlockVectors ? End - n2 : plan->BlockVectors;
+
+        /* Columns n2 .. n2+B-1, bit reversed and interleaved */
+        for (i = 0; i < N1; i++) {
+            r = N2 * Col->BitRevInd[i] + n2;
+            for (v = 0; v < B; v++) {
+                Scratch[2*(B*i + v)]   = InData[2*(r + v)];
+                Scratch[2*(B*i + v)+1] = InData[2*(r + v)+1];
+            }
+        }
+
+        fxpStages(Scratch, Scratch + 1, 2, B, Col->DataSizeExponent,
+                  Col->Twiddle, Col->Twiddle + 1, 2, TRUE, Inverse, TRUE,
+                  Col->DataSizeExponent);
+
+        /* Twiddle bin k1 = i of each column into row i of the work array */
+        for (i = 0; i < N1; i++) {
+            W = plan->Twiddle + 2*(i*N2 + n2);
+            for (v = 0; v < B; v++) {
+                WReal = W[2*v];
+                WImag = Inverse ? -W[2*v+1] : W[2*v+1];
+                xr = Scratch[2*(B*i + v)];
+                xi = Scratch[2*(B*i + v)+1];
+                WorkData[2*(i*N2 + n2 + v)]   = (e_s16)fxpRound( ( WReal * xr ) + ( WImag * xi ), BUTTERFLY_SCALE_FACTOR );
+                WorkData[2*(i*N2 + n2 + v)+1] = (e_s16)fxpRound( ( WReal * xi ) - ( WImag * xr ), BUTTERFLY_SCALE_FACTOR );
+            }
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTLargeRows
+ *
+ * DESC    : 
+ * Step 3, for part Part of NumParts of the rows: the row FFTs (IFFTs if
+ * Inverse) of WorkData, each stage halved and rounded, after
+ * FFTLargeColumns has finished all its parts, into OutData, DataSize
+ * interleaved points in natural order. The parts can run on separate
+ * threads as for FFTLargeColumns.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTLargeRows(const FFTLargePlan *plan, const e_s16 *WorkData, e_s16 *OutData,
+                  n_int Part, n_int NumParts, e_s16 *Scratch, n_int Inverse)
+{
+    const FFTPlan   *Row = plan->Row;
+    n_int           N1 = plan->N1, N2 = plan->N2;
+    n_int           k1, End, B, i, v;
+
+    End = FFTLargePart(plan, N1, Part, NumParts, &k1);
+    for (; k1 < End; k1 += B) {
+        B = End - k1 < plan->BlockVectors ? End - k1 : plan->BlockVectors;
+
+        /* Rows k1 .. k1+B-1, bit reversed and interleaved */
+        for (v = 0; v < B; v++) {
+            for (i = 0; i < N2; i++) {
+                Scratch[2*(B*i + v)]   = WorkData[2*((k1 + v)*N2 + Row->BitRevInd[i])];
+                Scratch[2*(B*i + v)+1] = WorkData[2*((k1 + v)*N2 + Row->BitRevInd[i])+1];
+            }
+        }
+
+        fxpStages(Scratch, Scratch + 1, 2, B, Row->DataSizeExponent,
+                  Row->Twiddle, Row->Twiddle + 1, 2, TRUE, Inverse, TRUE,
+                  Row->DataSizeExponent);
+
+        /* Bin k2 = i of row k1 is output bin k1 + N1*k2 */
+        for (i = 0; i < N2; i++) {
+            for (v = 0; v < B; v++) {
+                OutData[2*(k1 + v + N1*i)]   = Scratch[2*(B*i + v)];
+                OutData[2*(k1 + v + N1*i)+1] = Scratch[2*(B*i + v)+1];
+            }
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTLargeForward, FFTLargeInverse
+ *
+ * DESC    : 
+ * The whole FFT and IFFT on one thread, the transform times
+ * 2**-DataSizeExponent of data that is not prescaled. WorkData holds
+ * DataSize interleaved points and Scratch FFTLargeScratchSize e_s16.
+ * InData and OutData may be the same buffer.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTLargeForward(const FFTLargePlan *plan, const e_s16 *InData, e_s16 *OutData,
+                     e_s16 *WorkData, e_s16 *Scratch)
+{
+    FFTLargeColumns(plan, InData, WorkData, 0, 1, Scratch, FALSE);
+    FFTLargeRows(plan, WorkData, OutData, 0, 1, Scratch, FALSE);
+}
+
+void FFTLargeInverse(const FFTLargePlan *plan, const e_s16 *InData, e_s16 *OutData,
+                     e_s16 *WorkData, e_s16 *Scratch)
+{
+    FFTLargeColumns(plan, InData, WorkData, 0, 1, Scratch, TRUE);
+    FFTLargeRows(plan, WorkData, OutData, 0, 1, Scratch, TRUE);
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC    : FFTReference
+ *
+ * DESC    : 
+ * The exact transform that fxpfft and fxpifft approximate, in double:
+ * bin k of the 2**DataSizeExponent interleaved points of InData is
+ * the sum over n of InData[n] * exp(-/+ 2 pi i k n / DataSize), - for the
+ * forward and + for the Inverse transform, without scaling. Gives the
+ * interleaved bins in RefData. It is computed as a radix-2 FFT with every
+ * twiddle taken from cos and sin of its own angle, so that the error stays
+ * many orders below the fixed point one, and the four-step sizes can be
+ * checked as well. Needs FLOAT_SUPPORT, and does nothing without.
+ *
+ * RETURNS : 
+ * ---------------------------------------------------------------------------*/
+void FFTReference(const e_s16 *InData, e_f64 *RefData, n_int DataSizeExponent, n_int Inverse)
+{
+#if FLOAT_SUPPORT
+    e_f64   Angle, c, s, Real, Imag;
+    n_int   i, j, k, b, r, Half, DataSize;
+
+    DataSize = 1 << DataSizeExponent;
+    for (i = 0; i < DataSize; i++) {
+        r = 0;
+        for (b = 0; b < DataSizeExponent; b++)
+            r = (r << 1) | ((i >> b) & 1);
+        RefData[2*i]   = InData[2*r];
+        RefData[2*i+1] = InData[2*r+1];
+    }
+
+    for (Half = 1; Half < DataSize; Half <<= 1) {
+        for (j = 0; j < Half; j++) {
+            Angle = FFT_PI * j / Half;
+            c = cos(Angle);
+            s = Inverse ? sin(Angle) : -sin(Angle);
+            for (i = j; i < DataSize; i += 2 * Half) {
+                k = i + Half;
+                Real = RefData[2*k] * c - RefData[2*k+1] * s;
+                Imag = RefData[2*k] * s + RefData[2*k+1] * c;
+                RefData[2*k]   = RefData[2*i] - Real;
+                RefData[2*k+1] = RefData[2*i+1] - Imag;
+                RefData[2*i]   += Real;
+                RefData[2*i+1] += Imag;
+            }
+        }
+    }
+#else
+    InData = InData;
+    RefData = RefData;
+    DataSizeExponent = DataSizeExponent;
+    Inverse = Inverse;
+#endif
+}
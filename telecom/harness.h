@@ -21,4 +21,16 @@
 #define VERIFY_FLOAT (1)
 #endif
 
+/* The suite score of the telemark image: the geometric mean of the
+ * benchmarks' iterations/sec over 785.138, the lowest score in this category
+ * on December 5, 2000 */
+
+#if	!defined(TH_SUITE_SCORE)
+#define TH_SUITE_SCORE "Telemark"
+#endif
+
+#if	!defined(TH_SUITE_NORM)
+#define TH_SUITE_NORM (785.138)
+#endif
+
 #endif /* File Sentinal */
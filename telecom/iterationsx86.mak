@@ -24,3 +24,4 @@ viterb00data_1	= DEFAULT
 viterb00data_2	= DEFAULT 
 viterb00data_3	= DEFAULT 
 viterb00data_4	= DEFAULT 
+modem00			= DEFAULT 
@@ -0,0 +1,134 @@
+/**
+ *
+ * Copyright (C) EEMBC(R) All Rights Reserved
+ *
+ * This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+ * Please refer to the license file (LICENSE.md) included with this code.
+ *
+ */
+
+#ifndef ALGO_H
+#define ALGO_H
+
+/*******************************************************************************
+    Includes
+*******************************************************************************/
+#include "thlib.h"
+
+/*******************************************************************************
+    Defines
+*******************************************************************************/
+
+/*
+ * The DMT frame: MODEM_PACKETS IS-136 packets of MODEM_PACKET_BITS bits,
+ * the last 5 of each the flush bits, rate 1/2 coded and loaded onto the
+ * MODEM_CARRIERS bins of one fxpifft by fxpBitAllocation. MODEM_PACKET_BITS
+ * is viterb00's MAX_DATA_SIZE and MODEM_CARRIERS fft00's MAX_FFT_SIZE.
+ * The typical line of fbital00 carries 2 packets without errors; from 3
+ * the larger constellations no longer decode clean at MODEM_NOISE.
+ */
+#define MODEM_PACKET_BITS       344
+#define MODEM_PACKET_WORDS      (MODEM_PACKET_BITS/16+1)
+#define MODEM_PAYLOAD_BITS      (MODEM_PACKET_BITS-5)
+#define MODEM_FFT_EXPONENT      8
+#define MODEM_CARRIERS          (1 << MODEM_FFT_EXPONENT)
+
+#if !defined(MODEM_PACKETS)
+#define MODEM_PACKETS           2
+#endif
+
+#define MODEM_CODED_BITS        (2*MODEM_PACKETS*MODEM_PACKET_BITS)
+
+/* fbital00's allocation map and largest constellation */
+#define ALLOCATION_MAP_SIZE     512
+#define MAX_BITS_PER_CARRIER    12
+
+/*
+ * MODEM_STAGES: the stages of the pipeline, in order. Each works in place
+ * on the buffers of one ring slot and hands the slot on to the next.
+ */
+#define MODEM_BITALLOC          0
+#define MODEM_ENCODE            1
+#define MODEM_MAP               2
+#define MODEM_IFFT              3
+#define MODEM_CHANNEL           4
+#define MODEM_FFT               5
+#define MODEM_DEMAP             6
+#define MODEM_DECODE            7
+#define MODEM_STAGES            8
+
+/*
+ * MODEM_RING: the frame slots of the ring, preallocated before the timed
+ * loop. MODEM_PROFILES: the payloads and carrier SNR profiles the frames
+ * cycle through, also generated before the timed loop.
+ */
+#if !defined(MODEM_RING)
+#define MODEM_RING              16
+#endif
+
+#if !defined(MODEM_PROFILES)
+#define MODEM_PROFILES          16
+#endif
+
+/*
+ * MODEM_RIPPLE: the largest change of each frame's carrier SNRs from the
+ * data set, in 1/512 dB. MODEM_NOISE: the uniform noise of +/- MODEM_NOISE
+ * the channel adds to the scaled down line samples.
+ */
+#if !defined(MODEM_RIPPLE)
+#define MODEM_RIPPLE            256
+#endif
+
+#if !defined(MODEM_NOISE)
+#define MODEM_NOISE             1
+#endif
+
+/*
+ * MODEM_THREADS: When TRUE, the timed loop runs each of the MODEM_STAGES
+ * stages on its own thread of a th_pool_open() pool, left to the scheduler
+ * to spread over the cores, with up to MODEM_RING frames in flight, handed
+ * on under POSIX locks. The benchmark then also prints the wall-clock
+ * frames per second and the latency percentiles of a frame through the
+ * pipeline, over the last MODEM_LATENCY_FRAMES frames. The harness timer
+ * still measures process CPU time. Needs TH_THREADS, and do not combine
+ * with TH_PROFILE.
+ */
+#if !defined(MODEM_THREADS)
+#define MODEM_THREADS (FALSE)
+#endif
+#if MODEM_THREADS && !TH_THREADS
+#error "MODEM_THREADS needs the worker threads of TH_THREADS"
+#endif
+
+#if !defined(MODEM_LATENCY_FRAMES)
+#define MODEM_LATENCY_FRAMES    4096
+#endif
+
+#if MODEM_RING < 1 || MODEM_PROFILES < 1
+#error "MODEM_RING and MODEM_PROFILES must be at least 1"
+#endif
+
+/*******************************************************************************
+    Function Prototypes
+*******************************************************************************/
+
+/* The kernels, from fbital00.c, conven00.c, fft00.c and viterb00.c, which
+ * are linked into the modem00 target. fbital00.c is built with
+ * FBITAL_BISECTION (see depgen_modem00_gcc.cml): the stepped water level
+ * can stall a bit short of the budget on a rippled profile. */
+void fxpBitAllocation( e_s16 *CarrierSNRdB, e_s16 *CarrierBitAllocation,
+                       e_u16 NumberOfCarriers, e_s16 WaterLeveldB_in,
+                       e_s16 *WaterLeveldB_out, e_s16 *AllocationMap,
+                       e_u16 BitsPerDMTSymbol, size_t loop_cnt );
+void fxpBitAllocSelectKernel( void );
+void convolutionalEncode( e_u8 *DataBits, e_s16 DataByteSize, e_s16 NumberCodeVectors,
+                          e_s16 ConstraintLength, e_u8 (*CodeMatrix)[2], e_u8 *BranchWords );
+void fxpfft( e_s16 *InRealData, e_s16 *InImagData, e_s16 *OutRealData, e_s16 *OutImagData,
+             e_s16 DataSizeExponent, e_s16 *SineV, e_s16 *CosineV, e_s16 *BitRevInd );
+void fxpifft( e_s16 *InRealData, e_s16 *InImagData, e_s16 *OutRealData, e_s16 *OutImagData,
+              e_s16 DataSizeExponent, e_s16 *SineV, e_s16 *CosineV, e_s16 *BitRevInd );
+void fxpFFTSelectKernel( void );
+void ViterbiDecoderIS136( e_s16 *EncodedStreamPtr, e_s16 *DecodedStreamPtr );
+void ViterbiSelectKernel( void );
+
+#endif /* ALGO_H */
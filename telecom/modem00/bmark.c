@@ -0,0 +1,652 @@
+/**
+ *
+ * Copyright (C) EEMBC(R) All Rights Reserved
+ *
+ * This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+ * Please refer to the license file (LICENSE.md) included with this code.
+ *
+ */
+
+/*==============================================================================
+ * The DMT modem pipeline
+ *
+ * Chains the telecom kernels into the transmit and receive path of a DMT
+ * modem, one frame per iteration: fxpBitAllocation loads the carriers for
+ * the frame's SNRs, convolutionalEncode codes its IS-136 packets, the code
+ * bits are mapped onto Gray coded QAM constellations, fxpifft makes the
+ * line samples, the channel scales them down and adds noise, fxpfft and a
+ * slicer bring back the code bits and ViterbiDecoderIS136 decodes the
+ * packets. Every stage reads and writes the buffers of the frame's ring
+ * slot in place, so the frame is never copied from stage to stage.
+ *============================================================================*/
+
+/* The ring slot locks need the POSIX declarations under -ansi */
+#if defined(MODEM_THREADS) && MODEM_THREADS
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "algo.h"
+
+#if MODEM_THREADS
+#include <pthread.h>
+#include <stdlib.h> /* qsort */
+#endif
+
+/*------------------------------------------------------------------------------
+ * Test Component Definition Structure
+ */
+
+int    t_run_test( size_t iterations, int argc, const char* argv[] );
+int    test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+
+/* Define iterations */
+#if !defined(ITERATIONS) || CRC_CHECK || ITERATIONS==DEFAULT
+#undef ITERATIONS
+#if CRC_CHECK
+#define ITERATIONS 2000	/* required iterations for crc */
+#else
+#define ITERATIONS 2000	/* recommended iterations for benchmark */
+#endif
+#endif
+
+#if CRC_CHECK
+#define EXPECTED_CRC	0x0000
+#elif NON_INTRUSIVE_CRC_CHECK
+#if MODEM_PACKETS == 1
+#define EXPECTED_CRC	0x892e
+#elif MODEM_PACKETS == 2
+#define EXPECTED_CRC	0xa03c
+#else
+#define EXPECTED_CRC	0x0000	/* not known */
+#endif
+#else
+#define EXPECTED_CRC	0x0000
+#endif
+
+static TCDef the_tcdef =
+   {
+   "TEL modem00     ",
+   EEMBC_MEMBER_COMPANY,
+   EEMBC_PROCESSOR,
+   EEMBC_TARGET,
+   "DMT Modem Pipeline Bench Mark V1.0E0",
+   TCDEF_REVISION,
+   NULL, /* pointer to the next TCDef */
+   /* TH Version Number Required */
+   { EEMBC_TH_MAJOR, EEMBC_TH_MINOR, EEMBC_TH_STEP, EEMBC_TH_REVISION },
+   /* Target Hardware Version Number Required (make all zeros to ignore)*/
+   { 0, 0, 0, 0 },
+   /* The Version number of this Benchmark */
+   { 1, 0, 'E', 1 },
+   ITERATIONS,
+   &t_run_test,
+   &test_main,
+   NULL,        /* there is no main function in this implementation */
+   NULL         /* there is no entry function in this implementation */
+   };
+
+/*------------------------------------------------------------------------------
+ * Local Data
+*/
+
+/* >> IMPORTANT NOTE <<
+ *
+ * Since benchmarks can be entered (run) multiple times, the benchmark
+ * MUST NOT depend on global data being initialized.  E.g. it must
+ * complelty initialize itself EVERY TIME its t_run_test() function
+ * is called.
+ *
+*/
+
+/* The carrier SNRs of fbital00's typical line, in 1/512 dB */
+static e_s16 snr_buf[] = {
+#include "xtypsnri.dat"
+};
+
+static e_s16 alloc_map_buf[] = {
+#include "allocmapi.dat"
+};
+
+/* fft00's interleaved twiddle and bit reversal tables */
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 sin_buf[] = {0};
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 cosin_buf[] = {
+#include "cstable256i.dat"
+};
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 index_buf[] = {
+#include "brind256i.dat"
+};
+
+/* The IS-136 generators 0x2B and 0x3D in conven00's column-wise code
+ * matrix form, the code ViterbiDecoderIS136 decodes */
+static e_u8 is136_code_matrix[6][2] = {
+    { 1, 1 }, { 1, 0 }, { 0, 1 }, { 1, 1 }, { 0, 1 }, { 1, 1 }
+};
+
+/*
+ * The largest constellation point on either axis. fxpifft does not scale
+ * its output, so a bin of MODEM_AMPLITUDE on every carrier just fits. The
+ * channel scales the samples down by 2**(MODEM_FFT_EXPONENT/2) and fxpfft
+ * brings the bins back MODEM_CARRIERS times larger, which puts the
+ * received grid at 2**(MODEM_RX_SHIFT-1) for MODEM_AMPLITUDE.
+ */
+#define MODEM_AMPLITUDE     ( 32768 >> MODEM_FFT_EXPONENT )
+#define MODEM_LINE_SHIFT    ( MODEM_FFT_EXPONENT / 2 )
+#define MODEM_RX_SHIFT      ( 16 - MODEM_FFT_EXPONENT / 2 )
+
+/*
+ * ModemSlot: one frame in the ring. The frame's SNRs and packets stay in
+ * the profile pools; the buffers are the output of each stage, in order,
+ * and the input of the next.
+ */
+typedef struct {
+    e_s16       tx[2*MODEM_CARRIERS];       /* MAP: interleaved bins */
+    e_s16       line[2*MODEM_CARRIERS];     /* IFFT, CHANNEL: samples */
+    e_s16       rx[2*MODEM_CARRIERS];       /* FFT: received bins */
+    e_s16       alloc[MODEM_CARRIERS];      /* BITALLOC: bits per carrier */
+    e_s16       branch[MODEM_PACKETS*MODEM_PACKET_BITS];   /* DEMAP */
+    e_s16       decoded[MODEM_PACKETS*MODEM_PACKET_WORDS]; /* DECODE */
+    e_u8        code[MODEM_CODED_BITS];     /* ENCODE: 1 bit per byte */
+    e_s16       *snr;
+    e_u8        *payload;
+    size_t      frame;
+#if MODEM_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t  ready;
+    n_int       stage;                      /* the stage it waits for */
+    double      start;                      /* th_wall_seconds() at BITALLOC */
+#endif
+} ModemSlot;
+
+/* The pipeline: the ring, the pools and the decoder's error counts */
+typedef struct {
+    ModemSlot   *ring[MODEM_RING];
+    e_s16       *snr;                       /* MODEM_PROFILES profiles */
+    e_u8        *payload;                   /* MODEM_PROFILES frames */
+    e_s16       WaterLeveldB;
+    e_s16       *AllocationMap;
+    e_s16       *SineV, *CosineV, *BitRevInd;
+    long        raw_errors;                 /* code bits sliced wrong */
+    long        bit_errors;                 /* payload bits decoded wrong */
+    long        packet_errors;
+#if MODEM_THREADS
+    double      *latency;                   /* MODEM_LATENCY_FRAMES */
+    size_t      frames;
+#endif
+} Modem;
+
+/*
+* FUNC   : modem_random
+*
+* DESC   : Linear congruential generator, 15 random bits per call.
+*/
+static n_int modem_random( e_u32 *seed )
+{
+    *seed = ( *seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+    return (n_int)( ( *seed >> 16 ) & 0x7fff );
+}
+
+/*
+* FUNC   : modem_point
+*
+* DESC   : One axis of a constellation point from the next Bits code bits,
+*          the first the most significant, Gray coded onto 2**Bits levels
+*          spaced 2 * MODEM_AMPLITUDE / 2**Bits apart about 0. Bits that
+*          the frame does not have are 0.
+*/
+static e_s16 modem_point( const e_u8 *code, n_int *next, n_int Bits )
+{
+    n_int   v, m, t, i;
+
+    if ( Bits == 0 )
+        return 0;
+    v = 0;
+    for ( i = 0; i < Bits; i++ )
+    {
+        v = ( v << 1 ) | ( *next < MODEM_CODED_BITS ? code[*next] : 0 );
+        (*next)++;
+    }
+    m = v;
+    for ( t = v >> 1; t != 0; t >>= 1 )
+        m ^= t;
+    return (e_s16)( ( 2 * m + 1 - ( 1 << Bits ) ) * ( MODEM_AMPLITUDE >> Bits ) );
+}
+
+/*
+* FUNC   : modem_slice
+*
+* DESC   : Slices one axis of a received bin back to its Bits code bits,
+*          and packs them as hard 3-bit soft values into the branch words
+*          ViterbiDecoderIS136 takes: y0 in bits 3-5 and y1 in bits 0-2 of
+*          each, 7 a 0 and 0 a 1.
+*/
+static void modem_slice( e_s16 *branch, n_int *next, n_int Bits, e_s16 y )
+{
+    n_int   m, v, t, i, bit, q;
+
+    if ( Bits == 0 )
+        return;
+    t = y + ( 1 << ( MODEM_RX_SHIFT - 1 ) );
+    m = t < 0 ? 0 : t >> ( MODEM_RX_SHIFT - Bits );
+    if ( m > ( 1 << Bits ) - 1 )
+        m = ( 1 << Bits ) - 1;
+    v = m ^ ( m >> 1 );
+    for ( i = Bits - 1; i >= 0 && *next < MODEM_CODED_BITS; i-- )
+    {
+        bit = ( v >> i ) & 1;
+        q   = bit ? 0 : 7;
+        if ( ( *next & 1 ) == 0 )
+            branch[*next >> 1] = (e_s16)( q << 3 );
+        else
+            branch[*next >> 1] |= (e_s16)q;
+        (*next)++;
+    }
+}
+
+/*
+* FUNC   : modem_stage
+*
+* DESC   : Runs one stage of the pipeline on the frame in slot s.
+*/
+static void modem_stage( Modem *m, ModemSlot *s, n_int stage )
+{
+    e_s16   WaterLeveldB_out;
+    e_u32   seed;
+    n_int   i, k, p, next, bit, errors;
+
+    switch ( stage )
+    {
+    case MODEM_BITALLOC:
+        s->snr     = m->snr + ( s->frame % MODEM_PROFILES ) * MODEM_CARRIERS;
+        s->payload = m->payload + ( s->frame % MODEM_PROFILES ) * MODEM_PACKETS * MODEM_PACKET_BITS;
+        fxpBitAllocation( s->snr, s->alloc, MODEM_CARRIERS, m->WaterLeveldB,
+                          &WaterLeveldB_out, m->AllocationMap, MODEM_CODED_BITS, s->frame );
+        break;
+
+    case MODEM_ENCODE:
+        for ( p = 0; p < MODEM_PACKETS; p++ )
+            convolutionalEncode( s->payload + p * MODEM_PACKET_BITS, MODEM_PACKET_BITS, 2, 6,
+                                 is136_code_matrix, s->code + 2 * p * MODEM_PACKET_BITS );
+        break;
+
+    case MODEM_MAP:
+        /* The larger half of each carrier's bits on the real axis */
+        next = 0;
+        for ( k = 0; k < MODEM_CARRIERS; k++ )
+        {
+            s->tx[2*k]   = modem_point( s->code, &next, ( s->alloc[k] + 1 ) >> 1 );
+            s->tx[2*k+1] = modem_point( s->code, &next, s->alloc[k] >> 1 );
+        }
+        break;
+
+    case MODEM_IFFT:
+        fxpifft( s->tx, NULL, s->line, NULL, MODEM_FFT_EXPONENT,
+                 m->SineV, m->CosineV, m->BitRevInd );
+        break;
+
+    case MODEM_CHANNEL:
+        /* Scale down for the FFT with rounding and add noise */
+        seed = (e_u32)( s->frame + 1 ) * 69069UL;
+        for ( i = 0; i < 2 * MODEM_CARRIERS; i++ )
+            s->line[i] = (e_s16)( ( ( s->line[i] + ( 1 << ( MODEM_LINE_SHIFT - 1 ) ) ) >> MODEM_LINE_SHIFT ) +
+                         modem_random( &seed ) % ( 2 * MODEM_NOISE + 1 ) - MODEM_NOISE );
+        break;
+
+    case MODEM_FFT:
+        fxpfft( s->line, NULL, s->rx, NULL, MODEM_FFT_EXPONENT,
+                m->SineV, m->CosineV, m->BitRevInd );
+        break;
+
+    case MODEM_DEMAP:
+        next = 0;
+        for ( k = 0; k < MODEM_CARRIERS; k++ )
+        {
+            modem_slice( s->branch, &next, ( s->alloc[k] + 1 ) >> 1, s->rx[2*k] );
+            modem_slice( s->branch, &next, s->alloc[k] >> 1, s->rx[2*k+1] );
+        }
+        /* Code bits the allocation left out, weak zeros */
+        for ( ; next < MODEM_CODED_BITS; next++ )
+        {
+            if ( ( next & 1 ) == 0 )
+                s->branch[next >> 1] = 4 << 3;
+            else
+                s->branch[next >> 1] |= 4;
+        }
+        break;
+
+    case MODEM_DECODE:
+        for ( p = 0; p < MODEM_PACKETS; p++ )
+            ViterbiDecoderIS136( s->branch + p * MODEM_PACKET_BITS,
+                                 s->decoded + p * MODEM_PACKET_WORDS );
+
+        /* Count the errors the slicer made and the decoder left */
+        for ( i = 0; i < MODEM_CODED_BITS; i++ )
+        {
+            bit = ( s->branch[i >> 1] >> ( i & 1 ? 0 : 3 ) & 7 ) < 4;
+            m->raw_errors += bit != s->code[i];
+        }
+        for ( p = 0; p < MODEM_PACKETS; p++ )
+        {
+            errors = 0;
+            for ( i = 0; i < MODEM_PAYLOAD_BITS; i++ )
+            {
+                bit = ( s->decoded[p * MODEM_PACKET_WORDS + ( i >> 4 )] >> ( 15 - ( i & 15 ) ) ) & 1;
+                errors += bit != s->payload[p * MODEM_PACKET_BITS + i];
+            }
+            m->bit_errors    += errors;
+            m->packet_errors += errors != 0;
+        }
+        break;
+    }
+}
+
+#if MODEM_THREADS
+static int compare_seconds( const void *a, const void *b )
+{
+    double  x = *(const double *)a;
+    double  y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*
+* FUNC   : modem_run_stage
+*
+* DESC   : Runs one stage on every frame in turn, each as soon as the stage
+*          before has handed its slot on, and hands the slot on to the next
+*          stage, the last back to BITALLOC.
+*/
+static void modem_run_stage( Modem *m, n_int stage )
+{
+    ModemSlot   *s;
+    size_t      f;
+
+    for ( f = 0; f < m->frames; f++ )
+    {
+        s = m->ring[f % MODEM_RING];
+        pthread_mutex_lock( &s->lock );
+        while ( s->stage != stage )
+            pthread_cond_wait( &s->ready, &s->lock );
+        pthread_mutex_unlock( &s->lock );
+
+        if ( stage == MODEM_BITALLOC )
+        {
+            s->frame = f;
+            s->start = th_wall_seconds();
+        }
+        modem_stage( m, s, stage );
+        if ( stage == MODEM_DECODE )
+            m->latency[f % MODEM_LATENCY_FRAMES] = th_wall_seconds() - s->start;
+
+        pthread_mutex_lock( &s->lock );
+        s->stage = ( stage + 1 ) % MODEM_STAGES;
+        pthread_cond_broadcast( &s->ready );
+        pthread_mutex_unlock( &s->lock );
+    }
+}
+
+/* A th_pool_run() part of modem_threads, part p running stage p */
+static void modem_part( void *arg, int part )
+{
+    modem_run_stage( (Modem *)arg, part );
+}
+
+/*
+* FUNC   : modem_threads
+*
+* DESC   : Runs 'frames' frames through the pipeline on a pool of
+*          MODEM_STAGES threads, a stage each, the calling thread running
+*          BITALLOC, and returns the wall-clock seconds.
+*/
+static double modem_threads( Modem *m, THPool *pool, size_t frames )
+{
+    double      t0;
+
+    m->frames = frames;
+    t0 = th_wall_seconds();
+    th_pool_run( pool, modem_part, m );
+    return th_wall_seconds() - t0;
+}
+
+/*
+* FUNC   : modem_report
+*
+* DESC   : Prints the wall-clock frames per second of modem_threads and the
+*          latency percentiles of a frame, BITALLOC to DECODE and waits in
+*          the ring included, over the last MODEM_LATENCY_FRAMES frames.
+*/
+static void modem_report( Modem *m, size_t frames, double seconds )
+{
+    static const double percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+    size_t  n, i;
+    n_int   p;
+
+    n = frames < MODEM_LATENCY_FRAMES ? frames : MODEM_LATENCY_FRAMES;
+    if ( n == 0 )
+        return;
+    qsort( m->latency, n, sizeof(double), compare_seconds );
+
+    th_printf( "--  Pipeline %d threads, %d slots: %10.1f frames/s, %9.3f payload Mbit/s\n",
+               MODEM_STAGES, MODEM_RING,
+               seconds > 0.0 ? frames / seconds : 0.0,
+               seconds > 0.0 ? (double)frames * MODEM_PACKETS * MODEM_PAYLOAD_BITS / seconds * 1e-6 : 0.0 );
+    for ( p = 0; p < (n_int)( sizeof(percentiles) / sizeof(percentiles[0]) ); p++ )
+    {
+        i = (size_t)( percentiles[p] / 100.0 * ( n - 1 ) + 0.5 );
+        th_printf( "--  Pipeline latency p%-4g: %9.2f us\n", percentiles[p], m->latency[i] * 1e6 );
+    }
+    th_printf( "--  Pipeline latency max  : %9.2f us\n", m->latency[n - 1] * 1e6 );
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : t_run_test
+ *
+ * DESC   : called to run the test
+ *
+ *          This function is called to start the test.  It does not return
+ *          until after the test is completed (finished).  Note, th_finished()
+ *          and th_report_results() MUST be called before this function
+ *          returns if results are to be report.  If these are not called
+ *          then no results will be reported for the test.
+ *
+ * NOTE   : after this function returns, no other functions in the test
+ *          will be called.  EG, returning from this function is equivelent
+ *          to returning from a main() or calling th_exit()
+ *
+ * RETURNS: Success if the test ran fine.  If th_finished() and
+ *          th_report_results() were not called, then the test finished
+ *          successfully, but there were no results and the host will
+ *          not be able to measure the test's duration.
+*/
+
+int t_run_test( size_t iterations, int argc, const char* argv[] )
+
+   {
+   THTestResults    results;
+   static n_char    info[64]; /* gotta be static */
+   Modem            modem;
+   n_int            r, i, j, k;
+   e_u32            seed;
+#if MODEM_THREADS
+   THPool           *pool;
+   double           seconds;
+#else
+   ModemSlot        *slot;
+   size_t           loop_cnt;
+#endif
+
+   argc = argc;
+   argv = argv;
+
+   /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    * First, initialize the data structures we need for the test
+    */
+   modem.AllocationMap = alloc_map_buf;
+   modem.SineV         = sin_buf;
+   modem.CosineV       = cosin_buf;
+   modem.BitRevInd     = index_buf;
+   modem.raw_errors    = 0;
+   modem.bit_errors    = 0;
+   modem.packet_errors = 0;
+
+   for ( r = 0; r < MODEM_RING; r++ )
+      {
+      modem.ring[r] = (ModemSlot *)th_malloc_aligned( sizeof(ModemSlot), EE_SIMD_ALIGN );
+      if ( modem.ring[r] == NULL )
+         th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+#if MODEM_THREADS
+      pthread_mutex_init( &modem.ring[r]->lock, NULL );
+      pthread_cond_init( &modem.ring[r]->ready, NULL );
+      modem.ring[r]->stage = MODEM_BITALLOC;
+#endif
+      }
+
+   modem.snr     = (e_s16 *)th_malloc( (size_t)MODEM_PROFILES * MODEM_CARRIERS * sizeof(e_s16) );
+   modem.payload = (e_u8 *)th_malloc( (size_t)MODEM_PROFILES * MODEM_PACKETS * MODEM_PACKET_BITS );
+#if MODEM_THREADS
+   modem.latency = (double *)th_malloc( MODEM_LATENCY_FRAMES * sizeof(double) );
+   if ( modem.latency == NULL )
+      th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+#endif
+   if ( modem.snr == NULL || modem.payload == NULL )
+      th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+   /* The profiles: the line's SNRs with up to MODEM_RIPPLE of ripple, the
+    * first as is, and random packets flushed back to state 0 */
+   seed = 1;
+   modem.WaterLeveldB = -32768;
+   for ( r = 0; r < MODEM_PROFILES; r++ )
+      {
+      for ( k = 0; k < MODEM_CARRIERS; k++ )
+         {
+         modem.snr[r * MODEM_CARRIERS + k] = (e_s16)( snr_buf[k] +
+            ( r == 0 ? 0 : modem_random( &seed ) % ( 2 * MODEM_RIPPLE + 1 ) - MODEM_RIPPLE ) );
+         /* Save the maximum CarrierSNR as the inital WaterLevel */
+         if ( modem.snr[r * MODEM_CARRIERS + k] > modem.WaterLeveldB )
+            modem.WaterLeveldB = modem.snr[r * MODEM_CARRIERS + k];
+         }
+      for ( i = 0; i < MODEM_PACKETS; i++ )
+         for ( j = 0; j < MODEM_PACKET_BITS; j++ )
+            modem.payload[( r * MODEM_PACKETS + i ) * MODEM_PACKET_BITS + j] =
+               (e_u8)( j < MODEM_PAYLOAD_BITS ? modem_random( &seed ) & 1 : 0 );
+      }
+
+   /* Fill Allocation Map */
+   for ( i = 0; i < ALLOCATION_MAP_SIZE; i++ )
+      if ( modem.AllocationMap[i] > MAX_BITS_PER_CARRIER )
+         modem.AllocationMap[i] = MAX_BITS_PER_CARRIER;
+
+   fxpBitAllocSelectKernel();  /* pick the kernel variants, see th_kernel_select() */
+   fxpFFTSelectKernel();
+   ViterbiSelectKernel();
+
+   /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    * This is the actual benchmark
+    */
+
+#if MODEM_THREADS
+   pool = th_pool_open( MODEM_STAGES );
+   if ( pool == NULL )
+      th_exit( THE_FAILURE, "Cannot create thread %s:%d", __FILE__, __LINE__ );
+
+   th_signal_start();  /* Tell the host that the test has begun */
+   seconds = modem_threads( &modem, pool, iterations );
+   results.duration = th_signal_finished();  /* signal that we are finished */
+
+   th_pool_close( pool );
+#else
+   th_latency_begin( iterations );
+   th_signal_start();  /* Tell the host that the test has begun */
+
+   for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
+      {
+      slot = modem.ring[loop_cnt % MODEM_RING];
+      slot->frame = loop_cnt;
+      for ( r = 0; r < MODEM_STAGES; r++ )
+         modem_stage( &modem, slot, r );
+      th_latency_mark();
+      } /* end for */
+
+   results.duration = th_signal_finished();  /* signal that we are finished */
+#endif
+
+   results.iterations = iterations;
+   results.v1         = 0;
+   results.v2         = 0;
+   results.v3         = 0;
+   results.v4         = 0;
+   results.info       = info;
+   results.verify_snr = FALSE;
+
+   th_sprintf( info, "%d packets per frame", MODEM_PACKETS );
+
+   th_printf( "--  Pipeline %ld frames of %d packets: %ld raw bit errors in %ld code bits, "
+              "%ld bit errors, %ld packet errors\n",
+              (long)iterations, MODEM_PACKETS, modem.raw_errors, (long)iterations * MODEM_CODED_BITS,
+              modem.bit_errors, modem.packet_errors );
+
+   /* Verification */
+   if ( modem.bit_errors != 0 )
+      {
+      th_printf( "Failed: %ld payload bits decoded wrong\n", modem.bit_errors );
+      results.v1 = (size_t)modem.bit_errors;
+      results.v2 = (size_t)modem.packet_errors;
+      }
+
+#if NON_INTRUSIVE_CRC_CHECK
+   /* Frame 0 again, untimed, for a crc that does not depend on the
+    * iterations: its allocation and decoded packets */
+   modem.ring[0]->frame = 0;
+   for ( r = 0; r < MODEM_STAGES; r++ )
+      modem_stage( &modem, modem.ring[0], r );
+   results.CRC = Calc_crc_buf16( (const e_u16 *)modem.ring[0]->alloc, MODEM_CARRIERS, 0 );
+   results.CRC = Calc_crc_buf16( (const e_u16 *)modem.ring[0]->decoded,
+                                 MODEM_PACKETS * MODEM_PACKET_WORDS, results.CRC );
+#elif CRC_CHECK
+   results.CRC = 0;
+#else
+   results.CRC = 0;
+#endif
+
+#if MODEM_THREADS
+   modem_report( &modem, iterations, seconds );
+   th_free( modem.latency );
+#endif
+
+   th_free( modem.payload );
+   th_free( modem.snr );
+   for ( r = 0; r < MODEM_RING; r++ )
+      {
+#if MODEM_THREADS
+      pthread_cond_destroy( &modem.ring[r]->ready );
+      pthread_mutex_destroy( &modem.ring[r]->lock );
+#endif
+      th_free_aligned( modem.ring[r] );
+      }
+
+   return th_report_results( &results, EXPECTED_CRC );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : test_main
+ *
+ * DESC   : the test (or bench mark) main entry point
+ *
+ * RETURNS: Any error value defined in th_error.h
+ * ---------------------------------------------------------------------------*/
+
+int test_main( struct TCDef** tcdef, int argc, const char* argv[] )
+   {
+   argc = argc;
+   argv = argv;
+   /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    *                  >>> GOTTA DO THIS FIRST <<<
+    * Point the test harness at our test definition structure
+   */
+   *tcdef = &the_tcdef;
+
+   /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    * Now do any other low level, or basic initialization here
+   */
+   return Success;
+   }
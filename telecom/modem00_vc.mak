@@ -0,0 +1,48 @@
+# File generated by Makerule.pl - DO NOT EDIT
+# Edit depgen_modem00_vc.cml to change
+# $Revision: 1.22 $ $Date: 2002/07/18 19:00:12 $
+$(OBJBUILD)/modem00/bmark$(LITE)$(OBJ) :                               \
+                                         modem00/algo.h                \
+                                         fbital00/datasets/xtypsnri.dat \
+                                         fbital00/datasets/allocmapi.dat \
+                                         fft00/datasets/cstable256i.dat \
+                                         fft00/datasets/brind256i.dat
+$(OBJBUILD)/modem00/bmark$(LITE)$(OBJ) : modem00/bmark$(LITE).c        \
+                                         $(BMDEPS)
+	$(COM) -Imodem00 -Ifbital00/datasets -Ifft00/datasets -DFBITAL_BISECTION=TRUE -DITERATIONS=$(modem00) $(CINCS) $(OBJOUT)"$(OBJBUILD)/modem00/bmark$(LITE)$(OBJ)" modem00/bmark$(LITE).c
+
+$(OBJBUILD)/modem00/fbital00$(OBJ) :                                   \
+                                     fbital00/algo.h
+$(OBJBUILD)/modem00/fbital00$(OBJ) : fbital00/fbital00.c $(BMDEPS)
+	$(COM) -Imodem00 -Ifbital00/datasets -Ifft00/datasets -DFBITAL_BISECTION=TRUE -DITERATIONS=$(modem00) $(CINCS) $(OBJOUT)"$(OBJBUILD)/modem00/fbital00$(OBJ)" fbital00/fbital00.c
+
+$(OBJBUILD)/modem00/conven00$(OBJ) :                                   \
+                                     conven00/algo.h
+$(OBJBUILD)/modem00/conven00$(OBJ) : conven00/conven00.c $(BMDEPS)
+	$(COM) -Imodem00 -Ifbital00/datasets -Ifft00/datasets -DFBITAL_BISECTION=TRUE -DITERATIONS=$(modem00) $(CINCS) $(OBJOUT)"$(OBJBUILD)/modem00/conven00$(OBJ)" conven00/conven00.c
+
+$(OBJBUILD)/modem00/fft00$(OBJ) :                                      \
+                                  fft00/algo.h
+$(OBJBUILD)/modem00/fft00$(OBJ) : fft00/fft00.c $(BMDEPS)
+	$(COM) -Imodem00 -Ifbital00/datasets -Ifft00/datasets -DFBITAL_BISECTION=TRUE -DITERATIONS=$(modem00) $(CINCS) $(OBJOUT)"$(OBJBUILD)/modem00/fft00$(OBJ)" fft00/fft00.c
+
+$(OBJBUILD)/modem00/viterb00$(OBJ) :                                   \
+                                     viterb00/algo.h
+$(OBJBUILD)/modem00/viterb00$(OBJ) : viterb00/viterb00.c $(BMDEPS)
+	$(COM) -Imodem00 -Ifbital00/datasets -Ifft00/datasets -DFBITAL_BISECTION=TRUE -DITERATIONS=$(modem00) $(CINCS) $(OBJOUT)"$(OBJBUILD)/modem00/viterb00$(OBJ)" viterb00/viterb00.c
+
+MODEM00 = \
+    $(OBJBUILD)/modem00/bmark$(LITE)$(OBJ) \
+    $(OBJBUILD)/modem00/fbital00$(OBJ) \
+    $(OBJBUILD)/modem00/conven00$(OBJ) \
+    $(OBJBUILD)/modem00/fft00$(OBJ) \
+    $(OBJBUILD)/modem00/viterb00$(OBJ) 
+
+$(BINBUILD)/modem00$(LITE)$(EXE):  $(MODEM00) $(THOBJS) 
+	$(LINK) $(EXEOUT)"$(BINBUILD)/modem00$(LITE)$(EXE)" $(MODEM00) $(THLIB)  
+
+
+targets:: \
+	$(BINBUILD)/modem00$(LITE)$(EXE) 
+
+
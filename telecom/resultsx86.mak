@@ -119,3 +119,15 @@ $(TOOLCHAIN)$(SLOGTYP)$(VER)$(LITE).log:	 $(SIZELOGS)
 	@echo >> $(TOOLCHAIN)$(SLOGTYP)$(VER)$(LITE).log
 	@gawk -f $(ROOT)/util/$(AWKDIR)/size$(AWKSZ).awk -v BMARK=viterb00data_4  $(RESULTS)/viterb00data_4.size.log >> $(TOOLCHAIN)$(SLOGTYP)$(VER)$(LITE).log
 	@echo >> $(TOOLCHAIN)$(SLOGTYP)$(VER)$(LITE).log
+
+# Baselines of the -json results records, see util/perl/baseline.pl.
+# Run with CMDLINE="-autogo -json -trials<n>" for the confidence intervals,
+# and name the build with BASELINE_FLAGS=-config=<name>.
+BASELINES	= baselines
+RECORDS		= thresults.json
+
+baseline:
+	@perl $(ROOT)/util/perl/baseline.pl store -dir=$(BASELINES) $(BASELINE_FLAGS) $(RECORDS)
+
+compare:
+	@perl $(ROOT)/util/perl/baseline.pl compare -dir=$(BASELINES) $(BASELINE_FLAGS) $(RECORDS)
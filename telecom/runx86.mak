@@ -139,3 +139,15 @@ $(RESULTS)/viterb00data_4.run.log:	 $(BINBUILD)/viterb00data_4$(LITE)$(EXE)
 $(RESULTS)/viterb00data_4.size.log:	 $(BINBUILD)/viterb00data_4$(LITE)$(EXE)
 	$(SIZE) $(SIZE_FLAGS) $(BINBUILD)/viterb00data_4$(LITE)$(EXE) > $(RESULTS)/viterb00data_4.size.log
 
+
+# The telemark suite image, not part of 'run'; it repeats every benchmark
+run_telemark:	$(RESULTS)/telemark.run.log
+
+$(RESULTS)/telemark.run.log:	 $(BINBUILD)/telemark$(LITE)$(EXE)
+	-$(RUN) $(RUN_FLAGS) $(BINBUILD)/telemark$(LITE)$(EXE) $(CMDLINE$(LITE)) > $(RESULTS)/telemark.run.log 
+
+# The modem00 pipeline, not part of 'run' either; it repeats the kernels
+run_modem00:	$(RESULTS)/modem00.run.log
+
+$(RESULTS)/modem00.run.log:	 $(BINBUILD)/modem00$(LITE)$(EXE)
+	-$(RUN) $(RUN_FLAGS) $(BINBUILD)/modem00$(LITE)$(EXE) $(CMDLINE$(LITE)) > $(RESULTS)/modem00.run.log
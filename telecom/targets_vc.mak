@@ -37,10 +37,17 @@ $(OBJBUILD)/autcor00data_1/verify$(OBJ) : diffmeasure/verify.c         \
                                           $(BMDEPS)
 	$(COM) -Iautcor00 -Iautcor00/datasets -Idiffmeasure -DDATA_1 -DITERATIONS=$(autcor00data_1) $(CINCS) $(OBJOUT)"$(OBJBUILD)/autcor00data_1/verify$(OBJ)" diffmeasure/verify.c
 
+$(OBJBUILD)/autcor00data_1/fft00$(OBJ) :                               \
+                                         fft00/algo.h
+$(OBJBUILD)/autcor00data_1/fft00$(OBJ) : fft00/fft00.c                  \
+                                         $(BMDEPS)
+	$(COM) -Iautcor00 -Iautcor00/datasets -Idiffmeasure -DDATA_1 -DITERATIONS=$(autcor00data_1) $(CINCS) $(OBJOUT)"$(OBJBUILD)/autcor00data_1/fft00$(OBJ)" fft00/fft00.c
+
 AUTCOR00DATA_1 = \
     $(OBJBUILD)/autcor00data_1/autcor00$(OBJ) \
     $(OBJBUILD)/autcor00data_1/bmark$(LITE)$(OBJ) \
-    $(OBJBUILD)/autcor00data_1/verify$(OBJ) 
+    $(OBJBUILD)/autcor00data_1/verify$(OBJ) \
+    $(OBJBUILD)/autcor00data_1/fft00$(OBJ) 
 
 $(BINBUILD)/autcor00data_1$(LITE)$(EXE):  $(AUTCOR00DATA_1) $(THOBJS) 
 	$(LINK) $(EXEOUT)"$(BINBUILD)/autcor00data_1$(LITE)$(EXE)" $(AUTCOR00DATA_1) $(THLIB)  
@@ -71,10 +78,17 @@ $(OBJBUILD)/autcor00data_2/verify$(OBJ) : diffmeasure/verify.c         \
                                           $(BMDEPS)
 	$(COM) -Iautcor00 -Iautcor00/datasets -Idiffmeasure -DDATA_2 -DITERATIONS=$(autcor00data_2) $(CINCS) $(OBJOUT)"$(OBJBUILD)/autcor00data_2/verify$(OBJ)" diffmeasure/verify.c
 
+$(OBJBUILD)/autcor00data_2/fft00$(OBJ) :                               \
+                                         fft00/algo.h
+$(OBJBUILD)/autcor00data_2/fft00$(OBJ) : fft00/fft00.c                  \
+                                         $(BMDEPS)
+	$(COM) -Iautcor00 -Iautcor00/datasets -Idiffmeasure -DDATA_2 -DITERATIONS=$(autcor00data_2) $(CINCS) $(OBJOUT)"$(OBJBUILD)/autcor00data_2/fft00$(OBJ)" fft00/fft00.c
+
 AUTCOR00DATA_2 = \
     $(OBJBUILD)/autcor00data_2/autcor00$(OBJ) \
     $(OBJBUILD)/autcor00data_2/bmark$(LITE)$(OBJ) \
-    $(OBJBUILD)/autcor00data_2/verify$(OBJ) 
+    $(OBJBUILD)/autcor00data_2/verify$(OBJ) \
+    $(OBJBUILD)/autcor00data_2/fft00$(OBJ) 
 
 $(BINBUILD)/autcor00data_2$(LITE)$(EXE):  $(AUTCOR00DATA_2) $(THOBJS) 
 	$(LINK) $(EXEOUT)"$(BINBUILD)/autcor00data_2$(LITE)$(EXE)" $(AUTCOR00DATA_2) $(THLIB)  
@@ -105,10 +119,17 @@ $(OBJBUILD)/autcor00data_3/verify$(OBJ) : diffmeasure/verify.c         \
                                           $(BMDEPS)
 	$(COM) -Iautcor00 -Iautcor00/datasets -Idiffmeasure -DDATA_3 -DITERATIONS=$(autcor00data_3) $(CINCS) $(OBJOUT)"$(OBJBUILD)/autcor00data_3/verify$(OBJ)" diffmeasure/verify.c
 
+$(OBJBUILD)/autcor00data_3/fft00$(OBJ) :                               \
+                                         fft00/algo.h
+$(OBJBUILD)/autcor00data_3/fft00$(OBJ) : fft00/fft00.c                  \
+                                         $(BMDEPS)
+	$(COM) -Iautcor00 -Iautcor00/datasets -Idiffmeasure -DDATA_3 -DITERATIONS=$(autcor00data_3) $(CINCS) $(OBJOUT)"$(OBJBUILD)/autcor00data_3/fft00$(OBJ)" fft00/fft00.c
+
 AUTCOR00DATA_3 = \
     $(OBJBUILD)/autcor00data_3/autcor00$(OBJ) \
     $(OBJBUILD)/autcor00data_3/bmark$(LITE)$(OBJ) \
-    $(OBJBUILD)/autcor00data_3/verify$(OBJ) 
+    $(OBJBUILD)/autcor00data_3/verify$(OBJ) \
+    $(OBJBUILD)/autcor00data_3/fft00$(OBJ) 
 
 $(BINBUILD)/autcor00data_3$(LITE)$(EXE):  $(AUTCOR00DATA_3) $(THOBJS) 
 	$(LINK) $(EXEOUT)"$(BINBUILD)/autcor00data_3$(LITE)$(EXE)" $(AUTCOR00DATA_3) $(THLIB)  
@@ -437,6 +458,12 @@ $(OBJBUILD)/viterb00data_1/bmark$(LITE)$(OBJ) : viterb00/bmark$(LITE).c \
                                                 $(BMDEPS)
 	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_1 -DITERATIONS=$(viterb00data_1) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_1/bmark$(LITE)$(OBJ)" viterb00/bmark$(LITE).c
 
+$(OBJBUILD)/viterb00data_1/trellis$(OBJ) :                             \
+                                           viterb00/algo.h
+$(OBJBUILD)/viterb00data_1/trellis$(OBJ) : viterb00/trellis.c          \
+                                           $(BMDEPS)
+	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_1 -DITERATIONS=$(viterb00data_1) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_1/trellis$(OBJ)" viterb00/trellis.c
+
 $(OBJBUILD)/viterb00data_1/viterb00$(OBJ) :                            \
                                             viterb00/algo.h
 $(OBJBUILD)/viterb00data_1/viterb00$(OBJ) : viterb00/viterb00.c        \
@@ -449,10 +476,18 @@ $(OBJBUILD)/viterb00data_1/verify$(OBJ) : diffmeasure/verify.c         \
                                           $(BMDEPS)
 	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_1 -DITERATIONS=$(viterb00data_1) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_1/verify$(OBJ)" diffmeasure/verify.c
 
+$(OBJBUILD)/viterb00data_1/conven00$(OBJ) :                            \
+                                            conven00/algo.h
+$(OBJBUILD)/viterb00data_1/conven00$(OBJ) : conven00/conven00.c        \
+                                            $(BMDEPS)
+	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_1 -DITERATIONS=$(viterb00data_1) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_1/conven00$(OBJ)" conven00/conven00.c
+
 VITERB00DATA_1 = \
     $(OBJBUILD)/viterb00data_1/bmark$(LITE)$(OBJ) \
+    $(OBJBUILD)/viterb00data_1/trellis$(OBJ) \
     $(OBJBUILD)/viterb00data_1/viterb00$(OBJ) \
-    $(OBJBUILD)/viterb00data_1/verify$(OBJ) 
+    $(OBJBUILD)/viterb00data_1/verify$(OBJ) \
+    $(OBJBUILD)/viterb00data_1/conven00$(OBJ) 
 
 $(BINBUILD)/viterb00data_1$(LITE)$(EXE):  $(VITERB00DATA_1) $(THOBJS) 
 	$(LINK) $(EXEOUT)"$(BINBUILD)/viterb00data_1$(LITE)$(EXE)" $(VITERB00DATA_1) $(THLIB)  
@@ -472,6 +507,12 @@ $(OBJBUILD)/viterb00data_2/bmark$(LITE)$(OBJ) : viterb00/bmark$(LITE).c \
                                                 $(BMDEPS)
 	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_2 -DITERATIONS=$(viterb00data_2) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_2/bmark$(LITE)$(OBJ)" viterb00/bmark$(LITE).c
 
+$(OBJBUILD)/viterb00data_2/trellis$(OBJ) :                             \
+                                           viterb00/algo.h
+$(OBJBUILD)/viterb00data_2/trellis$(OBJ) : viterb00/trellis.c          \
+                                           $(BMDEPS)
+	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_2 -DITERATIONS=$(viterb00data_2) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_2/trellis$(OBJ)" viterb00/trellis.c
+
 $(OBJBUILD)/viterb00data_2/viterb00$(OBJ) :                            \
                                             viterb00/algo.h
 $(OBJBUILD)/viterb00data_2/viterb00$(OBJ) : viterb00/viterb00.c        \
@@ -484,10 +525,18 @@ $(OBJBUILD)/viterb00data_2/verify$(OBJ) : diffmeasure/verify.c         \
                                           $(BMDEPS)
 	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_2 -DITERATIONS=$(viterb00data_2) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_2/verify$(OBJ)" diffmeasure/verify.c
 
+$(OBJBUILD)/viterb00data_2/conven00$(OBJ) :                            \
+                                            conven00/algo.h
+$(OBJBUILD)/viterb00data_2/conven00$(OBJ) : conven00/conven00.c        \
+                                            $(BMDEPS)
+	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_2 -DITERATIONS=$(viterb00data_2) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_2/conven00$(OBJ)" conven00/conven00.c
+
 VITERB00DATA_2 = \
     $(OBJBUILD)/viterb00data_2/bmark$(LITE)$(OBJ) \
+    $(OBJBUILD)/viterb00data_2/trellis$(OBJ) \
     $(OBJBUILD)/viterb00data_2/viterb00$(OBJ) \
-    $(OBJBUILD)/viterb00data_2/verify$(OBJ) 
+    $(OBJBUILD)/viterb00data_2/verify$(OBJ) \
+    $(OBJBUILD)/viterb00data_2/conven00$(OBJ) 
 
 $(BINBUILD)/viterb00data_2$(LITE)$(EXE):  $(VITERB00DATA_2) $(THOBJS) 
 	$(LINK) $(EXEOUT)"$(BINBUILD)/viterb00data_2$(LITE)$(EXE)" $(VITERB00DATA_2) $(THLIB)  
@@ -507,6 +556,12 @@ $(OBJBUILD)/viterb00data_3/bmark$(LITE)$(OBJ) : viterb00/bmark$(LITE).c \
                                                 $(BMDEPS)
 	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_3 -DITERATIONS=$(viterb00data_3) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_3/bmark$(LITE)$(OBJ)" viterb00/bmark$(LITE).c
 
+$(OBJBUILD)/viterb00data_3/trellis$(OBJ) :                             \
+                                           viterb00/algo.h
+$(OBJBUILD)/viterb00data_3/trellis$(OBJ) : viterb00/trellis.c          \
+                                           $(BMDEPS)
+	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_3 -DITERATIONS=$(viterb00data_3) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_3/trellis$(OBJ)" viterb00/trellis.c
+
 $(OBJBUILD)/viterb00data_3/viterb00$(OBJ) :                            \
                                             viterb00/algo.h
 $(OBJBUILD)/viterb00data_3/viterb00$(OBJ) : viterb00/viterb00.c        \
@@ -519,10 +574,18 @@ $(OBJBUILD)/viterb00data_3/verify$(OBJ) : diffmeasure/verify.c         \
                                           $(BMDEPS)
 	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_3 -DITERATIONS=$(viterb00data_3) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_3/verify$(OBJ)" diffmeasure/verify.c
 
+$(OBJBUILD)/viterb00data_3/conven00$(OBJ) :                            \
+                                            conven00/algo.h
+$(OBJBUILD)/viterb00data_3/conven00$(OBJ) : conven00/conven00.c        \
+                                            $(BMDEPS)
+	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_3 -DITERATIONS=$(viterb00data_3) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_3/conven00$(OBJ)" conven00/conven00.c
+
 VITERB00DATA_3 = \
     $(OBJBUILD)/viterb00data_3/bmark$(LITE)$(OBJ) \
+    $(OBJBUILD)/viterb00data_3/trellis$(OBJ) \
     $(OBJBUILD)/viterb00data_3/viterb00$(OBJ) \
-    $(OBJBUILD)/viterb00data_3/verify$(OBJ) 
+    $(OBJBUILD)/viterb00data_3/verify$(OBJ) \
+    $(OBJBUILD)/viterb00data_3/conven00$(OBJ) 
 
 $(BINBUILD)/viterb00data_3$(LITE)$(EXE):  $(VITERB00DATA_3) $(THOBJS) 
 	$(LINK) $(EXEOUT)"$(BINBUILD)/viterb00data_3$(LITE)$(EXE)" $(VITERB00DATA_3) $(THLIB)  
@@ -542,6 +605,12 @@ $(OBJBUILD)/viterb00data_4/bmark$(LITE)$(OBJ) : viterb00/bmark$(LITE).c \
                                                 $(BMDEPS)
 	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_4 -DITERATIONS=$(viterb00data_4) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_4/bmark$(LITE)$(OBJ)" viterb00/bmark$(LITE).c
 
+$(OBJBUILD)/viterb00data_4/trellis$(OBJ) :                             \
+                                           viterb00/algo.h
+$(OBJBUILD)/viterb00data_4/trellis$(OBJ) : viterb00/trellis.c          \
+                                           $(BMDEPS)
+	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_4 -DITERATIONS=$(viterb00data_4) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_4/trellis$(OBJ)" viterb00/trellis.c
+
 $(OBJBUILD)/viterb00data_4/viterb00$(OBJ) :                            \
                                             viterb00/algo.h
 $(OBJBUILD)/viterb00data_4/viterb00$(OBJ) : viterb00/viterb00.c        \
@@ -554,10 +623,18 @@ $(OBJBUILD)/viterb00data_4/verify$(OBJ) : diffmeasure/verify.c         \
                                           $(BMDEPS)
 	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_4 -DITERATIONS=$(viterb00data_4) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_4/verify$(OBJ)" diffmeasure/verify.c
 
+$(OBJBUILD)/viterb00data_4/conven00$(OBJ) :                            \
+                                            conven00/algo.h
+$(OBJBUILD)/viterb00data_4/conven00$(OBJ) : conven00/conven00.c        \
+                                            $(BMDEPS)
+	$(COM) -Iviterb00 -Iviterb00/datasets -Idiffmeasure -DDATA_4 -DITERATIONS=$(viterb00data_4) $(CINCS) $(OBJOUT)"$(OBJBUILD)/viterb00data_4/conven00$(OBJ)" conven00/conven00.c
+
 VITERB00DATA_4 = \
     $(OBJBUILD)/viterb00data_4/bmark$(LITE)$(OBJ) \
+    $(OBJBUILD)/viterb00data_4/trellis$(OBJ) \
     $(OBJBUILD)/viterb00data_4/viterb00$(OBJ) \
-    $(OBJBUILD)/viterb00data_4/verify$(OBJ) 
+    $(OBJBUILD)/viterb00data_4/verify$(OBJ) \
+    $(OBJBUILD)/viterb00data_4/conven00$(OBJ) 
 
 $(BINBUILD)/viterb00data_4$(LITE)$(EXE):  $(VITERB00DATA_4) $(THOBJS) 
 	$(LINK) $(EXEOUT)"$(BINBUILD)/viterb00data_4$(LITE)$(EXE)" $(VITERB00DATA_4) $(THLIB)  
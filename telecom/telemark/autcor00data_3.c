@@ -0,0 +1,16 @@
+/**
+ *
+ * Copyright (C) EEMBC(R) All Rights Reserved
+ *
+ * This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+ * Please refer to the license file (LICENSE.md) included with this code.
+ *
+ */
+
+/* autcor00 DATA_3 in the telemark suite image, see bmark.c */
+
+#define DATA_3
+#define t_run_test autcor00data_3_run_test
+#define test_main  autcor00data_3_test_main
+
+#include "../autcor00/bmark.c"
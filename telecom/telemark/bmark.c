@@ -0,0 +1,108 @@
+/**
+ *
+ * Copyright (C) EEMBC(R) All Rights Reserved
+ *
+ * This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+ * Please refer to the license file (LICENSE.md) included with this code.
+ *
+ */
+
+/*==============================================================================
+ * The telemark suite image
+ *
+ * Links every telecom kernel and data set into one TH image.  Each data set
+ * is its benchmark's bmark.c built with that DATA_n and its entry points
+ * renamed (autcor00data_1.c and friends).  test_main() chains their TCDefs
+ * through 'next', and the TH runs the whole chain for each 'g' and reports
+ * the Telemark score (see TH_SUITE_SCORE in harness.h).
+ *============================================================================*/
+
+#include "thlib.h"
+#include <string.h>
+
+int    test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+
+int autcor00data_1_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int autcor00data_2_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int autcor00data_3_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int conven00data_1_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int conven00data_2_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int conven00data_3_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int fbital00data_2_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int fbital00data_3_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int fbital00data_6_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int fft00data_1_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int fft00data_2_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int fft00data_3_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int viterb00data_1_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int viterb00data_2_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int viterb00data_3_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+int viterb00data_4_test_main( struct TCDef** tcdef, int argc, const char* argv[] );
+
+typedef struct {
+   const char      *name;   /* the data set, as in the per benchmark images */
+   tcft_test_main   entry;
+} SuiteEntry;
+
+static const SuiteEntry suite[] =
+   {
+   { "autcor00data_1", autcor00data_1_test_main },
+   { "autcor00data_2", autcor00data_2_test_main },
+   { "autcor00data_3", autcor00data_3_test_main },
+   { "conven00data_1", conven00data_1_test_main },
+   { "conven00data_2", conven00data_2_test_main },
+   { "conven00data_3", conven00data_3_test_main },
+   { "fbital00data_2", fbital00data_2_test_main },
+   { "fbital00data_3", fbital00data_3_test_main },
+   { "fbital00data_6", fbital00data_6_test_main },
+   { "fft00data_1", fft00data_1_test_main },
+   { "fft00data_2", fft00data_2_test_main },
+   { "fft00data_3", fft00data_3_test_main },
+   { "viterb00data_1", viterb00data_1_test_main },
+   { "viterb00data_2", viterb00data_2_test_main },
+   { "viterb00data_3", viterb00data_3_test_main },
+   { "viterb00data_4", viterb00data_4_test_main }
+   };
+
+#define SUITE_SIZE ((int)(sizeof(suite) / sizeof(suite[0])))
+
+/* The chain, copies of each data set's TCDef named after the data set */
+static TCDef suite_tcdef[ SUITE_SIZE ];
+
+/*------------------------------------------------------------------------------
+ * FUNC   : test_main
+ *
+ * DESC   : Initializes every data set of the suite and chains their TCDefs
+ *
+ * RETURNS: Success, or the first failing data set's return value
+ * ---------------------------------------------------------------------------*/
+
+int test_main( struct TCDef** tcdef, int argc, const char* argv[] )
+
+{
+   char   desc[ 16 + sizeof(suite_tcdef[0].desc) ];
+   TCDef *tc;
+   int    rv;
+   int    i;
+
+   for (i = 0; i < SUITE_SIZE; i++)
+      {
+      rv = suite[i].entry( &tc, argc, argv );
+      if (rv != Success)
+         return rv;
+
+      suite_tcdef[i] = *tc;
+
+      /* Every data set of a benchmark has the same desc, so lead with
+       * the data set */
+      th_sprintf( desc, "%s %s", suite[i].name, tc->desc );
+      strncpy( suite_tcdef[i].desc, desc, sizeof(suite_tcdef[i].desc) - 1 );
+      suite_tcdef[i].desc[ sizeof(suite_tcdef[i].desc) - 1 ] = '\0';
+
+      suite_tcdef[i].next = i + 1 < SUITE_SIZE ? &suite_tcdef[i + 1] : NULL;
+      }
+
+   *tcdef = &suite_tcdef[0];
+
+   return Success;
+}
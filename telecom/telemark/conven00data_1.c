@@ -0,0 +1,16 @@
+/**
+ *
+ * Copyright (C) EEMBC(R) All Rights Reserved
+ *
+ * This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+ * Please refer to the license file (LICENSE.md) included with this code.
+ *
+ */
+
+/* conven00 DATA_1 in the telemark suite image, see bmark.c */
+
+#define DATA_1
+#define t_run_test conven00data_1_run_test
+#define test_main  conven00data_1_test_main
+
+#include "../conven00/bmark.c"
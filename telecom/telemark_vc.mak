@@ -0,0 +1,311 @@
+# File generated by Makerule.pl - DO NOT EDIT
+# Edit depgen_telemark_vc.cml to change
+# $Revision: 1.22 $ $Date: 2002/07/18 19:00:12 $
+$(OBJBUILD)/telemark/autcor00data_1$(OBJ) :                            \
+                                                                       \
+                                            telemark/../autcor00/bmark.c \
+                                            diffmeasure/verify.h       \
+                                            autcor00/datasets/xpulsei.dat \
+                                            autcor00/datasets/vpulseai.dat \
+                                            autcor00/datasets/xsinei.dat \
+                                            autcor00/datasets/vsineai.dat \
+                                            autcor00/datasets/xspeechi.dat \
+                                            autcor00/datasets/vspeechai.dat
+$(OBJBUILD)/telemark/autcor00data_1$(OBJ) : telemark/autcor00data_1.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/autcor00data_1$(OBJ)" telemark/autcor00data_1.c
+
+$(OBJBUILD)/telemark/autcor00data_2$(OBJ) :                            \
+                                                                       \
+                                            telemark/../autcor00/bmark.c \
+                                            diffmeasure/verify.h       \
+                                            autcor00/datasets/xpulsei.dat \
+                                            autcor00/datasets/vpulseai.dat \
+                                            autcor00/datasets/xsinei.dat \
+                                            autcor00/datasets/vsineai.dat \
+                                            autcor00/datasets/xspeechi.dat \
+                                            autcor00/datasets/vspeechai.dat
+$(OBJBUILD)/telemark/autcor00data_2$(OBJ) : telemark/autcor00data_2.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/autcor00data_2$(OBJ)" telemark/autcor00data_2.c
+
+$(OBJBUILD)/telemark/autcor00data_3$(OBJ) :                            \
+                                                                       \
+                                            telemark/../autcor00/bmark.c \
+                                            diffmeasure/verify.h       \
+                                            autcor00/datasets/xpulsei.dat \
+                                            autcor00/datasets/vpulseai.dat \
+                                            autcor00/datasets/xsinei.dat \
+                                            autcor00/datasets/vsineai.dat \
+                                            autcor00/datasets/xspeechi.dat \
+                                            autcor00/datasets/vspeechai.dat
+$(OBJBUILD)/telemark/autcor00data_3$(OBJ) : telemark/autcor00data_3.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/autcor00data_3$(OBJ)" telemark/autcor00data_3.c
+
+
+$(OBJBUILD)/telemark/bmark$(LITE)$(OBJ) : telemark/bmark$(LITE).c      \
+ $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/bmark$(LITE)$(OBJ)" telemark/bmark$(LITE).c
+
+$(OBJBUILD)/telemark/conven00data_1$(OBJ) :                            \
+                                                                       \
+                                            telemark/../conven00/bmark.c \
+                                            conven00/datasets/xk5r2di.dat \
+                                            conven00/datasets/vk5r2bwi.dat \
+                                            conven00/datasets/xk4r2di.dat \
+                                            conven00/datasets/vk4r2bwi.dat \
+                                            conven00/datasets/xk3r2di.dat \
+                                            conven00/datasets/vk3r2bwi.dat
+$(OBJBUILD)/telemark/conven00data_1$(OBJ) : telemark/conven00data_1.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/conven00data_1$(OBJ)" telemark/conven00data_1.c
+
+$(OBJBUILD)/telemark/conven00data_2$(OBJ) :                            \
+                                                                       \
+                                            telemark/../conven00/bmark.c \
+                                            conven00/datasets/xk5r2di.dat \
+                                            conven00/datasets/vk5r2bwi.dat \
+                                            conven00/datasets/xk4r2di.dat \
+                                            conven00/datasets/vk4r2bwi.dat \
+                                            conven00/datasets/xk3r2di.dat \
+                                            conven00/datasets/vk3r2bwi.dat
+$(OBJBUILD)/telemark/conven00data_2$(OBJ) : telemark/conven00data_2.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/conven00data_2$(OBJ)" telemark/conven00data_2.c
+
+$(OBJBUILD)/telemark/conven00data_3$(OBJ) :                            \
+                                                                       \
+                                            telemark/../conven00/bmark.c \
+                                            conven00/datasets/xk5r2di.dat \
+                                            conven00/datasets/vk5r2bwi.dat \
+                                            conven00/datasets/xk4r2di.dat \
+                                            conven00/datasets/vk4r2bwi.dat \
+                                            conven00/datasets/xk3r2di.dat \
+                                            conven00/datasets/vk3r2bwi.dat
+$(OBJBUILD)/telemark/conven00data_3$(OBJ) : telemark/conven00data_3.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/conven00data_3$(OBJ)" telemark/conven00data_3.c
+
+$(OBJBUILD)/telemark/fbital00data_2$(OBJ) :                            \
+                                                                       \
+                                            telemark/../fbital00/bmark.c \
+                                            fbital00/datasets/vtypbai.dat \
+                                            fbital00/datasets/xtypsnri.dat \
+                                            fbital00/datasets/xstepsnri.dat \
+                                            fbital00/datasets/vstepbai.dat \
+                                            fbital00/datasets/vpentbai.dat \
+                                            fbital00/datasets/xpentsnri.dat \
+                                            fbital00/datasets/allocmapi.dat
+$(OBJBUILD)/telemark/fbital00data_2$(OBJ) : telemark/fbital00data_2.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/fbital00data_2$(OBJ)" telemark/fbital00data_2.c
+
+$(OBJBUILD)/telemark/fbital00data_3$(OBJ) :                            \
+                                                                       \
+                                            telemark/../fbital00/bmark.c \
+                                            fbital00/datasets/vtypbai.dat \
+                                            fbital00/datasets/xtypsnri.dat \
+                                            fbital00/datasets/xstepsnri.dat \
+                                            fbital00/datasets/vstepbai.dat \
+                                            fbital00/datasets/vpentbai.dat \
+                                            fbital00/datasets/xpentsnri.dat \
+                                            fbital00/datasets/allocmapi.dat
+$(OBJBUILD)/telemark/fbital00data_3$(OBJ) : telemark/fbital00data_3.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/fbital00data_3$(OBJ)" telemark/fbital00data_3.c
+
+$(OBJBUILD)/telemark/fbital00data_6$(OBJ) :                            \
+                                                                       \
+                                            telemark/../fbital00/bmark.c \
+                                            fbital00/datasets/vtypbai.dat \
+                                            fbital00/datasets/xtypsnri.dat \
+                                            fbital00/datasets/xstepsnri.dat \
+                                            fbital00/datasets/vstepbai.dat \
+                                            fbital00/datasets/vpentbai.dat \
+                                            fbital00/datasets/xpentsnri.dat \
+                                            fbital00/datasets/allocmapi.dat
+$(OBJBUILD)/telemark/fbital00data_6$(OBJ) : telemark/fbital00data_6.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/fbital00data_6$(OBJ)" telemark/fbital00data_6.c
+
+$(OBJBUILD)/telemark/fft00data_1$(OBJ) :                               \
+                                         telemark/../fft00/bmark.c     \
+                                         diffmeasure/verify.h          \
+                                         fft00/datasets/xtpulse256i.dat \
+                                         fft00/datasets/vtpulse256i.dat \
+                                         fft00/datasets/xspn256i.dat   \
+                                         fft00/datasets/vspn256i.dat   \
+                                         fft00/datasets/xsine256i.dat  \
+                                         fft00/datasets/golden_sine.dat \
+                                         fft00/datasets/cstable256i.dat \
+                                         fft00/datasets/stable256i.dat \
+                                         fft00/datasets/ctable256i.dat \
+                                         fft00/datasets/brind256i.dat
+$(OBJBUILD)/telemark/fft00data_1$(OBJ) : telemark/fft00data_1.c        \
+                                         $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/fft00data_1$(OBJ)" telemark/fft00data_1.c
+
+$(OBJBUILD)/telemark/fft00data_2$(OBJ) :                               \
+                                         telemark/../fft00/bmark.c     \
+                                         diffmeasure/verify.h          \
+                                         fft00/datasets/xtpulse256i.dat \
+                                         fft00/datasets/vtpulse256i.dat \
+                                         fft00/datasets/xspn256i.dat   \
+                                         fft00/datasets/vspn256i.dat   \
+                                         fft00/datasets/xsine256i.dat  \
+                                         fft00/datasets/golden_sine.dat \
+                                         fft00/datasets/cstable256i.dat \
+                                         fft00/datasets/stable256i.dat \
+                                         fft00/datasets/ctable256i.dat \
+                                         fft00/datasets/brind256i.dat
+$(OBJBUILD)/telemark/fft00data_2$(OBJ) : telemark/fft00data_2.c        \
+                                         $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/fft00data_2$(OBJ)" telemark/fft00data_2.c
+
+$(OBJBUILD)/telemark/fft00data_3$(OBJ) :                               \
+                                         telemark/../fft00/bmark.c     \
+                                         diffmeasure/verify.h          \
+                                         fft00/datasets/xtpulse256i.dat \
+                                         fft00/datasets/vtpulse256i.dat \
+                                         fft00/datasets/xspn256i.dat   \
+                                         fft00/datasets/vspn256i.dat   \
+                                         fft00/datasets/xsine256i.dat  \
+                                         fft00/datasets/golden_sine.dat \
+                                         fft00/datasets/cstable256i.dat \
+                                         fft00/datasets/stable256i.dat \
+                                         fft00/datasets/ctable256i.dat \
+                                         fft00/datasets/brind256i.dat
+$(OBJBUILD)/telemark/fft00data_3$(OBJ) : telemark/fft00data_3.c        \
+                                         $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/fft00data_3$(OBJ)" telemark/fft00data_3.c
+
+$(OBJBUILD)/telemark/viterb00data_1$(OBJ) :                            \
+                                                                       \
+                                            telemark/../viterb00/bmark.c \
+                                            viterb00/datasets/getti.dat \
+                                            viterb00/datasets/gett_golden.dat \
+                                            viterb00/datasets/togglei.dat \
+                                            viterb00/datasets/toggle_golden.dat \
+                                            viterb00/datasets/onesi.dat \
+                                            viterb00/datasets/ones_golden.dat \
+                                            viterb00/datasets/zerosi.dat \
+                                            viterb00/datasets/zeros_golden.dat
+$(OBJBUILD)/telemark/viterb00data_1$(OBJ) : telemark/viterb00data_1.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/viterb00data_1$(OBJ)" telemark/viterb00data_1.c
+
+$(OBJBUILD)/telemark/viterb00data_2$(OBJ) :                            \
+                                                                       \
+                                            telemark/../viterb00/bmark.c \
+                                            viterb00/datasets/getti.dat \
+                                            viterb00/datasets/gett_golden.dat \
+                                            viterb00/datasets/togglei.dat \
+                                            viterb00/datasets/toggle_golden.dat \
+                                            viterb00/datasets/onesi.dat \
+                                            viterb00/datasets/ones_golden.dat \
+                                            viterb00/datasets/zerosi.dat \
+                                            viterb00/datasets/zeros_golden.dat
+$(OBJBUILD)/telemark/viterb00data_2$(OBJ) : telemark/viterb00data_2.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/viterb00data_2$(OBJ)" telemark/viterb00data_2.c
+
+$(OBJBUILD)/telemark/viterb00data_3$(OBJ) :                            \
+                                                                       \
+                                            telemark/../viterb00/bmark.c \
+                                            viterb00/datasets/getti.dat \
+                                            viterb00/datasets/gett_golden.dat \
+                                            viterb00/datasets/togglei.dat \
+                                            viterb00/datasets/toggle_golden.dat \
+                                            viterb00/datasets/onesi.dat \
+                                            viterb00/datasets/ones_golden.dat \
+                                            viterb00/datasets/zerosi.dat \
+                                            viterb00/datasets/zeros_golden.dat
+$(OBJBUILD)/telemark/viterb00data_3$(OBJ) : telemark/viterb00data_3.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/viterb00data_3$(OBJ)" telemark/viterb00data_3.c
+
+$(OBJBUILD)/telemark/viterb00data_4$(OBJ) :                            \
+                                                                       \
+                                            telemark/../viterb00/bmark.c \
+                                            viterb00/datasets/getti.dat \
+                                            viterb00/datasets/gett_golden.dat \
+                                            viterb00/datasets/togglei.dat \
+                                            viterb00/datasets/toggle_golden.dat \
+                                            viterb00/datasets/onesi.dat \
+                                            viterb00/datasets/ones_golden.dat \
+                                            viterb00/datasets/zerosi.dat \
+                                            viterb00/datasets/zeros_golden.dat
+$(OBJBUILD)/telemark/viterb00data_4$(OBJ) : telemark/viterb00data_4.c  \
+                                            $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/viterb00data_4$(OBJ)" telemark/viterb00data_4.c
+
+$(OBJBUILD)/telemark/autcor00$(OBJ) :                                  \
+                                      autcor00/algo.h
+$(OBJBUILD)/telemark/autcor00$(OBJ) : autcor00/autcor00.c $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/autcor00$(OBJ)" autcor00/autcor00.c
+
+$(OBJBUILD)/telemark/conven00$(OBJ) :                                  \
+                                      conven00/algo.h
+$(OBJBUILD)/telemark/conven00$(OBJ) : conven00/conven00.c $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/conven00$(OBJ)" conven00/conven00.c
+
+$(OBJBUILD)/telemark/fbital00$(OBJ) :                                  \
+                                      fbital00/algo.h
+$(OBJBUILD)/telemark/fbital00$(OBJ) : fbital00/fbital00.c $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/fbital00$(OBJ)" fbital00/fbital00.c
+
+$(OBJBUILD)/telemark/fft00$(OBJ) :                                     \
+                                   fft00/algo.h
+$(OBJBUILD)/telemark/fft00$(OBJ) : fft00/fft00.c $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/fft00$(OBJ)" fft00/fft00.c
+
+$(OBJBUILD)/telemark/trellis$(OBJ) :                                   \
+                                     viterb00/algo.h
+$(OBJBUILD)/telemark/trellis$(OBJ) : viterb00/trellis.c $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/trellis$(OBJ)" viterb00/trellis.c
+
+$(OBJBUILD)/telemark/viterb00$(OBJ) :                                  \
+                                      viterb00/algo.h
+$(OBJBUILD)/telemark/viterb00$(OBJ) : viterb00/viterb00.c $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/viterb00$(OBJ)" viterb00/viterb00.c
+
+$(OBJBUILD)/telemark/verify$(OBJ) :                                    \
+                                    diffmeasure/verify.h
+$(OBJBUILD)/telemark/verify$(OBJ) : diffmeasure/verify.c $(BMDEPS)
+	$(COM) -Iautcor00/datasets -Iconven00/datasets -Ifbital00/datasets -Ifft00/datasets -Iviterb00/datasets -Idiffmeasure $(CINCS) $(OBJOUT)"$(OBJBUILD)/telemark/verify$(OBJ)" diffmeasure/verify.c
+
+TELEMARK = \
+    $(OBJBUILD)/telemark/autcor00data_1$(OBJ) \
+    $(OBJBUILD)/telemark/autcor00data_2$(OBJ) \
+    $(OBJBUILD)/telemark/autcor00data_3$(OBJ) \
+    $(OBJBUILD)/telemark/bmark$(LITE)$(OBJ) \
+    $(OBJBUILD)/telemark/conven00data_1$(OBJ) \
+    $(OBJBUILD)/telemark/conven00data_2$(OBJ) \
+    $(OBJBUILD)/telemark/conven00data_3$(OBJ) \
+    $(OBJBUILD)/telemark/fbital00data_2$(OBJ) \
+    $(OBJBUILD)/telemark/fbital00data_3$(OBJ) \
+    $(OBJBUILD)/telemark/fbital00data_6$(OBJ) \
+    $(OBJBUILD)/telemark/fft00data_1$(OBJ) \
+    $(OBJBUILD)/telemark/fft00data_2$(OBJ) \
+    $(OBJBUILD)/telemark/fft00data_3$(OBJ) \
+    $(OBJBUILD)/telemark/viterb00data_1$(OBJ) \
+    $(OBJBUILD)/telemark/viterb00data_2$(OBJ) \
+    $(OBJBUILD)/telemark/viterb00data_3$(OBJ) \
+    $(OBJBUILD)/telemark/viterb00data_4$(OBJ) \
+    $(OBJBUILD)/telemark/autcor00$(OBJ) \
+    $(OBJBUILD)/telemark/conven00$(OBJ) \
+    $(OBJBUILD)/telemark/fbital00$(OBJ) \
+    $(OBJBUILD)/telemark/fft00$(OBJ) \
+    $(OBJBUILD)/telemark/trellis$(OBJ) \
+    $(OBJBUILD)/telemark/viterb00$(OBJ) \
+    $(OBJBUILD)/telemark/verify$(OBJ) 
+
+$(BINBUILD)/telemark$(LITE)$(EXE):  $(TELEMARK) $(THOBJS) 
+	$(LINK) $(EXEOUT)"$(BINBUILD)/telemark$(LITE)$(EXE)" $(TELEMARK) $(THLIB)  
+
+
+targets:: \
+	$(BINBUILD)/telemark$(LITE)$(EXE) 
+
+
@@ -31,6 +31,39 @@
 
 #define     MAX_DATA_SIZE        344   
 
+/*
+ * VITERBI_SOA_ACS: Selects the structure-of-arrays ACS engine. Path metrics
+ * and survivor states are kept in separate arrays, and all 16 butterflies of
+ * the trellis are computed branch-free. SSE2, AVX2 or NEON compare/select on
+ * 16-bit lanes is used when the compiler targets them, otherwise a portable
+ * branch-free C loop is used. The decoded output is identical to the default
+ * array-of-structs engine.
+ */
+#if !defined(VITERBI_SOA_ACS)
+#define VITERBI_SOA_ACS (FALSE)
+#endif
+
+/*
+ * VITERBI_PACKED_SURVIVORS: Selects bit-packed survivor memory. ACS records
+ * one decision bit per state per trellis step, a single 32-bit word per step
+ * for the 32-state trellis, and no longer carries a state history for each
+ * path. The traceback walks the decision words. Applies to either ACS engine
+ * (not to the batched decoder), and the output is unchanged.
+ */
+#if !defined(VITERBI_PACKED_SURVIVORS)
+#define VITERBI_PACKED_SURVIVORS (FALSE)
+#endif
+
+/*
+ * VITERBI_BM_TABLE: Precomputes the 16 branch metrics of each of the 64
+ * possible branch words once, so each trellis step uses a pointer into the
+ * table instead of running FindMetrics. Applies to every decoder in
+ * viterb00.c, and the output is unchanged.
+ */
+#if !defined(VITERBI_BM_TABLE)
+#define VITERBI_BM_TABLE (FALSE)
+#endif
+
 
 /* Compile time Data set select for uuencode: 
  * DATA_1 through DATA_4
@@ -40,7 +73,198 @@
 #define DATA_4
 #endif
 
+/*
+ * VITERBI_MAX_BATCH: the largest number of packets ViterbiDecoderIS136Batch
+ * decodes in one call. Must be a multiple of 8.
+ */
+#define     VITERBI_MAX_BATCH    32
+
+/*
+ * VITERBI_BATCH_BENCH: When TRUE, the benchmark times the batched decoder for
+ * batch sizes of 1, 4, 8, 16 and 32 packets and reports packets per second
+ * for each.
+ */
+#if !defined(VITERBI_BATCH_BENCH)
+#define VITERBI_BATCH_BENCH (FALSE)
+#endif
+
+/*
+ * VITERBI_THREAD_BENCH: When TRUE, after the timed loop the benchmark runs
+ * one decoder context per th_pool_open() thread, for 1 to
+ * VITERBI_MAX_THREADS threads, and reports the aggregate wall-clock packets
+ * per second for each thread count. Needs TH_THREADS.
+ */
+#if !defined(VITERBI_THREAD_BENCH)
+#define VITERBI_THREAD_BENCH (FALSE)
+#endif
+#if VITERBI_THREAD_BENCH && !TH_THREADS
+#error "VITERBI_THREAD_BENCH needs the worker threads of TH_THREADS"
+#endif
+
+#if !defined(VITERBI_MAX_THREADS)
+#define VITERBI_MAX_THREADS 4
+#endif
+
+/*
+ * VITERBI_TRACEBACK_DEPTH: the default traceback depth of the streaming
+ * decoder. About 5 constraint lengths (K=6) is the usual rule, but the
+ * error burst in the toggle data set needs a depth of about 10K for the
+ * streaming result to equal the full-frame decode. VITERBI_MAX_TRACEBACK is
+ * the largest depth ViterbiStreamInit accepts.
+ */
+#define     VITERBI_TRACEBACK_DEPTH  64
+#define     VITERBI_MAX_TRACEBACK    256
+
+/*
+ * VITERBI_STREAM_BENCH: When TRUE, the benchmark decodes the packet with the
+ * streaming decoder, pushing it in chunks of VITERBI_STREAM_CHUNK branch
+ * words, instead of with ViterbiDecoderIS136. The output is checked against
+ * the same golden data.
+ */
+#if !defined(VITERBI_STREAM_BENCH)
+#define VITERBI_STREAM_BENCH (FALSE)
+#endif
+
+#if !defined(VITERBI_STREAM_CHUNK)
+#define VITERBI_STREAM_CHUNK 40
+#endif
+
+/*
+ * VITERBI_METRIC8_BENCH: When TRUE, the benchmark times the packet with the
+ * default 16-bit decoder and then with the 8-bit metric decoder, and reports
+ * packets per second for both. The reported result and output are those of
+ * the 8-bit decoder, checked against the same golden data.
+ */
+#if !defined(VITERBI_METRIC8_BENCH)
+#define VITERBI_METRIC8_BENCH (FALSE)
+#endif
+
+/*
+ * VITERBI_SCALING_BENCH: When TRUE, after the timed loop the benchmark
+ * sweeps packet length (200 to 4096 bits), packets per decode pass and
+ * thread count (1 to VITERBI_MAX_THREADS), decoding random payloads
+ * encoded with conven00's convolutionalEncode through the trellis decoder
+ * set up for the IS-136 code. Each point reports the aggregate decoded
+ * Mbit/s and the time per trellis step of one decoder. Needs TH_THREADS.
+ */
+#if !defined(VITERBI_SCALING_BENCH)
+#define VITERBI_SCALING_BENCH (FALSE)
+#endif
+#if VITERBI_SCALING_BENCH && !TH_THREADS
+#error "VITERBI_SCALING_BENCH needs the worker threads of TH_THREADS"
+#endif
+
+/*
+ * VITERBI_LOOPBACK_BENCH: When TRUE, after the timed loop the benchmark
+ * draws VITERBI_LOOPBACK_PACKETS random packets, encodes them with
+ * conven00's convolutionalEncode using the IS-136 polynomials, sends them
+ * as BPSK through AWGN at each Eb/N0 point from 0 to
+ * VITERBI_LOOPBACK_MAX_EBNO dB, quantizes the received values to the 3-bit
+ * soft branch words and decodes them with ViterbiDecoderIS136. Each point
+ * reports the bit and packet error rates and the encode plus decode
+ * Mbit/s. The run fails if the decoded bit error rate is not below that
+ * of the hard decided code bits at VITERBI_LOOPBACK_MAX_EBNO dB.
+ */
+#if !defined(VITERBI_LOOPBACK_BENCH)
+#define VITERBI_LOOPBACK_BENCH (FALSE)
+#endif
+
+#if !defined(VITERBI_LOOPBACK_PACKETS)
+#define VITERBI_LOOPBACK_PACKETS 2000
+#endif
+
+#if !defined(VITERBI_LOOPBACK_MAX_EBNO)
+#define VITERBI_LOOPBACK_MAX_EBNO 6
+#endif
+
+/*
+ * TRELLIS_MAX_K, TRELLIS_MAX_N: the largest constraint length and number of
+ * code vectors TrellisDecoderInit accepts.
+ */
+#define     TRELLIS_MAX_K    9
+#define     TRELLIS_MAX_N    3
+
+/*
+ * VITERBI_TRELLIS_BENCH: When TRUE, the benchmark decodes the packet with the
+ * generic trellis decoder, set up for the IS-136 code (K=6, generators 0x2B
+ * and 0x3D), instead of with ViterbiDecoderIS136. The output is checked
+ * against the same golden data.
+ */
+#if !defined(VITERBI_TRELLIS_BENCH)
+#define VITERBI_TRELLIS_BENCH (FALSE)
+#endif
+
+/*
+ * VITERBI_TRELLIS_WINDOW, VITERBI_TRELLIS_WARMUP: the traceback window and
+ * warm-up depth the trellis and scaling benchmarks give TrellisSetTraceback.
+ * A window of 0 traces each frame back in one pass.
+ */
+#if !defined(VITERBI_TRELLIS_WINDOW)
+#define VITERBI_TRELLIS_WINDOW 0
+#endif
+
+#if !defined(VITERBI_TRELLIS_WARMUP)
+#define VITERBI_TRELLIS_WARMUP 64
+#endif
+
+
+/*
+ * ViterbiContext, ViterbiBatchContext, ViterbiStream: Opaque decoder state.
+ * Each context owns all of the buffers used by a decode, so separate
+ * contexts can be used from separate threads. The ViterbiDecoderIS136*
+ * entry points use a static default context and are not reentrant.
+ */
+typedef struct ViterbiContext ViterbiContext;
+typedef struct ViterbiBatchContext ViterbiBatchContext;
+typedef struct ViterbiStream ViterbiStream;
+
+ViterbiContext *ViterbiContextInit(void);
+void ViterbiContextFree(ViterbiContext *ctx);
+void ViterbiDecode(ViterbiContext *ctx, e_s16 *EncodedStreamPtr, e_s16 *DecodedStreamPtr);
+
+ViterbiBatchContext *ViterbiBatchContextInit(void);
+void ViterbiBatchContextFree(ViterbiBatchContext *ctx);
+void ViterbiBatchDecode(ViterbiBatchContext *ctx, e_s16 **EncodedStreamPtrs,
+			e_s16 **DecodedStreamPtrs, n_int NumPackets);
+
+ViterbiStream *ViterbiStreamInit(n_int TracebackDepth);
+void ViterbiStreamFree(ViterbiStream *st);
+n_int ViterbiStreamPush(ViterbiStream *st, const e_s16 *BranchWords, n_int NumWords,
+			e_u8 *DecodedBits);
+n_int ViterbiStreamFlush(ViterbiStream *st, n_int Terminated, e_u8 *DecodedBits);
+
+/*
+ * ViterbiContext8: Opaque state of the decoder with 8-bit path metrics.
+ * Same input and output as ViterbiDecode.
+ */
+typedef struct ViterbiContext8 ViterbiContext8;
+
+ViterbiContext8 *ViterbiContext8Init(void);
+void ViterbiContext8Free(ViterbiContext8 *ctx);
+void ViterbiDecode8(ViterbiContext8 *ctx, e_s16 *EncodedStreamPtr, e_s16 *DecodedStreamPtr);
+
+/*
+ * TrellisDecoder: Opaque state of the generic trellis decoder (trellis.c),
+ * which decodes any rate 1/n code with K <= TRELLIS_MAX_K and
+ * n <= TRELLIS_MAX_N from 3-bit soft values.
+ */
+typedef struct TrellisDecoder TrellisDecoder;
+
+TrellisDecoder *TrellisDecoderInit(n_int ConstraintLength, n_int NumberCodeVectors,
+				   const e_u32 *Generators, const e_s16 *SoftWeights,
+				   n_int MaxSteps);
+void TrellisDecoderFree(TrellisDecoder *td);
+void TrellisDecode(TrellisDecoder *td, const e_u8 *Symbols, n_int NumSteps,
+		   n_int Terminated, e_u8 *DataBits);
+void TrellisSetTraceback(TrellisDecoder *td, n_int WindowLength, n_int WarmupDepth);
+void TrellisForward(TrellisDecoder *td, const e_u8 *Symbols, n_int NumSteps);
+n_int TrellisNumWindows(const TrellisDecoder *td);
+void TrellisTraceBack(const TrellisDecoder *td, n_int Terminated, n_int FirstWindow,
+		      n_int NumWindows, e_u8 *DataBits);
 
 void ViterbiDecoderIS136(e_s16 *EncodedStreamPtr, e_s16 *DecodedStreamPtr);
+void ViterbiSelectKernel(void);
+void ViterbiDecoderIS136Batch(e_s16 **EncodedStreamPtrs, e_s16 **DecodedStreamPtrs,
+			      n_int NumPackets);
 
 #endif /* __ALGO_H */
@@ -15,6 +15,10 @@
 #include "therror.h"
 #include <ctype.h> /* isprintf */
 
+#if VITERBI_LOOPBACK_BENCH
+#include <math.h> /* sqrt, log, cos, pow, floor */
+#endif
+
 /*******************************************************************************
     Defines
 *******************************************************************************/
@@ -99,36 +103,52 @@ static TCDef the_tcdef =
 /* encapsulated data */ 
 #ifdef DATA_1 
 #define OUTFILENAME "gettiOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "getti.bin"
+#define REFFILENAME "gett_golden.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "getti.dat"
 };
 static e_s16 test_buf[] = { 
 #include "gett_golden.dat"
-}; 
+};
+#endif
 #elif defined(DATA_2)
 #define OUTFILENAME "toggleiOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "togglei.bin"
+#define REFFILENAME "toggle_golden.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "togglei.dat"
 };
 static e_s16 test_buf[] = { 
 #include "toggle_golden.dat"
-}; 
+};
+#endif
 #elif defined(DATA_3)
 #define OUTFILENAME "onesiOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "onesi.bin"
+#define REFFILENAME "ones_golden.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "onesi.dat"
 };
 static e_s16 test_buf[] = { 
 #include "ones_golden.dat"
-}; 
+};
+#endif
 #else /* default DATA_4 */  
 #define OUTFILENAME "zerosiOutput.dat"
-static  e_s16 input_buf[] = {
+#define INFILENAME  "zerosi.bin"
+#define REFFILENAME "zeros_golden.bin"
+#if !TH_DATA_FILES
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "zerosi.dat"
 };
 static e_s16 test_buf[] = { 
 #include "zeros_golden.dat"
-}; 
+};
+#endif
 #endif /* included data */ 
 
 #define T_INPUT  (MAX_DATA_SIZE*sizeof(e_s16))
@@ -137,6 +157,438 @@ static e_s16 test_buf[] = {
 
 static n_char* g_pchBuf = NULL ; 
 
+#if VITERBI_BATCH_BENCH
+/* Batch sizes timed by the batched decoder benchmark */
+static const n_int batch_sizes[] = { 1, 4, 8, 16, 32 };
+#define NUM_BATCH_SIZES	((n_int)(sizeof(batch_sizes)/sizeof(batch_sizes[0])))
+
+static e_s16 *batch_in[VITERBI_MAX_BATCH];
+static e_s16 *batch_out[VITERBI_MAX_BATCH];
+#endif
+
+#if VITERBI_STREAM_BENCH || VITERBI_TRELLIS_BENCH
+/* Output of the streaming or trellis decoder, one bit per byte */
+static e_u8 stream_bits[MAX_DATA_SIZE];
+#endif
+
+#if VITERBI_TRELLIS_BENCH || VITERBI_SCALING_BENCH
+/* The IS-136 code for the trellis decoder: 1+D+D3+D5 and 1+D2+D3+D4+D5 */
+static const e_u32 is136_generators[2] = { 0x2B, 0x3D };
+
+/* Metric of each 3-bit soft value for a code bit of 0, as in FindMetrics */
+static const e_s16 is136_weights[8] = { -4, -5, -6, -7, 6, 5, 4, 3 };
+#endif
+
+#if VITERBI_TRELLIS_BENCH
+/* Soft values of the packet, two per branch word */
+static e_u8 trellis_symbols[2*MAX_DATA_SIZE];
+#endif
+
+#if VITERBI_THREAD_BENCH
+/* Work for one decoder thread: its own context, input and output */
+typedef struct {
+    ViterbiContext  *ctx;
+    e_s16           *in;
+    e_s16           out[MAX_DATA_SIZE/16+1];
+    size_t          iterations;
+} ThreadJob;
+
+static ThreadJob thread_jobs[VITERBI_MAX_THREADS];
+#endif
+
+#if VITERBI_THREAD_BENCH
+/*
+* FUNC   : thread_decode
+*
+* DESC   : A th_pool_run() part, decodes the packet of job 'part' of the
+*          array job->iterations times.
+*/
+static void thread_decode( void *arg, int part )
+{
+    ThreadJob   *job = (ThreadJob *)arg + part;
+    size_t      loop_cnt;
+
+    for ( loop_cnt = 0; loop_cnt < job->iterations; loop_cnt++ )
+    {
+        ViterbiDecode(job->ctx, job->in, job->out);
+    }
+}
+
+/*
+* FUNC   : thread_bench
+*
+* DESC   : Decodes iterations packets on each of 1..VITERBI_MAX_THREADS
+*          threads and prints the aggregate packets per second. Every
+*          thread's output is checked against the golden data.
+*/
+static void thread_bench( e_s16 *in, e_s16 *golden, size_t iterations )
+{
+    THPool      *pool;
+    n_int       nthreads, t, j;
+    double      t0, t1;
+
+    /* Contexts come from the harness heap, so allocate before threading */
+    for ( t = 0; t < VITERBI_MAX_THREADS; t++ )
+    {
+        thread_jobs[t].ctx        = ViterbiContextInit();
+        thread_jobs[t].in         = in;
+        thread_jobs[t].iterations = iterations;
+        if( thread_jobs[t].ctx == NULL )
+           th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+    }
+
+    for ( nthreads = 1; nthreads <= VITERBI_MAX_THREADS; nthreads++ )
+    {
+        pool = th_pool_open( nthreads );
+        if ( pool == NULL )
+           th_exit( THE_FAILURE, "Cannot create thread %s:%d", __FILE__, __LINE__ );
+        t0 = th_wall_seconds();
+        th_pool_run( pool, thread_decode, thread_jobs );
+        t1 = th_wall_seconds();
+        th_pool_close( pool );
+
+        for ( t = 0; t < nthreads; t++ )
+        {
+            for ( j = 0; j < MAX_DATA_SIZE/16+1; j++ )
+            {
+                if ( thread_jobs[t].out[j] != golden[j] )
+                {
+                    th_printf( ">> Failure: Thread %d At (%d) Actual(%x)!=Golden(%x)\n",
+                               t, j, thread_jobs[t].out[j], golden[j] );
+                    break;
+                }
+            }
+        }
+
+        th_printf( "--  Threads %2d: %12.3f packets/sec\n", nthreads,
+                   t1 > t0 ? (double)iterations * nthreads / (t1 - t0) : 0.0 );
+    }
+
+    for ( t = 0; t < VITERBI_MAX_THREADS; t++ )
+    {
+        ViterbiContextFree( thread_jobs[t].ctx );
+    }
+}
+#endif
+
+#if VITERBI_SCALING_BENCH || VITERBI_LOOPBACK_BENCH
+/* From conven00/conven00.c, which is linked into the viterb00 targets */
+void convolutionalEncode( e_u8 *DataBits, e_s16 DataByteSize, e_s16 NumberCodeVectors,
+                          e_s16 ConstraintLength, e_u8 (*CodeMatrix)[2], e_u8 *BranchWords );
+
+/* The IS-136 generators in conven00's column-wise code matrix form */
+static e_u8 is136_code_matrix[6][2] = {
+    { 1, 1 }, { 1, 0 }, { 0, 1 }, { 1, 1 }, { 0, 1 }, { 1, 1 }
+};
+#endif
+
+#if VITERBI_SCALING_BENCH
+
+/* The sweep: packet lengths in bits, packets per decode pass */
+static const n_int scale_lengths[] = { 200, 344, 512, 1024, 2048, 4096 };
+static const n_int scale_batches[] = { 1, 4, 16 };
+#define NUM_SCALE_LENGTHS   (sizeof(scale_lengths)/sizeof(scale_lengths[0]))
+#define NUM_SCALE_BATCHES   (sizeof(scale_batches)/sizeof(scale_batches[0]))
+#define SCALE_MAX_LENGTH    4096
+#define SCALE_MAX_BATCH     16
+
+/* Work for one scaling thread: its own decoder and output, shared input */
+typedef struct {
+    TrellisDecoder  *td;
+    const e_u8      *symbols;
+    e_u8            *out;
+    n_int           length;
+    n_int           batch;
+    size_t          passes;
+} ScaleJob;
+
+static ScaleJob scale_jobs[VITERBI_MAX_THREADS];
+
+/*
+* FUNC   : scale_decode
+*
+* DESC   : A th_pool_run() part, decodes the batch of packets of job 'part'
+*          of the array job->passes times.
+*/
+static void scale_decode( void *arg, int part )
+{
+    ScaleJob    *job = (ScaleJob *)arg + part;
+    size_t      pass;
+    n_int       b;
+
+    for ( pass = 0; pass < job->passes; pass++ )
+    {
+        for ( b = 0; b < job->batch; b++ )
+        {
+            TrellisDecode( job->td, job->symbols + 2 * b * job->length, job->length,
+                           TRUE, job->out + b * job->length );
+        }
+    }
+}
+
+/*
+* FUNC   : scale_bench
+*
+* DESC   : Sweeps packet length, packets per pass and thread count. Each
+*          point decodes about iterations * MAX_DATA_SIZE bits per thread
+*          and prints the aggregate decoded Mbit/s and the time one decoder
+*          spends per trellis step. Every decoded packet is checked against
+*          its payload.
+*/
+static void scale_bench( size_t iterations )
+{
+    THPool      *pool;
+    e_u8        *payload, *symbols;
+    n_int       l, b, nthreads, t, j, length, batch;
+    size_t      passes;
+    double      t0, t1, bits;
+    e_u32       seed = 1;
+
+    payload = (e_u8 *)th_malloc( SCALE_MAX_BATCH * SCALE_MAX_LENGTH );
+    symbols = (e_u8 *)th_malloc( 2 * SCALE_MAX_BATCH * SCALE_MAX_LENGTH );
+    if( payload == NULL || symbols == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    /* Decoders come from the harness heap, so allocate before threading */
+    for ( t = 0; t < VITERBI_MAX_THREADS; t++ )
+    {
+        scale_jobs[t].td      = TrellisDecoderInit( 6, 2, is136_generators, is136_weights,
+                                                    SCALE_MAX_LENGTH );
+        scale_jobs[t].out     = (e_u8 *)th_malloc( SCALE_MAX_BATCH * SCALE_MAX_LENGTH );
+        scale_jobs[t].symbols = symbols;
+        if( scale_jobs[t].td == NULL || scale_jobs[t].out == NULL )
+           th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+        TrellisSetTraceback( scale_jobs[t].td, VITERBI_TRELLIS_WINDOW, VITERBI_TRELLIS_WARMUP );
+    }
+
+    for ( l = 0; l < (n_int)NUM_SCALE_LENGTHS; l++ )
+    {
+        length = scale_lengths[l];
+
+        /* Random payloads flushed with K-1 zeros, encoded to hard
+         * decision soft values: 3 a strong 1, 4 a strong 0 under
+         * is136_weights */
+        for ( b = 0; b < SCALE_MAX_BATCH; b++ )
+        {
+            for ( j = 0; j < length; j++ )
+            {
+                seed = ( seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+                payload[b * length + j] = (e_u8)( j < length - 5 ? ( seed >> 16 ) & 1 : 0 );
+            }
+            convolutionalEncode( payload + b * length, (e_s16)length, 2, 6,
+                                 is136_code_matrix, symbols + 2 * b * length );
+        }
+        for ( j = 0; j < 2 * SCALE_MAX_BATCH * length; j++ )
+        {
+            symbols[j] = (e_u8)( symbols[j] ? 3 : 4 );
+        }
+
+        for ( b = 0; b < (n_int)NUM_SCALE_BATCHES; b++ )
+        {
+            batch  = scale_batches[b];
+            passes = iterations * MAX_DATA_SIZE / ( length * batch );
+            if ( passes == 0 )
+                passes = 1;
+
+            for ( nthreads = 1; nthreads <= VITERBI_MAX_THREADS; nthreads++ )
+            {
+                for ( t = 0; t < nthreads; t++ )
+                {
+                    scale_jobs[t].length = length;
+                    scale_jobs[t].batch  = batch;
+                    scale_jobs[t].passes = passes;
+                }
+
+                pool = th_pool_open( nthreads );
+                if ( pool == NULL )
+                   th_exit( THE_FAILURE, "Cannot create thread %s:%d", __FILE__, __LINE__ );
+                t0 = th_wall_seconds();
+                th_pool_run( pool, scale_decode, scale_jobs );
+                t1 = th_wall_seconds();
+                th_pool_close( pool );
+
+                for ( t = 0; t < nthreads; t++ )
+                {
+                    for ( j = 0; j < batch * length; j++ )
+                    {
+                        if ( scale_jobs[t].out[j] != payload[j] )
+                        {
+                            th_printf( ">> Failure: Scale %d bits thread %d packet %d bit %d\n",
+                                       length, t, j / length, j % length );
+                            break;
+                        }
+                    }
+                }
+
+                bits = (double)passes * batch * length * nthreads;
+                th_printf( "--  Scale %4d bits x %2d packets, %d threads: %9.3f Mbit/s %8.2f ns/step\n",
+                           length, batch, nthreads,
+                           t1 > t0 ? bits / ( t1 - t0 ) * 1e-6 : 0.0,
+                           ( t1 - t0 ) * 1e9 * nthreads / bits );
+            }
+        }
+    }
+
+    for ( t = 0; t < VITERBI_MAX_THREADS; t++ )
+    {
+        TrellisDecoderFree( scale_jobs[t].td );
+        th_free( scale_jobs[t].out );
+    }
+    th_free( symbols );
+    th_free( payload );
+}
+#endif
+
+#if VITERBI_LOOPBACK_BENCH
+/* The payload of a packet, less the K-1 flush bits */
+#define LOOPBACK_PAYLOAD    (MAX_DATA_SIZE - 5)
+
+/*
+* FUNC   : loopback_random
+*
+* DESC   : Linear congruential generator, 15 random bits per call.
+*/
+static n_int loopback_random( e_u32 *seed )
+{
+    *seed = ( *seed * 1103515245UL + 12345UL ) & 0xffffffffUL;
+    return (n_int)( ( *seed >> 16 ) & 0x7fff );
+}
+
+/*
+* FUNC   : loopback_gauss
+*
+* DESC   : Box-Muller, a normal deviate of zero mean and unit variance.
+*/
+static double loopback_gauss( e_u32 *seed )
+{
+    double u1, u2;
+
+    u1 = ( loopback_random( seed ) + 1.0 ) / 32768.0;
+    u2 = loopback_random( seed ) / 32768.0;
+    return sqrt( -2.0 * log( u1 ) ) * cos( 6.283185307179586 * u2 );
+}
+
+/*
+* FUNC   : loopback_bench
+*
+* DESC   : Encodes VITERBI_LOOPBACK_PACKETS random packets, then for each
+*          Eb/N0 point adds white Gaussian noise to the BPSK code bits,
+*          +1 for a 0 and -1 for a 1, quantizes them to 3 bits in steps of
+*          half the amplitude, packs y0 and y1 into branch words and
+*          decodes them. The branch values follow FindMetrics: 0 to 3 a
+*          1 and 4 to 7 a 0, the most confident 3 and 4 (see
+*          is136_weights). The noise is scaled for the energy per payload
+*          bit, so counts the flush bits as overhead. Prints the bit error
+*          rate of the hard decided code bits, the bit and packet error
+*          rates of the decoded payloads and the encode plus decode Mbit/s
+*          of payload.
+*
+* RETURNS: Failure, after a failure line, if the decoded bit error rate
+*          is not below the raw one at VITERBI_LOOPBACK_MAX_EBNO dB
+*/
+static int loopback_bench( void )
+{
+    e_u8        *payload, *code;
+    e_s16       *branch, *decoded;
+    n_int       p, j, ebno, q, bit, bit_errors, packet_errors, errors, raw_errors;
+    size_t      encode_ticks, decode_ticks;
+    double      sigma, y, raw_ber = 0.0, ber = 0.0;
+    e_u32       seed = 1;
+
+    payload = (e_u8 *)th_malloc( (size_t)VITERBI_LOOPBACK_PACKETS * MAX_DATA_SIZE );
+    code    = (e_u8 *)th_malloc( (size_t)VITERBI_LOOPBACK_PACKETS * 2 * MAX_DATA_SIZE );
+    branch  = (e_s16 *)th_malloc( (size_t)VITERBI_LOOPBACK_PACKETS * MAX_DATA_SIZE * sizeof(e_s16) );
+    decoded = (e_s16 *)th_malloc( (size_t)VITERBI_LOOPBACK_PACKETS * (MAX_DATA_SIZE/16+1) * sizeof(e_s16) );
+    if( payload == NULL || code == NULL || branch == NULL || decoded == NULL )
+       th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+    /* Random payloads, flushed back to state 0 */
+    for ( p = 0; p < VITERBI_LOOPBACK_PACKETS; p++ )
+    {
+        for ( j = 0; j < MAX_DATA_SIZE; j++ )
+        {
+            payload[p * MAX_DATA_SIZE + j] =
+                (e_u8)( j < LOOPBACK_PAYLOAD ? loopback_random( &seed ) & 1 : 0 );
+        }
+    }
+
+    th_signal_start();
+    for ( p = 0; p < VITERBI_LOOPBACK_PACKETS; p++ )
+    {
+        convolutionalEncode( payload + p * MAX_DATA_SIZE, MAX_DATA_SIZE, 2, 6,
+                             is136_code_matrix, code + 2 * p * MAX_DATA_SIZE );
+    }
+    encode_ticks = th_signal_finished();
+
+    for ( ebno = 0; ebno <= VITERBI_LOOPBACK_MAX_EBNO; ebno++ )
+    {
+        /* Es = 1, Eb = 2 * MAX_DATA_SIZE / LOOPBACK_PAYLOAD and sigma^2 = N0 / 2 */
+        sigma = sqrt( (double)MAX_DATA_SIZE / ( LOOPBACK_PAYLOAD * pow( 10.0, ebno / 10.0 ) ) );
+        raw_errors = 0;
+        for ( j = 0; j < VITERBI_LOOPBACK_PACKETS * MAX_DATA_SIZE; j++ )
+        {
+            branch[j] = 0;
+            for ( bit = 0; bit < 2; bit++ )
+            {
+                y = ( code[2 * j + bit] ? -1.0 : 1.0 ) + sigma * loopback_gauss( &seed );
+                /* the level of y, 0 below -1.5 to 7 from +1.5, as the
+                 * branch value of its side, the level furthest out the
+                 * most confident 3 or 4 */
+                q = (n_int)floor( 2.0 * y ) + 4;
+                q = q < 0 ? 0 : q > 7 ? 7 : q;
+                q = q < 4 ? 3 - q : 11 - q;
+                raw_errors += ( q < 4 ) != code[2 * j + bit];
+                branch[j] |= (e_s16)( q << ( 3 - 3 * bit ) );
+            }
+        }
+
+        th_signal_start();
+        for ( p = 0; p < VITERBI_LOOPBACK_PACKETS; p++ )
+        {
+            ViterbiDecoderIS136( branch + p * MAX_DATA_SIZE, decoded + p * (MAX_DATA_SIZE/16+1) );
+        }
+        decode_ticks = th_signal_finished();
+
+        bit_errors    = 0;
+        packet_errors = 0;
+        for ( p = 0; p < VITERBI_LOOPBACK_PACKETS; p++ )
+        {
+            errors = 0;
+            for ( j = 0; j < LOOPBACK_PAYLOAD; j++ )
+            {
+                bit = ( decoded[p * (MAX_DATA_SIZE/16+1) + ( j >> 4 )] >> ( 15 - ( j & 15 ) ) ) & 1;
+                errors += bit != payload[p * MAX_DATA_SIZE + j];
+            }
+            bit_errors    += errors;
+            packet_errors += errors != 0;
+        }
+
+        raw_ber = (double)raw_errors / ( 2.0 * VITERBI_LOOPBACK_PACKETS * MAX_DATA_SIZE );
+        ber     = (double)bit_errors / ( (double)VITERBI_LOOPBACK_PACKETS * LOOPBACK_PAYLOAD );
+        th_printf( "--  Loopback Eb/N0 %2d dB: raw BER %.3e BER %.3e (%d/%ld) PER %.3e %9.3f Mbit/s\n",
+                   ebno, raw_ber, ber, bit_errors, (long)VITERBI_LOOPBACK_PACKETS * LOOPBACK_PAYLOAD,
+                   (double)packet_errors / VITERBI_LOOPBACK_PACKETS,
+                   encode_ticks + decode_ticks ?
+                   (double)VITERBI_LOOPBACK_PACKETS * LOOPBACK_PAYLOAD * th_ticks_per_sec() /
+                   ( encode_ticks + decode_ticks ) * 1e-6 : 0.0 );
+    }
+
+    th_free( decoded );
+    th_free( branch );
+    th_free( code );
+    th_free( payload );
+
+    /* the decoder has to gain on the hard decided code bits */
+    if ( ber > 0.0 && ber >= raw_ber )
+    {
+        th_printf( "--  Failure: Loopback BER %.3e not below raw BER %.3e at %d dB\n",
+                   ber, raw_ber, VITERBI_LOOPBACK_MAX_EBNO );
+        return Failure;
+    }
+    return Success;
+}
+#endif
+
 /*
 * FUNC   : t_run_test
 * 
@@ -170,31 +622,59 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
     n_int           i;
 	size_t          loop_cnt;
 	e_s16			*golden_result; 
-#if	!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
-    e_u8			*out_symbol_buffer; 
-    e_s8			*stringHeadPtr; /* changed 2-14-00 arw picky compilers */
-	n_char			*tmp_buf;
-    n_int           TempVal;
+#if	TH_DATA_FILES
+	size_t			in_size, golden_size, Blocks, Block;
+#endif
+#if VITERBI_BATCH_BENCH
+	n_int			b, n, j;
+	size_t			duration;
+#elif VITERBI_STREAM_BENCH
+	ViterbiStream	*stream;
+	n_int			n, j, NumBits = 0;
+#elif VITERBI_TRELLIS_BENCH
+	TrellisDecoder	*trellis;
+	n_int			j;
+#elif VITERBI_METRIC8_BENCH
+	ViterbiContext8	*ctx8;
+	size_t			duration;
+	n_int			j;
+#endif
+#if VITERBI_LOOPBACK_BENCH
+	int				loopback_rv;
+	int				rv;
 #endif
 
    /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     * First, initialize the data structures we need for the test
     */
 	argv=argv;
-	golden_result	= (e_s16 *)&test_buf; 
 	outFilename		= OUTFILENAME;
 
+#if	TH_DATA_FILES
+   /* The data set comes from files, the branch words of MAX_DATA_SIZE bit
+    * packets and the golden decoded words of each. The decoder takes one
+    * packet per iteration, the other benchmarks the first.
+    */
+    BranchWords	 = (e_s16 *)th_get_data_file( TH_DATA_INPUT, INFILENAME, sizeof(e_s16), &in_size );
+	golden_result = (e_s16 *)th_get_data_file( TH_DATA_GOLDEN, REFFILENAME, sizeof(e_s16), &golden_size );
+	Blocks = in_size / MAX_DATA_SIZE;
+	if ( in_size % MAX_DATA_SIZE != 0 || golden_size < Blocks * (MAX_DATA_SIZE/16+1) )
+		th_exit( THE_BAD_SIZE, "Data set of %ld words with %ld golden words is not of %d bit packets",
+			(long)in_size, (long)golden_size, MAX_DATA_SIZE );
+#else
+	golden_result	= (e_s16 *)&test_buf; 
 
    /* When this is defined no file uploading necesary
     * we have all the data in the executable
 	* so initialising is simplier
 	*/ 
+    BranchWords	 = (e_s16 *)&input_buf; 
+#endif
 
 	g_pchBuf     = (n_char *) th_malloc( T_BSIZE );
     if( g_pchBuf == NULL )
        th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
 
-    BranchWords	 = (e_s16 *)&input_buf; 
     DataBits     = (e_s16 *)g_pchBuf;
 	DataByteSize = MAX_DATA_SIZE;  
 
@@ -203,30 +683,233 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 		th_printf( "WARNING: Missing output filename  Using: %s\n",outFilename);
 	}
 
+   ViterbiSelectKernel();  /* pick the kernel variants, see th_kernel_select() */
+
    /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
     * This is the actual benchmark
     *---------------------------------------------------------------------------*/
 
+#if VITERBI_BATCH_BENCH
+   for ( n = 0; n < VITERBI_MAX_BATCH; n++ )
+   {
+       batch_in[n]  = BranchWords;
+       batch_out[n] = (e_s16 *)th_malloc( (MAX_DATA_SIZE/16+1)*sizeof(e_s16) );
+       if( batch_out[n] == NULL )
+          th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+   }
+
+   for ( b = 0; b < NUM_BATCH_SIZES; b++ )
+   {
+       th_latency_begin( iterations );
+       th_signal_start();  /* Tell the host that the test has begun */
+
+       for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
+       {
+           ViterbiDecoderIS136Batch(batch_in, batch_out, batch_sizes[b]);
+           th_latency_mark();
+       }
+
+       duration = th_signal_finished();  /* signal that we are finished */
+
+       /* Every packet of the batch must match the single packet decoder */
+       for ( n = 0; n < batch_sizes[b]; n++ )
+       {
+           for ( j = 0; j < MAX_DATA_SIZE/16+1; j++ )
+           {
+               if ( batch_out[n][j] != golden_result[j] )
+               {
+                   th_printf( ">> Failure: Batch %d packet %d At (%d) Actual(%x)!=Golden(%x)\n",
+                              batch_sizes[b], n, j, batch_out[n][j], golden_result[j] );
+                   break;
+               }
+           }
+       }
+
+       th_printf( "--  Batch %2d: %12.3f packets/sec\n", batch_sizes[b],
+                  duration ? (double)iterations * batch_sizes[b] *
+                  th_ticks_per_sec() / duration : 0.0 );
+   }
+
+   /* The reported duration, checks and output are from the last batch */
+   results.duration   = duration;
+   results.iterations = iterations;
+
+   for ( j = 0; j < MAX_DATA_SIZE/16+1; j++ )
+   {
+       DataBits[j] = batch_out[0][j];
+   }
+   for ( n = 0; n < VITERBI_MAX_BATCH; n++ )
+   {
+       th_free( batch_out[n] );
+   }
+#elif VITERBI_STREAM_BENCH
+   stream = ViterbiStreamInit( VITERBI_TRACEBACK_DEPTH );
+   if( stream == NULL )
+      th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+   th_latency_begin( iterations );
+   th_signal_start();  /* Tell the host that the test has begun */
+
+   for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
+   {
+       NumBits = 0;
+       for ( n = 0; n < MAX_DATA_SIZE; n += VITERBI_STREAM_CHUNK )
+       {
+           NumBits += ViterbiStreamPush( stream, BranchWords + n,
+                         MAX_DATA_SIZE - n < VITERBI_STREAM_CHUNK ? MAX_DATA_SIZE - n : VITERBI_STREAM_CHUNK,
+                         stream_bits + NumBits );
+       }
+       NumBits += ViterbiStreamFlush( stream, TRUE, stream_bits + NumBits );
+       th_latency_mark();
+   }
+
+   results.duration   = th_signal_finished();  /* signal that we are finished */
+
+   results.iterations = iterations;
+
+   ViterbiStreamFree( stream );
+
+   /* Pack the bits 16 to a word, MSB first, as ViterbiDecoderIS136 does */
+   for ( j = 0; j < MAX_DATA_SIZE/16+1; j++ )
+   {
+       DataBits[j] = 0;
+   }
+   for ( j = 0; j < NumBits; j++ )
+   {
+       if ( stream_bits[j] )
+          DataBits[j >> 4] |= (e_s16)(0x8000 >> (j & 15));
+   }
+#elif VITERBI_TRELLIS_BENCH
+   trellis = TrellisDecoderInit( 6, 2, is136_generators, is136_weights, MAX_DATA_SIZE );
+   if( trellis == NULL )
+      th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+   TrellisSetTraceback( trellis, VITERBI_TRELLIS_WINDOW, VITERBI_TRELLIS_WARMUP );
+
+   th_latency_begin( iterations );
+   th_signal_start();  /* Tell the host that the test has begun */
+
+   for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
+   {
+       /* Unpack the branch words as part of the decode, y0 in bits 5..3 */
+       for ( j = 0; j < MAX_DATA_SIZE; j++ )
+       {
+           trellis_symbols[2*j]   = (e_u8)((BranchWords[j] >> 3) & 7);
+           trellis_symbols[2*j+1] = (e_u8)(BranchWords[j] & 7);
+       }
+       TrellisDecode( trellis, trellis_symbols, MAX_DATA_SIZE, TRUE, stream_bits );
+       th_latency_mark();
+   }
+
+   results.duration   = th_signal_finished();  /* signal that we are finished */
+
+   results.iterations = iterations;
+
+   TrellisDecoderFree( trellis );
+
+   /* Pack the bits 16 to a word, MSB first, as ViterbiDecoderIS136 does */
+   for ( j = 0; j < MAX_DATA_SIZE/16+1; j++ )
+   {
+       DataBits[j] = 0;
+   }
+   for ( j = 0; j < MAX_DATA_SIZE; j++ )
+   {
+       if ( stream_bits[j] )
+          DataBits[j >> 4] |= (e_s16)(0x8000 >> (j & 15));
+   }
+#elif VITERBI_METRIC8_BENCH
+   ctx8 = ViterbiContext8Init();
+   if( ctx8 == NULL )
+      th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+
+   th_signal_start();  /* Tell the host that the test has begun */
+
+   for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
+   {
+       ViterbiDecoderIS136(BranchWords, DataBits);
+   }
+
+   duration = th_signal_finished();  /* signal that we are finished */
+
+   th_printf( "--  16-bit metrics: %12.3f packets/sec\n",
+              duration ? (double)iterations * th_ticks_per_sec() / duration : 0.0 );
+
+   th_latency_begin( iterations );
+   th_signal_start();  /* Tell the host that the test has begun */
+
+   for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
+   {
+       ViterbiDecode8(ctx8, BranchWords, DataBits);
+       th_latency_mark();
+   }
+
+   results.duration   = th_signal_finished();  /* signal that we are finished */
+
+   results.iterations = iterations;
+
+   th_printf( "--   8-bit metrics: %12.3f packets/sec\n",
+              results.duration ? (double)iterations * th_ticks_per_sec() / results.duration : 0.0 );
+
+   for ( j = 0; j < MAX_DATA_SIZE/16+1; j++ )
+   {
+       if ( DataBits[j] != golden_result[j] )
+       {
+           th_printf( ">> Failure: 8-bit metrics At (%d) Actual(%x)!=Golden(%x)\n",
+                      j, DataBits[j], golden_result[j] );
+           break;
+       }
+   }
+
+   ViterbiContext8Free( ctx8 );
+#else
+   th_latency_begin( iterations );
    th_signal_start();  /* Tell the host that the test has begun */
 
    for ( loop_cnt = 0; loop_cnt < iterations; loop_cnt++ )  /* no stopping! */
    {
+#if	TH_DATA_FILES
+       ViterbiDecoderIS136(BranchWords + ( loop_cnt % Blocks ) * MAX_DATA_SIZE, DataBits);
+#else
        ViterbiDecoderIS136(BranchWords, DataBits);
+#endif
+       th_latency_mark();
    }
 
    results.duration   = th_signal_finished();  /* signal that we are finished */
 
    results.iterations = iterations;
+
+#if	TH_DATA_FILES
+   /* Check, and bench further, the packet of the last iteration */
+   Block          = iterations > 0 ? ( iterations - 1 ) % Blocks : 0;
+   BranchWords   += Block * MAX_DATA_SIZE;
+   golden_result += Block * (MAX_DATA_SIZE/16+1);
+#endif
+#endif
+
+#if VITERBI_THREAD_BENCH
+   thread_bench( BranchWords, golden_result, iterations );
+#endif
+#if VITERBI_SCALING_BENCH
+   scale_bench( iterations );
+#endif
+#if VITERBI_LOOPBACK_BENCH
+   loopback_rv = loopback_bench();
+#endif
    results.v1         = 0;
    results.v2         = 0;
    results.v3         = 0;
    results.v4         = 0;
    results.info       = info;
+   results.verify_snr = FALSE;
 
+#if VITERBI_BATCH_BENCH
+   th_sprintf( info, "%d packets per iteration", batch_sizes[NUM_BATCH_SIZES-1] );
+#else
    th_sprintf( info, "A note of basic info" );
+#endif
 
 #if	NON_INTRUSIVE_CRC_CHECK
-	results.CRC = 0;
+	results.CRC = Calc_crc_buf16( (const e_u16 *)DataBits, MAX_DATA_SIZE/16+1, 0 );
 #elif	CRC_CHECK
 	results.CRC=0;
 #else
@@ -236,10 +919,6 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 
 	/* Verification */
    for( i=0; i<MAX_DATA_SIZE/16+1; i++ ){
-
-#if	NON_INTRUSIVE_CRC_CHECK
-	  results.CRC = Calc_crc16((e_u16)DataBits[i],results.CRC);
-#endif
 		if(DataBits[i] != golden_result[i]){
 		th_printf(">> Failure: At (%d) Actual(%x)!=Golden(%x)\n",i,DataBits[i],golden_result[i]); 
 		results.v1         = i;
@@ -255,71 +934,30 @@ int t_run_test( size_t iterations, int argc, const char* argv[] )
 	}
 
 #if	!CRC_CHECK && !NON_INTRUSIVE_CRC_CHECK
-   /* Calculate the size of the output buffer */ 
-
-   TempVal   = 0;             /* reuse this variable as a counter */ 
-
-   tmp_buf   = (n_char *)th_malloc(16); /* should acommodate largest single token */
-
-   if( tmp_buf == NULL )
-
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
-
-
-
-   
-
-    for( i=0; i<MAX_DATA_SIZE/16+1; i++ ){
-
-       TempVal += th_sprintf( tmp_buf, "%04x ", DataBits[i]&0xffff);
-
-    }
-
-	
-
-    for( i=0; i<MAX_DATA_SIZE/16+1; i++ ){
-
-	   n_char c1 = (DataBits[i]&0xff00)>>8;
-
-	   n_char c2 = (DataBits[i]&0xff);
-
-	   TempVal += th_sprintf( tmp_buf,(c1 >= ' ' && c1 <= '~') ? "%c" : "<%02x>", c1 & 0x0ff);
-
-	   TempVal += th_sprintf( tmp_buf,(c1 >= ' ' && c1 <= '~') ? "%c" : "<%02x>", c2 & 0x0ff);
-
-    }
-
-    TempVal += 2; 
-
-   th_free(tmp_buf); 
-
-
-
-    out_symbol_buffer  = (e_u8 *)th_malloc(TempVal+1);
-	if( out_symbol_buffer == NULL )
-            th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
-
-    stringHeadPtr = (e_s8 *)out_symbol_buffer; 
-    for( i=0; i<MAX_DATA_SIZE/16+1; i++ ){
-       stringHeadPtr += th_sprintf( (char *)stringHeadPtr, "%04x ", DataBits[i]&0xffff);
-    }
-	stringHeadPtr += th_sprintf( (char *)stringHeadPtr, "\n"); 
+   /* Stream the output to the host as it is formatted */
+   th_file_begin( outFilename );
+   for( i=0; i<MAX_DATA_SIZE/16+1; i++ ){
+       th_file_printf( "%04x ", DataBits[i]&0xffff);
+   }
+   th_file_printf( "\n");
 
 	/* Now print as ascii */
-    for( i=0; i<MAX_DATA_SIZE/16+1; i++ ){
+   for( i=0; i<MAX_DATA_SIZE/16+1; i++ ){
 	   n_char c1 = (DataBits[i]&0xff00)>>8;
 	   n_char c2 = (DataBits[i]&0xff);
-	   stringHeadPtr += th_sprintf( (char *)stringHeadPtr, 
-	    (isprint(c1)) ? "%c" : "<%02x>", c1 & 0x0ff);
-	   stringHeadPtr += th_sprintf( (char *)stringHeadPtr, 
-	    (isprint(c2)) ? "%c" : "<%02x>", c2 & 0x0ff);
-    }
-    stringHeadPtr += th_sprintf( (char *)stringHeadPtr, "\n");
-
-    th_send_buf_as_file((const char *)out_symbol_buffer,TempVal,outFilename);
+	   th_file_printf( (isprint(c1)) ? "%c" : "<%02x>", c1 & 0x0ff);
+	   th_file_printf( (isprint(c2)) ? "%c" : "<%02x>", c2 & 0x0ff);
+   }
+   th_file_printf( "\n");
+   th_file_end();
 #endif
 
+#if VITERBI_LOOPBACK_BENCH
+	   rv = th_report_results( &results, EXPECTED_CRC );
+	   return rv == Success ? loopback_rv : rv;
+#else
 	   return th_report_results( &results, EXPECTED_CRC );
+#endif
 }
 
 /*
@@ -65,7 +65,8 @@ TCDef the_tcdef =
 	0,
 	0,
 	0,
-	0
+	0,
+	FALSE
 }; 
 
 /*------------------------------------------------------------------------------
@@ -86,28 +87,28 @@ TCDef the_tcdef =
 
 /* encapsulated data */ 
 #if defined(DATA_1)
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "getti.dat"
 };
 static e_s16 test_buf[] = { 
 #include "gett_golden.dat"
 }; 
 #elif defined(DATA_2)
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "togglei.dat"
 };
 static e_s16 test_buf[] = { 
 #include "toggle_golden.dat"
 }; 
 #elif defined(DATA_3)
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "onesi.dat"
 };
 static e_s16 test_buf[] = { 
 #include "ones_golden.dat"
 }; 
 #else /* default DATA_4 */  
-static  e_s16 input_buf[] = {
+static EE_ALIGN( EE_SIMD_ALIGN ) e_s16 input_buf[] = {
 #include "zerosi.dat"
 };
 static e_s16 test_buf[] = { 
@@ -174,22 +175,26 @@ int t_run_test( TCDef *tcdef,int argc, const char *argv[] )
 	DataByteSize = MAX_DATA_SIZE;  
 
 
+   ViterbiSelectKernel();  /* pick the kernel variants, see th_kernel_select() */
+
    /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
     * This is the actual benchmark
     *---------------------------------------------------------------------------*/
 
+   th_latency_begin( tcdef->rec_iterations );
    th_signal_start();  /* Tell the host that the test has begun */
 
    for ( loop_cnt = 0; loop_cnt < tcdef->rec_iterations ; loop_cnt++ )  /* no stopping! */
    {
        ViterbiDecoderIS136(BranchWords, DataBits);
+       th_latency_mark();
    }
 
     tcdef->duration		= th_signal_finished() ;
 	tcdef->iterations	= tcdef->rec_iterations;
 
 #if	NON_INTRUSIVE_CRC_CHECK
-	tcdef->CRC = 0;
+	tcdef->CRC = Calc_crc_buf16( (const e_u16 *)DataBits, MAX_DATA_SIZE/16+1, 0 );
 #elif	CRC_CHECK
 	tcdef->CRC=0;
 #else
@@ -199,10 +204,6 @@ int t_run_test( TCDef *tcdef,int argc, const char *argv[] )
 
 	/* Verification */
    for( i=0; i<MAX_DATA_SIZE/16+1; i++ ){
-
-#if	NON_INTRUSIVE_CRC_CHECK
-	  tcdef->CRC = Calc_crc16((e_u16)DataBits[i],tcdef->CRC);
-#endif
 		if(DataBits[i] != golden_result[i]){
 		th_printf(">> Failure: At (%d) Actual(%x)!=Golden(%x)\n",i,DataBits[i],golden_result[i]); 
 		tcdef->v1         = i;
@@ -0,0 +1,402 @@
+/**
+ *
+ * Copyright (C) EEMBC(R) All Rights Reserved
+ *
+ * This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+ * Please refer to the license file (LICENSE.md) included with this code.
+ *
+ */
+
+/*******************************************************************************
+    Includes
+*******************************************************************************/
+
+#include "algo.h"
+
+/*
+ * Generic trellis decoder
+ *
+ * Decodes a rate 1/n convolutional code of constraint length K described the
+ * same way as conven00's convolutionalEncode(): code vector v taps shift
+ * register stage j when bit j of Generators[v] is set (CodeMatrix[j][v] in
+ * conven00), stage 0 holding the newest input bit.
+ *
+ * The state is the last K-1 input bits, newest in bit 0, so the successors
+ * of state i and i + NumStates/2 are 2i and 2i+1, exactly as in the IS-136
+ * decoder. The branch output of every transition is tabulated from the
+ * generators when the decoder is created.
+ *
+ * The input is one 3-bit soft value per code bit, n values per trellis step,
+ * whose meaning the SoftWeights of TrellisDecoderInit set. With the default
+ * linear weights 0 is a strong 1 and 7 a strong 0. The weights of viterb00's
+ * FindMetrics, { -4, -5, -6, -7, 6, 5, 4, 3 }, make 0 to 3 a 1 and 4 to 7 a
+ * 0, with 3 and 4 the strongest and 0 and 7 the weakest. The output is one
+ * decoded bit per byte, the format of conven00's DataBits.
+ *
+ * The step function is chosen when the decoder is created. Kernels for the
+ * common codes (K = 5, 7, 9 at rates 1/2 and 1/3, and the IS-136 K = 6 rate
+ * 1/2 code) are instantiated from one macro with K and n as constants, so the
+ * compiler can fully unroll the branch metric and butterfly loops. Any other
+ * code uses the same macro instantiated with run-time K and n.
+ *
+ * The traceback of a long frame is a serial chain of dependent loads. With
+ * TrellisSetTraceback the frame is cut into windows which are traced
+ * independently, each from an arbitrary state over a warm-up depth, so the
+ * windows can be traced in lockstep or on separate threads and the latency
+ * is bounded by the window rather than the frame length.
+ */
+
+/*
+ * TRELLIS_MAX_STATES: 2^(TRELLIS_MAX_K-1).
+ */
+#define		TRELLIS_MAX_STATES	(1 << (TRELLIS_MAX_K - 1))
+
+/*
+ * TRELLIS_TB_LANES: The number of traceback windows traced in lockstep.
+ */
+#define		TRELLIS_TB_LANES	4
+
+/*
+ * The path metrics are renormalized every TRELLIS_RENORM_INTERVAL steps by
+ * subtracting the metric of state 0. States other than 0 start at
+ * TRELLIS_START_METRIC, so the first K-1 steps only extend paths from state 0.
+ */
+#define		TRELLIS_RENORM_INTERVAL	64
+#define		TRELLIS_START_METRIC	(-0x1000)
+
+typedef void (*TrellisStepFn)(TrellisDecoder *td, const e_u8 *pSymbols,
+			      e_u32 *pDecision);
+
+/*
+ * TrellisDecoder: The code tables and all of the decoder state.
+ */
+struct TrellisDecoder {
+    n_int ConstraintLength;			/* K */
+    n_int NumberCodeVectors;			/* n */
+    n_int NumStates;				/* 2^(K-1) */
+    n_int MaxSteps;				/* capacity of Decisions */
+    n_int DecisionWords;			/* e_u32 words per step */
+    n_int Steps;				/* length of the last frame */
+    n_int Window;				/* traceback window, 0 for the frame */
+    n_int Warmup;				/* traceback warm-up depth */
+    TrellisStepFn Step;
+
+    /*
+     * OutIdx[r]: the code bits (bit v for code vector v) sent for shift
+     * register contents r; r = (state << 1) | input.
+     */
+    e_u8 OutIdx[2 * TRELLIS_MAX_STATES];
+
+    /*
+     * SoftWeight[y]: metric contribution of soft value y to a code bit of 0.
+     * A code bit of 1 contributes -SoftWeight[y].
+     */
+    e_s16 SoftWeight[8];
+
+    e_s16 BranchMetric[1 << TRELLIS_MAX_N];
+    e_s16 PathMetric[2][TRELLIS_MAX_STATES];
+    n_int BufSelector;
+
+    e_u32 *Decisions;		/* MaxSteps * DecisionWords */
+};
+
+/*
+ * TRELLIS_STEP: Defines a step function for a code of K (constraint length)
+ * and N (code vectors). K and N may be constants or expressions on td.
+ *
+ * For every combination c of code bits the branch metric is computed once,
+ * then every butterfly does two lookups per successor. On a tie the upper
+ * predecessor wins, as in the IS-136 decoder.
+ */
+#define	TRELLIS_STEP(NAME, K, N)						\
+static void NAME(TrellisDecoder *td, const e_u8 *pSymbols, e_u32 *pDecision)	\
+{										\
+    n_int i, v, c, s;								\
+    e_s16 esSum, esMetric1, esMetric2;						\
+    e_s16 *pBM = td->BranchMetric;						\
+    const e_u8 *pOutIdx = td->OutIdx;						\
+    e_s16 *pIn  = td->PathMetric[td->BufSelector];				\
+    e_s16 *pOut = td->PathMetric[1 - td->BufSelector];				\
+										\
+    td->BufSelector ^= 1;							\
+										\
+    for (c = 0; c < (1 << (N)); c++) {						\
+	esSum = 0;								\
+	for (v = 0; v < (N); v++) {						\
+	    if ((c >> v) & 1)							\
+		esSum -= td->SoftWeight[pSymbols[v] & 7];			\
+	    else								\
+		esSum += td->SoftWeight[pSymbols[v] & 7];			\
+	}									\
+	pBM[c] = esSum;								\
+    }										\
+										\
+    for (i = 0; i < ((1 << ((K) - 1)) + 31) / 32; i++)				\
+	pDecision[i] = 0;							\
+										\
+    for (i = 0; i < (1 << ((K) - 2)); i++) {					\
+	s = 2*i;								\
+	esMetric1 = pIn[i] + pBM[pOutIdx[s]];					\
+	esMetric2 = pIn[i + (1 << ((K) - 2))] + pBM[pOutIdx[s + (1 << ((K) - 1))]];	\
+	pOut[s] = (esMetric1 >= esMetric2) ? esMetric1 : esMetric2;		\
+	pDecision[s >> 5] |= (e_u32)(esMetric2 > esMetric1) << (s & 31);	\
+										\
+	s = 2*i + 1;								\
+	esMetric1 = pIn[i] + pBM[pOutIdx[s]];					\
+	esMetric2 = pIn[i + (1 << ((K) - 2))] + pBM[pOutIdx[s + (1 << ((K) - 1))]];	\
+	pOut[s] = (esMetric1 >= esMetric2) ? esMetric1 : esMetric2;		\
+	pDecision[s >> 5] |= (e_u32)(esMetric2 > esMetric1) << (s & 31);	\
+    }										\
+}
+
+TRELLIS_STEP(TrellisStepK5R2, 5, 2)
+TRELLIS_STEP(TrellisStepK6R2, 6, 2)
+TRELLIS_STEP(TrellisStepK7R2, 7, 2)
+TRELLIS_STEP(TrellisStepK9R2, 9, 2)
+TRELLIS_STEP(TrellisStepK5R3, 5, 3)
+TRELLIS_STEP(TrellisStepK7R3, 7, 3)
+TRELLIS_STEP(TrellisStepK9R3, 9, 3)
+TRELLIS_STEP(TrellisStepGeneric, td->ConstraintLength, td->NumberCodeVectors)
+
+/*
+ * TrellisKernels: The specialized step functions, by K and n.
+ */
+static const struct {
+    n_int K;
+    n_int N;
+    TrellisStepFn Step;
+} TrellisKernels[] = {
+    { 5, 2, TrellisStepK5R2 },
+    { 6, 2, TrellisStepK6R2 },
+    { 7, 2, TrellisStepK7R2 },
+    { 9, 2, TrellisStepK9R2 },
+    { 5, 3, TrellisStepK5R3 },
+    { 7, 3, TrellisStepK7R3 },
+    { 9, 3, TrellisStepK9R3 },
+};
+
+/*
+ * FUNC: TrellisDecoderInit
+ *
+ * DESC: Creates a decoder for the code with constraint length K
+ * (3..TRELLIS_MAX_K) and NumberCodeVectors generators (1..TRELLIS_MAX_N),
+ * able to decode frames of up to MaxSteps trellis steps. SoftWeights, if not
+ * NULL, gives the metric of each 3-bit soft value for a code bit of 0;
+ * otherwise the linear weights 2y-7 are used.
+ *
+ * RETURNS: The new decoder, or NULL if the code is out of range or the
+ * allocation failed.
+ */
+TrellisDecoder *TrellisDecoderInit(n_int ConstraintLength, n_int NumberCodeVectors,
+				   const e_u32 *Generators, const e_s16 *SoftWeights,
+				   n_int MaxSteps)
+{
+    TrellisDecoder *td;
+    n_int r, v, j, c;
+    size_t k;
+
+    if (ConstraintLength < 3 || ConstraintLength > TRELLIS_MAX_K ||
+	NumberCodeVectors < 1 || NumberCodeVectors > TRELLIS_MAX_N || MaxSteps < 1)
+	return NULL;
+
+    td = (TrellisDecoder *)th_malloc(sizeof(TrellisDecoder));
+    if (td == NULL)
+	return NULL;
+
+    td->ConstraintLength  = ConstraintLength;
+    td->NumberCodeVectors = NumberCodeVectors;
+    td->NumStates         = 1 << (ConstraintLength - 1);
+    td->MaxSteps          = MaxSteps;
+    td->DecisionWords     = (td->NumStates + 31) / 32;
+    td->Steps             = 0;
+    td->Window            = 0;
+    td->Warmup            = 0;
+
+    td->Decisions = (e_u32 *)th_malloc((size_t)MaxSteps * td->DecisionWords *
+				       sizeof(e_u32));
+    if (td->Decisions == NULL) {
+	th_free(td);
+	return NULL;
+    }
+
+    /* Tabulate the code bits sent for every shift register value */
+    for (r = 0; r < 2 * td->NumStates; r++) {
+	c = 0;
+	for (v = 0; v < NumberCodeVectors; v++) {
+	    e_u32 Taps = (e_u32)r & Generators[v];
+	    n_int Parity = 0;
+
+	    for (j = 0; j < ConstraintLength; j++)
+		Parity ^= (n_int)((Taps >> j) & 1);
+	    c |= Parity << v;
+	}
+	td->OutIdx[r] = (e_u8)c;
+    }
+
+    for (j = 0; j < 8; j++)
+	td->SoftWeight[j] = SoftWeights ? SoftWeights[j] : (e_s16)(2*j - 7);
+
+    td->Step = TrellisStepGeneric;
+    for (k = 0; k < sizeof(TrellisKernels) / sizeof(TrellisKernels[0]); k++) {
+	if (TrellisKernels[k].K == ConstraintLength &&
+	    TrellisKernels[k].N == NumberCodeVectors)
+	    td->Step = TrellisKernels[k].Step;
+    }
+
+    return td;
+} /* TrellisDecoderInit */
+
+/*
+ * FUNC: TrellisDecoderFree
+ *
+ * DESC: Releases a decoder obtained from TrellisDecoderInit().
+ */
+void TrellisDecoderFree(TrellisDecoder *td)
+{
+    if (td != NULL) {
+	th_free(td->Decisions);
+	th_free(td);
+    }
+} /* TrellisDecoderFree */
+
+/*
+ * FUNC: TrellisSetTraceback
+ *
+ * DESC: Selects the traceback. A WindowLength of 0 traces the whole frame
+ * back in one pass. Otherwise the frame is cut into windows of WindowLength
+ * steps; each window is traced from an arbitrary state starting WarmupDepth
+ * steps after its end (from the frame's final state for the last windows),
+ * so the windows are independent of each other.
+ */
+void TrellisSetTraceback(TrellisDecoder *td, n_int WindowLength, n_int WarmupDepth)
+{
+    td->Window = WindowLength > 0 ? WindowLength : 0;
+    td->Warmup = WarmupDepth > 0 ? WarmupDepth : 0;
+} /* TrellisSetTraceback */
+
+/*
+ * FUNC: TrellisForward
+ *
+ * DESC: Runs the ACS over NumSteps (up to MaxSteps) trellis steps from
+ * Symbols, NumberCodeVectors soft values per step, and keeps the decisions
+ * for TrellisTraceBack. The encoder is assumed to start in state 0.
+ */
+void TrellisForward(TrellisDecoder *td, const e_u8 *Symbols, n_int NumSteps)
+{
+    n_int i, t;
+    e_s16 *pM, esNorm;
+
+    if (NumSteps > td->MaxSteps)
+	NumSteps = td->MaxSteps;
+    td->Steps = NumSteps;
+
+    td->BufSelector = 0;
+    td->PathMetric[0][0] = 0;
+    for (i = 1; i < td->NumStates; i++)
+	td->PathMetric[0][i] = TRELLIS_START_METRIC;
+
+    for (t = 0; t < NumSteps; t++) {
+	(*td->Step)(td, Symbols, td->Decisions + t * td->DecisionWords);
+	Symbols += td->NumberCodeVectors;
+
+	if ((t + 1) % TRELLIS_RENORM_INTERVAL == 0) {
+	    pM = td->PathMetric[td->BufSelector];
+	    esNorm = pM[0];
+	    for (i = 0; i < td->NumStates; i++)
+		pM[i] -= esNorm;
+	}
+    }
+} /* TrellisForward */
+
+/*
+ * FUNC: TrellisNumWindows
+ *
+ * RETURNS: The number of traceback windows of the last TrellisForward frame.
+ */
+n_int TrellisNumWindows(const TrellisDecoder *td)
+{
+    if (td->Window == 0 || td->Steps == 0)
+	return 1;
+    return (td->Steps + td->Window - 1) / td->Window;
+} /* TrellisNumWindows */
+
+/*
+ * FUNC: TrellisTraceBack
+ *
+ * DESC: Writes the decoded bits of windows FirstWindow .. FirstWindow +
+ * NumWindows - 1 of the last TrellisForward frame to DataBits, one bit per
+ * byte at its step index. If Terminated is TRUE the encoder was flushed to
+ * state 0 and the trace of the frame end starts there, otherwise it starts
+ * from the best state.
+ *
+ * The decoder is only read, so separate ranges of windows may be traced from
+ * separate threads. Within a call up to TRELLIS_TB_LANES windows are traced
+ * in lockstep, so their dependent decision loads overlap.
+ */
+void TrellisTraceBack(const TrellisDecoder *td, n_int Terminated, n_int FirstWindow,
+		      n_int NumWindows, e_u8 *DataBits)
+{
+    n_int Top[TRELLIS_TB_LANES], Low[TRELLIS_TB_LANES], High[TRELLIS_TB_LANES];
+    n_int State[TRELLIS_TB_LANES];
+    n_int i, l, t, w, n, End, Span, FinalState;
+    n_int Window = td->Window ? td->Window : td->Steps;
+    n_int Shift = td->ConstraintLength - 2;
+    const e_s16 *pM;
+    const e_u32 *pDecision;
+
+    FinalState = 0;
+    if (!Terminated) {
+	pM = td->PathMetric[td->BufSelector];
+	for (i = 1; i < td->NumStates; i++) {
+	    if (pM[i] > pM[FinalState])
+		FinalState = i;
+	}
+    }
+
+    for (w = FirstWindow; w < FirstWindow + NumWindows; w += n) {
+	n = FirstWindow + NumWindows - w;
+	if (n > TRELLIS_TB_LANES)
+	    n = TRELLIS_TB_LANES;
+
+	Span = 0;
+	for (l = 0; l < n; l++) {
+	    Low[l]  = (w + l) * Window;
+	    High[l] = Low[l] + Window < td->Steps ? Low[l] + Window : td->Steps;
+	    End     = High[l] + td->Warmup < td->Steps ? High[l] + td->Warmup : td->Steps;
+	    Top[l]  = End - 1;
+	    State[l] = (End == td->Steps) ? FinalState : 0;
+	    if (End - Low[l] > Span)
+		Span = End - Low[l];
+	}
+
+	/* The decoded bit is the low bit of the state, the decision selects
+	 * the predecessor: State/2, or State/2 + NumStates/2 */
+	for (i = 0; i < Span; i++) {
+	    for (l = 0; l < n; l++) {
+		t = Top[l] - i;
+		if (t < Low[l])
+		    continue;
+		pDecision = td->Decisions + t * td->DecisionWords;
+		if (t < High[l])
+		    DataBits[t] = (e_u8)(State[l] & 1);
+		State[l] = (State[l] >> 1) |
+			   (n_int)(((pDecision[State[l] >> 5] >> (State[l] & 31)) & 1) << Shift);
+	    }
+	}
+    }
+} /* TrellisTraceBack */
+
+/*
+ * FUNC: TrellisDecode
+ *
+ * DESC: Decodes a frame of NumSteps (up to MaxSteps) trellis steps from
+ * Symbols, NumberCodeVectors soft values per step, into NumSteps bits of
+ * DataBits, one bit per byte: TrellisForward followed by TrellisTraceBack
+ * of every window.
+ */
+void TrellisDecode(TrellisDecoder *td, const e_u8 *Symbols, n_int NumSteps,
+		   n_int Terminated, e_u8 *DataBits)
+{
+    TrellisForward(td, Symbols, NumSteps);
+    TrellisTraceBack(td, Terminated, 0, TrellisNumWindows(td), DataBits);
+} /* TrellisDecode */
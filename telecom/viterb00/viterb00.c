@@ -13,6 +13,14 @@
 
 #include "algo.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 /*
  * ViterbiDecoderIS136(EncodedStreamPtr, DecodedStreamPtr)
  *
@@ -36,10 +44,11 @@
  * to have been flushed back to state 0 when done.
  *
  * The decoder performs the ACS (Add/Compare/Select) function based on the 
- * received branch words and provides renormalization of the path metrics to
- * prevent overflow. When all branch words have been processed the decoder then
- * performs a Backtrack function to generate the data bits from the minimum
- * path metric and decoder trellis.
+ * received branch words. The 16-bit path metrics grow by at most 14 per
+ * step, so they cannot overflow within a packet and are not renormalized;
+ * ViterbiDecode8 keeps 8-bit metrics that wrap instead. When all branch
+ * words have been processed, the decoder performs a Backtrack function to
+ * generate the data bits from the minimum path metric and decoder trellis.
  */
 
 /*
@@ -57,6 +66,7 @@
 #define		ENCBITS			5
 #define		NUMSTATES		(1<<ENCBITS)
 
+#if !VITERBI_SOA_ACS && !VITERBI_PACKED_SURVIVORS
 /*
  * StatePathMetricData:
  */
@@ -64,26 +74,69 @@ typedef struct {
     e_s16 m_esState;
     e_s16 m_esPathMetric;
 } StatePathMetricData;
+#endif
 
-static StatePathMetricData SPM1[NUMSTATES], SPM2[NUMSTATES];
-
-static e_s16 pBranchMetrics[NUMSTATES/2];
 /*
- * SavedPath: The traceback buffer.
+ * ViterbiContext: All of the state of one decoder. Decoders which do not
+ * share a context may run concurrently.
  */
-static e_s16 pSavedPath[NUMSTATES * (MAX_DATA_SIZE/8 + 1)];
+struct ViterbiContext {
+#if VITERBI_PACKED_SURVIVORS
+    /*
+     * PathMetric: The state path metric buffers. The first index selects the
+     * buffer (see BufSelector), the second is the state.
+     */
+    e_s16 PathMetric[2][NUMSTATES];
 
-/* 
- * BufPtr, BufSelector:
- *
- * Implement a double-buffering mechanism for SPM1, SPM2.
- * Each call to ACS and PreACS reads from one and writes to the other,
- * switching input and output on each call. The setting of which
- * of the two is input and which is output is determined by the
- * value of BufSelector, which toggles between 0 and 1.
+    /*
+     * Decisions: The survivor memory, one word per trellis step. Bit s is set
+     * when state s was reached from the lower predecessor (s/2 + NUMSTATES/2)
+     * rather than the upper one (s/2).
+     */
+    e_u32 Decisions[MAX_DATA_SIZE];
+    n_int Step;
+#elif VITERBI_SOA_ACS
+    /*
+     * PathMetric, PathState:
+     *
+     * Structure-of-arrays form of the state path metric buffers. The first
+     * index selects the buffer (see BufSelector), the second is the state.
+     */
+    e_s16 PathMetric[2][NUMSTATES];
+    e_s16 PathState[2][NUMSTATES];
+#else
+    /*
+     * SPM: The state path metric buffers. The first index selects the
+     * buffer (see BufSelector), the second is the state.
+     */
+    StatePathMetricData SPM[2][NUMSTATES];
+#endif
+
+    e_s16 pBranchMetrics[NUMSTATES/2];
+
+#if !VITERBI_PACKED_SURVIVORS
+    /*
+     * SavedPath: The traceback buffer.
+     */
+    e_s16 pSavedPath[NUMSTATES * (MAX_DATA_SIZE/8 + 1)];
+#endif
+
+    /* 
+     * BufSelector:
+     *
+     * Implement a double-buffering mechanism for the state path metric
+     * buffers. Each call to ACS and PreACS reads from one and writes to the
+     * other, switching input and output on each call. The setting of which
+     * of the two is input and which is output is determined by the
+     * value of BufSelector, which toggles between 0 and 1.
+     */
+    n_int BufSelector;
+};
+
+/*
+ * DefaultContext: The context used by ViterbiDecoderIS136().
  */
-static StatePathMetricData *BufPtr[2] = {SPM1, SPM2};
-static n_int BufSelector;
+static ViterbiContext DefaultContext;
 
 /*
  * FUNC: FindMetrics
@@ -141,6 +194,45 @@ static void FindMetrics(e_s16 EncodedWord, e_s16 *pBM)
     *pBM++ = esMp;
 } /* FindMetrics */
 
+#if VITERBI_BM_TABLE
+/*
+ * BranchMetricTable: The FindMetrics output for each of the 64 possible
+ * branch words, indexed by the six meaningful bits. Built once by
+ * InitBranchMetricTable and read-only afterwards, so it is shared by all
+ * contexts.
+ */
+static e_s16 BranchMetricTable[64][NUMSTATES/2];
+static n_int BranchMetricTableReady = FALSE;
+
+/*
+ * FUNC: InitBranchMetricTable
+ *
+ * DESC: Fills BranchMetricTable on the first call, does nothing afterwards.
+ */
+static void InitBranchMetricTable(void)
+{
+    n_int i;
+
+    if (BranchMetricTableReady)
+	return;
+    for (i = 0; i < 64; i++)
+	FindMetrics((e_s16)i, BranchMetricTable[i]);
+    BranchMetricTableReady = TRUE;
+} /* InitBranchMetricTable */
+
+/*
+ * BRANCH_METRICS: The branch metrics of EncodedWord. Looked up in
+ * BranchMetricTable, so pBuf is not used.
+ */
+#define	BRANCH_METRICS(EncodedWord, pBuf)	(BranchMetricTable[(EncodedWord) & 0x3f])
+#else
+/*
+ * BRANCH_METRICS: Computes the branch metrics of EncodedWord into pBuf and
+ * evaluates to pBuf.
+ */
+#define	BRANCH_METRICS(EncodedWord, pBuf)	(FindMetrics((EncodedWord), (pBuf)), (pBuf))
+#endif
+
 /*
  * FUNC: PreACS
  *
@@ -150,15 +242,59 @@ static void FindMetrics(e_s16 EncodedWord, e_s16 *pBM)
  * computations for the decoder.
  */
 
-static void PreACS(n_int Iterations, e_s16 *pBranchMetric)
+#if VITERBI_PACKED_SURVIVORS
+static void PreACS(ViterbiContext *ctx, n_int Iterations, e_s16 *pBranchMetric)
+{
+    n_int i;
+    e_s16 esMetricIn;
+
+    e_s16 *pInM  = ctx->PathMetric[ctx->BufSelector];
+    e_s16 *pOutM = ctx->PathMetric[1 - ctx->BufSelector];
+
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
+
+    for (i = 0; i < Iterations; i++) {
+	esMetricIn = pBranchMetric[i];
+
+	pOutM[2*i]   = pInM[i] - esMetricIn;
+	pOutM[2*i+1] = pInM[i] + esMetricIn;
+    }
+
+    /* Every state has a single (upper) predecessor */
+    ctx->Decisions[ctx->Step++] = 0;
+} /* PreACS */
+#elif VITERBI_SOA_ACS
+static void PreACS(ViterbiContext *ctx, n_int Iterations, e_s16 *pBranchMetric)
+{
+    n_int i;
+    e_s16 esMetricIn;
+
+    e_s16 *pInM  = ctx->PathMetric[ctx->BufSelector];
+    e_s16 *pInS  = ctx->PathState[ctx->BufSelector];
+    e_s16 *pOutM = ctx->PathMetric[1 - ctx->BufSelector];
+    e_s16 *pOutS = ctx->PathState[1 - ctx->BufSelector];
+
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
+
+    for (i = 0; i < Iterations; i++) {
+	esMetricIn = pBranchMetric[i];
+
+	pOutM[2*i]   = pInM[i] - esMetricIn;
+	pOutM[2*i+1] = pInM[i] + esMetricIn;
+	pOutS[2*i]   = (pInS[i] << 1);
+	pOutS[2*i+1] = (pInS[i] << 1)|1;
+    }
+} /* PreACS */
+#else
+static void PreACS(ViterbiContext *ctx, n_int Iterations, e_s16 *pBranchMetric)
 {
     n_int i;
     e_s16 esMetricIn, esMetric1, esMetric2;
 
-    StatePathMetricData *pIn1 = BufPtr[BufSelector];
-    StatePathMetricData *pOut = BufPtr[1 - BufSelector];
+    StatePathMetricData *pIn1 = ctx->SPM[ctx->BufSelector];
+    StatePathMetricData *pOut = ctx->SPM[1 - ctx->BufSelector];
 
-    BufSelector ^= 1;		/* Toggle for next call */
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
 
     for (i = 0; i < Iterations; i++) {
 	esMetricIn = *pBranchMetric++;
@@ -175,6 +311,134 @@ static void PreACS(n_int Iterations, e_s16 *pBranchMetric)
 	pIn1++;
     }
 } /* PreACS */
+#endif
+
+/*
+ * FUNC: ACSDecisions
+ *
+ * DESC: ACS on path metrics only, used with packed survivors and by the
+ * streaming decoder. The outcome of each compare is returned as one bit of
+ * the step's decision word, in state order: bit s is set when state s was
+ * reached from the lower predecessor. With VITERBI_SOA_ACS the compares are
+ * done on SSE2 or NEON vectors, ACSDecisionsSSE2 and ACSDecisionsNEON, and
+ * the masks are packed directly into the decision word; ViterbiSelectKernel
+ * picks them or the scalar ACSDecisionsScalar.
+ */
+#if VITERBI_SOA_ACS && defined(__SSE2__)
+static e_u32 ACSDecisionsSSE2(const e_s16 *pInM, e_s16 *pOutM, const e_s16 *pBranchMetric)
+{
+    n_int i;
+    e_u32 Decision = 0;
+    __m128i vBm, vM1, vM2, vT1, vT2, vMaskE, vMaskO, vMe, vMo;
+
+    for (i = 0; i < NUMSTATES/2; i += 8) {
+	vBm = _mm_loadu_si128((const __m128i *)(pBranchMetric + i));
+	vM1 = _mm_loadu_si128((const __m128i *)(pInM + i));
+	vM2 = _mm_loadu_si128((const __m128i *)(pInM + i + NUMSTATES/2));
+
+	vT1    = _mm_sub_epi16(vM1, vBm);
+	vT2    = _mm_add_epi16(vM2, vBm);
+	vMaskE = _mm_cmpgt_epi16(vT2, vT1);
+	vMe    = _mm_max_epi16(vT1, vT2);
+
+	vT1    = _mm_add_epi16(vM1, vBm);
+	vT2    = _mm_sub_epi16(vM2, vBm);
+	vMaskO = _mm_cmpgt_epi16(vT2, vT1);
+	vMo    = _mm_max_epi16(vT1, vT2);
+
+	_mm_storeu_si128((__m128i *)(pOutM + 2*i),     _mm_unpacklo_epi16(vMe, vMo));
+	_mm_storeu_si128((__m128i *)(pOutM + 2*i + 8), _mm_unpackhi_epi16(vMe, vMo));
+
+	/* One byte per state, in state order, then one bit per byte */
+	Decision |= (e_u32)_mm_movemask_epi8(
+			_mm_packs_epi16(_mm_unpacklo_epi16(vMaskE, vMaskO),
+					_mm_unpackhi_epi16(vMaskE, vMaskO))) << (2*i);
+    }
+
+    return Decision;
+}
+#elif VITERBI_SOA_ACS && defined(__ARM_NEON)
+static e_u32 ACSDecisionsNEON(const e_s16 *pInM, e_s16 *pOutM, const e_s16 *pBranchMetric)
+{
+    n_int i;
+    e_u32 Decision = 0;
+    static const e_u16 pBitWeights[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+    int16x8_t vBm, vM1, vM2, vT1, vT2;
+    uint16x8_t vMaskE, vMaskO, vWeights;
+    uint16x8x2_t vMaskZip;
+    uint32x4_t vSum;
+    int16x8x2_t vZip;
+
+    vWeights = vld1q_u16(pBitWeights);
+    for (i = 0; i < NUMSTATES/2; i += 8) {
+	vBm = vld1q_s16(pBranchMetric + i);
+	vM1 = vld1q_s16(pInM + i);
+	vM2 = vld1q_s16(pInM + i + NUMSTATES/2);
+
+	vT1    = vsubq_s16(vM1, vBm);
+	vT2    = vaddq_s16(vM2, vBm);
+	vMaskE = vcgtq_s16(vT2, vT1);
+	vZip.val[0] = vmaxq_s16(vT1, vT2);
+
+	vT1    = vaddq_s16(vM1, vBm);
+	vT2    = vsubq_s16(vM2, vBm);
+	vMaskO = vcgtq_s16(vT2, vT1);
+	vZip.val[1] = vmaxq_s16(vT1, vT2);
+
+	vZip = vzipq_s16(vZip.val[0], vZip.val[1]);
+	vst1q_s16(pOutM + 2*i,     vZip.val[0]);
+	vst1q_s16(pOutM + 2*i + 8, vZip.val[1]);
+
+	/* Weight each state's mask by its bit, then add across the vector */
+	vMaskZip = vzipq_u16(vMaskE, vMaskO);
+	vSum = vpaddlq_u16(vorrq_u16(vandq_u16(vMaskZip.val[0], vWeights),
+				     vshlq_n_u16(vandq_u16(vMaskZip.val[1], vWeights), 8)));
+	Decision |= (e_u32)(vgetq_lane_u32(vSum, 0) + vgetq_lane_u32(vSum, 1) +
+			    vgetq_lane_u32(vSum, 2) + vgetq_lane_u32(vSum, 3)) << (2*i);
+    }
+
+    return Decision;
+}
+#endif
+
+static e_u32 ACSDecisionsScalar(const e_s16 *pInM, e_s16 *pOutM, const e_s16 *pBranchMetric)
+{
+    n_int i;
+    e_u32 Decision = 0;
+    e_s16 esMetricIn, esMetric1, esMetric2;
+
+    for (i = 0; i < NUMSTATES/2; i++) {
+	/* The Viterbi Butterfly, the select compiles to conditional moves */
+	esMetricIn = pBranchMetric[i];
+
+	esMetric1 = pInM[i] - esMetricIn;
+	esMetric2 = pInM[i + NUMSTATES/2] + esMetricIn;
+	pOutM[2*i] = (esMetric1 >= esMetric2) ? esMetric1 : esMetric2;
+	Decision |= (e_u32)(esMetric2 > esMetric1) << (2*i);
+
+	esMetric1 = pInM[i] + esMetricIn;
+	esMetric2 = pInM[i + NUMSTATES/2] - esMetricIn;
+	pOutM[2*i+1] = (esMetric1 >= esMetric2) ? esMetric1 : esMetric2;
+	Decision |= (e_u32)(esMetric2 > esMetric1) << (2*i+1);
+    }
+
+    return Decision;
+}
+
+#if VITERBI_SOA_ACS
+/* The decision kernel ViterbiSelectKernel picked */
+typedef e_u32 (*ACSDecisionsFn)(const e_s16 *, e_s16 *, const e_s16 *);
+static ACSDecisionsFn ACSDecisions =
+#if defined(__SSE2__)
+    ACSDecisionsSSE2;
+#elif defined(__ARM_NEON)
+    ACSDecisionsNEON;
+#else
+    ACSDecisionsScalar;
+#endif
+#else
+#define ACSDecisions ACSDecisionsScalar
+#endif
 
 /*
  * FUNC: ACS
@@ -182,16 +446,198 @@ static void PreACS(n_int Iterations, e_s16 *pBranchMetric)
  * DESC: Updates the path metrics/paths for the Viterbi algorithm by
  * performing an add,compare,select update for state pairs.
  */
-static void ACS(e_s16 *pBranchMetric)
+#if VITERBI_PACKED_SURVIVORS
+static void ACS(ViterbiContext *ctx, e_s16 *pBranchMetric)
+{
+    e_s16 *pInM  = ctx->PathMetric[ctx->BufSelector];
+    e_s16 *pOutM = ctx->PathMetric[1 - ctx->BufSelector];
+
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
+
+    ctx->Decisions[ctx->Step++] = ACSDecisions(pInM, pOutM, pBranchMetric);
+} /* ACS */
+#elif VITERBI_SOA_ACS
+/*
+ * The structure-of-arrays engine computes the even (bit 0) and odd (bit 1)
+ * successors of each butterfly as two vectors, selects without branches,
+ * and interleaves them into the output buffer. The metric of the survivor
+ * is max(m1, m2); on a tie the upper path (m1) wins, as in the scalar code.
+ * The AVX2, SSE2, NEON and scalar steps are variants ViterbiSelectKernel
+ * picks from.
+ */
+#if defined(__AVX2__)
+static void ACSStepAVX2(const e_s16 *pInM, const e_s16 *pInS, e_s16 *pOutM, e_s16 *pOutS,
+                        const e_s16 *pBranchMetric)
+{
+    __m256i vBm, vM1, vM2, vS1, vS2, vT1, vT2, vMask;
+    __m256i vMe, vMo, vSe, vSo, vLo, vHi;
+
+    vBm = _mm256_loadu_si256((const __m256i *)pBranchMetric);
+    vM1 = _mm256_loadu_si256((const __m256i *)pInM);
+    vM2 = _mm256_loadu_si256((const __m256i *)(pInM + NUMSTATES/2));
+    vS1 = _mm256_slli_epi16(_mm256_loadu_si256((const __m256i *)pInS), 1);
+    vS2 = _mm256_slli_epi16(_mm256_loadu_si256((const __m256i *)(pInS + NUMSTATES/2)), 1);
+
+    vT1   = _mm256_sub_epi16(vM1, vBm);
+    vT2   = _mm256_add_epi16(vM2, vBm);
+    vMask = _mm256_cmpgt_epi16(vT2, vT1);
+    vMe   = _mm256_max_epi16(vT1, vT2);
+    vSe   = _mm256_blendv_epi8(vS1, vS2, vMask);
+
+    vT1   = _mm256_add_epi16(vM1, vBm);
+    vT2   = _mm256_sub_epi16(vM2, vBm);
+    vMask = _mm256_cmpgt_epi16(vT2, vT1);
+    vMo   = _mm256_max_epi16(vT1, vT2);
+    vSo   = _mm256_or_si256(_mm256_blendv_epi8(vS1, vS2, vMask),
+			    _mm256_set1_epi16(1));
+
+    /* unpack works within 128-bit lanes, so reorder the halves */
+    vLo = _mm256_unpacklo_epi16(vMe, vMo);
+    vHi = _mm256_unpackhi_epi16(vMe, vMo);
+    _mm256_storeu_si256((__m256i *)pOutM, _mm256_permute2x128_si256(vLo, vHi, 0x20));
+    _mm256_storeu_si256((__m256i *)(pOutM + 16), _mm256_permute2x128_si256(vLo, vHi, 0x31));
+    vLo = _mm256_unpacklo_epi16(vSe, vSo);
+    vHi = _mm256_unpackhi_epi16(vSe, vSo);
+    _mm256_storeu_si256((__m256i *)pOutS, _mm256_permute2x128_si256(vLo, vHi, 0x20));
+    _mm256_storeu_si256((__m256i *)(pOutS + 16), _mm256_permute2x128_si256(vLo, vHi, 0x31));
+}
+#endif
+
+#if defined(__SSE2__)
+static void ACSStepSSE2(const e_s16 *pInM, const e_s16 *pInS, e_s16 *pOutM, e_s16 *pOutS,
+                        const e_s16 *pBranchMetric)
+{
+    n_int i;
+    __m128i vBm, vM1, vM2, vS1, vS2, vT1, vT2, vMask;
+    __m128i vMe, vMo, vSe, vSo;
+
+    for (i = 0; i < NUMSTATES/2; i += 8) {
+	vBm = _mm_loadu_si128((const __m128i *)(pBranchMetric + i));
+	vM1 = _mm_loadu_si128((const __m128i *)(pInM + i));
+	vM2 = _mm_loadu_si128((const __m128i *)(pInM + i + NUMSTATES/2));
+	vS1 = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(pInS + i)), 1);
+	vS2 = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(pInS + i + NUMSTATES/2)), 1);
+
+	vT1   = _mm_sub_epi16(vM1, vBm);
+	vT2   = _mm_add_epi16(vM2, vBm);
+	vMask = _mm_cmpgt_epi16(vT2, vT1);
+	vMe   = _mm_max_epi16(vT1, vT2);
+	vSe   = _mm_or_si128(_mm_and_si128(vMask, vS2), _mm_andnot_si128(vMask, vS1));
+
+	vT1   = _mm_add_epi16(vM1, vBm);
+	vT2   = _mm_sub_epi16(vM2, vBm);
+	vMask = _mm_cmpgt_epi16(vT2, vT1);
+	vMo   = _mm_max_epi16(vT1, vT2);
+	vSo   = _mm_or_si128(_mm_and_si128(vMask, vS2), _mm_andnot_si128(vMask, vS1));
+	vSo   = _mm_or_si128(vSo, _mm_set1_epi16(1));
+
+	_mm_storeu_si128((__m128i *)(pOutM + 2*i),     _mm_unpacklo_epi16(vMe, vMo));
+	_mm_storeu_si128((__m128i *)(pOutM + 2*i + 8), _mm_unpackhi_epi16(vMe, vMo));
+	_mm_storeu_si128((__m128i *)(pOutS + 2*i),     _mm_unpacklo_epi16(vSe, vSo));
+	_mm_storeu_si128((__m128i *)(pOutS + 2*i + 8), _mm_unpackhi_epi16(vSe, vSo));
+    }
+}
+#endif
+
+#if defined(__ARM_NEON)
+static void ACSStepNEON(const e_s16 *pInM, const e_s16 *pInS, e_s16 *pOutM, e_s16 *pOutS,
+                        const e_s16 *pBranchMetric)
+{
+    n_int i;
+    int16x8_t vBm, vM1, vM2, vS1, vS2, vT1, vT2;
+    int16x8_t vMe, vMo, vSe, vSo;
+    uint16x8_t vMask;
+    int16x8x2_t vZip;
+
+    for (i = 0; i < NUMSTATES/2; i += 8) {
+	vBm = vld1q_s16(pBranchMetric + i);
+	vM1 = vld1q_s16(pInM + i);
+	vM2 = vld1q_s16(pInM + i + NUMSTATES/2);
+	vS1 = vshlq_n_s16(vld1q_s16(pInS + i), 1);
+	vS2 = vshlq_n_s16(vld1q_s16(pInS + i + NUMSTATES/2), 1);
+
+	vT1   = vsubq_s16(vM1, vBm);
+	vT2   = vaddq_s16(vM2, vBm);
+	vMask = vcgtq_s16(vT2, vT1);
+	vMe   = vmaxq_s16(vT1, vT2);
+	vSe   = vbslq_s16(vMask, vS2, vS1);
+
+	vT1   = vaddq_s16(vM1, vBm);
+	vT2   = vsubq_s16(vM2, vBm);
+	vMask = vcgtq_s16(vT2, vT1);
+	vMo   = vmaxq_s16(vT1, vT2);
+	vSo   = vorrq_s16(vbslq_s16(vMask, vS2, vS1), vdupq_n_s16(1));
+
+	vZip = vzipq_s16(vMe, vMo);
+	vst1q_s16(pOutM + 2*i,     vZip.val[0]);
+	vst1q_s16(pOutM + 2*i + 8, vZip.val[1]);
+	vZip = vzipq_s16(vSe, vSo);
+	vst1q_s16(pOutS + 2*i,     vZip.val[0]);
+	vst1q_s16(pOutS + 2*i + 8, vZip.val[1]);
+    }
+}
+#endif
+
+static void ACSStepScalar(const e_s16 *pInM, const e_s16 *pInS, e_s16 *pOutM, e_s16 *pOutS,
+                          const e_s16 *pBranchMetric)
+{
+    n_int i;
+    e_s16 esMetricIn, esMetric1, esMetric2, esState1, esState2, esMask;
+
+    for (i = 0; i < NUMSTATES/2; i++) {
+	esMetricIn = pBranchMetric[i];
+	esState1   = (pInS[i] << 1);
+	esState2   = (pInS[i + NUMSTATES/2] << 1);
+
+	esMetric1 = pInM[i] - esMetricIn;
+	esMetric2 = pInM[i + NUMSTATES/2] + esMetricIn;
+	esMask    = -(esMetric2 > esMetric1);
+	pOutM[2*i] = (esMetric1 & ~esMask) | (esMetric2 & esMask);
+	pOutS[2*i] = (esState1 & ~esMask) | (esState2 & esMask);
+
+	esMetric1 = pInM[i] + esMetricIn;
+	esMetric2 = pInM[i + NUMSTATES/2] - esMetricIn;
+	esMask    = -(esMetric2 > esMetric1);
+	pOutM[2*i+1] = (esMetric1 & ~esMask) | (esMetric2 & esMask);
+	pOutS[2*i+1] = ((esState1 & ~esMask) | (esState2 & esMask)) | 1;
+    }
+}
+
+/* The step ViterbiSelectKernel picked */
+typedef void (*ACSStepFn)(const e_s16 *, const e_s16 *, e_s16 *, e_s16 *, const e_s16 *);
+static ACSStepFn ACSStep =
+#if defined(__AVX2__)
+    ACSStepAVX2;
+#elif defined(__SSE2__)
+    ACSStepSSE2;
+#elif defined(__ARM_NEON)
+    ACSStepNEON;
+#else
+    ACSStepScalar;
+#endif
+
+static void ACS(ViterbiContext *ctx, e_s16 *pBranchMetric)
+{
+    e_s16 *pInM  = ctx->PathMetric[ctx->BufSelector];
+    e_s16 *pInS  = ctx->PathState[ctx->BufSelector];
+    e_s16 *pOutM = ctx->PathMetric[1 - ctx->BufSelector];
+    e_s16 *pOutS = ctx->PathState[1 - ctx->BufSelector];
+
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
+
+    (*ACSStep)(pInM, pInS, pOutM, pOutS, pBranchMetric);
+} /* ACS */
+#else
+static void ACS(ViterbiContext *ctx, e_s16 *pBranchMetric)
 {
     n_int i;
     e_s16 esMetricIn, esMetric1, esMetric2;
 
-    StatePathMetricData *pIn1 = BufPtr[BufSelector];
+    StatePathMetricData *pIn1 = ctx->SPM[ctx->BufSelector];
     StatePathMetricData *pIn2 = pIn1 + NUMSTATES/2;
-    StatePathMetricData *pOut = BufPtr[1 - BufSelector];
+    StatePathMetricData *pOut = ctx->SPM[1 - ctx->BufSelector];
 
-    BufSelector ^= 1;		/* Toggle for next call */
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
 
     for (i = 0; i < NUMSTATES/2; i++) {
 	/* The Viterbi Butterfly */
@@ -227,18 +673,89 @@ static void ACS(e_s16 *pBranchMetric)
 	pIn2++;
     }
 } /* ACS */
+#endif
+
+/*
+ * FUNC: ViterbiSelectKernel
+ *
+ * DESC: Picks the ACS kernels of VITERBI_SOA_ACS with th_kernel_select,
+ * the best the CPU runs unless -kernel= forces one: the decision kernel
+ * and, without packed survivors, the step of the structure-of-arrays
+ * engine. The AVX2 variant takes the SSE2 decision kernel. Without
+ * VITERBI_SOA_ACS there is nothing to pick.
+ */
+void ViterbiSelectKernel(void)
+{
+#if VITERBI_SOA_ACS
+    static const THKernelVariant Variants[] = {
+#if defined(__AVX2__) && !VITERBI_PACKED_SURVIVORS
+	{ "avx2",   TH_CPU_AVX2 },
+#endif
+#if defined(__SSE2__)
+	{ "sse2",   TH_CPU_SSE2 },
+#elif defined(__ARM_NEON)
+	{ "neon",   TH_CPU_NEON },
+#endif
+	{ "scalar", 0 }
+    };
+    static const ACSDecisionsFn Decisions[] = {
+#if defined(__AVX2__) && !VITERBI_PACKED_SURVIVORS
+	ACSDecisionsSSE2,
+#endif
+#if defined(__SSE2__)
+	ACSDecisionsSSE2,
+#elif defined(__ARM_NEON)
+	ACSDecisionsNEON,
+#endif
+	ACSDecisionsScalar
+    };
+#if !VITERBI_PACKED_SURVIVORS
+    static const ACSStepFn Steps[] = {
+#if defined(__AVX2__)
+	ACSStepAVX2,
+#endif
+#if defined(__SSE2__)
+	ACSStepSSE2,
+#elif defined(__ARM_NEON)
+	ACSStepNEON,
+#endif
+	ACSStepScalar
+    };
+#endif
+    n_int v = th_kernel_select("acs", Variants, sizeof(Variants) / sizeof(Variants[0]));
+
+    ACSDecisions = Decisions[v];
+#if !VITERBI_PACKED_SURVIVORS
+    ACSStep = Steps[v];
+#endif
+#endif
+} /* ViterbiSelectKernel */
 
 /*
  *  FUNC: StorePaths
  *
  * DESC: Stores partial path metrics. 
  */
-static void StorePaths(e_s16 *PathPtr)
+#if VITERBI_PACKED_SURVIVORS
+/* Not needed, the decisions are stored by ACS */
+#elif VITERBI_SOA_ACS
+static void StorePaths(ViterbiContext *ctx, e_s16 *PathPtr)
+{
+    n_int i;
+    e_s16 *pInS = ctx->PathState[ctx->BufSelector];
+
+    for (i = 0; i < NUMSTATES; i++) {
+	PathPtr[i] = (pInS[i] >> 5);	    /* Store path metric, leaving out current state */
+	pInS[i] &= 0x1f;		    /* Keep current state */
+    }
+} /* StorePaths */
+#else
+static void StorePaths(ViterbiContext *ctx, e_s16 *PathPtr)
 {
     n_int i;
     e_s16 esPm;
 
-    StatePathMetricData *pIn = BufPtr[BufSelector];
+    StatePathMetricData *pIn = ctx->SPM[ctx->BufSelector];
 
     for (i = 0; i < NUMSTATES; i++) {
 	esPm = pIn->m_esState;
@@ -247,6 +764,37 @@ static void StorePaths(e_s16 *PathPtr)
 	pIn++;
     }
 } /* StorePaths */
+#endif
+
+/*
+ * FUNC: TraceBackDecisions
+ *
+ * DESC: Traces a packet back through its per-step decision words, starting
+ * from state 0, and writes the packed output. Used by the packed survivor
+ * engine and by the 8-bit metric decoder.
+ */
+static void TraceBackDecisions(const e_u32 *pDecisions, e_s16 *pOut)
+{
+    n_int i;
+    n_int State = 0;
+    e_u16 *pWord = (e_u16 *)pOut + EVENMULTIPLEOF8;
+
+    for (i = 0; i < MAX_DATA_SIZE/16 + 1; i++) {
+	pOut[i] = 0;
+    }
+
+    /*
+     * The decoded bit of each step is the low bit of the survivor state, and
+     * the decision word of that step selects its predecessor. Bits are packed
+     * MSB first, 16 to a word, exactly as the state-history traceback does.
+     */
+    for (i = MAX_DATA_SIZE - 1; i >= 0; i--) {
+	if (State & 1)
+	    pWord[i >> 4] |= (e_u16)(0x8000 >> (i & 15));
+	State = (State >> 1) |
+		(n_int)(((pDecisions[i] >> State) & 1) << (ENCBITS - 1));
+    }
+} /* TraceBackDecisions */
 
 /*
  * FUNC: TraceBack
@@ -258,15 +806,28 @@ static void StorePaths(e_s16 *PathPtr)
  * is reached.
  * Taking state 0 as the starting point is based on the assumption that the
  * encoder ended the encoded block with a series of zeros (i.e. flushed to zero).
+ *
+ * With packed survivors the trace instead walks the per-step decision words
+ * backwards from state 0, one bit at a time (see TraceBackDecisions).
  */
-static void TraceBack(e_s16 *pOut, e_s16 *pIn)
+#if VITERBI_PACKED_SURVIVORS
+static void TraceBack(ViterbiContext *ctx, e_s16 *pOut)
+{
+    TraceBackDecisions(ctx->Decisions, pOut);
+} /* TraceBack */
+#else
+static void TraceBack(ViterbiContext *ctx, e_s16 *pOut, e_s16 *pIn)
 {
     n_int i;
     n_int offset = 0;
     volatile e_s16 PathBits1, PathBits2;	
 
     pOut += (MAX_DATA_SIZE / 8) / 2;			/* Point to last stage */
-    *pIn =  (BufPtr[BufSelector])->m_esState;
+#if VITERBI_SOA_ACS
+    *pIn =  ctx->PathState[ctx->BufSelector][0];
+#else
+    *pIn =  (ctx->SPM[ctx->BufSelector])->m_esState;
+#endif
 
     if (!EVENMULTIPLEOF8) {
 	PathBits2 = *pIn;
@@ -289,49 +850,935 @@ static void TraceBack(e_s16 *pOut, e_s16 *pIn)
 	*pOut-- = (PathBits2 << 8) | PathBits1;	/* Store as 16-bit word */
     }
 } /* TraceBack */
+#endif
 
 /*
- * FUNC: ViterbiDecoderIS136
+ * FUNC: ViterbiContextInit
  *
- * DESC: See documentation at top of this source file.
+ * DESC: Allocates and clears a decoder context.
+ *
+ * RETURNS: The new context, or NULL if the allocation failed.
  */
-void ViterbiDecoderIS136(e_s16 *EncodedStreamPtr, e_s16 *DecodedStreamPtr)
+ViterbiContext *ViterbiContextInit(void)
+{
+    ViterbiContext *ctx;
+    size_t i;
+    e_u8 *p;
+
+#if VITERBI_BM_TABLE
+    InitBranchMetricTable();
+#endif
+
+    ctx = (ViterbiContext *)th_malloc(sizeof(ViterbiContext));
+    if (ctx == NULL)
+	return NULL;
+
+    p = (e_u8 *)ctx;
+    for (i = 0; i < sizeof(ViterbiContext); i++)
+	p[i] = 0;
+
+    return ctx;
+} /* ViterbiContextInit */
+
+/*
+ * FUNC: ViterbiContextFree
+ *
+ * DESC: Releases a context obtained from ViterbiContextInit().
+ */
+void ViterbiContextFree(ViterbiContext *ctx)
+{
+    if (ctx != NULL)
+	th_free(ctx);
+} /* ViterbiContextFree */
+
+/* The TH_PROF_BEGIN/TH_PROF_END stages of ViterbiDecode, see TH_PROFILE */
+enum { PROF_FindMetrics, PROF_ACS, PROF_StorePaths, PROF_TraceBack };
+
+/*
+ * FUNC: ViterbiDecode
+ *
+ * DESC: Decodes one packet using the state in ctx. See documentation at top
+ * of this source file.
+ */
+void ViterbiDecode(ViterbiContext *ctx, e_s16 *EncodedStreamPtr, e_s16 *DecodedStreamPtr)
 {
     n_int i;
     n_int iter;
-    e_s16 *PathPtr = pSavedPath;
+    e_s16 *pBM;
+#if !VITERBI_PACKED_SURVIVORS
+    e_s16 *PathPtr = ctx->pSavedPath;
+#endif
 
     /* Initialize the state path metric buffers */
 
-    BufSelector = 0;			/* Start by reading from SPM1[] */
-    SPM1[0].m_esPathMetric = 0x0ff;		/* Give state 0 higher metric */
+    ctx->BufSelector = 0;		/* Start by reading from buffer 0 */
+#if VITERBI_PACKED_SURVIVORS
+    ctx->Step = 0;
+#endif
+#if VITERBI_PACKED_SURVIVORS || VITERBI_SOA_ACS
+    ctx->PathMetric[0][0] = 0x0ff;	/* Give state 0 higher metric */
+    for (i = 1; i < NUMSTATES; i++) {
+	ctx->PathMetric[0][i] = 0;
+    }
+#else
+    ctx->SPM[0][0].m_esPathMetric = 0x0ff;	/* Give state 0 higher metric */
     for (i = 1; i < NUMSTATES; i++) {
-	SPM1[i].m_esPathMetric = 0;
+	ctx->SPM[0][i].m_esPathMetric = 0;
     }
+#endif
 
     iter = 1;
     for (i = 0; i < ENCBITS; i++) {
-	FindMetrics(*EncodedStreamPtr++, pBranchMetrics);
-	PreACS(iter, pBranchMetrics);
+	TH_PROF_BEGIN(PROF_FindMetrics);
+	pBM = BRANCH_METRICS(*EncodedStreamPtr++, ctx->pBranchMetrics);
+	TH_PROF_END(PROF_FindMetrics);
+	TH_PROF_BEGIN(PROF_ACS);
+	PreACS(ctx, iter, pBM);
+	TH_PROF_END(PROF_ACS);
 	iter *= 2;
     }
 
+#if VITERBI_PACKED_SURVIVORS
+    for (i = ENCBITS; i < MAX_DATA_SIZE; i++) {
+	TH_PROF_BEGIN(PROF_FindMetrics);
+	pBM = BRANCH_METRICS(*EncodedStreamPtr++, ctx->pBranchMetrics);
+	TH_PROF_END(PROF_FindMetrics);
+	TH_PROF_BEGIN(PROF_ACS);
+	ACS(ctx, pBM);
+	TH_PROF_END(PROF_ACS);
+    }
+    TH_PROF_BEGIN(PROF_TraceBack);
+    TraceBack(ctx, DecodedStreamPtr);
+    TH_PROF_END(PROF_TraceBack);
+#else
     for (i = 0; i < MAX_DATA_SIZE/8-1; i++) {
 	n_int j;
 
 	for (j = 0; j < 8; j++) {
-	    FindMetrics(*EncodedStreamPtr++, pBranchMetrics);
-	    ACS(pBranchMetrics);
+	    TH_PROF_BEGIN(PROF_FindMetrics);
+	    pBM = BRANCH_METRICS(*EncodedStreamPtr++, ctx->pBranchMetrics);
+	    TH_PROF_END(PROF_FindMetrics);
+	    TH_PROF_BEGIN(PROF_ACS);
+	    ACS(ctx, pBM);
+	    TH_PROF_END(PROF_ACS);
 	}
-	StorePaths(PathPtr);
+	TH_PROF_BEGIN(PROF_StorePaths);
+	StorePaths(ctx, PathPtr);
+	TH_PROF_END(PROF_StorePaths);
 	PathPtr += NUMSTATES;
     }
 
     /* Process remaining bits */
     for (i = 0; i < 8-ENCBITS; i++) {
-	FindMetrics(*EncodedStreamPtr++, pBranchMetrics);
-	ACS(pBranchMetrics);
+	TH_PROF_BEGIN(PROF_FindMetrics);
+	pBM = BRANCH_METRICS(*EncodedStreamPtr++, ctx->pBranchMetrics);
+	TH_PROF_END(PROF_FindMetrics);
+	TH_PROF_BEGIN(PROF_ACS);
+	ACS(ctx, pBM);
+	TH_PROF_END(PROF_ACS);
     }
-    TraceBack(DecodedStreamPtr, PathPtr);
+    TH_PROF_BEGIN(PROF_TraceBack);
+    TraceBack(ctx, DecodedStreamPtr, PathPtr);
+    TH_PROF_END(PROF_TraceBack);
+#endif
+} /* ViterbiDecode */
+
+/*
+ * FUNC: ViterbiDecoderIS136
+ *
+ * DESC: Decodes one packet using the default context. Not reentrant.
+ */
+void ViterbiDecoderIS136(e_s16 *EncodedStreamPtr, e_s16 *DecodedStreamPtr)
+{
+#if VITERBI_BM_TABLE
+    InitBranchMetricTable();
+#endif
+    ViterbiDecode(&DefaultContext, EncodedStreamPtr, DecodedStreamPtr);
 } /* ViterbiDecoderIS136 */
 
+
+/*******************************************************************************
+    8-bit metric decoder
+*******************************************************************************/
+
+/*
+ * The 8-bit decoder keeps the path metrics in bytes and lets them wrap. The
+ * metrics only ever grow, but the spread between the metrics of any two
+ * states is bounded by the code and the branch metric range (|bm| <= 14
+ * here); the largest difference between the two candidates of a compare is
+ * about 112, below 128. Candidates are therefore compared by the sign of
+ * their wrapped 8-bit difference, which gives exactly the decisions of the
+ * 16-bit decoder without any renormalization pass.
+ *
+ * One 128-bit vector holds all 16 butterflies, twice the states per register
+ * of the 16-bit engines. Survivors are kept as one decision word per step,
+ * as with VITERBI_PACKED_SURVIVORS.
+ */
+
+/*
+ * ViterbiContext8: All of the state of one 8-bit metric decoder.
+ */
+struct ViterbiContext8 {
+    e_u8 PathMetric[2][NUMSTATES];
+    e_u32 Decisions[MAX_DATA_SIZE];
+    n_int BufSelector;
+};
+
+/*
+ * BranchMetricTable8: The FindMetrics output for each of the 64 branch
+ * words, as two's complement bytes. Built once, shared by all contexts.
+ */
+static e_u8 BranchMetricTable8[64][NUMSTATES/2];
+static n_int BranchMetricTable8Ready = FALSE;
+
+/*
+ * FUNC: InitBranchMetricTable8
+ *
+ * DESC: Fills BranchMetricTable8 on the first call, does nothing afterwards.
+ */
+static void InitBranchMetricTable8(void)
+{
+    n_int i, j;
+    e_s16 pBM[NUMSTATES/2];
+
+    if (BranchMetricTable8Ready)
+	return;
+    for (i = 0; i < 64; i++) {
+	FindMetrics((e_s16)i, pBM);
+	for (j = 0; j < NUMSTATES/2; j++)
+	    BranchMetricTable8[i][j] = (e_u8)pBM[j];
+    }
+    BranchMetricTable8Ready = TRUE;
+} /* InitBranchMetricTable8 */
+
+/*
+ * FUNC: PreACS8
+ *
+ * DESC: PreACS on 8-bit metrics.
+ */
+static void PreACS8(ViterbiContext8 *ctx, n_int Iterations, const e_u8 *pBranchMetric)
+{
+    n_int i;
+
+    e_u8 *pInM  = ctx->PathMetric[ctx->BufSelector];
+    e_u8 *pOutM = ctx->PathMetric[1 - ctx->BufSelector];
+
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
+
+    for (i = 0; i < Iterations; i++) {
+	pOutM[2*i]   = (e_u8)(pInM[i] - pBranchMetric[i]);
+	pOutM[2*i+1] = (e_u8)(pInM[i] + pBranchMetric[i]);
+    }
+} /* PreACS8 */
+
+/*
+ * FUNC: ACS8
+ *
+ * DESC: ACSDecisions on 8-bit wrapping metrics. The lower candidate m2 is
+ * taken when (e_s8)(m2 - m1) > 0; on a tie the upper path wins.
+ *
+ * RETURNS: The decision word of the step.
+ */
+static e_u32 ACS8(ViterbiContext8 *ctx, const e_u8 *pBranchMetric)
+{
+    e_u32 Decision;
+    e_u8 *pInM  = ctx->PathMetric[ctx->BufSelector];
+    e_u8 *pOutM = ctx->PathMetric[1 - ctx->BufSelector];
+
+#if defined(__SSE2__)
+    __m128i vBm, vM1, vM2, vT1, vT2, vZero, vMaskE, vMaskO, vMe, vMo;
+
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
+
+    vZero = _mm_setzero_si128();
+    vBm = _mm_loadu_si128((const __m128i *)pBranchMetric);
+    vM1 = _mm_loadu_si128((const __m128i *)pInM);
+    vM2 = _mm_loadu_si128((const __m128i *)(pInM + NUMSTATES/2));
+
+    vT1    = _mm_sub_epi8(vM1, vBm);
+    vT2    = _mm_add_epi8(vM2, vBm);
+    vMaskE = _mm_cmpgt_epi8(_mm_sub_epi8(vT2, vT1), vZero);
+    vMe    = _mm_or_si128(_mm_and_si128(vMaskE, vT2), _mm_andnot_si128(vMaskE, vT1));
+
+    vT1    = _mm_add_epi8(vM1, vBm);
+    vT2    = _mm_sub_epi8(vM2, vBm);
+    vMaskO = _mm_cmpgt_epi8(_mm_sub_epi8(vT2, vT1), vZero);
+    vMo    = _mm_or_si128(_mm_and_si128(vMaskO, vT2), _mm_andnot_si128(vMaskO, vT1));
+
+    _mm_storeu_si128((__m128i *)pOutM,        _mm_unpacklo_epi8(vMe, vMo));
+    _mm_storeu_si128((__m128i *)(pOutM + 16), _mm_unpackhi_epi8(vMe, vMo));
+
+    Decision = (e_u32)_mm_movemask_epi8(_mm_unpacklo_epi8(vMaskE, vMaskO)) |
+	       ((e_u32)_mm_movemask_epi8(_mm_unpackhi_epi8(vMaskE, vMaskO)) << 16);
+#elif defined(__ARM_NEON)
+    static const e_u8 pBitWeights[16] = {
+	1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128
+    };
+    int8x16_t vBm, vM1, vM2, vT1, vT2, vZero;
+    uint8x16_t vMaskE, vMaskO, vWeights;
+    uint8x16x2_t vMaskZip;
+    int8x16x2_t vZip;
+    uint64x2_t vLo, vHi;
+
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
+
+    vZero = vdupq_n_s8(0);
+    vWeights = vld1q_u8(pBitWeights);
+    vBm = vreinterpretq_s8_u8(vld1q_u8(pBranchMetric));
+    vM1 = vreinterpretq_s8_u8(vld1q_u8(pInM));
+    vM2 = vreinterpretq_s8_u8(vld1q_u8(pInM + NUMSTATES/2));
+
+    vT1    = vsubq_s8(vM1, vBm);
+    vT2    = vaddq_s8(vM2, vBm);
+    vMaskE = vcgtq_s8(vsubq_s8(vT2, vT1), vZero);
+    vZip.val[0] = vbslq_s8(vMaskE, vT2, vT1);
+
+    vT1    = vaddq_s8(vM1, vBm);
+    vT2    = vsubq_s8(vM2, vBm);
+    vMaskO = vcgtq_s8(vsubq_s8(vT2, vT1), vZero);
+    vZip.val[1] = vbslq_s8(vMaskO, vT2, vT1);
+
+    vZip = vzipq_s8(vZip.val[0], vZip.val[1]);
+    vst1q_u8(pOutM,      vreinterpretq_u8_s8(vZip.val[0]));
+    vst1q_u8(pOutM + 16, vreinterpretq_u8_s8(vZip.val[1]));
+
+    /* Weight each state's mask by its bit, then add up each 8 byte half */
+    vMaskZip = vzipq_u8(vMaskE, vMaskO);
+    vLo = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(vMaskZip.val[0], vWeights))));
+    vHi = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(vMaskZip.val[1], vWeights))));
+    Decision = (e_u32)vgetq_lane_u64(vLo, 0) | ((e_u32)vgetq_lane_u64(vLo, 1) << 8) |
+	       ((e_u32)vgetq_lane_u64(vHi, 0) << 16) | ((e_u32)vgetq_lane_u64(vHi, 1) << 24);
+#else
+    n_int i;
+    e_u8 Metric1, Metric2, Diff;
+
+    ctx->BufSelector ^= 1;		/* Toggle for next call */
+
+    Decision = 0;
+    for (i = 0; i < NUMSTATES/2; i++) {
+	Metric1 = (e_u8)(pInM[i] - pBranchMetric[i]);
+	Metric2 = (e_u8)(pInM[i + NUMSTATES/2] + pBranchMetric[i]);
+	Diff = (e_u8)(Metric2 - Metric1);
+	pOutM[2*i] = (Diff != 0 && Diff < 0x80) ? Metric2 : Metric1;
+	Decision |= (e_u32)(Diff != 0 && Diff < 0x80) << (2*i);
+
+	Metric1 = (e_u8)(pInM[i] + pBranchMetric[i]);
+	Metric2 = (e_u8)(pInM[i + NUMSTATES/2] - pBranchMetric[i]);
+	Diff = (e_u8)(Metric2 - Metric1);
+	pOutM[2*i+1] = (Diff != 0 && Diff < 0x80) ? Metric2 : Metric1;
+	Decision |= (e_u32)(Diff != 0 && Diff < 0x80) << (2*i+1);
+    }
+#endif
+
+    return Decision;
+} /* ACS8 */
+
+/*
+ * FUNC: ViterbiContext8Init
+ *
+ * DESC: Allocates an 8-bit metric decoder context.
+ *
+ * RETURNS: The new context, or NULL if the allocation failed.
+ */
+ViterbiContext8 *ViterbiContext8Init(void)
+{
+    ViterbiContext8 *ctx;
+
+    InitBranchMetricTable8();
+
+    ctx = (ViterbiContext8 *)th_malloc(sizeof(ViterbiContext8));
+    if (ctx == NULL)
+	return NULL;
+
+    ctx->BufSelector = 0;
+
+    return ctx;
+} /* ViterbiContext8Init */
+
+/*
+ * FUNC: ViterbiContext8Free
+ *
+ * DESC: Releases a context obtained from ViterbiContext8Init().
+ */
+void ViterbiContext8Free(ViterbiContext8 *ctx)
+{
+    if (ctx != NULL)
+	th_free(ctx);
+} /* ViterbiContext8Free */
+
+/*
+ * FUNC: ViterbiDecode8
+ *
+ * DESC: Decodes one packet with 8-bit path metrics. Input, output and
+ * result are the same as for ViterbiDecode.
+ */
+void ViterbiDecode8(ViterbiContext8 *ctx, e_s16 *EncodedStreamPtr, e_s16 *DecodedStreamPtr)
+{
+    n_int i;
+    n_int iter;
+
+    /* All states start equal; PreACS only extends paths from state 0 */
+    ctx->BufSelector = 0;
+    for (i = 0; i < NUMSTATES; i++) {
+	ctx->PathMetric[0][i] = 0;
+    }
+
+    iter = 1;
+    for (i = 0; i < ENCBITS; i++) {
+	PreACS8(ctx, iter, BranchMetricTable8[*EncodedStreamPtr++ & 0x3f]);
+	ctx->Decisions[i] = 0;		/* single (upper) predecessor */
+	iter *= 2;
+    }
+
+    for (i = ENCBITS; i < MAX_DATA_SIZE; i++) {
+	ctx->Decisions[i] = ACS8(ctx, BranchMetricTable8[*EncodedStreamPtr++ & 0x3f]);
+    }
+
+    TraceBackDecisions(ctx->Decisions, DecodedStreamPtr);
+} /* ViterbiDecode8 */
+
+
+/*******************************************************************************
+    Streaming decoder
+*******************************************************************************/
+
+/*
+ * The streaming decoder accepts branch words in chunks of any length, from
+ * an encoder that started in state 0 but need not be flushed. It keeps up to
+ * 2*Depth decision words; whenever the window is full it traces back from the
+ * best state and releases the oldest Depth bits, so memory and latency are
+ * bounded by the traceback depth instead of the stream length.
+ *
+ * There is no PreACS: states other than 0 start with a large negative metric
+ * instead. The metrics are renormalized every STREAM_RENORM_INTERVAL steps
+ * by subtracting the metric of state 0; the spread between the metrics is
+ * bounded, so this keeps them all well inside 16 bits.
+ */
+#define		STREAM_RENORM_INTERVAL	64
+#define		STREAM_START_METRIC	(-0x1000)
+
+/*
+ * ViterbiStream: All of the state of one streaming decoder.
+ */
+struct ViterbiStream {
+    e_s16 PathMetric[2][NUMSTATES];
+    e_s16 pBranchMetrics[NUMSTATES/2];
+    e_u32 Decisions[2*VITERBI_MAX_TRACEBACK];
+    n_int BufSelector;
+    n_int Depth;	/* traceback depth, in trellis steps */
+    n_int Count;	/* decision words held in Decisions[] */
+    n_int Renorm;	/* steps since the last renormalization */
+};
+
+/*
+ * FUNC: StreamReset
+ *
+ * DESC: Returns the stream to the start of a new transmission.
+ */
+static void StreamReset(ViterbiStream *st)
+{
+    n_int i;
+
+    st->BufSelector = 0;
+    st->Count = 0;
+    st->Renorm = 0;
+    st->PathMetric[0][0] = 0;
+    for (i = 1; i < NUMSTATES; i++) {
+	st->PathMetric[0][i] = STREAM_START_METRIC;
+    }
+} /* StreamReset */
+
+/*
+ * FUNC: StreamBestState
+ *
+ * DESC: Returns the state with the highest path metric (lowest on a tie).
+ */
+static n_int StreamBestState(ViterbiStream *st)
+{
+    n_int i, Best = 0;
+    e_s16 *pM = st->PathMetric[st->BufSelector];
+
+    for (i = 1; i < NUMSTATES; i++) {
+	if (pM[i] > pM[Best])
+	    Best = i;
+    }
+    return Best;
+} /* StreamBestState */
+
+/*
+ * FUNC: StreamTraceBack
+ *
+ * DESC: Traces all held decisions back from State, writes the bits of the
+ * oldest NumOut steps to pOut (one bit per byte) and drops those steps.
+ *
+ * RETURNS: NumOut
+ */
+static n_int StreamTraceBack(ViterbiStream *st, n_int State, n_int NumOut, e_u8 *pOut)
+{
+    n_int i;
+
+    for (i = st->Count - 1; i >= 0; i--) {
+	if (i < NumOut)
+	    pOut[i] = (e_u8)(State & 1);
+	State = (State >> 1) |
+		(n_int)(((st->Decisions[i] >> State) & 1) << (ENCBITS - 1));
+    }
+
+    for (i = NumOut; i < st->Count; i++) {
+	st->Decisions[i - NumOut] = st->Decisions[i];
+    }
+    st->Count -= NumOut;
+
+    return NumOut;
+} /* StreamTraceBack */
+
+/*
+ * FUNC: ViterbiStreamInit
+ *
+ * DESC: Allocates a streaming decoder with the given traceback depth in
+ * trellis steps, 1..VITERBI_MAX_TRACEBACK. A depth of 5 to 10 constraint
+ * lengths gives practically the same result as decoding the whole frame.
+ *
+ * RETURNS: The new stream, or NULL if the depth is out of range or the
+ * allocation failed.
+ */
+ViterbiStream *ViterbiStreamInit(n_int TracebackDepth)
+{
+    ViterbiStream *st;
+
+    if (TracebackDepth < 1 || TracebackDepth > VITERBI_MAX_TRACEBACK)
+	return NULL;
+
+#if VITERBI_BM_TABLE
+    InitBranchMetricTable();
+#endif
+
+    st = (ViterbiStream *)th_malloc(sizeof(ViterbiStream));
+    if (st == NULL)
+	return NULL;
+
+    st->Depth = TracebackDepth;
+    StreamReset(st);
+
+    return st;
+} /* ViterbiStreamInit */
+
+/*
+ * FUNC: ViterbiStreamFree
+ *
+ * DESC: Releases a stream obtained from ViterbiStreamInit().
+ */
+void ViterbiStreamFree(ViterbiStream *st)
+{
+    if (st != NULL)
+	th_free(st);
+} /* ViterbiStreamFree */
+
+/*
+ * FUNC: ViterbiStreamPush
+ *
+ * DESC: Decodes NumWords branch words, in the input format of
+ * ViterbiDecoderIS136. Decoded bits are written to DecodedBits, one bit per
+ * byte, in stream order. At most NumWords + Depth bits are written.
+ *
+ * RETURNS: The number of bits written.
+ */
+n_int ViterbiStreamPush(ViterbiStream *st, const e_s16 *BranchWords, n_int NumWords,
+			e_u8 *DecodedBits)
+{
+    n_int i, j;
+    n_int NumOut = 0;
+    e_s16 *pInM, *pOutM, *pBM, esNorm;
+
+    for (i = 0; i < NumWords; i++) {
+	pBM = BRANCH_METRICS(BranchWords[i], st->pBranchMetrics);
+
+	pInM  = st->PathMetric[st->BufSelector];
+	pOutM = st->PathMetric[1 - st->BufSelector];
+	st->BufSelector ^= 1;
+
+	st->Decisions[st->Count++] = ACSDecisions(pInM, pOutM, pBM);
+
+	if (++st->Renorm == STREAM_RENORM_INTERVAL) {
+	    esNorm = pOutM[0];
+	    for (j = 0; j < NUMSTATES; j++) {
+		pOutM[j] -= esNorm;
+	    }
+	    st->Renorm = 0;
+	}
+
+	if (st->Count == 2*st->Depth) {
+	    NumOut += StreamTraceBack(st, StreamBestState(st), st->Depth,
+				      DecodedBits + NumOut);
+	}
+    }
+
+    return NumOut;
+} /* ViterbiStreamPush */
+
+/*
+ * FUNC: ViterbiStreamFlush
+ *
+ * DESC: Ends the stream and writes the bits still held (at most 2*Depth-1).
+ * If Terminated is TRUE the encoder was flushed to state 0 and the trace
+ * starts there, otherwise it starts from the best state. The stream is then
+ * ready for a new transmission.
+ *
+ * RETURNS: The number of bits written.
+ */
+n_int ViterbiStreamFlush(ViterbiStream *st, n_int Terminated, e_u8 *DecodedBits)
+{
+    n_int NumOut;
+
+    NumOut = StreamTraceBack(st, Terminated ? 0 : StreamBestState(st), st->Count,
+			     DecodedBits);
+    StreamReset(st);
+
+    return NumOut;
+} /* ViterbiStreamFlush */
+
+
+/*******************************************************************************
+    Batched decoder
+*******************************************************************************/
+
+/*
+ * The batched decoder runs NumPackets independent trellises side by side.
+ * Every buffer is laid out [state][lane], one lane per packet, so a single
+ * butterfly is computed for a whole vector of packets at once. The lane count
+ * is rounded up to a multiple of BATCH_LANES; padding lanes see zero branch
+ * metrics and their results are discarded.
+ */
+#define		BATCH_LANES		8
+#define		BATCH_PATHS		(NUMSTATES * (MAX_DATA_SIZE/8 + 1))
+
+/*
+ * ViterbiBatchContext: All of the state of one batched decoder.
+ */
+struct ViterbiBatchContext {
+    e_s16 Metric[2][NUMSTATES][VITERBI_MAX_BATCH];
+    e_s16 State[2][NUMSTATES][VITERBI_MAX_BATCH];
+    e_s16 BranchMetrics[NUMSTATES/2][VITERBI_MAX_BATCH];
+    e_s16 SavedPath[BATCH_PATHS][VITERBI_MAX_BATCH];
+    n_int Selector;
+};
+
+/*
+ * DefaultBatchContext: The context used by ViterbiDecoderIS136Batch().
+ */
+static ViterbiBatchContext DefaultBatchContext;
+
+/*
+ * FUNC: BatchFindMetrics
+ *
+ * DESC: Computes the branch metrics of one trellis step for every packet and
+ * transposes them into lane order.
+ */
+static void BatchFindMetrics(ViterbiBatchContext *ctx, e_s16 **EncodedStreamPtrs,
+			     n_int Step, n_int NumPackets, n_int NumLanes)
+{
+    n_int i, lane;
+#if !VITERBI_BM_TABLE
+    e_s16 pBuf[NUMSTATES/2];
+#endif
+    e_s16 *pBM;
+
+    for (lane = 0; lane < NumPackets; lane++) {
+	pBM = BRANCH_METRICS(EncodedStreamPtrs[lane][Step], pBuf);
+	for (i = 0; i < NUMSTATES/2; i++)
+	    ctx->BranchMetrics[i][lane] = pBM[i];
+    }
+    for (; lane < NumLanes; lane++) {
+	for (i = 0; i < NUMSTATES/2; i++)
+	    ctx->BranchMetrics[i][lane] = 0;
+    }
+} /* BatchFindMetrics */
+
+/*
+ * FUNC: BatchPreACS
+ *
+ * DESC: PreACS for all lanes.
+ */
+static void BatchPreACS(ViterbiBatchContext *ctx, n_int Iterations, n_int NumLanes)
+{
+    n_int i, lane;
+    e_s16 esMetricIn;
+
+    e_s16 (*pInM)[VITERBI_MAX_BATCH]  = ctx->Metric[ctx->Selector];
+    e_s16 (*pInS)[VITERBI_MAX_BATCH]  = ctx->State[ctx->Selector];
+    e_s16 (*pOutM)[VITERBI_MAX_BATCH] = ctx->Metric[1 - ctx->Selector];
+    e_s16 (*pOutS)[VITERBI_MAX_BATCH] = ctx->State[1 - ctx->Selector];
+
+    ctx->Selector ^= 1;		/* Toggle for next call */
+
+    for (i = 0; i < Iterations; i++) {
+	for (lane = 0; lane < NumLanes; lane++) {
+	    esMetricIn = ctx->BranchMetrics[i][lane];
+
+	    pOutM[2*i][lane]   = pInM[i][lane] - esMetricIn;
+	    pOutM[2*i+1][lane] = pInM[i][lane] + esMetricIn;
+	    pOutS[2*i][lane]   = (pInS[i][lane] << 1);
+	    pOutS[2*i+1][lane] = (pInS[i][lane] << 1)|1;
+	}
+    }
+} /* BatchPreACS */
+
+/*
+ * FUNC: BatchACS
+ *
+ * DESC: ACS for all lanes. Each butterfly is evaluated BATCH_LANES packets
+ * at a time with the same branch-free select as the structure-of-arrays ACS.
+ */
+static void BatchACS(ViterbiBatchContext *ctx, n_int NumLanes)
+{
+    n_int i, lane;
+
+    e_s16 (*pInM)[VITERBI_MAX_BATCH]  = ctx->Metric[ctx->Selector];
+    e_s16 (*pInS)[VITERBI_MAX_BATCH]  = ctx->State[ctx->Selector];
+    e_s16 (*pOutM)[VITERBI_MAX_BATCH] = ctx->Metric[1 - ctx->Selector];
+    e_s16 (*pOutS)[VITERBI_MAX_BATCH] = ctx->State[1 - ctx->Selector];
+
+    ctx->Selector ^= 1;		/* Toggle for next call */
+
+    for (i = 0; i < NUMSTATES/2; i++) {
+	e_s16 *pBm  = ctx->BranchMetrics[i];
+	e_s16 *pM1  = pInM[i],  *pM2  = pInM[i + NUMSTATES/2];
+	e_s16 *pS1  = pInS[i],  *pS2  = pInS[i + NUMSTATES/2];
+	e_s16 *pOMe = pOutM[2*i], *pOMo = pOutM[2*i+1];
+	e_s16 *pOSe = pOutS[2*i], *pOSo = pOutS[2*i+1];
+
+	for (lane = 0; lane < NumLanes; lane += BATCH_LANES) {
+#if defined(__SSE2__)
+	    __m128i vBm, vM1, vM2, vS1, vS2, vT1, vT2, vMask, vSel;
+
+	    vBm = _mm_loadu_si128((const __m128i *)(pBm + lane));
+	    vM1 = _mm_loadu_si128((const __m128i *)(pM1 + lane));
+	    vM2 = _mm_loadu_si128((const __m128i *)(pM2 + lane));
+	    vS1 = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(pS1 + lane)), 1);
+	    vS2 = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(pS2 + lane)), 1);
+
+	    vT1   = _mm_sub_epi16(vM1, vBm);
+	    vT2   = _mm_add_epi16(vM2, vBm);
+	    vMask = _mm_cmpgt_epi16(vT2, vT1);
+	    vSel  = _mm_or_si128(_mm_and_si128(vMask, vS2), _mm_andnot_si128(vMask, vS1));
+	    _mm_storeu_si128((__m128i *)(pOMe + lane), _mm_max_epi16(vT1, vT2));
+	    _mm_storeu_si128((__m128i *)(pOSe + lane), vSel);
+
+	    vT1   = _mm_add_epi16(vM1, vBm);
+	    vT2   = _mm_sub_epi16(vM2, vBm);
+	    vMask = _mm_cmpgt_epi16(vT2, vT1);
+	    vSel  = _mm_or_si128(_mm_and_si128(vMask, vS2), _mm_andnot_si128(vMask, vS1));
+	    _mm_storeu_si128((__m128i *)(pOMo + lane), _mm_max_epi16(vT1, vT2));
+	    _mm_storeu_si128((__m128i *)(pOSo + lane), _mm_or_si128(vSel, _mm_set1_epi16(1)));
+#elif defined(__ARM_NEON)
+	    int16x8_t vBm, vM1, vM2, vS1, vS2, vT1, vT2;
+	    uint16x8_t vMask;
+
+	    vBm = vld1q_s16(pBm + lane);
+	    vM1 = vld1q_s16(pM1 + lane);
+	    vM2 = vld1q_s16(pM2 + lane);
+	    vS1 = vshlq_n_s16(vld1q_s16(pS1 + lane), 1);
+	    vS2 = vshlq_n_s16(vld1q_s16(pS2 + lane), 1);
+
+	    vT1   = vsubq_s16(vM1, vBm);
+	    vT2   = vaddq_s16(vM2, vBm);
+	    vMask = vcgtq_s16(vT2, vT1);
+	    vst1q_s16(pOMe + lane, vmaxq_s16(vT1, vT2));
+	    vst1q_s16(pOSe + lane, vbslq_s16(vMask, vS2, vS1));
+
+	    vT1   = vaddq_s16(vM1, vBm);
+	    vT2   = vsubq_s16(vM2, vBm);
+	    vMask = vcgtq_s16(vT2, vT1);
+	    vst1q_s16(pOMo + lane, vmaxq_s16(vT1, vT2));
+	    vst1q_s16(pOSo + lane, vorrq_s16(vbslq_s16(vMask, vS2, vS1), vdupq_n_s16(1)));
+#else
+	    n_int k;
+	    e_s16 esMetric1, esMetric2, esState1, esState2, esMask;
+
+	    for (k = lane; k < lane + BATCH_LANES; k++) {
+		esState1 = (pS1[k] << 1);
+		esState2 = (pS2[k] << 1);
+
+		esMetric1 = pM1[k] - pBm[k];
+		esMetric2 = pM2[k] + pBm[k];
+		esMask    = -(esMetric2 > esMetric1);
+		pOMe[k] = (esMetric1 & ~esMask) | (esMetric2 & esMask);
+		pOSe[k] = (esState1 & ~esMask) | (esState2 & esMask);
+
+		esMetric1 = pM1[k] + pBm[k];
+		esMetric2 = pM2[k] - pBm[k];
+		esMask    = -(esMetric2 > esMetric1);
+		pOMo[k] = (esMetric1 & ~esMask) | (esMetric2 & esMask);
+		pOSo[k] = ((esState1 & ~esMask) | (esState2 & esMask)) | 1;
+	    }
+#endif
+	}
+    }
+} /* BatchACS */
+
+/*
+ * FUNC: BatchStorePaths
+ *
+ * DESC: StorePaths for all lanes.
+ */
+static void BatchStorePaths(ViterbiBatchContext *ctx, e_s16 (*PathPtr)[VITERBI_MAX_BATCH],
+			    n_int NumLanes)
+{
+    n_int i, lane;
+    e_s16 (*pInS)[VITERBI_MAX_BATCH] = ctx->State[ctx->Selector];
+
+    for (i = 0; i < NUMSTATES; i++) {
+	for (lane = 0; lane < NumLanes; lane++) {
+	    PathPtr[i][lane] = (pInS[i][lane] >> 5);
+	    pInS[i][lane] &= 0x1f;
+	}
+    }
+} /* BatchStorePaths */
+
+/*
+ * FUNC: BatchTraceBack
+ *
+ * DESC: TraceBack of a single lane of the batch survivor memory.
+ */
+static void BatchTraceBack(ViterbiBatchContext *ctx, e_s16 *pOut,
+			   e_s16 (*pIn)[VITERBI_MAX_BATCH], n_int lane)
+{
+    n_int i;
+    n_int offset = 0;
+    e_s16 PathBits1, PathBits2;
+
+    pOut += (MAX_DATA_SIZE / 8) / 2;			/* Point to last stage */
+    pIn[0][lane] = ctx->State[ctx->Selector][0][lane];
+
+    if (!EVENMULTIPLEOF8) {
+	PathBits2 = pIn[0][lane];
+	offset = (PathBits2 & 0xf8) >> 3;
+	pIn -= NUMSTATES;
+
+	*pOut-- = (PathBits2 << 8);
+    }
+
+    /* Process 16 bits in each iteration */
+    for (i = 0; i < ((MAX_DATA_SIZE / 8) / 2); i++) {
+	PathBits1 = pIn[offset][lane];		/* Extract lower byte */
+	offset = (PathBits1 & 0xf8) >> 3;
+	pIn -= NUMSTATES;
+
+	PathBits2 = pIn[offset][lane];		/* Extract upper byte */
+	offset = (PathBits2 & 0xf8) >> 3;
+	pIn -= NUMSTATES;
+
+	*pOut-- = (PathBits2 << 8) | PathBits1;	/* Store as 16-bit word */
+    }
+} /* BatchTraceBack */
+
+/*
+ * FUNC: ViterbiBatchContextInit
+ *
+ * DESC: Allocates and clears a batched decoder context.
+ *
+ * RETURNS: The new context, or NULL if the allocation failed.
+ */
+ViterbiBatchContext *ViterbiBatchContextInit(void)
+{
+    ViterbiBatchContext *ctx;
+    size_t i;
+    e_u8 *p;
+
+#if VITERBI_BM_TABLE
+    InitBranchMetricTable();
+#endif
+
+    ctx = (ViterbiBatchContext *)th_malloc(sizeof(ViterbiBatchContext));
+    if (ctx == NULL)
+	return NULL;
+
+    p = (e_u8 *)ctx;
+    for (i = 0; i < sizeof(ViterbiBatchContext); i++)
+	p[i] = 0;
+
+    return ctx;
+} /* ViterbiBatchContextInit */
+
+/*
+ * FUNC: ViterbiBatchContextFree
+ *
+ * DESC: Releases a context obtained from ViterbiBatchContextInit().
+ */
+void ViterbiBatchContextFree(ViterbiBatchContext *ctx)
+{
+    if (ctx != NULL)
+	th_free(ctx);
+} /* ViterbiBatchContextFree */
+
+/*
+ * FUNC: ViterbiBatchDecode
+ *
+ * DESC: Decodes NumPackets (1..VITERBI_MAX_BATCH) independent packets.
+ * EncodedStreamPtrs[n] and DecodedStreamPtrs[n] are the input and output of
+ * packet n, in the same format as ViterbiDecode. The result for each
+ * packet is identical to decoding it alone.
+ */
+void ViterbiBatchDecode(ViterbiBatchContext *ctx, e_s16 **EncodedStreamPtrs,
+			e_s16 **DecodedStreamPtrs, n_int NumPackets)
+{
+    n_int i, j, lane;
+    n_int iter, step;
+    n_int NumLanes;
+    e_s16 (*PathPtr)[VITERBI_MAX_BATCH] = ctx->SavedPath;
+
+    NumLanes = (NumPackets + BATCH_LANES - 1) & ~(BATCH_LANES - 1);
+
+    /* Initialize the state path metric buffers */
+    ctx->Selector = 0;
+    for (lane = 0; lane < NumLanes; lane++) {
+	ctx->Metric[0][0][lane] = 0x0ff;	/* Give state 0 higher metric */
+	ctx->State[0][0][lane] = 0;
+	for (i = 1; i < NUMSTATES; i++) {
+	    ctx->Metric[0][i][lane] = 0;
+	}
+    }
+
+    step = 0;
+    iter = 1;
+    for (i = 0; i < ENCBITS; i++) {
+	BatchFindMetrics(ctx, EncodedStreamPtrs, step++, NumPackets, NumLanes);
+	BatchPreACS(ctx, iter, NumLanes);
+	iter *= 2;
+    }
+
+    for (i = 0; i < MAX_DATA_SIZE/8-1; i++) {
+	for (j = 0; j < 8; j++) {
+	    BatchFindMetrics(ctx, EncodedStreamPtrs, step++, NumPackets, NumLanes);
+	    BatchACS(ctx, NumLanes);
+	}
+	BatchStorePaths(ctx, PathPtr, NumLanes);
+	PathPtr += NUMSTATES;
+    }
+
+    /* Process remaining bits */
+    for (i = 0; i < 8-ENCBITS; i++) {
+	BatchFindMetrics(ctx, EncodedStreamPtrs, step++, NumPackets, NumLanes);
+	BatchACS(ctx, NumLanes);
+    }
+
+    for (lane = 0; lane < NumPackets; lane++) {
+	BatchTraceBack(ctx, DecodedStreamPtrs[lane], PathPtr, lane);
+    }
+} /* ViterbiDecoderIS136Batch */
+
+/*
+ * FUNC: ViterbiDecoderIS136Batch
+ *
+ * DESC: Decodes a batch of packets using the default batch context.
+ * Not reentrant.
+ */
+void ViterbiDecoderIS136Batch(e_s16 **EncodedStreamPtrs, e_s16 **DecodedStreamPtrs,
+			      n_int NumPackets)
+{
+#if VITERBI_BM_TABLE
+    InitBranchMetricTable();
+#endif
+    ViterbiBatchDecode(&DefaultBatchContext, EncodedStreamPtrs, DecodedStreamPtrs,
+		       NumPackets);
+} /* ViterbiDecoderIS136Batch */
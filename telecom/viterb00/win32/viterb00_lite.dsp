@@ -91,6 +91,14 @@ SOURCE=..\bmark_lite.c
 
 SOURCE=..\Viterb00.c
 # End Source File
+# Begin Source File
+
+SOURCE=..\trellis.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\conven00\conven00.c
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
@@ -133,6 +133,10 @@ char *ops[] = { "INIT", "MALLOC", "FREE" };
 static int cm( const char *magic, const char *value );
 #endif
 
+#if !COMPILE_OUT_HEAP && HEAP_ALLOCATOR != HEAP_FIRST_FIT
+static void *sheap_initialize( char *start, BlockSize size );
+#endif
+
 /*lint -e740*/
 
 /*----------------------------------------------------------------------------*/
@@ -188,6 +192,8 @@ void *heap_initialize( char *start, BlockSize size )
 	start=start;
 	size=size;
    return NULL;
+#elif HEAP_ALLOCATOR != HEAP_FIRST_FIT
+   return sheap_initialize( start, size );
 #else
 
    Heap *xheap;
@@ -266,6 +272,525 @@ static int cm( const char *magic, const char *value )
    }
 #endif
 
+#if HEAP_ALLOCATOR != HEAP_FIRST_FIT
+
+/*------------------------------------------------------------------------------
+ * Segregated Fit and Arena Heaps (see HEAP_ALLOCATOR in thcfg.h)
+ *
+ * Both carve blocks off the bottom of the region, at 'top', and neither
+ * splits or combines blocks, so heap_alloc() and heap_free() take the same
+ * few steps no matter how the heap is used.
+ *
+ * The segregated fit heap puts a header with the size class in front of each
+ * block.  The classes step by a quarter of each power of two, so a block is
+ * at most a quarter bigger than asked for.  heap_free() pushes a block onto
+ * the free list of its class, and heap_alloc() pops the list of the class
+ * asked for, else carves a new block, else takes a block of a bigger class.
+ *
+ * The arena heap has no headers and its heap_free() returns nothing to the
+ * heap; all the memory comes back with heap_reset().
+ * ---------------------------------------------------------------------------*/
+
+#define SHEAP_MIN_SHIFT (5)   /* the smallest class is 32 bytes */
+#define SHEAP_CLASSES   (4 * ( 31 - SHEAP_MIN_SHIFT ) + 1) /* up to 2Gb */
+
+typedef struct SBlok
+   {
+   BlockSize sclass;      /* size class of this block */
+#if       TURN_ON_VERIFY_HEAP
+   char      magic[ 8 ];
+#endif
+   }
+SBlok;
+
+typedef struct SHeap
+   {
+   BlockSize size;         /* total size of the heap                 */
+   BlockSize freed;        /* useable space in the free lists        */
+   BlockSize num_freed;    /* number of blocks in the free lists     */
+   BlockSize num_alloced;  /* number of allocated blocks             */
+   char     *first;        /* the first block in the heap            */
+   char     *top;          /* the space not yet carved into blocks   */
+   char     *end;          /* the end of the heap                    */
+#if      HEAP_ALLOCATOR == HEAP_SEGREGATED
+   void     *freel[ SHEAP_CLASSES ]; /* the free list of each class */
+#endif
+#if      TURN_ON_VERIFY_HEAP
+   char     magic[ 8 ];
+#endif
+   }
+SHeap;
+
+/* The size of the block header and the heap structure, rounded up to the
+ * heap alignment boundary.  Arena blocks have no header. */
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+#define SBSIZE ((BlockSize)(HEAP_ALIGN(sizeof( SBlok ))))
+#else
+#define SBSIZE ((BlockSize)0)
+#endif
+#define SHSIZE ((BlockSize)(HEAP_ALIGN(sizeof( SHeap ))))
+
+#define SHEAP ((SHeap*)theap)
+
+/* The space left at the top of the heap */
+#define SWILD( h ) ((BlockSize)((h) -> end - (h) -> top))
+
+/* A free block links its free list in its first word */
+#define SNEXT_PTR( blk ) (*(void**)PTR_ADD( blk, SBSIZE ))
+
+#if TURN_ON_VERIFY_HEAP
+#define SVERIFY_HEAP(h) { assert( theap != NULL );                          \
+                          assert( !cm(((SHeap*)h)->magic, HEAP_MAGIC  )); }
+
+#define SVERIFY_BLOK(b) { assert( b != NULL );                              \
+                          assert( !cm(((SBlok*)b)->magic, BLOCK_MAGIC )); }
+#else
+#define SVERIFY_HEAP(h)  {((void)0);}
+#define SVERIFY_BLOK(b)  {((void)0);}
+#endif
+
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+/*------------------------------------------------------------------------------
+ * FUNC   : sheap_class_size
+ *
+ * RETURNS: The size of the blocks of class c, header included
+ * ---------------------------------------------------------------------------*/
+
+static BlockSize sheap_class_size( int c )
+
+   {
+   int k;
+
+   if (c == 0)
+      return (BlockSize) 1 << SHEAP_MIN_SHIFT;
+
+   k = SHEAP_MIN_SHIFT + ( c - 1 ) / 4;
+
+   return HEAP_ALIGN(( (BlockSize) 1 << k ) +
+      (BlockSize)( ( c - 1 ) % 4 + 1 ) * ( (BlockSize) 1 << ( k - 2 ) ));
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : sheap_class
+ *
+ * RETURNS: The smallest class whose blocks hold 'need' bytes, header
+ *          included.  The loop runs once per bit of 'need' at most.
+ * ---------------------------------------------------------------------------*/
+
+static int sheap_class( BlockSize need )
+
+   {
+   BlockSize m;
+   int       k;
+
+   if (need <= (BlockSize) 1 << SHEAP_MIN_SHIFT)
+      return 0;
+
+   m = need - 1;
+   for (k = SHEAP_MIN_SHIFT; ( m >> ( k + 1 ) ) != 0; k++)
+      ;
+
+   /* the two bits below the top one pick the quarter */
+   return ( k - SHEAP_MIN_SHIFT ) * 4 + (int)(( m >> ( k - 2 ) ) & 3 ) + 1;
+   }
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : sheap_initialize
+ *
+ * DESC   : heap_initialize() for the segregated fit and arena heaps
+ * ---------------------------------------------------------------------------*/
+
+static void *sheap_initialize( char *start, BlockSize size )
+
+   {
+   SHeap *xheap;
+
+   if (size < SHSIZE + SBSIZE)
+      return NULL;
+
+   xheap = ( SHeap * ) start;
+   xheap -> size = size;
+   xheap -> first = ( char * ) PTR_ADD( start, SHSIZE );
+   xheap -> end = ( char * ) PTR_ADD( start, size );
+
+   INIT_MAGIC( xheap, HEAP_MAGIC );/* init the magic number */
+
+   heap_reset( xheap );
+
+   dpf1( "Heap Ptr         = %p\n", xheap );
+   dpf1( "Heap First       = %p\n", xheap -> first );
+   dpf2( "Heap Size        = %ld (%08lX)\n", xheap -> size, xheap -> size );
+
+   return (void *) xheap;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : heap_reset
+ *
+ * DESC   : Reset the heap so that it is empty!
+ *
+ *          After this function returns, the heap will be in the same state
+ *          as it was after heap_initialize returned
+ * ---------------------------------------------------------------------------*/
+
+void heap_reset( void *theap )
+
+   {
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   int c;
+#endif
+
+   SVERIFY_HEAP( SHEAP );
+
+   SHEAP -> top = SHEAP -> first;
+   SHEAP -> freed = 0;
+   SHEAP -> num_freed = 0;
+   SHEAP -> num_alloced = 0;
+
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   for (c = 0; c < SHEAP_CLASSES; c++)
+      SHEAP -> freel[ c ] = NULL;
+#endif
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : heap_alloc
+ *
+ * DESC   : Allocates a block of memory from the heap
+ *
+ * RETURNS: A pointer to the allocated buffer.  If there is not a free
+ *          block big enough, then NULL is returned
+ * ---------------------------------------------------------------------------*/
+
+void *heap_alloc( void *theap, BlockSize size )
+
+   {
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   SBlok    *blk;
+   BlockSize csize;
+   int       c;
+#else
+   void     *buf;
+#endif
+
+   SVERIFY_HEAP( SHEAP );
+
+   REC_MALLOC; /* record that a malloc happend */
+
+   if (size > SHEAP -> size)
+      return NULL;
+
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   c = sheap_class( size + SBSIZE );
+   if (c >= SHEAP_CLASSES)
+      return NULL;
+   csize = sheap_class_size( c );
+
+   if (SHEAP -> freel[ c ] == NULL && SWILD( SHEAP ) >= csize)
+      {
+      /* carve a new block off the top */
+      blk = ( SBlok * ) SHEAP -> top;
+      SHEAP -> top += csize;
+
+      blk -> sclass = (BlockSize) c;
+      INIT_MAGIC( blk, BLOCK_MAGIC ); /* init the magic number */
+      }
+   else
+      {
+      /* no room at the top, so settle for a bigger free block */
+      while (c < SHEAP_CLASSES && SHEAP -> freel[ c ] == NULL)
+         c++;
+      if (c == SHEAP_CLASSES)
+         return NULL;
+
+      blk = ( SBlok * ) SHEAP -> freel[ c ];
+      SVERIFY_BLOK( blk );
+
+      SHEAP -> freel[ c ] = SNEXT_PTR( blk );
+      SHEAP -> num_freed--;
+      SHEAP -> freed -= sheap_class_size( c ) - SBSIZE;
+      }
+
+   SHEAP -> num_alloced++;
+
+   return (void *) PTR_ADD( blk, SBSIZE );
+#else
+   size = size == 0 ? HEAP_ALIGN_V : HEAP_ALIGN( size );
+   if (SWILD( SHEAP ) < size)
+      return NULL;
+
+   buf = SHEAP -> top;
+   SHEAP -> top += size;
+   SHEAP -> num_alloced++;
+
+   return buf;
+#endif
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : heap_free
+ *
+ * DESC   : frees a block
+ *
+ *          Puts the block on the free list of its class.  The arena heap
+ *          only counts it; its space comes back with heap_reset().
+ *
+ * PARAMS : heap - a pointer to the heap structure that defines the heap
+ *          buf  - the buffer to free
+ * ---------------------------------------------------------------------------*/
+
+void heap_free( void *theap, void *buff )
+
+   {
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   SBlok *blk;
+   int    c;
+#endif
+
+   REC_FREE;       /* record that a free happend */
+
+   SVERIFY_HEAP( SHEAP );
+
+   if (buff == 0)
+      return;
+
+   SHEAP -> num_alloced--;
+
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   blk = ( SBlok * ) PTR_SUB( buff, SBSIZE );
+
+   SVERIFY_BLOK( blk );
+
+   c = (int) blk -> sclass;
+#if TURN_ON_VERIFY_HEAP
+   assert( c < SHEAP_CLASSES );
+#endif
+
+   SNEXT_PTR( blk ) = SHEAP -> freel[ c ];
+   SHEAP -> freel[ c ] = blk;
+   SHEAP -> num_freed++;
+   SHEAP -> freed += sheap_class_size( c ) - SBSIZE;
+#endif
+   }
+
+#if !defined(NDEBUG)
+/*------------------------------------------------------------------------------
+ * FUNC   : heap_check
+ *
+ * DESC   : check the heap to see if it is ok.
+ *
+ *          Checks the top of the heap, and walks the free lists checking
+ *          that each block is inside the heap and of the list's class, and
+ *          that the lists add up to the free counts.
+ *
+ * RETURNS: 0 if the heap is ok
+ *          If the heap is not ok, then a bit mask value is returned.
+ *          indicating the problem(s) found.
+ *
+ * PARAMS : heap - a pointer to the heap structure that defines the heap
+ * ---------------------------------------------------------------------------*/
+
+long heap_check( void *theap )
+
+   {
+   long      rv = 0;
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   SBlok    *blk;
+   BlockSize free_size = 0;
+   BlockSize num_free = 0;
+   int       c;
+#endif
+
+#if TURN_ON_VERIFY_HEAP
+   assert( theap != NULL );
+
+   if (cm( SHEAP -> magic, HEAP_MAGIC ))
+      {
+      dpf0( "$$ Bad Heap Structure\n" );
+      return HERR_BAD_HEAP_STRUCT;
+      }
+#endif
+
+   if (SHEAP -> top < SHEAP -> first || SHEAP -> top > SHEAP -> end)
+      {
+      dpf0( "$$ Heap Top Outside The Heap\n" );
+      return HERR_TOTAL_SIZE_BAD;
+      }
+
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   for (c = 0; c < SHEAP_CLASSES && rv == 0; c++)
+      {
+      for (blk = ( SBlok * ) SHEAP -> freel[ c ]; blk != NULL;
+           blk = ( SBlok * ) SNEXT_PTR( blk ))
+         {
+         if (( char * ) blk < SHEAP -> first ||
+             ( char * ) blk + sheap_class_size( c ) > SHEAP -> top)
+            {
+            dpf1( "$$ Free Block Outside The Heap (class %d)\n", c );
+            rv |= HERR_BAD_FL_NEXT;
+            break;
+            }
+
+#if TURN_ON_VERIFY_HEAP
+         if (cm( blk -> magic, BLOCK_MAGIC ))
+            {
+            dpf0( "$$ Bad Block\n" );
+            return HERR_FL_BLOCK_BAD;
+            }
+#endif
+
+         if (blk -> sclass != (BlockSize) c)
+            {
+            dpf2( "$$ Block of class %lu in free list %d\n", blk -> sclass, c );
+            rv |= HERR_FL_BLOCK_BAD;
+            break;
+            }
+
+         /* a loop in a list would run forever */
+         if (++num_free > SHEAP -> num_freed)
+            {
+            rv |= HERR_BAD_FL_TOO_MANY;
+            break;
+            }
+
+         free_size += sheap_class_size( c ) - SBSIZE;
+         }
+      }
+
+   if (rv == 0)
+      {
+      if (num_free != SHEAP -> num_freed)
+         {
+         dpf2( "$$ num_free{%lu} != xheap->num_freed{%lu}\n", num_free, SHEAP -> num_freed );
+         rv |= HERR_NUM_FREE_BAD;
+         }
+
+      if (free_size != SHEAP -> freed)
+         {
+         dpf2( "$$ free_size{%lu} != xheap->freed{%lu}\n", free_size, SHEAP -> freed );
+         rv |= HERR_FREE_SIZE_BAD;
+         }
+      }
+#endif
+
+   return rv;
+   }
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : heap_free_space
+ *
+ * DESC   : Returns the total free space in the heap
+ * ---------------------------------------------------------------------------*/
+
+BlockSize heap_free_space( void *theap )
+
+   {
+   BlockSize wild = SWILD( SHEAP );
+
+   return SHEAP -> freed + ( wild > SBSIZE ? wild - SBSIZE : 0 );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : heap_biggest_free_block
+ *
+ * RETURNS: The size of the biggest free block
+ * ---------------------------------------------------------------------------*/
+
+BlockSize heap_biggest_free_block( void *theap )
+
+   {
+   BlockSize wild = SWILD( SHEAP );
+   BlockSize biggest_blok = wild > SBSIZE ? wild - SBSIZE : 0;
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   int       c;
+#endif
+
+   SVERIFY_HEAP( SHEAP );
+
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   for (c = SHEAP_CLASSES - 1; c >= 0; c--)
+      {
+      if (SHEAP -> freel[ c ] != NULL)
+         {
+         if (sheap_class_size( c ) - SBSIZE > biggest_blok)
+            biggest_blok = sheap_class_size( c ) - SBSIZE;
+         break;
+         }
+      }
+#endif
+
+   return biggest_blok;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : heap_stats
+ *
+ * DESC   : Gets the heap statistics.  The space not yet carved counts as
+ *          one free block.
+ *
+ * PARAMS : heap - a pointer to the heap
+ *          stats - a pointer to a heap statistics structure to fill out
+ * ---------------------------------------------------------------------------*/
+
+void heap_stats( void *theap, HeapStats *stats )
+
+   {
+   SVERIFY_HEAP( SHEAP );
+
+   stats -> size = SHEAP -> size;
+   stats -> free = heap_free_space( theap );
+   stats -> num_free = SHEAP -> num_freed + ( SWILD( SHEAP ) > SBSIZE ? 1 : 0 );
+   stats -> num_alloced = SHEAP -> num_alloced;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : heap_dump
+ *
+ * DESC   : Dumps the heap
+ * ---------------------------------------------------------------------------*/
+
+#if !defined(NDEBUG)
+
+void heap_dump( void *theap )
+
+   {
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   void     *blk;
+   BlockSize n;
+   int       c;
+#endif
+
+   theap = theap; /* only the debug printf's use it */
+
+   SVERIFY_HEAP( SHEAP );
+
+   dpf0( "\n" );
+   dpf1( "Heap Ptr         = %p\n", SHEAP );
+   dpf1( "Heap First       = %p\n", SHEAP -> first );
+   dpf1( "Heap Top         = %p\n", SHEAP -> top );
+   dpf1( "Heap End         = %p\n", SHEAP -> end );
+   dpf2( "Heap Size        = %ld (%08lX)\n", SHEAP -> size, SHEAP -> size );
+   dpf2( "Heap Free        = %ld (%08lX)\n", heap_free_space( theap ), heap_free_space( theap ));
+   dpf1( "Heap Num Freed   = %ld\n", SHEAP -> num_freed );
+   dpf1( "Heap Num Alloced = %ld\n", SHEAP -> num_alloced );
+
+#if HEAP_ALLOCATOR == HEAP_SEGREGATED
+   for (c = 0; c < SHEAP_CLASSES; c++)
+      {
+      for (n = 0, blk = SHEAP -> freel[ c ]; blk != NULL; blk = SNEXT_PTR( blk ))
+         n++;
+
+      if (n > 0)
+         dpf3( "class %3d size=%8ld free=%8ld\n", c, sheap_class_size( c ), n );
+      }
+#endif
+   }
+#endif
+
+#else /* HEAP_ALLOCATOR == HEAP_FIRST_FIT */
+
 /*------------------------------------------------------------------------------
  * FUNC   : heap_reset
  *
@@ -1015,6 +1540,7 @@ void heap_dump( void *theap )
    }
 #endif
 
+#endif /* HEAP_ALLOCATOR */
 
 #endif /* COMPILE_OUT_HEAP */
 
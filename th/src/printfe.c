@@ -116,7 +116,7 @@ static void prt_l( char **_ptrbf, int prec, unsigned int b, unsigned long x, int
 
    {
    int   n;
-   char  tmpbuf[ 12 ];
+   char  tmpbuf[ 24 ];   /* 22 octal digits for a 64 bit long */
    char *cptr;
 
    cptr = tmpbuf;
@@ -133,7 +133,10 @@ static void prt_l( char **_ptrbf, int prec, unsigned int b, unsigned long x, int
    while (x);
 
    if (( prec != 0 ) && ( n > prec ))
+      {
       cptr = tmpbuf + prec;
+      n = prec;
+      }
 
    while (n--)
       {
@@ -48,6 +48,51 @@ extern "C" {
    size_t al_signal_finished( void );
    void   al_exit( int exit_code, const char *fmt, va_list args );
    void	al_report_results( void );
+   int    al_run_copies( int copies, size_t (*run)( int copy ), size_t *durations,
+                          double *seconds );
+   int    al_cpu_count( void );
+   int    al_pin_cpu( int cpu );
+   const char *al_cpu_scaling( int cpu );
+   e_u32  al_cpu_features( void );
+
+   /* Stack high water mark, see TH_FOOTPRINT in thcfg.h */
+   void   al_stack_paint( void );
+   size_t al_stack_used( void );
+
+   /* Hardware counters over the timed region, see TARGET_PERF_COUNTERS */
+#define AL_PERF_CYCLES        0
+#define AL_PERF_INSTRUCTIONS  1
+#define AL_PERF_BRANCH_MISSES 2
+#define AL_PERF_L1D_MISSES    3
+#define AL_PERF_LLC_MISSES    4
+#define AL_PERF_COUNTERS      5
+
+   int    al_perf_counts( size_t *counts );
+
+   /* Energy over the timed region, see TARGET_ENERGY in thcfg.h */
+   int    al_energy( size_t *uj );
+
+   /* Results records, see TH_RESULTS in thcfg.h */
+   const char *al_timer_name( void );
+   int    al_write_record( const char *path, const char *header, const char *record );
+
+   /* Data set files, see TH_DATA_FILES in thcfg.h */
+   struct FileDef;
+   int    al_map_file( const char *path, struct FileDef *fd );
+
+   /* Cache cold runs, see TH_CACHE_COLD in thcfg.h */
+   int    al_evict_caches( void );
+
+   /* Wall clock and worker threads, see TH_THREADS in thcfg.h */
+   struct THPool;
+   double al_wall_seconds( void );
+   struct THPool *al_pool_open( int threads );
+   void   al_pool_run( struct THPool *pool, void (*run)( void *arg, int part ), void *arg );
+   void   al_pool_close( struct THPool *pool );
+
+   /* Co-runners, see TH_CORUN in thcfg.h */
+   int    al_start_corunners( int n, int load, void (*bench)( void ) );
+   void   al_stop_corunners( void );
 
    extern char *mem_base;
    extern BlockSize mem_size;
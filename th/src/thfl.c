@@ -11,15 +11,19 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <stdlib.h>	/* atol, atoi, getenv */
 
 #if !USE_TH_PRINTF
 /* get the compiler's printf stuff
 #include <stdarg.h>
  */
-#include <stdlib.h>	/* atol */
 #include <stdio.h>
 #endif
 
+#if FLOAT_SUPPORT
+#include <math.h>	/* log, exp for the suite score */
+#endif
+
 #include "thfl.h"
 #include "thfli.h"
 #include "printfe.h"
@@ -53,6 +57,141 @@ LoopCount iterations = 0;
 
 static int autogo = FALSE;
 
+/* Iteration calibration and copies, see TH_CALIBRATE and TH_COPIES in
+ * thcfg.h.  i_report_results() records each run's duration in
+ * 'last_duration'.  While 'quiet' is set the console output is dropped and
+ * that is all it does.
+*/
+static size_t calibrate_secs = TH_CALIBRATE ? TH_CALIBRATE_SECONDS : 0;
+static int    copies         = TH_COPIES;
+static int    quiet          = FALSE;
+static e_u32  last_duration  = 0;
+
+/* Repeated trials and pinning, see TH_TRIALS and TH_PIN_CPU in thcfg.h.
+ * report_trials() leaves the iterations/sec statistics of the trials in
+ * 'trial_' for the results record, the interval as its half width.
+*/
+static int    trials         = TH_TRIALS;
+static int    pin_cpu        = TH_PIN_CPU;
+static int    trial_count    = 0;
+#if FLOAT_SUPPORT
+static double trial_mean     = 0.0;
+static double trial_sd       = 0.0;
+static double trial_half     = 0.0;
+#endif
+
+/* Kernel variants, see TH_KERNEL_ENV in thcfg.h.  'kernel_opt' is the
+ * -kernel= list.  i_kernel_select() records the variant each kernel picked
+ * in 'kernels' for the next report, which clears them.
+*/
+static const char *kernel_opt = NULL;
+static struct {
+   const char *kernel;
+   const char *variant;
+} kernels[ TH_MAX_KERNELS ];
+static int    kernel_count   = 0;
+
+#if TH_OVERHEAD
+/* Harness overhead, see TH_OVERHEAD in thcfg.h.  measure_overhead() calls
+ * empty_kernel() through the volatile 'overhead_kernel', which keeps the
+ * call and the loop around it.  report_overhead() leaves the ticks of the
+ * benchmark in 'overhead_raw' and those of the empty loop, taken out of
+ * them, in 'overhead_ticks' for the results record.
+*/
+static void   empty_kernel( void );
+static void   (* volatile overhead_kernel)( void ) = empty_kernel;
+static int    overhead_done  = FALSE;
+static e_u32  overhead_raw   = 0;
+static e_u32  overhead_ticks = 0;
+#endif
+
+#if TH_CACHE_COLD
+/* Cache cold runs, see TH_CACHE_COLD in thcfg.h.  While 'cold' is set
+ * i_evict_caches() evicts the caches and adds the ticks it took to
+ * 'cold_ticks', which i_signal_finished() takes out of the duration.
+*/
+static int    cold           = FALSE;
+static int    cold_failed    = FALSE;
+static size_t cold_ticks     = 0;
+#endif
+
+#if TH_FOOTPRINT
+/* Memory footprint, see TH_FOOTPRINT in thcfg.h.  Each th_malloc() block
+ * starts with a FOOT_HDR byte header holding the size asked for, which keeps
+ * the alignment of the block behind it.  'foot_bytes' and 'foot_blocks' are
+ * live, the peaks count from the 'foot_base_' ones foot_start() found, and
+ * i_signal_finished() reads the stack high water mark into 'foot_stack'.
+*/
+#define FOOT_HDR        (16)
+
+static size_t foot_bytes         = 0;
+static size_t foot_blocks        = 0;
+static size_t foot_base_bytes    = 0;
+static size_t foot_base_blocks   = 0;
+static size_t foot_peak_bytes    = 0;
+static size_t foot_peak_blocks   = 0;
+static size_t foot_stack         = 0;
+#endif
+
+/* Co-runner runs, see TH_CORUN in thcfg.h.  'corun_names' are the -corun=
+ * names of the TH_CORUN_ loads.
+*/
+static int    corun          = TH_CORUN;
+static int    corun_copies   = TH_CORUN_COPIES;
+static const char *corun_names[] = { "none", "stream", "llc", "bench" };
+
+/* Suite runs, see TH_MAX_SUITE in thcfg.h.  'fixed_iterations' is set when
+ * the iterations came from -i<n> or 'n' and so apply to every benchmark.
+*/
+static int        parallel         = FALSE;
+static int        fixed_iterations = FALSE;
+static TCDef     *suite_tcdef[ TH_MAX_SUITE ];
+static LoopCount  suite_its[ TH_MAX_SUITE ];
+static int        in_suite         = FALSE;
+
+/* Results records, see TH_RESULTS in thcfg.h.  Records are built in
+ * 'rec_buf', and for CSV the matching header in 'rec_hdr'.
+*/
+#define REC_BUF_SIZE    (2048)
+#define REC_PATH_SIZE   (256)
+
+static int    results_format = TH_RESULTS;
+static char   results_path[ REC_PATH_SIZE ];
+static char   rec_buf[ REC_BUF_SIZE ];
+static char   rec_hdr[ REC_BUF_SIZE ];
+static size_t rec_len = 0;
+static size_t hdr_len = 0;
+static int    rec_fields = 0;
+static int    rec_open   = FALSE;
+
+/* Data files, see TH_DATA_FILES in thcfg.h.  i_get_file_def() maps a file
+ * the memory manager does not hold from 'data_dir' into 'data_files'.
+ * 'data_name' holds the -in= and -ref= file names, and 'data_crc' the -crc=
+ * expected CRC.
+*/
+#if TH_DATA_FILES
+#define DATA_PATH_SIZE  (REC_PATH_SIZE + FILE_NAME_SIZE)
+
+static const char *data_dir = TH_DATA_DIR;
+static const char *data_name[ TH_DATA_KINDS ];
+static FileDef     data_files[ TH_MAX_DATA_FILES ];
+static int         data_count   = 0;
+static int         data_crc_set = FALSE;
+static e_u16       data_crc     = 0;
+#endif
+
+/* Console output, see TH_CON_BUF_SIZE in thcfg.h.  Everything the functional
+ * layer sends to the logical console goes through con_write().
+*/
+#if TH_CON_BUF_SIZE
+static char   con_buf[ TH_CON_BUF_SIZE ];
+static size_t con_len = 0;
+
+static int con_write( const char *buf, size_t len );
+#else
+#define con_write( buf, len ) al_write_con( buf, len )
+#endif
+
 /*==============================================================================
  *             -- Funcational Layer Interface Functions --
  *============================================================================*/
@@ -73,6 +212,9 @@ int i_printf( const char *fmt, va_list args )
    {
    int len;
 
+   if (quiet)
+      return 0;
+
    vsprintf( pf_buf, fmt, args );  /* Do the printf stuff */
 
 #if !defined( NO_CRLF_XLATE )
@@ -81,7 +223,7 @@ int i_printf( const char *fmt, va_list args )
    len = strlen( pf_buf );
 #endif
 
-   if (al_write_con( pf_buf, (size_t) len ) == Success) /*lint !e571*/
+   if (con_write( pf_buf, (size_t) len ) == Success) /*lint !e571*/
       return len;
    else
       return 0;
@@ -126,18 +268,18 @@ int i_sends( const char *str )
    {
    int len;
 
-   if (str == NULL)
+   if (str == NULL || quiet)
       return 1;
 
 #if !defined( NO_CRLF_XLATE )
    len = xlate_nl( str, pf_buf );
-   if (al_write_con( pf_buf, (size_t) len ) != Success) /*lint !e571*/
+   if (con_write( pf_buf, (size_t) len ) != Success) /*lint !e571*/
       return -1;
    else
       return  1;
 #else
    len = strlen( str );
-   if (al_write_con( str, (size_t) len ) != Success) /*lint !e571*/
+   if (con_write( str, (size_t) len ) != Success) /*lint !e571*/
       return -1;
    else
       return  1;
@@ -167,12 +309,17 @@ int i_putchar( char c )
    {
 #if !defined( NO_CRLF_XLATE )
    const char cr = '\r';
+#endif
+
+   if (quiet)
+      return (int) c & 0xFF;
 
-   if ( c == '\n' && al_write_con( &cr, 1 ) != Success )
+#if !defined( NO_CRLF_XLATE )
+   if ( c == '\n' && con_write( &cr, 1 ) != Success )
       return -1;
 #endif
 
-   if ( al_write_con( &c, 1 ) != Success )
+   if ( con_write( &c, 1 ) != Success )
       return -1;
 
    /* Note, we 'and' the character with 0xFF >after< casting to to an
@@ -191,7 +338,10 @@ int i_putchar( char c )
 int i_write_con( const char *buf, size_t buf_size )
 
    {
-   return al_write_con( buf, buf_size );
+   if (quiet)
+      return Success;
+
+   return con_write( buf, buf_size );
    }
 
 /*------------------------------------------------------------------------------
@@ -203,6 +353,7 @@ int i_write_con( const char *buf, size_t buf_size )
 size_t i_read_con( char *buf, size_t buf_size )
 
    {
+   i_flush_con();
    return al_read_con( buf, buf_size );
    }
 
@@ -215,9 +366,59 @@ size_t i_read_con( char *buf, size_t buf_size )
 size_t i_con_chars_avail( void )
 
    {
+   i_flush_con();
    return al_con_chars_avail();
    }
 
+/*------------------------------------------------------------------------------
+ * FUNC   : i_flush_con
+ *
+ * DESC   : functional layer implimentation of th_flush_con()
+ *
+ *          Sends the console output held in 'con_buf' to al_write_con()
+ *
+ * RETURNS: Success if it was all sent, otherwise Failure
+ * ---------------------------------------------------------------------------*/
+
+int i_flush_con( void )
+
+   {
+#if TH_CON_BUF_SIZE
+   size_t len = con_len;
+
+   con_len = 0;
+   return al_write_con( con_buf, len );
+#else
+   return Success;
+#endif
+   }
+
+#if TH_CON_BUF_SIZE
+/*------------------------------------------------------------------------------
+ * FUNC   : con_write
+ *
+ * DESC   : Adds 'len' bytes to the console output in 'con_buf', flushing it
+ *          when it is full.  Blocks too big for the buffer are sent straight
+ *          to al_write_con() after what it already holds.
+ *
+ * RETURNS: Success or Failure
+ * ---------------------------------------------------------------------------*/
+
+static int con_write( const char *buf, size_t len )
+
+   {
+   if (con_len + len > TH_CON_BUF_SIZE && i_flush_con() != Success)
+      return Failure;
+
+   if (len > TH_CON_BUF_SIZE)
+      return al_write_con( buf, len );
+
+   memcpy( con_buf + con_len, buf, len );
+   con_len += len;
+   return Success;
+   }
+#endif
+
 /*------------------------------------------------------------------------------
  * FUNC   : i_ticks_per_sec
  *
@@ -230,6 +431,18 @@ size_t i_ticks_per_sec( void )
    return al_ticks_per_sec();
    }
 
+/*------------------------------------------------------------------------------
+ * FUNC   : i_ticks
+ *
+ * DESC   : functional layer implimentation of th_ticks()
+ * ---------------------------------------------------------------------------*/
+
+size_t i_ticks( void )
+
+   {
+   return al_ticks();
+   }
+
 /*------------------------------------------------------------------------------
  * FUNC   : i_tick_granularity
  *
@@ -243,12 +456,12 @@ size_t i_tick_granularity( void )
    }
 
 /*------------------------------------------------------------------------------
- * FUNC   : i_malloc
+ * FUNC   : heap_get
  *
- * DESC   : functional layer implimentation of th_malloc()
+ * DESC   : Gets a block from the heap manager for i_malloc()
  * ---------------------------------------------------------------------------*/
 
-void *i_malloc( size_t size, const char *file, int line )
+static void *heap_get( size_t size, const char *file, int line )
 
    {
 #if HAVE_MALLOC_H
@@ -279,12 +492,12 @@ void *i_malloc( size_t size, const char *file, int line )
    }
 
 /*------------------------------------------------------------------------------
- * FUNC   : i_free
+ * FUNC   : heap_put
  *
- * DESC   : functional layer implimentation of i_free()
+ * DESC   : Gives a block back to the heap manager for i_free()
  * ---------------------------------------------------------------------------*/
 
-void i_free( void *block, const char *file, int line )
+static void heap_put( void *block, const char *file, int line )
 
    {
 #if HAVE_MALLOC_H
@@ -303,6 +516,55 @@ void i_free( void *block, const char *file, int line )
 #endif
    }
 
+/*------------------------------------------------------------------------------
+ * FUNC   : i_malloc
+ *
+ * DESC   : functional layer implimentation of th_malloc()
+ * ---------------------------------------------------------------------------*/
+
+void *i_malloc( size_t size, const char *file, int line )
+
+   {
+#if TH_FOOTPRINT
+   char *block = (char *) heap_get( size + FOOT_HDR, file, line );
+
+   if (block == NULL)
+      return NULL;
+
+   *(size_t *) block = size;
+   foot_bytes += size;
+   foot_blocks++;
+   if (foot_bytes - foot_base_bytes > foot_peak_bytes)
+      foot_peak_bytes = foot_bytes - foot_base_bytes;
+   if (foot_blocks - foot_base_blocks > foot_peak_blocks)
+      foot_peak_blocks = foot_blocks - foot_base_blocks;
+
+   return block + FOOT_HDR;
+#else
+   return heap_get( size, file, line );
+#endif
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : i_free
+ *
+ * DESC   : functional layer implimentation of i_free()
+ * ---------------------------------------------------------------------------*/
+
+void i_free( void *block, const char *file, int line )
+
+   {
+#if TH_FOOTPRINT
+   if (block != NULL)
+      {
+      block = (char *) block - FOOT_HDR;
+      foot_bytes -= *(size_t *) block;
+      foot_blocks--;
+      }
+#endif
+   heap_put( block, file, line );
+   }
+
 /*------------------------------------------------------------------------------
  * FUNC   : i_heap_reset
  *
@@ -315,8 +577,38 @@ void i_heap_reset()
 #if COMPILE_OUT_HEAP
 #else
    heap_reset( th_heap );
+#if TH_FOOTPRINT
+   foot_bytes  = 0;
+   foot_blocks = 0;
+#endif
+#endif
+   }
+
+#if TH_FOOTPRINT
+/*------------------------------------------------------------------------------
+ * FUNC   : foot_start
+ *
+ * DESC   : Starts the footprint of a run right after mem_heap_initialize(),
+ *          and paints the stack the run is going to use.
+ * ---------------------------------------------------------------------------*/
+
+static void foot_start( void )
+
+   {
+#if !COMPILE_OUT_HEAP
+   /* mem_heap_initialize() just dropped every block */
+   foot_bytes  = 0;
+   foot_blocks = 0;
 #endif
+   foot_base_bytes  = foot_bytes;
+   foot_base_blocks = foot_blocks;
+   foot_peak_bytes  = 0;
+   foot_peak_blocks = 0;
+   foot_stack       = 0;
+
+   al_stack_paint();
    }
+#endif
 
 /*------------------------------------------------------------------------------
  * FUNC   : i_signal_start
@@ -328,7 +620,11 @@ void i_signal_start( void )
 
    {
    t_printf( ">> START!\n" ); /* Do before calling adaptaion layer */
+   i_flush_con();             /* and keep the console out of the timing */
 
+#if TH_CACHE_COLD
+   cold_ticks = 0;
+#endif
    al_signal_start();
    }
 
@@ -345,11 +641,189 @@ size_t i_signal_finished( void )
 
    rv = al_signal_finished();
 
+#if TH_FOOTPRINT
+   foot_stack = al_stack_used();
+#endif
+
+#if TH_CACHE_COLD
+   /* the evictions are not part of the benchmark */
+   if ( cold && rv != TH_UNDEF_VALUE )
+      rv = rv > cold_ticks ? rv - cold_ticks : 0;
+#endif
+
    t_printf( ">> FINISHED!\n" );  /* Do this AFTER calling the adaption layer */
 
    return rv;
    }
 
+/*------------------------------------------------------------------------------
+ * FUNC   : i_evict_caches
+ *
+ * DESC   : functional layer of th_latency_mark() in TH_CACHE_COLD builds,
+ *          evicting the caches between the iterations of the cold run
+ *          untimed.  Does nothing in other runs.
+ * ---------------------------------------------------------------------------*/
+
+void i_evict_caches( void )
+
+   {
+#if TH_CACHE_COLD
+   size_t start;
+
+   if ( !cold )
+      return;
+
+   start = al_ticks();
+   if ( al_evict_caches() != Success )
+      cold_failed = TRUE;
+   cold_ticks += al_ticks() - start;
+#endif
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : kernel_forced
+ *
+ * DESC   : Finds the variant the -kernel= list, or else the TH_KERNEL_ENV
+ *          environment variable, forces for 'kernel': its <kernel>:<variant>
+ *          entry, or else its last <variant> entry for every kernel.
+ *
+ * RETURNS: TRUE with the variant's name in 'name', FALSE if none is forced
+ * ---------------------------------------------------------------------------*/
+
+static int kernel_forced( const char *kernel, char *name, size_t size )
+
+   {
+   const char *s = kernel_opt != NULL ? kernel_opt : getenv( TH_KERNEL_ENV );
+   const char *end;
+   const char *colon;
+   size_t      klen  = strlen( kernel );
+   int         found = FALSE;
+
+   if (s == NULL)
+      return FALSE;
+
+   for (; *s != '\0'; s = *end != '\0' ? end + 1 : end)
+      {
+      end = strchr( s, ',' );
+      if (end == NULL)
+         end = s + strlen( s );
+      colon = (const char *)memchr( s, ':', (size_t)( end - s ) );
+
+      if (colon != NULL)
+         {
+         if ((size_t)( colon - s ) != klen || strncmp( s, kernel, klen ) != 0)
+            continue;
+         s = colon + 1;
+         }
+      if ((size_t)( end - s ) >= size)
+         continue;
+
+      memcpy( name, s, (size_t)( end - s ) );
+      name[ end - s ] = '\0';
+      found = TRUE;
+      if (colon != NULL)
+         break;
+      }
+
+   return found;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : i_wall_seconds
+ *
+ * DESC   : functional layer implimentation of th_wall_seconds()
+ * ---------------------------------------------------------------------------*/
+
+double i_wall_seconds( void )
+
+   {
+   return al_wall_seconds();
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : i_pool_open
+ *
+ * DESC   : functional layer implimentation of th_pool_open()
+ * ---------------------------------------------------------------------------*/
+
+THPool *i_pool_open( int threads )
+
+   {
+   return al_pool_open( threads );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : i_pool_run
+ *
+ * DESC   : functional layer implimentation of th_pool_run()
+ * ---------------------------------------------------------------------------*/
+
+void i_pool_run( THPool *pool, THPartFunc run, void *arg )
+
+   {
+   al_pool_run( pool, run, arg );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : i_pool_close
+ *
+ * DESC   : functional layer implimentation of th_pool_close()
+ * ---------------------------------------------------------------------------*/
+
+void i_pool_close( THPool *pool )
+
+   {
+   al_pool_close( pool );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : i_kernel_select
+ *
+ * DESC   : functional layer implimentation of th_kernel_select()
+ * ---------------------------------------------------------------------------*/
+
+int i_kernel_select( const char *kernel, const THKernelVariant *variants, int count )
+
+   {
+   char  forced[ 32 ];
+   e_u32 features = al_cpu_features();
+   int   pick     = -1;
+   int   v;
+
+   if (kernel_forced( kernel, forced, sizeof(forced) ))
+      {
+      for (v = 0; v < count; v++)
+         if (strcmp( variants[v].name, forced ) == 0)
+            break;
+
+      if (v == count)
+         t_printf( "-- Kernel %s has no %s variant\n", kernel, forced );
+      else if (( variants[v].features & ~features ) != 0)
+         t_printf( "-- Kernel %s cannot run %s on this CPU\n", kernel, forced );
+      else
+         pick = v;
+      }
+
+   for (v = 0; pick < 0 && v < count; v++)
+      if (( variants[v].features & ~features ) == 0)
+         pick = v;
+   if (pick < 0)
+      pick = count - 1;
+
+   for (v = 0; v < kernel_count; v++)
+      if (strcmp( kernels[v].kernel, kernel ) == 0)
+         break;
+   if (v < TH_MAX_KERNELS)
+      {
+      kernels[v].kernel  = kernel;
+      kernels[v].variant = variants[ pick ].name;
+      if (v == kernel_count)
+         kernel_count++;
+      }
+
+   return pick;
+   }
+
 /*------------------------------------------------------------------------------
  * FUNC   : i_exit
  *
@@ -359,6 +833,7 @@ size_t i_signal_finished( void )
 void i_exit( int exit_code, const char *fmt, va_list args )
 
    {
+   i_flush_con();
    al_exit( exit_code, fmt, args );
    }
 
@@ -371,7 +846,59 @@ void i_exit( int exit_code, const char *fmt, va_list args )
 FileDef *i_get_file_def( const char *fn )
 
    {
-   return mem_get_file_def( fn );
+   FileDef *fd = mem_get_file_def( fn );
+#if TH_DATA_FILES
+   char     path[ DATA_PATH_SIZE ];
+   int      i;
+
+   if ( fd != NULL || strlen( fn ) >= FILE_NAME_SIZE )
+      return fd;
+
+   for ( i = 0; i < data_count; i++ )
+      if ( strcmp( data_files[i].name, fn ) == 0 )
+         return &data_files[i];
+
+   if ( data_count == TH_MAX_DATA_FILES || strlen( data_dir ) >= REC_PATH_SIZE )
+      return NULL;
+
+   if ( fn[0] == '/' )
+      strcpy( path, fn );
+   else
+      t_sprintf( path, "%s/%s", data_dir, fn );
+
+   fd = &data_files[ data_count ];
+   if ( al_map_file( path, fd ) != Success )
+      return NULL;
+   strcpy( fd->name, fn );
+   fd->crc = 0;
+   data_count++;
+#endif
+   return fd;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : i_get_data_file
+ *
+ * DESC   : functional layer implimentation of th_get_data_file()
+ *
+ *          Gets the file 'fn', or the one given by -in= or -ref= for 'kind'
+ * ---------------------------------------------------------------------------*/
+
+FileDef *i_get_data_file( int kind, const char *fn )
+
+   {
+   FileDef *fd;
+
+#if TH_DATA_FILES
+   if ( kind >= 0 && kind < TH_DATA_KINDS && data_name[ kind ] != NULL )
+      fn = data_name[ kind ];
+#else
+   kind = kind;
+#endif
+
+   if ( (fd = i_get_file_def( fn )) == NULL )
+      t_printf( "-- Cannot find data file %s\n", fn );
+   return fd;
    }
 
 /*------------------------------------------------------------------------------
@@ -395,63 +922,612 @@ FileDef *i_get_file_num( int n )
 int i_send_buf_as_file( const char* buf, BlockSize length, const char* fn )
 
    {
+   if (quiet)
+      return Success;
+
+#if TH_FILE_OUTPUT == TH_FILE_RAW
+   if (i_file_begin( fn ) != Success || i_file_write( buf, length ) != Success)
+      return Failure;
+   return i_file_end();
+#elif TH_FRAMED_FILES
+   if (fr_begin( fn, (e_u32)length ) != 0 || fr_write( buf, (n_int)length ) != 0)
+      return Failure;
+   return fr_end() == 0 ? Success : Failure;
+#else
 	return uu_send_buf ( buf, length, fn ); 
+#endif
    }
 
 /*------------------------------------------------------------------------------
- * FUNC   : i_report_results
+ * FUNC   : i_file_begin
  *
- * DESC   : functional layer implimentation of th_report_results()
+ * DESC   : functional layer implimentation of th_file_begin(), starts
+ *          sending file 'fn', see TH_FILE_OUTPUT in thcfg.h
  * ---------------------------------------------------------------------------*/
 
-int i_report_results( const THTestResults *results, e_u16 Expected_CRC )
-{
-int	exit_code = Success;
+int i_file_begin( const char *fn )
 
-/* Used to unload double from two vx results variables */ 
-#if	VERIFY_FLOAT && FLOAT_SUPPORT
-	typedef union {
-		double	d;
-		size_t	v[2];
-	} d_union;
-	d_union	dunion;
+   {
+   if (quiet)
+      return Success;
+
+#if TH_FILE_OUTPUT == TH_FILE_RAW
+   t_printf( "begin-raw %s\n", fn );
+   return Success;
+#elif TH_FRAMED_FILES
+   return fr_begin( fn, FR_UNKNOWN ) == 0 ? Success : Failure;
+#else
+   return uu_begin( fn ) == 0 ? Success : Failure;
 #endif
+   }
 
-/* Standard Results Section */
+/*------------------------------------------------------------------------------
+ * FUNC   : i_file_write
+ *
+ * DESC   : functional layer implimentation of th_file_write(), sends the
+ *          next 'length' bytes of the file started by i_file_begin()
+ * ---------------------------------------------------------------------------*/
 
-#if		CRC_CHECK
-t_printf(  "--  Intrusive CRC     = %4x\n",results->CRC);
-#elif	NON_INTRUSIVE_CRC_CHECK
-t_printf(  "--  Non-Intrusive CRC = %4x\n",results->CRC);
+int i_file_write( const char *buf, size_t length )
+
+   {
+   if (quiet || length == 0)
+      return Success;
+
+#if TH_FILE_OUTPUT == TH_FILE_RAW
+   /* a zero length would end the file, so it is never sent above */
+   t_printf( "%lx\n", (unsigned long)length );
+   return con_write( buf, length );
+#elif TH_FRAMED_FILES
+   return fr_write( buf, (n_int)length ) == 0 ? Success : Failure;
 #else
-t_printf(  "--  No CRC check      = 0000\n"); 
-#endif
-t_printf(  "--  Iterations        = %5u\n", results->iterations );
-t_printf(  "--  Target Duration   = %5u\n", results->duration );
-#if		VERIFY_INT
-t_printf(  "--  v1                = %d\n", results->v1);
-t_printf(  "--  v2                = %d\n", results->v2);
-t_printf(  "--  v3                = %d\n", results->v3);
-t_printf(  "--  v4                = %d\n", results->v4);
-#endif
-#if		VERIFY_FLOAT && FLOAT_SUPPORT
-dunion.v[0]	= results->v1;
-dunion.v[1] = results->v2;
-t_printf(  "--  v1v2              = %f\n", dunion.d);
-dunion.v[0]	= results->v3;
-dunion.v[1] = results->v4;
-t_printf(  "--  v3v4              = %f\n", dunion.d);
+   return uu_write( buf, (n_int)length ) == 0 ? Success : Failure;
 #endif
+   }
 
-#if		FLOAT_SUPPORT
-   if (results -> duration > 0)
-      {
-      double fduration;
-      double fiterations;
-      double ticks_per_sec;
-      double its_per_sec;
+/*------------------------------------------------------------------------------
+ * FUNC   : i_file_end
+ *
+ * DESC   : functional layer implimentation of th_file_end(), finishes the
+ *          file started by i_file_begin()
+ * ---------------------------------------------------------------------------*/
 
-      /* Ok, lets do this in floating point.... */
+int i_file_end( void )
+
+   {
+   if (quiet)
+      return Success;
+
+#if TH_FILE_OUTPUT == TH_FILE_RAW
+   t_printf( "0\nend\n\n" );
+   return Success;
+#elif TH_FRAMED_FILES
+   return fr_end() == 0 ? Success : Failure;
+#else
+   return uu_end() == 0 ? Success : Failure;
+#endif
+   }
+
+#if		TARGET_PERF_COUNTERS && FLOAT_SUPPORT
+/*------------------------------------------------------------------------------
+ * FUNC   : report_perf
+ *
+ * DESC   : Reports the hardware counters of the timed region as the IPC
+ *          and counts per iteration.
+ * ---------------------------------------------------------------------------*/
+
+static void report_perf( size_t its )
+
+   {
+   static const char *names[ AL_PERF_COUNTERS ] =
+      { "Cycles/Iter", "Instr/Iter", "Mispredict/Iter",
+        "L1D Miss/Iter", "LLC Miss/Iter" };
+   size_t counts[ AL_PERF_COUNTERS ];
+   int    mask;
+   int    e;
+
+   mask = al_perf_counts( counts );
+
+   if (mask == 0 || its == 0)
+      {
+      t_printf( "--  Perf Counters   = n/a\n" );
+      return;
+      }
+
+   if (( mask & ( 1 << AL_PERF_CYCLES ) ) && ( mask & ( 1 << AL_PERF_INSTRUCTIONS ) )
+       && counts[ AL_PERF_CYCLES ] > 0)
+      th_printf( "--  IPC             = %12.3f\n",
+         (double) counts[ AL_PERF_INSTRUCTIONS ] / (double) counts[ AL_PERF_CYCLES ] );
+
+   for (e = 0; e < AL_PERF_COUNTERS; e++)
+      {
+      if (mask & ( 1 << e ))
+         th_printf( "--  %-16s= %12.3f\n", names[e], (double) counts[e] / (double) its );
+      else
+         t_printf( "--  %-16s= n/a\n", names[e] );
+      }
+   }
+#endif
+
+#if		TARGET_ENERGY && FLOAT_SUPPORT
+/*------------------------------------------------------------------------------
+ * FUNC   : report_energy
+ *
+ * DESC   : Reports the energy of the timed region, per iteration and as
+ *          iterations per joule.
+ * ---------------------------------------------------------------------------*/
+
+static void report_energy( size_t its )
+
+   {
+   size_t uj;
+   double joules;
+
+   if (al_energy( &uj ) != Success || uj == 0 || its == 0)
+      {
+      t_printf( "--  Energy          = n/a\n" );
+      return;
+      }
+
+   joules = (double) uj / 1e6;
+   th_printf( "--  Energy          = %12.6fJ\n", joules );
+   th_printf( "--  Joules/Iter     = %18.9fJ\n", joules / (double) its );
+   th_printf( "--  Iter/Joule      = %12.3f\n", (double) its / joules );
+   }
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : rec_put
+ *
+ * DESC   : Adds one field to the record in rec_buf, and its name to the
+ *          CSV header in rec_hdr.  A NULL value is JSON null or an empty
+ *          CSV cell.  'quote' values are strings and get escaped, the
+ *          others are numbers.  Fields past the end of the buffer are
+ *          dropped.
+ * ---------------------------------------------------------------------------*/
+
+static void rec_put( const char *name, const char *value, int quote )
+
+   {
+   int json = results_format == TH_RESULTS_JSON;
+
+   /* names and numbers are short, each string leaves room to escape it */
+   if (rec_len + 64 + ( value != NULL ? 2 * strlen( value ) : 0 ) >= REC_BUF_SIZE
+       || hdr_len + 64 >= REC_BUF_SIZE)
+      return;
+
+   if (rec_fields++ > 0)
+      {
+      rec_buf[ rec_len++ ] = ',';
+      rec_hdr[ hdr_len++ ] = ',';
+      }
+   hdr_len += t_sprintf( rec_hdr + hdr_len, "%s", name );
+   if (json)
+      rec_len += t_sprintf( rec_buf + rec_len, "\"%s\":", name );
+
+   if (value == NULL)
+      {
+      if (json)
+         rec_len += t_sprintf( rec_buf + rec_len, "null" );
+      }
+   else if (!quote)
+      rec_len += t_sprintf( rec_buf + rec_len, "%s", value );
+   else
+      {
+      rec_buf[ rec_len++ ] = '"';
+      for (; *value != '\0'; value++)
+         {
+         if (*value == '"')
+            rec_buf[ rec_len++ ] = json ? '\\' : '"';
+         else if (*value == '\\' && json)
+            rec_buf[ rec_len++ ] = '\\';
+         else if ((unsigned char)*value < ' ')
+            continue;
+         rec_buf[ rec_len++ ] = *value;
+         }
+      rec_buf[ rec_len++ ] = '"';
+      }
+
+   rec_buf[ rec_len ] = '\0';
+   rec_hdr[ hdr_len ] = '\0';
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : rec_number
+ *
+ * DESC   : Adds a whole number field to the record
+ * ---------------------------------------------------------------------------*/
+
+static void rec_number( const char *name, unsigned long value )
+
+   {
+   char num[ 32 ];
+
+   t_sprintf( num, "%lu", value );
+   rec_put( name, num, FALSE );
+   }
+
+#if		FLOAT_SUPPORT
+/*------------------------------------------------------------------------------
+ * FUNC   : rec_real
+ *
+ * DESC   : Adds a floating point field to the record, or null if not 'ok'
+ * ---------------------------------------------------------------------------*/
+
+static void rec_real( const char *name, double value, int ok )
+
+   {
+   char num[ 48 ];
+
+   t_sprintf( num, "%.9g", value );
+   rec_put( name, ok ? num : NULL, FALSE );
+   }
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : rec_dataset
+ *
+ * DESC   : Names the data set being run: for a suite, the first word of
+ *          the benchmark description, which names its data set, otherwise
+ *          the program name without its directory or extension.
+ * ---------------------------------------------------------------------------*/
+
+static void rec_dataset( char *name, size_t size )
+
+   {
+   const char *s   = in_suite ? the_tcdef_ptr->desc : argv0_pgm;
+   const char *end;
+
+   if (s == NULL)
+      s = "";
+
+   if (in_suite)
+      {
+      end = strchr( s, ' ' );
+      }
+   else
+      {
+      for (end = s; *end != '\0'; end++)
+         if (*end == '/' || *end == '\\' || *end == ':')
+            s = end + 1;
+      end = strrchr( s, '.' );
+      }
+
+   if (end == NULL)
+      end = s + strlen( s );
+   if ((size_t)( end - s ) >= size)
+      end = s + size - 1;
+
+   memcpy( name, s, (size_t)( end - s ) );
+   name[ end - s ] = '\0';
+   }
+
+#if	VERIFY_FLOAT && FLOAT_SUPPORT
+/*------------------------------------------------------------------------------
+ * FUNC   : result_snr
+ *
+ * DESC   : Unpacks the doubles of v1 and v2 and of v3 and v4, with
+ *          verify_snr the S/N in dB a benchmark's diffmeasure() found and
+ *          the least S/N that passes, 0 for none.
+ * ---------------------------------------------------------------------------*/
+
+static void result_snr( const THTestResults *results, double *snr, double *snr_min )
+
+   {
+   union {
+      double d;
+      size_t v[2];
+   } dunion;
+
+   dunion.v[0] = results->v1;
+   dunion.v[1] = results->v2;
+   *snr        = dunion.d;
+   dunion.v[0] = results->v3;
+   dunion.v[1] = results->v4;
+   *snr_min    = dunion.d;
+   }
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : begin_record
+ *
+ * DESC   : Starts the results record of a reported run, when TH_RESULTS or
+ *          a -json or -csv option asked for one, for end_record() to finish
+ *          once the trials are in.  Fields that do not apply, such as the
+ *          latency fields without TH_LATENCY_BATCH, are null so that every
+ *          record has the same fields.
+ * ---------------------------------------------------------------------------*/
+
+static void begin_record( const THTestResults *results, e_u16 Expected_CRC, int exit_code )
+
+   {
+   static const char *lat_keys[ TH_LATENCY_POINTS ] =
+      { "latency_min", "latency_p50", "latency_p90", "latency_p99",
+        "latency_p999", "latency_max" };
+   static const char *perf_keys[ AL_PERF_COUNTERS ] =
+      { "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses" };
+   size_t      points[ TH_LATENCY_POINTS ];
+   size_t      counts[ AL_PERF_COUNTERS ];
+   size_t      samples;
+   char        id[ sizeof(the_tcdef_ptr->eembc_bm_id) + 1 ];
+   char        dataset[ 64 ];
+   char        crc[ 8 ];
+   char        list[ 128 ];
+   const char *crc_status;
+   int         mask;
+   int         i;
+#if		FLOAT_SUPPORT
+   double      secs = 0.0;
+   double      tps  = (double) th_ticks_per_sec();
+   size_t      uj;
+   int         energy;
+#endif
+#if		VERIFY_FLOAT && FLOAT_SUPPORT
+   double      snr, snr_min;
+#endif
+
+   if (results_format == TH_RESULTS_NONE)
+      return;
+
+   rec_len = hdr_len = 0;
+   rec_fields = 0;
+   if (results_format == TH_RESULTS_JSON)
+      rec_buf[ rec_len++ ] = '{';
+
+   /* the id is blank padded to its field */
+   strncpy( id, the_tcdef_ptr->eembc_bm_id, sizeof(id) - 1 );
+   id[ sizeof(id) - 1 ] = '\0';
+   for (i = (int)strlen( id ); i > 0 && id[ i - 1 ] == ' '; i--)
+      id[ i - 1 ] = '\0';
+
+   rec_dataset( dataset, sizeof(dataset) );
+   rec_put( "benchmark", id, TRUE );
+   rec_put( "desc", the_tcdef_ptr->desc, TRUE );
+   rec_put( "dataset", dataset, TRUE );
+   rec_put( "toolchain", TH_TOOLCHAIN, TRUE );
+   rec_put( "timer", al_timer_name(), TRUE );
+   rec_number( "ticks_per_sec", (unsigned long) th_ticks_per_sec() );
+   rec_number( "iterations", (unsigned long) results->iterations );
+   rec_number( "duration", (unsigned long) results->duration );
+#if		FLOAT_SUPPORT
+   if (tps > 0.0)
+      secs = (double) results->duration / tps;
+   rec_real( "total_sec", secs, tps > 0.0 );
+   rec_real( "time_per_iter", secs / (double) results->iterations,
+      tps > 0.0 && results->iterations > 0 );
+   rec_real( "iter_per_sec", (double) results->iterations / secs, secs > 0.0 );
+#else
+   rec_put( "total_sec", NULL, FALSE );
+   rec_put( "time_per_iter", NULL, FALSE );
+   rec_put( "iter_per_sec", NULL, FALSE );
+#endif
+
+#if		CRC_CHECK || NON_INTRUSIVE_CRC_CHECK
+   crc_status = results->CRC == Expected_CRC ? "pass" : "fail";
+#else
+   crc_status = "none";
+#endif
+   t_sprintf( crc, "%04x", (unsigned) results->CRC );
+   rec_put( "crc", crc, TRUE );
+   t_sprintf( crc, "%04x", (unsigned) Expected_CRC );
+   rec_put( "expected_crc", crc, TRUE );
+   rec_put( "crc_status", crc_status, TRUE );
+#if		VERIFY_FLOAT && FLOAT_SUPPORT
+   result_snr( results, &snr, &snr_min );
+   if (!results->verify_snr)
+      snr_min = 0.0;
+   rec_real( "snr", snr, results->verify_snr );
+   rec_real( "snr_min", snr_min, snr_min != 0.0 );
+   rec_put( "snr_status", snr_min == 0.0 ? "none" : snr >= snr_min ? "pass" : "fail", TRUE );
+#else
+   rec_put( "snr", NULL, FALSE );
+   rec_put( "snr_min", NULL, FALSE );
+   rec_put( "snr_status", "none", TRUE );
+#endif
+   rec_put( "status", exit_code == Success ? "pass" : "fail", TRUE );
+
+   /* the kernel variants, in the -kernel= form that forces them again */
+   list[0] = '\0';
+   for (i = 0; i < kernel_count; i++)
+      if (strlen( list ) + strlen( kernels[i].kernel ) + strlen( kernels[i].variant ) + 3
+          < sizeof(list))
+         t_sprintf( list + strlen( list ), "%s%s:%s", i > 0 ? "," : "",
+            kernels[i].kernel, kernels[i].variant );
+   rec_put( "kernels", kernel_count > 0 ? list : NULL, TRUE );
+
+   /* peak heap bytes and blocks, and the stack high water mark in bytes */
+#if		TH_FOOTPRINT
+   rec_number( "heap_peak", (unsigned long) foot_peak_bytes );
+   rec_number( "heap_peak_blocks", (unsigned long) foot_peak_blocks );
+   rec_number( "stack_peak", (unsigned long) foot_stack );
+#else
+   rec_put( "heap_peak", NULL, FALSE );
+   rec_put( "heap_peak_blocks", NULL, FALSE );
+   rec_put( "stack_peak", NULL, FALSE );
+#endif
+
+   /* latency batch durations in seconds, or ticks without floating point */
+   for (i = 0; i < TH_LATENCY_POINTS; i++)
+      points[i] = 0;
+   samples = th_latency_points( points );
+   if (samples > 0)
+      {
+      rec_number( "latency_batch", (unsigned long) TH_LATENCY_BATCH );
+      rec_number( "latency_samples", (unsigned long) samples );
+      }
+   else
+      {
+      rec_put( "latency_batch", NULL, FALSE );
+      rec_put( "latency_samples", NULL, FALSE );
+      }
+   for (i = 0; i < TH_LATENCY_POINTS; i++)
+      {
+#if		FLOAT_SUPPORT
+      rec_real( lat_keys[i], (double) points[i] / tps, samples > 0 && tps > 0.0 );
+#else
+      if (samples > 0)
+         rec_number( lat_keys[i], (unsigned long) points[i] );
+      else
+         rec_put( lat_keys[i], NULL, FALSE );
+#endif
+      }
+
+   /* hardware counter totals over the timed region */
+   mask = al_perf_counts( counts );
+#if		FLOAT_SUPPORT
+   rec_real( "ipc", (double) counts[ AL_PERF_INSTRUCTIONS ] / (double) counts[ AL_PERF_CYCLES ],
+      ( mask & ( 1 << AL_PERF_CYCLES ) ) && ( mask & ( 1 << AL_PERF_INSTRUCTIONS ) )
+      && counts[ AL_PERF_CYCLES ] > 0 );
+#else
+   rec_put( "ipc", NULL, FALSE );
+#endif
+   for (i = 0; i < AL_PERF_COUNTERS; i++)
+      {
+      if (mask & ( 1 << i ))
+         rec_number( perf_keys[i], (unsigned long) counts[i] );
+      else
+         rec_put( perf_keys[i], NULL, FALSE );
+      }
+
+   /* energy of the timed region in joules */
+#if		FLOAT_SUPPORT
+   energy = al_energy( &uj ) == Success && uj > 0;
+   rec_real( "joules", (double) uj / 1e6, energy );
+   rec_real( "joules_per_iter", (double) uj / 1e6 / (double) results->iterations,
+      energy && results->iterations > 0 );
+   rec_real( "iter_per_joule", (double) results->iterations / ( (double) uj / 1e6 ), energy );
+#else
+   rec_put( "joules", NULL, FALSE );
+   rec_put( "joules_per_iter", NULL, FALSE );
+   rec_put( "iter_per_joule", NULL, FALSE );
+#endif
+
+   rec_open = TRUE;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : end_record
+ *
+ * DESC   : Adds the trial statistics of report_trials() to the record
+ *          begin_record() started, null without trials, and appends it to
+ *          results_path.  The baseline comparison of util/perl/baseline.pl
+ *          reads them.
+ * ---------------------------------------------------------------------------*/
+
+static void end_record( void )
+
+   {
+#if		TH_OVERHEAD && FLOAT_SUPPORT
+   double tps = (double) th_ticks_per_sec();
+   int    ok;
+#endif
+
+   if (!rec_open)
+      return;
+   rec_open = FALSE;
+
+   rec_number( "trials", (unsigned long) trial_count );
+#if		FLOAT_SUPPORT
+   rec_real( "trial_mean", trial_mean, trial_count > 0 );
+   rec_real( "trial_sd", trial_sd, trial_count > 1 );
+   rec_real( "trial_ci_lo", trial_mean - trial_half, trial_count > 1 );
+   rec_real( "trial_ci_hi", trial_mean + trial_half, trial_count > 1 );
+#else
+   rec_put( "trial_mean", NULL, FALSE );
+   rec_put( "trial_sd", NULL, FALSE );
+   rec_put( "trial_ci_lo", NULL, FALSE );
+   rec_put( "trial_ci_hi", NULL, FALSE );
+#endif
+
+#if		TH_OVERHEAD
+   if (overhead_done)
+      rec_number( "overhead_duration", (unsigned long) overhead_ticks );
+   else
+      rec_put( "overhead_duration", NULL, FALSE );
+#else
+   rec_put( "overhead_duration", NULL, FALSE );
+#endif
+#if		TH_OVERHEAD && FLOAT_SUPPORT
+   ok = overhead_done && tps > 0.0 && iterations > 0;
+   rec_real( "overhead_per_iter",
+      (double) overhead_ticks / tps / (double) iterations, ok );
+   rec_real( "corrected_time_per_iter",
+      overhead_raw > overhead_ticks ?
+         (double)( overhead_raw - overhead_ticks ) / tps / (double) iterations : 0.0, ok );
+#else
+   rec_put( "overhead_per_iter", NULL, FALSE );
+   rec_put( "corrected_time_per_iter", NULL, FALSE );
+#endif
+
+   if (results_format == TH_RESULTS_JSON)
+      {
+      rec_buf[ rec_len++ ] = '}';
+      rec_buf[ rec_len ] = '\0';
+      }
+
+   if (al_write_record( results_path,
+          results_format == TH_RESULTS_CSV ? rec_hdr : NULL, rec_buf ) != Success)
+      t_printf( "--  Failure: Cannot write results record to %s\n", results_path );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : i_report_results
+ *
+ * DESC   : functional layer implimentation of th_report_results()
+ * ---------------------------------------------------------------------------*/
+
+int i_report_results( const THTestResults *results, e_u16 Expected_CRC )
+{
+int	exit_code = Success;
+int	k;
+#if	VERIFY_FLOAT && FLOAT_SUPPORT
+double	snr, snr_min;
+#endif
+
+#if	TH_DATA_FILES
+	if (data_crc_set)
+		Expected_CRC = data_crc;
+#endif
+
+	last_duration = results->duration;
+	if (quiet)
+		{
+		kernel_count = 0;
+		return exit_code;
+		}
+
+/* Standard Results Section */
+
+#if		CRC_CHECK
+t_printf(  "--  Intrusive CRC     = %4x\n",results->CRC);
+#elif	NON_INTRUSIVE_CRC_CHECK
+t_printf(  "--  Non-Intrusive CRC = %4x\n",results->CRC);
+#else
+t_printf(  "--  No CRC check      = 0000\n"); 
+#endif
+t_printf(  "--  Iterations        = %5u\n", results->iterations );
+t_printf(  "--  Target Duration   = %5u\n", results->duration );
+#if		VERIFY_INT
+t_printf(  "--  v1                = %d\n", results->v1);
+t_printf(  "--  v2                = %d\n", results->v2);
+t_printf(  "--  v3                = %d\n", results->v3);
+t_printf(  "--  v4                = %d\n", results->v4);
+#endif
+#if		VERIFY_FLOAT && FLOAT_SUPPORT
+result_snr( results, &snr, &snr_min );
+t_printf(  "--  v1v2              = %f\n", snr);
+t_printf(  "--  v3v4              = %f\n", snr_min);
+#endif
+
+#if		FLOAT_SUPPORT
+   if (results -> duration > 0)
+      {
+      double fduration;
+      double fiterations;
+      double ticks_per_sec;
+      double its_per_sec;
+
+      /* Ok, lets do this in floating point.... */
 
       fduration = results -> duration;
 	  fiterations = results->iterations;
@@ -465,9 +1541,27 @@ t_printf(  "--  v3v4              = %f\n", dunion.d);
       }
 #endif
 
+#if		TARGET_PERF_COUNTERS && FLOAT_SUPPORT
+   report_perf( results->iterations );
+#endif
+
+#if		TARGET_ENERGY && FLOAT_SUPPORT
+   report_energy( results->iterations );
+#endif
+
+   for (k = 0; k < kernel_count; k++)
+      t_printf( "--  Kernel %-9s= %s\n", kernels[k].kernel, kernels[k].variant );
+
    if (results -> info != NULL && results -> info[ 0 ] != '\0')
       t_printf( "-- Info             = %s\n", results -> info );
 
+#if		TH_FOOTPRINT
+   t_printf( "--  Peak Heap         = %lu bytes in %lu blocks\n",
+      (unsigned long) foot_peak_bytes, (unsigned long) foot_peak_blocks );
+   t_printf( "--  Stack High Water  = %lu bytes%s\n", (unsigned long) foot_stack,
+      foot_stack >= (size_t) TH_STACK_PAINT ? " or more" : "" );
+#endif
+
    /* Failure Section */
 #if		CRC_CHECK || NON_INTRUSIVE_CRC_CHECK
 	if( results->CRC != Expected_CRC ){
@@ -476,11 +1570,22 @@ t_printf(  "--  v3v4              = %f\n", dunion.d);
 	} 
 #endif
 
+#if		VERIFY_FLOAT && FLOAT_SUPPORT
+	if( results->verify_snr && snr_min != 0.0 && !( snr >= snr_min ) ){
+		t_printf("--  Failure: S/N %f dB, Expected at least %f dB\n",snr,snr_min);
+		exit_code = Failure;
+	}
+#endif
+
 	if (iterations != results->iterations) {
 		t_printf("--  Failure: Actual iterations %x, Expected iterations %x\n",results->iterations,iterations);
 		exit_code = Failure;
 	}
 
+	end_record();	/* the record of an earlier report of this run */
+	begin_record( results, Expected_CRC, exit_code );
+	kernel_count = 0;
+
 	return	exit_code;
 }
 
@@ -768,13 +1873,17 @@ static int parse_command( const char *in_buf )
          {
          its = dectost( s );
 
+         calibrate_secs = 0;
+
          if (its > 0)
             {
+            fixed_iterations = TRUE;
             iterations = its;
             }
          else
             {
             t_printf( "{ Reset iterations to recommended value }\n\n" );
+            fixed_iterations = FALSE;
             iterations = the_tcdef_ptr->rec_iterations;
             }
 
@@ -921,12 +2030,31 @@ static int parse_command( const char *in_buf )
          }
       else
          {
-		 uu_send_buf ( fd->buf, fd->size, fd->name ); 
+		 i_send_buf_as_file ( fd->buf, fd->size, fd->name ); 
          }
 
       return KEEP_COMMANDING;
       }
 
+#if TH_FRAMED_FILES
+   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    * 'rf' -- Receive File.  Reads one file, sent in frames as described in
+    *         uuencode.c, into the memory manager.
+   */
+
+   if (str_icmp( cmd_buf, "rf" ) == 0)
+      {
+      FileDef *fd = fr_receive();
+
+      if ( fd == NULL )
+         t_printf( "\nFile receive failed\n\n" );
+      else
+         t_printf( "\nReceived %s, %ld bytes\n\n", fd->name, (long)fd->size );
+
+      return KEEP_COMMANDING;
+      }
+#endif
+
    /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     * 'h' 'help' '?'  -- help
    */
@@ -945,6 +2073,9 @@ static int parse_command( const char *in_buf )
       t_printf( "dir          : display the downloaded files\n" );
       t_printf( "dnf          : delete the newest file\n" );
       t_printf( "daf          : delete all the downloaded files\n" );
+#if TH_FRAMED_FILES
+      t_printf( "rf           : receive a file in frames\n" );
+#endif
       t_printf( "mem          : display memory info\n" );
       t_printf( "exit         : exit the test harness\n" );
       t_printf( "ver          : dump version of TH and BM\n" );
@@ -999,6 +2130,7 @@ static int wait_for_start_signal( void )
 
    prompt:
    t_printf( "TH +> " );
+   i_flush_con();
 
    i = 0;
 
@@ -1149,6 +2281,7 @@ void t_exit( int exit_code, const char *fmt, ... )
    {
    va_list args;
    va_start( args, fmt );
+   i_flush_con();
    al_exit( exit_code, fmt, args );
    }
 
@@ -1185,7 +2318,851 @@ const char *efn( const char *fn )
    }
 
 /*------------------------------------------------------------------------------
- * FUNC   : th_main
+ * FUNC   : is_auto_option
+ *
+ * RETURNS: TRUE if the text after '-i' asks for calibrated iterations,
+ *          that is 'auto' or 'AUTO' optionally followed by seconds.
+ * ---------------------------------------------------------------------------*/
+
+static int is_auto_option( const char *s )
+
+   {
+   return strncmp( s, "auto", 4 ) == 0 || strncmp( s, "AUTO", 4 ) == 0;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : is_copies_option
+ *
+ * RETURNS: TRUE if a command line argument is -copies<n> or -COPIES<n>
+ * ---------------------------------------------------------------------------*/
+
+static int is_copies_option( const char *s )
+
+   {
+   return ( strncmp( s, "-copies", 7 ) == 0 || strncmp( s, "-COPIES", 7 ) == 0 )
+      && isdigit( s[7] );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : is_corun_option
+ *
+ * RETURNS: The TH_CORUN_ load of a -corun=<load>[:<n>] command line
+ *          argument, otherwise TH_CORUN_NONE
+ * ---------------------------------------------------------------------------*/
+
+static int is_corun_option( const char *s )
+
+   {
+   size_t len;
+   int    load;
+
+   if (strncmp( s, "-corun=", 7 ) != 0)
+      return TH_CORUN_NONE;
+
+   for (load = TH_CORUN_STREAM; load <= TH_CORUN_BENCH; load++)
+      {
+      len = strlen( corun_names[ load ] );
+      if (strncmp( s + 7, corun_names[ load ], len ) == 0
+          && ( s[ 7 + len ] == '\0' || s[ 7 + len ] == ':' ))
+         return load;
+      }
+   return TH_CORUN_NONE;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : is_trials_option
+ *
+ * RETURNS: TRUE if a command line argument is -trials<n> or -TRIALS<n>
+ * ---------------------------------------------------------------------------*/
+
+static int is_trials_option( const char *s )
+
+   {
+   return ( strncmp( s, "-trials", 7 ) == 0 || strncmp( s, "-TRIALS", 7 ) == 0 )
+      && isdigit( s[7] );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : is_pin_option
+ *
+ * RETURNS: TRUE if a command line argument is -pin<n> or -PIN<n>
+ * ---------------------------------------------------------------------------*/
+
+static int is_pin_option( const char *s )
+
+   {
+   return ( strncmp( s, "-pin", 4 ) == 0 || strncmp( s, "-PIN", 4 ) == 0 )
+      && isdigit( s[4] );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : is_kernel_option
+ *
+ * RETURNS: TRUE if a command line argument is -kernel=<list>
+ * ---------------------------------------------------------------------------*/
+
+static int is_kernel_option( const char *s )
+
+   {
+   return strncmp( s, "-kernel=", 8 ) == 0 || strncmp( s, "-KERNEL=", 8 ) == 0;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : is_parallel_option
+ *
+ * RETURNS: TRUE if a command line argument is -parallel or -PARALLEL
+ * ---------------------------------------------------------------------------*/
+
+static int is_parallel_option( const char *s )
+
+   {
+   return strcmp( s, "-parallel" ) == 0 || strcmp( s, "-PARALLEL" ) == 0;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : is_data_option
+ *
+ * RETURNS: TRUE if a command line argument is -data=<dir>, -in=<file>,
+ *          -ref=<file> or -crc=<hex> and TH_DATA_FILES is set
+ * ---------------------------------------------------------------------------*/
+
+static int is_data_option( const char *s )
+
+   {
+#if TH_DATA_FILES
+   return strncmp( s, "-data=", 6 ) == 0 || strncmp( s, "-in=", 4 ) == 0 ||
+          strncmp( s, "-ref=", 5 ) == 0 || strncmp( s, "-crc=", 5 ) == 0;
+#else
+   s = s;
+   return FALSE;
+#endif
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : is_results_option
+ *
+ * RETURNS: TH_RESULTS_JSON or TH_RESULTS_CSV if a command line argument is
+ *          -json or -csv, optionally followed by =<file>, else
+ *          TH_RESULTS_NONE
+ * ---------------------------------------------------------------------------*/
+
+static int is_results_option( const char *s )
+
+   {
+   if (strncmp( s, "-json", 5 ) == 0 && ( s[5] == '\0' || s[5] == '=' ))
+      return TH_RESULTS_JSON;
+   if (strncmp( s, "-csv", 4 ) == 0 && ( s[4] == '\0' || s[4] == '=' ))
+      return TH_RESULTS_CSV;
+   return TH_RESULTS_NONE;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : quiet_run
+ *
+ * DESC   : Runs the benchmark once for 'n' iterations with the console
+ *          output dropped, and gets the duration it reported.
+ *
+ * RETURNS: The benchmark's return value
+ * ---------------------------------------------------------------------------*/
+
+static int quiet_run( LoopCount n, e_u32 *duration )
+
+   {
+   int rv;
+
+   iterations    = n;
+   last_duration = 0;
+
+   mem_heap_initialize();
+
+   quiet = TRUE;
+   rv = the_tcdef_ptr->tcip_run_test( n, argca, argva );
+   quiet = FALSE;
+
+   *duration = last_duration;
+
+   return rv;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : copy_run
+ *
+ * DESC   : Runs one copy for al_run_copies()
+ *
+ * RETURNS: The copy's duration, or 0 if it failed
+ * ---------------------------------------------------------------------------*/
+
+static size_t copy_run( int copy )
+
+   {
+   e_u32 duration;
+
+   copy = copy;
+
+   if (quiet_run( iterations, &duration ) != SUCCESS)
+      return 0;
+
+   return duration;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : report_copies
+ *
+ * DESC   : Runs 'copies' pinned copies of the benchmark at once and reports
+ *          each copy's iterations/sec, the aggregate over the wall-clock
+ *          time from the first copy's timer start to the last one's stop,
+ *          and the scaling efficiency: the aggregate over 'copies' times the
+ *          single copy run that took 'single' ticks.  Refuses more copies
+ *          than the CPUs the harness may run on, which would only time
+ *          slice them.
+ * ---------------------------------------------------------------------------*/
+
+static void report_copies( e_u32 single )
+
+   {
+   size_t durations[ TH_MAX_COPIES ];
+   double seconds[ TH_MAX_COPIES ];
+   int    cpus = al_cpu_count();
+   int    c;
+#if		FLOAT_SUPPORT
+   double ticks_per_sec;
+   double rate;
+   double last = 0.0;
+   int    done = 0;
+#endif
+
+   if (cpus > 0 && copies > cpus)
+      {
+      t_printf( ">> Copies Refused           : %d copies for %d CPUs\n", copies, cpus );
+      return;
+      }
+
+   i_flush_con();
+   if (al_run_copies( copies, copy_run, durations, seconds ) != Success)
+      {
+      t_printf( ">> Copies Failed            : %d\n", copies );
+      return;
+      }
+
+   t_printf( ">> Copies                   : %d\n", copies );
+
+#if		FLOAT_SUPPORT
+   ticks_per_sec = th_ticks_per_sec();
+
+   for (c = 0; c < copies; c++)
+      {
+      if (durations[c] == 0 || seconds[c] <= 0.0)
+         {
+         t_printf( "--  Copy %2d Iter/Sec   : Failed\n", c );
+         continue;
+         }
+
+      if (seconds[c] > last)
+         last = seconds[c];
+      done++;
+
+      th_printf( "--  Copy %2d Iter/Sec   = %12.3f\n", c,
+         (double) iterations / ( (double) durations[c] / ticks_per_sec ) );
+      }
+
+   if (done == 0)
+      return;
+
+   rate = (double) iterations * done / last;
+   th_printf( "--  Aggregate Iter/Sec = %12.3f\n", rate );
+
+   if (single > 0)
+      th_printf( "--  Scaling Efficiency = %12.3f%%\n",
+         100.0 * rate / ( (double) iterations / ( (double) single / ticks_per_sec ) * copies ) );
+#else
+   single = single;
+
+   for (c = 0; c < copies; c++)
+      t_printf( "--  Copy %2d Duration   = %lu\n", c, (unsigned long)durations[c] );
+#endif
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : report_trials
+ *
+ * DESC   : Runs the benchmark 'trials' more times and reports the mean,
+ *          standard deviation, coefficient of variation and 95% confidence
+ *          interval of their iterations/sec, warning when the variation is
+ *          above TH_TRIALS_MAX_CV percent.
+ * ---------------------------------------------------------------------------*/
+
+static void report_trials( void )
+
+   {
+   e_u32  duration;
+   int    t;
+   int    n = 0;
+#if		TH_CHECK_SCALING
+   const char *scaling;
+#endif
+#if		FLOAT_SUPPORT
+   /* two sided 95% Student t for 1 to 30 degrees of freedom */
+   static const double t95[ 30 ] = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+       2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+       2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+   double ticks_per_sec;
+   double rate;
+   double mean = 0.0;
+   double m2   = 0.0;
+   double lo   = 0.0;
+   double hi   = 0.0;
+   double delta;
+   double sd;
+   double half;
+#else
+   e_u32  lo = 0;
+   e_u32  hi = 0;
+#endif
+
+#if		TH_CHECK_SCALING
+   scaling = al_cpu_scaling( pin_cpu );
+   if ( scaling != NULL )
+      t_printf( ">> Warning                  : clock may vary, %s\n", scaling );
+#endif
+
+#if		FLOAT_SUPPORT
+   ticks_per_sec = th_ticks_per_sec();
+#endif
+
+   for (t = 0; t < trials; t++)
+      {
+      if (quiet_run( iterations, &duration ) != SUCCESS || duration == 0)
+         continue;
+      n++;
+
+#if		FLOAT_SUPPORT
+      /* Welford's running mean and sum of squared deviations */
+      rate  = (double) iterations / ( (double) duration / ticks_per_sec );
+      delta = rate - mean;
+      mean += delta / (double) n;
+      m2   += delta * ( rate - mean );
+      if (n == 1 || rate < lo)
+         lo = rate;
+      if (n == 1 || rate > hi)
+         hi = rate;
+#else
+      if (n == 1 || duration < lo)
+         lo = duration;
+      if (n == 1 || duration > hi)
+         hi = duration;
+#endif
+      }
+
+   t_printf( ">> Trials                   : %d of %d\n", n, trials );
+   if (n == 0)
+      return;
+
+   trial_count = n;
+
+#if		FLOAT_SUPPORT
+   sd   = n > 1 ? sqrt( m2 / (double)( n - 1 ) ) : 0.0;
+   half = n > 1 ? ( n - 1 <= 30 ? t95[ n - 2 ] : 1.960 ) * sd / sqrt( (double) n ) : 0.0;
+
+   trial_mean  = mean;
+   trial_sd    = sd;
+   trial_half  = half;
+
+   th_printf( "--  Trial Mean Iter/Sec   = %12.3f\n", mean );
+   th_printf( "--  Trial Min  Iter/Sec   = %12.3f\n", lo );
+   th_printf( "--  Trial Max  Iter/Sec   = %12.3f\n", hi );
+   th_printf( "--  Trial Std Deviation   = %12.3f\n", sd );
+   th_printf( "--  Trial Variation (CV)  = %12.3f%%\n", 100.0 * sd / mean );
+   th_printf( "--  Trial 95%% Interval    = %12.3f .. %.3f\n", mean - half, mean + half );
+
+   if (100.0 * sd / mean > (double) TH_TRIALS_MAX_CV)
+      t_printf( ">> Warning                  : variation above %d%%, differences within the interval are noise\n",
+         (int) TH_TRIALS_MAX_CV );
+#else
+   t_printf( "--  Trial Min Duration    = %lu\n", (unsigned long)lo );
+   t_printf( "--  Trial Max Duration    = %lu\n", (unsigned long)hi );
+#endif
+   }
+
+#if		TH_CACHE_COLD
+/*------------------------------------------------------------------------------
+ * FUNC   : report_cold
+ *
+ * DESC   : Runs the benchmark again with the caches evicted between
+ *          iterations and reports its iterations/sec against those of the
+ *          normal run that took 'hot' ticks.
+ * ---------------------------------------------------------------------------*/
+
+static void report_cold( e_u32 hot )
+
+   {
+   e_u32  duration;
+   int    rv;
+#if		FLOAT_SUPPORT
+   double ticks_per_sec;
+#endif
+
+   cold_failed = FALSE;
+   cold        = TRUE;
+   rv = quiet_run( iterations, &duration );
+   cold        = FALSE;
+
+   if (rv != SUCCESS || cold_failed)
+      {
+      t_printf( ">> Cache Cold Failed        : %s\n",
+         cold_failed ? "cannot allocate the eviction buffer" : "benchmark failed" );
+      return;
+      }
+
+   t_printf( ">> Cache Cold               : %lu bytes evicted per iteration\n",
+      (unsigned long)TH_CACHE_EVICT_SIZE );
+
+#if		FLOAT_SUPPORT
+   ticks_per_sec = th_ticks_per_sec();
+
+   if (hot > 0)
+      th_printf( "--  Hot Iter/Sec       = %12.3f\n",
+         (double) iterations / ( (double) hot / ticks_per_sec ) );
+   if (duration > 0)
+      th_printf( "--  Cold Iter/Sec      = %12.3f\n",
+         (double) iterations / ( (double) duration / ticks_per_sec ) );
+   if (hot > 0 && duration > 0)
+      th_printf( "--  Cold Slowdown      = %12.3fx\n", (double) duration / (double) hot );
+#else
+   t_printf( "--  Hot Duration       = %lu\n", (unsigned long)hot );
+   t_printf( "--  Cold Duration      = %lu\n", (unsigned long)duration );
+#endif
+   }
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : corun_bench
+ *
+ * DESC   : Runs the benchmark once, the load of a TH_CORUN_BENCH co-runner
+ * ---------------------------------------------------------------------------*/
+
+static void corun_bench( void )
+
+   {
+   e_u32 duration;
+
+   quiet_run( iterations, &duration );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : report_corun
+ *
+ * DESC   : Runs the benchmark again beside 'corun_copies' co-runners and
+ *          reports its iterations/sec against those of the solo run that
+ *          took 'solo' ticks.
+ * ---------------------------------------------------------------------------*/
+
+static void report_corun( e_u32 solo )
+
+   {
+   e_u32  duration;
+   int    rv;
+#if		FLOAT_SUPPORT
+   double ticks_per_sec;
+#endif
+
+   i_flush_con();
+   if (al_start_corunners( corun_copies, corun, corun_bench ) != Success)
+      {
+      t_printf( ">> Co-Run Failed            : cannot start %d %s co-runners on other CPUs\n",
+         corun_copies, corun_names[ corun ] );
+      return;
+      }
+   rv = quiet_run( iterations, &duration );
+   al_stop_corunners();
+
+   if (rv != SUCCESS)
+      {
+      t_printf( ">> Co-Run Failed            : benchmark failed\n" );
+      return;
+      }
+
+   t_printf( ">> Co-Run                   : %d %s\n", corun_copies, corun_names[ corun ] );
+
+#if		FLOAT_SUPPORT
+   ticks_per_sec = th_ticks_per_sec();
+
+   if (solo > 0)
+      th_printf( "--  Solo Iter/Sec      = %12.3f\n",
+         (double) iterations / ( (double) solo / ticks_per_sec ) );
+   if (duration > 0)
+      th_printf( "--  Co-Run Iter/Sec    = %12.3f\n",
+         (double) iterations / ( (double) duration / ticks_per_sec ) );
+   if (solo > 0 && duration > 0)
+      th_printf( "--  Co-Run Slowdown    = %12.3fx\n", (double) duration / (double) solo );
+#else
+   t_printf( "--  Solo Duration      = %lu\n", (unsigned long)solo );
+   t_printf( "--  Co-Run Duration    = %lu\n", (unsigned long)duration );
+#endif
+   }
+
+#if		TH_OVERHEAD
+/*------------------------------------------------------------------------------
+ * FUNC   : empty_kernel
+ *
+ * DESC   : The kernel of the overhead loop, which does nothing
+ * ---------------------------------------------------------------------------*/
+
+static void empty_kernel( void )
+
+   {
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : measure_overhead
+ *
+ * DESC   : Runs the timed loop of the empty benchmark for 'n' iterations
+ *          with the console output dropped, armed and reported like a
+ *          benchmark's so that the latency and profile instrumentation
+ *          does the same work.
+ *
+ * RETURNS: The duration of the loop
+ * ---------------------------------------------------------------------------*/
+
+static e_u32 measure_overhead( LoopCount n )
+
+   {
+   THTestResults results;
+   LoopCount     loop_cnt;
+
+   iterations    = n;
+   last_duration = 0;
+
+   mem_heap_initialize();
+
+   quiet = TRUE;
+   th_latency_begin( n );
+   th_signal_start();
+   for (loop_cnt = 0; loop_cnt < n; loop_cnt++)
+      {
+      (*overhead_kernel)();
+      th_latency_mark();
+      }
+   results.duration   = th_signal_finished();
+   results.iterations = n;
+   results.CRC        = 0;
+   results.v1         = 0;
+   results.v2         = 0;
+   results.v3         = 0;
+   results.v4         = 0;
+   results.info       = NULL;
+   results.verify_snr = FALSE;
+   th_report_results( &results, 0 );
+   quiet = FALSE;
+
+   return last_duration;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : report_overhead
+ *
+ * DESC   : Measures the harness and loop overhead of the normal run that
+ *          took 'raw' ticks and reports its raw, overhead and corrected
+ *          time per iteration.
+ * ---------------------------------------------------------------------------*/
+
+static void report_overhead( e_u32 raw )
+
+   {
+   e_u32  over;
+#if		FLOAT_SUPPORT
+   double ticks_per_sec;
+   double its;
+#endif
+
+   over = measure_overhead( iterations );
+
+   overhead_done  = TRUE;
+   overhead_raw   = raw;
+   overhead_ticks = over;
+
+   t_printf( ">> Overhead                 : %lu iterations of the empty kernel\n",
+      (unsigned long)iterations );
+   t_printf( "--  Overhead Duration  = %lu\n", (unsigned long)over );
+
+#if		FLOAT_SUPPORT
+   ticks_per_sec = th_ticks_per_sec();
+   its           = (double) iterations;
+
+   if (iterations > 0)
+      {
+      th_printf( "--  Raw Time / Iter    = %18.9fsec\n",
+         (double) raw / ticks_per_sec / its );
+      th_printf( "--  Overhead / Iter    = %18.9fsec\n",
+         (double) over / ticks_per_sec / its );
+      th_printf( "--  Corrected / Iter   = %18.9fsec\n",
+         raw > over ? (double)( raw - over ) / ticks_per_sec / its : 0.0 );
+      }
+#else
+   t_printf( "--  Corrected Duration = %lu\n",
+      (unsigned long)( raw > over ? raw - over : 0 ) );
+#endif
+
+   if (over >= raw)
+      t_printf( ">> Warning                  : overhead not below the benchmark, too few iterations for the timer\n" );
+   }
+#endif
+
+#if		!CRC_CHECK
+
+/*------------------------------------------------------------------------------
+ * FUNC   : calibrate_iterations
+ *
+ * DESC   : Picks the iteration count that makes a run take about 'secs'
+ *          seconds.  Runs TH_CALIBRATE_WARMUP untimed iterations first,
+ *          then probes with ten times more iterations each run until one
+ *          takes a tenth of the target, and scales from that run.
+ *
+ * RETURNS: The calibrated iterations, or the recommended iterations if a
+ *          probe run fails.
+ * ---------------------------------------------------------------------------*/
+
+static LoopCount calibrate_iterations( size_t secs )
+
+   {
+   LoopCount n;
+   e_u32     duration;
+   size_t    target;
+
+   target = secs * th_ticks_per_sec();
+
+   if (quiet_run( TH_CALIBRATE_WARMUP, &duration ) != SUCCESS)
+      return the_tcdef_ptr->rec_iterations;
+
+   for (n = 1; ; n *= 10)
+      {
+      if (quiet_run( n, &duration ) != SUCCESS)
+         return the_tcdef_ptr->rec_iterations;
+
+      if (duration >= target / 10 || n > ((LoopCount)~0) / 100)
+         break;
+      }
+
+   if (duration == 0)
+      return n;
+
+#if		FLOAT_SUPPORT
+   n = (LoopCount)( (double) n * (double) target / (double) duration );
+#else
+   n = n * ( target / duration );
+#endif
+
+   return n > 0 ? n : 1;
+   }
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : run_benchmark
+ *
+ * DESC   : Runs the_tcdef_ptr's benchmark once and reports it, calibrating
+ *          the iterations first and following with the overhead, the
+ *          copies, the trials, the cache cold run and the co-run when those
+ *          modes are on.
+ *
+ * PARAMS : duration - gets the duration of the normal run, not that of
+ *                     the follow-up runs.  May be NULL.
+ *
+ * RETURNS: The benchmark's return value
+ * ---------------------------------------------------------------------------*/
+
+static int run_benchmark( e_u32 *duration )
+
+   {
+   int   rv;
+   e_u32 hot;
+
+#if		!CRC_CHECK
+   if ( calibrate_secs > 0 )
+      {
+      iterations = calibrate_iterations( calibrate_secs );
+
+      t_printf( ">> Calibrated Iterations    : %lu (%lu sec)\n",
+         (unsigned long)iterations, (unsigned long)calibrate_secs );
+      }
+#endif
+
+   mem_heap_initialize();  /* start the heap up! */
+#if		TH_FOOTPRINT
+   foot_start();
+#endif
+
+   /* Ok, now go execute the test.... */
+   trial_count = 0;
+#if		TH_OVERHEAD
+   overhead_done = FALSE;
+#endif
+   rv = the_tcdef_ptr->tcip_run_test( iterations, argca, argva );
+   hot = last_duration;
+   if ( duration != NULL )
+      *duration = hot;
+
+#if		TH_OVERHEAD
+   if ( rv == SUCCESS )
+      report_overhead( hot );
+#endif
+   if ( rv == SUCCESS && copies > 0 )
+      report_copies( hot );
+   if ( rv == SUCCESS && trials > 0 )
+      report_trials();
+#if		TH_CACHE_COLD
+   if ( rv == SUCCESS )
+      report_cold( hot );
+#endif
+   if ( rv == SUCCESS && corun != TH_CORUN_NONE )
+      report_corun( hot );
+   end_record();
+
+   if ( rv == SUCCESS )
+      t_printf( ">> DONE!\n" );
+   else
+      t_printf( ">> Failure: %d\n", rv );
+   /* 
+    * user defined print information
+    * outside fixed standard log so automated scripts still work
+    */
+   al_report_results();
+
+   return rv;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : suite_run
+ *
+ * DESC   : Runs the copy'th benchmark of the suite for al_run_copies()
+ *
+ * RETURNS: The benchmark's duration, or 0 if it failed
+ * ---------------------------------------------------------------------------*/
+
+static size_t suite_run( int copy )
+
+   {
+   e_u32 duration;
+
+   the_tcdef_ptr = suite_tcdef[ copy ];
+
+   if (quiet_run( suite_its[ copy ], &duration ) != SUCCESS)
+      return 0;
+
+   return duration;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : run_suite
+ *
+ * DESC   : Runs every benchmark on the_tcdef_ptr's next chain, one after
+ *          the other with the normal report each, or with -parallel all at
+ *          once, pinned like the copies and with their output dropped.
+ *          Then reports each benchmark's iterations/sec and the suite
+ *          score, the geometric mean of those over TH_SUITE_NORM.
+ *
+ * RETURNS: Success, or the first failing benchmark's return value
+ * ---------------------------------------------------------------------------*/
+
+static int run_suite( void )
+
+   {
+   TCDef  *head = the_tcdef_ptr;
+   size_t  durations[ TH_MAX_SUITE ];
+   e_u32   duration;
+   int     rv = Success;
+   int     n;
+   int     b;
+#if		FLOAT_SUPPORT
+   double  rate;
+   double  logs = 0.0;
+   int     scored = 0;
+#endif
+
+   in_suite = TRUE;
+   for (n = 0; the_tcdef_ptr != NULL && n < TH_MAX_SUITE; n++)
+      {
+      suite_tcdef[ n ] = the_tcdef_ptr;
+      suite_its[ n ]   = fixed_iterations ? iterations : the_tcdef_ptr->rec_iterations;
+      the_tcdef_ptr    = the_tcdef_ptr->next;
+      }
+
+   for (b = 0; b < n; b++)
+      {
+      the_tcdef_ptr = suite_tcdef[ b ];
+      iterations    = suite_its[ b ];
+
+      if ( parallel )
+         {
+#if		!CRC_CHECK
+         if ( calibrate_secs > 0 )
+            suite_its[ b ] = calibrate_iterations( calibrate_secs );
+#endif
+         continue;
+         }
+
+      t_printf( ">> BM: %s\n", the_tcdef_ptr->desc );
+
+      durations[ b ] = 0;
+      if ( run_benchmark( &duration ) == SUCCESS )
+         durations[ b ] = duration;
+      else if ( rv == Success )
+         rv = Failure;
+
+      suite_its[ b ] = iterations;
+      }
+
+   if ( parallel )
+      i_flush_con();
+   if ( parallel && al_run_copies( n, suite_run, durations, NULL ) != Success )
+      {
+      t_printf( ">> Suite Parallel Failed    : %d\n", n );
+      rv = Failure;
+      }
+
+   the_tcdef_ptr = head;
+   iterations    = suite_its[ 0 ];
+   in_suite      = FALSE;
+
+   t_printf( ">> Suite                    : %d (%s)\n", n,
+      parallel ? "parallel" : "sequential" );
+
+#if		FLOAT_SUPPORT
+   for (b = 0; b < n; b++)
+      {
+      if (durations[ b ] == 0)
+         {
+         t_printf( "--  Iter/Sec        :          n/a %s\n", suite_tcdef[ b ]->desc );
+         continue;
+         }
+
+      rate = (double) suite_its[ b ] /
+         ( (double) durations[ b ] / (double) th_ticks_per_sec() );
+      logs += log( rate );
+      scored++;
+
+      th_printf( "--  Iter/Sec        = %12.3f %s\n", rate, suite_tcdef[ b ]->desc );
+      }
+
+   if (scored == n && n > 0)
+      th_printf( "--  %-16s= %12.3f\n", TH_SUITE_SCORE, exp( logs / n ) / TH_SUITE_NORM );
+   else
+      t_printf( "--  %-16s= n/a\n", TH_SUITE_SCORE );
+#else
+   for (b = 0; b < n; b++)
+      t_printf( "--  Duration        = %lu %s\n", (unsigned long)durations[ b ],
+         suite_tcdef[ b ]->desc );
+#endif
+
+   if ( rv == Success )
+      t_printf( ">> DONE!\n" );
+   else
+      t_printf( ">> Failure: %d\n", rv );
+
+   return rv;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : th_main
  *
  * DESC   : The portable (target independent) test harness entry point
  * ---------------------------------------------------------------------------*/
@@ -1249,6 +3226,75 @@ int th_main( int argc, const char *argv[] )
           */
           autogo = TRUE;
           }
+       if ( is_results_option( argv[i] ) != TH_RESULTS_NONE )
+          {
+          /* -json[=<file>] or -csv[=<file>] appends a record per run */
+          const char *path = strchr( argv[i], '=' );
+
+          results_format = is_results_option( argv[i] );
+          results_path[0] = '\0';
+          if ( path != NULL && path[1] != '\0' )
+             {
+             strncpy( results_path, path + 1, REC_PATH_SIZE - 1 );
+             results_path[ REC_PATH_SIZE - 1 ] = '\0';
+             }
+          }
+       if ( is_parallel_option( argv[i] ) )
+          {
+          /* -parallel runs a suite's benchmarks all at once */
+          parallel = TRUE;
+          }
+#if TH_DATA_FILES
+       if ( is_data_option( argv[i] ) )
+          {
+          /* -data=, -in=, -ref= and -crc= pick the data set */
+          const char *v = strchr( argv[i], '=' ) + 1;
+
+          if ( argv[i][1] == 'd' )
+             data_dir = v;
+          else if ( argv[i][1] == 'i' )
+             data_name[ TH_DATA_INPUT ] = v;
+          else if ( argv[i][1] == 'r' )
+             data_name[ TH_DATA_GOLDEN ] = v;
+          else
+             {
+             data_crc     = (e_u16)strtoul( v, NULL, 16 );
+             data_crc_set = TRUE;
+             }
+          }
+#endif
+       if ( is_copies_option( argv[i] ) )
+          {
+          /* -copies<n> runs <n> pinned copies after the benchmark */
+          copies = atoi( argv[i]+7 );
+          if ( copies > TH_MAX_COPIES )
+             copies = TH_MAX_COPIES;
+          }
+       if ( is_corun_option( argv[i] ) != TH_CORUN_NONE )
+          {
+          /* -corun=<load>[:<n>] runs the benchmark again beside <n>
+           * co-runners */
+          const char *n = strchr( argv[i], ':' );
+
+          corun = is_corun_option( argv[i] );
+          if ( n != NULL && isdigit( n[1] ) )
+             corun_copies = atoi( n + 1 );
+          }
+       if ( is_trials_option( argv[i] ) )
+          {
+          /* -trials<n> repeats the benchmark <n> times after it */
+          trials = atoi( argv[i]+7 );
+          }
+       if ( is_pin_option( argv[i] ) )
+          {
+          /* -pin<n> pins the harness to CPU <n> */
+          pin_cpu = atoi( argv[i]+4 );
+          }
+       if ( is_kernel_option( argv[i] ) )
+          {
+          /* -kernel=<list> forces kernel variants */
+          kernel_opt = argv[i]+8;
+          }
 #if		!CRC_CHECK
        if ( argv[i][0] == '-' && toupper( argv[i][1] ) == 'I' )
           {
@@ -1257,16 +3303,31 @@ int th_main( int argc, const char *argv[] )
         	  {
 	            t_printf( "{ Reset iterations to recommended value }\n\n" );
     	        iterations = the_tcdef_ptr->rec_iterations;
+    	        fixed_iterations = FALSE;
     	      }
           else if ( isdigit( argv[i][2] ) )
              {
              /* set the number of iterations from the command line */
              iterations = (LoopCount)atol( argv[i]+2 );
+             fixed_iterations = TRUE;
              }
           else if ( i < (argc-1) && isdigit( argv[i+1][0] ) )
              {
              /* set the number of iterations from the command line */
              iterations = (LoopCount)atol( argv[i+1] );
+             fixed_iterations = TRUE;
+             }
+
+          /* -iauto[<secs>] calibrates the iterations, anything else
+           * fixes them */
+          if ( is_auto_option( &argv[i][2] ) )
+             {
+             calibrate_secs = isdigit( argv[i][6] ) ?
+                (size_t)atol( argv[i]+6 ) : TH_CALIBRATE_SECONDS;
+             }
+          else
+             {
+             calibrate_secs = 0;
              }
           }
 #endif
@@ -1276,6 +3337,10 @@ int th_main( int argc, const char *argv[] )
         * Hey!  Everything is OK!  We have a command line so lets
         * just run the darned thing
        */
+       if ( results_path[0] == '\0' )
+          t_sprintf( results_path, "%s%s", TH_RESULTS_FILE,
+             results_format == TH_RESULTS_CSV ? ".csv" : ".json" );
+
        mem_mgr_init(); /* intialize the memory management sub-system */
 
        if ( argc == 0)
@@ -1295,7 +3360,14 @@ int th_main( int argc, const char *argv[] )
              {
 			  /* strip the ones we handle in the harness */
 	         if ( strcmp( argv[i], "-autogo" ) == 0 ||
-                  strcmp( argv[i], "-AUTOGO" ) == 0)
+                  strcmp( argv[i], "-AUTOGO" ) == 0 ||
+                  is_copies_option( argv[i] ) ||
+                  is_trials_option( argv[i] ) ||
+                  is_pin_option( argv[i] ) ||
+                  is_kernel_option( argv[i] ) ||
+                  is_parallel_option( argv[i] ) ||
+                  is_data_option( argv[i] ) ||
+                  is_results_option( argv[i] ) != TH_RESULTS_NONE)
                     continue;
                  /* For the -i option, handle three
                   * cases:  -idefault (case
@@ -1304,6 +3376,7 @@ int th_main( int argc, const char *argv[] )
                  {
                     if (strcmp(&argv[i][2], "default") == 0 ||
                           strcmp(&argv[i][2], "DEFAULT") == 0 ||
+                          is_auto_option(&argv[i][2]) ||
                           isdigit(argv[i][2]))
                        continue;
                     else if (i < (argc-1) && isdigit(
@@ -1323,6 +3396,14 @@ int th_main( int argc, const char *argv[] )
           set_cmd_line( inbuf );
           }
 
+      if ( pin_cpu >= 0 )
+         {
+         if ( al_pin_cpu( pin_cpu ) == Success )
+            t_printf( ">> Pinned to CPU            : %d\n", pin_cpu );
+         else
+            t_printf( ">> Pin Failed               : CPU %d\n", pin_cpu );
+         }
+
       /* Now: gather commands and run benchmarks, as directed by the user */
       for(;;)
          {
@@ -1335,30 +3416,22 @@ int th_main( int argc, const char *argv[] )
                break;
 
             case RUN_BENCHMARK:
-               mem_heap_initialize();  /* start the heap up! */
-
-               /* Ok, now go execute the test.... */
-               rv = the_tcdef_ptr->tcip_run_test( iterations, argca, argva );
-
-               if ( rv == SUCCESS )
-                  t_printf( ">> DONE!\n" );
+               if ( the_tcdef_ptr->next != NULL )
+                  rv = run_suite();
                else
-                  t_printf( ">> Failure: %d\n", rv );
-               /* 
-                * user defined print information
-                * outside fixed standard log so automated scripts still work
-                */
-               al_report_results();
+                  rv = run_benchmark( NULL );
             break;
 
             default:
             case USER_EXIT:
                t_printf( ">> USER EXIT!\n" );
+               i_flush_con();
                return Success;
             }
          }
       }
 
+   i_flush_con();
    return rv;
    }
 
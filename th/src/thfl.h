@@ -33,6 +33,7 @@ int    i_putchar( char c );
 int    i_write_con( const char *buf, size_t buf_size );
 size_t i_read_con( char *buf, size_t buf_size );
 size_t i_con_chars_avail( void );
+int    i_flush_con( void );
 
 FP     i_open( const char file_name, int oflag );
 int    i_read( const FP file_ptr, char *buf, size_t buf_size );
@@ -59,8 +60,18 @@ int    i_harness_poll( void );
 
 FileDef *i_get_file_def( const char *fn );
 FileDef *i_get_file_num( int n );
+FileDef *i_get_data_file( int kind, const char *fn );
+void   i_evict_caches( void );
+int    i_kernel_select( const char *kernel, const THKernelVariant *variants, int count );
+double i_wall_seconds( void );
+THPool *i_pool_open( int threads );
+void   i_pool_run( THPool *pool, THPartFunc run, void *arg );
+void   i_pool_close( THPool *pool );
 
 int i_send_buf_as_file( const char* buf, BlockSize length, const char* fn );
+int i_file_begin( const char *fn );
+int i_file_write( const char *buf, size_t length );
+int i_file_end( void );
 
 /*----------------------------------------------------------------------------*/
 
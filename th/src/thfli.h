@@ -41,6 +41,7 @@ typedef int (*thft_putchar) ( char c );
 typedef int (*thft_write_con) ( const char *buf, size_t buf_size );
 typedef size_t( *thft_read_con ) ( char *buf, size_t buf_size );
 typedef size_t (*thft_con_chars_avail) ( void );
+typedef int (*thft_flush_con) ( void );
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  * Target Timer Support
@@ -50,6 +51,7 @@ typedef size_t (*thft_con_chars_avail) ( void );
 
 typedef size_t (*thft_ticks_per_sec) ( void );
 typedef size_t (*thft_tick_granularity) ( void );
+typedef size_t (*thft_ticks) ( void );
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  * Target memory allocation support
@@ -75,6 +77,15 @@ typedef int (*thft_report_results) ( const THTestResults * results, e_u16 Expect
 
 typedef int (*thft_harness_poll) ( void );
 
+typedef void (*thft_evict_caches) ( void );
+
+typedef int (*thft_kernel_select) ( const char *kernel, const THKernelVariant *variants, int count );
+
+typedef double (*thft_wall_seconds) ( void );
+typedef THPool * ( *thft_pool_open ) ( int threads );
+typedef void (*thft_pool_run) ( THPool *pool, THPartFunc run, void *arg );
+typedef void (*thft_pool_close) ( THPool *pool );
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  * File Handling
 */
@@ -85,6 +96,11 @@ typedef FileDef * ( *thft_get_file_num ) ( int n );
 typedef int (*thft_send_buf_as_file)
                      ( const char* buf, BlockSize length, const char* fn );
 
+typedef int (*thft_file_begin) ( const char *fn );
+typedef int (*thft_file_write) ( const char *buf, size_t length );
+typedef int (*thft_file_end) ( void );
+typedef FileDef * ( *thft_get_data_file ) ( int kind, const char *fn );
+
 /*------------------------------------------------------------------------------
  * Structures and Typedefs
 
@@ -100,9 +116,15 @@ typedef int (*thft_send_buf_as_file)
  *     - obtain pointers to the test harness entry points
 */
 
-/* THDef.revsion == 4  { this is revision 2 of this structure } */
+/* THDef.revsion == 5  { revision 5 adds thip_ticks } */
+/* THDef.revsion == 6  { revision 6 adds thip_flush_con } */
+/* THDef.revsion == 7  { revision 7 adds thip_file_begin, _write and _end } */
+/* THDef.revsion == 8  { revision 8 adds thip_get_data_file } */
+/* THDef.revsion == 9  { revision 9 adds thip_evict_caches } */
+/* THDef.revsion == 10 { revision 10 adds thip_kernel_select } */
+/* THDef.revsion == 11 { revision 11 adds thip_wall_seconds and thip_pool_ } */
 
-#define THDEF_REVISION (4)
+#define THDEF_REVISION (11)
 
 typedef struct THDef
 
@@ -139,6 +161,7 @@ typedef struct THDef
 
    thft_ticks_per_sec          thip_ticks_per_sec;
    thft_tick_granularity       thip_tick_granularity;
+   thft_ticks                  thip_ticks;
 
    thft_malloc                 thip_malloc;
    thft_free                   thip_free;
@@ -154,6 +177,23 @@ typedef struct THDef
    thft_get_file_num           thip_get_file_num;
 
    thft_send_buf_as_file       thip_send_buf_as_file;
+
+   thft_flush_con              thip_flush_con;
+
+   thft_file_begin             thip_file_begin;
+   thft_file_write             thip_file_write;
+   thft_file_end               thip_file_end;
+
+   thft_get_data_file          thip_get_data_file;
+
+   thft_evict_caches           thip_evict_caches;
+
+   thft_kernel_select          thip_kernel_select;
+
+   thft_wall_seconds           thip_wall_seconds;
+   thft_pool_open              thip_pool_open;
+   thft_pool_run               thip_pool_run;
+   thft_pool_close             thip_pool_close;
    }
 THDef;
 
@@ -13,6 +13,12 @@
 #include "printfe.h"
 
 #include <stdio.h>
+#if TH_LATENCY_BATCH
+#include <stdlib.h> /* qsort */
+#endif
+#if TH_PROFILE
+#include <string.h> /* strncmp */
+#endif
 
 /*------------------------------------------------------------------------------
  * This sturcture is intentionally static.  Nothing outside this file
@@ -21,6 +27,41 @@
 */
 static THDef *thdef = NULL;
 
+#if TH_LATENCY_BATCH
+/*------------------------------------------------------------------------------
+ * Latency histogram state. lat_stamps holds lat_size timestamps, the first
+ * taken by th_signal_start() and one per TH_LATENCY_BATCH iterations after
+ * it. lat_armed is set by th_latency_begin() until th_signal_start(), and
+ * lat_open while the timed loop runs.
+*/
+static size_t *lat_stamps = NULL;
+static size_t  lat_size   = 0;
+static size_t  lat_used   = 0;
+static size_t  lat_count  = 0;
+static int     lat_armed  = 0;
+static int     lat_open   = 0;
+
+/* lat_points holds the summary th_report_results() takes of lat_samples
+ * batch durations, in the order of lat_names. */
+static const char *lat_names[ TH_LATENCY_POINTS ] =
+   { "min", "p50", "p90", "p99", "p99.9", "max" };
+static size_t  lat_points[ TH_LATENCY_POINTS ];
+static size_t  lat_samples = 0;
+#endif
+
+#if TH_PROFILE
+/*------------------------------------------------------------------------------
+ * Stage profile. prof_ticks and prof_calls add up each stage while prof_open,
+ * from th_signal_start() to th_signal_finished(), prof_start holds the tick
+ * TH_PROF_BEGIN() read and prof_names the name TH_PROF_END() gave.
+*/
+static size_t      prof_start[ TH_PROF_STAGES ];
+static size_t      prof_ticks[ TH_PROF_STAGES ];
+static size_t      prof_calls[ TH_PROF_STAGES ];
+static const char *prof_names[ TH_PROF_STAGES ];
+static int         prof_open = 0;
+#endif
+
 /*------------------------------------------------------------------------------
  * FUNC   : thlib_main
  *
@@ -303,6 +344,21 @@ size_t th_con_chars_avail( void )
    return (*thdef->thip_con_chars_avail)();
    }
 
+/*------------------------------------------------------------------------------
+ * FUNC   : th_flush_con
+ *
+ * DESC   : Sends any console output the test harness is holding, see
+ *          TH_CON_BUF_SIZE in thcfg.h
+ *
+ * RETURNS: Success or Failure
+ * ---------------------------------------------------------------------------*/
+
+int th_flush_con( void )
+
+   {
+   return (*thdef->thip_flush_con)();
+   }
+
 /*------------------------------------------------------------------------------
  * FUNC   : th_read_con
  *
@@ -418,6 +474,19 @@ size_t th_tick_granularity( void )
 	return (*thdef->thip_tick_granularity)();
 }
 
+/*------------------------------------------------------------------------------
+ * FUNC   : th_ticks
+ *
+ * DESC   : Reads the target timer without signalling the host
+ *
+ * RETURNS: The current timer value in th_ticks_per_sec() ticks
+ * ---------------------------------------------------------------------------*/
+
+size_t th_ticks( void )
+{
+	return (*thdef->thip_ticks)();
+}
+
 /*------------------------------------------------------------------------------
  * FUNC    : th_malloc_x
  *
@@ -466,6 +535,66 @@ void th_free_x( void *block, const char *file, int line )
    ( *thdef->thip_free ) ( block, file, line );
    }
 
+/*------------------------------------------------------------------------------
+ * FUNC    : th_malloc_aligned_x
+ *
+ * DESC    : Test Harness aligned malloc()
+ *
+ *           Gets a block 'align' - 1 bytes and a pointer bigger from
+ *           th_malloc_x(), which works with every heap manager, and returns
+ *           the first 'align' byte boundary in it with the pointer to the
+ *           block right in front.
+ *
+ * PARAMS  : size  - is the size of the memory block neded
+ *           align - the alignment, a power of 2
+ *           file  - the __FILE__ macro from where the call was made
+ *           line  - the __LINE__ macro from where the call was made
+ *
+ * NOTE    : This function is usually invoked by using the
+ *           th_malloc_aligned() macro.  Free the block with
+ *           th_free_aligned().
+ *
+ * RETURNS : A pointer to the aligned block, or NULL if 'align' is not a
+ *           power of 2 or the block cannot be allocated.
+ * ---------------------------------------------------------------------------*/
+
+void *th_malloc_aligned_x( size_t size, size_t align, const char *file, int line )
+
+   {
+   char *block;
+   char *aligned;
+
+   if (align < sizeof(void *))
+      align = sizeof(void *);
+   if (( align & ( align - 1 )) != 0)
+      return NULL;
+
+   block = (char *) th_malloc_x( size + align - 1 + sizeof(void *), file, line );
+   if (block == NULL)
+      return NULL;
+
+   aligned = block + sizeof(void *);
+   aligned += ( align - (size_t) aligned % align ) % align;
+   ((void **) aligned)[ -1 ] = block;
+
+   return (void *) aligned;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC    : th_free_aligned_x
+ *
+ * DESC    : Test Harness free() for th_malloc_aligned() blocks
+ *
+ * NOTE    : It is valid to pass the null pointer to this function.
+ * ---------------------------------------------------------------------------*/
+
+void th_free_aligned_x( void *block, const char *file, int line )
+
+   {
+   if (block != NULL)
+      th_free_x( ((void **) block)[ -1 ], file, line );
+   }
+
 /*------------------------------------------------------------------------------
  * FUNC   : th_heap_reset()
  *
@@ -497,7 +626,28 @@ void th_heap_reset( void )
 void th_signal_start( void )
 
    {
+#if TH_PROFILE
+   int i;
+
+   for ( i = 0; i < TH_PROF_STAGES; i++ )
+      {
+      prof_ticks[i] = 0;
+      prof_calls[i] = 0;
+      prof_names[i] = NULL;
+      }
+   prof_open = 1;
+#endif
    ( *thdef->thip_signal_start )();
+#if TH_LATENCY_BATCH
+   if ( lat_armed )
+      {
+      lat_armed     = 0;
+      lat_open      = 1;
+      lat_count     = 0;
+      lat_stamps[0] = th_ticks();
+      lat_used      = 1;
+      }
+#endif
    }
 
 /*------------------------------------------------------------------------------
@@ -524,9 +674,227 @@ void th_signal_start( void )
 size_t th_signal_finished( void )
 
    {
+#if TH_LATENCY_BATCH
+   lat_open = 0;
+#endif
+#if TH_PROFILE
+   prof_open = 0;
+#endif
    return (*thdef->thip_signal_finished)();
    }
 
+#if TH_LATENCY_BATCH
+/*------------------------------------------------------------------------------
+ * FUNC   : th_latency_begin
+ *
+ * DESC   : Arms the latency histogram for the next timed loop of
+ *          iterations iterations, allocating its timestamps now so that
+ *          none are allocated inside the timed region.
+ * ---------------------------------------------------------------------------*/
+
+void th_latency_begin( size_t iterations )
+
+   {
+   if ( lat_stamps != NULL )
+      th_free( lat_stamps );
+   lat_size   = iterations / TH_LATENCY_BATCH + 1;
+   lat_stamps = (size_t *)th_malloc( lat_size * sizeof(size_t) );
+   if ( lat_stamps == NULL )
+      th_exit( THE_OUT_OF_MEMORY, "Cannot Allocate Memory %s:%d", __FILE__, __LINE__ );
+   lat_used  = 0;
+   lat_armed = 1;
+   lat_open  = 0;
+   }
+
+#endif
+
+#if TH_LATENCY_BATCH || TH_CACHE_COLD
+/*------------------------------------------------------------------------------
+ * FUNC   : th_latency_mark
+ *
+ * DESC   : Called after each iteration of the timed loop. Every
+ *          TH_LATENCY_BATCH-th call stores a timestamp, and in the cache
+ *          cold run every call evicts the caches.
+ * ---------------------------------------------------------------------------*/
+
+void th_latency_mark( void )
+
+   {
+#if TH_LATENCY_BATCH
+   if ( lat_open && ++lat_count == TH_LATENCY_BATCH )
+      {
+      lat_count = 0;
+      if ( lat_used < lat_size )
+         lat_stamps[lat_used++] = th_ticks();
+      }
+#endif
+#if TH_CACHE_COLD
+   ( *thdef->thip_evict_caches )();
+#endif
+   }
+#endif
+
+#if TH_LATENCY_BATCH
+
+static int lat_compare( const void *a, const void *b )
+{
+   size_t x = *(const size_t *)a, y = *(const size_t *)b;
+
+   return x < y ? -1 : x > y;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : lat_summarize
+ *
+ * DESC   : Turns the timestamps into sorted batch durations, takes their
+ *          min, p50, p90, p99, p99.9 and max, nearest rank, into
+ *          lat_points, then frees the buffer.
+ * ---------------------------------------------------------------------------*/
+
+static void lat_summarize( void )
+
+   {
+   static const size_t  permille[ TH_LATENCY_POINTS ] = { 0, 500, 900, 990, 999, 1000 };
+   size_t               n, i, rank;
+
+   n = lat_used > 0 ? lat_used - 1 : 0;
+   for ( i = 0; i < n; i++ )
+      lat_stamps[i] = lat_stamps[i + 1] - lat_stamps[i];
+   qsort( lat_stamps, n, sizeof(size_t), lat_compare );
+
+   for ( i = 0; i < TH_LATENCY_POINTS && n > 0; i++ )
+      {
+      rank = ( n * permille[i] + 999 ) / 1000;
+      rank = rank == 0 ? 0 : rank - 1;
+      lat_points[i] = lat_stamps[rank];
+      }
+   lat_samples = n;
+
+   th_free( lat_stamps );
+   lat_stamps = NULL;
+   lat_used   = 0;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : lat_report
+ *
+ * DESC   : Prints the summary lat_summarize() took.
+ * ---------------------------------------------------------------------------*/
+
+static void lat_report( void )
+
+   {
+   size_t i;
+
+   th_printf( "--  Latency Batch   = %12lu iterations\n", (unsigned long)TH_LATENCY_BATCH );
+   th_printf( "--  Latency Samples = %12lu\n", (unsigned long)lat_samples );
+   for ( i = 0; i < TH_LATENCY_POINTS && lat_samples > 0; i++ )
+      {
+#if FLOAT_SUPPORT
+      th_printf( "--  Latency %-6s  = %18.9fsec\n", lat_names[i],
+                 (double)lat_points[i] / th_ticks_per_sec() );
+#else
+      th_printf( "--  Latency %-6s  = %12lu ticks\n", lat_names[i], (unsigned long)lat_points[i] );
+#endif
+      }
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : th_latency_points
+ *
+ * DESC   : Gives the latency summary of the results being reported, for
+ *          the functional layer's th_report_results() implementation.
+ *          points gets the TH_LATENCY_POINTS batch durations in ticks.
+ *
+ * RETURNS: The number of batches summarized, 0 if there is no summary
+ * ---------------------------------------------------------------------------*/
+
+size_t th_latency_points( size_t *points )
+
+   {
+   size_t i;
+
+   for ( i = 0; i < TH_LATENCY_POINTS && lat_samples > 0; i++ )
+      points[i] = lat_points[i];
+   return lat_samples;
+   }
+#endif
+
+#if TH_PROFILE
+/*------------------------------------------------------------------------------
+ * FUNC   : th_prof_begin
+ *
+ * DESC   : TH_PROF_BEGIN(), the start of a stage of the timed loop
+ * ---------------------------------------------------------------------------*/
+
+void th_prof_begin( int id )
+
+   {
+   if ( id >= 0 && id < TH_PROF_STAGES )
+      prof_start[id] = th_ticks();
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : th_prof_end
+ *
+ * DESC   : TH_PROF_END(), adds the stage since th_prof_begin() to slot id
+ * ---------------------------------------------------------------------------*/
+
+void th_prof_end( int id, const char *name )
+
+   {
+   size_t now = th_ticks();
+
+   if ( prof_open && id >= 0 && id < TH_PROF_STAGES )
+      {
+      prof_ticks[id] += now - prof_start[id];
+      prof_calls[id]++;
+      prof_names[id]  = name;
+      }
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : prof_report
+ *
+ * DESC   : Prints each stage of the profile, its calls, ticks per call and
+ *          share of the run's duration, then the share of all the stages.
+ * ---------------------------------------------------------------------------*/
+
+static void prof_report( size_t duration )
+
+   {
+   size_t      total = 0;
+   const char *name;
+   int         i;
+
+   for ( i = 0; i < TH_PROF_STAGES; i++ )
+      {
+      if ( prof_calls[i] == 0 )
+         continue;
+      name = prof_names[i];
+      if ( strncmp( name, "PROF_", 5 ) == 0 )
+         name += 5;
+      total += prof_ticks[i];
+#if FLOAT_SUPPORT
+      th_printf( "--  Stage %-12s= %10lu calls %14.3f ticks/call %6.2f%%\n", name,
+                 (unsigned long)prof_calls[i], (double)prof_ticks[i] / prof_calls[i],
+                 duration > 0 ? 100.0 * prof_ticks[i] / duration : 0.0 );
+#else
+      th_printf( "--  Stage %-12s= %10lu calls %10lu ticks/call %3lu%%\n", name,
+                 (unsigned long)prof_calls[i], (unsigned long)( prof_ticks[i] / prof_calls[i] ),
+                 (unsigned long)( duration > 0 ? prof_ticks[i] / ( duration / 100 + 1 ) : 0 ) );
+#endif
+      }
+#if FLOAT_SUPPORT
+   th_printf( "--  Stages Total      = %10lu ticks %6.2f%% of the run\n", (unsigned long)total,
+              duration > 0 ? 100.0 * total / duration : 0.0 );
+#else
+   th_printf( "--  Stages Total      = %10lu ticks %3lu%% of the run\n", (unsigned long)total,
+              (unsigned long)( duration > 0 ? total / ( duration / 100 + 1 ) : 0 ) );
+#endif
+   }
+#endif
+
 /*------------------------------------------------------------------------------
  * FUNC   : th_exit
  *
@@ -560,7 +928,27 @@ void th_exit( int exit_code, const char *fmt, ... )
 
 int th_report_results( const THTestResults *results, e_u16 Expected_CRC )
 {
-   return ( *thdef->thip_report_results ) ( results, Expected_CRC );
+   int rv;
+#if TH_LATENCY_BATCH
+   int lat = lat_stamps != NULL;
+
+   /* summarize first so the functional layer can record the summary */
+   lat_samples = 0;
+   if ( lat )
+      lat_summarize();
+#endif
+
+   rv = ( *thdef->thip_report_results ) ( results, Expected_CRC );
+#if TH_LATENCY_BATCH
+   if ( lat )
+      lat_report();
+   lat_samples = 0;
+#endif
+#if TH_PROFILE
+   prof_report( results->duration );
+#endif
+   th_flush_con();
+   return rv;
 }
 
 /*------------------------------------------------------------------------------
@@ -636,6 +1024,126 @@ const FileDef *th_get_file_num( int idx )
    return (*thdef->thip_get_file_num) ( idx );
    }
 
+/*------------------------------------------------------------------------------
+ * FUNC   : th_get_data_file
+ *
+ * DESC   : Gets the data of one of the benchmark's data set files, an array
+ *          of 'elem_size' byte elements in the target's own layout.
+ *
+ *          The -in=<file> or -ref=<file> command line option, for the
+ *          TH_DATA_INPUT or TH_DATA_GOLDEN file, replaces the default name
+ *          'fn'.  See TH_DATA_FILES in thcfg.h.
+ *
+ *          This does not return if there is no such file, or its size is
+ *          not a whole number of elements.
+ *
+ * PARAMS : kind      - TH_DATA_INPUT or TH_DATA_GOLDEN
+ *          fn        - the default file name
+ *          elem_size - the size of an element
+ *          count     - gets the number of elements in the file
+ *
+ * RETURNS: A pointer to the file's data
+ * ---------------------------------------------------------------------------*/
+
+const void *th_get_data_file( int kind, const char *fn, size_t elem_size, size_t *count )
+
+   {
+   const FileDef *fd = (*thdef->thip_get_data_file) ( kind, fn );
+
+   if ( fd == NULL )
+      th_exit( THE_FAILURE, "Cannot find the data file for %s", fn );
+   if ( fd->size == 0 || fd->size % elem_size != 0 )
+      th_exit( THE_BAD_SIZE, "Data file %s is %ld bytes, not a multiple of %ld",
+         fd->name, (long)fd->size, (long)elem_size );
+
+   *count = fd->size / elem_size;
+   return fd->buf;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : th_kernel_select
+ *
+ * DESC   : Picks the variant of a kernel to run: the one forced by
+ *          -kernel= or the TH_KERNEL_ENV environment variable when the CPU
+ *          can run it, else the first the CPU can run.  The report lists
+ *          the variant picked.  See TH_KERNEL_ENV in thcfg.h.
+ *
+ * PARAMS : kernel   - the kernel's name, e.g. "fft"
+ *          variants - its variants, best first, the last needing no
+ *                     TH_CPU_ features
+ *          count    - the number of variants
+ *
+ * RETURNS: The index of the variant to run
+ * ---------------------------------------------------------------------------*/
+
+int th_kernel_select( const char *kernel, const THKernelVariant *variants, int count )
+
+   {
+   return (*thdef->thip_kernel_select)( kernel, variants, count );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : th_wall_seconds
+ *
+ * DESC   : Reads a monotonic wall clock.  The harness timer may count
+ *          process CPU time, which does not show scaling across threads.
+ *          See TH_THREADS in thcfg.h.
+ *
+ * RETURNS: The time in seconds from an arbitrary start
+ * ---------------------------------------------------------------------------*/
+
+double th_wall_seconds( void )
+
+   {
+   return (*thdef->thip_wall_seconds)();
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : th_pool_open
+ *
+ * DESC   : Starts a pool of 'threads' threads for th_pool_run(), the calling
+ *          thread and threads-1 workers.  See TH_THREADS in thcfg.h.
+ *
+ * RETURNS: The pool, or NULL if the workers cannot be started
+ * ---------------------------------------------------------------------------*/
+
+THPool *th_pool_open( int threads )
+
+   {
+   return (*thdef->thip_pool_open)( threads );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : th_pool_run
+ *
+ * DESC   : Runs run( arg, part ) for every part from 0 to threads-1 at once,
+ *          part 0 on the calling thread and the others on the workers, and
+ *          returns when all of them have.  The workers wait between runs,
+ *          so no thread is started inside it.
+ *
+ * PARAMS : pool - from th_pool_open()
+ *          run  - runs one part of the job
+ *          arg  - the job
+ * ---------------------------------------------------------------------------*/
+
+void th_pool_run( THPool *pool, THPartFunc run, void *arg )
+
+   {
+   (*thdef->thip_pool_run)( pool, run, arg );
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC   : th_pool_close
+ *
+ * DESC   : Stops the workers of a pool from th_pool_open() and frees it
+ * ---------------------------------------------------------------------------*/
+
+void th_pool_close( THPool *pool )
+
+   {
+   (*thdef->thip_pool_close)( pool );
+   }
+
 /*------------------------------------------------------------------------------
  * FUNC   : th_send_buf_as_file
  *
@@ -662,6 +1170,57 @@ int th_send_buf_as_file( const char* buf, BlockSize length, const char* fn )
    return (*thdef->thip_send_buf_as_file)( buf, length, fn );
    }
 
+/*------------------------------------------------------------------------------
+ * FUNC   : th_file_begin, th_file_write, th_file_printf, th_file_end
+ *
+ * DESC   : Send a file to the host a piece at a time, for output that is
+ *          formatted as it goes rather than into a buffer for
+ *          th_send_buf_as_file().  th_file_begin() starts file 'fn', each
+ *          th_file_write() or th_file_printf() sends the next part of it,
+ *          and th_file_end() finishes it.  Only one file at a time.
+ *
+ * NOTE   : th_file_printf() formats one piece at a time, of up to
+ *          FILE_PF_SIZE characters.
+ *
+ * RETRUNS: Success or Failure
+ *----------------------------------------------------------------------------*/
+
+#define FILE_PF_SIZE (128)
+
+int th_file_begin( const char *fn )
+
+   {
+   return (*thdef->thip_file_begin)( fn );
+   }
+
+int th_file_write( const char *buf, size_t length )
+
+   {
+   return (*thdef->thip_file_write)( buf, length );
+   }
+
+int th_file_printf( const char *fmt, ... )
+
+   {
+   char    buf[ FILE_PF_SIZE ];
+   int     len;
+   va_list args;
+
+   va_start( args, fmt );
+   len = vsprintf( buf, fmt, args );
+   va_end( args );
+
+   if (len < 0)
+      return Failure;
+   return (*thdef->thip_file_write)( buf, (size_t)len );
+   }
+
+int th_file_end( void )
+
+   {
+   return (*thdef->thip_file_end)();
+   }
+
 
 /*------------------------------------------------------------------------------
  * Malloc and Free Mapping
@@ -101,6 +101,8 @@ typedef struct THTestResults
    size_t            v3;
    size_t            v4;
    const char *info;
+   int               verify_snr;  /* TRUE if v1v2 is the S/N in dB of the
+                                   * output and v3v4 the least that passes */
    }
 THTestResults;
 
@@ -153,11 +155,18 @@ int    th_sends( const char *s );
 
 size_t th_read_con( char *buf, size_t buf_size );
 size_t th_con_chars_avail( void );
+int    th_flush_con( void );
 
 #define th_malloc( size ) th_malloc_x( size, __FILE__, __LINE__ )
 void *th_malloc_x( size_t size, const char *file, int line );
 #define th_free( blk ) th_free_x( blk, __FILE__, __LINE__ )
 void    th_free_x( void *blk, const char *file, int line );
+/* th_malloc_aligned gets 'align' byte aligned memory, a power of 2, that
+ * only th_free_aligned may free */
+#define th_malloc_aligned( size, align ) th_malloc_aligned_x( size, align, __FILE__, __LINE__ )
+void *th_malloc_aligned_x( size_t size, size_t align, const char *file, int line );
+#define th_free_aligned( blk ) th_free_aligned_x( blk, __FILE__, __LINE__ )
+void    th_free_aligned_x( void *blk, const char *file, int line );
 void    th_heap_reset( void );
 
 int    th_timer_available( void );
@@ -165,10 +174,39 @@ int    th_timer_is_intrusive( void );
 int    th_is_timer_running( void );
 size_t th_ticks_per_sec( void );
 size_t th_tick_granularity( void );
+size_t th_ticks( void );
 
 void   th_signal_start( void );
 size_t th_signal_finished( void );
 
+/* Latency histogram mode, see TH_LATENCY_BATCH in thcfg.h, and the cache
+ * evictions of TH_CACHE_COLD, both after every iteration */
+#define TH_LATENCY_POINTS (6) /* min, p50, p90, p99, p99.9, max */
+#if TH_LATENCY_BATCH
+void   th_latency_begin( size_t iterations );
+size_t th_latency_points( size_t *points );
+#else
+#define th_latency_begin( iterations ) ((void)(iterations))
+#define th_latency_points( points )     ((void)(points), (size_t)0)
+#endif
+#if TH_LATENCY_BATCH || TH_CACHE_COLD
+void   th_latency_mark( void );
+#else
+#define th_latency_mark()              ((void)0)
+#endif
+
+/* Stage profiling, see TH_PROFILE in thcfg.h. id is a constant from 0 to
+ * TH_PROF_STAGES-1, reported by its name less any PROF_ prefix */
+#if TH_PROFILE
+void   th_prof_begin( int id );
+void   th_prof_end( int id, const char *name );
+#define TH_PROF_BEGIN( id )            th_prof_begin( id )
+#define TH_PROF_END( id )              th_prof_end( id, #id )
+#else
+#define TH_PROF_BEGIN( id )            ((void)0)
+#define TH_PROF_END( id )              ((void)0)
+#endif
+
 void   th_exit( int exit_code, const char *fmt, ... );
 
 int    th_report_results( const THTestResults *results, e_u16 Expected_CRC );
@@ -181,13 +219,53 @@ int    th_harness_poll( void );
 const FileDef *th_get_file_def( const char *fn );
 const FileDef *th_get_file_num( int n );
 
+/* data set files, see TH_DATA_FILES in thcfg.h */
+#define TH_DATA_INPUT   (0)
+#define TH_DATA_GOLDEN  (1)
+#define TH_DATA_KINDS   (2)
+
+const void *th_get_data_file( int kind, const char *fn, size_t elem_size, size_t *count );
+
+/* kernel variants, see TH_KERNEL_ENV in thcfg.h.  A variant needs all its
+ * TH_CPU_ features; th_kernel_select() returns the index of the one to
+ * run, so list them best first and the scalar one, needing none, last */
+#define TH_CPU_SSE2     (0x01UL)
+#define TH_CPU_AVX2     (0x02UL)
+#define TH_CPU_AVX512   (0x04UL)
+#define TH_CPU_NEON     (0x08UL)
+
+typedef struct {
+   const char *name;      /* e.g. "sse2" */
+   e_u32       features;  /* TH_CPU_ features it needs */
+} THKernelVariant;
+
+int th_kernel_select( const char *kernel, const THKernelVariant *variants, int count );
+
+/* wall clock and worker threads, see TH_THREADS in thcfg.h.  th_pool_run()
+ * runs 'run' on parts 0 to threads-1 of a job at once, part 0 on the
+ * calling thread, and returns when all of them have */
+typedef void (*THPartFunc)( void *arg, int part );
+typedef struct THPool THPool;
+
+double  th_wall_seconds( void );
+THPool *th_pool_open( int threads );
+void    th_pool_run( THPool *pool, THPartFunc run, void *arg );
+void    th_pool_close( THPool *pool );
+
 int th_send_buf_as_file( const char* buf, BlockSize length, const char* fn );
+/* stream a file to the host a piece at a time, one file at a time */
+int th_file_begin( const char *fn );
+int th_file_write( const char *buf, size_t length );
+int th_file_printf( const char *fmt, ... );
+int th_file_end( void );
 
 /* CRC Utilities */
-#if CRC_CHECK || NON_INTRUSIVE_CRC_CHECK
+#if CRC_CHECK || NON_INTRUSIVE_CRC_CHECK || TH_FRAMED_FILES
 e_u16 Calc_crc8(e_u8 data, e_u16 crc );
 e_u16 Calc_crc16( e_u16 data, e_u16 crc );
 e_u16 Calc_crc32( e_u32 data, e_u16 crc );
+e_u16 Calc_crc_buf( const void *buf, size_t len, e_u16 crc );
+e_u16 Calc_crc_buf16( const e_u16 *buf, size_t n, e_u16 crc );
 #endif
 
 /*----------------------------------------------------------------------------*/
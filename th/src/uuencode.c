@@ -15,8 +15,10 @@
  */ 
 
 #include "uuencode.h" 
+#include "memmgr.h"	/* the file area, for fr_receive() */
 
 #include <stdio.h> 
+#include <string.h>	/* memcpy */
 
 /* 
  * commented out 2/15/00 because sys/stat.h is not ANSI std.  If you DO have this
@@ -49,84 +51,97 @@ const Char *trans_ptr = uu_std;
 /* ENC is the basic 1 character encoding function to make a char printing.  */
 #define ENC(Char) (trans_ptr[(Char) & 077])
 
-/*
- *	Gnu style uuencoding routine
- *  encodes buffer raw_buffer of size raw_buf_len
- *
- */ 
+/* Streaming state for uu_write(), the bytes of the line being built */
+#define UU_LINE		(45)
 
-n_void encode (const char *raw_buffer, n_int raw_buf_len)
+static Char		uu_line[ UU_LINE ];
+static n_int	uu_len = 0;
+
+/*
+ *	Encodes one line of n (0 to 45) bytes, as a count, 4 characters for
+ *	each 3 bytes with the last group padded with zeros, and a newline.
+ */
+static n_int uu_put_line (const Char *p, n_int n)
 {
-  register n_int	ch, n	= 0;
-  n_int			    buf_cnt = 0;
-  Char			    buf[80];
-  register Char     *p		= buf;
-  
+  Char	out[ 1 + UU_LINE/3*4 + 2 ];
+  Char	*q	= out;
+  Char	c1, c2, c3;
 
-  if(!raw_buf_len || raw_buf_len <0 || !raw_buffer){
-	  t_printf("Uuencode buffer parameters error.\n"); /* changed to t_printf() arw 2-14-00 */
-	  return;
-  } 
+  *q++ = ENC (n);
+  for (; n > 0; n -= 3, p += 3)
+	{
+		c1 = p[0];
+		c2 = (Char) (n > 1 ? p[1] : 0);
+		c3 = (Char) (n > 2 ? p[2] : 0);
+		*q++ = ENC (c1 >> 2);
+		*q++ = ENC (((c1 << 4) & 060) | ((c2 >> 4) & 017));
+		*q++ = ENC (((c2 << 2) & 074) | ((c3 >> 6) & 03));
+		*q++ = ENC (c3 & 077);
+	}
+  *q++ = '\n';
+  *q   = '\0';
 
-  trans_ptr = uu_std;	/* used by ENC macro */
+  return th_sends ((const char *)out) == -1 ? EOF : 0;
+}
 
-  while (1){
-	  for(n = 0; n<45;n++){
-		  if(n+buf_cnt >= raw_buf_len) break; 
-		  buf[n]	= raw_buffer[n+buf_cnt]; 
-	  }
-	  buf_cnt += 45; 
+/*
+ *	Adds raw_buf_len bytes to the encoding, sending each line as it fills
+ */
+n_int uu_write (const char *raw_buffer, n_int raw_buf_len)
+{
+  n_int	n;
 
-      if (n == 0)					break;
-	  if (th_putchar (ENC (n)) == EOF)	break;
+  while (raw_buf_len > 0)
+	{
+		n = UU_LINE - uu_len;
+		if (n > raw_buf_len)
+			n = raw_buf_len;
+		memcpy (uu_line + uu_len, raw_buffer, (size_t) n);
+		uu_len		+= n;
+		raw_buffer	+= n;
+		raw_buf_len	-= n;
 
-	  for (p = buf; n > 2; n -= 3, p += 3)
+		if (uu_len == UU_LINE)
 		{
-			ch = *p >> 2;
-			ch = ENC (ch);
-			if (th_putchar ((Char) ch) == EOF)	break;
-			ch = ((*p << 4) & 060) | ((p[1] >> 4) & 017);
-			ch = ENC (ch);
-			if (th_putchar ((Char) ch) == EOF)	break;
-			ch = ((p[1] << 2) & 074) | ((p[2] >> 6) & 03);
-			ch = ENC (ch);
-			if (th_putchar ((Char) ch) == EOF)	break;
-			ch = p[2] & 077;
-			ch = ENC (ch);
-			if (th_putchar ((Char) ch) == EOF)	break;
+			uu_len = 0;
+			if (uu_put_line (uu_line, UU_LINE) == EOF)
+				return EOF;
 		}
+	}
+  return 0;
+}
 
-		if (n != 0)						break;
-		if (th_putchar ('\n') == EOF)		break;
-    }
+/*
+ *	Sends the last, short, line and the zero length line that ends the data
+ */
+static n_int uu_flush (void)
+{
+  n_int	n = uu_len;
 
-    while (n != 0){
-		Char c1 = *p;
-		Char c2 = (Char) (n == 1 ?  0 :  p[1]);
+  uu_len = 0;
+  if (n != 0 && uu_put_line (uu_line, n) == EOF)
+	  return EOF;
+  return uu_put_line (uu_line, 0);
+}
 
-		ch = c1 >> 2;
-		ch = ENC (ch);
-		if (th_putchar ((Char) ch) == EOF)		break;
+/*
+ *	Gnu style uuencoding routine
+ *  encodes buffer raw_buffer of size raw_buf_len
+ *
+ */ 
 
-		ch = ((c1 << 4) & 060) | ((c2 >> 4) & 017);
-		ch = ENC (ch);
-		if (th_putchar ((Char) ch) == EOF)		break;
+n_void encode (const char *raw_buffer, n_int raw_buf_len)
+{
+  if(!raw_buf_len || raw_buf_len <0 || !raw_buffer){
+	  t_printf("Uuencode buffer parameters error.\n"); /* changed to t_printf() arw 2-14-00 */
+	  return;
+  } 
 
-		if (n == 1)
-			ch = ENC ('\0');
-		else{
-			ch = (c2 << 2) & 074;
-			ch = ENC (ch);
-		}
-		if (th_putchar ((Char) ch) == EOF)		break;
-		ch = ENC ('\0');
-		if (th_putchar ((Char) ch) == EOF)		break;
-		th_putchar ('\n');
-		break;
-    }
+  trans_ptr = uu_std;	/* used by ENC macro */
 
-	th_putchar (ENC ('\0'));
-	th_putchar ('\n');
+  uu_len = 0;
+  if (uu_write (raw_buffer, raw_buf_len) != EOF)
+	  uu_flush ();
 }
 
 /* Larin 
@@ -147,3 +162,410 @@ n_int uu_send_buf( const char* buf, n_int length, const char* fn  )
    return 0; /* Success; */ 
 }
 
+/*
+ * The same upload a piece at a time: uu_begin(), any number of uu_write()
+ * calls and uu_end().  Only one can be in progress.
+ */
+n_int uu_begin( const char* fn )
+{
+   Dword	mode;
+
+   mode = _S_IREAD | _S_IWRITE;
+   trans_ptr = uu_std;
+   uu_len = 0;
+   t_printf ("begin %lo %s\n",mode,fn);
+
+   return 0;
+}
+
+n_int uu_end( void )
+{
+   n_int	rv = uu_flush ();
+
+   t_printf ("end\n\n");
+   return rv;
+}
+
+
+#if TH_FRAMED_FILES
+/*
+ *	Framed binary transfer, see TH_FILE_FRAMED in thcfg.h
+ *
+ *	Every frame is
+ *		FR_SYNC, type, length (2 bytes), payload, crc (2 bytes)
+ *	with multi byte fields least significant byte first, and the crc from
+ *	Calc_crc_buf() over the type, length and payload.  The types are
+ *		'B'  begin: the file size (4 bytes, FR_UNKNOWN if streamed), name
+ *		'D'  data: the next bytes of the file
+ *		'Z'  data, LZ compressed: its size expanded (2 bytes), the code
+ *		'E'  end: the file size (4 bytes), the crc of the file (2 bytes)
+ *
+ *	The LZ code has a flag byte before each 8 items, least significant
+ *	bit first, 0 for a literal byte and 1 for a match.  A match is 2 bytes,
+ *	the distance back less 1 in the low 12 bits and the length less
+ *	LZ_MIN in the high 4.  Matches stay inside their frame, so every frame
+ *	expands on its own.
+ */
+
+#define FR_HEAD		(4)
+#define FR_MAX		(TH_FRAME_SIZE + FILE_NAME_SIZE)	/* largest payload */
+#define LZ_MIN		(3)
+#define LZ_MAX		(LZ_MIN + 15)
+#define LZ_HASH		(1024)
+
+static char		fr_buf[ TH_FRAME_SIZE ];	/* data waiting for a frame */
+static n_int	fr_len	= 0;
+static e_u32	fr_size	= 0;				/* bytes of the file so far */
+static e_u16	fr_crc	= 0;				/* and their crc */
+static char		fr_rx[ FR_MAX + 1 ];		/* the frame being received */
+#if TH_FRAME_LZ
+static char		lz_buf[ TH_FRAME_SIZE ];
+static e_s16	lz_hash[ LZ_HASH ];
+#endif
+
+static void fr_put16 (char *p, e_u32 v)
+{
+  p[0] = (char) (v & 0xFF);
+  p[1] = (char) ((v >> 8) & 0xFF);
+}
+
+static void fr_put32 (char *p, e_u32 v)
+{
+  fr_put16 (p, v & 0xFFFF);
+  fr_put16 (p + 2, (v >> 16) & 0xFFFF);
+}
+
+static e_u32 fr_get16 (const char *p)
+{
+  const e_u8	*b = (const e_u8 *)p;
+
+  return (e_u32) b[0] | ((e_u32) b[1] << 8);
+}
+
+static e_u32 fr_get32 (const char *p)
+{
+  return fr_get16 (p) | (fr_get16 (p + 2) << 16);
+}
+
+/*
+ *	Sends one frame, the payload straight from where it is
+ */
+static n_int fr_send (int type, const char *payload, n_int len)
+{
+  char	head[ FR_HEAD ];
+  char	tail[ 2 ];
+  e_u16	crc;
+
+  head[0] = (char) FR_SYNC;
+  head[1] = (char) type;
+  fr_put16 (head + 2, (e_u32) len);
+  crc = Calc_crc_buf (head + 1, FR_HEAD - 1, 0);
+  crc = Calc_crc_buf (payload, (size_t) len, crc);
+  fr_put16 (tail, crc);
+
+  if (th_putb (head, FR_HEAD) == -1 ||
+	  th_putb (payload, (size_t) len) == -1 ||
+	  th_putb (tail, 2) == -1)
+	  return EOF;
+  return 0;
+}
+
+/*
+ *	Expands LZ code, returns 0 if it gives exactly 'size' bytes
+ */
+static n_int lz_unpack (const char *code, n_int len, char *out, n_int size)
+{
+  const e_u8	*in = (const e_u8 *)code;
+  n_int			i = 0, o = 0, bit = 8, dist, n;
+  e_u8			flag = 0;
+
+  while (i < len)
+	{
+		if (bit == 8)
+		{
+			flag = in[i++];
+			bit = 0;
+			continue;
+		}
+		if (flag & (1 << bit))
+		{
+			if (i + 2 > len)
+				return EOF;
+			dist = (in[i] | ((in[i+1] & 0x0F) << 8)) + 1;
+			n = (in[i+1] >> 4) + LZ_MIN;
+			i += 2;
+			if (dist > o || o + n > size)
+				return EOF;
+			for (; n > 0; n--, o++)
+				out[o] = out[o - dist];
+		}
+		else
+		{
+			if (o >= size)
+				return EOF;
+			out[o++] = (char) in[i++];
+		}
+		bit++;
+	}
+  return o == size ? 0 : EOF;
+}
+
+#if TH_FRAME_LZ
+/*
+ *	LZ compresses len bytes into at most max, returns the size of the code
+ *	or 0 if it would not fit
+ */
+static n_int lz_pack (const char *data, n_int len, char *code, n_int max)
+{
+  const e_u8	*in		= (const e_u8 *)data;
+  e_u8			*out	= (e_u8 *)code;
+  n_int			i = 0, o = 0, flag = 0, bit = 8;
+  n_int			h, cand, n, best, dist = 0;
+
+  for (h = 0; h < LZ_HASH; h++)
+	  lz_hash[h] = -1;
+
+  while (i < len)
+	{
+		if (bit == 8)
+		{
+			if (o >= max)
+				return 0;
+			flag = o++;
+			out[flag] = 0;
+			bit = 0;
+		}
+
+		/* the last place the next 3 bytes were seen */
+		best = 0;
+		if (i + LZ_MIN <= len)
+		{
+			h = ((in[i] << 6) ^ (in[i+1] << 3) ^ in[i+2]) & (LZ_HASH - 1);
+			cand = lz_hash[h];
+			lz_hash[h] = (e_s16) i;
+			if (cand >= 0)
+			{
+				for (n = 0; n < LZ_MAX && i + n < len; n++)
+					if (in[cand + n] != in[i + n])
+						break;
+				if (n >= LZ_MIN)
+				{
+					best = n;
+					dist = i - cand;
+				}
+			}
+		}
+
+		if (best)
+		{
+			if (o + 2 > max)
+				return 0;
+			out[flag] |= (e_u8) (1 << bit);
+			out[o++] = (e_u8) ((dist - 1) & 0xFF);
+			out[o++] = (e_u8) (((dist - 1) >> 8) | ((best - LZ_MIN) << 4));
+			i += best;
+		}
+		else
+		{
+			if (o >= max)
+				return 0;
+			out[o++] = in[i++];
+		}
+		bit++;
+	}
+  return o;
+}
+#endif
+
+/*
+ *	Sends len bytes of file data, compressed if that makes them smaller
+ */
+static n_int fr_data (const char *buf, n_int len)
+{
+#if TH_FRAME_LZ
+  n_int	n = lz_pack (buf, len, lz_buf + 2, len - 3);
+
+  if (n > 0)
+	{
+		fr_put16 (lz_buf, (e_u32) len);
+		return fr_send ('Z', lz_buf, n + 2);
+	}
+#endif
+  return fr_send ('D', buf, len);
+}
+
+/*
+ *	Sending a file is fr_begin(), any number of fr_write() calls and
+ *	fr_end().  Only one can be in progress.
+ */
+n_int fr_begin (const char *fn, e_u32 size)
+{
+  char		head[ 4 + FILE_NAME_SIZE ];
+  size_t	n = strlen (fn);
+
+  if (n > FILE_NAME_SIZE - 1)
+	  n = FILE_NAME_SIZE - 1;
+  fr_put32 (head, size);
+  memcpy (head + 4, fn, n);
+
+  fr_len	= 0;
+  fr_size	= 0;
+  fr_crc	= 0;
+  return fr_send ('B', head, (n_int) (4 + n));
+}
+
+n_int fr_write (const char *buf, n_int len)
+{
+  n_int	n;
+
+  fr_crc	= Calc_crc_buf (buf, (size_t) len, fr_crc);
+  fr_size	+= (e_u32) len;
+
+  while (len > 0)
+	{
+		/* whole frames go straight from the caller's buffer */
+		if (fr_len == 0 && len >= TH_FRAME_SIZE)
+		{
+			if (fr_data (buf, TH_FRAME_SIZE) == EOF)
+				return EOF;
+			buf	+= TH_FRAME_SIZE;
+			len	-= TH_FRAME_SIZE;
+			continue;
+		}
+
+		n = TH_FRAME_SIZE - fr_len;
+		if (n > len)
+			n = len;
+		memcpy (fr_buf + fr_len, buf, (size_t) n);
+		fr_len	+= n;
+		buf		+= n;
+		len		-= n;
+
+		if (fr_len == TH_FRAME_SIZE)
+		{
+			fr_len = 0;
+			if (fr_data (fr_buf, TH_FRAME_SIZE) == EOF)
+				return EOF;
+		}
+	}
+  return 0;
+}
+
+n_int fr_end (void)
+{
+  char	tail[ 6 ];
+  n_int	n = fr_len;
+
+  fr_len = 0;
+  if (n > 0 && fr_data (fr_buf, n) == EOF)
+	  return EOF;
+
+  fr_put32 (tail, fr_size);
+  fr_put16 (tail + 4, fr_crc);
+  return fr_send ('E', tail, 6);
+}
+
+/*
+ *	Reads exactly len bytes from the console
+ */
+static void fr_read (char *buf, n_int len)
+{
+  size_t	n;
+
+  while (len > 0)
+	{
+		n = th_read_con (buf, (size_t) len);
+		buf	+= n;
+		len	-= (n_int) n;
+	}
+}
+
+/*
+ *	Receives the next frame into fr_rx, skipping anything before its
+ *	FR_SYNC.  Returns its type, or EOF if it is too long or its crc is wrong.
+ */
+static n_int fr_recv (n_int *len)
+{
+  char	head[ FR_HEAD ];
+  char	tail[ 2 ];
+  e_u16	crc;
+
+  do
+	  fr_read (head, 1);
+  while ((e_u8) head[0] != FR_SYNC);
+  fr_read (head + 1, FR_HEAD - 1);
+
+  *len = (n_int) fr_get16 (head + 2);
+  if (*len > FR_MAX)
+	  return EOF;
+  fr_read (fr_rx, *len);
+  fr_read (tail, 2);
+
+  crc = Calc_crc_buf (head + 1, FR_HEAD - 1, 0);
+  crc = Calc_crc_buf (fr_rx, (size_t) *len, crc);
+  if (crc != fr_get16 (tail))
+	  return EOF;
+  return (e_u8) head[1];
+}
+
+/*
+ *	Receives one file, sent as fr_begin() ... fr_end() with its size
+ *	known, into the file area.  Returns its FileDef, or NULL if it did not
+ *	fit or any frame was bad.
+ */
+FileDef *fr_receive (void)
+{
+  FileDef	*fd;
+  n_int		len, n;
+  e_u32		size, got = 0;
+  e_u16		crc = 0;
+
+  if (fr_recv (&len) != 'B' || len < 4 || len > 4 + FILE_NAME_SIZE - 1)
+	  return NULL;
+  size = fr_get32 (fr_rx);
+  fr_rx[ len ] = '\0';
+  if (size == FR_UNKNOWN ||
+	  (fd = mem_alloc_file_space (fr_rx + 4, (BlockSize) size)) == NULL)
+	  return NULL;
+
+  for (;;)
+	{
+		switch (fr_recv (&len))
+		{
+		case 'E':
+			if (len == 6 && got == size && fr_get32 (fr_rx) == size &&
+				fr_get16 (fr_rx + 4) == crc)
+			{
+				fd->crc = crc;
+				return fd;
+			}
+			break;
+
+		case 'D':
+			n = len;
+			if (got + (e_u32) n > size)
+				break;
+			memcpy (fd->buf + got, fr_rx, (size_t) n);
+			crc = Calc_crc_buf (fd->buf + got, (size_t) n, crc);
+			got += (e_u32) n;
+			continue;
+
+		case 'Z':
+			n = len >= 2 ? (n_int) fr_get16 (fr_rx) : 0;
+			if (n == 0 || got + (e_u32) n > size ||
+				lz_unpack (fr_rx + 2, len - 2, fd->buf + got, n) == EOF)
+				break;
+			crc = Calc_crc_buf (fd->buf + got, (size_t) n, crc);
+			got += (e_u32) n;
+			continue;
+
+		default:
+			break;
+		}
+		break;
+	}
+
+  mem_delete_newest_file ();
+  return NULL;
+}
+#endif /* TH_FRAMED_FILES */
@@ -16,5 +16,18 @@
 int uu_send_buf( const char*, int, const char*  );
 int t_printf( const char *, ... );
 n_void encode (const char *raw_buffer, n_int raw_buf_len);
+n_int uu_begin( const char* fn );
+n_int uu_write( const char *raw_buffer, n_int raw_buf_len );
+n_int uu_end( void );
+
+#if TH_FRAMED_FILES
+#define FR_SYNC    (0x7E)         /* starts every frame */
+#define FR_UNKNOWN (0xFFFFFFFFUL) /* the size of a streamed file */
+
+n_int    fr_begin( const char *fn, e_u32 size );
+n_int    fr_write( const char *buf, n_int len );
+n_int    fr_end( void );
+FileDef *fr_receive( void );
+#endif
 
 #endif
@@ -0,0 +1,303 @@
+/**
+ *
+ * Copyright (C) EEMBC(R) All Rights Reserved
+ *
+ * This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+ * Please refer to the license file (LICENSE.md) included with this code.
+ *
+ */
+
+/*------------------------------------------------------------------------------
+ * Fixed-point primitives on the e_s16 and e_s32 types of eembc_dt.h: Q15
+ * saturating add and subtract, rounding multiply, multiply-accumulate into
+ * 32 bits and complex multiply. Each has a scalar reference, ee_q15_*, and
+ * the vector forms give the same result in every lane:
+ *
+ *   ee_q15x8_*   8 lanes in __m128i with SSE2, or int16x8_t with NEON,
+ *                defined when EE_Q15X8 is
+ *   ee_q15x16_*  16 lanes in __m256i with AVX2, defined when EE_Q15X16 is
+ *
+ * The 32-bit accumulators of the multiply-accumulate wrap, as pmaddwd and
+ * vmlal_s16 do, so only their sum is defined: the sum of the lanes of
+ * ee_q31x4 (or ee_q31x8) equals the scalar accumulator modulo 2^32. Bits
+ * 16 to 31 of a sum, the usual output, do not depend on the order.
+ *
+ * The header is not pulled in by thlib.h; include it after thlib.h in the
+ * files that use it, so that only they see the intrinsics headers. The
+ * vector forms follow what the compiler targets, so a kernel that picks
+ * them at run time still checks the CPU with th_kernel_select.
+ *----------------------------------------------------------------------------*/
+
+#ifndef EEMBC_FXP_H
+#define EEMBC_FXP_H
+
+#include "eembc_dt.h"
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+#elif defined( __ARM_NEON )
+#include <arm_neon.h>
+#endif
+
+/* inline as each compiler spells it in C89, none where it cannot */
+#if defined( __GNUC__ )
+#define EE_INLINE       __inline__
+#elif defined( _MSC_VER )
+#define EE_INLINE       __inline
+#else
+#define EE_INLINE
+#endif
+
+#define EE_Q15_MAX      ((e_s32)32767)
+#define EE_Q15_MIN      ((e_s32)-32768)
+#define EE_Q15_ROUND    ((e_s32)0x4000)     /* half of the dropped 15 bits */
+
+/*------------------------------------------------------------------------------
+ * Scalar reference
+ *----------------------------------------------------------------------------*/
+
+/* x clamped to the e_s16 range */
+static EE_INLINE e_s16 ee_q15_sat( e_s32 x )
+{
+    return (e_s16)( x > EE_Q15_MAX ? EE_Q15_MAX : x < EE_Q15_MIN ? EE_Q15_MIN : x );
+}
+
+static EE_INLINE e_s16 ee_q15_adds( e_s16 a, e_s16 b )
+{
+    return ee_q15_sat( (e_s32)a + b );
+}
+
+static EE_INLINE e_s16 ee_q15_subs( e_s16 a, e_s16 b )
+{
+    return ee_q15_sat( (e_s32)a - b );
+}
+
+/* a*b in Q15, rounded half up; only -1 * -1 saturates */
+static EE_INLINE e_s16 ee_q15_mulr( e_s16 a, e_s16 b )
+{
+    return ee_q15_sat( ( (e_s32)a * b + EE_Q15_ROUND ) >> 15 );
+}
+
+/*
+ * acc + a*b, the full product, wrapping at 32 bits as the vector lanes do
+ * also where e_s32 is wider
+ */
+static EE_INLINE e_s32 ee_q15_mac( e_s32 acc, e_s16 a, e_s16 b )
+{
+    e_u32 u = ( (e_u32)acc + (e_u32)( (e_s32)a * b ) ) & 0xffffffffUL;
+
+    return ( u & 0x80000000UL ) ? -(e_s32)( 0xffffffffUL - u ) - 1 : (e_s32)u;
+}
+
+/*
+ * (ar + j ai) * (br + j bi) in Q15: each product is rounded with
+ * ee_q15_mulr, then combined with ee_q15_subs and ee_q15_adds.
+ */
+static EE_INLINE void ee_q15_cmul( e_s16 ar, e_s16 ai, e_s16 br, e_s16 bi,
+                                   e_s16 *re, e_s16 *im )
+{
+    *re = ee_q15_subs( ee_q15_mulr( ar, br ), ee_q15_mulr( ai, bi ) );
+    *im = ee_q15_adds( ee_q15_mulr( ar, bi ), ee_q15_mulr( ai, br ) );
+}
+
+/*------------------------------------------------------------------------------
+ * 8 lanes: SSE2 or NEON
+ *----------------------------------------------------------------------------*/
+
+#if defined( __SSE2__ )
+
+#define EE_Q15X8        1
+
+typedef __m128i ee_q15x8;               /* 8 e_s16 */
+typedef __m128i ee_q31x4;               /* 4 e_s32 accumulators */
+
+static EE_INLINE ee_q15x8 ee_q15x8_load( const e_s16 *p )
+{
+    return _mm_loadu_si128( (const __m128i *)p );
+}
+
+static EE_INLINE void ee_q15x8_store( e_s16 *p, ee_q15x8 a )
+{
+    _mm_storeu_si128( (__m128i *)p, a );
+}
+
+static EE_INLINE ee_q15x8 ee_q15x8_adds( ee_q15x8 a, ee_q15x8 b )
+{
+    return _mm_adds_epi16( a, b );
+}
+
+static EE_INLINE ee_q15x8 ee_q15x8_subs( ee_q15x8 a, ee_q15x8 b )
+{
+    return _mm_subs_epi16( a, b );
+}
+
+/*
+ * The full products from their low and high halves; pmulhrsw would do
+ * without them but needs SSSE3 and gives -1 for -1 * -1.
+ */
+static EE_INLINE ee_q15x8 ee_q15x8_mulr( ee_q15x8 a, ee_q15x8 b )
+{
+    __m128i lo = _mm_mullo_epi16( a, b );
+    __m128i hi = _mm_mulhi_epi16( a, b );
+    __m128i r  = _mm_set1_epi32( EE_Q15_ROUND );
+
+    return _mm_packs_epi32(
+        _mm_srai_epi32( _mm_add_epi32( _mm_unpacklo_epi16( lo, hi ), r ), 15 ),
+        _mm_srai_epi32( _mm_add_epi32( _mm_unpackhi_epi16( lo, hi ), r ), 15 ) );
+}
+
+static EE_INLINE ee_q31x4 ee_q31x4_zero( void )
+{
+    return _mm_setzero_si128();
+}
+
+static EE_INLINE ee_q31x4 ee_q15x8_mac( ee_q31x4 acc, ee_q15x8 a, ee_q15x8 b )
+{
+    return _mm_add_epi32( acc, _mm_madd_epi16( a, b ) );
+}
+
+static EE_INLINE e_s32 ee_q31x4_sum( ee_q31x4 acc )
+{
+    acc = _mm_add_epi32( acc, _mm_shuffle_epi32( acc, 0x4e ) );
+    acc = _mm_add_epi32( acc, _mm_shuffle_epi32( acc, 0xb1 ) );
+    return _mm_cvtsi128_si32( acc );
+}
+
+#elif defined( __ARM_NEON )
+
+#define EE_Q15X8        1
+
+typedef int16x8_t ee_q15x8;
+typedef int32x4_t ee_q31x4;
+
+static EE_INLINE ee_q15x8 ee_q15x8_load( const e_s16 *p )
+{
+    return vld1q_s16( p );
+}
+
+static EE_INLINE void ee_q15x8_store( e_s16 *p, ee_q15x8 a )
+{
+    vst1q_s16( p, a );
+}
+
+static EE_INLINE ee_q15x8 ee_q15x8_adds( ee_q15x8 a, ee_q15x8 b )
+{
+    return vqaddq_s16( a, b );
+}
+
+static EE_INLINE ee_q15x8 ee_q15x8_subs( ee_q15x8 a, ee_q15x8 b )
+{
+    return vqsubq_s16( a, b );
+}
+
+/* sat((2ab + 2^15) >> 16) is sat((ab + 2^14) >> 15) */
+static EE_INLINE ee_q15x8 ee_q15x8_mulr( ee_q15x8 a, ee_q15x8 b )
+{
+    return vqrdmulhq_s16( a, b );
+}
+
+static EE_INLINE ee_q31x4 ee_q31x4_zero( void )
+{
+    return vdupq_n_s32( 0 );
+}
+
+static EE_INLINE ee_q31x4 ee_q15x8_mac( ee_q31x4 acc, ee_q15x8 a, ee_q15x8 b )
+{
+    acc = vmlal_s16( acc, vget_low_s16( a ), vget_low_s16( b ) );
+    return vmlal_s16( acc, vget_high_s16( a ), vget_high_s16( b ) );
+}
+
+static EE_INLINE e_s32 ee_q31x4_sum( ee_q31x4 acc )
+{
+    int32x2_t s = vadd_s32( vget_low_s32( acc ), vget_high_s32( acc ) );
+
+    return vget_lane_s32( vpadd_s32( s, s ), 0 );
+}
+
+#endif
+
+#if defined( EE_Q15X8 )
+/* As ee_q15_cmul, on 8 separate real and imaginary lanes */
+static EE_INLINE void ee_q15x8_cmul( ee_q15x8 ar, ee_q15x8 ai, ee_q15x8 br, ee_q15x8 bi,
+                                     ee_q15x8 *re, ee_q15x8 *im )
+{
+    *re = ee_q15x8_subs( ee_q15x8_mulr( ar, br ), ee_q15x8_mulr( ai, bi ) );
+    *im = ee_q15x8_adds( ee_q15x8_mulr( ar, bi ), ee_q15x8_mulr( ai, br ) );
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * 16 lanes: AVX2
+ *----------------------------------------------------------------------------*/
+
+#if defined( __AVX2__ )
+
+#define EE_Q15X16       1
+
+typedef __m256i ee_q15x16;
+typedef __m256i ee_q31x8;
+
+static EE_INLINE ee_q15x16 ee_q15x16_load( const e_s16 *p )
+{
+    return _mm256_loadu_si256( (const __m256i *)p );
+}
+
+static EE_INLINE void ee_q15x16_store( e_s16 *p, ee_q15x16 a )
+{
+    _mm256_storeu_si256( (__m256i *)p, a );
+}
+
+static EE_INLINE ee_q15x16 ee_q15x16_adds( ee_q15x16 a, ee_q15x16 b )
+{
+    return _mm256_adds_epi16( a, b );
+}
+
+static EE_INLINE ee_q15x16 ee_q15x16_subs( ee_q15x16 a, ee_q15x16 b )
+{
+    return _mm256_subs_epi16( a, b );
+}
+
+/* As ee_q15x8_mulr; the unpacks and the pack both keep to 128-bit halves */
+static EE_INLINE ee_q15x16 ee_q15x16_mulr( ee_q15x16 a, ee_q15x16 b )
+{
+    __m256i lo = _mm256_mullo_epi16( a, b );
+    __m256i hi = _mm256_mulhi_epi16( a, b );
+    __m256i r  = _mm256_set1_epi32( EE_Q15_ROUND );
+
+    return _mm256_packs_epi32(
+        _mm256_srai_epi32( _mm256_add_epi32( _mm256_unpacklo_epi16( lo, hi ), r ), 15 ),
+        _mm256_srai_epi32( _mm256_add_epi32( _mm256_unpackhi_epi16( lo, hi ), r ), 15 ) );
+}
+
+static EE_INLINE ee_q31x8 ee_q31x8_zero( void )
+{
+    return _mm256_setzero_si256();
+}
+
+static EE_INLINE ee_q31x8 ee_q15x16_mac( ee_q31x8 acc, ee_q15x16 a, ee_q15x16 b )
+{
+    return _mm256_add_epi32( acc, _mm256_madd_epi16( a, b ) );
+}
+
+static EE_INLINE e_s32 ee_q31x8_sum( ee_q31x8 acc )
+{
+    __m128i s = _mm_add_epi32( _mm256_castsi256_si128( acc ),
+                               _mm256_extracti128_si256( acc, 1 ) );
+
+    s = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0x4e ) );
+    s = _mm_add_epi32( s, _mm_shuffle_epi32( s, 0xb1 ) );
+    return _mm_cvtsi128_si32( s );
+}
+
+static EE_INLINE void ee_q15x16_cmul( ee_q15x16 ar, ee_q15x16 ai, ee_q15x16 br, ee_q15x16 bi,
+                                      ee_q15x16 *re, ee_q15x16 *im )
+{
+    *re = ee_q15x16_subs( ee_q15x16_mulr( ar, br ), ee_q15x16_mulr( ai, bi ) );
+    *im = ee_q15x16_adds( ee_q15x16_mulr( ar, bi ), ee_q15x16_mulr( ai, br ) );
+}
+
+#endif /* __AVX2__ */
+
+#endif /* EEMBC_FXP_H */
@@ -7,6 +7,15 @@
  *
  */
 
+/* clock_gettime() needs the POSIX declarations under -ansi, and the
+ * copies mode needs the GNU ones for sched_setaffinity() */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include <stdlib.h>
 #include <setjmp.h>
 #include <stdarg.h>
@@ -14,6 +23,25 @@
 #include <time.h>
 #include <string.h> /* strlen */
 
+#if defined(__unix__) || defined(__APPLE__)
+#define AL_COPIES (TRUE)
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#else
+#define AL_COPIES (FALSE)
+#endif
+
 #include "eembc_dt.h"
 #include "thcfg.h"
 #include "thal.h"
@@ -63,6 +91,7 @@ THDef the_thdef =
 
    i_ticks_per_sec,
    i_tick_granularity,
+   i_ticks,
    i_malloc,
    i_free,
    i_heap_reset,
@@ -76,7 +105,24 @@ THDef the_thdef =
    i_get_file_def,
    i_get_file_num,
 
-   i_send_buf_as_file
+   i_send_buf_as_file,
+
+   i_flush_con,
+
+   i_file_begin,
+   i_file_write,
+   i_file_end,
+
+   i_get_data_file,
+
+   i_evict_caches,
+
+   i_kernel_select,
+
+   i_wall_seconds,
+   i_pool_open,
+   i_pool_run,
+   i_pool_close
 
    };
 
@@ -102,8 +148,56 @@ BlockSize mem_size = 0;
 
 static jmp_buf exit_point;
 
+#if TARGET_TIMER_SOURCE == TARGET_TIMER_CLOCK
 static clock_t start_time;
 static clock_t stop_time;
+#else
+static size_t start_time;
+static size_t stop_time;
+#endif
+
+#if AL_COPIES
+/* al_wall_seconds() at the last al_signal_start() and al_signal_finished(),
+ * for the wall-clock span of al_run_copies() */
+static double wall_start = 0.0;
+static double wall_stop  = 0.0;
+#endif
+
+#if TARGET_TIMER_SOURCE == TARGET_TIMER_TSC && defined(__GNUC__) && defined(__x86_64__)
+#define AL_TIMER_TSC (TRUE)
+static int    tsc_calibrated = 0;
+static size_t tsc_per_sec    = 0;     /* 0 when the TSC is not invariant */
+#else
+#define AL_TIMER_TSC (FALSE)
+#endif
+
+#if TARGET_PERF_COUNTERS && defined(__linux__) && defined(__NR_perf_event_open)
+#define AL_PERF (TRUE)
+/* In AL_PERF_* order, see thal.h.  The cache events count read misses. */
+static const struct {
+	unsigned		type;
+	unsigned long	config;
+} perf_events[ AL_PERF_COUNTERS ] = {
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+	{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+		( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ) },
+	{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL |
+		( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ) }
+};
+static int    perf_opened = 0;
+static int    perf_fd[ AL_PERF_COUNTERS ];   /* -1 where not available */
+static size_t perf_counts[ AL_PERF_COUNTERS ];
+#else
+#define AL_PERF (FALSE)
+#endif
+
+#if TARGET_ENERGY
+static int    energy_ok    = 0;       /* the last timed region was measured */
+static size_t energy_start = 0;
+static size_t energy_uj    = 0;
+#endif
 
 /*------------------------------------------------------------------------------
  * Platform Specific Header Files, Defines, Globals and Local Data
@@ -113,6 +207,307 @@ static clock_t stop_time;
 >> Put your platform specific stuff here
 */
 
+/* Asynchronous output, see TH_ASYNC_OUTPUT in thcfg.h.  'outq' is a ring
+ * of TH_OUTQ_SIZE bytes, the 'outq_len' from 'outq_head' waiting for the
+ * link.  In the thread drain 'outq_lock' guards them, and the thread sends
+ * its chunk without the lock while 'outq_sending' is set.
+*/
+#if TH_ASYNC_OUTPUT != TH_ASYNC_NONE && AL_COPIES
+#define AL_OUTQ (TRUE)
+#include <errno.h>
+#if TH_ASYNC_OUTPUT == TH_ASYNC_THREAD
+#include <pthread.h>
+#else
+#include <poll.h>
+#endif
+
+static char   *outq        = NULL;
+static size_t  outq_head   = 0;
+static size_t  outq_len    = 0;
+static int     outq_on     = 0;       /* al_write_con() queues */
+static int     outq_timing = 0;       /* inside a timed region */
+
+#if TH_ASYNC_OUTPUT == TH_ASYNC_THREAD
+static pthread_t       outq_thread;
+static pthread_mutex_t outq_lock    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  outq_cond    = PTHREAD_COND_INITIALIZER;
+static int             outq_sending = 0;
+static int             outq_stop    = 0;
+
+#define OUTQ_LOCK()     pthread_mutex_lock( &outq_lock )
+#define OUTQ_UNLOCK()   pthread_mutex_unlock( &outq_lock )
+#define OUTQ_WAKE()     pthread_cond_broadcast( &outq_cond )
+#else
+#define OUTQ_LOCK()
+#define OUTQ_UNLOCK()
+#define OUTQ_WAKE()
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : outq_send
+ *
+ * DESC   : Sends 'n' bytes to the link, waiting for it to take them all
+ * ---------------------------------------------------------------------------*/
+
+static void outq_send( const char *buf, size_t n )
+{
+	ssize_t	w;
+
+	while (n > 0) {
+		w = write( STDOUT_FILENO, buf, n );
+		if (w < 0 && errno == EINTR)
+			continue;
+		if (w <= 0)
+			return;			/* the link is gone, as fwrite() would find */
+		buf	+= w;
+		n	-= (size_t)w;
+	}
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : outq_chunk, outq_pop
+ *
+ * DESC   : outq_chunk() is the size of the next chunk to send: the bytes
+ *          from the head up to the end of the ring, at most TH_OUTQ_CHUNK.
+ *          outq_pop() drops the 'n' bytes sent from the head.
+ * ---------------------------------------------------------------------------*/
+
+static size_t outq_chunk( void )
+{
+	size_t	n = TH_OUTQ_SIZE - outq_head;
+
+	if (n > outq_len)
+		n = outq_len;
+	return n > TH_OUTQ_CHUNK ? TH_OUTQ_CHUNK : n;
+}
+
+static void outq_pop( size_t n )
+{
+	outq_head	= ( outq_head + n ) % TH_OUTQ_SIZE;
+	outq_len	-= n;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : outq_flush
+ *
+ * DESC   : Sends the whole queue from the caller, once the drain thread
+ *          has sent its chunk.  Call with the lock held.
+ * ---------------------------------------------------------------------------*/
+
+static void outq_flush( void )
+{
+	size_t	n;
+
+#if TH_ASYNC_OUTPUT == TH_ASYNC_THREAD
+	while (outq_sending)
+		pthread_cond_wait( &outq_cond, &outq_lock );
+#endif
+	while (outq_len > 0) {
+		n = outq_chunk();
+		outq_send( outq + outq_head, n );
+		outq_pop( n );
+	}
+	OUTQ_WAKE();
+}
+
+#if TH_ASYNC_OUTPUT == TH_ASYNC_THREAD
+/*------------------------------------------------------------------------------
+ * FUNC   : outq_main
+ *
+ * DESC   : The drain thread: sends the queue a chunk at a time while the
+ *          timer is stopped, until al_lc_close()
+ * ---------------------------------------------------------------------------*/
+
+static void *outq_main( void *arg )
+{
+	size_t	n;
+
+	arg = arg;
+	OUTQ_LOCK();
+	for (;;) {
+		while (!outq_stop && ( outq_len == 0 || outq_timing ))
+			pthread_cond_wait( &outq_cond, &outq_lock );
+		if (outq_stop)
+			break;
+
+		n				= outq_chunk();
+		outq_sending	= 1;
+		OUTQ_UNLOCK();
+		outq_send( outq + outq_head, n );
+		OUTQ_LOCK();
+		outq_pop( n );
+		outq_sending	= 0;
+		OUTQ_WAKE();
+	}
+	OUTQ_UNLOCK();
+	return NULL;
+}
+#else
+/*------------------------------------------------------------------------------
+ * FUNC   : outq_pump
+ *
+ * DESC   : The idle drain: sends chunks outside the timed regions for as
+ *          long as the link takes them without waiting.
+ *
+ * PORTING: Targets with a UART send what its transmit FIFO has room for.
+ * ---------------------------------------------------------------------------*/
+
+static void outq_pump( void )
+{
+	struct pollfd	p;
+	size_t			n;
+
+	while (outq_len > 0 && !outq_timing) {
+		p.fd		= STDOUT_FILENO;
+		p.events	= POLLOUT;
+		p.revents	= 0;
+		if (poll( &p, 1, 0 ) != 1 || !( p.revents & POLLOUT ))
+			return;
+		n = outq_chunk();
+		outq_send( outq + outq_head, n );
+		outq_pop( n );
+	}
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : outq_put
+ *
+ * DESC   : Adds 'n' bytes to the queue.  When it is full the drain thread
+ *          makes room, or, in a timed region or without the thread, the
+ *          caller sends it.
+ * ---------------------------------------------------------------------------*/
+
+static void outq_put( const char *buf, size_t n )
+{
+	size_t	tail;
+	size_t	k;
+
+	OUTQ_LOCK();
+	while (n > 0) {
+		if (outq_len == TH_OUTQ_SIZE) {
+#if TH_ASYNC_OUTPUT == TH_ASYNC_THREAD
+			if (!outq_timing) {
+				pthread_cond_wait( &outq_cond, &outq_lock );
+				continue;
+			}
+#endif
+			outq_flush();
+		}
+		tail	= ( outq_head + outq_len ) % TH_OUTQ_SIZE;
+		k		= tail >= outq_head ? TH_OUTQ_SIZE - tail : outq_head - tail;
+		if (k > n)
+			k = n;
+		memcpy( outq + tail, buf, k );
+		outq_len	+= k;
+		buf			+= k;
+		n			-= k;
+	}
+	OUTQ_WAKE();
+	OUTQ_UNLOCK();
+
+#if TH_ASYNC_OUTPUT == TH_ASYNC_IDLE
+	outq_pump();
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : outq_drain
+ *
+ * DESC   : Empties the queue, waiting for the link
+ * ---------------------------------------------------------------------------*/
+
+static void outq_drain( void )
+{
+	if (!outq_on)
+		return;
+	OUTQ_LOCK();
+	outq_flush();
+	OUTQ_UNLOCK();
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : outq_pause, outq_resume
+ *
+ * DESC   : Hold the queue over a timed region.  outq_pause() returns once
+ *          the drain thread has sent its chunk.
+ * ---------------------------------------------------------------------------*/
+
+static void outq_pause( void )
+{
+	if (!outq_on)
+		return;
+#if TH_ASYNC_OUTPUT == TH_ASYNC_IDLE
+	outq_pump();
+#endif
+	OUTQ_LOCK();
+	outq_timing = 1;
+#if TH_ASYNC_OUTPUT == TH_ASYNC_THREAD
+	while (outq_sending)
+		pthread_cond_wait( &outq_cond, &outq_lock );
+#endif
+	OUTQ_UNLOCK();
+}
+
+static void outq_resume( void )
+{
+	if (!outq_on)
+		return;
+	OUTQ_LOCK();
+	outq_timing = 0;
+	OUTQ_WAKE();
+	OUTQ_UNLOCK();
+#if TH_ASYNC_OUTPUT == TH_ASYNC_IDLE
+	outq_pump();
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : outq_open, outq_close
+ *
+ * DESC   : Start and stop queueing.  Without the memory or the thread the
+ *          output goes straight to the link.  outq_close() empties the
+ *          queue, and also runs at exit() for exits that skip
+ *          al_lc_close().
+ * ---------------------------------------------------------------------------*/
+
+static void outq_close( void )
+{
+	if (!outq_on)
+		return;
+	outq_drain();
+	outq_on = 0;
+#if TH_ASYNC_OUTPUT == TH_ASYNC_THREAD
+	OUTQ_LOCK();
+	outq_stop = 1;
+	OUTQ_WAKE();
+	OUTQ_UNLOCK();
+	pthread_join( outq_thread, NULL );
+#endif
+	free( outq );
+	outq = NULL;
+}
+
+static void outq_open( void )
+{
+	if (outq_on || ( outq = (char *)malloc( TH_OUTQ_SIZE ) ) == NULL)
+		return;
+	fflush( stdout );		/* what stdio holds goes first */
+#if TH_ASYNC_OUTPUT == TH_ASYNC_THREAD
+	outq_stop = 0;
+	if (pthread_create( &outq_thread, NULL, outq_main, NULL ) != 0) {
+		free( outq );
+		outq = NULL;
+		return;
+	}
+#endif
+	outq_on = 1;
+	atexit( outq_close );
+}
+#else
+#define AL_OUTQ (FALSE)
+#endif
+
 /*------------------------------------------------------------------------------
  *                       >>> LOGICAL CONSOLE I/O <<<
  * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -142,6 +537,9 @@ static clock_t stop_time;
 int al_lc_open( void )
 
    {
+#if AL_OUTQ
+   outq_open();
+#endif
    return Success;
    }
 
@@ -164,6 +562,9 @@ int al_lc_open( void )
 void al_lc_close( void )
 
    {
+#if AL_OUTQ
+   outq_close();
+#endif
    }
 
 /*------------------------------------------------------------------------------
@@ -190,6 +591,14 @@ int al_write_con( const char* tx_buf, size_t byte_count )
    if ( byte_count == 0 )
       return Success;
 
+#if AL_OUTQ
+   if ( outq_on )
+      {
+      outq_put( tx_buf, byte_count );
+      return Success;
+      }
+#endif
+
    fwrite( tx_buf, sizeof(char), byte_count, stdout );
 
    return Success;
@@ -232,6 +641,10 @@ size_t al_read_con( char* rx_buf, size_t byte_count )
    int	ic;
    size_t cnt = 0;
 
+#if AL_OUTQ
+   outq_drain();  /* the prompt goes out before waiting for the answer */
+#endif
+
    while( byte_count )
       {
       ic = fgetc( stdin );
@@ -297,6 +710,9 @@ size_t al_read_con( char* rx_buf, size_t byte_count )
 size_t al_con_chars_avail( void )
 
    {
+#if AL_OUTQ
+   outq_drain();
+#endif
    return 1;
    }
 
@@ -310,6 +726,253 @@ size_t al_con_chars_avail( void )
  *            to support target based timing!
  * ---------------------------------------------------------------------------*/
 
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+/*------------------------------------------------------------------------------
+ * FUNC   : al_monotonic_ns
+ *
+ * DESC   : Reads CLOCK_MONOTONIC_RAW, which NTP does not slew
+ *
+ * RETURNS: The time in nanoseconds
+ * ---------------------------------------------------------------------------*/
+
+static size_t al_monotonic_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC_RAW, &ts );
+	return (size_t)ts.tv_sec * 1000000000UL + (size_t)ts.tv_nsec;
+}
+#endif
+
+#if AL_TIMER_TSC
+/*------------------------------------------------------------------------------
+ * FUNC   : al_read_tsc
+ *
+ * DESC   : Reads the time stamp counter
+ *
+ * RETURNS: The counter
+ * ---------------------------------------------------------------------------*/
+
+static size_t al_read_tsc( void )
+{
+	unsigned int lo, hi;
+
+	__asm__ __volatile__ ( "rdtsc" : "=a" (lo), "=d" (hi) );
+	return (size_t)hi << 32 | lo;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_calibrate_tsc
+ *
+ * DESC   : Once, checks CPUID for an invariant TSC, one that ticks at a
+ *          constant rate in every power state, and counts its ticks over
+ *          20 ms of CLOCK_MONOTONIC_RAW. Leaves tsc_per_sec 0 otherwise.
+ * ---------------------------------------------------------------------------*/
+
+static void al_calibrate_tsc( void )
+{
+	unsigned int eax, ebx, ecx, edx;
+	size_t       ns0, ns1, tsc0, tsc1;
+
+	if ( tsc_calibrated )
+		return;
+	tsc_calibrated = 1;
+
+	__asm__ __volatile__ ( "cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	                               : "a" (0x80000000U) );
+	if ( eax < 0x80000007U )
+		return;
+	__asm__ __volatile__ ( "cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	                               : "a" (0x80000007U) );
+	if ( !( edx & ( 1U << 8 ) ) )
+		return;
+
+	ns0  = al_monotonic_ns();
+	tsc0 = al_read_tsc();
+	do
+		ns1 = al_monotonic_ns();
+	while ( ns1 - ns0 < 20000000UL );
+	tsc1 = al_read_tsc();
+
+	tsc_per_sec = (size_t)( (double)( tsc1 - tsc0 ) * 1e9 / ( ns1 - ns0 ) + 0.5 );
+}
+#endif
+
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+/*------------------------------------------------------------------------------
+ * FUNC   : al_read_ticks
+ *
+ * DESC   : Reads the timer of TARGET_TIMER_SOURCE
+ *
+ * RETURNS: The time in al_ticks_per_sec() ticks
+ * ---------------------------------------------------------------------------*/
+
+static size_t al_read_ticks( void )
+{
+#if AL_TIMER_TSC
+	if ( tsc_per_sec != 0 )
+		return al_read_tsc();
+#endif
+	return al_monotonic_ns();
+}
+#endif
+
+#if AL_PERF
+/*------------------------------------------------------------------------------
+ * FUNC   : al_perf_open
+ *
+ * DESC   : Opens the perf_event_open() counter group, led by the cycle
+ *          counter, for this process in user mode.  A counter the kernel or
+ *          the CPU does not offer is left out; without the leader there is
+ *          no group at all.
+ * ---------------------------------------------------------------------------*/
+
+static void al_perf_open( void )
+{
+	struct perf_event_attr	attr;
+	int						e;
+
+	perf_opened = 1;
+
+	for (e = 0; e < AL_PERF_COUNTERS; e++) {
+		perf_fd[e] = -1;
+		if (e > 0 && perf_fd[0] < 0)
+			continue;
+
+		memset( &attr, 0, sizeof(attr) );
+		attr.size			= sizeof(attr);
+		attr.type			= perf_events[e].type;
+		attr.config			= perf_events[e].config;
+		attr.disabled		= ( e == 0 );  /* the leader switches the group */
+		attr.exclude_kernel	= 1;
+		attr.exclude_hv		= 1;
+
+		perf_fd[e] = (int)syscall( __NR_perf_event_open, &attr, 0, -1,
+			e == 0 ? -1 : perf_fd[0], 0 );
+	}
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_perf_counts
+ *
+ * DESC   : Gets the hardware counters over the last timed region, in the
+ *          AL_PERF_* order of thal.h.
+ *
+ * RETURNS: A mask with bit AL_PERF_* set for each counter that was counted,
+ *          0 when TARGET_PERF_COUNTERS is off or there are no counters.
+ *
+ * PORTING: This uses Linux perf_event_open().  Other targets can read
+ *          their PMU in al_signal_start() and al_signal_finished() and
+ *          return the counts here.
+ * ---------------------------------------------------------------------------*/
+
+int al_perf_counts( size_t *counts )
+{
+	int mask = 0;
+#if AL_PERF
+	int e;
+
+	for (e = 0; e < AL_PERF_COUNTERS; e++) {
+		counts[e] = 0;
+		if (perf_opened && perf_fd[e] >= 0) {
+			counts[e] = perf_counts[e];
+			mask |= 1 << e;
+		}
+	}
+#else
+	counts = counts;
+#endif
+	return mask;
+}
+
+#if TARGET_ENERGY
+#if defined(__linux__)
+/*------------------------------------------------------------------------------
+ * FUNC   : al_read_sysfs
+ *
+ * DESC   : Reads the number in one file of TARGET_ENERGY_PATH
+ *
+ * RETURNS: Success, or Failure if the file cannot be read
+ * ---------------------------------------------------------------------------*/
+
+static int al_read_sysfs( const char *name, size_t *value )
+{
+	char			path[ 256 ];
+	FILE			*fp;
+	unsigned long	v;
+	int				ok;
+
+	if ( strlen( TARGET_ENERGY_PATH ) + strlen( name ) + 2 > sizeof(path) )
+		return Failure;
+	sprintf( path, "%s/%s", TARGET_ENERGY_PATH, name );
+
+	fp = fopen( path, "r" );
+	if ( fp == NULL )
+		return Failure;
+	ok = fscanf( fp, "%lu", &v ) == 1;
+	fclose( fp );
+
+	*value = (size_t)v;
+	return ok ? Success : Failure;
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_read_energy
+ *
+ * DESC   : Reads the energy counter in microjoules, and the most it counts
+ *          before it wraps around to 0, or 0 if it does not.
+ *
+ * RETURNS: Success, or Failure if there is no counter to read
+ *
+ * PORTING: This reads RAPL from the Linux powercap sysfs.  Boards with a
+ *          power monitor read its accumulated energy here, or integrate its
+ *          power readings over al_ticks().
+ * ---------------------------------------------------------------------------*/
+
+static int al_read_energy( size_t *uj, size_t *wrap )
+{
+#if defined(__linux__)
+	static int		range_read = 0;
+	static size_t	range      = 0;
+
+	if ( !range_read )
+	{
+		range_read = 1;
+		if ( al_read_sysfs( "max_energy_range_uj", &range ) != Success )
+			range = 0;
+	}
+	*wrap = range;
+	return al_read_sysfs( "energy_uj", uj );
+#else
+	*uj   = 0;
+	*wrap = 0;
+	return Failure;
+#endif
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_energy
+ *
+ * DESC   : Gets the energy used over the last timed region in microjoules.
+ *
+ * RETURNS: Success, or Failure when TARGET_ENERGY is off or there is no
+ *          energy counter
+ * ---------------------------------------------------------------------------*/
+
+int al_energy( size_t *uj )
+{
+#if TARGET_ENERGY
+	*uj = energy_uj;
+	return energy_ok ? Success : Failure;
+#else
+	*uj = 0;
+	return Failure;
+#endif
+}
+
 /*------------------------------------------------------------------------------
  * FUNC   : al_signal_start
  *
@@ -325,12 +988,38 @@ size_t al_con_chars_avail( void )
 
 void al_signal_start( void )
 {
-#if WINDOWS_EXAMPLE_CODE
+#if AL_OUTQ
+	outq_pause();
+#endif
+#if AL_PERF
+	if (!perf_opened)
+		al_perf_open();
+	if (perf_fd[0] >= 0) {
+		ioctl( perf_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+		ioctl( perf_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+	}
+#endif
+#if AL_TIMER_TSC
+        al_calibrate_tsc();
+#endif
+#if TARGET_ENERGY
+	{
+		size_t	wrap;
+
+		energy_ok = al_read_energy( &energy_start, &wrap ) == Success;
+	}
+#endif
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+        start_time      = al_read_ticks();
+#elif WINDOWS_EXAMPLE_CODE
         start_time      = clock();       
 #else
         /* Board specific timer code */                      
         start_time      = clock();       
 #endif
+#if AL_COPIES
+	wall_start = al_wall_seconds();
+#endif
 }
 
 /*------------------------------------------------------------------------------
@@ -351,11 +1040,44 @@ void al_signal_start( void )
 
 size_t al_signal_finished( void )
 {
-#if WINDOWS_EXAMPLE_CODE 
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+	stop_time	= al_read_ticks();
+#elif WINDOWS_EXAMPLE_CODE 
 	stop_time	= clock();
 #else
 	/* Board specific timer code  */ 
 	stop_time	= clock();
+#endif
+#if AL_COPIES
+	wall_stop = al_wall_seconds();
+#endif
+#if AL_PERF
+	if (perf_fd[0] >= 0) {
+		int		e;
+		__u64	v;
+
+		ioctl( perf_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP );
+		for (e = 0; e < AL_PERF_COUNTERS; e++) {
+			perf_counts[e] = 0;
+			if (perf_fd[e] >= 0 && read( perf_fd[e], &v, sizeof(v) ) == (int)sizeof(v))
+				perf_counts[e] = (size_t)v;
+		}
+	}
+#endif
+#if TARGET_ENERGY
+	if (energy_ok) {
+		size_t	now;
+		size_t	wrap;
+
+		energy_ok = al_read_energy( &now, &wrap ) == Success;
+		if (now < energy_start && wrap > 0)
+			energy_uj = wrap - energy_start + now;
+		else
+			energy_uj = now - energy_start;
+	}
+#endif
+#if AL_OUTQ
+	outq_resume();
 #endif
 	return (size_t)(stop_time-start_time);
 }
@@ -392,11 +1114,48 @@ size_t al_signal_finished( void )
  *          return the same value approximately every 72 minutes.
  *          ( Excerpt from GNU man page clock )
  *
+ *          TARGET_TIMER_MONOTONIC counts nanoseconds and TARGET_TIMER_TSC
+ *          the calibrated TSC rate, and neither wraps in practice with
+ *          64-bit ticks.
+ *
  * ---------------------------------------------------------------------------*/
 
 size_t al_ticks_per_sec( void )
 {
+#if AL_TIMER_TSC
+	al_calibrate_tsc();
+	if ( tsc_per_sec != 0 )
+		return tsc_per_sec;
+#endif
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+	return (size_t) 1000000000UL;
+#else
 	return (size_t) CLOCKS_PER_SEC;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_ticks
+ *
+ * DESC   : Adaptation layer implimentation of th_ticks()
+ *
+ *          Reads the free running timer behind al_signal_start() and
+ *          al_signal_finished() without starting or stopping anything, for
+ *          timestamps within a timed region.
+ *
+ * RETURNS: The current timer value, in al_ticks_per_sec() ticks
+ * ---------------------------------------------------------------------------*/
+
+size_t al_ticks( void )
+{
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+#if AL_TIMER_TSC
+	al_calibrate_tsc();
+#endif
+	return al_read_ticks();
+#else
+	return (size_t)clock();
+#endif
 }
 
 /*------------------------------------------------------------------------------
@@ -422,7 +1181,946 @@ size_t al_ticks_per_sec( void )
 
 size_t al_tick_granularity( void )
 {
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+	return 1;
+#else
 	return 10;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_timer_name
+ *
+ * DESC   : Names the timer behind al_signal_start() and al_signal_finished()
+ *
+ * RETURNS: "clock", "monotonic", or "tsc" when TARGET_TIMER_TSC found an
+ *          invariant TSC
+ * ---------------------------------------------------------------------------*/
+
+const char *al_timer_name( void )
+{
+#if AL_TIMER_TSC
+	al_calibrate_tsc();
+	if ( tsc_per_sec != 0 )
+		return "tsc";
+#endif
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+	return "monotonic";
+#else
+	return "clock";
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_write_record
+ *
+ * DESC   : Appends one results record line to the file path, writing the
+ *          header line first if the file is new or empty.  header may be
+ *          NULL.
+ *
+ * RETURNS: Success, or Failure if the file cannot be written
+ *
+ * PORTING: Targets without a file system can send the record to the
+ *          host with th_send_buf_as_file() instead.
+ * ---------------------------------------------------------------------------*/
+
+int al_write_record( const char *path, const char *header, const char *record )
+{
+	FILE	*fp;
+	int		ok;
+
+	fp = fopen( path, "a" );
+	if ( fp == NULL )
+		return Failure;
+
+	fseek( fp, 0L, SEEK_END );
+	if ( header != NULL && ftell( fp ) == 0L )
+		fprintf( fp, "%s\n", header );
+	fprintf( fp, "%s\n", record );
+
+	ok = !ferror( fp );
+	if ( fclose( fp ) != 0 )
+		ok = 0;
+
+	return ok ? Success : Failure;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_map_file
+ *
+ * DESC   : Maps the file at path into memory for the life of the program
+ *          and sets fd's buf, size and buf_size.  The mapping is private,
+ *          so a benchmark may write to it without changing the file.
+ *
+ * RETURNS: Success, or Failure if the file cannot be opened or is empty
+ *
+ * PORTING: Targets without mmap() can read the file into memory instead.
+ *          Targets without a file system return Failure and take their
+ *          data files from the host with the 'rf' command.
+ * ---------------------------------------------------------------------------*/
+
+int al_map_file( const char *path, FileDef *fd )
+{
+#if AL_COPIES
+	struct stat	st;
+	void		*p;
+	int			fh;
+
+	fh = open( path, O_RDONLY );
+	if ( fh < 0 )
+		return Failure;
+	if ( fstat( fh, &st ) != 0 || st.st_size <= 0 )
+	{
+		close( fh );
+		return Failure;
+	}
+	p = mmap( NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fh, 0 );
+	close( fh );
+	if ( p == MAP_FAILED )
+		return Failure;
+
+	fd->buf      = (char *)p;
+	fd->size     = (BlockSize)st.st_size;
+	fd->buf_size = fd->size;
+	return Success;
+#else
+	FILE	*fp;
+	long	len;
+
+	fp = fopen( path, "rb" );
+	if ( fp == NULL )
+		return Failure;
+	fseek( fp, 0L, SEEK_END );
+	len = ftell( fp );
+	rewind( fp );
+	if ( len <= 0 || ( fd->buf = (char *)malloc( (size_t)len ) ) == NULL )
+	{
+		fclose( fp );
+		return Failure;
+	}
+	if ( fread( fd->buf, 1, (size_t)len, fp ) != (size_t)len )
+	{
+		fclose( fp );
+		free( fd->buf );
+		return Failure;
+	}
+	fclose( fp );
+
+	fd->size     = (BlockSize)len;
+	fd->buf_size = fd->size;
+	return Success;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_evict_caches
+ *
+ * DESC   : Evicts the benchmark's data from the caches by writing one byte
+ *          of every TH_CACHE_LINE bytes of a TH_CACHE_EVICT_SIZE buffer,
+ *          allocated on the first call.  Writing rather than reading also
+ *          pushes the benchmark's dirty lines out to memory.
+ *
+ * RETURNS: Success, or Failure if the buffer cannot be allocated
+ *
+ * PORTING: Targets with cache maintenance operations, or caches larger
+ *          than the default TH_CACHE_EVICT_SIZE, may clean and invalidate
+ *          them here instead.
+ * ---------------------------------------------------------------------------*/
+
+int al_evict_caches( void )
+{
+	static unsigned char	*evict_buf = NULL;
+	size_t					i;
+
+	if ( evict_buf == NULL &&
+	     ( evict_buf = (unsigned char *)malloc( TH_CACHE_EVICT_SIZE ) ) == NULL )
+		return Failure;
+
+	for ( i = 0; i < TH_CACHE_EVICT_SIZE; i += TH_CACHE_LINE )
+		evict_buf[i]++;
+	return Success;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_cpu_count
+ *
+ * DESC   : Counts the CPUs the harness may run on, those of -pin<n> after
+ *          it pinned itself
+ *
+ * RETURNS: The count, or 0 if the target cannot tell
+ * ---------------------------------------------------------------------------*/
+
+int al_cpu_count( void )
+{
+#if defined(__linux__) && defined(CPU_SETSIZE)
+	cpu_set_t	allowed;
+#endif
+#if AL_COPIES && defined(_SC_NPROCESSORS_ONLN)
+	long		online;
+#endif
+
+#if defined(__linux__) && defined(CPU_SETSIZE)
+	if (sched_getaffinity( 0, sizeof(allowed), &allowed ) == 0)
+		return CPU_COUNT( &allowed );
+#endif
+#if AL_COPIES && defined(_SC_NPROCESSORS_ONLN)
+	online = sysconf( _SC_NPROCESSORS_ONLN );
+	return online > 0 ? (int)online : 0;
+#else
+	return 0;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_pin_copy
+ *
+ * DESC   : Pins the calling process to the copy'th CPU it may run on,
+ *          wrapping around when there are more copies than CPUs.  This is
+ *          a no-op off Linux.
+ * ---------------------------------------------------------------------------*/
+
+#if AL_COPIES
+static void al_pin_copy( int copy )
+{
+#if defined(__linux__) && defined(CPU_SETSIZE)
+	cpu_set_t	allowed;
+	cpu_set_t	one;
+	int			cpu;
+	int			n;
+	int			k;
+
+	if (sched_getaffinity( 0, sizeof(allowed), &allowed ) != 0)
+		return;
+
+	n = CPU_COUNT( &allowed );
+	if (n <= 0)
+		return;
+
+	k = copy % n;
+	for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		if (CPU_ISSET( cpu, &allowed ) && k-- == 0)
+			break;
+
+	CPU_ZERO( &one );
+	CPU_SET( cpu, &one );
+	sched_setaffinity( 0, sizeof(one), &one );
+#else
+	copy = copy;
+#endif
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_run_copies
+ *
+ * DESC   : Runs 'copies' copies of 'run' at once, one per forked process,
+ *          each pinned to its own CPU.  Every copy waits on a common start
+ *          barrier, the closing of a pipe, so they all start together and
+ *          share the caches and memory bandwidth for the whole run.
+ *
+ * PARAMS : copies    - the number of copies
+ *          run       - runs copy 'copy' and returns its duration in
+ *                      ticks, or 0 if it failed
+ *          durations - gets the duration of each copy, 0 for a copy that
+ *                      failed or died
+ *          seconds   - gets the al_wall_seconds() from the first copy
+ *                      to start its timer to the stop of each copy's
+ *                      timer, 0 for a copy that failed or died.  May be
+ *                      NULL.
+ *
+ * RETURNS: Success, or Failure if the copies could not be started
+ *
+ * PORTING: Targets without processes return Failure.  The copies must not
+ *          share any writable data, so a thread per copy will only do
+ *          where the benchmarks are reentrant.
+ * ---------------------------------------------------------------------------*/
+
+int al_run_copies( int copies, size_t (*run)( int copy ), size_t *durations, double *seconds )
+{
+#if AL_COPIES
+	struct {
+		int		copy;
+		size_t	duration;
+		double	start;
+		double	stop;
+	} rec;
+	int		go[2];
+	int		done[2];
+	int		c;
+	int		k;
+	pid_t	pid;
+	double	first = 0.0;
+	int		started = 0;
+
+	for (c = 0; c < copies; c++) {
+		durations[c] = 0;
+		if (seconds != NULL)
+			seconds[c] = 0.0;
+	}
+
+	if (pipe( go ) != 0)
+		return Failure;
+	if (pipe( done ) != 0) {
+		close( go[0] );
+		close( go[1] );
+		return Failure;
+	}
+
+	/* don't let every copy flush the parent's buffered output again */
+#if AL_OUTQ
+	outq_drain();
+#endif
+	fflush( stdout );
+
+	for (c = 0; c < copies; c++) {
+		pid = fork();
+		if (pid == 0) {
+			char	b;
+
+#if AL_OUTQ
+			outq_on = 0;	/* without the parent's drain thread */
+#endif
+			close( go[1] );
+			close( done[0] );
+			al_pin_copy( c );
+
+			/* the barrier: read() returns when the parent closes go[1] */
+			while (read( go[0], &b, 1 ) > 0)
+				;
+			close( go[0] );
+
+			rec.copy		= c;
+			rec.duration	= run( c );
+			rec.start		= wall_start;
+			rec.stop		= wall_stop;
+			if (write( done[1], &rec, sizeof(rec) ) != (int)sizeof(rec))
+				_exit( 1 );
+			_exit( 0 );
+		}
+		if (pid < 0)
+			break;
+	}
+
+	close( go[0] );
+	close( go[1] );       /* start them all */
+	close( done[1] );
+
+	while (read( done[0], &rec, sizeof(rec) ) == (int)sizeof(rec))
+		if (rec.copy >= 0 && rec.copy < copies) {
+			durations[rec.copy] = rec.duration;
+			if (seconds == NULL || rec.duration == 0)
+				continue;
+			seconds[rec.copy] = rec.stop;
+			if (!started || rec.start < first)
+				first = rec.start;
+			started = 1;
+		}
+	close( done[0] );
+
+	if (seconds != NULL)
+		for (k = 0; k < copies; k++)
+			if (seconds[k] != 0.0)
+				seconds[k] -= first;
+
+	while (wait( NULL ) > 0)
+		;
+
+	return c == copies ? Success : Failure;
+#else
+	copies		= copies;
+	run			= run;
+	durations	= durations;
+	seconds		= seconds;
+	return Failure;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_corun_load
+ *
+ * DESC   : The stream and llc loads of a co-runner, which never return.
+ *          The llc load steps through the lines by a prime, so that it
+ *          visits every one in an order the prefetchers do not follow.
+ * ---------------------------------------------------------------------------*/
+
+#if AL_COPIES
+#define CORUN_STRIDE	(7919)
+
+static void al_corun_load( int load )
+{
+	volatile unsigned char	*buf;
+	size_t					size;
+	size_t					lines;
+	size_t					i;
+	size_t					k;
+
+	size = load == TH_CORUN_STREAM ? TH_CORUN_STREAM_SIZE : TH_CORUN_LLC_SIZE;
+	if ( ( buf = (volatile unsigned char *)malloc( size ) ) == NULL )
+		_exit( 1 );
+	lines = size / TH_CACHE_LINE;
+
+	for (;;) {
+		if ( load == TH_CORUN_STREAM ) {
+			for ( i = 0; i + sizeof(size_t) <= size; i += sizeof(size_t) )
+				*(volatile size_t *)( buf + i ) += 1;
+		} else {
+			for ( i = 0, k = 0; i < lines; i++ ) {
+				buf[ k * TH_CACHE_LINE ]++;
+				k = ( k + CORUN_STRIDE ) % lines;
+			}
+		}
+	}
+}
+
+static pid_t	corun_pid[ TH_MAX_COPIES ];
+static int		corun_count = 0;
+#if defined(__linux__) && defined(CPU_SETSIZE)
+static cpu_set_t	corun_saved;		/* the harness's CPUs before the co-run */
+static int			corun_pinned = 0;
+#endif
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_start_corunners
+ *
+ * DESC   : Starts 'n' co-runner processes running 'load' beside the
+ *          harness until al_stop_corunners().  The harness is pinned to the
+ *          CPU it is on, and each co-runner to another one: of the CPUs the
+ *          harness may run on, or of all of them when that is just one, as
+ *          after -pin<n>.  Returns once every co-runner is on its CPU.
+ *
+ * PARAMS : n     - the number of co-runners, at most TH_MAX_COPIES
+ *          load  - TH_CORUN_STREAM, TH_CORUN_LLC or TH_CORUN_BENCH
+ *          bench - runs the benchmark once, for TH_CORUN_BENCH
+ *
+ * RETURNS: Success, or Failure if the co-runners could not be started or
+ *          there is no other CPU for them
+ *
+ * PORTING: Targets without processes return Failure.
+ * ---------------------------------------------------------------------------*/
+
+int al_start_corunners( int n, int load, void (*bench)( void ) )
+{
+#if AL_COPIES
+	int		ready[2];
+	int		c;
+	char	b;
+	pid_t	pid;
+#if defined(__linux__) && defined(CPU_SETSIZE)
+	cpu_set_t	others;
+	cpu_set_t	one;
+	int			count;
+	int			cpu;
+	int			me;
+	int			k;
+#endif
+
+	if (n > TH_MAX_COPIES)
+		n = TH_MAX_COPIES;
+	corun_count = 0;
+
+	if (pipe( ready ) != 0)
+		return Failure;
+
+#if defined(__linux__) && defined(CPU_SETSIZE)
+	CPU_ZERO( &others );
+	corun_pinned = sched_getaffinity( 0, sizeof(corun_saved), &corun_saved ) == 0;
+	if (corun_pinned && CPU_COUNT( &corun_saved ) > 1)
+		others = corun_saved;
+	else
+		for (cpu = 0; cpu < CPU_SETSIZE && cpu < (int)sysconf( _SC_NPROCESSORS_CONF ); cpu++)
+			CPU_SET( cpu, &others );
+
+	me = sched_getcpu();
+	if (me >= 0) {
+		CPU_CLR( me, &others );
+		CPU_ZERO( &one );
+		CPU_SET( me, &one );
+		sched_setaffinity( 0, sizeof(one), &one );
+	}
+	count = CPU_COUNT( &others );
+	if (count == 0) {
+		/* co-runners sharing the harness's CPU would only time slice it */
+		close( ready[0] );
+		close( ready[1] );
+		al_stop_corunners();
+		return Failure;
+	}
+#endif
+
+	/* don't let every co-runner flush the parent's buffered output again */
+#if AL_OUTQ
+	outq_drain();
+#endif
+	fflush( stdout );
+
+	for (c = 0; c < n; c++) {
+		pid = fork();
+		if (pid == 0) {
+#if AL_OUTQ
+			outq_on = 0;
+#endif
+			close( ready[0] );
+#if defined(__linux__) && defined(CPU_SETSIZE)
+			k = c % count;
+			for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+				if (CPU_ISSET( cpu, &others ) && k-- == 0)
+					break;
+			CPU_ZERO( &one );
+			CPU_SET( cpu, &one );
+			sched_setaffinity( 0, sizeof(one), &one );
+#endif
+			b = 1;
+			if (write( ready[1], &b, 1 ) != 1)
+				_exit( 1 );
+			close( ready[1] );
+
+			if (load == TH_CORUN_BENCH)
+				for (;;)
+					bench();
+			al_corun_load( load );
+			_exit( 0 );
+		}
+		if (pid < 0)
+			break;
+		corun_pid[ corun_count++ ] = pid;
+	}
+
+	close( ready[1] );
+	for (c = 0; c < corun_count && read( ready[0], &b, 1 ) == 1; c++)
+		;
+	close( ready[0] );
+
+	if (c < n) {
+		al_stop_corunners();
+		return Failure;
+	}
+	return Success;
+#else
+	n		= n;
+	load	= load;
+	bench	= bench;
+	return Failure;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_stop_corunners
+ *
+ * DESC   : Kills the co-runners of al_start_corunners() and lets the
+ *          harness run on its CPUs again
+ * ---------------------------------------------------------------------------*/
+
+void al_stop_corunners( void )
+{
+#if AL_COPIES
+	int	c;
+
+	for (c = 0; c < corun_count; c++)
+		kill( corun_pid[c], SIGKILL );
+	for (c = 0; c < corun_count; c++)
+		waitpid( corun_pid[c], NULL, 0 );
+	corun_count = 0;
+
+#if defined(__linux__) && defined(CPU_SETSIZE)
+	if (corun_pinned) {
+		sched_setaffinity( 0, sizeof(corun_saved), &corun_saved );
+		corun_pinned = 0;
+	}
+#endif
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_wall_seconds
+ *
+ * DESC   : Adaptation layer implimentation of th_wall_seconds()
+ *
+ * RETURNS: CLOCK_MONOTONIC in seconds, or the processor time of clock()
+ *          on targets without it
+ *
+ * PORTING: Return the best wall clock the target has.
+ * ---------------------------------------------------------------------------*/
+
+double al_wall_seconds( void )
+{
+#if AL_COPIES
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+#if TH_THREADS && AL_COPIES
+#define AL_THREADS (TRUE)
+#include <pthread.h>
+#else
+#define AL_THREADS (FALSE)
+#endif
+
+/* A th_pool_open() pool.  A run bumps 'generation' and sets 'pending' to
+ * the number of workers, each worker runs its part when it sees a new
+ * generation and the last one to finish signals 'done'. */
+struct THPool {
+	int		threads;
+#if AL_THREADS
+	pthread_mutex_t	lock;
+	pthread_cond_t	start;       /* a new run, or quit */
+	pthread_cond_t	done;        /* the workers finished the run */
+	unsigned long	generation;  /* counts the runs */
+	int		pending;     /* workers still in the run */
+	int		quit;
+	int		started;     /* workers started */
+	void		(*run)( void *arg, int part );
+	void		*arg;
+	pthread_t	*tid;
+	struct AlWorker	*workers;
+#endif
+};
+
+#if AL_THREADS
+typedef struct AlWorker {
+	struct THPool	*pool;
+	int		part;
+} AlWorker;
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_pool_main
+ *
+ * DESC   : A worker of a pool: runs its part of every run until told to quit
+ * ---------------------------------------------------------------------------*/
+
+static void *al_pool_main( void *arg )
+{
+	AlWorker	*w    = (AlWorker *)arg;
+	struct THPool	*pool = w->pool;
+	unsigned long	seen  = 0;
+	void		(*run)( void *arg, int part );
+	void		*run_arg;
+
+	pthread_mutex_lock( &pool->lock );
+	for (;;) {
+		while ( !pool->quit && pool->generation == seen )
+			pthread_cond_wait( &pool->start, &pool->lock );
+		if ( pool->quit )
+			break;
+		seen    = pool->generation;
+		run     = pool->run;
+		run_arg = pool->arg;
+		pthread_mutex_unlock( &pool->lock );
+
+		(*run)( run_arg, w->part );
+
+		pthread_mutex_lock( &pool->lock );
+		if ( --pool->pending == 0 )
+			pthread_cond_signal( &pool->done );
+	}
+	pthread_mutex_unlock( &pool->lock );
+	return NULL;
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_pool_open
+ *
+ * DESC   : Adaptation layer implimentation of th_pool_open()
+ *
+ * RETURNS: The pool, or NULL if 'threads' is below 1, or above 1 without
+ *          TH_THREADS, or a worker cannot be started
+ * ---------------------------------------------------------------------------*/
+
+struct THPool *al_pool_open( int threads )
+{
+	struct THPool	*pool;
+#if AL_THREADS
+	int		t;
+#endif
+
+	if ( threads < 1 || ( !AL_THREADS && threads > 1 ) )
+		return NULL;
+	pool = (struct THPool *)malloc( sizeof(struct THPool) );
+	if ( pool == NULL )
+		return NULL;
+	pool->threads = threads;
+
+#if AL_THREADS
+	pool->generation = 0;
+	pool->pending    = 0;
+	pool->quit       = 0;
+	pool->started    = 0;
+	pool->tid        = (pthread_t *)malloc( threads * sizeof(pthread_t) );
+	pool->workers    = (AlWorker *)malloc( threads * sizeof(AlWorker) );
+	pthread_mutex_init( &pool->lock, NULL );
+	pthread_cond_init( &pool->start, NULL );
+	pthread_cond_init( &pool->done, NULL );
+	if ( pool->tid == NULL || pool->workers == NULL ) {
+		al_pool_close( pool );
+		return NULL;
+	}
+
+	for ( t = 1; t < threads; t++ ) {
+		pool->workers[t].pool = pool;
+		pool->workers[t].part = t;
+		if ( pthread_create( &pool->tid[t], NULL, al_pool_main, &pool->workers[t] ) != 0 ) {
+			al_pool_close( pool );
+			return NULL;
+		}
+		pool->started++;
+	}
+#endif
+	return pool;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_pool_run
+ *
+ * DESC   : Adaptation layer implimentation of th_pool_run()
+ * ---------------------------------------------------------------------------*/
+
+void al_pool_run( struct THPool *pool, void (*run)( void *arg, int part ), void *arg )
+{
+#if AL_THREADS
+	if ( pool->threads > 1 ) {
+		pthread_mutex_lock( &pool->lock );
+		pool->run     = run;
+		pool->arg     = arg;
+		pool->pending = pool->threads - 1;
+		pool->generation++;
+		pthread_cond_broadcast( &pool->start );
+		pthread_mutex_unlock( &pool->lock );
+	}
+#else
+	pool = pool;
+#endif
+
+	(*run)( arg, 0 );
+
+#if AL_THREADS
+	if ( pool->threads > 1 ) {
+		pthread_mutex_lock( &pool->lock );
+		while ( pool->pending != 0 )
+			pthread_cond_wait( &pool->done, &pool->lock );
+		pthread_mutex_unlock( &pool->lock );
+	}
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_pool_close
+ *
+ * DESC   : Adaptation layer implimentation of th_pool_close().  Takes NULL.
+ * ---------------------------------------------------------------------------*/
+
+void al_pool_close( struct THPool *pool )
+{
+#if AL_THREADS
+	int	t;
+#endif
+
+	if ( pool == NULL )
+		return;
+
+#if AL_THREADS
+	pthread_mutex_lock( &pool->lock );
+	pool->quit = 1;
+	pthread_cond_broadcast( &pool->start );
+	pthread_mutex_unlock( &pool->lock );
+	for ( t = 1; t <= pool->started; t++ )
+		pthread_join( pool->tid[t], NULL );
+
+	pthread_cond_destroy( &pool->done );
+	pthread_cond_destroy( &pool->start );
+	pthread_mutex_destroy( &pool->lock );
+	free( pool->workers );
+	free( pool->tid );
+#endif
+	free( pool );
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_pin_cpu
+ *
+ * DESC   : Pins the calling process to CPU 'cpu'
+ *
+ * RETURNS: Success, or Failure if the CPU does not exist or may not be
+ *          used
+ *
+ * PORTING: Targets that cannot pin return Failure.
+ * ---------------------------------------------------------------------------*/
+
+int al_pin_cpu( int cpu )
+{
+#if defined(__linux__) && defined(CPU_SETSIZE)
+	cpu_set_t	one;
+
+	if (cpu < 0 || cpu >= CPU_SETSIZE)
+		return Failure;
+
+	CPU_ZERO( &one );
+	CPU_SET( cpu, &one );
+	return sched_setaffinity( 0, sizeof(one), &one ) == 0 ? Success : Failure;
+#else
+	cpu = cpu;
+	return Failure;
+#endif
+}
+
+#if defined(__linux__)
+/*------------------------------------------------------------------------------
+ * FUNC   : al_read_word
+ *
+ * DESC   : Reads the first word of a small text file, such as a sysfs
+ *          attribute, into 'buf'.
+ *
+ * RETURNS: TRUE if it got one
+ * ---------------------------------------------------------------------------*/
+
+static int al_read_word( const char *path, char *buf, size_t size )
+{
+	FILE	*fp;
+	size_t	n;
+
+	fp = fopen( path, "r" );
+	if ( fp == NULL )
+		return FALSE;
+	if ( fgets( buf, (int)size, fp ) == NULL )
+		buf[0] = '\0';
+	fclose( fp );
+
+	for ( n = 0; buf[n] != '\0' && buf[n] != '\n' && buf[n] != ' '; n++ )
+		;
+	buf[n] = '\0';
+	return n > 0;
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_cpu_scaling
+ *
+ * DESC   : Checks whether the clock of CPU 'cpu' can change under a run:
+ *          a cpufreq governor other than 'performance', or turbo boost
+ *          on.
+ *
+ * RETURNS: A note of what was found, or NULL if the clock looks fixed or
+ *          the target cannot tell
+ *
+ * PORTING: Targets with a fixed clock return NULL.
+ * ---------------------------------------------------------------------------*/
+
+const char *al_cpu_scaling( int cpu )
+{
+#if defined(__linux__)
+	static char	note[ 128 ];
+	char		path[ 96 ];
+	char		word[ 32 ];
+
+	note[0] = '\0';
+	if (cpu < 0)
+		cpu = 0;
+
+	sprintf( path, "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu );
+	if ( al_read_word( path, word, sizeof(word) ) && strcmp( word, "performance" ) != 0 )
+		sprintf( note, "cpu%d governor '%.31s'", cpu, word );
+
+	/* intel_pstate says no_turbo, acpi-cpufreq and amd-pstate say boost */
+	if ( ( al_read_word( "/sys/devices/system/cpu/intel_pstate/no_turbo", word, sizeof(word) )
+	       && strcmp( word, "0" ) == 0 ) ||
+	     ( al_read_word( "/sys/devices/system/cpu/cpufreq/boost", word, sizeof(word) )
+	       && strcmp( word, "1" ) == 0 ) )
+		strcat( note, note[0] != '\0' ? ", turbo boost on" : "turbo boost on" );
+
+	return note[0] != '\0' ? note : NULL;
+#else
+	cpu = cpu;
+	return NULL;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_cpu_features
+ *
+ * DESC   : Finds the instruction set extensions the CPU has, for
+ *          th_kernel_select(): CPUID on x86, NEON on AArch64, where it is
+ *          always there, and the hardware capabilities on 32 bit ARM Linux.
+ *
+ * RETURNS: TH_CPU_ features
+ *
+ * PORTING: Targets with no kernel variants can return 0.
+ * ---------------------------------------------------------------------------*/
+
+e_u32 al_cpu_features( void )
+{
+	e_u32	features = 0;
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "sse2" ) )
+		features |= TH_CPU_SSE2;
+	if ( __builtin_cpu_supports( "avx2" ) )
+		features |= TH_CPU_AVX2;
+	if ( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ) )
+		features |= TH_CPU_AVX512;
+#elif defined(__aarch64__)
+	features |= TH_CPU_NEON;
+#elif defined(__linux__) && defined(__arm__)
+	FILE	*fp;
+	char	line[ 256 ];
+
+	/* the Features line of /proc/cpuinfo lists the hardware capabilities */
+	fp = fopen( "/proc/cpuinfo", "r" );
+	if ( fp != NULL )
+	{
+		while ( fgets( line, sizeof(line), fp ) != NULL )
+			if ( strncmp( line, "Features", 8 ) == 0 && strstr( line, " neon" ) != NULL )
+				features |= TH_CPU_NEON;
+		fclose( fp );
+	}
+#endif
+	return features;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_stack_paint, al_stack_used
+ *
+ * DESC   : al_stack_paint() fills TH_STACK_PAINT bytes of stack below its
+ *          caller with a pattern, and al_stack_used() finds how much of it
+ *          was written since, from the far end, for TH_FOOTPRINT.  They
+ *          live here, apart from their callers, so that neither is inlined.
+ *
+ * RETURNS: The bytes of stack used below al_stack_paint()'s caller, or 0
+ *          before al_stack_paint()
+ *
+ * PORTING: This takes a stack that grows down, as on x86 and ARM.  Count
+ *          from the other end of the paint where it grows up.
+ * ---------------------------------------------------------------------------*/
+
+#define STACK_WORDS	( (size_t)TH_STACK_PAINT / sizeof(e_u32) )
+#define STACK_MAGIC	( (e_u32)0xDEADBEEFUL )
+
+static volatile e_u32	*stack_paint = NULL;
+
+void al_stack_paint( void )
+{
+	volatile e_u32	paint[ STACK_WORDS ];
+	size_t			i;
+
+	for ( i = 0; i < STACK_WORDS; i++ )
+		paint[i] = STACK_MAGIC;
+	stack_paint = paint;
+}
+
+size_t al_stack_used( void )
+{
+	size_t	i;
+
+	if ( stack_paint == NULL )
+		return 0;
+	for ( i = 0; i < STACK_WORDS && stack_paint[i] == STACK_MAGIC; i++ )
+		;
+	return ( STACK_WORDS - i ) * sizeof(e_u32);
 }
 
 /*------------------------------------------------------------------------------
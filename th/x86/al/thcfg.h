@@ -49,6 +49,438 @@
 #define TARGET_TIMER_AVAIL     (TRUE)
 #define TARGET_TIMER_INTRUSIVE (TRUE)
 
+/*------------------------------------------------------------------------------
+ * Target Timer Source, the timer behind th_signal_start/th_signal_finished
+ *
+ * TARGET_TIMER_CLOCK     - ANSI clock(), process CPU time in CLOCKS_PER_SEC
+ *                          ticks of about a millisecond
+ * TARGET_TIMER_MONOTONIC - POSIX clock_gettime(CLOCK_MONOTONIC_RAW) wall
+ *                          time in nanosecond ticks
+ * TARGET_TIMER_TSC       - the x86-64 time stamp counter in cycle ticks,
+ *                          calibrated against CLOCK_MONOTONIC_RAW. Without
+ *                          an invariant TSC, or on other targets, this is
+ *                          TARGET_TIMER_MONOTONIC.
+ *
+ * The tick counts are size_t, 64 bits on 64-bit hosts.
+ *---------------------------------------------------------------------------*/
+
+#define TARGET_TIMER_CLOCK     0
+#define TARGET_TIMER_MONOTONIC 1
+#define TARGET_TIMER_TSC       2
+
+#if !defined( TARGET_TIMER_SOURCE )
+#define TARGET_TIMER_SOURCE    TARGET_TIMER_CLOCK
+#endif
+
+/*------------------------------------------------------------------------------
+ * Hardware Performance Counters
+ *
+ * When TARGET_PERF_COUNTERS is (TRUE), th_signal_start/th_signal_finished
+ * also count cycles, instructions, branch misses and L1D and LLC read misses
+ * over the timed region (Linux perf_event_open(), user mode only), and
+ * th_report_results() adds the IPC and the counts per iteration. Counters
+ * the kernel refuses, e.g. under perf_event_paranoid, are reported as n/a.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TARGET_PERF_COUNTERS )
+#define TARGET_PERF_COUNTERS   (FALSE)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Energy Measurement
+ *
+ * When TARGET_ENERGY is (TRUE), th_signal_start/th_signal_finished also read
+ * an energy counter around the timed region, and th_report_results() adds
+ * the joules, joules per iteration and iterations per joule. On Linux this
+ * is the RAPL package domain in TARGET_ENERGY_PATH of the powercap sysfs,
+ * Intel or AMD, which often needs root to read; other targets read their
+ * board power monitor in al_read_energy(). RAPL counts about every
+ * millisecond and for the whole package, so use long, quiet runs. Without a
+ * counter the energy is reported as n/a.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TARGET_ENERGY )
+#define TARGET_ENERGY          (FALSE)
+#endif
+
+#if !defined( TARGET_ENERGY_PATH )
+#define TARGET_ENERGY_PATH     "/sys/class/powercap/intel-rapl:0"
+#endif
+
+/*------------------------------------------------------------------------------
+ * Latency Histogram Mode
+ *
+ * When TH_LATENCY_BATCH is non-zero, th_latency_mark() timestamps every
+ * TH_LATENCY_BATCH-th iteration of the timed loop into a buffer that
+ * th_latency_begin() allocates before th_signal_start(), and
+ * th_report_results() adds the min, p50, p90, p99, p99.9 and max time per
+ * batch. Use a TARGET_TIMER_SOURCE finer than one batch.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_LATENCY_BATCH )
+#define TH_LATENCY_BATCH       (0)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Stage Profiling
+ *
+ * When TH_PROFILE is TRUE, TH_PROF_BEGIN(id) and TH_PROF_END(id) around a
+ * stage of a kernel, e.g. the ACS of viterb00 or the bit reversal of fft00,
+ * add its ticks to slot id, 0 to TH_PROF_STAGES-1, while the timed loop
+ * runs, and th_report_results() adds each stage's calls, ticks per call and
+ * share of the run. Each stage reads the timer twice, so use a
+ * TARGET_TIMER_SOURCE finer than one stage and do not compare the timing of
+ * a profiled build with an unprofiled one. Otherwise the macros compile to
+ * nothing.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_PROFILE )
+#define TH_PROFILE             (FALSE)
+#endif
+
+#if !defined( TH_PROF_STAGES )
+#define TH_PROF_STAGES         (8)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Memory Footprint
+ *
+ * When TH_FOOTPRINT is TRUE, th_report_results() adds the peak heap use of
+ * the run, the bytes asked of th_malloc() and the blocks live at once, and
+ * the stack high water mark. Each block then carries a size header, and
+ * TH_STACK_PAINT bytes of stack below the harness are painted before the
+ * run and checked at th_signal_finished(), so the mark counts the harness
+ * calls the benchmark made until then. A mark of TH_STACK_PAINT bytes means
+ * the run went deeper than the paint.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_FOOTPRINT )
+#define TH_FOOTPRINT           (FALSE)
+#endif
+
+#if !defined( TH_STACK_PAINT )
+#define TH_STACK_PAINT         (0x10000L)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Iteration Calibration
+ *
+ * When calibration is on, the harness first runs the benchmark untimed for
+ * TH_CALIBRATE_WARMUP iterations, then probes with 1, 10, 100, ... iterations
+ * until a run takes at least a tenth of the target, and scales the count so
+ * the reported run takes about TH_CALIBRATE_SECONDS. Probe runs print
+ * nothing. The chosen count is printed before the run.
+ *
+ * TH_CALIBRATE turns it on by default. The -iauto or -iauto<secs> command
+ * line option turns it on for one run, and -i<n> or -idefault turns it off.
+ * Calibration is compiled out under CRC_CHECK, which needs the required
+ * iterations.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_CALIBRATE )
+#define TH_CALIBRATE           (FALSE)
+#endif
+
+#if !defined( TH_CALIBRATE_SECONDS )
+#define TH_CALIBRATE_SECONDS   (2)
+#endif
+
+#if !defined( TH_CALIBRATE_WARMUP )
+#define TH_CALIBRATE_WARMUP    (10)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Multi-Core Throughput Mode
+ *
+ * When TH_COPIES is non-zero, or -copies<n> is on the command line, the
+ * harness follows the normal run with TH_COPIES copies of the benchmark
+ * running at once, each in its own process pinned to its own CPU and
+ * started from a common barrier (see al_run_copies()). Each copy runs the
+ * same iterations with its output dropped. The report adds each copy's
+ * iterations/sec, their aggregate over the wall clock from the first
+ * copy's timer start to the last one's stop, and the scaling efficiency
+ * against the normal single copy run. More copies than the CPUs the
+ * harness may run on are refused, as they would only time slice them.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_COPIES )
+#define TH_COPIES              (0)
+#endif
+
+#if !defined( TH_MAX_COPIES )
+#define TH_MAX_COPIES          (64)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Repeated Trials
+ *
+ * When TH_TRIALS is non-zero, or -trials<n> is on the command line, the
+ * harness follows the normal run with TH_TRIALS more runs of the same
+ * iterations with their output dropped.  The report adds the mean,
+ * standard deviation, coefficient of variation and 95% confidence interval
+ * of their iterations/sec, and a warning when the coefficient of variation
+ * is above TH_TRIALS_MAX_CV percent: a difference smaller than the interval
+ * is noise.
+ *
+ * When TH_PIN_CPU is not -1, or -pin<n> is on the command line, the
+ * harness pins itself to that CPU before running (see al_pin_cpu()).
+ * Copies started by -copies<n> inherit the pinning and share that CPU.
+ *
+ * When TH_CHECK_SCALING is (TRUE), the trials report starts with a warning
+ * if the CPU runs under a governor other than 'performance' or with turbo
+ * boost on (see al_cpu_scaling()), either of which moves the clock under
+ * the benchmark.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_TRIALS )
+#define TH_TRIALS              (0)
+#endif
+
+#if !defined( TH_TRIALS_MAX_CV )
+#define TH_TRIALS_MAX_CV       (2)
+#endif
+
+#if !defined( TH_PIN_CPU )
+#define TH_PIN_CPU             (-1)
+#endif
+
+#if !defined( TH_CHECK_SCALING )
+#define TH_CHECK_SCALING       (TRUE)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Kernel Variants
+ *
+ * A kernel built with more than one variant, such as the scalar and the
+ * SSE2 or NEON butterflies of fft00 with FFT_SIMD, picks one when the
+ * benchmark starts with th_kernel_select(): the first of its variants
+ * whose CPU features al_cpu_features() finds.  A -kernel=<list> option on
+ * the command line, or else the TH_KERNEL_ENV environment variable, forces
+ * a variant.  The list is comma separated, each entry a <variant> for
+ * every kernel or a <kernel>:<variant> for one, e.g. -kernel=scalar or
+ * -kernel=fft:scalar,acs:sse2.  A forced variant the kernel does not have,
+ * or the CPU cannot run, is ignored with a note.  The report and the
+ * results record list the variant each kernel ran, in the same form.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_KERNEL_ENV )
+#define TH_KERNEL_ENV          "TH_KERNEL"
+#endif
+
+#if !defined( TH_MAX_KERNELS )
+#define TH_MAX_KERNELS         (8)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Suite Runs
+ *
+ * An image whose test_main() returns a TCDef with a 'next' chain runs every
+ * benchmark on it for each 'g', in order with the normal report each, or
+ * with -parallel all at once like the copies. Each benchmark runs its own
+ * recommended iterations unless -i<n> fixes one count for all. The report
+ * ends with each benchmark's iterations/sec and TH_SUITE_SCORE, their
+ * geometric mean over TH_SUITE_NORM. The suite's harness.h may set both.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_MAX_SUITE )
+#define TH_MAX_SUITE           (32)
+#endif
+
+#if !defined( TH_SUITE_SCORE )
+#define TH_SUITE_SCORE         "Score"
+#endif
+
+#if !defined( TH_SUITE_NORM )
+#define TH_SUITE_NORM          (1.0)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Results Records
+ *
+ * Besides the normal report, every reported run can append one record to a
+ * results file for dashboards to ingest, without scraping the log.
+ * TH_RESULTS selects the format by default, and -json[=<file>] or
+ * -csv[=<file>] on the command line for one run. The file defaults to
+ * TH_RESULTS_FILE with a .json or .csv extension.  JSON files get one
+ * object per line, CSV files a header line when new. A record holds the
+ * benchmark, its data set, TH_TOOLCHAIN, the timer, the iterations,
+ * duration, time per iteration and CRC status, and the latency histogram
+ * and hardware counters when those are on.
+ *---------------------------------------------------------------------------*/
+
+#define TH_RESULTS_NONE        (0)
+#define TH_RESULTS_JSON        (1)
+#define TH_RESULTS_CSV         (2)
+
+#if !defined( TH_RESULTS )
+#define TH_RESULTS             TH_RESULTS_NONE
+#endif
+
+#if !defined( TH_RESULTS_FILE )
+#define TH_RESULTS_FILE        "thresults"
+#endif
+
+#if !defined( TH_TOOLCHAIN )
+#if defined( __clang__ )
+#define TH_TOOLCHAIN           "clang " __clang_version__
+#elif defined( __GNUC__ )
+#define TH_TOOLCHAIN           "gcc " __VERSION__
+#elif defined( _MSC_VER )
+#define TH_TOOLCHAIN           "msvc"
+#else
+#define TH_TOOLCHAIN           "unknown"
+#endif
+#endif
+
+/*------------------------------------------------------------------------------
+ * File Output
+ *
+ * th_send_buf_as_file() and the streaming th_file_begin(), th_file_write(),
+ * th_file_printf() and th_file_end() send files to the host over the
+ * console.  TH_FILE_UUENCODE sends them uuencoded as 'begin' ... 'end'.
+ * TH_FILE_RAW sends 'begin-raw <name>', then each write as its length in
+ * hex on a line followed by the bytes as they are, and '0' and 'end' to
+ * finish.  That works on a binary-clean link and copies nothing.
+ *
+ * TH_FILE_FRAMED sends binary frames of up to TH_FRAME_SIZE bytes, each
+ * with a CRC, and with TH_FRAME_LZ the data frames are LZ compressed when
+ * that makes them smaller.  It also adds the 'rf' command, which receives
+ * a file sent the same way into the file area.  The frame format is
+ * described in uuencode.c.
+ *---------------------------------------------------------------------------*/
+
+#define TH_FILE_UUENCODE       (0)
+#define TH_FILE_RAW            (1)
+#define TH_FILE_FRAMED         (2)
+
+#if !defined( TH_FILE_OUTPUT )
+#define TH_FILE_OUTPUT         TH_FILE_UUENCODE
+#endif
+
+#if !defined( TH_FRAME_SIZE )
+#define TH_FRAME_SIZE          (1024)
+#endif
+
+#if !defined( TH_FRAME_LZ )
+#define TH_FRAME_LZ            (TRUE)
+#endif
+
+#define TH_FRAMED_FILES        ( TH_FILE_OUTPUT == TH_FILE_FRAMED )
+
+#if TH_FRAMED_FILES && ( TH_FRAME_SIZE < 16 || TH_FRAME_SIZE > 4096 )
+#error "TH_FRAME_SIZE must be from 16 to 4096"
+#endif
+
+/*------------------------------------------------------------------------------
+ * Data Files
+ *
+ * Set TH_DATA_FILES to (TRUE) to build the benchmarks without their data
+ * sets compiled in.  They then take their input and golden data from
+ * binary files, in the target's own layout, through th_get_data_file(), so
+ * one image runs any data set of the same shape.  dat2bin makes the files
+ * from the .dat sets.
+ *
+ * The harness looks for a file in the file area first, where 'rf' puts
+ * files on targets without a file system, then maps it with al_map_file()
+ * from TH_DATA_DIR, or the directory given by -data=<dir>.  -in=<file> and
+ * -ref=<file> replace the benchmark's default input and golden files, and
+ * -crc=<hex> its expected CRC.  Up to TH_MAX_DATA_FILES files are mapped,
+ * two for each data set in a suite.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_DATA_FILES )
+#define TH_DATA_FILES          (FALSE)
+#endif
+
+#if !defined( TH_DATA_DIR )
+#define TH_DATA_DIR            "."
+#endif
+
+#if !defined( TH_MAX_DATA_FILES )
+#define TH_MAX_DATA_FILES      (32)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Cache Cold Mode
+ *
+ * When TH_CACHE_COLD is (TRUE), the harness follows the normal run, whose
+ * iterations after the first find the benchmark's data in cache, with a
+ * cold run of the same iterations and its output dropped.  In the cold run
+ * th_latency_mark() evicts the caches after every iteration with
+ * al_evict_caches(), a pass over TH_CACHE_EVICT_SIZE bytes, more than the
+ * last level cache, in steps of TH_CACHE_LINE.  The eviction is not timed.
+ * The report adds the hot and cold iterations/sec and their ratio.
+ *
+ * To stream a data set larger than the caches instead, see TH_DATA_FILES.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_CACHE_COLD )
+#define TH_CACHE_COLD          (FALSE)
+#endif
+
+#if !defined( TH_CACHE_EVICT_SIZE )
+#define TH_CACHE_EVICT_SIZE    (64UL*1024*1024)
+#endif
+
+#if !defined( TH_CACHE_LINE )
+#define TH_CACHE_LINE          (64)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Co-Runner Interference Mode
+ *
+ * When TH_CORUN is not TH_CORUN_NONE, or -corun=<load>[:<n>] is on the
+ * command line, the harness follows the normal run with a run of the same
+ * iterations, its output dropped, while TH_CORUN_COPIES, or <n>, co-runner
+ * processes load other CPUs (see al_start_corunners()). The harness stays
+ * on its CPU and each co-runner is pinned to another one. The report adds
+ * the solo and co-run iterations/sec and the slowdown. The loads are
+ *
+ * stream - reads and writes TH_CORUN_STREAM_SIZE bytes in order, taking
+ *          memory bandwidth
+ * llc    - writes one byte of every TH_CACHE_LINE of TH_CORUN_LLC_SIZE
+ *          bytes in a scattered order, thrashing the last level cache
+ * bench  - the benchmark itself, run over and over
+ *---------------------------------------------------------------------------*/
+
+#define TH_CORUN_NONE          (0)
+#define TH_CORUN_STREAM        (1)
+#define TH_CORUN_LLC           (2)
+#define TH_CORUN_BENCH         (3)
+
+#if !defined( TH_CORUN )
+#define TH_CORUN               TH_CORUN_NONE
+#endif
+
+#if !defined( TH_CORUN_COPIES )
+#define TH_CORUN_COPIES        (1)
+#endif
+
+#if !defined( TH_CORUN_STREAM_SIZE )
+#define TH_CORUN_STREAM_SIZE   (64UL*1024*1024)
+#endif
+
+#if !defined( TH_CORUN_LLC_SIZE )
+#define TH_CORUN_LLC_SIZE      (16UL*1024*1024)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Harness Overhead
+ *
+ * When TH_OVERHEAD is (TRUE), the harness follows the normal run with the
+ * timed loop of the empty benchmark, its output dropped: the same
+ * iterations of an empty kernel called through a pointer, each followed
+ * by th_latency_mark(), between th_signal_start() and th_signal_finished()
+ * with the same timer and instrumentation as the benchmark.  The report
+ * adds the raw, overhead and overhead-corrected time per iteration, which
+ * matters once an iteration takes tens of nanoseconds.  Too few
+ * iterations for the timer make the overhead 0 ticks.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_OVERHEAD )
+#define TH_OVERHEAD            (TRUE)
+#endif
+
 /*------------------------------------------------------------------------------
  * Set BMDEBUG to a (TRUE) to enable debugging printf's etc etc.
  * Set it to a (FALSE) for the released version of the BM
@@ -129,13 +561,43 @@
  * COMPILE_OUT_HEAP	FALSE,	HAVE_MALLOC_H TRUE, maximize code size (invalid).
  *---------------------------------------------------------------------------*/
 
+/*---------------------------------------------------------------------------
+ * HEAP_ALLOCATOR selects the internal heap manager (see heap.c):
+ *
+ * HEAP_FIRST_FIT   one free list searched first fit, blocks are split
+ *                  and combined.
+ * HEAP_SEGREGATED  a free list per size class, a quarter of a power of
+ *                  two apart; alloc and free take constant time.
+ * HEAP_ARENA       a bump pointer; free does nothing and heap_reset()
+ *                  gives back everything at once.
+ *
+ * Defining HEAP_ALLOCATOR, e.g. in the make file, also selects the internal
+ * heap manager here, so that hosts measure the same allocator as targets.
+ *---------------------------------------------------------------------------*/
+
+#define HEAP_FIRST_FIT  (0)
+#define HEAP_SEGREGATED (1)
+#define HEAP_ARENA      (2)
+
 #if !defined (COMPILE_OUT_HEAP)
+#if defined (HEAP_ALLOCATOR)
+#define COMPILE_OUT_HEAP (FALSE)
+#else
 #define COMPILE_OUT_HEAP (TRUE)
 #endif
+#endif
 
 #if !defined (HAVE_MALLOC_H)
+#if defined (HEAP_ALLOCATOR)
+#define HAVE_MALLOC_H (FALSE)
+#else
 #define HAVE_MALLOC_H (TRUE)
 #endif
+#endif
+
+#if !defined (HEAP_ALLOCATOR)
+#define HEAP_ALLOCATOR HEAP_FIRST_FIT
+#endif
 
 #if !COMPILE_OUT_HEAP && HAVE_MALLOC_H
 #error	"COMPILE_OUT_HEAP is false, and HAVE_MALLOC_H is true. Cannot select both internal and compiler malloc functions."
@@ -196,6 +658,21 @@
 #error	"CRC_CHECK and NON_INTRUSIVE_CRC_CHECK are enabled. Set one of them to FALSE"
 #endif
 
+/*---------------------------------------------------------------------------
+ * CRC_SLICES selects how Calc_crc8 and Calc_crc_buf compute the crc, all
+ * with the same results.  0 is the original bit at a time loop, 1 looks up
+ * a 256 entry table per byte, and 8 also slices Calc_crc_buf 8 bytes at a
+ * time through 8 tables (4KB of data).
+ *---------------------------------------------------------------------------*/
+
+#if	!defined(CRC_SLICES)
+#define	CRC_SLICES				(8)
+#endif
+
+#if		CRC_SLICES != 0 && CRC_SLICES != 1 && CRC_SLICES != 8
+#error	"CRC_SLICES must be 0, 1 or 8"
+#endif
+
 /*------------------------------------------------------------------------------
  * Display verification 
  * VERIFY_INT - v1, v2, v3, v4 as size_t
@@ -213,6 +690,21 @@
 #define	VERIFY_FLOAT (FALSE)
 #endif
 
+/*------------------------------------------------------------------------------
+ * In-process verification
+ *
+ * With VERIFY_FLOAT, a benchmark that checks its output with diffmeasure()
+ * sets verify_snr in its results, reports the S/N in dB as v1v2 and the
+ * least S/N that passes as v3v4, 0 for no check, and th_report_results()
+ * fails a run below it.  Without a CRC check this replaces writing the
+ * output for the host's diffmeasure; set TH_VERIFY_FILES to (TRUE) to
+ * write it as well.
+ *----------------------------------------------------------------------------*/
+
+#if !defined(TH_VERIFY_FILES)
+#define TH_VERIFY_FILES (FALSE)
+#endif
+
 /*------------------------------------------------------------------------------
  * Set USE_TH_PRINTF to (FALSE) to use the printf engine that comes with
  * your compiler's C Library.
@@ -225,6 +717,72 @@
 #define USE_TH_PRINTF (FALSE)
 #endif
 
+/*------------------------------------------------------------------------------
+ * TH_CON_BUF_SIZE is the size of the buffer that collects console output
+ * so it reaches al_write_con() in blocks, not a character at a time.  The
+ * buffer is flushed when full, before the timer starts, when reading the
+ * console, by th_report_results() and by th_exit().  Set it to (0) to send
+ * everything straight to al_write_con().
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_CON_BUF_SIZE )
+#define TH_CON_BUF_SIZE (1024)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Asynchronous Output
+ *
+ * When TH_ASYNC_OUTPUT is not TH_ASYNC_NONE, al_write_con() only queues
+ * the console output, files included, in a TH_OUTQ_SIZE byte queue, and
+ * the harness goes on to its next benchmark while the queue drains to the
+ * link. The queue never drains inside a timed region: al_signal_start()
+ * waits for the chunk being sent and holds the rest until
+ * al_signal_finished(). The queue is emptied before reading the console,
+ * before forking copies or co-runners and at exit. The drains are
+ *
+ * thread - a POSIX thread sends the queue whenever the timer is stopped.
+ *          Link with -lpthread.
+ * idle   - for targets without threads: each console write and each end
+ *          of a timed region sends what the link takes without waiting,
+ *          at most TH_OUTQ_CHUNK bytes at a time
+ *
+ * A full queue is sent by the caller, as without the queue. Targets
+ * without POSIX I/O send everything straight away.
+ *---------------------------------------------------------------------------*/
+
+#define TH_ASYNC_NONE          (0)
+#define TH_ASYNC_THREAD        (1)
+#define TH_ASYNC_IDLE          (2)
+
+#if !defined( TH_ASYNC_OUTPUT )
+#define TH_ASYNC_OUTPUT        TH_ASYNC_NONE
+#endif
+
+#if !defined( TH_OUTQ_SIZE )
+#define TH_OUTQ_SIZE           (64UL*1024)
+#endif
+
+#if !defined( TH_OUTQ_CHUNK )
+#define TH_OUTQ_CHUNK          (4096)
+#endif
+
+/*------------------------------------------------------------------------------
+ * Worker Threads
+ *
+ * When TH_THREADS is TRUE, th_pool_open() starts a pool of POSIX threads
+ * that th_pool_run() hands the parts of a job to, for the benchmarks that
+ * measure scaling across threads. Link with -lpthread. When FALSE, or on
+ * targets without POSIX threads, a pool has only the calling thread and
+ * th_pool_open() of more than one thread fails.
+ *
+ * th_wall_seconds() reads CLOCK_MONOTONIC whatever the timer, as the
+ * clock() timer adds up the CPU time of every thread.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_THREADS )
+#define TH_THREADS             (FALSE)
+#endif
+
 /*------------------------------------------------------------------------------
  * This define is used to set the size of the buffer used to hold the
  * benchmark command line.  E.g. the 'argc' and 'argv' arguments will
@@ -11,14 +11,53 @@
 #include "thlib.h" /* pick up prototypes from api */
 
 
-/********************************************************************   
+/********************************************************************
 Function:  calc_crc
-Purpose:  Compute crc16 a byte at a time 
+Purpose:  Compute crc16 a byte at a time
 Type: PUBLIC
-********************************************************************/ 
+********************************************************************/
 
-#if	CRC_CHECK || NON_INTRUSIVE_CRC_CHECK  
+#if	CRC_CHECK || NON_INTRUSIVE_CRC_CHECK
+
+#if	CRC_SLICES
+/*********************************************************************
+ * crc_table[0] steps the crc over one byte, and crc_table[k] over a byte
+ * followed by k zero bytes, so that slicing by CRC_SLICES can look up
+ * CRC_SLICES bytes at once.  The tables are built on first use.
+ */
+static e_u16	crc_table[ CRC_SLICES ][ 256 ];
+static int		crc_table_ready = 0;
+
+static void crc_table_init( void )
+{
+	e_u16	crc;
+	int		i, j, k;
+
+	for (i = 0; i < 256; i++)
+	{
+		/* the bit at a time loop below, on (e_u8)i */
+		crc = (e_u16)i;
+		for (j = 0; j < 8; j++)
+			crc = (e_u16)(( crc & 1 ) ? ( crc >> 1 ) ^ 0xA001 : crc >> 1);
+		crc_table[0][i] = crc;
+	}
+	for (k = 1; k < CRC_SLICES; k++)
+		for (i = 0; i < 256; i++)
+			crc_table[k][i] = (e_u16)(( crc_table[k-1][i] >> 8 ) ^
+				crc_table[0][ crc_table[k-1][i] & 0xFF ]);
+	crc_table_ready = 1;
+}
+
+#define	CRC_BYTE( data, crc ) \
+	((e_u16)(( (crc) >> 8 ) ^ crc_table[0][ ( (crc) ^ (data) ) & 0xFF ]))
 
+e_u16 Calc_crc8(e_u8 data, e_u16 crc )
+{
+	if (!crc_table_ready)
+		crc_table_init();
+	return CRC_BYTE( data, crc );
+}
+#else
 e_u16 Calc_crc8(e_u8 data, e_u16 crc )
 {
 	e_u8 i,x16,carry;
@@ -40,7 +79,8 @@ e_u16 Calc_crc8(e_u8 data, e_u16 crc )
 		   crc &= 0x7fff;
     }
 	return crc;
-} 
+}
+#endif
 /*********************************************************************/
 e_u16 Calc_crc16( e_u16 data, e_u16 crc )
 {
@@ -62,4 +102,53 @@ e_u16 Calc_crc32( e_u32 data, e_u16 crc )
 
 	return crc;
 }
-#endif 
+
+/*********************************************************************
+ * Calc_crc_buf: the crc of len bytes at buf in memory order, the same
+ * as Calc_crc8 on each byte in turn.
+ */
+e_u16 Calc_crc_buf( const void *buf, size_t len, e_u16 crc )
+{
+	const e_u8	*p = (const e_u8 *)buf;
+
+#if	CRC_SLICES
+	if (!crc_table_ready)
+		crc_table_init();
+#endif
+#if	CRC_SLICES == 8
+	for (; len >= 8; len -= 8, p += 8)
+	{
+		crc ^= (e_u16)( p[0] | ( p[1] << 8 ) );
+		crc = (e_u16)( crc_table[7][ crc & 0xFF ] ^ crc_table[6][ crc >> 8 ] ^
+			crc_table[5][ p[2] ] ^ crc_table[4][ p[3] ] ^
+			crc_table[3][ p[4] ] ^ crc_table[2][ p[5] ] ^
+			crc_table[1][ p[6] ] ^ crc_table[0][ p[7] ] );
+	}
+#endif
+	for (; len > 0; len--, p++)
+	{
+#if	CRC_SLICES
+		crc = CRC_BYTE( *p, crc );
+#else
+		crc = Calc_crc8( *p, crc );
+#endif
+	}
+	return crc;
+}
+
+/*********************************************************************
+ * Calc_crc_buf16: the crc of n 16 bit words, the same as Calc_crc16 on
+ * each in turn.  That is their bytes in memory order on a little endian
+ * target.
+ */
+e_u16 Calc_crc_buf16( const e_u16 *buf, size_t n, e_u16 crc )
+{
+#if	EE_LITTLE_ENDIAN
+	return Calc_crc_buf( buf, n * sizeof(e_u16), crc );
+#else
+	for (; n > 0; n--)
+		crc = Calc_crc16( *buf++, crc );
+	return crc;
+#endif
+}
+#endif
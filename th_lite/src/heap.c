@@ -187,6 +187,20 @@ static int cm( const char *magic, const char *value );
 void *i_malloc( size_t size, const char *file, int line );
 void mem_heap_initialize(void);
 
+#if TH_FOOTPRINT
+/*
+ * Memory footprint, see TH_FOOTPRINT in thcfg.h.  Each th_malloc() block
+ * starts with a FOOT_HDR byte header holding the size asked for, which keeps
+ * the alignment of the block behind it.
+ */
+#define FOOT_HDR	(16)
+
+static size_t	foot_bytes			= 0;
+static size_t	foot_blocks			= 0;
+static size_t	foot_peak_bytes		= 0;
+static size_t	foot_peak_blocks	= 0;
+#endif
+
 
 /*------------------------------------------------------------------------------
  * FUNC   : heap_initialize
@@ -631,7 +645,24 @@ void i_free( void *block, const char *file, int line ){
 void *th_malloc_x( size_t size, const char *file, int line )
 
    {
+#if TH_FOOTPRINT
+   char *block = (char *) i_malloc( size + FOOT_HDR, file, line );
+
+   if (block == NULL)
+      return NULL;
+
+   *(size_t *) block = size;
+   foot_bytes += size;
+   foot_blocks++;
+   if (foot_bytes > foot_peak_bytes)
+      foot_peak_bytes = foot_bytes;
+   if (foot_blocks > foot_peak_blocks)
+      foot_peak_blocks = foot_blocks;
+
+   return block + FOOT_HDR;
+#else
    return i_malloc( size, file, line );
+#endif
    }
 
 /*------------------------------------------------------------------------------
@@ -652,6 +683,90 @@ void *th_malloc_x( size_t size, const char *file, int line )
  * ---------------------------------------------------------------------------*/
 
 void th_free_x( void *block, const char *file, int line ){
+#if TH_FOOTPRINT
+   if (block != NULL)
+      {
+      block = (char *) block - FOOT_HDR;
+      foot_bytes -= *(size_t *) block;
+      foot_blocks--;
+      }
+#endif
    i_free ( block, file, line );
 }
 
+#if TH_FOOTPRINT
+/*------------------------------------------------------------------------------
+ * FUNC    : th_heap_peak
+ *
+ * DESC    : Gets the most bytes asked of th_malloc() and the most blocks
+ *           that were live at once.
+ * ---------------------------------------------------------------------------*/
+
+void th_heap_peak( size_t *bytes, size_t *blocks )
+
+   {
+   *bytes  = foot_peak_bytes;
+   *blocks = foot_peak_blocks;
+   }
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC    : th_malloc_aligned_x
+ *
+ * DESC    : Test Harness aligned malloc()
+ *
+ *           Gets a block 'align' - 1 bytes and a pointer bigger from
+ *           th_malloc_x(), which works with every heap manager, and returns
+ *           the first 'align' byte boundary in it with the pointer to the
+ *           block right in front.
+ *
+ * PARAMS  : size  - is the size of the memory block neded
+ *           align - the alignment, a power of 2
+ *           file  - the __FILE__ macro from where the call was made
+ *           line  - the __LINE__ macro from where the call was made
+ *
+ * NOTE    : This function is usually invoked by using the
+ *           th_malloc_aligned() macro.  Free the block with
+ *           th_free_aligned().
+ *
+ * RETURNS : A pointer to the aligned block, or NULL if 'align' is not a
+ *           power of 2 or the block cannot be allocated.
+ * ---------------------------------------------------------------------------*/
+
+void *th_malloc_aligned_x( size_t size, size_t align, const char *file, int line )
+
+   {
+   char *block;
+   char *aligned;
+
+   if (align < sizeof(void *))
+      align = sizeof(void *);
+   if (( align & ( align - 1 )) != 0)
+      return NULL;
+
+   block = (char *) th_malloc_x( size + align - 1 + sizeof(void *), file, line );
+   if (block == NULL)
+      return NULL;
+
+   aligned = block + sizeof(void *);
+   aligned += ( align - (size_t) aligned % align ) % align;
+   ((void **) aligned)[ -1 ] = block;
+
+   return (void *) aligned;
+   }
+
+/*------------------------------------------------------------------------------
+ * FUNC    : th_free_aligned_x
+ *
+ * DESC    : Test Harness free() for th_malloc_aligned() blocks
+ *
+ * NOTE    : It is valid to pass the null pointer to this function.
+ * ---------------------------------------------------------------------------*/
+
+void th_free_aligned_x( void *block, const char *file, int line )
+
+   {
+   if (block != NULL)
+      th_free_x( ((void **) block)[ -1 ], file, line );
+   }
+
@@ -24,6 +24,14 @@ extern "C" {
 
 #define FATAL_EXIT (-32766)
 
+/* The bits of al_ticks() that count, see TARGET_TIMER_MASK in thcfg.h.
+ * The ticks between two reads are their difference masked with it. */
+#if TARGET_TIMER_SOURCE == TARGET_TIMER_USER
+#define AL_TICKS_MASK  ( (size_t)( TARGET_TIMER_MASK ) )
+#else
+#define AL_TICKS_MASK  ( ~(size_t)0 )
+#endif
+
    /*------------------------------------------------------------------------------
     * Global data
     */
@@ -43,6 +51,10 @@ extern "C" {
 	int		al_printf(const char *fmt, va_list args);
 	int		al_sprintf(char *str, const char *fmt, va_list args);
 	void	al_report_results( void );
+	e_u32	al_cpu_features( void );
+	int		al_energy( size_t *uj );
+	void	al_stack_paint( void );
+	size_t	al_stack_used( void );
 	void	al_main(int argc, const char* argv[]);
 
    /*----------------------------------------------------------------------------*/
@@ -7,11 +7,73 @@
  *
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "thlib.h"
 #include "thal.h"
 
 static void report_info( TCDef *tcdef );
 
+/* the variant each kernel runs, for the report */
+static struct {
+	const char	*kernel;
+	const char	*variant;
+} kernels[ TH_MAX_KERNELS ];
+static int	kernel_count = 0;
+
+#if TH_FOOTPRINT
+/* the stack high water mark th_signal_finished() found */
+static size_t	foot_stack = 0;
+#endif
+
+#if TH_PROFILE
+/* the stage profile of the timed loop, see th_prof_begin() */
+static size_t		prof_start[ TH_PROF_STAGES ];
+static size_t		prof_ticks[ TH_PROF_STAGES ];
+static size_t		prof_calls[ TH_PROF_STAGES ];
+static const char	*prof_names[ TH_PROF_STAGES ];
+static int			prof_open = 0;
+
+static void prof_report( size_t duration );
+#endif
+
+#if TH_LATENCY_BATCH
+/* the latency histogram of the timed loop, see th_latency_mark().  Bin i
+ * of the first 2*LAT_SUB holds i ticks, and each LAT_SUB bins after them
+ * split an octave; lat_last is the tick the batch started on. */
+#define LAT_SUB		( (size_t)1 << TH_LATENCY_SUB_BITS )
+#define LAT_BINS	( ( sizeof(size_t) * 8 - TH_LATENCY_SUB_BITS + 1 ) * LAT_SUB )
+
+static e_u32	lat_bins[ LAT_BINS ];
+static e_u32	lat_samples = 0;
+static e_u32	lat_count   = 0;
+static size_t	lat_min     = 0;
+static size_t	lat_max     = 0;
+static size_t	lat_last    = 0;
+static int		lat_armed   = 0;
+static int		lat_open    = 0;
+
+static void lat_report( void );
+#endif
+
+#define STREAM_ON	( TH_STREAM && ( TH_LATENCY_BATCH || TH_PROFILE ) )
+
+#if STREAM_ON
+/* the streaming report, see TH_STREAM in thcfg.h.  An entry is a latency
+ * batch, id -1, or a stage; stream_ticks adds up the ticks of printing. */
+static struct {
+	int		id;
+	size_t	ticks;
+} stream_buf[ TH_STREAM_SIZE ];
+static int		stream_used    = 0;
+static e_u32	stream_batches = 0;
+static size_t	stream_ticks   = 0;
+
+static void stream_put( int id, size_t ticks );
+static void stream_flush( void );
+#endif
+
 /*------------------------------------------------------------------------------
  * FUNC   : th_timer_available
  *
@@ -113,7 +175,30 @@ size_t th_tick_granularity( void )
 
 void th_signal_start( void )
 {
+#if TH_PROFILE
+int	i;
+
+for ( i = 0; i < TH_PROF_STAGES; i++ ) {
+	prof_ticks[i] = 0;
+	prof_calls[i] = 0;
+	prof_names[i] = NULL;
+}
+prof_open = 1;
+#endif
+#if STREAM_ON
+stream_used    = 0;
+stream_batches = 0;
+stream_ticks   = 0;
+#endif
 al_signal_start();
+#if TH_LATENCY_BATCH
+if ( lat_armed ) {
+	lat_armed = 0;
+	lat_open  = 1;
+	lat_count = 0;
+	lat_last  = al_ticks();
+}
+#endif
 }
 
 /*------------------------------------------------------------------------------
@@ -139,7 +224,23 @@ al_signal_start();
 
 e_u32 th_signal_finished( void )
 {
-	return al_signal_finished();
+	size_t	rv = al_signal_finished();
+
+#if TH_LATENCY_BATCH
+	lat_open = 0;
+#endif
+#if TH_PROFILE
+	prof_open = 0;
+#endif
+#if STREAM_ON
+	/* the printing is not part of the benchmark */
+	rv = rv > stream_ticks ? rv - stream_ticks : 0;
+	stream_flush();
+#endif
+#if TH_FOOTPRINT
+	foot_stack = al_stack_used();
+#endif
+	return rv;
 }
 
 /*------------------------------------------------------------------------------
@@ -202,6 +303,13 @@ th_printf( ">> Bench Mark               : %s\n",tcdef->desc);
 int th_report_results(TCDef *tcdef, e_u16 Expected_CRC )
 {
 int	exit_code = Success;
+int	k;
+#if	TH_FOOTPRINT
+size_t	peak_bytes, peak_blocks;
+#endif
+#if	TARGET_ENERGY && FLOAT_SUPPORT
+size_t	uj;
+#endif
 
 /* Used to unload double from two vx results variables */ 
 #if	VERIFY_FLOAT && FLOAT_SUPPORT
@@ -210,6 +318,7 @@ int	exit_code = Success;
 		size_t	v[2];
 	} d_union;
 	d_union	dunion;
+	double	snr, snr_min;
 #endif
 
 /* Standard Log file Print Section */
@@ -224,6 +333,8 @@ th_printf(  "--  Non-Intrusive CRC = %4x\n",tcdef->CRC);
 #else
 th_printf(  "--  No CRC check      = 0000\n"); 
 #endif
+for ( k = 0; k < kernel_count; k++ )
+th_printf(  "--  Kernel %-9s= %s\n", kernels[k].kernel, kernels[k].variant );
 th_printf(  "--  Iterations        = %5u\n", tcdef->iterations );
 th_printf(  "--  Target Duration   = %5u\n", tcdef->duration );
 #if		VERIFY_INT
@@ -235,10 +346,12 @@ th_printf(  "--  v4                = %d\n", tcdef->v4);
 #if		VERIFY_FLOAT && FLOAT_SUPPORT
 dunion.v[0]	= tcdef->v1;
 dunion.v[1] = tcdef->v2;
-th_printf(  "--  v1v2              = %f\n", dunion.d);
+snr			= dunion.d;
+th_printf(  "--  v1v2              = %f\n", snr);
 dunion.v[0]	= tcdef->v3;
 dunion.v[1] = tcdef->v4;
-th_printf(  "--  v3v4              = %f\n", dunion.d);
+snr_min		= dunion.d;
+th_printf(  "--  v3v4              = %f\n", snr_min);
 #endif
 
 #if		FLOAT_SUPPORT
@@ -263,6 +376,27 @@ th_printf(  "--  v3v4              = %f\n", dunion.d);
       }
 #endif
 
+#if		TARGET_ENERGY && FLOAT_SUPPORT
+   if (al_energy( &uj ) == Success && uj > 0 && tcdef->iterations > 0)
+      {
+      double joules = (double) uj / 1e6;
+
+      th_printf( "--  Energy            = %12.6fJ\n", joules );
+      th_printf( "--  Joules / Iter     = %18.9fJ\n", joules / (double) tcdef->iterations );
+      th_printf( "--  Iterations/Joule  = %12.3f\n", (double) tcdef->iterations / joules );
+      }
+   else
+      th_printf( "--  Energy            = n/a\n" );
+#endif
+
+#if		TH_FOOTPRINT
+	th_heap_peak( &peak_bytes, &peak_blocks );
+	th_printf( "--  Peak Heap         = %lu bytes in %lu blocks\n",
+		(unsigned long)peak_bytes, (unsigned long)peak_blocks );
+	th_printf( "--  Stack High Water  = %lu bytes%s\n", (unsigned long)foot_stack,
+		foot_stack >= (size_t)TH_STACK_PAINT ? " or more" : "" );
+#endif
+
    /* Failure Section */
 #if		CRC_CHECK || NON_INTRUSIVE_CRC_CHECK
 	if( tcdef->CRC != Expected_CRC ){
@@ -271,11 +405,26 @@ th_printf(  "--  v3v4              = %f\n", dunion.d);
 	} 
 #endif
 
+#if	VERIFY_FLOAT && FLOAT_SUPPORT
+	if( tcdef->verify_snr && snr_min != 0.0 && !( snr >= snr_min ) ){
+		th_printf("--  Failure: S/N %f dB, Expected at least %f dB\n",snr,snr_min);
+		exit_code = Failure;
+	}
+#endif
+
 	if (tcdef->iterations != tcdef->rec_iterations) {
 		th_printf("--  Failure: Actual iterations %x, Expected iterations %x\n",tcdef->iterations,tcdef->rec_iterations);
 		exit_code = Failure;
 	}
 
+#if		TH_LATENCY_BATCH
+	lat_report();
+#endif
+
+#if		TH_PROFILE
+	prof_report( tcdef->duration );
+#endif
+
 if	(exit_code == SUCCESS )	th_printf( ">> DONE!\n" );
 else						th_printf( ">> Failure: %d\n", exit_code );
 
@@ -315,6 +464,316 @@ int th_harness_poll( void )
    {
    return (TRUE);
    }
+/*------------------------------------------------------------------------------
+ * FUNC   : th_kernel_select
+ *
+ * DESC   : Picks the variant of 'kernel' to run, the first of 'variants'
+ *          whose CPU features al_cpu_features() finds, unless the
+ *          TH_KERNEL_ENV environment variable forces another the CPU can
+ *          run: its <kernel>:<variant> entry, or else its last <variant>.
+ *
+ * RETURNS: the index of the variant in 'variants'
+ * ---------------------------------------------------------------------------*/
+
+int th_kernel_select( const char *kernel, const THKernelVariant *variants, int count )
+
+   {
+   const char	*s = getenv( TH_KERNEL_ENV );
+   const char	*end;
+   const char	*colon;
+   const char	*forced = NULL;
+   size_t		flen = 0;
+   size_t		klen = strlen( kernel );
+   e_u32		features = al_cpu_features();
+   int			pick = -1;
+   int			v;
+
+   for (; s != NULL && *s != '\0'; s = *end != '\0' ? end + 1 : end)
+      {
+      end = strchr( s, ',' );
+      if (end == NULL)
+         end = s + strlen( s );
+      colon = (const char *)memchr( s, ':', (size_t)( end - s ) );
+      if (colon == NULL)
+         {
+         forced = s;
+         flen = (size_t)( end - s );
+         }
+      else if ((size_t)( colon - s ) == klen && strncmp( s, kernel, klen ) == 0)
+         {
+         forced = colon + 1;
+         flen = (size_t)( end - forced );
+         break;
+         }
+      }
+
+   for (v = 0; forced != NULL && v < count; v++)
+      if (strlen( variants[v].name ) == flen && strncmp( variants[v].name, forced, flen ) == 0)
+         {
+         if (( variants[v].features & ~features ) == 0)
+            pick = v;
+         else
+            th_printf( "-- Kernel %s cannot run %s on this CPU\n", kernel, variants[v].name );
+         break;
+         }
+   if (forced != NULL && v == count)
+      th_printf( "-- Kernel %s has no %.*s variant\n", kernel, (int)flen, forced );
+
+   for (v = 0; pick < 0 && v < count; v++)
+      if (( variants[v].features & ~features ) == 0)
+         pick = v;
+   if (pick < 0)
+      pick = count - 1;
+
+   for (v = 0; v < kernel_count; v++)
+      if (strcmp( kernels[v].kernel, kernel ) == 0)
+         break;
+   if (v < TH_MAX_KERNELS)
+      {
+      kernels[v].kernel  = kernel;
+      kernels[v].variant = variants[ pick ].name;
+      if (v == kernel_count)
+         kernel_count++;
+      }
+
+   return pick;
+   }
+
+#if TH_PROFILE
+/*------------------------------------------------------------------------------
+ * FUNC   : th_prof_begin, th_prof_end
+ *
+ * DESC   : TH_PROF_BEGIN() and TH_PROF_END(), the start and end of a stage
+ *          of the timed loop, added to slot id.
+ * ---------------------------------------------------------------------------*/
+
+void th_prof_begin( int id )
+{
+	if ( id >= 0 && id < TH_PROF_STAGES )
+		prof_start[id] = al_ticks();
+}
+
+void th_prof_end( int id, const char *name )
+{
+	size_t	now = al_ticks();
+
+	size_t	ticks;
+
+	if ( prof_open && id >= 0 && id < TH_PROF_STAGES ) {
+		ticks = ( now - prof_start[id] ) & AL_TICKS_MASK;
+		prof_ticks[id] += ticks;
+		prof_calls[id]++;
+		prof_names[id]  = name;
+#if STREAM_ON
+		stream_put( id, ticks );
+#endif
+	}
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : prof_report
+ *
+ * DESC   : Prints each stage of the profile, its calls, ticks per call and
+ *          share of the run's duration, then the share of all the stages.
+ * ---------------------------------------------------------------------------*/
+
+static void prof_report( size_t duration )
+{
+	size_t		total = 0;
+	const char	*name;
+	int			i;
+
+	for ( i = 0; i < TH_PROF_STAGES; i++ ) {
+		if ( prof_calls[i] == 0 )
+			continue;
+		name = prof_names[i];
+		if ( strncmp( name, "PROF_", 5 ) == 0 )
+			name += 5;
+		total += prof_ticks[i];
+#if FLOAT_SUPPORT
+		th_printf( "--  Stage %-12s= %10lu calls %14.3f ticks/call %6.2f%%\n", name,
+			(unsigned long)prof_calls[i], (double)prof_ticks[i] / prof_calls[i],
+			duration > 0 ? 100.0 * prof_ticks[i] / duration : 0.0 );
+#else
+		th_printf( "--  Stage %-12s= %10lu calls %10lu ticks/call %3lu%%\n", name,
+			(unsigned long)prof_calls[i], (unsigned long)( prof_ticks[i] / prof_calls[i] ),
+			(unsigned long)( duration > 0 ? prof_ticks[i] / ( duration / 100 + 1 ) : 0 ) );
+#endif
+	}
+#if FLOAT_SUPPORT
+	th_printf( "--  Stages Total      = %10lu ticks %6.2f%% of the run\n", (unsigned long)total,
+		duration > 0 ? 100.0 * total / duration : 0.0 );
+#else
+	th_printf( "--  Stages Total      = %10lu ticks %3lu%% of the run\n", (unsigned long)total,
+		(unsigned long)( duration > 0 ? total / ( duration / 100 + 1 ) : 0 ) );
+#endif
+}
+#endif
+
+#if TH_LATENCY_BATCH
+/*------------------------------------------------------------------------------
+ * FUNC   : th_latency_begin
+ *
+ * DESC   : Arms the latency histogram for the next timed loop and empties
+ *          it.  The iterations are the full harness's, which buffers a
+ *          timestamp per batch; the histogram does not need them.
+ * ---------------------------------------------------------------------------*/
+
+void th_latency_begin( size_t iterations )
+{
+	iterations = iterations;
+
+	memset( lat_bins, 0, sizeof(lat_bins) );
+	lat_samples = 0;
+	lat_armed   = 1;
+	lat_open    = 0;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : th_latency_mark
+ *
+ * DESC   : Called after each iteration of the timed loop.  Every
+ *          TH_LATENCY_BATCH-th call counts the ticks of the batch in its
+ *          bin: the top TH_LATENCY_SUB_BITS bits below the leading one of
+ *          the ticks pick the bin of their octave.
+ * ---------------------------------------------------------------------------*/
+
+void th_latency_mark( void )
+{
+	size_t	now, ticks, top;
+	int		octave = 0;
+
+	if ( !lat_open || ++lat_count < TH_LATENCY_BATCH )
+		return;
+	lat_count = 0;
+
+	now      = al_ticks();
+	ticks    = ( now - lat_last ) & AL_TICKS_MASK;
+	lat_last = now;
+
+	for ( top = ticks; top >= 2 * LAT_SUB; top >>= 1 )
+		octave++;
+	lat_bins[ octave * LAT_SUB + top ]++;
+
+	if ( lat_samples == 0 || ticks < lat_min )
+		lat_min = ticks;
+	if ( lat_samples == 0 || ticks > lat_max )
+		lat_max = ticks;
+	lat_samples++;
+
+#if STREAM_ON
+	stream_put( -1, ticks );
+#endif
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : lat_report
+ *
+ * DESC   : Prints the min and max batch and the p50, p90, p99 and p99.9 of
+ *          the histogram, nearest rank, each the top of its bin.
+ * ---------------------------------------------------------------------------*/
+
+static void lat_report( void )
+{
+	static const char	*names[ 6 ]    = { "min", "p50", "p90", "p99", "p99.9", "max" };
+	static const e_u32	permille[ 6 ]  = { 0, 500, 900, 990, 999, 1000 };
+	size_t				point, sub, shift;
+	e_u32				rank, seen;
+	size_t				b;
+	int					i;
+
+	th_printf( "--  Latency Batch     = %12lu iterations\n", (unsigned long)TH_LATENCY_BATCH );
+	th_printf( "--  Latency Samples   = %12lu\n", (unsigned long)lat_samples );
+
+	for ( i = 0; i < 6 && lat_samples > 0; i++ ) {
+		if ( i == 0 )
+			point = lat_min;
+		else if ( i == 5 )
+			point = lat_max;
+		else {
+			rank = lat_samples / 1000 * permille[i] +
+			       ( lat_samples % 1000 * permille[i] + 999 ) / 1000;
+			for ( b = 0, seen = 0; b < LAT_BINS - 1; b++ )
+				if ( ( seen += lat_bins[b] ) >= rank )
+					break;
+			/* the top of bin b: 2*LAT_SUB bins of 1 tick, then octaves */
+			shift = b < 2 * LAT_SUB ? 0 : b / LAT_SUB - 1;
+			sub   = b - shift * LAT_SUB;
+			point = ( ( sub + 1 ) << shift ) - 1;
+			if ( point > lat_max )
+				point = lat_max;
+		}
+#if FLOAT_SUPPORT
+		th_printf( "--  Latency %-6s    = %18.9fsec\n", names[i],
+			(double)point / th_ticks_per_sec() );
+#else
+		th_printf( "--  Latency %-6s    = %12lu ticks\n", names[i], (unsigned long)point );
+#endif
+	}
+}
+#endif
+
+#if STREAM_ON
+/*------------------------------------------------------------------------------
+ * FUNC   : stream_put
+ *
+ * DESC   : Adds a batch, id -1, or a stage to the streaming report, and
+ *          prints the report when that fills it.
+ * ---------------------------------------------------------------------------*/
+
+static void stream_put( int id, size_t ticks )
+{
+	stream_buf[ stream_used ].id    = id;
+	stream_buf[ stream_used ].ticks = ticks;
+	if ( ++stream_used == TH_STREAM_SIZE )
+		stream_flush();
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : stream_flush
+ *
+ * DESC   : Prints the entries of the streaming report and empties it.  The
+ *          ticks that takes are added to stream_ticks, for
+ *          th_signal_finished() to take out of the duration, and moved
+ *          past by the start of the batch and of the stages it interrupts.
+ * ---------------------------------------------------------------------------*/
+
+static void stream_flush( void )
+{
+	size_t		start = al_ticks();
+	size_t		ticks;
+	const char	*name;
+	int			i;
+
+	for ( i = 0; i < stream_used; i++ ) {
+		if ( stream_buf[i].id < 0 ) {
+			th_printf( "## L %lu %lu\n", (unsigned long)++stream_batches,
+				(unsigned long)stream_buf[i].ticks );
+			continue;
+		}
+#if TH_PROFILE
+		name = prof_names[ stream_buf[i].id ];
+		if ( strncmp( name, "PROF_", 5 ) == 0 )
+			name += 5;
+#else
+		name = "";
+#endif
+		th_printf( "## S %s %lu\n", name, (unsigned long)stream_buf[i].ticks );
+	}
+	stream_used = 0;
+
+	ticks = ( al_ticks() - start ) & AL_TICKS_MASK;
+	stream_ticks += ticks;
+#if TH_LATENCY_BATCH
+	lat_last += ticks;
+#endif
+#if TH_PROFILE
+	for ( i = 0; i < TH_PROF_STAGES; i++ )
+		prof_start[i] += ticks;
+#endif
+}
+#endif
+
 /*------------------------------------------------------------------------------
  * FUNC   : th_printf
  *
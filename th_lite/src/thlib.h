@@ -78,6 +78,8 @@ typedef struct TCDef{
    size_t			v2;
    size_t			v3;
    size_t			v4;
+   int				verify_snr;	/* TRUE if v1v2 is the S/N in dB of the output
+								 * and v3v4 the least that passes */
 } TCDef;
 
 
@@ -101,6 +103,18 @@ FileDef;
 /* Keep FD_SIZE and even multiple of 4 */
 #define FD_SIZE ((size_t)ROUNDUP4(sizeof(FileDef)*2))
 
+/* kernel variants, see TH_KERNEL_ENV in thcfg.h.  A variant needs all its
+ * TH_CPU_ features; list them best first and the scalar one last */
+#define TH_CPU_SSE2     (0x01UL)
+#define TH_CPU_AVX2     (0x02UL)
+#define TH_CPU_AVX512   (0x04UL)
+#define TH_CPU_NEON     (0x08UL)
+
+typedef struct {
+	const char *name;      /* e.g. "sse2" */
+	e_u32       features;  /* TH_CPU_ features it needs */
+} THKernelVariant;
+
 #endif /*THLIB_H_FILE*/ 
 
 /*------------------------------------------------------------------------------
@@ -112,8 +126,17 @@ FileDef;
 void *th_malloc_x( size_t size, const char *file, int line );
 #define th_free( blk ) th_free_x( blk, __FILE__, __LINE__ )
 void    th_free_x( void *blk, const char *file, int line );
+/* th_malloc_aligned gets 'align' byte aligned memory, a power of 2, that
+ * only th_free_aligned may free */
+#define th_malloc_aligned( size, align ) th_malloc_aligned_x( size, align, __FILE__, __LINE__ )
+void *th_malloc_aligned_x( size_t size, size_t align, const char *file, int line );
+#define th_free_aligned( blk ) th_free_aligned_x( blk, __FILE__, __LINE__ )
+void    th_free_aligned_x( void *blk, const char *file, int line );
 void    th_heap_reset( void );
 void mem_heap_initialize(void);
+#if TH_FOOTPRINT
+void    th_heap_peak( size_t *bytes, size_t *blocks );
+#endif
 
 /* Timer Routines */
 void   th_signal_start( void );
@@ -123,6 +146,16 @@ int th_timer_is_intrusive( void );
 size_t th_ticks_per_sec( void );
 size_t th_tick_granularity( void );
 
+/* Latency histogram, see TH_LATENCY_BATCH in thcfg.h, after every
+ * iteration of the timed loop */
+#if TH_LATENCY_BATCH
+void th_latency_begin( size_t iterations );
+void th_latency_mark( void );
+#else
+#define th_latency_begin( iterations )	((void)(iterations))
+#define th_latency_mark()				((void)0)
+#endif
+
 /* System Routines */
 void   th_exit( int exit_code, const char *fmt, ... );
 int th_report_results(TCDef *tcdef, e_u16 Expected_CRC );
@@ -132,6 +165,8 @@ int th_report_results(TCDef *tcdef, e_u16 Expected_CRC );
 e_u16 Calc_crc8(e_u8 data, e_u16 crc );
 e_u16 Calc_crc16( e_u16 data, e_u16 crc );
 e_u16 Calc_crc32( e_u32 data, e_u16 crc );
+e_u16 Calc_crc_buf( const void *buf, size_t len, e_u16 crc );
+e_u16 Calc_crc_buf16( const e_u16 *buf, size_t n, e_u16 crc );
 #endif
 
 /* Display control */
@@ -140,3 +175,18 @@ int th_sprintf( char *str, const char *fmt, ... );
 
 /* Benchmark source code compatibility stubs */
 int th_harness_poll( void );
+
+/* Stage profiling, see TH_PROFILE in thcfg.h. id is a constant from 0 to
+ * TH_PROF_STAGES-1, reported by its name less any PROF_ prefix */
+#if TH_PROFILE
+void th_prof_begin( int id );
+void th_prof_end( int id, const char *name );
+#define TH_PROF_BEGIN( id )	th_prof_begin( id )
+#define TH_PROF_END( id )	th_prof_end( id, #id )
+#else
+#define TH_PROF_BEGIN( id )	((void)0)
+#define TH_PROF_END( id )	((void)0)
+#endif
+
+/* Kernel variants, see THKernelVariant */
+int th_kernel_select( const char *kernel, const THKernelVariant *variants, int count );
@@ -113,6 +113,25 @@ typedef float                   n_float;
 typedef double                  n_double;
 typedef void					n_void; 
 
+/*------------------------------------------------------------------------------
+ * Data alignment.  EE_ALIGN( n ) goes with the storage class of an object
+ * definition to align the object to n bytes, a power of 2.  EE_SIMD_ALIGN
+ * is the alignment of the benchmark data sets, and the one to ask of
+ * th_malloc_aligned() for buffers that vector loads run over.
+ *----------------------------------------------------------------------------*/
+
+#if !defined( EE_SIMD_ALIGN )
+#define EE_SIMD_ALIGN   64  /* a plain literal for __declspec( align() ) */
+#endif
+
+#if defined( __GNUC__ )
+#define EE_ALIGN( n )   __attribute__(( aligned( n ) ))
+#elif defined( _MSC_VER )
+#define EE_ALIGN( n )   __declspec( align( n ) )
+#else
+#define EE_ALIGN( n )   /* the compiler has no way to ask */
+#endif
+
 /*------------------------------------------------------------------------------
  * This data type should be set to a type which will hold the larget
  * benchmark loop count used on your target system.  Generally, this will
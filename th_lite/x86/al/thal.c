@@ -7,6 +7,11 @@
  *
  */
 
+/* clock_gettime() needs the POSIX declarations under -ansi */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include <stdlib.h>
 
 #include <stdarg.h>
@@ -29,8 +34,50 @@
  * Local Data
  */
 
+#if TARGET_TIMER_SOURCE == TARGET_TIMER_CLOCK
 static	clock_t  start_time;
 static	clock_t  stop_time;
+#else
+static	size_t   start_time;
+static	size_t   stop_time;
+#endif
+
+#if TARGET_TIMER_SOURCE == TARGET_TIMER_TSC && defined(__GNUC__) && defined(__x86_64__)
+#define AL_TIMER_TSC (TRUE)
+static int    tsc_calibrated = 0;
+static size_t tsc_per_sec    = 0;     /* 0 when the TSC is not invariant */
+#else
+#define AL_TIMER_TSC (FALSE)
+#endif
+
+#if TARGET_TIMER_SOURCE == TARGET_TIMER_DWT && \
+    ( defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__) )
+#define AL_TIMER_DWT (TRUE)
+/* the ARMv7-M debug registers: DEMCR.TRCENA powers the DWT, DWT_CTRL
+ * bit 0 runs CYCCNT, and the Cortex-M7 locks them until LAR is written */
+#define DWT_DEMCR   ( *(volatile e_u32 *)0xE000EDFCUL )
+#define DWT_CTRL    ( *(volatile e_u32 *)0xE0001000UL )
+#define DWT_CYCCNT  ( *(volatile e_u32 *)0xE0001004UL )
+#define DWT_LAR     ( *(volatile e_u32 *)0xE0001FB0UL )
+#else
+#define AL_TIMER_DWT (FALSE)
+#endif
+
+#if TARGET_TIMER_SOURCE == TARGET_TIMER_USER
+#define AL_TIMER_USER (TRUE)
+#else
+#define AL_TIMER_USER (FALSE)
+#endif
+
+/* the POSIX clock, TARGET_TIMER_MONOTONIC's and the fallback of the others */
+#define AL_TIMER_MONOTONIC ( TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK && \
+                             !AL_TIMER_DWT && !AL_TIMER_USER )
+
+#if TARGET_ENERGY
+static int    energy_ok    = 0;       /* the last timed region was measured */
+static size_t energy_start = 0;
+static size_t energy_uj    = 0;
+#endif
 
 /*------------------------------------------------------------------------------
  * Platform Specific Header Files, Defines, Globals and Local Data
@@ -50,6 +97,206 @@ static	clock_t  stop_time;
  *            to support target based timing!  
  * ---------------------------------------------------------------------------*/
 
+#if AL_TIMER_MONOTONIC
+/*------------------------------------------------------------------------------
+ * FUNC   : al_monotonic_ns
+ *
+ * DESC   : Reads CLOCK_MONOTONIC_RAW, which NTP does not slew
+ *
+ * RETURNS: The time in nanoseconds
+ * ---------------------------------------------------------------------------*/
+
+static size_t al_monotonic_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC_RAW, &ts );
+	return (size_t)ts.tv_sec * 1000000000UL + (size_t)ts.tv_nsec;
+}
+#endif
+
+#if AL_TIMER_TSC
+/*------------------------------------------------------------------------------
+ * FUNC   : al_read_tsc
+ *
+ * DESC   : Reads the time stamp counter
+ *
+ * RETURNS: The counter
+ * ---------------------------------------------------------------------------*/
+
+static size_t al_read_tsc( void )
+{
+	unsigned int lo, hi;
+
+	__asm__ __volatile__ ( "rdtsc" : "=a" (lo), "=d" (hi) );
+	return (size_t)hi << 32 | lo;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_calibrate_tsc
+ *
+ * DESC   : Once, checks CPUID for an invariant TSC, one that ticks at a
+ *          constant rate in every power state, and counts its ticks over
+ *          20 ms of CLOCK_MONOTONIC_RAW. Leaves tsc_per_sec 0 otherwise.
+ * ---------------------------------------------------------------------------*/
+
+static void al_calibrate_tsc( void )
+{
+	unsigned int eax, ebx, ecx, edx;
+	size_t       ns0, ns1, tsc0, tsc1;
+
+	if ( tsc_calibrated )
+		return;
+	tsc_calibrated = 1;
+
+	__asm__ __volatile__ ( "cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	                               : "a" (0x80000000U) );
+	if ( eax < 0x80000007U )
+		return;
+	__asm__ __volatile__ ( "cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	                               : "a" (0x80000007U) );
+	if ( !( edx & ( 1U << 8 ) ) )
+		return;
+
+	ns0  = al_monotonic_ns();
+	tsc0 = al_read_tsc();
+	do
+		ns1 = al_monotonic_ns();
+	while ( ns1 - ns0 < 20000000UL );
+	tsc1 = al_read_tsc();
+
+	tsc_per_sec = (size_t)( (double)( tsc1 - tsc0 ) * 1e9 / ( ns1 - ns0 ) + 0.5 );
+}
+#endif
+
+#if AL_TIMER_DWT
+/*------------------------------------------------------------------------------
+ * FUNC   : al_enable_dwt
+ *
+ * DESC   : Powers the DWT and runs its cycle counter, which the debugger
+ *          may have left off.  CYCCNT keeps counting from where it is.
+ * ---------------------------------------------------------------------------*/
+
+static void al_enable_dwt( void )
+{
+	DWT_DEMCR |= (e_u32)1 << 24;
+	DWT_LAR    = (e_u32)0xC5ACCE55UL;
+	DWT_CTRL  |= (e_u32)1;
+}
+#endif
+
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+/*------------------------------------------------------------------------------
+ * FUNC   : al_read_ticks
+ *
+ * DESC   : Reads the timer of TARGET_TIMER_SOURCE
+ *
+ * RETURNS: The time in al_ticks_per_sec() ticks
+ * ---------------------------------------------------------------------------*/
+
+static size_t al_read_ticks( void )
+{
+#if AL_TIMER_DWT
+	return (size_t)DWT_CYCCNT;
+#elif AL_TIMER_USER
+	return (size_t)( TARGET_TIMER_READ() ) & AL_TICKS_MASK;
+#else
+#if AL_TIMER_TSC
+	if ( tsc_per_sec != 0 )
+		return al_read_tsc();
+#endif
+	return al_monotonic_ns();
+#endif
+}
+#endif
+
+#if TARGET_ENERGY
+#if defined(__linux__)
+/*------------------------------------------------------------------------------
+ * FUNC   : al_read_sysfs
+ *
+ * DESC   : Reads the number in one file of TARGET_ENERGY_PATH
+ *
+ * RETURNS: Success, or Failure if the file cannot be read
+ * ---------------------------------------------------------------------------*/
+
+static int al_read_sysfs( const char *name, size_t *value )
+{
+	char			path[ 256 ];
+	FILE			*fp;
+	unsigned long	v;
+	int				ok;
+
+	if ( strlen( TARGET_ENERGY_PATH ) + strlen( name ) + 2 > sizeof(path) )
+		return Failure;
+	sprintf( path, "%s/%s", TARGET_ENERGY_PATH, name );
+
+	fp = fopen( path, "r" );
+	if ( fp == NULL )
+		return Failure;
+	ok = fscanf( fp, "%lu", &v ) == 1;
+	fclose( fp );
+
+	*value = (size_t)v;
+	return ok ? Success : Failure;
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_read_energy
+ *
+ * DESC   : Reads the energy counter in microjoules, and the most it counts
+ *          before it wraps around to 0, or 0 if it does not.
+ *
+ * RETURNS: Success, or Failure if there is no counter to read
+ *
+ * PORTING: This reads RAPL from the Linux powercap sysfs.  Boards with a
+ *          power monitor read its accumulated energy here, or integrate its
+ *          power readings over al_ticks().
+ * ---------------------------------------------------------------------------*/
+
+static int al_read_energy( size_t *uj, size_t *wrap )
+{
+#if defined(__linux__)
+	static int		range_read = 0;
+	static size_t	range      = 0;
+
+	if ( !range_read )
+	{
+		range_read = 1;
+		if ( al_read_sysfs( "max_energy_range_uj", &range ) != Success )
+			range = 0;
+	}
+	*wrap = range;
+	return al_read_sysfs( "energy_uj", uj );
+#else
+	*uj   = 0;
+	*wrap = 0;
+	return Failure;
+#endif
+}
+#endif
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_energy
+ *
+ * DESC   : Gets the energy used over the last timed region in microjoules.
+ *
+ * RETURNS: Success, or Failure when TARGET_ENERGY is off or there is no
+ *          energy counter
+ * ---------------------------------------------------------------------------*/
+
+int al_energy( size_t *uj )
+{
+#if TARGET_ENERGY
+	*uj = energy_uj;
+	return energy_ok ? Success : Failure;
+#else
+	*uj = 0;
+	return Failure;
+#endif
+}
+
 /*------------------------------------------------------------------------------
  * FUNC   : al_signal_start
  *
@@ -65,7 +312,23 @@ static	clock_t  stop_time;
 
 void al_signal_start( void )
 {
-#if WINDOWS_EXAMPLE_CODE
+#if AL_TIMER_TSC
+        al_calibrate_tsc();
+#elif AL_TIMER_DWT
+        al_enable_dwt();
+#elif AL_TIMER_USER && defined( TARGET_TIMER_INIT )
+        TARGET_TIMER_INIT();
+#endif
+#if TARGET_ENERGY
+	{
+		size_t	wrap;
+
+		energy_ok = al_read_energy( &energy_start, &wrap ) == Success;
+	}
+#endif
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+        start_time      = al_read_ticks();
+#elif WINDOWS_EXAMPLE_CODE
         start_time      = clock();       
 #else
         /* Board specific timer code */                      
@@ -91,15 +354,45 @@ void al_signal_start( void )
    
 size_t al_signal_finished( void )
 {
-#if WINDOWS_EXAMPLE_CODE 
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+	stop_time	= al_read_ticks();
+#elif WINDOWS_EXAMPLE_CODE 
 	stop_time	= clock();
 #else
 	/* Board specific timer code  */ 
 	stop_time	= clock();
 #endif
-	return (size_t)(stop_time-start_time);
+#if TARGET_ENERGY
+	if (energy_ok) {
+		size_t	now;
+		size_t	wrap;
+
+		energy_ok = al_read_energy( &now, &wrap ) == Success;
+		if (now < energy_start && wrap > 0)
+			energy_uj = wrap - energy_start + now;
+		else
+			energy_uj = now - energy_start;
+	}
+#endif
+	return (size_t)(stop_time-start_time) & AL_TICKS_MASK;
 }
    
+/*------------------------------------------------------------------------------
+ * FUNC   : al_ticks
+ *
+ * DESC   : Reads the target timer, in al_ticks_per_sec() ticks, without
+ *          starting or stopping it, for th_prof_begin() and th_prof_end().
+ * ---------------------------------------------------------------------------*/
+
+size_t al_ticks( void )
+{
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+	return al_read_ticks();
+#else
+	return (size_t)clock();
+#endif
+}
+
 /*------------------------------------------------------------------------------
  * FUNC   : al_ticks_per_sec
  *
@@ -132,11 +425,29 @@ size_t al_signal_finished( void )
  *          return the same value approximately every 72 minutes.
  *          ( Excerpt from GNU man page clock )
  *
+ *          TARGET_TIMER_MONOTONIC counts nanoseconds and TARGET_TIMER_TSC
+ *          the calibrated TSC rate, and neither wraps in practice with
+ *          64-bit ticks.  TARGET_TIMER_DWT counts TARGET_CPU_HZ cycles and
+ *          TARGET_TIMER_USER TARGET_TIMER_HZ ticks, both of which wrap.
+ *
  * ---------------------------------------------------------------------------*/
    
 size_t al_ticks_per_sec( void )
 {
+#if AL_TIMER_TSC
+	al_calibrate_tsc();
+	if ( tsc_per_sec != 0 )
+		return tsc_per_sec;
+#endif
+#if AL_TIMER_DWT
+	return (size_t) TARGET_CPU_HZ;
+#elif AL_TIMER_USER
+	return (size_t) TARGET_TIMER_HZ;
+#elif TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+	return (size_t) 1000000000UL;
+#else
 	return (size_t) CLOCKS_PER_SEC;
+#endif
 }
 
 /*------------------------------------------------------------------------------
@@ -162,7 +473,11 @@ size_t al_ticks_per_sec( void )
    
 size_t al_tick_granularity( void )
 {
+#if TARGET_TIMER_SOURCE != TARGET_TIMER_CLOCK
+	return 1;
+#else
 	return 10;
+#endif
 }
 
 /*------------------------------------------------------------------------------
@@ -220,6 +535,87 @@ int     al_sprintf(char *str, const char *fmt, va_list   args)
 	return  vsprintf(str,fmt,args);
 }
 
+/*------------------------------------------------------------------------------
+ * FUNC   : al_cpu_features
+ *
+ * DESC   : Finds the instruction set extensions the CPU has, for
+ *          th_kernel_select(): CPUID on x86, NEON on AArch64, where it is
+ *          always there, and the Features of /proc/cpuinfo on 32 bit ARM.
+ *
+ * RETURNS: TH_CPU_ features
+ *
+ * PORTING: Targets with no kernel variants can return 0.
+ * ---------------------------------------------------------------------------*/
+e_u32	al_cpu_features( void )
+{
+	e_u32	features = 0;
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "sse2" ) )
+		features |= TH_CPU_SSE2;
+	if ( __builtin_cpu_supports( "avx2" ) )
+		features |= TH_CPU_AVX2;
+	if ( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ) )
+		features |= TH_CPU_AVX512;
+#elif defined(__aarch64__)
+	features |= TH_CPU_NEON;
+#elif defined(__linux__) && defined(__arm__)
+	FILE	*fp;
+	char	line[ 256 ];
+
+	fp = fopen( "/proc/cpuinfo", "r" );
+	if ( fp != NULL )
+	{
+		while ( fgets( line, sizeof(line), fp ) != NULL )
+			if ( strncmp( line, "Features", 8 ) == 0 && strstr( line, " neon" ) != NULL )
+				features |= TH_CPU_NEON;
+		fclose( fp );
+	}
+#endif
+	return features;
+}
+
+/*------------------------------------------------------------------------------
+ * FUNC   : al_stack_paint, al_stack_used
+ *
+ * DESC   : al_stack_paint() fills TH_STACK_PAINT bytes of stack below its
+ *          caller with a pattern, and al_stack_used() finds how much of it
+ *          was written since, from the far end, for TH_FOOTPRINT.
+ *
+ * RETURNS: The bytes of stack used below al_stack_paint()'s caller, or 0
+ *          before al_stack_paint()
+ *
+ * PORTING: This takes a stack that grows down, as on x86 and ARM.  Count
+ *          from the other end of the paint where it grows up.
+ * ---------------------------------------------------------------------------*/
+
+#define STACK_WORDS	( (size_t)TH_STACK_PAINT / sizeof(e_u32) )
+#define STACK_MAGIC	( (e_u32)0xDEADBEEFUL )
+
+static volatile e_u32	*stack_paint = NULL;
+
+void al_stack_paint( void )
+{
+	volatile e_u32	paint[ STACK_WORDS ];
+	size_t			i;
+
+	for ( i = 0; i < STACK_WORDS; i++ )
+		paint[i] = STACK_MAGIC;
+	stack_paint = paint;
+}
+
+size_t al_stack_used( void )
+{
+	size_t	i;
+
+	if ( stack_paint == NULL )
+		return 0;
+	for ( i = 0; i < STACK_WORDS && stack_paint[i] == STACK_MAGIC; i++ )
+		;
+	return ( STACK_WORDS - i ) * sizeof(e_u32);
+}
+
 /*------------------------------------------------------------------------------
  * FUNC   : al_report_results
  *                                    
@@ -296,6 +692,11 @@ void	al_main( int argc, const char* argv[]  )
 	/* Initialize memory management (heap) data structures */
 	mem_heap_initialize();
 
+#if	TH_FOOTPRINT
+	/* the benchmark runs below here */
+	al_stack_paint();
+#endif
+
 /*- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  * AL_SECTION_1
  */
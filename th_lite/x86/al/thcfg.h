@@ -49,6 +49,76 @@
 #define TARGET_TIMER_AVAIL     (TRUE)
 #define TARGET_TIMER_INTRUSIVE (TRUE)
 
+/*------------------------------------------------------------------------------
+ * Target Timer Source, the timer behind th_signal_start/th_signal_finished
+ *
+ * TARGET_TIMER_CLOCK     - ANSI clock(), process CPU time in CLOCKS_PER_SEC
+ *                          ticks of about a millisecond
+ * TARGET_TIMER_MONOTONIC - POSIX clock_gettime(CLOCK_MONOTONIC_RAW) wall
+ *                          time in nanosecond ticks
+ * TARGET_TIMER_TSC       - the x86-64 time stamp counter in cycle ticks,
+ *                          calibrated against CLOCK_MONOTONIC_RAW. Without
+ *                          an invariant TSC, or on other targets, this is
+ *                          TARGET_TIMER_MONOTONIC.
+ * TARGET_TIMER_DWT       - the 32-bit DWT CYCCNT cycle counter of an
+ *                          ARMv7-M or ARMv8-M core, enabled by
+ *                          al_signal_start(), at TARGET_CPU_HZ ticks per
+ *                          second. On other targets this is
+ *                          TARGET_TIMER_MONOTONIC.
+ * TARGET_TIMER_USER      - a vendor timer: TARGET_TIMER_READ() reads the
+ *                          counter, TARGET_TIMER_HZ is its rate and
+ *                          TARGET_TIMER_MASK the bits it counts, for
+ *                          counters narrower than size_t that wrap.
+ *                          TARGET_TIMER_INIT(), if defined, starts it.
+ *                          Define them in harness.h or on the command
+ *                          line.
+ *
+ * The tick counts are size_t, 64 bits on 64-bit hosts.  The 32-bit CYCCNT
+ * wraps after 2^32 cycles, 21 seconds at 200 MHz: keep a timed region, a
+ * latency batch and a profile stage shorter than that.
+ *---------------------------------------------------------------------------*/
+
+#define TARGET_TIMER_CLOCK     0
+#define TARGET_TIMER_MONOTONIC 1
+#define TARGET_TIMER_TSC       2
+#define TARGET_TIMER_DWT       3
+#define TARGET_TIMER_USER      4
+
+#if !defined( TARGET_TIMER_SOURCE )
+#define TARGET_TIMER_SOURCE    TARGET_TIMER_CLOCK
+#endif
+
+#if !defined( TARGET_CPU_HZ )
+#define TARGET_CPU_HZ          (100000000UL)
+#endif
+
+#if TARGET_TIMER_SOURCE == TARGET_TIMER_USER
+#if !defined( TARGET_TIMER_READ ) || !defined( TARGET_TIMER_HZ )
+#error "TARGET_TIMER_USER needs TARGET_TIMER_READ() and TARGET_TIMER_HZ"
+#endif
+#if !defined( TARGET_TIMER_MASK )
+#define TARGET_TIMER_MASK      (~(size_t)0)
+#endif
+#endif
+
+/*------------------------------------------------------------------------------
+ * Energy Measurement
+ *
+ * When TARGET_ENERGY is (TRUE), th_signal_start/th_signal_finished also read
+ * an energy counter around the timed region, and th_report_results() adds
+ * the joules, joules per iteration and iterations per joule.  On Linux this
+ * is the RAPL package domain in TARGET_ENERGY_PATH, see the full harness's
+ * thcfg.h; other targets read their board power monitor in al_read_energy().
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TARGET_ENERGY )
+#define TARGET_ENERGY          (FALSE)
+#endif
+
+#if !defined( TARGET_ENERGY_PATH )
+#define TARGET_ENERGY_PATH     "/sys/class/powercap/intel-rapl:0"
+#endif
+
 /*------------------------------------------------------------------------------
  * Set BMDEBUG to a (TRUE) to enable debugging printf's etc etc.
  * Set it to a (FALSE) for the released version of the BM
@@ -196,6 +266,21 @@
 #error	"CRC_CHECK and NON_INTRUSIVE_CRC_CHECK are enabled. Set one of them to FALSE"
 #endif
 
+/*---------------------------------------------------------------------------
+ * CRC_SLICES selects how Calc_crc8 and Calc_crc_buf compute the crc, all
+ * with the same results.  0 is the original bit at a time loop, 1 looks up
+ * a 256 entry table per byte, and 8 also slices Calc_crc_buf 8 bytes at a
+ * time through 8 tables (4KB of data).
+ *---------------------------------------------------------------------------*/
+
+#if	!defined(CRC_SLICES)
+#define	CRC_SLICES				(8)
+#endif
+
+#if		CRC_SLICES != 0 && CRC_SLICES != 1 && CRC_SLICES != 8
+#error	"CRC_SLICES must be 0, 1 or 8"
+#endif
+
 /*------------------------------------------------------------------------------
  * Display verification 
  * VERIFY_INT - v1, v2, v3, v4 as size_t
@@ -203,6 +288,8 @@
  *
  * NOTE: VERIFY_FLOAT can be used in telecom benchmarks to display 
  * automatically calculated diffmeasure results 
+ * With verify_snr set, v1v2 is the S/N in dB and v3v4 the least S/N that
+ * passes, 0 for no check, and th_report_results() fails a run below it.
  *----------------------------------------------------------------------------*/
 
 #if !defined(VERIFY_INT)
@@ -213,6 +300,102 @@
 #define	VERIFY_FLOAT (FALSE)
 #endif
 
+/*---------------------------------------------------------------------------
+ * Stage Profiling
+ *
+ * When TH_PROFILE is TRUE, TH_PROF_BEGIN(id) and TH_PROF_END(id) around a
+ * stage of a kernel add its ticks to slot id, 0 to TH_PROF_STAGES-1, while
+ * the timed loop runs, and th_report_results() adds each stage's calls,
+ * ticks per call and share of the run.  Use a TARGET_TIMER_SOURCE finer
+ * than one stage.  Otherwise the macros compile to nothing.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_PROFILE )
+#define TH_PROFILE		(FALSE)
+#endif
+
+#if !defined( TH_PROF_STAGES )
+#define TH_PROF_STAGES	(8)
+#endif
+
+/*---------------------------------------------------------------------------
+ * Latency Histogram
+ *
+ * When TH_LATENCY_BATCH is non-zero, th_latency_mark() after each
+ * iteration of the timed loop times every TH_LATENCY_BATCH iterations as a
+ * batch and counts it in a histogram of octaves of ticks, each split into
+ * 2^TH_LATENCY_SUB_BITS bins, 124 counters with 32-bit ticks, so that the
+ * RAM it takes does not grow with the iterations as the full harness's
+ * buffer of timestamps does.  th_report_results() adds the exact min and
+ * max and the p50, p90, p99 and p99.9 time per batch, each the top of its
+ * bin, within 1/2^TH_LATENCY_SUB_BITS of the true value.  Use a
+ * TARGET_TIMER_SOURCE finer than one batch.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_LATENCY_BATCH )
+#define TH_LATENCY_BATCH	(0)
+#endif
+
+#if !defined( TH_LATENCY_SUB_BITS )
+#define TH_LATENCY_SUB_BITS	(2)
+#endif
+
+/*---------------------------------------------------------------------------
+ * Streaming Report
+ *
+ * When TH_STREAM is TRUE, each batch th_latency_mark() times and each stage
+ * TH_PROF_END() ends is also sent out as it happens, a line
+ * "## L <batch> <ticks>" or "## S <stage> <ticks>", through a buffer of
+ * TH_STREAM_SIZE entries that is printed whenever it fills and at
+ * th_signal_finished().  The ticks of printing it are taken out of the
+ * duration, the batch and the stages it interrupts.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_STREAM )
+#define TH_STREAM		(FALSE)
+#endif
+
+#if !defined( TH_STREAM_SIZE )
+#define TH_STREAM_SIZE	(32)
+#endif
+
+/*---------------------------------------------------------------------------
+ * Memory Footprint
+ *
+ * When TH_FOOTPRINT is TRUE, th_report_results() adds the peak heap use of
+ * the run, the bytes asked of th_malloc() and the blocks live at once, and
+ * the stack high water mark.  Each block then carries a size header, and
+ * al_main() paints TH_STACK_PAINT bytes of stack, checked again at
+ * th_signal_finished().  A mark of TH_STACK_PAINT bytes means the run went
+ * deeper than the paint.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_FOOTPRINT )
+#define TH_FOOTPRINT	(FALSE)
+#endif
+
+#if !defined( TH_STACK_PAINT )
+#define TH_STACK_PAINT	(0x10000L)
+#endif
+
+/*---------------------------------------------------------------------------
+ * Kernel Variants
+ *
+ * A kernel built with more than one variant picks one when the benchmark
+ * starts with th_kernel_select(): the first whose CPU features
+ * al_cpu_features() finds, unless the TH_KERNEL_ENV environment variable
+ * forces one, e.g. TH_KERNEL=scalar or TH_KERNEL=fft:scalar,acs:sse2.
+ * The report lists the variant each kernel ran.
+ *---------------------------------------------------------------------------*/
+
+#if !defined( TH_KERNEL_ENV )
+#define TH_KERNEL_ENV	"TH_KERNEL"
+#endif
+
+#if !defined( TH_MAX_KERNELS )
+#define TH_MAX_KERNELS	(8)
+#endif
+
 /*---------------------------------------------------------------------------
  * EEMBC Member Company and Target specific defines go here
  *---------------------------------------------------------------------------*/
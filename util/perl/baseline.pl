@@ -0,0 +1,258 @@
+# ============================================================================
+#
+# Copyright (C) EEMBC(R) All Rights Reserved
+#
+# This software is licensed with an Acceptable Use Agreement under Apache 2.0.
+# Please refer to the license file (LICENSE.md) included with this code.
+#
+# ============================================================================
+
+use strict;
+use JSON::PP;
+use File::Path qw /mkpath/;
+use Sys::Hostname;
+
+=pod
+
+=head1 NAME
+
+baseline.pl - stores the JSON results records of a run as a baseline, and
+              compares later runs against it.
+
+=head1 SYNOPSIS
+
+baseline.pl store   <switches> <results files>
+
+baseline.pl compare <switches> <results files>
+
+    -dir=<directory>      The baseline store, default baselines
+    -machine=<name>       The machine the baseline is for, default the
+                          host name
+    -config=<name>        The build configuration, default the toolchain
+                          of the records.  Name the compiler defines that
+                          matter here, e.g. -config=simd.
+    -threshold=<percent>  The smallest change of iterations/sec compare
+                          reports as a regression or improvement, default 2
+
+The results files are the ones -json writes (see TH_RESULTS in thcfg.h),
+one record per line.  Only the last record of each benchmark and data set
+counts, so a file that several runs appended to gives the latest one.
+
+store merges those records into <dir>/<machine>/<config>.json, replacing
+the earlier record of each benchmark and data set.
+
+compare matches each record with the baseline one of its benchmark and
+data set and prints the change of iterations/sec.  When both ran with
+-trials<n>, n of 2 or more, a Welch t test on the trial means and
+standard deviations says whether the change is significant at 95%: a
+change is a REGRESSION or an IMPROVEMENT when it is significant and at
+least the threshold, same when it is significant but smaller, and noise
+when it is not.  Without trials there is no interval, the threshold alone
+decides and the verdict is marked with a ?.
+A failed CRC or S/N check is FAILED.
+
+compare exits with 1 when there is a regression or a failure, so that it
+can gate a new kernel variant, and with 2 when there is no baseline.
+
+=head1 EXAMPLE
+
+    make COMPILER_DEFINES=-DFFT_SIMD=TRUE CMDLINE="-autogo -json -trials10" run
+    perl ../util/perl/baseline.pl compare -config=simd thresults.json
+
+=cut
+
+# two sided 95% Student t for 1 to 30 degrees of freedom, as report_trials()
+my @t95 = (
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+     2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+     2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 );
+
+my $json = JSON::PP->new->canonical;
+
+sub usage
+{
+    print STDERR "usage: baseline.pl store|compare [-dir=<dir>] [-machine=<name>] " .
+                 "[-config=<name>] [-threshold=<percent>] <results files>\n";
+    exit 2;
+}
+
+# The key of a record: its benchmark and data set
+sub record_key
+{
+    my ( $r ) = @_;
+
+    return $r->{benchmark} . ' ' . ( defined $r->{dataset} ? $r->{dataset} : '' );
+}
+
+# The last record of each key in the files, and the keys in first seen order
+sub read_records
+{
+    my ( @files ) = @_;
+    my %records;
+    my @keys;
+
+    foreach my $file ( @files ) {
+        open( my $fh, '<', $file ) or die "baseline.pl: cannot read $file: $!\n";
+        while ( my $line = <$fh> ) {
+            next if $line !~ /^\s*\{/;
+            my $r = eval { $json->decode( $line ) };
+            if ( !defined $r || !defined $r->{benchmark} ) {
+                print STDERR "baseline.pl: $file:$.: not a results record\n";
+                next;
+            }
+            my $k = record_key( $r );
+            push @keys, $k if !exists $records{$k};
+            $records{$k} = $r;
+        }
+        close( $fh );
+    }
+    return ( \%records, \@keys );
+}
+
+# A file name from a machine or configuration name
+sub file_name
+{
+    my ( $name ) = @_;
+
+    $name =~ s/[^A-Za-z0-9._-]+/_/g;
+    $name =~ s/^_+|_+$//g;
+    return $name eq '' ? 'default' : $name;
+}
+
+# The iterations/sec of a record: the trial mean, sd and count when it has
+# two or more trials, else the one run
+sub rate
+{
+    my ( $r ) = @_;
+
+    if ( defined $r->{trials} && $r->{trials} >= 2 && defined $r->{trial_sd} ) {
+        return ( $r->{trial_mean}, $r->{trial_sd}, $r->{trials} );
+    }
+    return ( $r->{iter_per_sec}, undef, 1 );
+}
+
+# Welch's t test: TRUE when the means differ at 95%
+sub significant
+{
+    my ( $m1, $s1, $n1, $m2, $s2, $n2 ) = @_;
+    my $v1 = $s1 * $s1 / $n1;
+    my $v2 = $s2 * $s2 / $n2;
+    my $df;
+    my $t;
+
+    return $m1 != $m2 if $v1 + $v2 == 0;
+
+    $t  = abs( $m1 - $m2 ) / sqrt( $v1 + $v2 );
+    $df = ( $v1 + $v2 ) ** 2 / ( $v1 * $v1 / ( $n1 - 1 ) + $v2 * $v2 / ( $n2 - 1 ) );
+    $df = int( $df );
+    $df = 1 if $df < 1;
+    return $t > ( $df <= 30 ? $t95[ $df - 1 ] : 1.960 );
+}
+
+my $command = shift @ARGV;
+my $dir       = 'baselines';
+my $machine   = hostname();
+my $config;
+my $threshold = 2;
+my @files;
+
+usage() if !defined $command || ( $command ne 'store' && $command ne 'compare' );
+
+foreach my $arg ( @ARGV ) {
+    if    ( $arg =~ /^-dir=(.+)$/ )       { $dir = $1; }
+    elsif ( $arg =~ /^-machine=(.+)$/ )   { $machine = $1; }
+    elsif ( $arg =~ /^-config=(.+)$/ )    { $config = $1; }
+    elsif ( $arg =~ /^-threshold=([0-9.]+)$/ ) { $threshold = $1; }
+    elsif ( $arg =~ /^-/ )                { usage(); }
+    else                                  { push @files, $arg; }
+}
+usage() if !@files;
+
+my ( $current, $keys ) = read_records( @files );
+die "baseline.pl: no results records in @files\n" if !@$keys;
+
+$config = $current->{ $keys->[0] }->{toolchain} if !defined $config;
+$config = 'default' if !defined $config;
+
+my $path = "$dir/" . file_name( $machine ) . '/' . file_name( $config ) . '.json';
+
+if ( $command eq 'store' ) {
+    my ( $stored, $order ) = ( -e $path ) ? read_records( $path ) : ( {}, [] );
+
+    foreach my $k ( @$keys ) {
+        push @$order, $k if !exists $stored->{$k};
+        $stored->{$k} = $current->{$k};
+        $stored->{$k}->{machine} = $machine;
+        $stored->{$k}->{config}  = $config;
+    }
+
+    mkpath( "$dir/" . file_name( $machine ) );
+    open( my $fh, '>', $path ) or die "baseline.pl: cannot write $path: $!\n";
+    print $fh $json->encode( $stored->{$_} ), "\n" foreach @$order;
+    close( $fh );
+
+    printf "Stored %d records in %s (%d in the baseline)\n", scalar @$keys, $path, scalar @$order;
+    exit 0;
+}
+
+if ( !-e $path ) {
+    print STDERR "baseline.pl: no baseline $path, run baseline.pl store first\n";
+    exit 2;
+}
+
+my ( $base ) = read_records( $path );
+my $regressions  = 0;
+my $improvements = 0;
+my $failures     = 0;
+
+printf "Baseline %s, threshold %s%%\n\n", $path, $threshold;
+printf "%-16s %-16s %14s %14s %9s  %s\n",
+    'Benchmark', 'Data Set', 'Base Iter/Sec', 'Iter/Sec', 'Change', 'Verdict';
+
+foreach my $k ( @$keys ) {
+    my $r = $current->{$k};
+    my $b = $base->{$k};
+    my ( $m, $s, $n ) = rate( $r );
+    my $verdict;
+    my $change;
+
+    if ( $r->{status} ne 'pass' ) {
+        $verdict = 'FAILED';
+        $failures++;
+    }
+    elsif ( !defined $b ) {
+        $verdict = 'new';
+    }
+
+    my ( $bm, $bs, $bn ) = defined $b ? rate( $b ) : ();
+
+    if ( !defined $m || !defined $bm || $bm == 0 ) {
+        $verdict = 'n/a' if !defined $verdict;
+        printf "%-16s %-16s %14s %14s %9s  %s\n", $r->{benchmark}, $r->{dataset},
+            defined $bm ? sprintf( '%.3f', $bm ) : '-',
+            defined $m ? sprintf( '%.3f', $m ) : '-', '-', $verdict;
+        next;
+    }
+
+    $change = 100.0 * ( $m - $bm ) / $bm;
+
+    if ( !defined $verdict ) {
+        my $sure = defined $s && defined $bs;
+        my $real = $sure ? significant( $m, $s, $n, $bm, $bs, $bn ) : 1;
+
+        if ( $real && abs( $change ) >= $threshold ) {
+            $verdict = $change < 0 ? 'REGRESSION' : 'IMPROVEMENT';
+            $change < 0 ? $regressions++ : $improvements++;
+        }
+        else {
+            $verdict = $real ? 'same' : 'noise';
+        }
+        $verdict .= ' ?' if !$sure;
+    }
+
+    printf "%-16s %-16s %14.3f %14.3f %+8.2f%%  %s\n",
+        $r->{benchmark}, $r->{dataset}, $bm, $m, $change, $verdict;
+}
+
+printf "\n%d regressions, %d improvements, %d failures\n", $regressions, $improvements, $failures;
+exit( $regressions > 0 || $failures > 0 ? 1 : 0 );
@@ -9,14 +9,22 @@
 
 cleanrule:
 	-rm -f targets_*.mak
+	-rm -f telemark_*.mak
+	-rm -f modem00_*.mak
 	-find $(ROOT)/th -name harness.mak -exec rm -f {} \;
 	-find $(ROOT)/th_lite -name harness.mak -exec rm -f {} \;
 
-harness: targets$(VER)_$(TARGETS).mak $(TH)/$(TARGETS)/harness.mak
+harness: targets$(VER)_$(TARGETS).mak telemark$(VER)_$(TARGETS).mak modem00$(VER)_$(TARGETS).mak $(TH)/$(TARGETS)/harness.mak
 
 targets$(VER)_$(TARGETS).mak:	depgen$(VER)_$(TARGETS).cml $(ROOT)/util/perl/makerule.pl
 	perl $(ROOT)/util/perl/makerule.pl -cmd depgen$(VER)_$(TARGETS).cml 
 
+telemark$(VER)_$(TARGETS).mak:	depgen_telemark$(VER)_$(TARGETS).cml $(ROOT)/util/perl/makerule.pl
+	perl $(ROOT)/util/perl/makerule.pl -cmd depgen_telemark$(VER)_$(TARGETS).cml 
+
+modem00$(VER)_$(TARGETS).mak:	depgen_modem00$(VER)_$(TARGETS).cml $(ROOT)/util/perl/makerule.pl
+	perl $(ROOT)/util/perl/makerule.pl -cmd depgen_modem00$(VER)_$(TARGETS).cml 
+
 
 $(TH)/$(TARGETS)/harness.mak:	$(TH)/$(TARGETS)/depgen.cml $(ROOT)/util/perl/makerule.pl
 	perl $(ROOT)/util/perl/makerule.pl -cmd $(TH)/$(TARGETS)/depgen.cml 